@@ -0,0 +1,30 @@
+/**
+ * @file   sleep.h
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Stand-in for the Xilinx BSP header for the GHDL co-simulation.
+ *         Sleeping advances simulation time instead of wall clock time.
+ */
+
+#ifndef SLEEP_H
+#define SLEEP_H
+
+#include "cosim.h"
+
+static inline int usleep_cosim(unsigned long useconds)
+{
+  cosim_sleep_us(useconds);
+  return 0;
+}
+
+static inline unsigned sleep_cosim(unsigned int seconds)
+{
+  cosim_sleep_us(1000000ULL * seconds);
+  return 0;
+}
+
+// Don't collide with the declarations from unistd.h
+#define usleep usleep_cosim
+#define sleep  sleep_cosim
+
+#endif
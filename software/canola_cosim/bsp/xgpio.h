@@ -0,0 +1,33 @@
+/**
+ * @file   xgpio.h
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Stand-in for the Xilinx BSP header for the GHDL co-simulation.
+ *         The switches and buttons are driven by cosim_main.c.
+ */
+
+#ifndef XGPIO_H
+#define XGPIO_H
+
+#include "xil_types.h"
+#include "xstatus.h"
+
+#define XGPIO_IR_CH1_MASK 0x1U
+#define XGPIO_IR_CH2_MASK 0x2U
+#define XGPIO_IR_MASK     (XGPIO_IR_CH1_MASK | XGPIO_IR_CH2_MASK)
+
+typedef struct {
+  u16 DeviceId;
+  u32 IsReady;
+  u32 Data[2];
+} XGpio;
+
+int XGpio_Initialize(XGpio *InstancePtr, u16 DeviceId);
+void XGpio_SetDataDirection(XGpio *InstancePtr, unsigned Channel, u32 DirectionMask);
+u32 XGpio_DiscreteRead(XGpio *InstancePtr, unsigned Channel);
+void XGpio_DiscreteWrite(XGpio *InstancePtr, unsigned Channel, u32 Mask);
+void XGpio_InterruptEnable(XGpio *InstancePtr, u32 Mask);
+void XGpio_InterruptGlobalEnable(XGpio *InstancePtr);
+void XGpio_InterruptClear(XGpio *InstancePtr, u32 Mask);
+
+#endif
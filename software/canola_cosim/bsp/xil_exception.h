@@ -0,0 +1,43 @@
+/**
+ * @file   xil_exception.h
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Stand-in for the Xilinx BSP header for the GHDL co-simulation.
+ *         Disabling exceptions defers the interrupt handlers.
+ */
+
+#ifndef XIL_EXCEPTION_H
+#define XIL_EXCEPTION_H
+
+#include "xil_types.h"
+#include "cosim.h"
+
+#define XIL_EXCEPTION_ID_INT 5U
+
+typedef void (*Xil_ExceptionHandler)(void *data);
+typedef void (*Xil_InterruptHandler)(void *data);
+
+static inline void Xil_ExceptionInit(void)
+{
+}
+
+static inline void Xil_ExceptionRegisterHandler(u32 Exception_id,
+                                                Xil_ExceptionHandler Handler,
+                                                void *Data)
+{
+  (void)Exception_id;
+  (void)Handler;
+  (void)Data;
+}
+
+static inline void Xil_ExceptionEnable(void)
+{
+  cosim_irq_mask(0);
+}
+
+static inline void Xil_ExceptionDisable(void)
+{
+  cosim_irq_mask(1);
+}
+
+#endif
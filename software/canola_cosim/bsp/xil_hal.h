@@ -0,0 +1,15 @@
+/**
+ * @file   xil_hal.h
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Stand-in for the Xilinx BSP header for the GHDL co-simulation
+ */
+
+#ifndef XIL_HAL_H
+#define XIL_HAL_H
+
+#include "xil_types.h"
+#include "xil_io.h"
+#include "xil_exception.h"
+
+#endif
@@ -0,0 +1,25 @@
+/**
+ * @file   xil_io.h
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Stand-in for the Xilinx BSP header for the GHDL co-simulation.
+ *         Register accesses become AXI-lite transactions in the simulation.
+ */
+
+#ifndef XIL_IO_H
+#define XIL_IO_H
+
+#include "xil_types.h"
+#include "cosim.h"
+
+static inline u32 Xil_In32(UINTPTR Addr)
+{
+  return cosim_read((u32)Addr);
+}
+
+static inline void Xil_Out32(UINTPTR Addr, u32 Value)
+{
+  cosim_write((u32)Addr, Value);
+}
+
+#endif
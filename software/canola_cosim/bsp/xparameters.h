@@ -0,0 +1,40 @@
+/**
+ * @file   xparameters.h
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Stand-in for the Xilinx BSP header for the GHDL co-simulation.
+ *         Addresses and interrupt IDs match the block design in
+ *         vivado/canola_test.tcl, and the instances in canola_cosim_tb.vhd.
+ */
+
+#ifndef XPARAMETERS_H
+#define XPARAMETERS_H
+
+#define XPAR_SCUGIC_SINGLE_DEVICE_ID 0U
+
+#define XPAR_CPU_CORTEXA9_0_CPU_CLK_FREQ_HZ 666666687U
+
+#define XPAR_GPIO_0_DEVICE_ID 0U
+#define XPAR_GPIO_1_DEVICE_ID 1U
+
+#define XPAR_CANOLA_AXI_SLAVE_0_BASEADDR 0x60000000U
+#define XPAR_CANOLA_AXI_SLAVE_1_BASEADDR 0x60010000U
+#define XPAR_CANOLA_AXI_SLAVE_2_BASEADDR 0x60020000U
+#define XPAR_CANOLA_AXI_SLAVE_3_BASEADDR 0x60030000U
+
+// xlconcat_0 inputs 0 to 7 are IRQ_F2P 61 to 68, inputs 8 to 15 are 84 to 91
+#define XPAR_FABRIC_CANOLA_AXI_SLAVE_0_CAN_RX_VALID_IRQ_INTR  61U
+#define XPAR_FABRIC_CANOLA_AXI_SLAVE_0_CAN_TX_DONE_IRQ_INTR   62U
+#define XPAR_FABRIC_CANOLA_AXI_SLAVE_0_CAN_TX_FAILED_IRQ_INTR 63U
+#define XPAR_FABRIC_CANOLA_AXI_SLAVE_1_CAN_RX_VALID_IRQ_INTR  64U
+#define XPAR_FABRIC_CANOLA_AXI_SLAVE_1_CAN_TX_DONE_IRQ_INTR   65U
+#define XPAR_FABRIC_CANOLA_AXI_SLAVE_1_CAN_TX_FAILED_IRQ_INTR 66U
+#define XPAR_FABRIC_CANOLA_AXI_SLAVE_2_CAN_RX_VALID_IRQ_INTR  67U
+#define XPAR_FABRIC_CANOLA_AXI_SLAVE_2_CAN_TX_DONE_IRQ_INTR   68U
+#define XPAR_FABRIC_CANOLA_AXI_SLAVE_2_CAN_TX_FAILED_IRQ_INTR 84U
+#define XPAR_FABRIC_CANOLA_AXI_SLAVE_3_CAN_RX_VALID_IRQ_INTR  85U
+#define XPAR_FABRIC_CANOLA_AXI_SLAVE_3_CAN_TX_DONE_IRQ_INTR   86U
+#define XPAR_FABRIC_CANOLA_AXI_SLAVE_3_CAN_TX_FAILED_IRQ_INTR 87U
+#define XPAR_FABRIC_AXI_GPIO_0_IP2INTC_IRPT_INTR              88U
+
+#endif
@@ -0,0 +1,19 @@
+/**
+ * @file   xpseudo_asm.h
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Stand-in for the Xilinx BSP header for the GHDL co-simulation.
+ *         The CPSR only has the I bit, which masks the interrupt handlers.
+ */
+
+#ifndef XPSEUDO_ASM_H
+#define XPSEUDO_ASM_H
+
+#include "xil_types.h"
+#include "xreg_cortexa9.h"
+#include "cosim.h"
+
+#define mfcpsr() (cosim_cpsr_irq_masked() ? XREG_CPSR_IRQ_ENABLE : 0U)
+#define mtcpsr(v) cosim_cpsr_set_irq_masked(((v) & XREG_CPSR_IRQ_ENABLE) != 0)
+
+#endif
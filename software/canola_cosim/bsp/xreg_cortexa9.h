@@ -0,0 +1,14 @@
+/**
+ * @file   xreg_cortexa9.h
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Stand-in for the Xilinx BSP header for the GHDL co-simulation.
+ *         Only the CPSR bits used by the firmware.
+ */
+
+#ifndef XREG_CORTEXA9_H
+#define XREG_CORTEXA9_H
+
+#define XREG_CPSR_IRQ_ENABLE 0x80U
+
+#endif
@@ -0,0 +1,42 @@
+/**
+ * @file   xscugic.h
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Stand-in for the Xilinx BSP header for the GHDL co-simulation.
+ *         Connected handlers are called by cosim.c on interrupt edges
+ *         from the simulation.
+ */
+
+#ifndef XSCUGIC_H
+#define XSCUGIC_H
+
+#include "xil_types.h"
+#include "xil_exception.h"
+#include "xstatus.h"
+
+#define XSCUGIC_MAX_NUM_INTR_INPUTS 95U
+
+typedef struct {
+  u16 DeviceId;
+  u32 CpuBaseAddress;
+  u32 DistBaseAddress;
+} XScuGic_Config;
+
+typedef struct {
+  XScuGic_Config *Config;
+  u32 IsReady;
+} XScuGic;
+
+XScuGic_Config *XScuGic_LookupConfig(u16 DeviceId);
+s32 XScuGic_CfgInitialize(XScuGic *InstancePtr, XScuGic_Config *ConfigPtr,
+                          u32 EffectiveAddr);
+s32 XScuGic_Connect(XScuGic *InstancePtr, u32 Int_Id,
+                    Xil_InterruptHandler Handler, void *CallBackRef);
+void XScuGic_Enable(XScuGic *InstancePtr, u32 Int_Id);
+void XScuGic_Disable(XScuGic *InstancePtr, u32 Int_Id);
+void XScuGic_SetPriorityTriggerType(XScuGic *InstancePtr, u32 Int_Id,
+                                    u8 Priority, u8 Trigger);
+void XScuGic_InterruptMaptoCpu(XScuGic *InstancePtr, u8 Cpu_Id, u32 Int_Id);
+void XScuGic_InterruptHandler(XScuGic *InstancePtr);
+
+#endif
@@ -0,0 +1,14 @@
+/**
+ * @file   xstatus.h
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Stand-in for the Xilinx BSP header for the GHDL co-simulation
+ */
+
+#ifndef XSTATUS_H
+#define XSTATUS_H
+
+#define XST_SUCCESS 0L
+#define XST_FAILURE 1L
+
+#endif
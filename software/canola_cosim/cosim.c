@@ -0,0 +1,290 @@
+/**
+ * @file   cosim.c
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Bridge between the Zynq test firmware and the GHDL simulation of
+ *         the Canola AXI slaves in canola_cosim_tb.vhd
+ */
+
+#include "cosim.h"
+#include "xparameters.h"
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define COSIM_IRQ_IDS 96
+
+typedef struct {
+  int32_t kind;
+  int32_t addr;
+  int32_t data;
+} cosim_op_t;
+
+typedef struct {
+  void (*handler)(void *);
+  void *data;
+  int enabled;
+} cosim_irq_t;
+
+// Interrupt IDs of the interrupt lines reported by the simulation,
+// in the same order as on xlconcat_0 in the block design
+static const uint32_t irq_line_ids[COSIM_IRQ_LINES] = {
+  XPAR_FABRIC_CANOLA_AXI_SLAVE_0_CAN_RX_VALID_IRQ_INTR,
+  XPAR_FABRIC_CANOLA_AXI_SLAVE_0_CAN_TX_DONE_IRQ_INTR,
+  XPAR_FABRIC_CANOLA_AXI_SLAVE_0_CAN_TX_FAILED_IRQ_INTR,
+  XPAR_FABRIC_CANOLA_AXI_SLAVE_1_CAN_RX_VALID_IRQ_INTR,
+  XPAR_FABRIC_CANOLA_AXI_SLAVE_1_CAN_TX_DONE_IRQ_INTR,
+  XPAR_FABRIC_CANOLA_AXI_SLAVE_1_CAN_TX_FAILED_IRQ_INTR,
+  XPAR_FABRIC_CANOLA_AXI_SLAVE_2_CAN_RX_VALID_IRQ_INTR,
+  XPAR_FABRIC_CANOLA_AXI_SLAVE_2_CAN_TX_DONE_IRQ_INTR,
+  XPAR_FABRIC_CANOLA_AXI_SLAVE_2_CAN_TX_FAILED_IRQ_INTR,
+  XPAR_FABRIC_CANOLA_AXI_SLAVE_3_CAN_RX_VALID_IRQ_INTR,
+  XPAR_FABRIC_CANOLA_AXI_SLAVE_3_CAN_TX_DONE_IRQ_INTR,
+  XPAR_FABRIC_CANOLA_AXI_SLAVE_3_CAN_TX_FAILED_IRQ_INTR
+};
+
+// The simulation and the firmware thread strictly take turns, and the
+// semaphores order the accesses to the state below between them
+static sem_t sim_turn;
+static sem_t fw_turn;
+static pthread_t fw_thread;
+static void (*fw_entry)(void) = NULL;
+static int fw_started = 0;
+static int fw_done = 0;
+
+static cosim_op_t ops[COSIM_BATCH_SIZE];
+static int32_t op_count = 0;
+
+static cosim_irq_t irqs[COSIM_IRQ_IDS];
+static uint32_t irq_pending = 0;
+static int irq_masked = 0;
+static int irq_active = 0;
+
+static uint64_t now_us = 0;
+
+static uint64_t stat_handovers = 0;
+static uint64_t stat_writes = 0;
+static uint64_t stat_reads = 0;
+static uint64_t stat_irqs = 0;
+
+
+static void *fw_thread_main(void *arg)
+{
+  (void)arg;
+
+  sem_wait(&fw_turn);
+
+  if(fw_entry)
+    fw_entry();
+
+  // Let the simulation finish the writes that are still queued
+  if(op_count > 0) {
+    sem_post(&sim_turn);
+    sem_wait(&fw_turn);
+  }
+
+  fw_done = 1;
+  sem_post(&sim_turn);
+  return NULL;
+}
+
+// Hand the queued operations to the simulation, and wait until they
+// have been performed
+static void handover(void)
+{
+  sem_post(&sim_turn);
+  sem_wait(&fw_turn);
+  op_count = 0;
+  stat_handovers++;
+}
+
+// Call the handlers for the interrupt edges reported by the simulation.
+// Like on the GIC an interrupt does not preempt the handler of another.
+static void dispatch_irqs(void)
+{
+  if(irq_masked || irq_active)
+    return;
+
+  irq_active = 1;
+
+  while(irq_pending != 0) {
+    unsigned int line = 0;
+    while((irq_pending & (1U << line)) == 0)
+      line++;
+
+    irq_pending &= ~(1U << line);
+
+    cosim_irq_t *irq = &irqs[irq_line_ids[line]];
+    if(irq->enabled && irq->handler) {
+      irq->handler(irq->data);
+      stat_irqs++;
+    }
+  }
+
+  irq_active = 0;
+}
+
+static int32_t push_op(int32_t kind, uint32_t addr, uint32_t data)
+{
+  ops[op_count].kind = kind;
+  ops[op_count].addr = (int32_t)addr;
+  ops[op_count].data = (int32_t)data;
+  return op_count++;
+}
+
+
+int32_t cosim_sync(int32_t irq_edges, int32_t time_us)
+{
+  irq_pending |= (uint32_t)irq_edges;
+  now_us = (uint64_t)time_us;
+
+  if(!fw_started) {
+    fw_started = 1;
+    sem_init(&sim_turn, 0, 0);
+    sem_init(&fw_turn, 0, 0);
+    if(pthread_create(&fw_thread, NULL, fw_thread_main, NULL) != 0) {
+      printf("cosim: Could not start firmware thread\n");
+      return -1;
+    }
+  }
+
+  sem_post(&fw_turn);
+  sem_wait(&sim_turn);
+
+  if(fw_done) {
+    pthread_join(fw_thread, NULL);
+    return -1;
+  }
+
+  return op_count;
+}
+
+void cosim_get_op(int32_t index, int32_t *kind, int32_t *addr, int32_t *data)
+{
+  *kind = ops[index].kind;
+  *addr = ops[index].addr;
+  *data = ops[index].data;
+}
+
+void cosim_put_read(int32_t index, int32_t data)
+{
+  ops[index].data = data;
+}
+
+
+void cosim_write(uint32_t addr, uint32_t data)
+{
+  push_op(COSIM_OP_WRITE, addr, data);
+  stat_writes++;
+
+  if(op_count == COSIM_BATCH_SIZE) {
+    handover();
+    dispatch_irqs();
+  }
+}
+
+uint32_t cosim_read(uint32_t addr)
+{
+  int32_t index = push_op(COSIM_OP_READ, addr, 0);
+  stat_reads++;
+
+  handover();
+  uint32_t data = (uint32_t)ops[index].data;
+
+  dispatch_irqs();
+  return data;
+}
+
+void cosim_sleep_us(uint64_t us)
+{
+  const uint64_t deadline = now_us + us;
+
+  // The simulation stops waiting on interrupts, so that the handlers
+  // run in the middle of the sleep like on the real hardware
+  do {
+    uint64_t remaining = deadline > now_us ? deadline - now_us : 1;
+    if(remaining > INT32_MAX)
+      remaining = INT32_MAX;
+
+    push_op(COSIM_OP_WAIT, 0, (uint32_t)remaining);
+    handover();
+    dispatch_irqs();
+  } while(now_us < deadline);
+}
+
+void cosim_idle(uint32_t cycles)
+{
+  push_op(COSIM_OP_IDLE, 0, cycles);
+  handover();
+  dispatch_irqs();
+}
+
+// Disconnect CAN_TX of the controllers with a bit set in ctrl_mask from the
+// bus, they still see the bus on CAN_RX. Their own frames fail with bit
+// errors until they go bus off.
+void cosim_set_can_tx_fault(uint32_t ctrl_mask)
+{
+  push_op(COSIM_OP_TX_FAULT, 0, ctrl_mask);
+  handover();
+  dispatch_irqs();
+}
+
+uint64_t cosim_time_us(void)
+{
+  return now_us;
+}
+
+
+void cosim_irq_connect(uint32_t id, void (*handler)(void *), void *data)
+{
+  if(id < COSIM_IRQ_IDS) {
+    irqs[id].handler = handler;
+    irqs[id].data = data;
+  }
+}
+
+void cosim_irq_enable(uint32_t id, int enable)
+{
+  if(id < COSIM_IRQ_IDS)
+    irqs[id].enabled = enable;
+}
+
+void cosim_irq_mask(int masked)
+{
+  irq_masked = masked;
+
+  if(!masked)
+    dispatch_irqs();
+}
+
+// The I bit of the CPSR, which is also set while an interrupt handler runs
+int cosim_cpsr_irq_masked(void)
+{
+  return irq_masked || irq_active;
+}
+
+// Interrupt handlers return with the CPSR they were entered with, so a
+// handler writing the I bit has no effect on the interrupted code
+void cosim_cpsr_set_irq_masked(int masked)
+{
+  if(!irq_active)
+    cosim_irq_mask(masked);
+}
+
+
+void cosim_set_firmware(void (*firmware)(void))
+{
+  fw_entry = firmware;
+}
+
+void cosim_print_stats(void)
+{
+  printf("Co-simulation: %llu us simulated\n", (unsigned long long)now_us);
+  printf("  AXI writes:  %llu\n", (unsigned long long)stat_writes);
+  printf("  AXI reads:   %llu\n", (unsigned long long)stat_reads);
+  printf("  Interrupts:  %llu\n", (unsigned long long)stat_irqs);
+  printf("  Handovers:   %llu (%.1f transactions per handover)\n",
+         (unsigned long long)stat_handovers,
+         stat_handovers ? (double)(stat_writes + stat_reads) / stat_handovers : 0.0);
+}
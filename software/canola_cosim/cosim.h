@@ -0,0 +1,57 @@
+/**
+ * @file   cosim.h
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Bridge between the Zynq test firmware and the GHDL simulation of
+ *         the Canola AXI slaves in canola_cosim_tb.vhd.
+ *
+ *         The firmware runs on its own thread, and the simulation and the
+ *         firmware take turns. Register writes are queued and handed to the
+ *         simulation in batches, which performs them as AXI-lite
+ *         transactions. Only reads, sleeps and full batches hand over
+ *         control to the simulation, and interrupt edges seen in the
+ *         simulation are delivered to the connected handlers when the
+ *         firmware gets control back.
+ */
+
+#ifndef COSIM_H
+#define COSIM_H
+
+#include <stdint.h>
+
+#define COSIM_BATCH_SIZE 256
+#define COSIM_IRQ_LINES  12
+
+// Operations in a batch, must match canola_cosim_pkg.vhd
+#define COSIM_OP_WRITE    0 // AXI-lite write of data to addr
+#define COSIM_OP_READ     1 // AXI-lite read from addr, result returned in data
+#define COSIM_OP_WAIT     2 // Wait data us, or until an interrupt edge
+#define COSIM_OP_IDLE     3 // Wait data clock cycles
+#define COSIM_OP_TX_FAULT 4 // Disconnect CAN_TX from the bus for the controllers in data
+
+// Called from the simulation through VHPIDIRECT
+int32_t cosim_sync(int32_t irq_edges, int32_t now_us);
+void cosim_get_op(int32_t index, int32_t *kind, int32_t *addr, int32_t *data);
+void cosim_put_read(int32_t index, int32_t data);
+
+// Called from the firmware, through the BSP headers in bsp/
+void cosim_write(uint32_t addr, uint32_t data);
+uint32_t cosim_read(uint32_t addr);
+void cosim_sleep_us(uint64_t us);
+void cosim_idle(uint32_t cycles);
+void cosim_set_can_tx_fault(uint32_t ctrl_mask);
+uint64_t cosim_time_us(void);
+void cosim_irq_connect(uint32_t id, void (*handler)(void *), void *data);
+void cosim_irq_enable(uint32_t id, int enable);
+void cosim_irq_mask(int masked);
+int cosim_cpsr_irq_masked(void);
+void cosim_cpsr_set_irq_masked(int masked);
+
+// Firmware to run on the firmware thread when the simulation starts
+void cosim_set_firmware(void (*firmware)(void));
+void cosim_print_stats(void);
+
+// Switches and buttons on the GPIO inputs, provided by cosim_main.c
+uint32_t cosim_gpio_input(uint16_t device_id, unsigned int channel);
+
+#endif
@@ -0,0 +1,138 @@
+/**
+ * @file   cosim_bsp.c
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Interrupt controller and GPIO driver functions from the Xilinx BSP,
+ *         for the firmware in the GHDL co-simulation
+ */
+
+#include "cosim.h"
+#include "xscugic.h"
+#include "xgpio.h"
+#include "xparameters.h"
+#include "canola_latency.h"
+#include <stddef.h>
+
+// Clock cycles of an AXI GPIO read, so polling the switches advances time
+#define GPIO_READ_CYCLES 8
+
+static XScuGic_Config GicConfig = {
+  .DeviceId = XPAR_SCUGIC_SINGLE_DEVICE_ID,
+  .CpuBaseAddress = 0xF8F00100U,
+  .DistBaseAddress = 0xF8F01000U
+};
+
+
+XScuGic_Config *XScuGic_LookupConfig(u16 DeviceId)
+{
+  return DeviceId == XPAR_SCUGIC_SINGLE_DEVICE_ID ? &GicConfig : NULL;
+}
+
+s32 XScuGic_CfgInitialize(XScuGic *InstancePtr, XScuGic_Config *ConfigPtr,
+                          u32 EffectiveAddr)
+{
+  (void)EffectiveAddr;
+  InstancePtr->Config = ConfigPtr;
+  InstancePtr->IsReady = XIL_COMPONENT_IS_READY;
+  return XST_SUCCESS;
+}
+
+s32 XScuGic_Connect(XScuGic *InstancePtr, u32 Int_Id,
+                    Xil_InterruptHandler Handler, void *CallBackRef)
+{
+  (void)InstancePtr;
+  if(Int_Id >= XSCUGIC_MAX_NUM_INTR_INPUTS)
+    return XST_FAILURE;
+
+  cosim_irq_connect(Int_Id, Handler, CallBackRef);
+  return XST_SUCCESS;
+}
+
+void XScuGic_Enable(XScuGic *InstancePtr, u32 Int_Id)
+{
+  (void)InstancePtr;
+  cosim_irq_enable(Int_Id, 1);
+}
+
+void XScuGic_Disable(XScuGic *InstancePtr, u32 Int_Id)
+{
+  (void)InstancePtr;
+  cosim_irq_enable(Int_Id, 0);
+}
+
+// The simulation reports rising edges, and all CPU interrupts go to the
+// firmware thread, so there is nothing to configure
+void XScuGic_SetPriorityTriggerType(XScuGic *InstancePtr, u32 Int_Id,
+                                    u8 Priority, u8 Trigger)
+{
+  (void)InstancePtr;
+  (void)Int_Id;
+  (void)Priority;
+  (void)Trigger;
+}
+
+void XScuGic_InterruptMaptoCpu(XScuGic *InstancePtr, u8 Cpu_Id, u32 Int_Id)
+{
+  (void)InstancePtr;
+  (void)Cpu_Id;
+  (void)Int_Id;
+}
+
+void XScuGic_InterruptHandler(XScuGic *InstancePtr)
+{
+  (void)InstancePtr;
+}
+
+
+int XGpio_Initialize(XGpio *InstancePtr, u16 DeviceId)
+{
+  InstancePtr->DeviceId = DeviceId;
+  InstancePtr->IsReady = XIL_COMPONENT_IS_READY;
+  InstancePtr->Data[0] = 0;
+  InstancePtr->Data[1] = 0;
+  return XST_SUCCESS;
+}
+
+void XGpio_SetDataDirection(XGpio *InstancePtr, unsigned Channel, u32 DirectionMask)
+{
+  (void)InstancePtr;
+  (void)Channel;
+  (void)DirectionMask;
+}
+
+u32 XGpio_DiscreteRead(XGpio *InstancePtr, unsigned Channel)
+{
+  cosim_idle(GPIO_READ_CYCLES);
+  return cosim_gpio_input(InstancePtr->DeviceId, Channel);
+}
+
+void XGpio_DiscreteWrite(XGpio *InstancePtr, unsigned Channel, u32 Mask)
+{
+  if(Channel == 1 || Channel == 2)
+    InstancePtr->Data[Channel-1] = Mask;
+}
+
+void XGpio_InterruptEnable(XGpio *InstancePtr, u32 Mask)
+{
+  (void)InstancePtr;
+  (void)Mask;
+}
+
+void XGpio_InterruptGlobalEnable(XGpio *InstancePtr)
+{
+  (void)InstancePtr;
+}
+
+void XGpio_InterruptClear(XGpio *InstancePtr, u32 Mask)
+{
+  (void)InstancePtr;
+  (void)Mask;
+}
+
+
+// The cycle counter of the CPU for the latency histograms, from simulation
+// time. Only as fine as the handovers between firmware and simulation.
+uint32_t canola_latency_cycles(void)
+{
+  return (uint32_t)(cosim_time_us() * (XPAR_CPU_CORTEXA9_0_CPU_CLK_FREQ_HZ / 1000000U));
+}
@@ -0,0 +1,176 @@
+/**
+ * @file   cosim_main.c
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Runs the Zynq test firmware for the Canola CAN controller against
+ *         the RTL, in a GHDL simulation of canola_cosim_tb.vhd.
+ *
+ *         Usage: canola_cosim [manual|continuous|sequence|latency|busoff] [run_time_ms] [GHDL options]
+ *
+ *         The test is selected with the switches like on the ZYBO board,
+ *         and the switches are turned off after the run time (simulation
+ *         time), which ends the test. In the manual test the buttons are
+ *         pressed in turn.
+ *
+ *         The busoff test needs a fault on the bus, and is only available
+ *         here: It checks that the Tx queue of a controller sends the rest
+ *         of its messages after the controller has recovered from bus off.
+ */
+
+#include "cosim.h"
+#include "canola.h"
+#include "canola_tests.h"
+#include "canola_tx_queue.h"
+#include "gpio.h"
+#include "xparameters.h"
+#include "sleep.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern int ghdl_main(int argc, char **argv);
+
+static uint32_t test_switches = 0x04;
+static uint64_t run_time_us = 50000;
+static unsigned int button_presses = 0;
+static bool busoff_test_en = false;
+static unsigned int test_errors = 0;
+
+
+uint32_t cosim_gpio_input(uint16_t device_id, unsigned int channel)
+{
+  if(device_id != XPAR_GPIO_0_DEVICE_ID)
+    return 0;
+
+  if(channel == GPIO_SW_CHANNEL)
+    return cosim_time_us() < run_time_us ? test_switches : 0;
+
+  if(channel == GPIO_BTN_CHANNEL)
+    return 1U << (button_presses++ % 4);
+
+  return 0;
+}
+
+static void busoff_check(bool ok, const char *what)
+{
+  if(!ok) {
+    printf("Bus off test: %s\n\r", what);
+    test_errors++;
+  }
+}
+
+/**
+ * CAN_TX of controller 0 is disconnected from the bus while its Tx queue is
+ * kept full, so that every frame it sends fails with a bit error until it
+ * goes bus off. The controller ignores TX_START while bus off, and the
+ * queue must not wait for a Tx done or Tx failed interrupt that never
+ * comes. When CAN_TX is connected again the controller recovers after 128
+ * sequences of 11 recessive bits, and the messages left in the queue must
+ * be sent.
+ */
+static void busoff_recovery_test(void)
+{
+  const canola_tx_queue_t *queue = &canola_tx_queues[0];
+
+  printf("Starting bus off recovery test\n\r");
+
+  cosim_set_can_tx_fault(0x1);
+
+  uint64_t deadline = cosim_time_us() + 10000;
+  while(!canola_is_bus_off(0) && cosim_time_us() < deadline) {
+    while(canola_tx_queue_count(0) < CANOLA_TX_QUEUE_SIZE) {
+      can_msg_t msg = canola_generate_rand_msg();
+      canola_tx_queue_send(0, &msg);
+    }
+    usleep(100);
+  }
+  busoff_check(canola_is_bus_off(0), "Controller 0 did not go bus off");
+
+  // Let the last failed frame be handled
+  usleep(200);
+  canola_tx_queue_print_stats(0);
+  busoff_check(!queue->tx_active, "Tx queue waits for a message the controller did not start");
+  busoff_check(queue->not_started_count > 0, "No message was refused while bus off");
+
+  const unsigned int queued = canola_tx_queue_count(0);
+  const uint32_t sent_count = queue->sent_count;
+  const uint32_t failed_count = queue->failed_count;
+  busoff_check(queued > 0, "No messages left in Tx queue");
+
+  cosim_set_can_tx_fault(0x0);
+
+  deadline = cosim_time_us() + 5000;
+  while(canola_is_bus_off(0) && cosim_time_us() < deadline)
+    usleep(100);
+  busoff_check(!canola_is_bus_off(0), "Controller 0 did not recover from bus off");
+
+  // The Tx interrupts stopped while bus off, polling starts the queue again
+  deadline = cosim_time_us() + 5000;
+  while((canola_tx_queue_count(0) > 0 || queue->tx_active) && cosim_time_us() < deadline) {
+    canola_tx_queue_poll(0);
+    usleep(100);
+  }
+  canola_tx_queue_print_stats(0);
+  busoff_check(canola_tx_queue_count(0) == 0, "Tx queue not emptied after bus off");
+  busoff_check(queue->sent_count - sent_count == queued, "Not all queued messages were sent");
+  busoff_check(queue->failed_count == failed_count, "Messages failed after bus off");
+
+  printf("Bus off recovery test: %s (%u errors)\n\r", test_errors == 0 ? "OK" : "FAILED",
+         test_errors);
+}
+
+// Like main() in main.c, but runs the selected test once instead of
+// polling the switches forever
+static void firmware(void)
+{
+  canola_tests_init();
+
+  if(busoff_test_en)
+    busoff_recovery_test();
+  else
+    canola_run_test(test_switches, 0);
+
+  for(unsigned int i = 0; i < 4; i++)
+    canola_print_status_regs(i);
+
+  printf("Exiting...\n\r");
+}
+
+int main(int argc, char **argv)
+{
+  int argn = 1;
+
+  if(argn < argc && argv[argn][0] != '-') {
+    if(strcmp(argv[argn], "manual") == 0) {
+      test_switches = 0x01;
+    } else if(strcmp(argv[argn], "continuous") == 0) {
+      test_switches = 0x02;
+    } else if(strcmp(argv[argn], "sequence") == 0) {
+      test_switches = 0x04;
+    } else if(strcmp(argv[argn], "latency") == 0) {
+      test_switches = 0x08;
+    } else if(strcmp(argv[argn], "busoff") == 0) {
+      test_switches = 0x00;
+      busoff_test_en = true;
+    } else {
+      printf("Usage: %s [manual|continuous|sequence|latency|busoff] [run_time_ms] [GHDL options]\n", argv[0]);
+      return 1;
+    }
+    argn++;
+  }
+
+  if(argn < argc && argv[argn][0] != '-') {
+    run_time_us = 1000ULL * strtoull(argv[argn], NULL, 0);
+    argn++;
+  }
+
+  // Pass the remaining arguments on to the simulation
+  argv[argn-1] = argv[0];
+
+  cosim_set_firmware(firmware);
+  int status = ghdl_main(argc - argn + 1, &argv[argn-1]);
+
+  cosim_print_stats();
+  return test_errors > 0 ? 1 : status;
+}
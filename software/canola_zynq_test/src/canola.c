@@ -9,6 +9,8 @@
 
 #include "canola.h"
 #include "canola_axi_slave.h"
+#include "canola_bit_timing.h"
+#include "canola_latency.h"
 #include "xil_io.h"
 #include "xil_printf.h"
 #include "xparameters.h"
@@ -39,24 +41,42 @@ UINTPTR canola_get_base_addr(unsigned int canola_dev_id)
 }
 
 
-void canola_print_status_regs(unsigned int canola_dev_id)
+_Static_assert(RX_STUFF_ERROR_COUNT_OFFSET == TX_MSG_SENT_COUNT_OFFSET+4*(CANOLA_NUM_COUNTERS-1),
+               "Counter registers are not contiguous");
+
+void canola_read_counters(unsigned int canola_dev_id, canola_counters_t *counters)
 {
   UINTPTR canola_baseaddr = canola_get_base_addr(canola_dev_id);
 
+  counters->status = Xil_In32(canola_baseaddr+STATUS_OFFSET);
+  counters->transmit_error_count = Xil_In32(canola_baseaddr+TRANSMIT_ERROR_COUNT_OFFSET);
+  counters->receive_error_count = Xil_In32(canola_baseaddr+RECEIVE_ERROR_COUNT_OFFSET);
+
+  for(unsigned int i = 0; i < CANOLA_NUM_COUNTERS; i++)
+    counters->count[i] = Xil_In32(canola_baseaddr+TX_MSG_SENT_COUNT_OFFSET+4*i);
+}
+
+void canola_print_status_regs(unsigned int canola_dev_id)
+{
+  static const char *counter_names[CANOLA_NUM_COUNTERS] = {
+    "TX_MSG_SENT_COUNT", "TX_FAILED_COUNT", "TX_ACK_ERROR_COUNT", "TX_ARB_LOST_COUNT",
+    "TX_BIT_ERROR_COUNT", "TX_RETRANSMIT_COUNT", "RX_MSG_RECV_COUNT", "RX_CRC_ERROR_COUNT",
+    "RX_FORM_ERROR_COUNT", "RX_STUFF_ERROR_COUNT"
+  };
+  canola_counters_t counters;
+
+  // Read everything first, so the values are from the same moment and not
+  // spread out over the time it takes to print them
+  canola_read_counters(canola_dev_id, &counters);
+
   printf("\n\rDevice %d:", canola_dev_id);
   printf("\n\r-------------\n\r");
-  printf("STATUS: %#010x\n\r", (unsigned int)Xil_In32(canola_baseaddr+STATUS_OFFSET));
-  printf("TRANSMIT_ERROR_COUNT: %d\n\r", (unsigned int)Xil_In32(canola_baseaddr+TRANSMIT_ERROR_COUNT_OFFSET));
-  printf("RECEIVE_ERROR_COUNT: %d\n\r", (unsigned int)Xil_In32(canola_baseaddr+RECEIVE_ERROR_COUNT_OFFSET));
-  printf("TX_MSG_SENT_COUNT: %d\n\r", (unsigned int)Xil_In32(canola_baseaddr+TX_MSG_SENT_COUNT_OFFSET));
-  printf("TX_ACK_ERROR_COUNT: %d\n\r", (unsigned int)Xil_In32(canola_baseaddr+TX_ACK_ERROR_COUNT_OFFSET));
-  printf("TX_ARB_LOST_COUNT: %d\n\r", (unsigned int)Xil_In32(canola_baseaddr+TX_ARB_LOST_COUNT_OFFSET));
-  printf("TX_BIT_ERROR_COUNT: %d\n\r", (unsigned int)Xil_In32(canola_baseaddr+TX_BIT_ERROR_COUNT_OFFSET));
-  printf("TX_RETRANSMIT_COUNT: %d\n\r", (unsigned int)Xil_In32(canola_baseaddr+TX_RETRANSMIT_COUNT_OFFSET));
-  printf("RX_MSG_RECV_COUNT: %d\n\r", (unsigned int)Xil_In32(canola_baseaddr+RX_MSG_RECV_COUNT_OFFSET));
-  printf("RX_CRC_ERROR_COUNT: %d\n\r", (unsigned int)Xil_In32(canola_baseaddr+RX_CRC_ERROR_COUNT_OFFSET));
-  printf("RX_FORM_ERROR_COUNT: %d\n\r", (unsigned int)Xil_In32(canola_baseaddr+RX_FORM_ERROR_COUNT_OFFSET));
-  printf("RX_STUFF_ERROR_COUNT: %d\n\r", (unsigned int)Xil_In32(canola_baseaddr+RX_STUFF_ERROR_COUNT_OFFSET));
+  printf("STATUS: %#010x\n\r", (unsigned int)counters.status);
+  printf("TRANSMIT_ERROR_COUNT: %d\n\r", (unsigned int)counters.transmit_error_count);
+  printf("RECEIVE_ERROR_COUNT: %d\n\r", (unsigned int)counters.receive_error_count);
+
+  for(unsigned int i = 0; i < CANOLA_NUM_COUNTERS; i++)
+    printf("%s: %u\n\r", counter_names[i], (unsigned int)counters.count[i]);
 }
 
 void canola_print_ctrl_regs(unsigned int canola_dev_id)
@@ -77,17 +97,25 @@ void canola_init(unsigned int canola_dev_id)
 {
   UINTPTR canola_baseaddr = canola_get_base_addr(canola_dev_id);
 
-  Xil_Out32(canola_baseaddr+TIME_QUANTA_CLOCK_SCALE_OFFSET, 9);
+  // Bit timing from canola_bit_timing.h, generated with
+  // software/cpp/tools/canola_bit_timing header
+  Xil_Out32(canola_baseaddr+TIME_QUANTA_CLOCK_SCALE_OFFSET, CANOLA_TIME_QUANTA_CLOCK_SCALE);
+  Xil_Out32(canola_baseaddr+BTL_PROP_SEG_OFFSET, CANOLA_BTL_PROP_SEG);
+  Xil_Out32(canola_baseaddr+BTL_PHASE_SEG1_OFFSET, CANOLA_BTL_PHASE_SEG1);
+  Xil_Out32(canola_baseaddr+BTL_PHASE_SEG2_OFFSET, CANOLA_BTL_PHASE_SEG2);
+  Xil_Out32(canola_baseaddr+BTL_SYNC_JUMP_WIDTH_OFFSET, CANOLA_BTL_SYNC_JUMP_WIDTH);
 }
 
-void canola_send_msg(unsigned int canola_dev_id, can_msg_t msg)
+/**
+ * Write msg to the TX registers. Used for both the TX_START and the Tx mailbox
+ * interface.
+ */
+static void canola_write_tx_regs(UINTPTR canola_baseaddr, can_msg_t msg)
 {
   uint32_t canola_tx_msg_id_reg = 0;
   uint32_t canola_tx_payload_0_reg = 0;
   uint32_t canola_tx_payload_1_reg = 0;
 
-  UINTPTR canola_baseaddr = canola_get_base_addr(canola_dev_id);
-
   // Set up arbitration ID register data
   canola_tx_msg_id_reg = (msg.arb_id_a << TX_MSG_ID_ARB_ID_A_OFFSET) |
     (msg.arb_id_b << TX_MSG_ID_ARB_ID_B_OFFSET);
@@ -112,10 +140,23 @@ void canola_send_msg(unsigned int canola_dev_id, can_msg_t msg)
     (msg.payload[6] << 16) |
     (msg.payload[7] << 24);
 
-  // Write payload and payload length registers
-  Xil_Out32(canola_baseaddr+TX_PAYLOAD_0_OFFSET, canola_tx_payload_0_reg);
-  Xil_Out32(canola_baseaddr+TX_PAYLOAD_1_OFFSET, canola_tx_payload_1_reg);
+  // Write payload and payload length registers.
+  // Payload registers that are not covered by the data length are not
+  // transmitted, and are skipped to save bus transactions.
+  if(!msg.remote_frame && msg.data_length > 0)
+    Xil_Out32(canola_baseaddr+TX_PAYLOAD_0_OFFSET, canola_tx_payload_0_reg);
+  if(!msg.remote_frame && msg.data_length > 4)
+    Xil_Out32(canola_baseaddr+TX_PAYLOAD_1_OFFSET, canola_tx_payload_1_reg);
   Xil_Out32(canola_baseaddr+TX_PAYLOAD_LENGTH_OFFSET, msg.data_length);
+}
+
+void canola_send_msg(unsigned int canola_dev_id, can_msg_t msg)
+{
+  UINTPTR canola_baseaddr = canola_get_base_addr(canola_dev_id);
+
+  CANOLA_LATENCY_TX_START(canola_dev_id, &msg);
+
+  canola_write_tx_regs(canola_baseaddr, msg);
 
   // Write to TX_START bit of control register to initiate transaction
   Xil_Out32(canola_baseaddr+CONTROL_OFFSET, (0x1 << CONTROL_TX_START_OFFSET));
@@ -129,8 +170,17 @@ can_msg_t canola_get_msg(unsigned int canola_dev_id)
 
   unsigned int rx_msg_id_reg      = (unsigned int)Xil_In32(canola_baseaddr+RX_MSG_ID_OFFSET);
   unsigned int rx_payload_len_reg = (unsigned int)Xil_In32(canola_baseaddr+RX_PAYLOAD_LENGTH_OFFSET);
-  unsigned int rx_payload_0_reg   = (unsigned int)Xil_In32(canola_baseaddr+RX_PAYLOAD_0_OFFSET);
-  unsigned int rx_payload_1_reg   = (unsigned int)Xil_In32(canola_baseaddr+RX_PAYLOAD_1_OFFSET);
+  unsigned int rx_payload_0_reg   = 0;
+  unsigned int rx_payload_1_reg   = 0;
+
+  // Only read the payload registers that are covered by the data length,
+  // the remaining bytes are set to zero below anyway
+  if((rx_msg_id_reg & RX_MSG_ID_RTR_EN_MASK) == 0) {
+    if(rx_payload_len_reg > 0)
+      rx_payload_0_reg = (unsigned int)Xil_In32(canola_baseaddr+RX_PAYLOAD_0_OFFSET);
+    if(rx_payload_len_reg > 4)
+      rx_payload_1_reg = (unsigned int)Xil_In32(canola_baseaddr+RX_PAYLOAD_1_OFFSET);
+  }
 
   msg.arb_id_a = (rx_msg_id_reg & RX_MSG_ID_ARB_ID_A_MASK) >> RX_MSG_ID_ARB_ID_A_OFFSET;
 
@@ -143,6 +193,7 @@ can_msg_t canola_get_msg(unsigned int canola_dev_id)
   }
 
   msg.data_length = rx_payload_len_reg;
+  msg.timestamp = Xil_In32(canola_baseaddr+RX_TIMESTAMP_OFFSET);
 
   if(((rx_msg_id_reg & RX_MSG_ID_RTR_EN_MASK) >> RX_MSG_ID_RTR_EN_OFFSET) == 1) {
     msg.remote_frame = true;
@@ -167,6 +218,8 @@ can_msg_t canola_get_msg(unsigned int canola_dev_id)
     }
   }
 
+  CANOLA_LATENCY_RX_READ(canola_dev_id, &msg);
+
   return msg;
 }
 
@@ -174,7 +227,8 @@ can_msg_t canola_get_msg(unsigned int canola_dev_id)
 bool canola_compare_messages(can_msg_t msg1, can_msg_t msg2)
 {
   if(msg1.arb_id_a != msg2.arb_id_a) {
-    printf("Arb ID A mismatch: %lx vs %lx\n\r", msg1.arb_id_a, msg2.arb_id_a);
+    printf("Arb ID A mismatch: %lx vs %lx\n\r", (unsigned long)msg1.arb_id_a,
+           (unsigned long)msg2.arb_id_a);
     return false;
   }
 
@@ -185,7 +239,8 @@ bool canola_compare_messages(can_msg_t msg1, can_msg_t msg2)
 
   if(msg1.ext_id) {
     if(msg1.arb_id_b != msg2.arb_id_b) {
-      printf("Arb ID B mismatch: %lx vs %lx\n\r", msg1.arb_id_b, msg2.arb_id_b);
+      printf("Arb ID B mismatch: %lx vs %lx\n\r", (unsigned long)msg1.arb_id_b,
+             (unsigned long)msg2.arb_id_b);
       return false;
     }
   }
@@ -218,10 +273,10 @@ void canola_print_msg(can_msg_t msg)
   printf("Ext ID: %s\n\r", msg.ext_id ? "true" : "false");
   printf("RTR: %s\n\r", msg.remote_frame ? "true" : "false");
   printf("DLC: %d\n\r", msg.data_length);
-  printf("Arb ID A: %lx\n\r", msg.arb_id_a);
+  printf("Arb ID A: %lx\n\r", (unsigned long)msg.arb_id_a);
 
   if(msg.ext_id)
-    printf("Arb ID B: %lx\n\r", msg.arb_id_b);
+    printf("Arb ID B: %lx\n\r", (unsigned long)msg.arb_id_b);
 
   if(!msg.remote_frame) {
     for(unsigned int i = 0; i < 8; i++)
@@ -240,6 +295,7 @@ can_msg_t canola_generate_rand_msg(void)
   msg_out.ext_id = (rand() % 2) == 1 ? true : false;
   msg_out.remote_frame = (rand() % 2) == 1 ? true : false;
   msg_out.data_length = (rand() % 9);
+  msg_out.timestamp = 0;
 
   for(unsigned int i = 0; i < msg_out.data_length; i++) {
     if(i >= msg_out.data_length || msg_out.remote_frame)
@@ -263,3 +319,244 @@ bool canola_is_busy(unsigned int canola_dev_id)
   else
     return true;
 }
+
+
+bool canola_is_bus_off(unsigned int canola_dev_id)
+{
+  UINTPTR canola_baseaddr = canola_get_base_addr(canola_dev_id);
+
+  unsigned int status_reg = (unsigned int)Xil_In32(canola_baseaddr+STATUS_OFFSET);
+
+  // ERROR_STATE: 0 = error active, 1 = error passive, b1X = bus off
+  return ((status_reg & STATUS_ERROR_STATE_MASK) >> STATUS_ERROR_STATE_OFFSET) >= 2;
+}
+
+
+uint32_t canola_get_timestamp(unsigned int canola_dev_id)
+{
+  return Xil_In32(canola_get_base_addr(canola_dev_id)+TIMESTAMP_OFFSET);
+}
+
+
+uint32_t canola_get_tx_timestamp(unsigned int canola_dev_id)
+{
+  return Xil_In32(canola_get_base_addr(canola_dev_id)+TX_TIMESTAMP_OFFSET);
+}
+
+
+void canola_set_acceptance_filter(unsigned int canola_dev_id, unsigned int filter_index,
+                                  can_msg_t id, can_msg_t mask, bool enable)
+{
+  UINTPTR canola_baseaddr = canola_get_base_addr(canola_dev_id);
+
+  uint32_t filter_id_reg = ((id.arb_id_a << FILTER_ID_ARB_ID_A_OFFSET) & FILTER_ID_ARB_ID_A_MASK) |
+    ((id.arb_id_b << FILTER_ID_ARB_ID_B_OFFSET) & FILTER_ID_ARB_ID_B_MASK);
+
+  uint32_t filter_mask_reg = ((mask.arb_id_a << FILTER_MASK_ARB_ID_A_OFFSET) & FILTER_MASK_ARB_ID_A_MASK) |
+    ((mask.arb_id_b << FILTER_MASK_ARB_ID_B_OFFSET) & FILTER_MASK_ARB_ID_B_MASK);
+
+  if(id.ext_id)
+    filter_id_reg |= FILTER_ID_EXT_ID_EN_MASK;
+  if(id.remote_frame)
+    filter_id_reg |= FILTER_ID_RTR_EN_MASK;
+  if(enable)
+    filter_id_reg |= FILTER_ID_ENABLE_MASK;
+
+  // For the mask, ext_id and remote_frame set means that the
+  // frame type and RTR bit must match the filter
+  if(mask.ext_id)
+    filter_mask_reg |= FILTER_MASK_EXT_ID_EN_MASK;
+  if(mask.remote_frame)
+    filter_mask_reg |= FILTER_MASK_RTR_EN_MASK;
+
+  Xil_Out32(canola_baseaddr+FILTER_INDEX_OFFSET, filter_index);
+  Xil_Out32(canola_baseaddr+FILTER_ID_OFFSET, filter_id_reg);
+  Xil_Out32(canola_baseaddr+FILTER_MASK_OFFSET, filter_mask_reg);
+
+  // Write to FILTER_WRITE bit of control register to update the filter
+  Xil_Out32(canola_baseaddr+CONTROL_OFFSET, (0x1 << CONTROL_FILTER_WRITE_OFFSET));
+}
+
+
+void canola_set_acceptance_filter_enable(unsigned int canola_dev_id, bool enable)
+{
+  UINTPTR canola_baseaddr = canola_get_base_addr(canola_dev_id);
+
+  uint32_t config_reg = Xil_In32(canola_baseaddr+CONFIG_OFFSET);
+
+  if(enable)
+    config_reg |= CONFIG_ACCEPTANCE_FILTER_EN_MASK;
+  else
+    config_reg &= ~CONFIG_ACCEPTANCE_FILTER_EN_MASK;
+
+  Xil_Out32(canola_baseaddr+CONFIG_OFFSET, config_reg);
+}
+
+
+unsigned int canola_get_filter_hit(unsigned int canola_dev_id)
+{
+  UINTPTR canola_baseaddr = canola_get_base_addr(canola_dev_id);
+
+  return (unsigned int)Xil_In32(canola_baseaddr+RX_FILTER_HIT_OFFSET);
+}
+
+
+/**
+ * Enable/disable the Rx FIFO. irq_level is the fill level at which the
+ * Rx valid interrupt is pulsed when a message is stored in the FIFO.
+ * Disabling the FIFO discards any messages in it.
+ */
+void canola_set_rx_fifo_enable(unsigned int canola_dev_id, bool enable, unsigned int irq_level)
+{
+  UINTPTR canola_baseaddr = canola_get_base_addr(canola_dev_id);
+
+  Xil_Out32(canola_baseaddr+RX_FIFO_IRQ_LEVEL_OFFSET, irq_level);
+
+  uint32_t config_reg = Xil_In32(canola_baseaddr+CONFIG_OFFSET);
+
+  if(enable)
+    config_reg |= CONFIG_RX_FIFO_EN_MASK;
+  else
+    config_reg &= ~CONFIG_RX_FIFO_EN_MASK;
+
+  Xil_Out32(canola_baseaddr+CONFIG_OFFSET, config_reg);
+}
+
+
+bool canola_rx_fifo_enabled(unsigned int canola_dev_id)
+{
+  UINTPTR canola_baseaddr = canola_get_base_addr(canola_dev_id);
+
+  return (Xil_In32(canola_baseaddr+CONFIG_OFFSET) & CONFIG_RX_FIFO_EN_MASK) != 0;
+}
+
+
+/**
+ * Read all messages in the Rx FIFO, up to max_msgs. The fill level is only
+ * read once, messages that arrive while draining are left for the next call.
+ * Returns the number of messages copied to msgs. If overflow is not NULL it
+ * is set if messages were dropped because the FIFO was full, and the
+ * overflow flag is cleared.
+ */
+unsigned int canola_rx_fifo_drain(unsigned int canola_dev_id, can_msg_t *msgs,
+                                  unsigned int max_msgs, bool *overflow)
+{
+  UINTPTR canola_baseaddr = canola_get_base_addr(canola_dev_id);
+
+  uint32_t status_reg = Xil_In32(canola_baseaddr+RX_FIFO_STATUS_OFFSET);
+  unsigned int count = (status_reg & RX_FIFO_STATUS_FILL_LEVEL_MASK) >> RX_FIFO_STATUS_FILL_LEVEL_OFFSET;
+
+  if(count > max_msgs)
+    count = max_msgs;
+
+  for(unsigned int i = 0; i < count; i++) {
+    msgs[i] = canola_get_msg(canola_dev_id);
+    Xil_Out32(canola_baseaddr+CONTROL_OFFSET, CONTROL_RX_FIFO_POP_MASK);
+  }
+
+  if(overflow != NULL) {
+    *overflow = (status_reg & RX_FIFO_STATUS_OVERFLOW_MASK) != 0;
+
+    if(*overflow)
+      Xil_Out32(canola_baseaddr+CONTROL_OFFSET, CONTROL_RX_FIFO_CLEAR_OVERFLOW_MASK);
+  }
+
+  return count;
+}
+
+
+/**
+ * Enable/disable the Tx mailboxes. With the mailboxes enabled, messages are
+ * only sent from the mailboxes, and TX_START (canola_send_msg()) is ignored.
+ * Disabling the mailboxes discards any pending messages.
+ */
+void canola_set_tx_mailbox_enable(unsigned int canola_dev_id, bool enable)
+{
+  UINTPTR canola_baseaddr = canola_get_base_addr(canola_dev_id);
+
+  uint32_t config_reg = Xil_In32(canola_baseaddr+CONFIG_OFFSET);
+
+  if(enable)
+    config_reg |= CONFIG_TX_MAILBOX_EN_MASK;
+  else
+    config_reg &= ~CONFIG_TX_MAILBOX_EN_MASK;
+
+  Xil_Out32(canola_baseaddr+CONFIG_OFFSET, config_reg);
+}
+
+
+unsigned int canola_tx_mailbox_count(unsigned int canola_dev_id)
+{
+  UINTPTR canola_baseaddr = canola_get_base_addr(canola_dev_id);
+
+  return (unsigned int)Xil_In32(canola_baseaddr+TX_MAILBOX_COUNT_OFFSET);
+}
+
+
+/**
+ * Find a Tx mailbox that is not pending. Returns the lowest numbered free
+ * mailbox, or -1 if all mailboxes are pending.
+ * The done/failed status of the mailbox is lost when it is loaded.
+ */
+int canola_tx_mailbox_alloc(unsigned int canola_dev_id)
+{
+  UINTPTR canola_baseaddr = canola_get_base_addr(canola_dev_id);
+
+  unsigned int count = (unsigned int)Xil_In32(canola_baseaddr+TX_MAILBOX_COUNT_OFFSET);
+  uint32_t pending = Xil_In32(canola_baseaddr+TX_MAILBOX_PENDING_OFFSET);
+
+  for(unsigned int i = 0; i < count; i++) {
+    if((pending & (0x1u << i)) == 0)
+      return i;
+  }
+
+  return -1;
+}
+
+
+/**
+ * Load msg into a Tx mailbox. The pending mailbox with the highest priority
+ * (lowest ID) is always sent first. Returns false if the mailbox is pending,
+ * in which case it is not loaded.
+ */
+bool canola_tx_mailbox_send(unsigned int canola_dev_id, unsigned int mailbox, can_msg_t msg)
+{
+  UINTPTR canola_baseaddr = canola_get_base_addr(canola_dev_id);
+
+  if(Xil_In32(canola_baseaddr+TX_MAILBOX_PENDING_OFFSET) & (0x1u << mailbox))
+    return false;
+
+  canola_write_tx_regs(canola_baseaddr, msg);
+
+  Xil_Out32(canola_baseaddr+TX_MAILBOX_INDEX_OFFSET, mailbox);
+  Xil_Out32(canola_baseaddr+CONTROL_OFFSET, CONTROL_TX_MAILBOX_LOAD_MASK);
+
+  return true;
+}
+
+
+/**
+ * Abort the pending mailboxes in mailbox_mask (one bit per mailbox).
+ * A mailbox that is being sent is aborted if the attempt fails, and is
+ * reported as done if it succeeds.
+ */
+void canola_tx_mailbox_abort(unsigned int canola_dev_id, uint32_t mailbox_mask)
+{
+  UINTPTR canola_baseaddr = canola_get_base_addr(canola_dev_id);
+
+  Xil_Out32(canola_baseaddr+TX_MAILBOX_ABORT_OFFSET, mailbox_mask);
+}
+
+
+void canola_tx_mailbox_status(unsigned int canola_dev_id, uint32_t *pending,
+                              uint32_t *done, uint32_t *failed)
+{
+  UINTPTR canola_baseaddr = canola_get_base_addr(canola_dev_id);
+
+  if(pending != NULL)
+    *pending = Xil_In32(canola_baseaddr+TX_MAILBOX_PENDING_OFFSET);
+  if(done != NULL)
+    *done = Xil_In32(canola_baseaddr+TX_MAILBOX_DONE_OFFSET);
+  if(failed != NULL)
+    *failed = Xil_In32(canola_baseaddr+TX_MAILBOX_FAILED_OFFSET);
+}
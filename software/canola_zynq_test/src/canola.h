@@ -23,10 +23,27 @@ typedef struct {
   bool ext_id;
   uint8_t payload[8];
   uint8_t data_length;
+
+  // RX_TIMESTAMP of a received message, in clock cycles of the controller.
+  // Not used when sending.
+  uint32_t timestamp;
 } can_msg_t;
 
+// Snapshot of the status and counter registers of a controller, read back
+// to back by canola_read_counters(). The counters are in register order,
+// TX_MSG_SENT_COUNT to RX_STUFF_ERROR_COUNT.
+#define CANOLA_NUM_COUNTERS 10
+
+typedef struct {
+  uint32_t status;
+  uint32_t transmit_error_count;
+  uint32_t receive_error_count;
+  uint32_t count[CANOLA_NUM_COUNTERS];
+} canola_counters_t;
+
 
 UINTPTR canola_get_base_addr(unsigned int canola_dev_id);
+void canola_read_counters(unsigned int canola_dev_id, canola_counters_t *counters);
 void canola_print_status_regs(unsigned int canola_dev_id);
 void canola_print_ctrl_regs(unsigned int canola_dev_id);
 void canola_init(unsigned int canola_dev_id);
@@ -36,5 +53,43 @@ bool canola_compare_messages(can_msg_t msg1, can_msg_t msg2);
 void canola_print_msg(can_msg_t msg);
 can_msg_t canola_generate_rand_msg(void);
 bool canola_is_busy(unsigned int canola_dev_id);
+bool canola_is_bus_off(unsigned int canola_dev_id);
+
+// Timestamps
+// Free-running counter in the controller, in clock cycles, which wraps
+// around after 2^32 cycles. The Tx timestamp is taken when the last message
+// sent was done. The Rx timestamp is in can_msg_t.
+uint32_t canola_get_timestamp(unsigned int canola_dev_id);
+uint32_t canola_get_tx_timestamp(unsigned int canola_dev_id);
+
+// Acceptance filters
+// A received message is accepted by a filter when the ID bits set in mask
+// are equal in the message and in id. Only accepted messages raise the
+// Rx interrupt when filtering is enabled.
+void canola_set_acceptance_filter(unsigned int canola_dev_id, unsigned int filter_index,
+                                  can_msg_t id, can_msg_t mask, bool enable);
+void canola_set_acceptance_filter_enable(unsigned int canola_dev_id, bool enable);
+unsigned int canola_get_filter_hit(unsigned int canola_dev_id);
+
+// Rx FIFO
+// With the Rx FIFO enabled, the RX registers show the oldest message in the
+// FIFO, and the Rx valid interrupt is pulsed when the fill level reaches
+// irq_level.
+void canola_set_rx_fifo_enable(unsigned int canola_dev_id, bool enable, unsigned int irq_level);
+bool canola_rx_fifo_enabled(unsigned int canola_dev_id);
+unsigned int canola_rx_fifo_drain(unsigned int canola_dev_id, can_msg_t *msgs,
+                                  unsigned int max_msgs, bool *overflow);
+
+// Tx mailboxes
+// With the Tx mailboxes enabled, the controller sends the pending mailbox
+// with the highest priority first. The done/failed status of a mailbox is
+// kept until it is loaded again.
+void canola_set_tx_mailbox_enable(unsigned int canola_dev_id, bool enable);
+unsigned int canola_tx_mailbox_count(unsigned int canola_dev_id);
+int canola_tx_mailbox_alloc(unsigned int canola_dev_id);
+bool canola_tx_mailbox_send(unsigned int canola_dev_id, unsigned int mailbox, can_msg_t msg);
+void canola_tx_mailbox_abort(unsigned int canola_dev_id, uint32_t mailbox_mask);
+void canola_tx_mailbox_status(unsigned int canola_dev_id, uint32_t *pending,
+                              uint32_t *done, uint32_t *failed);
 
 #endif
@@ -0,0 +1,291 @@
+/**
+ * @file   canola_filter.c
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Software acceptance filter for received CAN messages, the
+ *         firmware version of canola::FilterEngine in canola_filter.hpp.
+ */
+
+#include "canola_filter.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define STD_ID_MASK 0x7FF
+#define EXT_ID_MASK 0x1FFFFFFF
+
+typedef struct {
+  uint32_t first;
+  uint32_t last;
+} canola_filter_interval_t;
+
+typedef struct {
+  uint32_t std_bitmap[2048/32];
+
+  canola_filter_interval_t ext_intervals[CANOLA_FILTER_INTERVALS_MAX];
+  unsigned int num_ext_intervals;
+
+  canola_filter_rule_t ext_masked[CANOLA_FILTER_RULES_MAX];
+  unsigned int num_ext_masked;
+} canola_filter_table_t;
+
+static canola_filter_table_t filter_tables[2];
+static volatile unsigned int filter_active = 0;
+static volatile bool filter_enabled = false;
+
+
+static unsigned int popcount(uint32_t x)
+{
+  unsigned int n = 0;
+  for(; x != 0; x &= x - 1)
+    n++;
+  return n;
+}
+
+
+static void add_std_rule(canola_filter_table_t *table, uint32_t id, uint32_t mask)
+{
+  const uint32_t dont_care = ~mask & STD_ID_MASK;
+  const uint32_t base = id & mask;
+  uint32_t sub = 0;
+
+  // Enumerate all subsets of the don't care bits
+  do {
+    uint32_t std_id = base | sub;
+    table->std_bitmap[std_id >> 5] |= 1U << (std_id & 31);
+    sub = (sub - dont_care) & dont_care;
+  } while(sub != 0);
+}
+
+
+static void add_ext_rule(canola_filter_table_t *table, uint32_t id, uint32_t mask)
+{
+  const uint32_t dont_care = ~mask & EXT_ID_MASK;
+
+  // Don't care bits below the lowest mask bit give one contiguous interval,
+  // each combination of the don't care bits above it gives another interval
+  const uint32_t low = mask == 0 ? EXT_ID_MASK : (mask & -mask) - 1;
+  const uint32_t high = dont_care & ~low;
+  const uint32_t base = id & mask;
+
+  if((1U << popcount(high)) > CANOLA_FILTER_INTERVALS_PER_RULE) {
+    canola_filter_rule_t *rule = &table->ext_masked[table->num_ext_masked++];
+    rule->id = base;
+    rule->mask = mask;
+    rule->ext_id = true;
+    return;
+  }
+
+  uint32_t sub = 0;
+  do {
+    canola_filter_interval_t *iv = &table->ext_intervals[table->num_ext_intervals++];
+    iv->first = base | sub;
+    iv->last = base | sub | low;
+    sub = (sub - high) & high;
+  } while(sub != 0);
+}
+
+
+static int compare_intervals(const void *a, const void *b)
+{
+  const uint32_t first_a = ((const canola_filter_interval_t*)a)->first;
+  const uint32_t first_b = ((const canola_filter_interval_t*)b)->first;
+
+  return first_a < first_b ? -1 : first_a > first_b;
+}
+
+
+static void merge_intervals(canola_filter_table_t *table)
+{
+  canola_filter_interval_t *ivs = table->ext_intervals;
+  unsigned int n = 0;
+
+  qsort(ivs, table->num_ext_intervals, sizeof(ivs[0]), compare_intervals);
+
+  for(unsigned int i = 0; i < table->num_ext_intervals; i++) {
+    if(n > 0 && ivs[i].first <= (uint64_t)ivs[n-1].last + 1) {
+      if(ivs[i].last > ivs[n-1].last)
+        ivs[n-1].last = ivs[i].last;
+    } else {
+      ivs[n++] = ivs[i];
+    }
+  }
+
+  table->num_ext_intervals = n;
+}
+
+
+static bool match_ext(const canola_filter_table_t *table, uint32_t ext_id)
+{
+  // Find the last interval that starts at or below ext_id
+  unsigned int lo = 0;
+  unsigned int hi = table->num_ext_intervals;
+
+  while(lo < hi) {
+    unsigned int mid = (lo + hi) / 2;
+    if(table->ext_intervals[mid].first <= ext_id)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  if(lo > 0 && ext_id <= table->ext_intervals[lo-1].last)
+    return true;
+
+  for(unsigned int i = 0; i < table->num_ext_masked; i++) {
+    if(((ext_id ^ table->ext_masked[i].id) & table->ext_masked[i].mask) == 0)
+      return true;
+  }
+
+  return false;
+}
+
+
+/**
+ * Compile rules into the inactive table and switch to it, which enables
+ * filtering. Returns false, and leaves the filter unchanged, if there are
+ * more than CANOLA_FILTER_RULES_MAX rules. Only to be called from the main
+ * loop, not from interrupt handlers.
+ */
+bool canola_filter_set_rules(const canola_filter_rule_t *rules, unsigned int num_rules)
+{
+  if(num_rules > CANOLA_FILTER_RULES_MAX)
+    return false;
+
+  const unsigned int next = 1 - filter_active;
+  canola_filter_table_t *table = &filter_tables[next];
+
+  for(unsigned int i = 0; i < 2048/32; i++)
+    table->std_bitmap[i] = 0;
+  table->num_ext_intervals = 0;
+  table->num_ext_masked = 0;
+
+  for(unsigned int i = 0; i < num_rules; i++) {
+    if(rules[i].ext_id)
+      add_ext_rule(table, rules[i].id & EXT_ID_MASK, rules[i].mask & EXT_ID_MASK);
+    else
+      add_std_rule(table, rules[i].id & STD_ID_MASK, rules[i].mask & STD_ID_MASK);
+  }
+
+  merge_intervals(table);
+
+  // Table must be written before interrupt handlers can see it
+  __sync_synchronize();
+  filter_active = next;
+  filter_enabled = true;
+
+  return true;
+}
+
+
+/**
+ * Accept all messages
+ */
+void canola_filter_disable(void)
+{
+  filter_enabled = false;
+}
+
+
+bool canola_filter_accept(const can_msg_t *msg)
+{
+  if(!filter_enabled)
+    return true;
+
+  const canola_filter_table_t *table = &filter_tables[filter_active];
+
+  if(msg->ext_id) {
+    uint32_t ext_id = ((msg->arb_id_a & STD_ID_MASK) << 18) | (msg->arb_id_b & 0x3FFFF);
+    return match_ext(table, ext_id);
+  } else {
+    uint32_t std_id = msg->arb_id_a & STD_ID_MASK;
+    return (table->std_bitmap[std_id >> 5] >> (std_id & 31)) & 1;
+  }
+}
+
+
+static uint32_t rand32(void)
+{
+  return ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+}
+
+
+static bool brute_force(const canola_filter_rule_t *rules, unsigned int num_rules, const can_msg_t *msg)
+{
+  const uint32_t id_mask = msg->ext_id ? EXT_ID_MASK : STD_ID_MASK;
+  const uint32_t id = msg->ext_id ? ((msg->arb_id_a << 18) | msg->arb_id_b) : msg->arb_id_a;
+
+  for(unsigned int i = 0; i < num_rules; i++) {
+    if(rules[i].ext_id == msg->ext_id && ((id ^ rules[i].id) & rules[i].mask & id_mask) == 0)
+      return true;
+  }
+  return false;
+}
+
+
+/**
+ * Check the filter against a brute force evaluation of random rules, with
+ * the same kinds of rules as canola_filter_bench.cpp. Filtering is disabled
+ * afterwards. Returns the number of errors.
+ */
+unsigned int canola_filter_check(void)
+{
+  static canola_filter_rule_t rules[CANOLA_FILTER_RULES_MAX];
+  const unsigned int rule_counts[4] = {1, 16, 64, CANOLA_FILTER_RULES_MAX};
+  unsigned int errors = 0;
+
+  for(unsigned int n = 0; n < 4; n++) {
+    const unsigned int num_rules = rule_counts[n];
+
+    for(unsigned int i = 0; i < num_rules; i++) {
+      rules[i].ext_id = rand() % 2;
+      rules[i].id = rand32();
+
+      switch(rand() % 4) {
+      case 0: // Exact ID
+        rules[i].mask = EXT_ID_MASK;
+        break;
+      case 1: // ID range
+        rules[i].mask = EXT_ID_MASK << (rand() % 12);
+        break;
+      case 2: // Few don't care bits anywhere
+        rules[i].mask = EXT_ID_MASK & ~((1U << (rand() % 29)) | (1U << (rand() % 29)));
+        break;
+      default: // Random mask
+        rules[i].mask = rand32() | 0x1FF00000;
+      }
+    }
+
+    if(!canola_filter_set_rules(rules, num_rules))
+      errors++;
+
+    for(unsigned int i = 0; i < 1000; i++) {
+      can_msg_t msg = canola_generate_rand_msg();
+
+      // Make some messages hit a rule
+      if(rand() % 2) {
+        const canola_filter_rule_t *rule = &rules[rand() % num_rules];
+        uint32_t id = (rule->id & rule->mask) | (rand32() & ~rule->mask);
+
+        msg.ext_id = rule->ext_id;
+        msg.arb_id_a = msg.ext_id ? (id >> 18) & STD_ID_MASK : id & STD_ID_MASK;
+        msg.arb_id_b = msg.ext_id ? id & 0x3FFFF : 0;
+      }
+
+      if(canola_filter_accept(&msg) != brute_force(rules, num_rules, &msg))
+        errors++;
+    }
+  }
+
+  if(canola_filter_set_rules(rules, CANOLA_FILTER_RULES_MAX+1))
+    errors++;
+
+  canola_filter_disable();
+
+  for(unsigned int i = 0; i < 100; i++) {
+    can_msg_t msg = canola_generate_rand_msg();
+    if(!canola_filter_accept(&msg))
+      errors++;
+  }
+
+  return errors;
+}
@@ -0,0 +1,50 @@
+/**
+ * @file   canola_filter.h
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Software acceptance filter for received CAN messages, the
+ *         firmware version of canola::FilterEngine in canola_filter.hpp.
+ *
+ *         Up to CANOLA_FILTER_RULES_MAX ID/mask rules are compiled into a
+ *         2048-bit bitmap for standard IDs, and into sorted ID intervals for
+ *         extended IDs, with a linear list for masks that expand to more
+ *         than CANOLA_FILTER_INTERVALS_PER_RULE intervals.
+ *
+ *         There are two tables. canola_filter_set_rules() compiles the rules
+ *         into the table that is not in use, and then switches to it. It must
+ *         be called from the main loop. The Rx valid interrupt handlers only
+ *         read the active table, and the main loop can not run before they
+ *         return, so the rules are replaced without disabling interrupts.
+ *
+ *         The interrupt handlers filter one message at a time (or the few
+ *         messages in the Rx FIFO), so there is no SIMD batch lookup here.
+ */
+
+#ifndef CANOLA_FILTER_H
+#define CANOLA_FILTER_H
+
+#include "canola.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+// Same as C_ACCEPTANCE_FILTERS_MAX in canola_pkg.vhd
+#define CANOLA_FILTER_RULES_MAX 256
+
+#define CANOLA_FILTER_INTERVALS_PER_RULE 16
+#define CANOLA_FILTER_INTERVALS_MAX (CANOLA_FILTER_RULES_MAX*CANOLA_FILTER_INTERVALS_PER_RULE)
+
+// A message is accepted when the ID bits that are set in mask are equal to
+// the ones in id, and the frame type matches. For extended frames the ID is
+// the full 29-bit ID: (arb_id_a << 18) | arb_id_b
+typedef struct {
+  uint32_t id;
+  uint32_t mask;
+  bool ext_id;
+} canola_filter_rule_t;
+
+bool canola_filter_set_rules(const canola_filter_rule_t *rules, unsigned int num_rules);
+void canola_filter_disable(void);
+bool canola_filter_accept(const can_msg_t *msg);
+unsigned int canola_filter_check(void);
+
+#endif
@@ -0,0 +1,296 @@
+/**
+ * @file   canola_latency.c
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Latency histograms for the Tx and Rx paths of the Canola CAN
+ *         controllers, timed with the CPU cycle counter.
+ */
+
+#define CANOLA_LATENCY_C
+#include "canola_latency.h"
+#include "xparameters.h"
+#include <stdio.h>
+#include <string.h>
+
+
+/**
+ * Arbitration ID of a message as one number, with the extended ID flag in
+ * the MSB so that standard and extended IDs do not share a histogram.
+ */
+uint32_t canola_latency_arb_id(const can_msg_t *msg)
+{
+  if(msg->ext_id)
+    return 0x80000000U | (msg->arb_id_a << 18) | msg->arb_id_b;
+  else
+    return msg->arb_id_a;
+}
+
+
+unsigned int canola_latency_bucket(uint32_t cycles)
+{
+  if(cycles < CANOLA_LATENCY_SUB_COUNT)
+    return cycles;
+
+  // Position of the MSB selects the power of two, and the bits below it
+  // select one of the buckets within it
+  unsigned int msb = 31 - __builtin_clz(cycles);
+  unsigned int sub = (cycles >> (msb - CANOLA_LATENCY_SUB_BITS)) & (CANOLA_LATENCY_SUB_COUNT-1);
+
+  return (msb - CANOLA_LATENCY_SUB_BITS + 1) * CANOLA_LATENCY_SUB_COUNT + sub;
+}
+
+
+/**
+ * Midpoint of the range of cycle counts in a bucket
+ */
+uint32_t canola_latency_bucket_value(unsigned int bucket)
+{
+  if(bucket < CANOLA_LATENCY_SUB_COUNT)
+    return bucket;
+
+  unsigned int shift = bucket / CANOLA_LATENCY_SUB_COUNT - 1;
+  uint32_t sub = bucket % CANOLA_LATENCY_SUB_COUNT;
+  uint32_t lowest = (CANOLA_LATENCY_SUB_COUNT + sub) << shift;
+
+  return lowest + (((1U << shift) - 1) >> 1);
+}
+
+
+void canola_latency_record(canola_latency_hist_t *hist, uint32_t cycles)
+{
+  __atomic_fetch_add(&hist->buckets[canola_latency_bucket(cycles)], 1, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&hist->count, 1, __ATOMIC_RELAXED);
+
+  uint32_t min = __atomic_load_n(&hist->min, __ATOMIC_RELAXED);
+  while(cycles < min &&
+        !__atomic_compare_exchange_n(&hist->min, &min, cycles, true,
+                                     __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    ;
+
+  uint32_t max = __atomic_load_n(&hist->max, __ATOMIC_RELAXED);
+  while(cycles > max &&
+        !__atomic_compare_exchange_n(&hist->max, &max, cycles, true,
+                                     __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    ;
+}
+
+
+/**
+ * Cycle count that percentile (0 to 100) of the samples are at or below,
+ * to within the precision of a bucket. Returns zero for no samples.
+ */
+uint32_t canola_latency_percentile(const canola_latency_hist_t *hist, double percentile)
+{
+  uint32_t count = hist->count;
+
+  if(count == 0)
+    return 0;
+
+  // Rank of the sample, rounded up
+  uint64_t rank = (uint64_t)(percentile / 100.0 * count + 0.999999);
+  if(rank == 0)
+    rank = 1;
+
+  uint64_t seen = 0;
+  for(unsigned int i = 0; i < CANOLA_LATENCY_BUCKETS; i++) {
+    seen += hist->buckets[i];
+    if(seen >= rank) {
+      uint32_t value = canola_latency_bucket_value(i);
+
+      // Exact at the ends
+      if(value < hist->min)
+        return hist->min;
+      if(value > hist->max)
+        return hist->max;
+      return value;
+    }
+  }
+
+  return hist->max;
+}
+
+
+#if CANOLA_LATENCY_EN
+
+canola_latency_t canola_latency;
+
+static const char *path_names[CANOLA_LATENCY_PATHS] = {
+  "Tx", "Rx read", "Rx deliver"
+};
+
+
+static void hist_reset(canola_latency_hist_t *hist)
+{
+  memset(hist, 0, sizeof(*hist));
+  hist->min = 0xFFFFFFFFU;
+}
+
+
+void canola_latency_init(void)
+{
+#if defined(__arm__)
+  // Enable and reset the cycle counter in the Performance Monitor Unit
+  // (PMCR.E and PMCR.C), counting every cycle (PMCR.D = 0)
+  __asm__ volatile("mcr p15, 0, %0, c9, c12, 0" :: "r"(0x5U));
+  // PMCNTENSET.C
+  __asm__ volatile("mcr p15, 0, %0, c9, c12, 1" :: "r"(0x80000000U));
+#endif
+
+  canola_latency_reset();
+}
+
+
+/**
+ * Clear all histograms. Measurements in progress are dropped.
+ */
+void canola_latency_reset(void)
+{
+  for(unsigned int path = 0; path < CANOLA_LATENCY_PATHS; path++) {
+    for(unsigned int dev = 0; dev < 4; dev++)
+      hist_reset(&canola_latency.dev[path][dev]);
+
+    for(unsigned int i = 0; i < CANOLA_LATENCY_IDS; i++) {
+      canola_latency.ids[path][i].arb_id = CANOLA_LATENCY_ID_FREE;
+      hist_reset(&canola_latency.ids[path][i].hist);
+    }
+  }
+
+  canola_latency.ids_full_count = 0;
+
+  for(unsigned int dev = 0; dev < 4; dev++) {
+    canola_latency.tx_pending[dev] = false;
+    canola_latency.rx_pending[dev] = false;
+  }
+}
+
+
+/**
+ * Histogram for an arbitration ID. Slots are taken by the first sample of
+ * an ID, with a compare and swap so that concurrent callers agree on it.
+ * Returns NULL when the table is full.
+ */
+static canola_latency_hist_t* id_hist(canola_latency_path_t path, uint32_t arb_id)
+{
+  canola_latency_id_hist_t *ids = canola_latency.ids[path];
+
+  for(unsigned int i = 0; i < CANOLA_LATENCY_IDS; i++) {
+    uint32_t slot_id = __atomic_load_n(&ids[i].arb_id, __ATOMIC_ACQUIRE);
+
+    if(slot_id == CANOLA_LATENCY_ID_FREE &&
+       __atomic_compare_exchange_n(&ids[i].arb_id, &slot_id, arb_id, false,
+                                   __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+      return &ids[i].hist;
+
+    // Also the case when another caller just took the slot for this ID
+    if(slot_id == arb_id)
+      return &ids[i].hist;
+  }
+
+  return NULL;
+}
+
+
+void canola_latency_sample(canola_latency_path_t path, unsigned int canola_dev_id,
+                           uint32_t arb_id, uint32_t start_cycles)
+{
+  // Wraps around correctly for latencies below 2^32 cycles
+  uint32_t cycles = canola_latency_cycles() - start_cycles;
+
+  canola_latency_record(&canola_latency.dev[path][canola_dev_id], cycles);
+
+  canola_latency_hist_t *hist = id_hist(path, arb_id);
+  if(hist != NULL)
+    canola_latency_record(hist, cycles);
+  else
+    __atomic_fetch_add(&canola_latency.ids_full_count, 1, __ATOMIC_RELAXED);
+}
+
+
+/**
+ * Start of a transmission with canola_send_msg(). Only one message can be
+ * in the Tx buffer, so a new start replaces one that did not finish.
+ */
+void canola_latency_tx_start(unsigned int canola_dev_id, const can_msg_t *msg)
+{
+  canola_latency.tx_arb_id[canola_dev_id] = canola_latency_arb_id(msg);
+  canola_latency.tx_start_cycles[canola_dev_id] = canola_latency_cycles();
+  canola_latency.tx_pending[canola_dev_id] = true;
+}
+
+
+void canola_latency_tx_done(unsigned int canola_dev_id)
+{
+  // Tx done from messages not sent with canola_send_msg(), e.g. from the
+  // Tx mailboxes, are not timed
+  if(!canola_latency.tx_pending[canola_dev_id])
+    return;
+
+  canola_latency.tx_pending[canola_dev_id] = false;
+  canola_latency_sample(CANOLA_LATENCY_TX, canola_dev_id, canola_latency.tx_arb_id[canola_dev_id],
+                        canola_latency.tx_start_cycles[canola_dev_id]);
+}
+
+
+void canola_latency_rx_read(unsigned int canola_dev_id, const can_msg_t *msg)
+{
+  // Only the first message read after the interrupt is timed, and reads
+  // from polling without an interrupt are not
+  if(!canola_latency.rx_pending[canola_dev_id])
+    return;
+
+  canola_latency.rx_pending[canola_dev_id] = false;
+  canola_latency_sample(CANOLA_LATENCY_RX_READ, canola_dev_id, canola_latency_arb_id(msg),
+                        canola_latency.rx_irq_cycles[canola_dev_id]);
+}
+
+
+static void print_hist(const char *name, const canola_latency_hist_t *hist)
+{
+  const double us_per_cycle = 1e6 / CANOLA_LATENCY_CLOCK_HZ;
+
+  printf("  %-14s %8lu %9.2f %9.2f %9.2f %9.2f %9.2f\n\r", name, (unsigned long)hist->count,
+         us_per_cycle * hist->min,
+         us_per_cycle * canola_latency_percentile(hist, 50.0),
+         us_per_cycle * canola_latency_percentile(hist, 99.0),
+         us_per_cycle * canola_latency_percentile(hist, 99.9),
+         us_per_cycle * hist->max);
+}
+
+
+/**
+ * Print count, min, p50, p99, p99.9 and max in us for every histogram with
+ * samples.
+ */
+void canola_latency_print(void)
+{
+  char name[16];
+
+  for(unsigned int path = 0; path < CANOLA_LATENCY_PATHS; path++) {
+    printf("%s latency (us):\n\r", path_names[path]);
+    printf("  %-14s %8s %9s %9s %9s %9s %9s\n\r", "", "Count", "Min", "p50", "p99", "p99.9", "Max");
+
+    for(unsigned int dev = 0; dev < 4; dev++) {
+      if(canola_latency.dev[path][dev].count == 0)
+        continue;
+      snprintf(name, sizeof(name), "CAN #%u", dev);
+      print_hist(name, &canola_latency.dev[path][dev]);
+    }
+
+    for(unsigned int i = 0; i < CANOLA_LATENCY_IDS; i++) {
+      const canola_latency_id_hist_t *id = &canola_latency.ids[path][i];
+      if(id->arb_id == CANOLA_LATENCY_ID_FREE || id->hist.count == 0)
+        continue;
+      if(id->arb_id & 0x80000000U)
+        snprintf(name, sizeof(name), "ID %08lx", (unsigned long)(id->arb_id & 0x1FFFFFFFU));
+      else
+        snprintf(name, sizeof(name), "ID %03lx", (unsigned long)id->arb_id);
+      print_hist(name, &id->hist);
+    }
+  }
+
+  if(canola_latency.ids_full_count > 0)
+    printf("%lu samples without an ID histogram (table full)\n\r",
+           (unsigned long)canola_latency.ids_full_count);
+}
+
+#endif
@@ -0,0 +1,151 @@
+/**
+ * @file   canola_latency.h
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Latency histograms for the Tx and Rx paths of the Canola CAN
+ *         controllers, timed with the CPU cycle counter.
+ *
+ *         Tx:         canola_send_msg() until the Tx done interrupt.
+ *         Rx read:    Rx valid interrupt until canola_get_msg() has read the
+ *                     message (in the interrupt handler, via the Rx ring).
+ *         Rx deliver: Rx valid interrupt until the application pops the
+ *                     message from the Rx ring.
+ *
+ *         There is a histogram per controller and per arbitration ID for
+ *         each path. The histograms are log-linear (HDR style), with 16
+ *         buckets per power of two, so a percentile is within about 6 %.
+ *         Buckets are updated with atomic increments, from both interrupt
+ *         handlers and the main loop, without locks.
+ *
+ *         The hooks are only compiled in with CANOLA_LATENCY_EN=1, and
+ *         expand to nothing otherwise.
+ */
+
+#ifndef CANOLA_LATENCY_H
+#define CANOLA_LATENCY_H
+
+#ifndef CANOLA_LATENCY_EN
+#define CANOLA_LATENCY_EN 0
+#endif
+
+#include "canola.h"
+#include "xparameters.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+// Values below 2^CANOLA_LATENCY_SUB_BITS cycles have a bucket each, above
+// that there are 2^CANOLA_LATENCY_SUB_BITS buckets per power of two
+#define CANOLA_LATENCY_SUB_BITS 4
+#define CANOLA_LATENCY_SUB_COUNT (1U << CANOLA_LATENCY_SUB_BITS)
+#define CANOLA_LATENCY_BUCKETS ((32 - CANOLA_LATENCY_SUB_BITS + 1) * CANOLA_LATENCY_SUB_COUNT)
+
+// Arbitration IDs with a histogram of their own, per path. Messages with
+// other IDs are only in the per controller histograms.
+#define CANOLA_LATENCY_IDS 16
+#define CANOLA_LATENCY_ID_FREE 0xFFFFFFFFU
+
+#define CANOLA_LATENCY_CLOCK_HZ XPAR_CPU_CORTEXA9_0_CPU_CLK_FREQ_HZ
+
+typedef enum {
+  CANOLA_LATENCY_TX = 0,
+  CANOLA_LATENCY_RX_READ,
+  CANOLA_LATENCY_RX_DELIVER,
+  CANOLA_LATENCY_PATHS
+} canola_latency_path_t;
+
+typedef struct {
+  uint32_t buckets[CANOLA_LATENCY_BUCKETS];
+  uint32_t count;
+  uint32_t min;
+  uint32_t max;
+} canola_latency_hist_t;
+
+typedef struct {
+  // CANOLA_LATENCY_ID_FREE until the slot is taken by an ID
+  uint32_t arb_id;
+  canola_latency_hist_t hist;
+} canola_latency_id_hist_t;
+
+typedef struct {
+  canola_latency_hist_t dev[CANOLA_LATENCY_PATHS][4];
+  canola_latency_id_hist_t ids[CANOLA_LATENCY_PATHS][CANOLA_LATENCY_IDS];
+
+  // Samples that did not get an ID histogram because the table was full
+  uint32_t ids_full_count;
+
+  // Start of the measurements in progress per controller
+  uint32_t tx_start_cycles[4];
+  uint32_t tx_arb_id[4];
+  volatile bool tx_pending[4];
+  uint32_t rx_irq_cycles[4];
+  volatile bool rx_pending[4];
+} canola_latency_t;
+
+
+#if defined(__arm__)
+// PMCCNTR in the Performance Monitor Unit of the Cortex-A9,
+// enabled by canola_latency_init()
+static inline uint32_t canola_latency_cycles(void)
+{
+  uint32_t cycles;
+  __asm__ volatile("mrc p15, 0, %0, c9, c13, 0" : "=r"(cycles));
+  return cycles;
+}
+#else
+// Provided by the platform when not running on the Zynq,
+// e.g. from simulation time in the co-simulation
+uint32_t canola_latency_cycles(void);
+#endif
+
+
+uint32_t canola_latency_arb_id(const can_msg_t *msg);
+unsigned int canola_latency_bucket(uint32_t cycles);
+uint32_t canola_latency_bucket_value(unsigned int bucket);
+void canola_latency_record(canola_latency_hist_t *hist, uint32_t cycles);
+uint32_t canola_latency_percentile(const canola_latency_hist_t *hist, double percentile);
+
+
+#if CANOLA_LATENCY_EN
+
+#ifndef CANOLA_LATENCY_C
+extern canola_latency_t canola_latency;
+#endif
+
+void canola_latency_init(void);
+void canola_latency_reset(void);
+void canola_latency_sample(canola_latency_path_t path, unsigned int canola_dev_id,
+                           uint32_t arb_id, uint32_t start_cycles);
+void canola_latency_tx_start(unsigned int canola_dev_id, const can_msg_t *msg);
+void canola_latency_tx_done(unsigned int canola_dev_id);
+void canola_latency_rx_read(unsigned int canola_dev_id, const can_msg_t *msg);
+void canola_latency_print(void);
+
+#define CANOLA_LATENCY_TX_START(dev, msg) canola_latency_tx_start((dev), (msg))
+#define CANOLA_LATENCY_TX_DONE(dev)       canola_latency_tx_done(dev)
+#define CANOLA_LATENCY_TX_FAILED(dev)     (canola_latency.tx_pending[(dev)] = false)
+#define CANOLA_LATENCY_RX_IRQ(dev)                                \
+  do {                                                            \
+    canola_latency.rx_irq_cycles[(dev)] = canola_latency_cycles(); \
+    canola_latency.rx_pending[(dev)] = true;                      \
+  } while(0)
+#define CANOLA_LATENCY_RX_READ(dev, msg)  canola_latency_rx_read((dev), (msg))
+#define CANOLA_LATENCY_RX_IRQ_CYCLES(dev) (canola_latency.rx_irq_cycles[(dev)])
+#define CANOLA_LATENCY_RX_DELIVER(dev, msg, irq_cycles) \
+  canola_latency_sample(CANOLA_LATENCY_RX_DELIVER, (dev), canola_latency_arb_id(msg), (irq_cycles))
+
+#else
+
+#define canola_latency_init()  ((void)0)
+#define canola_latency_reset() ((void)0)
+#define canola_latency_print() ((void)0)
+
+#define CANOLA_LATENCY_TX_START(dev, msg) ((void)0)
+#define CANOLA_LATENCY_TX_DONE(dev)       ((void)0)
+#define CANOLA_LATENCY_TX_FAILED(dev)     ((void)0)
+#define CANOLA_LATENCY_RX_IRQ(dev)        ((void)0)
+#define CANOLA_LATENCY_RX_READ(dev, msg)  ((void)0)
+#define CANOLA_LATENCY_RX_DELIVER(dev, msg, irq_cycles) ((void)0)
+
+#endif
+
+#endif
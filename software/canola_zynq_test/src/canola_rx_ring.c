@@ -0,0 +1,180 @@
+/**
+ * @file   canola_rx_ring.c
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Lock-free single-producer/single-consumer ring buffer for
+ *         received CAN messages. The Rx valid interrupt handler is the
+ *         producer, and the main loop is the consumer.
+ */
+
+#define CANOLA_RX_RING_C
+#include "canola_rx_ring.h"
+#include "canola_axi_slave.h"
+#include "canola_filter.h"
+#include "xil_io.h"
+#include <stdio.h>
+
+canola_rx_ring_t canola_rx_rings[4];
+
+#if CANOLA_LATENCY_EN
+// Time of the interrupt for the message that is pushed next
+#define RX_RING_STAMP(ring, canola_dev_id) \
+  ((ring)->irq_cycles[(ring)->head & CANOLA_RX_RING_MASK] = CANOLA_LATENCY_RX_IRQ_CYCLES(canola_dev_id))
+#else
+#define RX_RING_STAMP(ring, canola_dev_id) ((void)0)
+#endif
+
+
+void canola_rx_ring_init(canola_rx_ring_t *ring)
+{
+  ring->head = 0;
+  ring->tail = 0;
+  ring->overrun_count = 0;
+  ring->missed_count = 0;
+  ring->last_recv_count = 0;
+  ring->filtered_count = 0;
+}
+
+
+/**
+ * Add message to ring. Only to be called by the producer.
+ * Returns false (and counts an overrun) if the ring is full.
+ */
+bool canola_rx_ring_push(canola_rx_ring_t *ring, const can_msg_t *msg)
+{
+  uint32_t head = ring->head;
+
+  if(head - ring->tail >= CANOLA_RX_RING_SIZE) {
+    ring->overrun_count++;
+    return false;
+  }
+
+  ring->msgs[head & CANOLA_RX_RING_MASK] = *msg;
+
+  // Message must be written before it is published to the consumer
+  __sync_synchronize();
+  ring->head = head + 1;
+
+  return true;
+}
+
+
+/**
+ * Remove up to max_msgs messages from ring. Only to be called by the consumer.
+ * Returns number of messages copied to msgs.
+ */
+unsigned int canola_rx_ring_pop(canola_rx_ring_t *ring, can_msg_t *msgs, unsigned int max_msgs)
+{
+  uint32_t tail = ring->tail;
+  uint32_t count = ring->head - tail;
+
+  if(count > max_msgs)
+    count = max_msgs;
+
+  // Read messages only after reading head
+  __sync_synchronize();
+
+  for(uint32_t i = 0; i < count; i++)
+    msgs[i] = ring->msgs[(tail + i) & CANOLA_RX_RING_MASK];
+
+#if CANOLA_LATENCY_EN
+  // Only the rings of the controllers are timed
+  if(ring >= canola_rx_rings && ring < canola_rx_rings + 4) {
+    for(uint32_t i = 0; i < count; i++)
+      CANOLA_LATENCY_RX_DELIVER(ring - canola_rx_rings, &msgs[i],
+                                ring->irq_cycles[(tail + i) & CANOLA_RX_RING_MASK]);
+  }
+#endif
+
+  // Messages must be read before the slots are released to the producer
+  __sync_synchronize();
+  ring->tail = tail + count;
+
+  return count;
+}
+
+
+unsigned int canola_rx_ring_count(const canola_rx_ring_t *ring)
+{
+  return ring->head - ring->tail;
+}
+
+
+/**
+ * Read the received message from the RX registers of a controller into its
+ * ring. Called from the Rx valid interrupt handler.
+ * With the Rx FIFO enabled, messages are moved from the FIFO straight into
+ * the free slots of the ring, one at a time. Messages that do not fit are
+ * left in the FIFO for the next interrupt.
+ * Messages rejected by the software acceptance filter are dropped.
+ */
+void canola_rx_ring_receive(unsigned int canola_dev_id)
+{
+  canola_rx_ring_t *ring = &canola_rx_rings[canola_dev_id];
+  UINTPTR canola_baseaddr = canola_get_base_addr(canola_dev_id);
+
+  if(canola_rx_fifo_enabled(canola_dev_id)) {
+    // The fill level is only read once, messages that arrive while
+    // draining are left for the next interrupt
+    uint32_t status_reg = Xil_In32(canola_baseaddr+RX_FIFO_STATUS_OFFSET);
+    unsigned int count = (status_reg & RX_FIFO_STATUS_FILL_LEVEL_MASK) >> RX_FIFO_STATUS_FILL_LEVEL_OFFSET;
+
+    // Messages dropped by the FIFO are not counted, only that it happened
+    if(status_reg & RX_FIFO_STATUS_OVERFLOW_MASK) {
+      ring->missed_count++;
+      Xil_Out32(canola_baseaddr+CONTROL_OFFSET, CONTROL_RX_FIFO_CLEAR_OVERFLOW_MASK);
+    }
+
+    uint32_t head = ring->head;
+
+    for(unsigned int i = 0; i < count && head - ring->tail < CANOLA_RX_RING_SIZE; i++) {
+      can_msg_t *msg = &ring->msgs[head & CANOLA_RX_RING_MASK];
+
+      RX_RING_STAMP(ring, canola_dev_id);
+      *msg = canola_get_msg(canola_dev_id);
+      Xil_Out32(canola_baseaddr+CONTROL_OFFSET, CONTROL_RX_FIFO_POP_MASK);
+
+      if(!canola_filter_accept(msg)) {
+        ring->filtered_count++;
+        continue;
+      }
+
+      // Message must be written before it is published to the consumer
+      __sync_synchronize();
+      ring->head = ++head;
+    }
+
+    return;
+  }
+
+  can_msg_t msg = canola_get_msg(canola_dev_id);
+
+  uint32_t recv_count = Xil_In32(canola_baseaddr+RX_MSG_RECV_COUNT_OFFSET);
+  uint32_t recv_delta = recv_count - ring->last_recv_count;
+
+  // More than one message received since last interrupt means that
+  // messages were overwritten before we got to read them. A smaller
+  // count means that the counter was reset.
+  if(recv_count > ring->last_recv_count && recv_delta > 1)
+    ring->missed_count += recv_delta - 1;
+  ring->last_recv_count = recv_count;
+
+  if(!canola_filter_accept(&msg)) {
+    ring->filtered_count++;
+    return;
+  }
+
+  RX_RING_STAMP(ring, canola_dev_id);
+  canola_rx_ring_push(ring, &msg);
+}
+
+
+void canola_rx_ring_print_stats(unsigned int canola_dev_id)
+{
+  canola_rx_ring_t *ring = &canola_rx_rings[canola_dev_id];
+
+  printf("RX ring %d: %d queued, %lu overruns, %lu missed, %lu filtered\n\r",
+         canola_dev_id, canola_rx_ring_count(ring),
+         (unsigned long)ring->overrun_count, (unsigned long)ring->missed_count,
+         (unsigned long)ring->filtered_count);
+}
@@ -0,0 +1,63 @@
+/**
+ * @file   canola_rx_ring.h
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Lock-free single-producer/single-consumer ring buffer for
+ *         received CAN messages. The Rx valid interrupt handler is the
+ *         producer, and the main loop is the consumer.
+ */
+
+#ifndef CANOLA_RX_RING_H
+#define CANOLA_RX_RING_H
+
+#include "canola.h"
+#include "canola_latency.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+// Number of messages per ring, must be a power of two
+#define CANOLA_RX_RING_SIZE 64
+#define CANOLA_RX_RING_MASK (CANOLA_RX_RING_SIZE-1)
+
+#if (CANOLA_RX_RING_SIZE & CANOLA_RX_RING_MASK) != 0
+#error "CANOLA_RX_RING_SIZE must be a power of two"
+#endif
+
+typedef struct {
+  can_msg_t msgs[CANOLA_RX_RING_SIZE];
+
+  // Free-running indexes, head is only written by producer,
+  // and tail is only written by consumer
+  volatile uint32_t head;
+  volatile uint32_t tail;
+
+  // Messages dropped because the ring was full
+  volatile uint32_t overrun_count;
+
+  // Messages overwritten in the RX registers of the controller before the
+  // interrupt handler read them (based on RX_MSG_RECV_COUNT). With the Rx
+  // FIFO enabled, this is the number of times the FIFO overflowed.
+  volatile uint32_t missed_count;
+  uint32_t last_recv_count;
+
+  // Messages dropped by the software acceptance filter (canola_filter.h)
+  volatile uint32_t filtered_count;
+
+#if CANOLA_LATENCY_EN
+  // Cycle count at the Rx valid interrupt for each message
+  uint32_t irq_cycles[CANOLA_RX_RING_SIZE];
+#endif
+} canola_rx_ring_t;
+
+#ifndef CANOLA_RX_RING_C
+extern canola_rx_ring_t canola_rx_rings[4];
+#endif
+
+void canola_rx_ring_init(canola_rx_ring_t *ring);
+bool canola_rx_ring_push(canola_rx_ring_t *ring, const can_msg_t *msg);
+unsigned int canola_rx_ring_pop(canola_rx_ring_t *ring, can_msg_t *msgs, unsigned int max_msgs);
+unsigned int canola_rx_ring_count(const canola_rx_ring_t *ring);
+void canola_rx_ring_receive(unsigned int canola_dev_id);
+void canola_rx_ring_print_stats(unsigned int canola_dev_id);
+
+#endif
@@ -8,6 +8,10 @@
 #include "canola_tests.h"
 #include "canola_axi_slave.h"
 #include "canola.h"
+#include "canola_filter.h"
+#include "canola_rx_ring.h"
+#include "canola_tx_queue.h"
+#include "canola_latency.h"
 #include "interrupt.h"
 #include "gpio.h"
 #include <stdio.h>
@@ -30,6 +34,7 @@ void canola_manual_test(void)
   unsigned int cycle_count = 0;
   uint32_t btn = 0;
   uint32_t sw = 0x01;
+  can_msg_t msg_in;
 
   can_msg_t msg_out_0 = {
     .arb_id_a = 0,
@@ -92,9 +97,12 @@ void canola_manual_test(void)
         got_tx_done[i] = 0;
       }
       if(got_rx_msg[i] == 1) {
-        printf("Rx msg received CAN #%d.\n\r", i);
         got_rx_msg[i] = 0;
       }
+
+      while(canola_rx_ring_pop(&canola_rx_rings[i], &msg_in, 1) == 1) {
+        printf("Rx msg received CAN #%d, ID A: %lx.\n\r", i, (unsigned long)msg_in.arb_id_a);
+      }
     }
 
 
@@ -113,6 +121,8 @@ void canola_manual_test(void)
       canola_print_status_regs(1);
       canola_print_status_regs(2);
       canola_print_status_regs(3);
+      for(unsigned int i = 0; i < 4; i++)
+        canola_rx_ring_print_stats(i);
       cycle_count = 0;
     }
 
@@ -126,6 +136,7 @@ void canola_continuous_send_test(void)
   uint32_t sw = 0x02;
 
   unsigned int msg_sent_count = 0;
+  can_msg_t msg_in[CANOLA_RX_RING_SIZE];
 
   //can_msg_t msg_out;
 
@@ -141,12 +152,19 @@ void canola_continuous_send_test(void)
         printf("Rx msg received CAN #%d.\n\r", i);
         got_rx_msg[i] = 0;
       }
+
+      // Discard received messages
+      canola_rx_ring_pop(&canola_rx_rings[i], msg_in, CANOLA_RX_RING_SIZE);
     }
 
+    // Keep the Tx queues full, the Tx done/failed interrupt handlers
+    // load the next message into the controller. Polling restarts a queue
+    // the controller stopped taking messages from, e.g. after bus off.
     for(unsigned int i = 0; i < 4; i++) {
-      if(!canola_is_busy(i)) {
-        canola_send_msg(i, canola_generate_rand_msg());
-        //msg_out.arb_id_b++;
+      canola_tx_queue_poll(i);
+      while(canola_tx_queue_count(i) < CANOLA_TX_QUEUE_SIZE) {
+        can_msg_t msg_out = canola_generate_rand_msg();
+        canola_tx_queue_send(i, &msg_out);
         msg_sent_count++;
       }
     }
@@ -156,11 +174,19 @@ void canola_continuous_send_test(void)
       canola_print_status_regs(1);
       canola_print_status_regs(2);
       canola_print_status_regs(3);
+      for(unsigned int i = 0; i < 4; i++) {
+        canola_rx_ring_print_stats(i);
+        canola_tx_queue_print_stats(i);
+      }
       msg_sent_count = 0;
     }
 
     sw = XGpio_DiscreteRead(&GpioSwBtn, GPIO_SW_CHANNEL);
   }
+
+  // The other tests send directly with canola_send_msg()
+  for(unsigned int i = 0; i < 4; i++)
+    canola_tx_queue_clear(i);
 }
 
 
@@ -187,6 +213,12 @@ void canola_sequence_send_test(void)
 
   printf("Starting send in sequence test\n\r");
 
+  // Discard messages received before the test started
+  for(unsigned int i = 0; i < 4; i++) {
+    while(canola_rx_ring_pop(&canola_rx_rings[i], &msg_in, 1) == 1)
+      ;
+  }
+
   while(sw == 0x04) {
     test_ok = true;
 
@@ -221,11 +253,11 @@ void canola_sequence_send_test(void)
       if(i == can_ctrl_num)
         continue;
 
-      if(got_rx_msg[i] == 0) {
+      if(canola_rx_ring_pop(&canola_rx_rings[i], &msg_in, 1) == 0) {
         printf("CAN %d failed to receive message from CAN %d\n\r", i, can_ctrl_num);
         test_ok = false;
       } else {
-        msg_in = canola_get_msg(i);
+        rx_msg_count++;
 
         if(canola_compare_messages(msg_out, msg_in) == false) {
           test_ok = false;
@@ -285,4 +317,129 @@ void canola_sequence_send_test(void)
   canola_print_status_regs(1);
   //canola_print_status_regs(2);
   canola_print_status_regs(3);
+
+  for(unsigned int i = 0; i < 4; i++)
+    canola_rx_ring_print_stats(i);
+}
+
+
+/**
+ * Send messages in sequence from the controllers, like the sequence send
+ * test, while polling the Rx rings like an application would, and print
+ * the latency histograms (see canola_latency.h) every 10000 messages and
+ * at the end.
+ */
+void canola_latency_test(void)
+{
+  uint32_t sw = 0x08;
+
+#if CANOLA_LATENCY_EN
+  can_msg_t msg_out;
+  can_msg_t msg_in[CANOLA_RX_RING_SIZE];
+
+  unsigned int can_ctrl_num = 0;
+  unsigned int msg_sent_count = 0;
+  unsigned int timeout_count = 0;
+
+  printf("Starting latency test\n\r");
+
+  for(unsigned int i = 0; i < 4; i++) {
+    canola_rx_ring_pop(&canola_rx_rings[i], msg_in, CANOLA_RX_RING_SIZE);
+    got_tx_done[i] = 0;
+  }
+
+  canola_latency_reset();
+
+  while(sw == 0x08) {
+    while(canola_is_busy(can_ctrl_num))
+      usleep(1);
+
+    msg_out = canola_generate_rand_msg();
+    canola_send_msg(can_ctrl_num, msg_out);
+
+    // Wait for Tx done, and for the two other controllers to receive
+    // the message (controller 2 is missing), for up to 2 ms
+    unsigned int rx_count = 0;
+    unsigned int wait_us;
+
+    for(wait_us = 0; wait_us < 2000; wait_us++) {
+      for(unsigned int i = 0; i < 4; i++)
+        rx_count += canola_rx_ring_pop(&canola_rx_rings[i], msg_in, CANOLA_RX_RING_SIZE);
+
+      if(got_tx_done[can_ctrl_num] == 1 && rx_count >= 2)
+        break;
+
+      usleep(1);
+    }
+
+    if(wait_us == 2000)
+      timeout_count++;
+
+    got_tx_done[can_ctrl_num] = 0;
+
+    msg_sent_count++;
+    if(msg_sent_count % 10000 == 0)
+      canola_latency_print();
+
+    can_ctrl_num++;
+    if(can_ctrl_num == 2)
+      can_ctrl_num++; // Skip missing controller
+    if(can_ctrl_num == 4)
+      can_ctrl_num = 0;
+
+    sw = XGpio_DiscreteRead(&GpioSwBtn, GPIO_SW_CHANNEL);
+  }
+
+  printf("msg_sent_count: %d\n\r", msg_sent_count);
+  printf("timeout_count: %d\n\r", timeout_count);
+  canola_latency_print();
+#else
+  printf("Latency hooks disabled, build with CANOLA_LATENCY_EN=1\n\r");
+
+  while(sw == 0x08) {
+    usleep(100000);
+    sw = XGpio_DiscreteRead(&GpioSwBtn, GPIO_SW_CHANNEL);
+  }
+#endif
+}
+
+
+void canola_tests_init(void)
+{
+  printf("\n\r\n\rStarting...\n\r-------------------\n\r");
+
+  printf("Initializing interrupts...\n\r");
+  if(init_interrupts() != XST_SUCCESS)
+    printf("Error initializing interrupts.\n\r");
+
+  printf("Initializing GPIO...\n\r");
+  init_gpio();
+
+  printf("Checking software acceptance filter...\n\r");
+  printf("%u errors\n\r", canola_filter_check());
+
+  printf("\n\rInitializing Canola CAN controllers...\n\r");
+  printf("--------------------------------------\n\r");
+  for(unsigned int i = 0; i < 4; i++) {
+    canola_init(i);
+    canola_print_ctrl_regs(i);
+    canola_print_status_regs(i);
+  }
+}
+
+
+void canola_run_test(uint32_t sw, unsigned int seed)
+{
+  if(sw == 0x01)
+    canola_manual_test();
+  else if(sw == 0x02) {
+    srand(seed);
+    canola_continuous_send_test();
+  } else if(sw == 0x04) {
+    srand(seed);
+    canola_sequence_send_test();
+  } else if(sw == 0x08) {
+    srand(seed);
+    canola_latency_test();
+  }
 }
@@ -8,8 +8,17 @@
 #ifndef CANOLA_TESTS_H
 #define CANOLA_TESTS_H
 
+#include <stdint.h>
+
+// Initializes interrupts, GPIO and the controllers, and prints their registers
+void canola_tests_init(void);
+
+// Runs the test mode selected by the switches, until the switches change
+void canola_run_test(uint32_t sw, unsigned int seed);
+
 void canola_manual_test(void);
 void canola_continuous_send_test(void);
 void canola_sequence_send_test(void);
+void canola_latency_test(void);
 
 #endif
@@ -0,0 +1,246 @@
+/**
+ * @file   canola_tx_queue.c
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Software Tx queue for Canola CAN controllers, ordered by CAN
+ *         arbitration priority. The hardware Tx buffer is refilled from the
+ *         Tx done and Tx failed interrupt handlers, so the application
+ *         never has to wait for the controller to be ready. Messages the
+ *         controller did not accept (e.g. while bus off) are started again
+ *         by canola_tx_queue_poll().
+ */
+
+#define CANOLA_TX_QUEUE_C
+#include "canola_tx_queue.h"
+#include "xpseudo_asm.h"
+#include <stdio.h>
+
+canola_tx_queue_t canola_tx_queues[4];
+
+
+/**
+ * Mask IRQs, and return the previous CPSR for irq_restore(). IRQs are only
+ * unmasked again if they were unmasked before, so the queue functions can
+ * also be called from interrupt handlers and with IRQs already masked.
+ */
+static u32 irq_save(void)
+{
+  u32 cpsr = mfcpsr();
+  mtcpsr(cpsr | XREG_CPSR_IRQ_ENABLE);
+  return cpsr;
+}
+
+
+static void irq_restore(u32 cpsr)
+{
+  mtcpsr((mfcpsr() & ~XREG_CPSR_IRQ_ENABLE) | (cpsr & XREG_CPSR_IRQ_ENABLE));
+}
+
+
+/**
+ * Arbitration priority of a message, lower value wins arbitration.
+ * The bits are in the order they appear in the arbitration field on the bus:
+ *
+ *   31..21: ID A
+ *       20: RTR (standard frame) or SRR (extended frame, always recessive)
+ *       19: IDE
+ *    18..1: ID B (extended frame)
+ *        0: RTR (extended frame)
+ *
+ * Hence a standard frame wins over an extended frame with the same ID A,
+ * and a data frame wins over a remote frame with the same ID.
+ */
+uint32_t canola_tx_priority(const can_msg_t *msg)
+{
+  uint32_t prio = (msg->arb_id_a & 0x7FF) << 21;
+
+  if(msg->ext_id) {
+    prio |= (1 << 20) | (1 << 19);
+    prio |= (msg->arb_id_b & 0x3FFFF) << 1;
+    prio |= msg->remote_frame ? 1 : 0;
+  } else {
+    prio |= msg->remote_frame ? (1 << 20) : 0;
+  }
+
+  return prio;
+}
+
+
+void canola_tx_queue_init(unsigned int canola_dev_id)
+{
+  canola_tx_queue_t *queue = &canola_tx_queues[canola_dev_id];
+
+  queue->count = 0;
+  queue->seq_num = 0;
+  queue->tx_active = false;
+  queue->sent_count = 0;
+  queue->failed_count = 0;
+  queue->full_count = 0;
+  queue->not_started_count = 0;
+}
+
+
+static void heap_swap(canola_tx_queue_t *queue, unsigned int a, unsigned int b)
+{
+  canola_tx_queue_entry_t tmp = queue->heap[a];
+  queue->heap[a] = queue->heap[b];
+  queue->heap[b] = tmp;
+}
+
+
+static void heap_push(canola_tx_queue_t *queue, const can_msg_t *msg)
+{
+  unsigned int i = queue->count++;
+
+  queue->heap[i].key = ((uint64_t)canola_tx_priority(msg) << 32) | queue->seq_num++;
+  queue->heap[i].msg = *msg;
+
+  while(i > 0 && queue->heap[(i-1)/2].key > queue->heap[i].key) {
+    heap_swap(queue, i, (i-1)/2);
+    i = (i-1)/2;
+  }
+}
+
+
+static void heap_pop(canola_tx_queue_t *queue, can_msg_t *msg)
+{
+  unsigned int i = 0;
+
+  *msg = queue->heap[0].msg;
+  queue->heap[0] = queue->heap[--queue->count];
+
+  while(1) {
+    unsigned int smallest = i;
+    unsigned int left = 2*i+1;
+    unsigned int right = 2*i+2;
+
+    if(left < queue->count && queue->heap[left].key < queue->heap[smallest].key)
+      smallest = left;
+    if(right < queue->count && queue->heap[right].key < queue->heap[smallest].key)
+      smallest = right;
+    if(smallest == i)
+      break;
+
+    heap_swap(queue, i, smallest);
+    i = smallest;
+  }
+}
+
+
+/**
+ * Load highest priority message into the hardware Tx buffer and start
+ * transmission. Called with interrupts disabled, or from interrupt handler.
+ *
+ * The controller ignores TX_START while it is bus off, or while it is busy
+ * with a message that was not sent from the queue. The message is then left
+ * in the queue, and tx_active is cleared so the next canola_tx_queue_send()
+ * or canola_tx_queue_poll() tries again.
+ */
+static void start_next(unsigned int canola_dev_id)
+{
+  canola_tx_queue_t *queue = &canola_tx_queues[canola_dev_id];
+  can_msg_t msg;
+
+  queue->tx_active = false;
+
+  if(queue->count == 0 || canola_is_busy(canola_dev_id))
+    return;
+
+  canola_send_msg(canola_dev_id, queue->heap[0].msg);
+
+  // TX_BUSY is set the cycle after TX_START, so it is already set when the
+  // read of STATUS gets to the controller if the message was accepted
+  if(!canola_is_busy(canola_dev_id)) {
+    queue->not_started_count++;
+    return;
+  }
+
+  heap_pop(queue, &msg);
+  queue->tx_active = true;
+}
+
+
+/**
+ * Queue message for transmission. Returns false if the queue is full.
+ */
+bool canola_tx_queue_send(unsigned int canola_dev_id, const can_msg_t *msg)
+{
+  canola_tx_queue_t *queue = &canola_tx_queues[canola_dev_id];
+  bool queued = false;
+  u32 cpsr = irq_save();
+
+  if(queue->count < CANOLA_TX_QUEUE_SIZE) {
+    heap_push(queue, msg);
+    queued = true;
+
+    if(!queue->tx_active)
+      start_next(canola_dev_id);
+  } else {
+    queue->full_count++;
+  }
+
+  irq_restore(cpsr);
+
+  return queued;
+}
+
+
+unsigned int canola_tx_queue_count(unsigned int canola_dev_id)
+{
+  return canola_tx_queues[canola_dev_id].count;
+}
+
+
+/**
+ * Discard all queued messages. A message already loaded into the
+ * controller is not aborted.
+ */
+void canola_tx_queue_clear(unsigned int canola_dev_id)
+{
+  u32 cpsr = irq_save();
+  canola_tx_queues[canola_dev_id].count = 0;
+  irq_restore(cpsr);
+}
+
+
+/**
+ * Start the next message if none from the queue is in the controller.
+ * Call periodically while messages are queued, to resume sending when the
+ * controller has recovered from bus off.
+ */
+void canola_tx_queue_poll(unsigned int canola_dev_id)
+{
+  u32 cpsr = irq_save();
+
+  if(!canola_tx_queues[canola_dev_id].tx_active)
+    start_next(canola_dev_id);
+
+  irq_restore(cpsr);
+}
+
+
+// Called from Tx done interrupt handler
+void canola_tx_queue_tx_done(unsigned int canola_dev_id)
+{
+  canola_tx_queues[canola_dev_id].sent_count++;
+  start_next(canola_dev_id);
+}
+
+
+// Called from Tx failed interrupt handler
+void canola_tx_queue_tx_failed(unsigned int canola_dev_id)
+{
+  canola_tx_queues[canola_dev_id].failed_count++;
+  start_next(canola_dev_id);
+}
+
+
+void canola_tx_queue_print_stats(unsigned int canola_dev_id)
+{
+  canola_tx_queue_t *queue = &canola_tx_queues[canola_dev_id];
+
+  printf("TX queue %d: %d queued, %lu sent, %lu failed, %lu full, %lu not started\n\r",
+         canola_dev_id, queue->count, (unsigned long)queue->sent_count,
+         (unsigned long)queue->failed_count, (unsigned long)queue->full_count,
+         (unsigned long)queue->not_started_count);
+}
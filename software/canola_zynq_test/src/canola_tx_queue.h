@@ -0,0 +1,60 @@
+/**
+ * @file   canola_tx_queue.h
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Software Tx queue for Canola CAN controllers, ordered by CAN
+ *         arbitration priority. The hardware Tx buffer is refilled from the
+ *         Tx done and Tx failed interrupt handlers, so the application
+ *         never has to wait for the controller to be ready. Messages the
+ *         controller did not accept (e.g. while bus off) are started again
+ *         by canola_tx_queue_poll().
+ *
+ *         Note: Messages must not be sent directly with canola_send_msg()
+ *         to a controller while its queue is in use.
+ */
+
+#ifndef CANOLA_TX_QUEUE_H
+#define CANOLA_TX_QUEUE_H
+
+#include "canola.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CANOLA_TX_QUEUE_SIZE 32
+
+typedef struct {
+  // Arbitration priority in upper 32 bits (see canola_tx_priority), and a
+  // sequence number in the lower 32 bits for FIFO order of equal priorities
+  uint64_t key;
+  can_msg_t msg;
+} canola_tx_queue_entry_t;
+
+typedef struct {
+  canola_tx_queue_entry_t heap[CANOLA_TX_QUEUE_SIZE]; // Binary min-heap
+  unsigned int count;
+  uint32_t seq_num;
+
+  // True while a message from the queue is in the hardware Tx buffer
+  volatile bool tx_active;
+
+  volatile uint32_t sent_count;
+  volatile uint32_t failed_count;
+  uint32_t full_count;
+  uint32_t not_started_count; // TX_START ignored, e.g. while bus off
+} canola_tx_queue_t;
+
+#ifndef CANOLA_TX_QUEUE_C
+extern canola_tx_queue_t canola_tx_queues[4];
+#endif
+
+uint32_t canola_tx_priority(const can_msg_t *msg);
+void canola_tx_queue_init(unsigned int canola_dev_id);
+bool canola_tx_queue_send(unsigned int canola_dev_id, const can_msg_t *msg);
+unsigned int canola_tx_queue_count(unsigned int canola_dev_id);
+void canola_tx_queue_clear(unsigned int canola_dev_id);
+void canola_tx_queue_poll(unsigned int canola_dev_id);
+void canola_tx_queue_tx_done(unsigned int canola_dev_id);
+void canola_tx_queue_tx_failed(unsigned int canola_dev_id);
+void canola_tx_queue_print_stats(unsigned int canola_dev_id);
+
+#endif
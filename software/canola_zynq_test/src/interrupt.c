@@ -9,6 +9,9 @@
 #define INTERRUPT_C
 #include "interrupt.h"
 #include "gpio.h"
+#include "canola_rx_ring.h"
+#include "canola_tx_queue.h"
+#include "canola_latency.h"
 
 #include "canola_axi_slave.h"
 #include "xil_printf.h"
@@ -33,16 +36,37 @@ const unsigned int CanolaInstance3 = 3;
 
 volatile unsigned int got_rx_msg[4] = {0,0,0,0};
 volatile unsigned int got_tx_done[4] = {0,0,0,0};
+volatile unsigned int got_tx_failed[4] = {0,0,0,0};
 volatile unsigned int got_gpio_event = 0;
 
 void IrqRxValidHandler(void *data) {
-  if(*(unsigned int*)data < 4)
+  if(*(unsigned int*)data < 4) {
+    CANOLA_LATENCY_RX_IRQ(*(unsigned int*)data);
+
+    // Move message to the ring right away, before the next message
+    // overwrites it in the RX registers
+    canola_rx_ring_receive(*(unsigned int*)data);
     got_rx_msg[*(unsigned int*)data] = 1;
+  }
 }
 
 void IrqTxDoneHandler(void *data) {
-  if(*(unsigned int*)data < 4)
+  if(*(unsigned int*)data < 4) {
+    // Before the next queued message is started below
+    CANOLA_LATENCY_TX_DONE(*(unsigned int*)data);
+
+    // Start next queued message right away to keep the bus busy
+    canola_tx_queue_tx_done(*(unsigned int*)data);
     got_tx_done[*(unsigned int*)data] = 1;
+  }
+}
+
+void IrqTxFailedHandler(void *data) {
+  if(*(unsigned int*)data < 4) {
+    CANOLA_LATENCY_TX_FAILED(*(unsigned int*)data);
+    canola_tx_queue_tx_failed(*(unsigned int*)data);
+    got_tx_failed[*(unsigned int*)data] = 1;
+  }
 }
 
 void IrqGpioHandler(void *data) {
@@ -56,6 +80,14 @@ unsigned int init_interrupts(void)
   int Status;
   static XScuGic_Config *GicConfig;
 
+  for(unsigned int i = 0; i < 4; i++)
+    canola_rx_ring_init(&canola_rx_rings[i]);
+
+  for(unsigned int i = 0; i < 4; i++)
+    canola_tx_queue_init(i);
+
+  canola_latency_init();
+
   /*
    * Initialize the interrupt controller driver so that it is ready to
    * use.
@@ -150,6 +182,42 @@ unsigned int init_interrupts(void)
     return XST_FAILURE;
   }
 
+  // Set up interrupt handler for Tx failed signal for CAN controller 0
+  Status = XScuGic_Connect(&IntcInstance,
+                           XPAR_FABRIC_CANOLA_AXI_SLAVE_0_CAN_TX_FAILED_IRQ_INTR,
+                           (Xil_InterruptHandler)IrqTxFailedHandler,
+                           (void *) &CanolaInstance0);
+  if (Status != XST_SUCCESS) {
+    return XST_FAILURE;
+  }
+
+  // Set up interrupt handler for Tx failed signal for CAN controller 1
+  Status = XScuGic_Connect(&IntcInstance,
+                           XPAR_FABRIC_CANOLA_AXI_SLAVE_1_CAN_TX_FAILED_IRQ_INTR,
+                           (Xil_InterruptHandler)IrqTxFailedHandler,
+                           (void *) &CanolaInstance1);
+  if (Status != XST_SUCCESS) {
+    return XST_FAILURE;
+  }
+
+  // Set up interrupt handler for Tx failed signal for CAN controller 2
+  Status = XScuGic_Connect(&IntcInstance,
+                           XPAR_FABRIC_CANOLA_AXI_SLAVE_2_CAN_TX_FAILED_IRQ_INTR,
+                           (Xil_InterruptHandler)IrqTxFailedHandler,
+                           (void *) &CanolaInstance2);
+  if (Status != XST_SUCCESS) {
+    return XST_FAILURE;
+  }
+
+  // Set up interrupt handler for Tx failed signal for CAN controller 3
+  Status = XScuGic_Connect(&IntcInstance,
+                           XPAR_FABRIC_CANOLA_AXI_SLAVE_3_CAN_TX_FAILED_IRQ_INTR,
+                           (Xil_InterruptHandler)IrqTxFailedHandler,
+                           (void *) &CanolaInstance3);
+  if (Status != XST_SUCCESS) {
+    return XST_FAILURE;
+  }
+
   // Set up interrupt handler for GPIO interrupts
   Status = XScuGic_Connect(&IntcInstance,
                            XPAR_FABRIC_AXI_GPIO_0_IP2INTC_IRPT_INTR,
@@ -194,6 +262,22 @@ unsigned int init_interrupts(void)
                                  XPAR_FABRIC_CANOLA_AXI_SLAVE_3_CAN_TX_DONE_IRQ_INTR,
                                  8,     // priority
                                  0b11); // rising edge
+  XScuGic_SetPriorityTriggerType(&IntcInstance,
+                                 XPAR_FABRIC_CANOLA_AXI_SLAVE_0_CAN_TX_FAILED_IRQ_INTR,
+                                 8,     // priority
+                                 0b11); // rising edge
+  XScuGic_SetPriorityTriggerType(&IntcInstance,
+                                 XPAR_FABRIC_CANOLA_AXI_SLAVE_1_CAN_TX_FAILED_IRQ_INTR,
+                                 8,     // priority
+                                 0b11); // rising edge
+  XScuGic_SetPriorityTriggerType(&IntcInstance,
+                                 XPAR_FABRIC_CANOLA_AXI_SLAVE_2_CAN_TX_FAILED_IRQ_INTR,
+                                 8,     // priority
+                                 0b11); // rising edge
+  XScuGic_SetPriorityTriggerType(&IntcInstance,
+                                 XPAR_FABRIC_CANOLA_AXI_SLAVE_3_CAN_TX_FAILED_IRQ_INTR,
+                                 8,     // priority
+                                 0b11); // rising edge
 
   XScuGic_InterruptMaptoCpu(&IntcInstance, 0, XPAR_FABRIC_CANOLA_AXI_SLAVE_0_CAN_RX_VALID_IRQ_INTR);
   XScuGic_InterruptMaptoCpu(&IntcInstance, 0, XPAR_FABRIC_CANOLA_AXI_SLAVE_1_CAN_RX_VALID_IRQ_INTR);
@@ -203,6 +287,10 @@ unsigned int init_interrupts(void)
   XScuGic_InterruptMaptoCpu(&IntcInstance, 0, XPAR_FABRIC_CANOLA_AXI_SLAVE_1_CAN_TX_DONE_IRQ_INTR);
   XScuGic_InterruptMaptoCpu(&IntcInstance, 0, XPAR_FABRIC_CANOLA_AXI_SLAVE_2_CAN_TX_DONE_IRQ_INTR);
   XScuGic_InterruptMaptoCpu(&IntcInstance, 0, XPAR_FABRIC_CANOLA_AXI_SLAVE_3_CAN_TX_DONE_IRQ_INTR);
+  XScuGic_InterruptMaptoCpu(&IntcInstance, 0, XPAR_FABRIC_CANOLA_AXI_SLAVE_0_CAN_TX_FAILED_IRQ_INTR);
+  XScuGic_InterruptMaptoCpu(&IntcInstance, 0, XPAR_FABRIC_CANOLA_AXI_SLAVE_1_CAN_TX_FAILED_IRQ_INTR);
+  XScuGic_InterruptMaptoCpu(&IntcInstance, 0, XPAR_FABRIC_CANOLA_AXI_SLAVE_2_CAN_TX_FAILED_IRQ_INTR);
+  XScuGic_InterruptMaptoCpu(&IntcInstance, 0, XPAR_FABRIC_CANOLA_AXI_SLAVE_3_CAN_TX_FAILED_IRQ_INTR);
 
   // Enable the interrupts
   XScuGic_Enable(&IntcInstance, XPAR_FABRIC_CANOLA_AXI_SLAVE_0_CAN_RX_VALID_IRQ_INTR);
@@ -213,6 +301,10 @@ unsigned int init_interrupts(void)
   XScuGic_Enable(&IntcInstance, XPAR_FABRIC_CANOLA_AXI_SLAVE_1_CAN_TX_DONE_IRQ_INTR);
   XScuGic_Enable(&IntcInstance, XPAR_FABRIC_CANOLA_AXI_SLAVE_2_CAN_TX_DONE_IRQ_INTR);
   XScuGic_Enable(&IntcInstance, XPAR_FABRIC_CANOLA_AXI_SLAVE_3_CAN_TX_DONE_IRQ_INTR);
+  XScuGic_Enable(&IntcInstance, XPAR_FABRIC_CANOLA_AXI_SLAVE_0_CAN_TX_FAILED_IRQ_INTR);
+  XScuGic_Enable(&IntcInstance, XPAR_FABRIC_CANOLA_AXI_SLAVE_1_CAN_TX_FAILED_IRQ_INTR);
+  XScuGic_Enable(&IntcInstance, XPAR_FABRIC_CANOLA_AXI_SLAVE_2_CAN_TX_FAILED_IRQ_INTR);
+  XScuGic_Enable(&IntcInstance, XPAR_FABRIC_CANOLA_AXI_SLAVE_3_CAN_TX_FAILED_IRQ_INTR);
   XScuGic_Enable(&IntcInstance, XPAR_FABRIC_AXI_GPIO_0_IP2INTC_IRPT_INTR);
 
   return XST_SUCCESS;
@@ -12,11 +12,13 @@
 #ifndef INTERRUPT_C
 extern volatile unsigned int got_rx_msg[4];
 extern volatile unsigned int got_tx_done[4];
+extern volatile unsigned int got_tx_failed[4];
 extern volatile unsigned int got_gpio_event;
 #endif
 
 void IrqRxValidHandler(void *data);
 void IrqTxDoneHandler(void *data);
+void IrqTxFailedHandler(void *data);
 void IrqGpioHandler(void *data);
 unsigned int init_interrupts(void);
 
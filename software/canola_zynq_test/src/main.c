@@ -8,6 +8,7 @@
 #include "canola_axi_slave.h"
 #include "canola_tests.h"
 #include "canola.h"
+#include "canola_filter.h"
 #include "interrupt.h"
 #include "gpio.h"
 #include "platform.h"
@@ -39,48 +40,11 @@ int main()
 
   init_platform();
 
-  printf("\n\r\n\rStarting...\n\r-------------------\n\r");
-
-  printf("Initializing interrupts...\n\r");
-  if(init_interrupts() != XST_SUCCESS)
-    printf("Error initializing interrupts.\n\r");
-
-  printf("Initializing GPIO...\n\r");
-  init_gpio();
-
-  printf("\n\rInitializing Canola CAN controllers...\n\r");
-  printf("--------------------------------------\n\r");
-  canola_init(0);
-  canola_print_ctrl_regs(0);
-  canola_print_status_regs(0);
-
-  canola_init(1);
-  canola_print_ctrl_regs(1);
-  canola_print_status_regs(1);
-
-  canola_init(2);
-  canola_print_ctrl_regs(2);
-  canola_print_status_regs(2);
-
-  canola_init(3);
-  canola_print_ctrl_regs(3);
-  canola_print_status_regs(3);
-
+  canola_tests_init();
 
   while(1) {
     sw = XGpio_DiscreteRead(&GpioSwBtn, GPIO_SW_CHANNEL);
-
-    if(sw == 0x01)
-      canola_manual_test();
-    else if(sw == 0x02) {
-      srand(seed);
-      canola_continuous_send_test();
-    } else if(sw == 0x04) {
-      srand(seed);
-      canola_sequence_send_test();
-    } else if(sw == 0x08)
-      ;
-
+    canola_run_test(sw, seed);
     seed++;
   }
 
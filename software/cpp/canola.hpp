@@ -0,0 +1,703 @@
+/**
+ * @file   canola.hpp
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Header-only C++ driver for the Canola CAN controller AXI-slave.
+ *         The driver is a class template over a RegisterIO policy
+ *         (see canola_io.hpp), so the same code runs bare-metal on the
+ *         Zynq, on Linux through a mapped register space, or against an
+ *         in-memory mock on a host. All functions are inline and compile
+ *         down to the register loads and stores they perform.
+ */
+
+#ifndef CANOLA_HPP
+#define CANOLA_HPP
+
+#include "canola_bit_timing.hpp"
+#include "canola_io.hpp"
+#include "canola_regs.hpp"
+#include "canola_regs_check.hpp"
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace canola
+{
+
+/**
+ * CAN message, same fields as can_msg_t in the C driver (canola.h)
+ */
+struct CanMsg {
+  uint32_t arb_id_a;
+  uint32_t arb_id_b;
+  bool remote_frame;
+  bool ext_id;
+  uint8_t payload[8];
+  uint8_t data_length;
+
+  // RX_TIMESTAMP of a received message, in clock cycles of the controller
+  // (see Canola::timestamp()), zero unless enabled with
+  // Canola::set_rx_timestamp_enable(). Not used when sending.
+  uint32_t timestamp;
+};
+
+enum class ErrorState : uint32_t {
+  ERROR_ACTIVE  = 0,
+  ERROR_PASSIVE = 1,
+  BUS_OFF       = 2
+};
+
+/**
+ * Status/error counters, the value is the register offset
+ */
+enum class Counter : uint32_t {
+  TX_MSG_SENT    = reg::TX_MSG_SENT_COUNT::address,
+  TX_FAILED      = reg::TX_FAILED_COUNT::address,
+  TX_ACK_ERROR   = reg::TX_ACK_ERROR_COUNT::address,
+  TX_ARB_LOST    = reg::TX_ARB_LOST_COUNT::address,
+  TX_BIT_ERROR   = reg::TX_BIT_ERROR_COUNT::address,
+  TX_RETRANSMIT  = reg::TX_RETRANSMIT_COUNT::address,
+  RX_MSG_RECV    = reg::RX_MSG_RECV_COUNT::address,
+  RX_CRC_ERROR   = reg::RX_CRC_ERROR_COUNT::address,
+  RX_FORM_ERROR  = reg::RX_FORM_ERROR_COUNT::address,
+  RX_STUFF_ERROR = reg::RX_STUFF_ERROR_COUNT::address
+};
+
+constexpr unsigned int NUM_COUNTERS = 10;
+
+static_assert(reg::RX_STUFF_ERROR_COUNT::address - reg::TRANSMIT_ERROR_COUNT::address ==
+              (NUM_COUNTERS + 1) * sizeof(uint32_t),
+              "Counter registers are not contiguous");
+
+// Index of a counter in CounterValues::count, in register order
+constexpr unsigned int counter_index(Counter cnt)
+{
+  return (static_cast<uint32_t>(cnt) - static_cast<uint32_t>(Counter::TX_MSG_SENT)) /
+         sizeof(uint32_t);
+}
+
+/**
+ * Status/error counters and error state of a controller, read at once by
+ * Canola::read_counters()
+ */
+struct CounterValues {
+  uint32_t count[NUM_COUNTERS];  // Indexed by counter_index()
+  uint32_t transmit_error_count;
+  uint32_t receive_error_count;
+  ErrorState error_state;
+};
+
+/**
+ * Bits for Canola::reset_counters(), same as the RESET_*_COUNTER
+ * fields of the CONTROL register
+ */
+enum CounterResetMask : uint32_t {
+  RESET_TX_MSG_SENT    = reg::CONTROL::RESET_TX_MSG_SENT_COUNTER::mask,
+  RESET_TX_FAILED      = reg::CONTROL::RESET_TX_FAILED_COUNTER::mask,
+  RESET_TX_ACK_ERROR   = reg::CONTROL::RESET_TX_ACK_ERROR_COUNTER::mask,
+  RESET_TX_ARB_LOST    = reg::CONTROL::RESET_TX_ARB_LOST_COUNTER::mask,
+  RESET_TX_BIT_ERROR   = reg::CONTROL::RESET_TX_BIT_ERROR_COUNTER::mask,
+  RESET_TX_RETRANSMIT  = reg::CONTROL::RESET_TX_RETRANSMIT_COUNTER::mask,
+  RESET_RX_MSG_RECV    = reg::CONTROL::RESET_RX_MSG_RECV_COUNTER::mask,
+  RESET_RX_CRC_ERROR   = reg::CONTROL::RESET_RX_CRC_ERROR_COUNTER::mask,
+  RESET_RX_FORM_ERROR  = reg::CONTROL::RESET_RX_FORM_ERROR_COUNTER::mask,
+  RESET_RX_STUFF_ERROR = reg::CONTROL::RESET_RX_STUFF_ERROR_COUNTER::mask,
+  RESET_ALL_COUNTERS   = RESET_TX_MSG_SENT | RESET_TX_FAILED | RESET_TX_ACK_ERROR |
+                         RESET_TX_ARB_LOST | RESET_TX_BIT_ERROR | RESET_TX_RETRANSMIT |
+                         RESET_RX_MSG_RECV | RESET_RX_CRC_ERROR | RESET_RX_FORM_ERROR |
+                         RESET_RX_STUFF_ERROR
+};
+
+
+template <typename RegisterIO>
+class Canola
+{
+public:
+  explicit Canola(RegisterIO io) : m_io(io) {}
+
+  RegisterIO& io() { return m_io; }
+  const RegisterIO& io() const { return m_io; }
+
+  // Program the bit timing, see solve_bit_timing() in canola_bit_timing.hpp
+  void init(const BitTiming& timing = BIT_TIMING_DEFAULT)
+  {
+    m_io.write(reg::TIME_QUANTA_CLOCK_SCALE::address, timing.time_quanta_clock_scale);
+    m_io.write(reg::BTL_PROP_SEG::address, btl_segment(timing.prop_seg));
+    m_io.write(reg::BTL_PHASE_SEG1::address, btl_segment(timing.phase_seg1));
+    m_io.write(reg::BTL_PHASE_SEG2::address, btl_segment(timing.phase_seg2));
+    m_io.write(reg::BTL_SYNC_JUMP_WIDTH::address, timing.sync_jump_width);
+  }
+
+  void send_msg(const CanMsg& msg)
+  {
+    m_tx_msg_id_shadow = pack_msg_id(msg);
+    m_tx_length_shadow = msg.data_length;
+    m_tx_shadow_valid  = true;
+
+    m_io.write(reg::TX_MSG_ID::address, m_tx_msg_id_shadow);
+    m_io.write(reg::TX_PAYLOAD_0::address, pack_payload(msg.payload));
+    m_io.write(reg::TX_PAYLOAD_1::address, pack_payload(msg.payload+4));
+    m_io.write(reg::TX_PAYLOAD_LENGTH::address, m_tx_length_shadow);
+
+    // Write to TX_START bit of control register to initiate transaction
+    m_io.write(reg::CONTROL::address, reg::CONTROL::TX_START::mask);
+  }
+
+  CanMsg get_msg() const
+  {
+    uint32_t rx_msg_id_reg      = m_io.read(reg::RX_MSG_ID::address);
+    uint32_t rx_payload_len_reg = m_io.read(reg::RX_PAYLOAD_LENGTH::address);
+    uint32_t rx_payload_0_reg   = m_io.read(reg::RX_PAYLOAD_0::address);
+    uint32_t rx_payload_1_reg   = m_io.read(reg::RX_PAYLOAD_1::address);
+
+    CanMsg msg = unpack_msg(rx_msg_id_reg, rx_payload_len_reg,
+                            rx_payload_0_reg, rx_payload_1_reg);
+    msg.timestamp = read_rx_timestamp();
+    return msg;
+  }
+
+  /**
+   * Send message with the fewest possible register writes:
+   * - Payload registers not covered by the data length (or all of them
+   *   for remote frames) are not written
+   * - TX_MSG_ID and TX_PAYLOAD_LENGTH are not written when they already
+   *   hold the right value from the previous call
+   * - With a RegisterIO that supports 64-bit accesses, TX_PAYLOAD_LENGTH
+   *   and TX_PAYLOAD_0 (8-byte aligned pair) are written in one transaction
+   * Call invalidate_tx_shadow() if the TX registers were written by
+   * something else than this driver instance.
+   */
+  void send_msg_burst(const CanMsg& msg)
+  {
+    write_tx_regs_burst(msg);
+
+    // Write to TX_START bit of control register to initiate transaction
+    m_io.write(reg::CONTROL::address, reg::CONTROL::TX_START::mask);
+  }
+
+  void invalidate_tx_shadow() { m_tx_shadow_valid = false; }
+
+  /**
+   * Read received message with the fewest possible register reads.
+   * Payload registers beyond the data length are not read (unpack_msg()
+   * zeroes those bytes anyway). With a RegisterIO that supports 64-bit
+   * accesses, RX_PAYLOAD_LENGTH and RX_PAYLOAD_0 are read in one transaction.
+   * RX_TIMESTAMP is only read if enabled with set_rx_timestamp_enable().
+   */
+  CanMsg get_msg_burst() const
+  {
+    uint32_t rx_msg_id_reg = m_io.read(reg::RX_MSG_ID::address);
+    uint32_t rx_payload_len_reg = 0;
+    uint32_t rx_payload_0_reg = 0;
+    uint32_t rx_payload_1_reg = 0;
+
+    read_length_and_payload(rx_payload_len_reg, rx_payload_0_reg,
+                            reg::RX_MSG_ID::RTR_EN::get(rx_msg_id_reg) == 0,
+                            std::integral_constant<bool, has_wide_access<RegisterIO>::value>());
+
+    if(reg::RX_MSG_ID::RTR_EN::get(rx_msg_id_reg) == 0 &&
+       reg::RX_PAYLOAD_LENGTH::VALUE::get(rx_payload_len_reg) > 4)
+      rx_payload_1_reg = m_io.read(reg::RX_PAYLOAD_1::address);
+
+    CanMsg msg = unpack_msg(rx_msg_id_reg, rx_payload_len_reg,
+                            rx_payload_0_reg, rx_payload_1_reg);
+    msg.timestamp = read_rx_timestamp();
+    return msg;
+  }
+
+  /**
+   * Free-running timestamp counter of the controller, in clock cycles. It
+   * wraps around after 2^32 cycles (43 s at 100 MHz), and is reset with
+   * the controller.
+   */
+  uint32_t timestamp() const
+  {
+    return m_io.read(reg::TIMESTAMP::address);
+  }
+
+  /**
+   * timestamp() when the last message sent (from the TX registers or a
+   * mailbox) was done, at the end of the frame
+   */
+  uint32_t tx_timestamp() const
+  {
+    return m_io.read(reg::TX_TIMESTAMP::address);
+  }
+
+  /**
+   * Read RX_TIMESTAMP into CanMsg::timestamp in get_msg(), get_msg_burst()
+   * and drain(). Off by default, since it costs a register read per frame,
+   * and the timestamp is left at zero.
+   */
+  void set_rx_timestamp_enable(bool enable) { m_rx_timestamp_en = enable; }
+
+  uint32_t status() const
+  {
+    return m_io.read(reg::STATUS::address);
+  }
+
+  bool is_busy() const
+  {
+    return reg::STATUS::TX_BUSY::get(status()) != 0;
+  }
+
+  bool rx_msg_valid() const
+  {
+    return reg::STATUS::RX_MSG_VALID::get(status()) != 0;
+  }
+
+  ErrorState error_state() const
+  {
+    return to_error_state(status());
+  }
+
+  uint32_t counter(Counter cnt) const
+  {
+    return m_io.read(static_cast<uint32_t>(cnt));
+  }
+
+  /**
+   * Read STATUS and all counter registers (TRANSMIT_ERROR_COUNT to
+   * RX_STUFF_ERROR_COUNT) back to back. With a RegisterIO that supports
+   * 64-bit accesses, the counters are read two at a time (8 instead of 13
+   * transactions).
+   */
+  CounterValues read_counters() const
+  {
+    uint32_t regs[2 + NUM_COUNTERS];
+    CounterValues values;
+
+    values.error_state = to_error_state(status());
+    read_regs(reg::TRANSMIT_ERROR_COUNT::address, regs, 2 + NUM_COUNTERS,
+              std::integral_constant<bool, has_wide_access<RegisterIO>::value>());
+
+    values.transmit_error_count = regs[0];
+    values.receive_error_count = regs[1];
+    for(unsigned int i = 0; i < NUM_COUNTERS; i++)
+      values.count[i] = regs[2 + i];
+
+    return values;
+  }
+
+  uint32_t transmit_error_count() const
+  {
+    return m_io.read(reg::TRANSMIT_ERROR_COUNT::address);
+  }
+
+  uint32_t receive_error_count() const
+  {
+    return m_io.read(reg::RECEIVE_ERROR_COUNT::address);
+  }
+
+  /**
+   * Reset one or more counters. mask is a combination of CounterResetMask
+   */
+  void reset_counters(uint32_t mask = RESET_ALL_COUNTERS)
+  {
+    m_io.write(reg::CONTROL::address, mask & RESET_ALL_COUNTERS);
+  }
+
+  void set_retransmit_enable(bool enable)
+  {
+    set_config_bit(reg::CONFIG::TX_RETRANSMIT_EN::mask, enable);
+  }
+
+  void set_triple_sampling_enable(bool enable)
+  {
+    set_config_bit(reg::CONFIG::BTL_TRIPLE_SAMPLING_EN::mask, enable);
+  }
+
+  /**
+   * Write acceptance filter number index. A received message matches the
+   * filter when the ID bits that are set in mask are equal in the message
+   * and in id. For the mask, ext_id and remote_frame set means that the
+   * frame type and RTR bit must match.
+   * The number of filters is set by the G_ACCEPTANCE_FILTERS generic
+   * of the AXI slave, writes to filters above that are ignored.
+   */
+  void set_acceptance_filter(unsigned int index, const CanMsg& id, const CanMsg& mask,
+                             bool enable = true)
+  {
+    reg::FILTER_ID::Value filter_id{};
+    filter_id.EXT_ID_EN = id.ext_id;
+    filter_id.RTR_EN = id.remote_frame;
+    filter_id.ARB_ID_B = id.arb_id_b;
+    filter_id.ARB_ID_A = id.arb_id_a;
+    filter_id.ENABLE = enable;
+
+    reg::FILTER_MASK::Value filter_mask{};
+    filter_mask.EXT_ID_EN = mask.ext_id;
+    filter_mask.RTR_EN = mask.remote_frame;
+    filter_mask.ARB_ID_B = mask.arb_id_b;
+    filter_mask.ARB_ID_A = mask.arb_id_a;
+
+    m_io.write(reg::FILTER_INDEX::address, index);
+    m_io.write(reg::FILTER_ID::address, reg::FILTER_ID::pack(filter_id));
+    m_io.write(reg::FILTER_MASK::address, reg::FILTER_MASK::pack(filter_mask));
+    m_io.write(reg::CONTROL::address, reg::CONTROL::FILTER_WRITE::mask);
+  }
+
+  void disable_acceptance_filter(unsigned int index)
+  {
+    m_io.write(reg::FILTER_INDEX::address, index);
+    m_io.write(reg::FILTER_ID::address, 0);
+    m_io.write(reg::CONTROL::address, reg::CONTROL::FILTER_WRITE::mask);
+  }
+
+  /**
+   * With acceptance filtering enabled, only messages that match one of
+   * the enabled filters are received (i.e. raise the Rx interrupt).
+   */
+  void set_acceptance_filter_enable(bool enable)
+  {
+    set_config_bit(reg::CONFIG::ACCEPTANCE_FILTER_EN::mask, enable);
+  }
+
+  // Index of the filter that accepted the last received message
+  unsigned int rx_filter_hit() const
+  {
+    return reg::RX_FILTER_HIT::VALUE::get(m_io.read(reg::RX_FILTER_HIT::address));
+  }
+
+  /**
+   * Enable/disable the Rx FIFO. With the FIFO enabled, the RX registers show
+   * the oldest message in the FIFO, and the Rx valid interrupt is pulsed
+   * when a message is stored and the fill level is at or above irq_level.
+   * Disabling the FIFO discards the messages in it.
+   */
+  void set_rx_fifo_enable(bool enable, unsigned int irq_level = 1)
+  {
+    m_io.write(reg::RX_FIFO_IRQ_LEVEL::address, irq_level);
+    set_config_bit(reg::CONFIG::RX_FIFO_EN::mask, enable);
+  }
+
+  reg::RX_FIFO_STATUS::Value rx_fifo_status() const
+  {
+    return reg::RX_FIFO_STATUS::unpack(m_io.read(reg::RX_FIFO_STATUS::address));
+  }
+
+  void rx_fifo_flush()
+  {
+    m_io.write(reg::CONTROL::address, reg::CONTROL::RX_FIFO_FLUSH::mask);
+  }
+
+  /**
+   * Empty the Rx FIFO in one pass, calling handler(const CanMsg&) for each
+   * message. The fill level is read once, and messages that arrive while
+   * draining are left for the next call. overflow (optional) is set if
+   * messages were dropped because the FIFO was full, and the overflow flag
+   * is cleared. Returns the number of messages drained.
+   */
+  template <typename Handler>
+  unsigned int drain(Handler&& handler, bool* overflow = nullptr)
+  {
+    return drain_fifo(~0u, std::forward<Handler>(handler), overflow);
+  }
+
+  /**
+   * Same as above, but copies up to max_msgs messages to msgs
+   */
+  unsigned int drain(CanMsg* msgs, unsigned int max_msgs, bool* overflow = nullptr)
+  {
+    return drain_fifo(max_msgs, [&msgs](const CanMsg& msg) { *msgs++ = msg; }, overflow);
+  }
+
+  /**
+   * Enable/disable the Tx mailboxes. With the mailboxes enabled, the
+   * pending mailbox with the highest priority (lowest ID) is always sent
+   * first, and send_msg()/send_msg_burst() (TX_START) are ignored.
+   * Disabling the mailboxes discards any pending messages.
+   */
+  void set_tx_mailbox_enable(bool enable)
+  {
+    set_config_bit(reg::CONFIG::TX_MAILBOX_EN::mask, enable);
+  }
+
+  // Number of Tx mailboxes (G_TX_MAILBOXES generic of the AXI slave)
+  unsigned int tx_mailbox_count() const
+  {
+    return reg::TX_MAILBOX_COUNT::VALUE::get(m_io.read(reg::TX_MAILBOX_COUNT::address));
+  }
+
+  /**
+   * Find a Tx mailbox that is not pending. Returns the lowest numbered free
+   * mailbox, or -1 if all mailboxes are pending.
+   */
+  int alloc_tx_mailbox() const
+  {
+    const unsigned int count = tx_mailbox_count();
+    const uint32_t pending = m_io.read(reg::TX_MAILBOX_PENDING::address);
+
+    for(unsigned int i = 0; i < count; i++) {
+      if((pending & (uint32_t(1) << i)) == 0)
+        return i;
+    }
+
+    return -1;
+  }
+
+  /**
+   * Load msg into a Tx mailbox, which clears its done/failed status.
+   * Returns false (and does not load it) if the mailbox is pending.
+   */
+  bool send_msg_mailbox(unsigned int mailbox, const CanMsg& msg)
+  {
+    if(m_io.read(reg::TX_MAILBOX_PENDING::address) & (uint32_t(1) << mailbox))
+      return false;
+
+    write_tx_regs_burst(msg);
+
+    m_io.write(reg::TX_MAILBOX_INDEX::address, mailbox);
+    m_io.write(reg::CONTROL::address, reg::CONTROL::TX_MAILBOX_LOAD::mask);
+
+    return true;
+  }
+
+  /**
+   * Abort the pending mailboxes in mask (one bit per mailbox). Aborted
+   * mailboxes are reported as failed. A mailbox that is being sent is
+   * aborted if the attempt fails, and is reported as done if it succeeds.
+   */
+  void abort_tx_mailboxes(uint32_t mask)
+  {
+    m_io.write(reg::TX_MAILBOX_ABORT::address, mask);
+  }
+
+  struct TxMailboxStatus {
+    uint32_t pending;
+    uint32_t done;
+    uint32_t failed;
+  };
+
+  // Mailboxes waiting to be sent or being sent, one bit per mailbox
+  uint32_t tx_mailbox_pending() const
+  {
+    return m_io.read(reg::TX_MAILBOX_PENDING::address);
+  }
+
+  TxMailboxStatus tx_mailbox_status() const
+  {
+    return {m_io.read(reg::TX_MAILBOX_PENDING::address),
+            m_io.read(reg::TX_MAILBOX_DONE::address),
+            m_io.read(reg::TX_MAILBOX_FAILED::address)};
+  }
+
+  static uint32_t pack_msg_id(const CanMsg& msg)
+  {
+    reg::TX_MSG_ID::Value msg_id{};
+    msg_id.EXT_ID_EN = msg.ext_id;
+    msg_id.RTR_EN = msg.remote_frame;
+    msg_id.ARB_ID_B = msg.arb_id_b;
+    msg_id.ARB_ID_A = msg.arb_id_a;
+    return reg::TX_MSG_ID::pack(msg_id);
+  }
+
+  static uint32_t pack_payload(const uint8_t* bytes)
+  {
+    // Same layout for TX_PAYLOAD_0 and TX_PAYLOAD_1
+    reg::TX_PAYLOAD_0::Value payload{};
+    payload.PAYLOAD_BYTE_0 = bytes[0];
+    payload.PAYLOAD_BYTE_1 = bytes[1];
+    payload.PAYLOAD_BYTE_2 = bytes[2];
+    payload.PAYLOAD_BYTE_3 = bytes[3];
+    return reg::TX_PAYLOAD_0::pack(payload);
+  }
+
+  static CanMsg unpack_msg(uint32_t msg_id_reg, uint32_t payload_len_reg,
+                           uint32_t payload_0_reg, uint32_t payload_1_reg)
+  {
+    CanMsg msg;
+
+    msg.timestamp = 0;
+
+    const reg::RX_MSG_ID::Value msg_id = reg::RX_MSG_ID::unpack(msg_id_reg);
+
+    msg.arb_id_a = msg_id.ARB_ID_A;
+    msg.ext_id = msg_id.EXT_ID_EN != 0;
+    msg.arb_id_b = msg.ext_id ? msg_id.ARB_ID_B : 0;
+    msg.remote_frame = msg_id.RTR_EN != 0;
+    msg.data_length = reg::RX_PAYLOAD_LENGTH::VALUE::get(payload_len_reg);
+
+    for(unsigned int i = 0; i < 4; i++) {
+      msg.payload[i]   = payload_0_reg >> (8*i);
+      msg.payload[i+4] = payload_1_reg >> (8*i);
+    }
+
+    // Set bytes not included in message to zero
+    for(unsigned int i = 0; i < 8; i++) {
+      if(msg.remote_frame || i >= msg.data_length)
+        msg.payload[i] = 0;
+    }
+
+    return msg;
+  }
+
+private:
+  uint32_t read_rx_timestamp() const
+  {
+    return m_rx_timestamp_en ? m_io.read(reg::RX_TIMESTAMP::address) : 0;
+  }
+
+  template <typename Handler>
+  unsigned int drain_fifo(unsigned int max_msgs, Handler&& handler, bool* overflow)
+  {
+    const uint32_t status_reg = m_io.read(reg::RX_FIFO_STATUS::address);
+    const bool fifo_overflow = reg::RX_FIFO_STATUS::OVERFLOW::get(status_reg) != 0;
+    unsigned int count = reg::RX_FIFO_STATUS::FILL_LEVEL::get(status_reg);
+
+    if(count > max_msgs)
+      count = max_msgs;
+
+    for(unsigned int i = 0; i < count; i++) {
+      handler(get_msg_burst());
+      m_io.write(reg::CONTROL::address, reg::CONTROL::RX_FIFO_POP::mask);
+    }
+
+    if(fifo_overflow)
+      m_io.write(reg::CONTROL::address, reg::CONTROL::RX_FIFO_CLEAR_OVERFLOW::mask);
+
+    if(overflow != nullptr)
+      *overflow = fifo_overflow;
+
+    return count;
+  }
+
+  // Write msg to the TX registers, skipping registers that already hold
+  // the right value (see send_msg_burst())
+  void write_tx_regs_burst(const CanMsg& msg)
+  {
+    const uint32_t msg_id_reg = pack_msg_id(msg);
+    const uint32_t length_reg = msg.data_length;
+    const unsigned int payload_regs = msg.remote_frame ? 0 : (msg.data_length+3)/4;
+
+    if(!m_tx_shadow_valid || msg_id_reg != m_tx_msg_id_shadow)
+      m_io.write(reg::TX_MSG_ID::address, msg_id_reg);
+
+    write_length_and_payload(msg, length_reg, payload_regs,
+                             std::integral_constant<bool, has_wide_access<RegisterIO>::value>());
+
+    if(payload_regs > 1)
+      m_io.write(reg::TX_PAYLOAD_1::address, pack_payload(msg.payload+4));
+
+    m_tx_msg_id_shadow = msg_id_reg;
+    m_tx_length_shadow = length_reg;
+    m_tx_shadow_valid  = true;
+  }
+
+  static_assert(reg::TX_PAYLOAD_LENGTH::address % 8 == 0 &&
+                reg::TX_PAYLOAD_0::address == reg::TX_PAYLOAD_LENGTH::address + 4 &&
+                reg::RX_PAYLOAD_LENGTH::address % 8 == 0 &&
+                reg::RX_PAYLOAD_0::address == reg::RX_PAYLOAD_LENGTH::address + 4,
+                "PAYLOAD_LENGTH and PAYLOAD_0 registers must be an 8-byte aligned pair");
+
+  void write_length_and_payload(const CanMsg& msg, uint32_t length_reg,
+                                unsigned int payload_regs, std::false_type)
+  {
+    if(!m_tx_shadow_valid || length_reg != m_tx_length_shadow)
+      m_io.write(reg::TX_PAYLOAD_LENGTH::address, length_reg);
+
+    if(payload_regs > 0)
+      m_io.write(reg::TX_PAYLOAD_0::address, pack_payload(msg.payload));
+  }
+
+  void write_length_and_payload(const CanMsg& msg, uint32_t length_reg,
+                                unsigned int payload_regs, std::true_type)
+  {
+    if(payload_regs > 0)
+      m_io.write64(reg::TX_PAYLOAD_LENGTH::address,
+                   uint64_t(length_reg) | (uint64_t(pack_payload(msg.payload)) << 32));
+    else if(!m_tx_shadow_valid || length_reg != m_tx_length_shadow)
+      m_io.write(reg::TX_PAYLOAD_LENGTH::address, length_reg);
+  }
+
+  void read_length_and_payload(uint32_t& length_reg, uint32_t& payload_0_reg,
+                               bool has_payload, std::false_type) const
+  {
+    length_reg = m_io.read(reg::RX_PAYLOAD_LENGTH::address);
+
+    if(has_payload && reg::RX_PAYLOAD_LENGTH::VALUE::get(length_reg) > 0)
+      payload_0_reg = m_io.read(reg::RX_PAYLOAD_0::address);
+  }
+
+  void read_length_and_payload(uint32_t& length_reg, uint32_t& payload_0_reg,
+                               bool has_payload, std::true_type) const
+  {
+    if(has_payload) {
+      uint64_t data = m_io.read64(reg::RX_PAYLOAD_LENGTH::address);
+      length_reg = uint32_t(data);
+      payload_0_reg = uint32_t(data >> 32);
+    } else {
+      length_reg = m_io.read(reg::RX_PAYLOAD_LENGTH::address);
+    }
+  }
+
+  void read_regs(uint32_t offset, uint32_t* regs, unsigned int count, std::false_type) const
+  {
+    for(unsigned int i = 0; i < count; i++)
+      regs[i] = m_io.read(offset + i * sizeof(uint32_t));
+  }
+
+  // 64-bit reads of the 8-byte aligned pairs, 32-bit reads of the rest
+  void read_regs(uint32_t offset, uint32_t* regs, unsigned int count, std::true_type) const
+  {
+    unsigned int i = 0;
+    if(offset % 8 != 0 && count > 0)
+      regs[i++] = m_io.read(offset);
+
+    for(; i + 1 < count; i += 2) {
+      uint64_t data = m_io.read64(offset + i * sizeof(uint32_t));
+      regs[i] = uint32_t(data);
+      regs[i+1] = uint32_t(data >> 32);
+    }
+    if(i < count)
+      regs[i] = m_io.read(offset + i * sizeof(uint32_t));
+  }
+
+  static ErrorState to_error_state(uint32_t status)
+  {
+    uint32_t state = reg::STATUS::ERROR_STATE::get(status);
+
+    // b1X = BUS_OFF
+    return state >= 2 ? ErrorState::BUS_OFF : static_cast<ErrorState>(state);
+  }
+
+  void set_config_bit(uint32_t mask, bool value)
+  {
+    uint32_t config = m_io.read(reg::CONFIG::address);
+    m_io.write(reg::CONFIG::address, value ? (config | mask) : (config & ~mask));
+  }
+
+  RegisterIO m_io;
+
+  // Last values written to TX_MSG_ID and TX_PAYLOAD_LENGTH by send_msg_burst()
+  uint32_t m_tx_msg_id_shadow = 0;
+  uint32_t m_tx_length_shadow = 0;
+  bool m_tx_shadow_valid = false;
+  bool m_rx_timestamp_en = false;
+};
+
+
+inline bool compare_messages(const CanMsg& msg1, const CanMsg& msg2)
+{
+  if(msg1.arb_id_a != msg2.arb_id_a || msg1.ext_id != msg2.ext_id)
+    return false;
+
+  if(msg1.ext_id && msg1.arb_id_b != msg2.arb_id_b)
+    return false;
+
+  if(msg1.remote_frame != msg2.remote_frame || msg1.data_length != msg2.data_length)
+    return false;
+
+  if(!msg1.remote_frame) {
+    for(unsigned int i = 0; i < 8 && i < msg1.data_length; i++) {
+      if(msg1.payload[i] != msg2.payload[i])
+        return false;
+    }
+  }
+
+  return true;
+}
+
+} // namespace canola
+
+#endif
@@ -0,0 +1,562 @@
+/**
+ * @file   canola_archive.hpp
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Compressed archive of frame traces (canola_trace.hpp) for long
+ *         recordings, with an index that lets queries for a time range or
+ *         an arbitration ID skip the blocks that can not match.
+ *
+ *         The frames are stored in blocks of BLOCK_FRAMES_DEFAULT frames.
+ *         Within a block the fields of the records (the fields of CanMsg,
+ *         plus controller and times) are stored in columns:
+ *
+ *           time:       host time, delta from the previous frame
+ *           timestamp:  controller timestamp, delta from the previous frame
+ *           entry:      index into a dictionary of the combinations of ID,
+ *                       controller, flags and data length in the block, one
+ *                       byte per frame with up to 256 entries
+ *           payload:    the bytes that changed since the previous frame
+ *                       with the same entry, after a mask of which bytes
+ *
+ *         Deltas of times are zigzag encoded varints (LEB128), so the usual
+ *         tens to hundreds of us between frames take 3 bytes instead of 8.
+ *         Periodic messages where only a counter or a signal changes take
+ *         one or two bytes of payload. Payload bytes past the data length,
+ *         and of remote frames, are not kept, and read back as zero.
+ *
+ *         File layout: FileHeader, blocks, and the index at the end, with
+ *         a BlockIndex per block. A BlockIndex has the offset of the block,
+ *         the first and last time in it, and a bitmap of the 11-bit
+ *         arb_id_a of the frames in it (the whole standard ID, the top bits
+ *         of an extended ID). The index is written when the archive is
+ *         closed, and read on open.
+ */
+
+#ifndef CANOLA_ARCHIVE_HPP
+#define CANOLA_ARCHIVE_HPP
+
+#include "canola_trace.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace canola
+{
+namespace archive
+{
+
+constexpr unsigned int BLOCK_FRAMES_DEFAULT = 4096;
+constexpr unsigned int ID_BITMAP_BYTES = 2048 / 8;
+constexpr unsigned int NUM_COLUMNS = 4;
+
+enum Column : unsigned int {
+  COLUMN_TIME = 0,
+  COLUMN_TIMESTAMP,
+  COLUMN_ENTRY,
+  COLUMN_PAYLOAD
+};
+
+struct FileHeader {
+  static constexpr uint32_t MAGIC   = 0x43415243;  // "CARC"
+  static constexpr uint32_t VERSION = 1;
+
+  uint32_t magic;
+  uint32_t version;
+  uint32_t block_frames;
+  uint32_t reserved;
+  uint64_t start_time_ns;  // Of the trace that was archived
+  uint64_t num_frames;
+  uint64_t num_blocks;
+  uint64_t index_offset;   // 0 until the archive is closed
+  uint64_t padding[2];
+};
+
+static_assert(sizeof(FileHeader) == 64, "Archive header must be 64 bytes");
+
+struct BlockIndex {
+  uint64_t offset;
+  uint32_t size;
+  uint32_t frames;
+  uint64_t min_time_ns;
+  uint64_t max_time_ns;
+  uint8_t id_bitmap[ID_BITMAP_BYTES];  // Bit arb_id_a set if in the block
+};
+
+// Key of an ID in the dictionary, the extended ID flag in the MSB
+inline uint32_t id_key(const trace::Record& rec)
+{
+  return rec.arb_id | ((rec.flags & trace::FLAG_EXT_ID) ? 0x80000000u : 0);
+}
+
+// Dictionary entry of a frame: ID key, controller, flags (low nibble) and
+// data length (high nibble)
+inline uint64_t entry_key(const trace::Record& rec)
+{
+  return (uint64_t(id_key(rec)) << 16) | (uint64_t(rec.controller) << 8) |
+         (rec.flags & 0x0F) | (rec.data_length << 4);
+}
+
+// Top 11 bits of an ID (arb_id_a), the bit in the ID bitmap
+inline uint32_t id_bit(uint32_t key)
+{
+  return (key & 0x80000000u) ? (key >> 18) & 0x7FF : key & 0x7FF;
+}
+
+// Payload bytes kept in the archive
+inline unsigned int payload_length(uint8_t flags, uint8_t data_length)
+{
+  return (flags & trace::FLAG_REMOTE_FRAME) ? 0 : data_length < 8 ? data_length : 8;
+}
+
+inline uint64_t zigzag(int64_t value)
+{
+  return (uint64_t(value) << 1) ^ uint64_t(value >> 63);
+}
+
+inline int64_t unzigzag(uint64_t value)
+{
+  return int64_t(value >> 1) ^ -int64_t(value & 1);
+}
+
+inline void put_varint(std::vector<uint8_t>& out, uint64_t value)
+{
+  while(value >= 0x80) {
+    out.push_back(uint8_t(value) | 0x80);
+    value >>= 7;
+  }
+  out.push_back(uint8_t(value));
+}
+
+// Returns false if the varint runs past end
+inline bool get_varint(const uint8_t*& pos, const uint8_t* end, uint64_t& value)
+{
+  value = 0;
+  for(unsigned int shift = 0; pos < end && shift < 64; shift += 7) {
+    const uint8_t byte = *pos++;
+    value |= uint64_t(byte & 0x7F) << shift;
+    if(!(byte & 0x80))
+      return true;
+  }
+  return false;
+}
+
+
+/**
+ * Frames to find with ArchiveReader::query(). All frames match by default.
+ */
+struct Query {
+  uint64_t from_ns = 0;           // Host time, inclusive
+  uint64_t to_ns = UINT64_MAX;    // Host time, exclusive
+  bool match_id = false;
+  uint32_t arb_id = 0;            // Same as trace::Record::arb_id
+  bool ext_id = false;
+  int controller = -1;            // -1 for all controllers
+
+  void set_id(uint32_t id, bool ext)
+  {
+    match_id = true;
+    arb_id = id;
+    ext_id = ext;
+  }
+};
+
+struct QueryStats {
+  uint64_t blocks_skipped = 0;   // By the index (time or ID bitmap)
+  uint64_t blocks_no_entry = 0;  // ID bit set, but no entry in the dictionary matches
+  uint64_t blocks_decoded = 0;
+  uint64_t frames_decoded = 0;
+  uint64_t frames_matched = 0;
+};
+
+
+class ArchiveWriter
+{
+public:
+  ArchiveWriter() = default;
+  ArchiveWriter(const ArchiveWriter&) = delete;
+  ArchiveWriter& operator=(const ArchiveWriter&) = delete;
+
+  ~ArchiveWriter() { close(); }
+
+  bool create(const std::string& path, uint64_t start_time_ns = 0,
+              unsigned int block_frames = BLOCK_FRAMES_DEFAULT)
+  {
+    close();
+
+    m_file = std::fopen(path.c_str(), "wb");
+    if(m_file == nullptr)
+      return false;
+
+    m_header = FileHeader{};
+    m_header.magic = FileHeader::MAGIC;
+    m_header.version = FileHeader::VERSION;
+    m_header.block_frames = std::min(std::max(block_frames, 1u), 65536u);
+    m_header.start_time_ns = start_time_ns;
+    m_offset = sizeof(FileHeader);
+    m_ok = std::fwrite(&m_header, sizeof(m_header), 1, m_file) == 1;
+
+    m_index.clear();
+    m_block.clear();
+    m_block.reserve(m_header.block_frames);
+    return m_ok;
+  }
+
+  bool is_open() const { return m_file != nullptr; }
+
+  void append(const trace::Record& rec)
+  {
+    m_block.push_back(rec);
+    if(m_block.size() == m_header.block_frames)
+      flush_block();
+  }
+
+  uint64_t num_frames() const { return m_header.num_frames + m_block.size(); }
+
+  // Bytes written so far, not counting the frames not yet in a block
+  uint64_t size() const { return m_offset; }
+
+  /**
+   * Write the last block, the index and the final header. Returns false if
+   * any write failed.
+   */
+  bool close()
+  {
+    if(m_file == nullptr)
+      return m_ok;
+
+    if(!m_block.empty())
+      flush_block();
+
+    m_header.num_blocks = m_index.size();
+    m_header.index_offset = m_offset;
+    if(!m_index.empty())
+      write(m_index.data(), m_index.size() * sizeof(BlockIndex));
+
+    m_ok = m_ok && std::fseek(m_file, 0, SEEK_SET) == 0 &&
+           std::fwrite(&m_header, sizeof(m_header), 1, m_file) == 1;
+    m_ok = std::fclose(m_file) == 0 && m_ok;
+    m_file = nullptr;
+    return m_ok;
+  }
+
+private:
+  void write(const void* data, size_t size)
+  {
+    m_ok = m_ok && std::fwrite(data, 1, size, m_file) == size;
+    m_offset += size;
+  }
+
+  void flush_block()
+  {
+    BlockIndex index = {};
+    index.offset = m_offset;
+    index.frames = m_block.size();
+    index.min_time_ns = UINT64_MAX;
+
+    std::vector<uint8_t> (&columns)[NUM_COLUMNS] = m_columns;
+    for(auto& column : columns)
+      column.clear();
+
+    // Dictionary of the IDs, in order of appearance
+    m_dict.clear();
+    m_dict_entries.clear();
+    for(const trace::Record& rec : m_block) {
+      if(m_dict_entries.emplace(entry_key(rec), m_dict.size()).second)
+        m_dict.push_back(entry_key(rec));
+    }
+    const bool wide_entries = m_dict.size() > 256;
+    m_prev_payload.assign(m_dict.size() * 8, 0);
+
+    uint64_t prev_time_ns = m_block.front().time_ns;
+    uint32_t prev_timestamp = m_block.front().timestamp;
+    uint32_t last_entry = 0;
+
+    for(const trace::Record& rec : m_block) {
+      index.min_time_ns = std::min(index.min_time_ns, rec.time_ns);
+      index.max_time_ns = std::max(index.max_time_ns, rec.time_ns);
+
+      put_varint(columns[COLUMN_TIME], zigzag(int64_t(rec.time_ns - prev_time_ns)));
+      put_varint(columns[COLUMN_TIMESTAMP], zigzag(int32_t(rec.timestamp - prev_timestamp)));
+      prev_time_ns = rec.time_ns;
+      prev_timestamp = rec.timestamp;
+
+      // Frames with the same entry often come in runs, try the last one first
+      const uint64_t key = entry_key(rec);
+      if(m_dict[last_entry] != key)
+        last_entry = m_dict_entries[key];
+      columns[COLUMN_ENTRY].push_back(uint8_t(last_entry));
+      if(wide_entries)
+        columns[COLUMN_ENTRY].push_back(uint8_t(last_entry >> 8));
+
+      const uint32_t bit = id_bit(id_key(rec));
+      index.id_bitmap[bit / 8] |= 1 << (bit % 8);
+
+      const unsigned int length = payload_length(rec.flags, rec.data_length);
+      if(length > 0) {
+        uint8_t* prev = &m_prev_payload[last_entry * 8];
+        std::vector<uint8_t>& column = columns[COLUMN_PAYLOAD];
+        const size_t mask_pos = column.size();
+        uint8_t mask = 0;
+
+        column.push_back(0);
+        for(unsigned int b = 0; b < length; b++) {
+          if(rec.payload[b] != prev[b]) {
+            mask |= 1 << b;
+            column.push_back(rec.payload[b]);
+            prev[b] = rec.payload[b];
+          }
+        }
+        column[mask_pos] = mask;
+      }
+    }
+
+    // Block: frames, first time and timestamp, dictionary, then the
+    // columns, each with its size first
+    m_buf.clear();
+    put_varint(m_buf, m_block.size());
+    put_varint(m_buf, m_block.front().time_ns);
+    put_varint(m_buf, m_block.front().timestamp);
+    put_varint(m_buf, m_dict.size());
+    for(uint64_t key : m_dict)
+      put_varint(m_buf, key);
+    for(const auto& column : columns)
+      put_varint(m_buf, column.size());
+    for(const auto& column : columns)
+      m_buf.insert(m_buf.end(), column.begin(), column.end());
+
+    write(m_buf.data(), m_buf.size());
+
+    index.size = m_buf.size();
+    m_index.push_back(index);
+    m_header.num_frames += m_block.size();
+    m_block.clear();
+  }
+
+  std::FILE* m_file = nullptr;
+  bool m_ok = true;
+  FileHeader m_header = {};
+  uint64_t m_offset = 0;
+  std::vector<BlockIndex> m_index;
+  std::vector<trace::Record> m_block;
+  std::vector<uint64_t> m_dict;
+  std::unordered_map<uint64_t, uint32_t> m_dict_entries;
+  std::vector<uint8_t> m_prev_payload;  // 8 bytes per dictionary entry
+  std::vector<uint8_t> m_columns[NUM_COLUMNS];
+  std::vector<uint8_t> m_buf;
+};
+
+
+/**
+ * Queries on an archive, mapped read-only
+ */
+class ArchiveReader
+{
+public:
+  ArchiveReader() = default;
+  ArchiveReader(const ArchiveReader&) = delete;
+  ArchiveReader& operator=(const ArchiveReader&) = delete;
+
+  ~ArchiveReader()
+  {
+    if(m_data != nullptr)
+      ::munmap(const_cast<uint8_t*>(m_data), m_size);
+  }
+
+  bool open(const std::string& path)
+  {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0)
+      return false;
+
+    struct stat st;
+    void* ptr = MAP_FAILED;
+    if(::fstat(fd, &st) == 0 && size_t(st.st_size) >= sizeof(FileHeader)) {
+      m_size = size_t(st.st_size);
+      ptr = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+
+    if(ptr == MAP_FAILED)
+      return false;
+
+    m_data = static_cast<const uint8_t*>(ptr);
+    m_header = reinterpret_cast<const FileHeader*>(m_data);
+
+    // Not closed, or not an archive
+    if(m_header->magic != FileHeader::MAGIC || m_header->version != FileHeader::VERSION ||
+       m_header->index_offset < sizeof(FileHeader) || m_header->index_offset > m_size ||
+       (m_size - m_header->index_offset) / sizeof(BlockIndex) < m_header->num_blocks) {
+      ::munmap(ptr, m_size);
+      m_data = nullptr;
+      return false;
+    }
+
+    m_index = reinterpret_cast<const BlockIndex*>(m_data + m_header->index_offset);
+    return true;
+  }
+
+  bool is_open() const { return m_data != nullptr; }
+  const FileHeader& header() const { return *m_header; }
+  uint64_t num_frames() const { return m_header->num_frames; }
+  uint64_t num_blocks() const { return m_header->num_blocks; }
+  const BlockIndex& block(uint64_t index) const { return m_index[index]; }
+  size_t size() const { return m_size; }
+
+  /**
+   * Call handler(const trace::Record&) for every frame that matches the
+   * query, in the order of the trace. Returns the number of frames that
+   * matched, or stops at, and returns, ~0 for a corrupt block.
+   */
+  template <typename Handler>
+  uint64_t query(const Query& q, Handler&& handler, QueryStats* stats = nullptr) const
+  {
+    QueryStats local;
+    QueryStats& s = stats != nullptr ? *stats : local;
+    const uint32_t key = q.arb_id | (q.ext_id ? 0x80000000u : 0);
+    const uint32_t bit = id_bit(key);
+
+    for(uint64_t b = 0; b < m_header->num_blocks; b++) {
+      const BlockIndex& index = m_index[b];
+
+      if(index.max_time_ns < q.from_ns || index.min_time_ns >= q.to_ns ||
+         (q.match_id && !(index.id_bitmap[bit / 8] & (1 << (bit % 8))))) {
+        s.blocks_skipped++;
+        continue;
+      }
+
+      if(index.offset + index.size > m_header->index_offset ||
+         !decode_block(m_data + index.offset, m_data + index.offset + index.size, q, key,
+                       handler, s))
+        return ~uint64_t(0);
+    }
+
+    return s.frames_matched;
+  }
+
+private:
+  template <typename Handler>
+  bool decode_block(const uint8_t* pos, const uint8_t* end, const Query& q, uint32_t key,
+                    Handler& handler, QueryStats& s) const
+  {
+    uint64_t frames, time_ns, timestamp, dict_size;
+    if(!get_varint(pos, end, frames) || !get_varint(pos, end, time_ns) ||
+       !get_varint(pos, end, timestamp) || !get_varint(pos, end, dict_size) ||
+       frames == 0 || dict_size == 0 || dict_size > frames)
+      return false;
+
+    // Match the query against the dictionary before decoding anything else
+    std::vector<uint64_t> entries(dict_size);
+    std::vector<uint8_t> matches(dict_size);
+    bool any_match = false;
+    for(uint64_t i = 0; i < dict_size; i++) {
+      if(!get_varint(pos, end, entries[i]))
+        return false;
+      matches[i] = (!q.match_id || uint32_t(entries[i] >> 16) == key) &&
+                   (q.controller < 0 || int((entries[i] >> 8) & 0xFF) == q.controller);
+      any_match = any_match || matches[i];
+    }
+
+    if(!any_match) {
+      s.blocks_no_entry++;
+      return true;
+    }
+
+    uint64_t sizes[NUM_COLUMNS];
+    const uint8_t* columns[NUM_COLUMNS];
+    for(auto& size : sizes) {
+      if(!get_varint(pos, end, size))
+        return false;
+    }
+    for(unsigned int c = 0; c < NUM_COLUMNS; c++) {
+      if(sizes[c] > uint64_t(end - pos))
+        return false;
+      columns[c] = pos;
+      pos += sizes[c];
+    }
+
+    const bool wide_entries = dict_size > 256;
+    if(sizes[COLUMN_ENTRY] != frames * (wide_entries ? 2 : 1))
+      return false;
+
+    // Payload of the previous frame with each entry
+    std::vector<uint8_t> prev_payload(dict_size * 8);
+
+    const uint8_t* time_pos = columns[COLUMN_TIME];
+    const uint8_t* time_end = time_pos + sizes[COLUMN_TIME];
+    const uint8_t* ts_pos = columns[COLUMN_TIMESTAMP];
+    const uint8_t* ts_end = ts_pos + sizes[COLUMN_TIMESTAMP];
+    const uint8_t* entry_pos = columns[COLUMN_ENTRY];
+    const uint8_t* payload = columns[COLUMN_PAYLOAD];
+    const uint8_t* payload_end = payload + sizes[COLUMN_PAYLOAD];
+
+    s.blocks_decoded++;
+    s.frames_decoded += frames;
+
+    trace::Record rec = {};
+    for(uint64_t i = 0; i < frames; i++) {
+      uint64_t time_delta, ts_delta;
+      if(!get_varint(time_pos, time_end, time_delta) || !get_varint(ts_pos, ts_end, ts_delta))
+        return false;
+      time_ns += unzigzag(time_delta);
+      timestamp += unzigzag(ts_delta);
+
+      unsigned int entry = *entry_pos++;
+      if(wide_entries)
+        entry |= *entry_pos++ << 8;
+      if(entry >= dict_size)
+        return false;
+
+      const uint8_t meta = uint8_t(entries[entry]);
+      const unsigned int length = payload_length(meta & 0x0F, meta >> 4);
+      uint8_t* prev = &prev_payload[entry * 8];
+
+      if(length > 0) {
+        if(payload == payload_end)
+          return false;
+
+        const uint8_t mask = *payload++;
+        if(unsigned(__builtin_popcount(mask)) > uint64_t(payload_end - payload))
+          return false;
+        for(unsigned int b = 0; b < length; b++) {
+          if(mask & (1 << b))
+            prev[b] = *payload++;
+        }
+      }
+
+      if(matches[entry] && time_ns >= q.from_ns && time_ns < q.to_ns) {
+        rec.time_ns = time_ns;
+        rec.timestamp = uint32_t(timestamp);
+        rec.arb_id = uint32_t(entries[entry] >> 16) & 0x7FFFFFFFu;
+        rec.controller = uint8_t(entries[entry] >> 8);
+        rec.flags = meta & 0x0F;
+        rec.data_length = meta >> 4;
+        std::memset(rec.payload, 0, sizeof(rec.payload));
+        std::memcpy(rec.payload, prev, length);
+
+        handler(rec);
+        s.frames_matched++;
+      }
+    }
+
+    return true;
+  }
+
+  size_t m_size = 0;
+  const uint8_t* m_data = nullptr;
+  const FileHeader* m_header = nullptr;
+  const BlockIndex* m_index = nullptr;
+};
+
+} // namespace archive
+} // namespace canola
+
+#endif
@@ -107,6 +107,36 @@
 #define CONTROL_RESET_RX_STUFF_ERROR_COUNTER_RESET 0x0
 #define CONTROL_RESET_RX_STUFF_ERROR_COUNTER_MASK 0x400
 
+/* Field: FILTER_WRITE */
+#define CONTROL_FILTER_WRITE_OFFSET 11
+#define CONTROL_FILTER_WRITE_WIDTH 1
+#define CONTROL_FILTER_WRITE_RESET 0x0
+#define CONTROL_FILTER_WRITE_MASK 0x800
+
+/* Field: RX_FIFO_POP */
+#define CONTROL_RX_FIFO_POP_OFFSET 12
+#define CONTROL_RX_FIFO_POP_WIDTH 1
+#define CONTROL_RX_FIFO_POP_RESET 0x0
+#define CONTROL_RX_FIFO_POP_MASK 0x1000
+
+/* Field: RX_FIFO_FLUSH */
+#define CONTROL_RX_FIFO_FLUSH_OFFSET 13
+#define CONTROL_RX_FIFO_FLUSH_WIDTH 1
+#define CONTROL_RX_FIFO_FLUSH_RESET 0x0
+#define CONTROL_RX_FIFO_FLUSH_MASK 0x2000
+
+/* Field: RX_FIFO_CLEAR_OVERFLOW */
+#define CONTROL_RX_FIFO_CLEAR_OVERFLOW_OFFSET 14
+#define CONTROL_RX_FIFO_CLEAR_OVERFLOW_WIDTH 1
+#define CONTROL_RX_FIFO_CLEAR_OVERFLOW_RESET 0x0
+#define CONTROL_RX_FIFO_CLEAR_OVERFLOW_MASK 0x4000
+
+/* Field: TX_MAILBOX_LOAD */
+#define CONTROL_TX_MAILBOX_LOAD_OFFSET 15
+#define CONTROL_TX_MAILBOX_LOAD_WIDTH 1
+#define CONTROL_TX_MAILBOX_LOAD_RESET 0x0
+#define CONTROL_TX_MAILBOX_LOAD_MASK 0x8000
+
 /* Register: CONFIG */
 #define CONFIG_OFFSET 0x8
 #define CONFIG_RESET 0x0
@@ -123,6 +153,24 @@
 #define CONFIG_BTL_TRIPLE_SAMPLING_EN_RESET 0x0
 #define CONFIG_BTL_TRIPLE_SAMPLING_EN_MASK 0x2
 
+/* Field: ACCEPTANCE_FILTER_EN */
+#define CONFIG_ACCEPTANCE_FILTER_EN_OFFSET 2
+#define CONFIG_ACCEPTANCE_FILTER_EN_WIDTH 1
+#define CONFIG_ACCEPTANCE_FILTER_EN_RESET 0x0
+#define CONFIG_ACCEPTANCE_FILTER_EN_MASK 0x4
+
+/* Field: RX_FIFO_EN */
+#define CONFIG_RX_FIFO_EN_OFFSET 3
+#define CONFIG_RX_FIFO_EN_WIDTH 1
+#define CONFIG_RX_FIFO_EN_RESET 0x0
+#define CONFIG_RX_FIFO_EN_MASK 0x8
+
+/* Field: TX_MAILBOX_EN */
+#define CONFIG_TX_MAILBOX_EN_OFFSET 4
+#define CONFIG_TX_MAILBOX_EN_WIDTH 1
+#define CONFIG_TX_MAILBOX_EN_RESET 0x0
+#define CONFIG_TX_MAILBOX_EN_MASK 0x10
+
 /* Register: BTL_PROP_SEG */
 #define BTL_PROP_SEG_OFFSET 0x20
 #define BTL_PROP_SEG_RESET 0x7
@@ -367,4 +415,142 @@
 #define RX_PAYLOAD_1_PAYLOAD_BYTE_7_RESET 0x0
 #define RX_PAYLOAD_1_PAYLOAD_BYTE_7_MASK 0xff000000
 
+/* Register: FILTER_INDEX */
+#define FILTER_INDEX_OFFSET 0x84
+#define FILTER_INDEX_RESET 0x0
+
+/* Register: FILTER_ID */
+#define FILTER_ID_OFFSET 0x88
+#define FILTER_ID_RESET 0x0
+
+/* Field: EXT_ID_EN */
+#define FILTER_ID_EXT_ID_EN_OFFSET 0
+#define FILTER_ID_EXT_ID_EN_WIDTH 1
+#define FILTER_ID_EXT_ID_EN_RESET 0x0
+#define FILTER_ID_EXT_ID_EN_MASK 0x1
+
+/* Field: RTR_EN */
+#define FILTER_ID_RTR_EN_OFFSET 1
+#define FILTER_ID_RTR_EN_WIDTH 1
+#define FILTER_ID_RTR_EN_RESET 0x0
+#define FILTER_ID_RTR_EN_MASK 0x2
+
+/* Field: ARB_ID_B */
+#define FILTER_ID_ARB_ID_B_OFFSET 2
+#define FILTER_ID_ARB_ID_B_WIDTH 18
+#define FILTER_ID_ARB_ID_B_RESET 0x0
+#define FILTER_ID_ARB_ID_B_MASK 0xffffc
+
+/* Field: ARB_ID_A */
+#define FILTER_ID_ARB_ID_A_OFFSET 20
+#define FILTER_ID_ARB_ID_A_WIDTH 11
+#define FILTER_ID_ARB_ID_A_RESET 0x0
+#define FILTER_ID_ARB_ID_A_MASK 0x7ff00000
+
+/* Field: ENABLE */
+#define FILTER_ID_ENABLE_OFFSET 31
+#define FILTER_ID_ENABLE_WIDTH 1
+#define FILTER_ID_ENABLE_RESET 0x0
+#define FILTER_ID_ENABLE_MASK 0x80000000
+
+/* Register: FILTER_MASK */
+#define FILTER_MASK_OFFSET 0x8c
+#define FILTER_MASK_RESET 0x0
+
+/* Field: EXT_ID_EN */
+#define FILTER_MASK_EXT_ID_EN_OFFSET 0
+#define FILTER_MASK_EXT_ID_EN_WIDTH 1
+#define FILTER_MASK_EXT_ID_EN_RESET 0x0
+#define FILTER_MASK_EXT_ID_EN_MASK 0x1
+
+/* Field: RTR_EN */
+#define FILTER_MASK_RTR_EN_OFFSET 1
+#define FILTER_MASK_RTR_EN_WIDTH 1
+#define FILTER_MASK_RTR_EN_RESET 0x0
+#define FILTER_MASK_RTR_EN_MASK 0x2
+
+/* Field: ARB_ID_B */
+#define FILTER_MASK_ARB_ID_B_OFFSET 2
+#define FILTER_MASK_ARB_ID_B_WIDTH 18
+#define FILTER_MASK_ARB_ID_B_RESET 0x0
+#define FILTER_MASK_ARB_ID_B_MASK 0xffffc
+
+/* Field: ARB_ID_A */
+#define FILTER_MASK_ARB_ID_A_OFFSET 20
+#define FILTER_MASK_ARB_ID_A_WIDTH 11
+#define FILTER_MASK_ARB_ID_A_RESET 0x0
+#define FILTER_MASK_ARB_ID_A_MASK 0x7ff00000
+
+/* Register: RX_FILTER_HIT */
+#define RX_FILTER_HIT_OFFSET 0x90
+#define RX_FILTER_HIT_RESET 0x0
+
+/* Register: RX_FIFO_STATUS */
+#define RX_FIFO_STATUS_OFFSET 0x94
+#define RX_FIFO_STATUS_RESET 0x0
+
+/* Field: FILL_LEVEL */
+#define RX_FIFO_STATUS_FILL_LEVEL_OFFSET 0
+#define RX_FIFO_STATUS_FILL_LEVEL_WIDTH 9
+#define RX_FIFO_STATUS_FILL_LEVEL_RESET 0x0
+#define RX_FIFO_STATUS_FILL_LEVEL_MASK 0x1ff
+
+/* Field: EMPTY */
+#define RX_FIFO_STATUS_EMPTY_OFFSET 9
+#define RX_FIFO_STATUS_EMPTY_WIDTH 1
+#define RX_FIFO_STATUS_EMPTY_RESET 0x0
+#define RX_FIFO_STATUS_EMPTY_MASK 0x200
+
+/* Field: FULL */
+#define RX_FIFO_STATUS_FULL_OFFSET 10
+#define RX_FIFO_STATUS_FULL_WIDTH 1
+#define RX_FIFO_STATUS_FULL_RESET 0x0
+#define RX_FIFO_STATUS_FULL_MASK 0x400
+
+/* Field: OVERFLOW */
+#define RX_FIFO_STATUS_OVERFLOW_OFFSET 11
+#define RX_FIFO_STATUS_OVERFLOW_WIDTH 1
+#define RX_FIFO_STATUS_OVERFLOW_RESET 0x0
+#define RX_FIFO_STATUS_OVERFLOW_MASK 0x800
+
+/* Register: RX_FIFO_IRQ_LEVEL */
+#define RX_FIFO_IRQ_LEVEL_OFFSET 0x98
+#define RX_FIFO_IRQ_LEVEL_RESET 0x1
+
+/* Register: TX_MAILBOX_INDEX */
+#define TX_MAILBOX_INDEX_OFFSET 0x9c
+#define TX_MAILBOX_INDEX_RESET 0x0
+
+/* Register: TX_MAILBOX_ABORT */
+#define TX_MAILBOX_ABORT_OFFSET 0xa0
+#define TX_MAILBOX_ABORT_RESET 0x0
+
+/* Register: TX_MAILBOX_PENDING */
+#define TX_MAILBOX_PENDING_OFFSET 0xa4
+#define TX_MAILBOX_PENDING_RESET 0x0
+
+/* Register: TX_MAILBOX_DONE */
+#define TX_MAILBOX_DONE_OFFSET 0xa8
+#define TX_MAILBOX_DONE_RESET 0x0
+
+/* Register: TX_MAILBOX_FAILED */
+#define TX_MAILBOX_FAILED_OFFSET 0xac
+#define TX_MAILBOX_FAILED_RESET 0x0
+
+/* Register: TX_MAILBOX_COUNT */
+#define TX_MAILBOX_COUNT_OFFSET 0xb0
+#define TX_MAILBOX_COUNT_RESET 0x0
+
+/* Register: TIMESTAMP */
+#define TIMESTAMP_OFFSET 0xb4
+#define TIMESTAMP_RESET 0x0
+
+/* Register: RX_TIMESTAMP */
+#define RX_TIMESTAMP_OFFSET 0xb8
+#define RX_TIMESTAMP_RESET 0x0
+
+/* Register: TX_TIMESTAMP */
+#define TX_TIMESTAMP_OFFSET 0xbc
+#define TX_TIMESTAMP_RESET 0x0
+
 #endif
\ No newline at end of file
@@ -111,6 +111,36 @@ static const uint32_t CONTROL_RESET_RX_STUFF_ERROR_COUNTER_WIDTH = 1;
 static const uint32_t CONTROL_RESET_RX_STUFF_ERROR_COUNTER_RESET = 0x0;
 static const uint32_t CONTROL_RESET_RX_STUFF_ERROR_COUNTER_MASK = 0x400;
 
+/* Field: FILTER_WRITE */
+static const uint32_t CONTROL_FILTER_WRITE_OFFSET = 11;
+static const uint32_t CONTROL_FILTER_WRITE_WIDTH = 1;
+static const uint32_t CONTROL_FILTER_WRITE_RESET = 0x0;
+static const uint32_t CONTROL_FILTER_WRITE_MASK = 0x800;
+
+/* Field: RX_FIFO_POP */
+static const uint32_t CONTROL_RX_FIFO_POP_OFFSET = 12;
+static const uint32_t CONTROL_RX_FIFO_POP_WIDTH = 1;
+static const uint32_t CONTROL_RX_FIFO_POP_RESET = 0x0;
+static const uint32_t CONTROL_RX_FIFO_POP_MASK = 0x1000;
+
+/* Field: RX_FIFO_FLUSH */
+static const uint32_t CONTROL_RX_FIFO_FLUSH_OFFSET = 13;
+static const uint32_t CONTROL_RX_FIFO_FLUSH_WIDTH = 1;
+static const uint32_t CONTROL_RX_FIFO_FLUSH_RESET = 0x0;
+static const uint32_t CONTROL_RX_FIFO_FLUSH_MASK = 0x2000;
+
+/* Field: RX_FIFO_CLEAR_OVERFLOW */
+static const uint32_t CONTROL_RX_FIFO_CLEAR_OVERFLOW_OFFSET = 14;
+static const uint32_t CONTROL_RX_FIFO_CLEAR_OVERFLOW_WIDTH = 1;
+static const uint32_t CONTROL_RX_FIFO_CLEAR_OVERFLOW_RESET = 0x0;
+static const uint32_t CONTROL_RX_FIFO_CLEAR_OVERFLOW_MASK = 0x4000;
+
+/* Field: TX_MAILBOX_LOAD */
+static const uint32_t CONTROL_TX_MAILBOX_LOAD_OFFSET = 15;
+static const uint32_t CONTROL_TX_MAILBOX_LOAD_WIDTH = 1;
+static const uint32_t CONTROL_TX_MAILBOX_LOAD_RESET = 0x0;
+static const uint32_t CONTROL_TX_MAILBOX_LOAD_MASK = 0x8000;
+
 /* Register: CONFIG */
 static const uint32_t CONFIG_OFFSET = 0x8;
 static const uint32_t CONFIG_RESET = 0x0;
@@ -127,6 +157,24 @@ static const uint32_t CONFIG_BTL_TRIPLE_SAMPLING_EN_WIDTH = 1;
 static const uint32_t CONFIG_BTL_TRIPLE_SAMPLING_EN_RESET = 0x0;
 static const uint32_t CONFIG_BTL_TRIPLE_SAMPLING_EN_MASK = 0x2;
 
+/* Field: ACCEPTANCE_FILTER_EN */
+static const uint32_t CONFIG_ACCEPTANCE_FILTER_EN_OFFSET = 2;
+static const uint32_t CONFIG_ACCEPTANCE_FILTER_EN_WIDTH = 1;
+static const uint32_t CONFIG_ACCEPTANCE_FILTER_EN_RESET = 0x0;
+static const uint32_t CONFIG_ACCEPTANCE_FILTER_EN_MASK = 0x4;
+
+/* Field: RX_FIFO_EN */
+static const uint32_t CONFIG_RX_FIFO_EN_OFFSET = 3;
+static const uint32_t CONFIG_RX_FIFO_EN_WIDTH = 1;
+static const uint32_t CONFIG_RX_FIFO_EN_RESET = 0x0;
+static const uint32_t CONFIG_RX_FIFO_EN_MASK = 0x8;
+
+/* Field: TX_MAILBOX_EN */
+static const uint32_t CONFIG_TX_MAILBOX_EN_OFFSET = 4;
+static const uint32_t CONFIG_TX_MAILBOX_EN_WIDTH = 1;
+static const uint32_t CONFIG_TX_MAILBOX_EN_RESET = 0x0;
+static const uint32_t CONFIG_TX_MAILBOX_EN_MASK = 0x10;
+
 /* Register: BTL_PROP_SEG */
 static const uint32_t BTL_PROP_SEG_OFFSET = 0x20;
 static const uint32_t BTL_PROP_SEG_RESET = 0x7;
@@ -371,6 +419,144 @@ static const uint32_t RX_PAYLOAD_1_PAYLOAD_BYTE_7_WIDTH = 8;
 static const uint32_t RX_PAYLOAD_1_PAYLOAD_BYTE_7_RESET = 0x0;
 static const uint32_t RX_PAYLOAD_1_PAYLOAD_BYTE_7_MASK = 0xff000000;
 
+/* Register: FILTER_INDEX */
+static const uint32_t FILTER_INDEX_OFFSET = 0x84;
+static const uint32_t FILTER_INDEX_RESET = 0x0;
+
+/* Register: FILTER_ID */
+static const uint32_t FILTER_ID_OFFSET = 0x88;
+static const uint32_t FILTER_ID_RESET = 0x0;
+
+/* Field: EXT_ID_EN */
+static const uint32_t FILTER_ID_EXT_ID_EN_OFFSET = 0;
+static const uint32_t FILTER_ID_EXT_ID_EN_WIDTH = 1;
+static const uint32_t FILTER_ID_EXT_ID_EN_RESET = 0x0;
+static const uint32_t FILTER_ID_EXT_ID_EN_MASK = 0x1;
+
+/* Field: RTR_EN */
+static const uint32_t FILTER_ID_RTR_EN_OFFSET = 1;
+static const uint32_t FILTER_ID_RTR_EN_WIDTH = 1;
+static const uint32_t FILTER_ID_RTR_EN_RESET = 0x0;
+static const uint32_t FILTER_ID_RTR_EN_MASK = 0x2;
+
+/* Field: ARB_ID_B */
+static const uint32_t FILTER_ID_ARB_ID_B_OFFSET = 2;
+static const uint32_t FILTER_ID_ARB_ID_B_WIDTH = 18;
+static const uint32_t FILTER_ID_ARB_ID_B_RESET = 0x0;
+static const uint32_t FILTER_ID_ARB_ID_B_MASK = 0xffffc;
+
+/* Field: ARB_ID_A */
+static const uint32_t FILTER_ID_ARB_ID_A_OFFSET = 20;
+static const uint32_t FILTER_ID_ARB_ID_A_WIDTH = 11;
+static const uint32_t FILTER_ID_ARB_ID_A_RESET = 0x0;
+static const uint32_t FILTER_ID_ARB_ID_A_MASK = 0x7ff00000;
+
+/* Field: ENABLE */
+static const uint32_t FILTER_ID_ENABLE_OFFSET = 31;
+static const uint32_t FILTER_ID_ENABLE_WIDTH = 1;
+static const uint32_t FILTER_ID_ENABLE_RESET = 0x0;
+static const uint32_t FILTER_ID_ENABLE_MASK = 0x80000000;
+
+/* Register: FILTER_MASK */
+static const uint32_t FILTER_MASK_OFFSET = 0x8c;
+static const uint32_t FILTER_MASK_RESET = 0x0;
+
+/* Field: EXT_ID_EN */
+static const uint32_t FILTER_MASK_EXT_ID_EN_OFFSET = 0;
+static const uint32_t FILTER_MASK_EXT_ID_EN_WIDTH = 1;
+static const uint32_t FILTER_MASK_EXT_ID_EN_RESET = 0x0;
+static const uint32_t FILTER_MASK_EXT_ID_EN_MASK = 0x1;
+
+/* Field: RTR_EN */
+static const uint32_t FILTER_MASK_RTR_EN_OFFSET = 1;
+static const uint32_t FILTER_MASK_RTR_EN_WIDTH = 1;
+static const uint32_t FILTER_MASK_RTR_EN_RESET = 0x0;
+static const uint32_t FILTER_MASK_RTR_EN_MASK = 0x2;
+
+/* Field: ARB_ID_B */
+static const uint32_t FILTER_MASK_ARB_ID_B_OFFSET = 2;
+static const uint32_t FILTER_MASK_ARB_ID_B_WIDTH = 18;
+static const uint32_t FILTER_MASK_ARB_ID_B_RESET = 0x0;
+static const uint32_t FILTER_MASK_ARB_ID_B_MASK = 0xffffc;
+
+/* Field: ARB_ID_A */
+static const uint32_t FILTER_MASK_ARB_ID_A_OFFSET = 20;
+static const uint32_t FILTER_MASK_ARB_ID_A_WIDTH = 11;
+static const uint32_t FILTER_MASK_ARB_ID_A_RESET = 0x0;
+static const uint32_t FILTER_MASK_ARB_ID_A_MASK = 0x7ff00000;
+
+/* Register: RX_FILTER_HIT */
+static const uint32_t RX_FILTER_HIT_OFFSET = 0x90;
+static const uint32_t RX_FILTER_HIT_RESET = 0x0;
+
+/* Register: RX_FIFO_STATUS */
+static const uint32_t RX_FIFO_STATUS_OFFSET = 0x94;
+static const uint32_t RX_FIFO_STATUS_RESET = 0x0;
+
+/* Field: FILL_LEVEL */
+static const uint32_t RX_FIFO_STATUS_FILL_LEVEL_OFFSET = 0;
+static const uint32_t RX_FIFO_STATUS_FILL_LEVEL_WIDTH = 9;
+static const uint32_t RX_FIFO_STATUS_FILL_LEVEL_RESET = 0x0;
+static const uint32_t RX_FIFO_STATUS_FILL_LEVEL_MASK = 0x1ff;
+
+/* Field: EMPTY */
+static const uint32_t RX_FIFO_STATUS_EMPTY_OFFSET = 9;
+static const uint32_t RX_FIFO_STATUS_EMPTY_WIDTH = 1;
+static const uint32_t RX_FIFO_STATUS_EMPTY_RESET = 0x0;
+static const uint32_t RX_FIFO_STATUS_EMPTY_MASK = 0x200;
+
+/* Field: FULL */
+static const uint32_t RX_FIFO_STATUS_FULL_OFFSET = 10;
+static const uint32_t RX_FIFO_STATUS_FULL_WIDTH = 1;
+static const uint32_t RX_FIFO_STATUS_FULL_RESET = 0x0;
+static const uint32_t RX_FIFO_STATUS_FULL_MASK = 0x400;
+
+/* Field: OVERFLOW */
+static const uint32_t RX_FIFO_STATUS_OVERFLOW_OFFSET = 11;
+static const uint32_t RX_FIFO_STATUS_OVERFLOW_WIDTH = 1;
+static const uint32_t RX_FIFO_STATUS_OVERFLOW_RESET = 0x0;
+static const uint32_t RX_FIFO_STATUS_OVERFLOW_MASK = 0x800;
+
+/* Register: RX_FIFO_IRQ_LEVEL */
+static const uint32_t RX_FIFO_IRQ_LEVEL_OFFSET = 0x98;
+static const uint32_t RX_FIFO_IRQ_LEVEL_RESET = 0x1;
+
+/* Register: TX_MAILBOX_INDEX */
+static const uint32_t TX_MAILBOX_INDEX_OFFSET = 0x9c;
+static const uint32_t TX_MAILBOX_INDEX_RESET = 0x0;
+
+/* Register: TX_MAILBOX_ABORT */
+static const uint32_t TX_MAILBOX_ABORT_OFFSET = 0xa0;
+static const uint32_t TX_MAILBOX_ABORT_RESET = 0x0;
+
+/* Register: TX_MAILBOX_PENDING */
+static const uint32_t TX_MAILBOX_PENDING_OFFSET = 0xa4;
+static const uint32_t TX_MAILBOX_PENDING_RESET = 0x0;
+
+/* Register: TX_MAILBOX_DONE */
+static const uint32_t TX_MAILBOX_DONE_OFFSET = 0xa8;
+static const uint32_t TX_MAILBOX_DONE_RESET = 0x0;
+
+/* Register: TX_MAILBOX_FAILED */
+static const uint32_t TX_MAILBOX_FAILED_OFFSET = 0xac;
+static const uint32_t TX_MAILBOX_FAILED_RESET = 0x0;
+
+/* Register: TX_MAILBOX_COUNT */
+static const uint32_t TX_MAILBOX_COUNT_OFFSET = 0xb0;
+static const uint32_t TX_MAILBOX_COUNT_RESET = 0x0;
+
+/* Register: TIMESTAMP */
+static const uint32_t TIMESTAMP_OFFSET = 0xb4;
+static const uint32_t TIMESTAMP_RESET = 0x0;
+
+/* Register: RX_TIMESTAMP */
+static const uint32_t RX_TIMESTAMP_OFFSET = 0xb8;
+static const uint32_t RX_TIMESTAMP_RESET = 0x0;
+
+/* Register: TX_TIMESTAMP */
+static const uint32_t TX_TIMESTAMP_OFFSET = 0xbc;
+static const uint32_t TX_TIMESTAMP_RESET = 0x0;
+
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,14 @@
+#ifndef CANOLA_BIT_TIMING_H
+#define CANOLA_BIT_TIMING_H
+
+/* Generated by canola_bit_timing header, do not edit */
+/* 100000000 Hz clock, 1000000 bit/s, 1.0 m, 150 ns transceiver loop delay */
+/* Sample point 80.0%, oscillator tolerance 4000 ppm, PROP_SEG margin 10.0 ns */
+
+#define CANOLA_TIME_QUANTA_CLOCK_SCALE 9
+#define CANOLA_BTL_PROP_SEG 0xf
+#define CANOLA_BTL_PHASE_SEG1 0x7
+#define CANOLA_BTL_PHASE_SEG2 0x3
+#define CANOLA_BTL_SYNC_JUMP_WIDTH 2
+
+#endif
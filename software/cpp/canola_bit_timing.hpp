@@ -0,0 +1,241 @@
+/**
+ * @file   canola_bit_timing.hpp
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Bit timing solver for the Canola CAN controller.
+ *
+ *         solve_bit_timing() finds the TIME_QUANTA_CLOCK_SCALE and BTL_*
+ *         register values for a system clock, bit rate, bus length and
+ *         transceiver loop delay. It tries every combination the register
+ *         widths in canola_pkg.vhd allow, keeps the ones where PROP_SEG
+ *         covers the propagation delay and the bit rate error leaves some
+ *         oscillator tolerance, and picks the one with the smallest bit rate
+ *         error and the sample point closest to the target. The SJW is the
+ *         largest one allowed by the phase segments.
+ *
+ *         The solver is constexpr, so firmware can compute the registers at
+ *         build time and static_assert that a solution exists:
+ *
+ *           constexpr canola::BitTiming timing = canola::solve_bit_timing(100e6, 500e3, 20.0, 150e-9);
+ *           static_assert(timing.valid, "No bit timing for 500 kbit on 20 m");
+ *           can.init(timing);
+ */
+
+#ifndef CANOLA_BIT_TIMING_HPP
+#define CANOLA_BIT_TIMING_HPP
+
+#include <cstdint>
+
+namespace canola
+{
+
+// Same as the constants in canola_pkg.vhd
+constexpr unsigned int TIME_QUANTA_SCALE_WIDTH = 5;  // C_TIME_QUANTA_SCALE_WIDTH_DEFAULT
+constexpr unsigned int BTL_SEGMENT_WIDTH       = 4;  // C_PROP_SEG_WIDTH, C_PHASE_SEG1/2_WIDTH
+constexpr unsigned int BTL_SYNC_JUMP_WIDTH_MAX = 4;  // C_SYNC_JUMP_WIDTH_MAX
+
+// Phase segment 2 must cover the information processing time (ISO 11898-1)
+constexpr unsigned int BTL_PHASE_SEG2_MIN = 2;
+
+// CAN_RX to edge detection, and sample point to CAN_TX, in canola_btl.vhd
+// (clock cycles per node)
+constexpr unsigned int BTL_IO_DELAY_CLOCKS = 4;
+
+// CAN_RX to edge detection alone (the two s_clk_sampled_bit registers)
+constexpr unsigned int BTL_RX_EDGE_DELAY_CLOCKS = 2;
+
+// Test project on the ZYBO board: system clock, bit rate, and a short bus
+// between transceivers on the Pmod connectors
+constexpr double CLOCK_FREQ_DEFAULT        = 100e6;
+constexpr double BIT_RATE_DEFAULT          = 1e6;
+constexpr double BUS_LENGTH_DEFAULT        = 1.0;     // m
+constexpr double TRANSCEIVER_DELAY_DEFAULT = 150e-9;  // Loop delay, typical for 1 Mbit transceivers
+
+constexpr double CABLE_DELAY                 = 5e-9;   // Per meter of twisted pair
+constexpr double SAMPLE_POINT_TARGET_DEFAULT = 0.875;  // CiA 601-3
+
+/**
+ * Register values for the bit timing, and what they give. The segments are
+ * in time quanta, the registers are thermometer coded (see btl_segment()).
+ */
+struct BitTiming {
+  bool valid                       = false;
+  uint32_t time_quanta_clock_scale = 0;
+  unsigned int prop_seg            = 1;
+  unsigned int phase_seg1          = 1;
+  unsigned int phase_seg2          = 1;
+  unsigned int sync_jump_width     = 1;
+
+  double bit_rate         = 0.0;  // Actual bit rate, bit/s
+  double bit_rate_error   = 0.0;  // Relative to the requested bit rate
+  double sample_point     = 0.0;  // Position of the sample point in the bit, 0 to 1
+  double clock_tolerance  = 0.0;  // Left for the oscillator of each node after the bit rate error
+  double prop_seg_margin  = 0.0;  // PROP_SEG minus the propagation delay, s
+
+  constexpr unsigned int quanta_per_bit() const
+  {
+    return 1 + prop_seg + phase_seg1 + phase_seg2;
+  }
+
+  constexpr uint32_t clocks_per_bit() const
+  {
+    return (time_quanta_clock_scale + 1) * quanta_per_bit();
+  }
+};
+
+// Register value for a BTL segment of quanta time quanta
+constexpr uint32_t btl_segment(unsigned int quanta)
+{
+  return (1u << quanta) - 1;
+}
+
+/**
+ * Time quanta from an edge on CAN_RX until the sync FSM in canola_btl.vhd
+ * acts on it: the edge detection, and then up to one time quantum until the
+ * FSM looks at it on the next time quanta pulse
+ */
+constexpr double btl_input_delay_quanta(uint32_t time_quanta_clock_scale)
+{
+  return 1.0 + double(BTL_RX_EDGE_DELAY_CLOCKS) / (time_quanta_clock_scale + 1);
+}
+
+/**
+ * Oscillator tolerance of each node (relative), from the two conditions in
+ * ISO 11898-1: resynchronization must keep up across 10 bits without an
+ * edge, and the phase segments across an error flag. Edges are seen
+ * input_delay_quanta late, which is taken out of PHASE_SEG1 and the SJW.
+ * Zero or negative if the delay leaves nothing of them.
+ */
+constexpr double btl_clock_tolerance(unsigned int quanta_per_bit, unsigned int phase_seg1,
+                                     unsigned int phase_seg2, unsigned int sync_jump_width,
+                                     double input_delay_quanta)
+{
+  const double ps1 = phase_seg1 - input_delay_quanta;
+  const double phase_seg_min = ps1 < phase_seg2 ? ps1 : phase_seg2;
+  const double sjw_delayed = sync_jump_width - input_delay_quanta;
+  const double sjw = sjw_delayed < phase_seg_min ? sjw_delayed : phase_seg_min;
+  const double df1 = sjw / (20.0 * quanta_per_bit);
+  const double df2 = phase_seg_min / (2.0 * (13.0 * quanta_per_bit - phase_seg2));
+  return df1 < df2 ? df1 : df2;
+}
+
+/**
+ * Time from the start of a bit until an edge from the node furthest away
+ * has made it back, which PROP_SEG must cover: the cable and both
+ * transceivers in both directions, and the delays in the two controllers.
+ * transceiver_delay is the loop delay (CAN_TX to CAN_RX) of one transceiver.
+ */
+constexpr double propagation_delay(double clock_freq, double bus_length, double transceiver_delay)
+{
+  return 2.0 * (bus_length * CABLE_DELAY + transceiver_delay + BTL_IO_DELAY_CLOCKS / clock_freq);
+}
+
+/**
+ * Bit timing with the given time quanta scale and segments, valid if it can
+ * be used for bit_rate with propagation delay prop_delay (s)
+ */
+constexpr BitTiming make_bit_timing(double clock_freq, double bit_rate, double prop_delay,
+                                    uint32_t time_quanta_clock_scale, unsigned int prop_seg,
+                                    unsigned int phase_seg1, unsigned int phase_seg2,
+                                    unsigned int sync_jump_width)
+{
+  BitTiming t;
+  t.time_quanta_clock_scale = time_quanta_clock_scale;
+  t.prop_seg = prop_seg;
+  t.phase_seg1 = phase_seg1;
+  t.phase_seg2 = phase_seg2;
+  t.sync_jump_width = sync_jump_width;
+
+  const double tq = (time_quanta_clock_scale + 1) / clock_freq;
+  t.bit_rate = clock_freq / t.clocks_per_bit();
+  t.bit_rate_error = t.bit_rate > bit_rate ? (t.bit_rate - bit_rate) / bit_rate
+                                           : (bit_rate - t.bit_rate) / bit_rate;
+  t.sample_point = double(1 + prop_seg + phase_seg1) / t.quanta_per_bit();
+  t.clock_tolerance = btl_clock_tolerance(t.quanta_per_bit(), phase_seg1, phase_seg2,
+                                          sync_jump_width,
+                                          btl_input_delay_quanta(time_quanta_clock_scale)) -
+                      t.bit_rate_error;
+  t.prop_seg_margin = prop_seg * tq - prop_delay;
+
+  t.valid = time_quanta_clock_scale < (1u << TIME_QUANTA_SCALE_WIDTH) &&
+            prop_seg >= 1 && prop_seg <= BTL_SEGMENT_WIDTH &&
+            phase_seg1 >= 1 && phase_seg1 <= BTL_SEGMENT_WIDTH &&
+            phase_seg2 >= BTL_PHASE_SEG2_MIN && phase_seg2 <= BTL_SEGMENT_WIDTH &&
+            sync_jump_width >= 1 && sync_jump_width <= BTL_SYNC_JUMP_WIDTH_MAX &&
+            sync_jump_width <= phase_seg1 && sync_jump_width <= phase_seg2 &&
+            t.prop_seg_margin >= 0.0 && t.clock_tolerance > 0.0;
+  return t;
+}
+
+/**
+ * True if a is a better choice than b: smaller bit rate error, then sample
+ * point closer to the target, then more oscillator tolerance, then more
+ * propagation margin
+ */
+constexpr bool better_bit_timing(const BitTiming& a, const BitTiming& b,
+                                 double sample_point_target = SAMPLE_POINT_TARGET_DEFAULT)
+{
+  constexpr double eps = 1e-9;
+
+  if(a.valid != b.valid)
+    return a.valid;
+  if(a.bit_rate_error < b.bit_rate_error - eps || a.bit_rate_error > b.bit_rate_error + eps)
+    return a.bit_rate_error < b.bit_rate_error;
+
+  const double a_sp = a.sample_point > sample_point_target ? a.sample_point - sample_point_target
+                                                           : sample_point_target - a.sample_point;
+  const double b_sp = b.sample_point > sample_point_target ? b.sample_point - sample_point_target
+                                                           : sample_point_target - b.sample_point;
+  if(a_sp < b_sp - eps || a_sp > b_sp + eps)
+    return a_sp < b_sp;
+
+  if(a.clock_tolerance < b.clock_tolerance - eps || a.clock_tolerance > b.clock_tolerance + eps)
+    return a.clock_tolerance > b.clock_tolerance;
+
+  return a.prop_seg_margin > b.prop_seg_margin + eps;
+}
+
+/**
+ * Best bit timing for bit_rate with a clock_freq system clock, bus_length
+ * meters between the two nodes furthest apart, and transceivers with loop
+ * delay transceiver_delay (s). The result is not valid if no combination
+ * of the registers works.
+ */
+constexpr BitTiming solve_bit_timing(double clock_freq, double bit_rate, double bus_length = 0.0,
+                                     double transceiver_delay = 0.0,
+                                     double sample_point_target = SAMPLE_POINT_TARGET_DEFAULT)
+{
+  const double prop_delay = propagation_delay(clock_freq, bus_length, transceiver_delay);
+  BitTiming best;
+
+  for(uint32_t scale = 0; scale < (1u << TIME_QUANTA_SCALE_WIDTH); scale++) {
+    for(unsigned int prop = 1; prop <= BTL_SEGMENT_WIDTH; prop++) {
+      for(unsigned int ps1 = 1; ps1 <= BTL_SEGMENT_WIDTH; ps1++) {
+        for(unsigned int ps2 = BTL_PHASE_SEG2_MIN; ps2 <= BTL_SEGMENT_WIDTH; ps2++) {
+          // A larger SJW only adds tolerance, take the largest allowed
+          unsigned int sjw = ps1 < ps2 ? ps1 : ps2;
+          if(sjw > BTL_SYNC_JUMP_WIDTH_MAX)
+            sjw = BTL_SYNC_JUMP_WIDTH_MAX;
+
+          const BitTiming t = make_bit_timing(clock_freq, bit_rate, prop_delay, scale, prop, ps1,
+                                              ps2, sjw);
+          if(better_bit_timing(t, best, sample_point_target))
+            best = t;
+        }
+      }
+    }
+  }
+
+  return best;
+}
+
+// Timing canola_init() uses, for the test project on the ZYBO board
+constexpr BitTiming BIT_TIMING_DEFAULT = solve_bit_timing(CLOCK_FREQ_DEFAULT, BIT_RATE_DEFAULT,
+                                                          BUS_LENGTH_DEFAULT,
+                                                          TRANSCEIVER_DELAY_DEFAULT);
+
+static_assert(BIT_TIMING_DEFAULT.valid, "No bit timing for the default clock and bit rate");
+
+} // namespace canola
+
+#endif
@@ -0,0 +1,815 @@
+/**
+ * @file   canola_btl.hpp
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Cycle-level host model of the Canola bit timing logic, for
+ *         Monte Carlo studies of the BTL_* settings with oscillator drift,
+ *         propagation delay and edge jitter.
+ *
+ *         Btl mirrors canola_btl.vhd and canola_time_quanta_gen.vhd clock
+ *         cycle by clock cycle (sync FSM, resynchronization with SJW, sample
+ *         points, triple sampling). BtlNode puts a Btl in front of a
+ *         model::Node, which is stepped at each Rx sample point like the BSP
+ *         is by BTL_RX_BIT_VALID.
+ *
+ *         Network connects BtlNodes with their own clocks to an analog bus:
+ *         each edge on CAN_TX reaches CAN_RX of every node (including the
+ *         sender) after the transceiver delays and the cable delay between
+ *         the two, with Gaussian jitter on each edge. The bus is
+ *         event-driven, the clock edges of all nodes are processed in time
+ *         order.
+ *
+ *         run_study() runs random traffic on independent networks with
+ *         random clock errors, spread over all cores with
+ *         sim::run_sharded(), and checks that every frame reaches every
+ *         other node without errors.
+ *
+ *         Quirks of the RTL are kept on purpose (marked RTL in the comments).
+ */
+
+#ifndef CANOLA_BTL_HPP
+#define CANOLA_BTL_HPP
+
+#include "canola_model.hpp"
+#include "canola_sim.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <random>
+#include <vector>
+
+namespace canola
+{
+namespace btl
+{
+
+/**
+ * BTL_* registers. The segments are thermometer coded, a segment with n
+ * ones lasts n time quanta (at least 1). Defaults to the values
+ * canola_init() writes (BIT_TIMING_DEFAULT).
+ */
+struct Timing {
+  uint32_t time_quanta_clock_scale = BIT_TIMING_DEFAULT.time_quanta_clock_scale;
+  uint32_t prop_seg                = btl_segment(BIT_TIMING_DEFAULT.prop_seg);
+  uint32_t phase_seg1              = btl_segment(BIT_TIMING_DEFAULT.phase_seg1);
+  uint32_t phase_seg2              = btl_segment(BIT_TIMING_DEFAULT.phase_seg2);
+  uint32_t sync_jump_width         = BIT_TIMING_DEFAULT.sync_jump_width;
+  bool triple_sampling             = false;
+
+  // Register value for a segment of quanta time quanta (1 to BTL_SEGMENT_WIDTH)
+  static constexpr uint32_t segment(unsigned int quanta) { return btl_segment(quanta); }
+
+  // Time quanta of a segment register, the sync FSM stops at the first zero
+  static unsigned int quanta(uint32_t segment)
+  {
+    unsigned int n = 1;
+    for(segment >>= 1; segment & 1; segment >>= 1)
+      n++;
+    return n;
+  }
+
+  static Timing from_quanta(unsigned int clock_scale, unsigned int prop, unsigned int phase1,
+                            unsigned int phase2, unsigned int sjw, bool triple_sampling = false)
+  {
+    Timing timing;
+    timing.time_quanta_clock_scale = clock_scale;
+    timing.prop_seg = segment(prop);
+    timing.phase_seg1 = segment(phase1);
+    timing.phase_seg2 = segment(phase2);
+    timing.sync_jump_width = sjw;
+    timing.triple_sampling = triple_sampling;
+    return timing;
+  }
+
+  static Timing from_bit_timing(const BitTiming& bit_timing)
+  {
+    return from_quanta(bit_timing.time_quanta_clock_scale, bit_timing.prop_seg,
+                       bit_timing.phase_seg1, bit_timing.phase_seg2, bit_timing.sync_jump_width);
+  }
+
+  unsigned int quanta_per_bit() const
+  {
+    return 1 + quanta(prop_seg) + quanta(phase_seg1) + quanta(phase_seg2);
+  }
+
+  unsigned int clocks_per_bit() const { return (time_quanta_clock_scale + 1) * quanta_per_bit(); }
+
+  // Position of the Rx sample point in the bit, 0 to 1
+  double sample_point() const
+  {
+    return double(1 + quanta(prop_seg) + quanta(phase_seg1)) / quanta_per_bit();
+  }
+
+  // BTL_SYNC_JUMP_WIDTH, at least 1 and at most BTL_SYNC_JUMP_WIDTH_MAX
+  unsigned int effective_sjw() const
+  {
+    return std::min(std::max(1u, sync_jump_width), BTL_SYNC_JUMP_WIDTH_MAX);
+  }
+
+  // Oscillator tolerance of each node (relative), see btl_clock_tolerance()
+  double clock_tolerance() const
+  {
+    return btl_clock_tolerance(quanta_per_bit(), quanta(phase_seg1), quanta(phase_seg2),
+                               effective_sjw(), btl_input_delay_quanta(time_quanta_clock_scale));
+  }
+};
+
+/**
+ * canola_btl with canola_time_quanta_gen, without TMR
+ */
+class Btl
+{
+public:
+  enum class SyncState : uint8_t { ST_SYNC_SEG, ST_PROP_SEG, ST_PHASE_SEG1, ST_PHASE_SEG2 };
+
+  explicit Btl(const Timing& timing = Timing())
+    : m_timing(timing)
+  {
+    reset();
+  }
+
+  void set_timing(const Timing& timing) { m_timing = timing; }
+  const Timing& timing() const { return m_timing; }
+
+  // Registers without reset get the initial values of the signals (or
+  // recessive instead of 'U')
+  void reset() { m_r = Registers{}; }
+
+  /**
+   * One rising edge of CLK. All registers are updated from their values
+   * before the edge, like the clocked processes in the RTL.
+   */
+  void clock(bool can_rx, bool tx_bit_value, bool tx_bit_valid, bool tx_active, bool rx_stop)
+  {
+    const Registers& o = m_r;
+    Registers n = m_r;
+
+    // canola_time_quanta_gen
+    n.tq_pulse = false;
+    if(o.tq_restart) {
+      n.tq_counter = 0;
+    } else if(o.tq_counter == m_timing.time_quanta_clock_scale) {
+      n.tq_pulse = true;
+      n.tq_counter = 0;
+    } else {
+      n.tq_counter = (o.tq_counter + 1) & ((1u << TIME_QUANTA_SCALE_WIDTH) - 1);
+    }
+
+    // proc_rx_sync_fsm
+    n.sync_jump_width = m_timing.effective_sjw();
+    n.tq_restart = false;
+
+    const bool falling_edge = o.clk_sampled_bits == 0x2;
+    if(falling_edge)
+      n.got_falling_edge = true;
+
+    if(rx_stop)
+      n.rx_synced = false;
+    else if(!o.rx_synced && falling_edge)
+      n.rx_synced = true;
+
+    if(!o.rx_synced && falling_edge && !tx_active) {
+      // Hard synchronization
+      n.tq_restart = true;
+      n.state = SyncState::ST_SYNC_SEG;
+    } else if(o.tq_pulse) {
+      sync_fsm(o, n);
+    }
+
+    // proc_tx_sync
+    n.tx_done = false;
+    if(tx_bit_valid) {
+      n.tx_rdy = false;
+      n.tx_bit = tx_bit_value;
+    }
+    if(o.sample_point_tx) {
+      if(!o.tx_rdy) {
+        n.can_tx = o.tx_bit;
+        n.tx_done = true;
+        n.tx_rdy = true;
+      } else {
+        n.can_tx = true;
+      }
+    }
+
+    // proc_sample_points
+    n.sample_point_tx = o.state == SyncState::ST_SYNC_SEG && !o.sample_point_tx_done;
+    n.sample_point_tx_done = o.state == SyncState::ST_SYNC_SEG;
+    n.sample_point_rx = o.state == SyncState::ST_PHASE_SEG2 && !o.sample_point_rx_done;
+    n.sample_point_rx_done = o.state == SyncState::ST_PHASE_SEG2;
+
+    // proc_sample_rx_bit
+    n.rx_bit_valid = false;
+    n.clk_sampled_bits = ((o.clk_sampled_bits << 1) | can_rx) & 0x3;
+    if(o.tq_pulse)
+      n.quanta_sampled_bits = ((o.quanta_sampled_bits << 1) | can_rx) & 0x3;
+
+    if(o.sample_point_rx) {
+      const bool q0 = o.quanta_sampled_bits & 1;
+      const bool q1 = o.quanta_sampled_bits & 2;
+      n.rx_bit_value = m_timing.triple_sampling ? (q0 && q1) || (q0 && can_rx) || (q1 && can_rx)
+                                                : can_rx;
+      n.rx_bit_valid = true;
+    }
+
+    m_r = n;
+  }
+
+  bool can_tx() const { return m_r.can_tx; }
+  bool tx_rdy() const { return m_r.tx_rdy; }
+  bool tx_done() const { return m_r.tx_done; }
+  bool rx_bit_value() const { return m_r.rx_bit_value; }
+  bool rx_bit_valid() const { return m_r.rx_bit_valid; }
+  bool rx_synced() const { return m_r.rx_synced; }
+  SyncState state() const { return m_r.state; }
+
+private:
+  struct Registers {
+    // canola_time_quanta_gen
+    uint32_t tq_counter = 0;
+    bool tq_pulse = false;
+
+    // proc_rx_sync_fsm
+    SyncState state = SyncState::ST_SYNC_SEG;
+    uint32_t segment = 0;
+    unsigned int phase_error = 0;
+    unsigned int sync_jump_width = 0;
+    bool resync_allowed = false;
+    bool resync_done = false;
+    bool got_falling_edge = false;
+    bool rx_synced = false;
+    bool tq_restart = false;
+
+    // proc_sample_points
+    bool sample_point_tx = false;
+    bool sample_point_tx_done = false;
+    bool sample_point_rx = false;
+    bool sample_point_rx_done = false;
+
+    // proc_tx_sync
+    bool tx_rdy = true;
+    bool tx_done = false;
+    bool tx_bit = true;
+    bool can_tx = true;
+
+    // proc_sample_rx_bit
+    uint8_t clk_sampled_bits = 0x3;
+    uint8_t quanta_sampled_bits = 0;
+    bool rx_bit_value = true;
+    bool rx_bit_valid = false;
+  };
+
+  static constexpr uint32_t SEGMENT_MASK = (1u << BTL_SEGMENT_WIDTH) - 1;
+
+  // The case statement of proc_rx_sync_fsm, on a time quanta pulse
+  void sync_fsm(const Registers& o, Registers& n) const
+  {
+    unsigned int phase_error = o.phase_error;
+    uint32_t segment = o.segment >> 1;
+
+    switch(o.state) {
+    case SyncState::ST_SYNC_SEG:
+      n.resync_allowed = o.rx_synced && !o.got_falling_edge;
+      n.resync_done = false;
+      n.phase_error = 0;
+      n.segment = m_timing.prop_seg & SEGMENT_MASK;
+      n.state = SyncState::ST_PROP_SEG;
+      return;
+
+    case SyncState::ST_PROP_SEG:
+      if(!o.got_falling_edge && phase_error < o.sync_jump_width)
+        phase_error++;
+
+      if(!(segment & 1)) {
+        segment = m_timing.phase_seg1 & SEGMENT_MASK;
+        n.state = SyncState::ST_PHASE_SEG1;
+      }
+      break;
+
+    case SyncState::ST_PHASE_SEG1:
+      if(!o.got_falling_edge) {
+        if(phase_error < o.sync_jump_width)
+          phase_error++;
+      } else if(o.resync_allowed && !o.resync_done) {
+        // Lengthen by the phase error, shift_left_and_fill_with_one()
+        segment = ((segment << phase_error) | ((1u << phase_error) - 1)) & SEGMENT_MASK;
+        n.resync_done = true;
+        n.resync_allowed = false;
+      }
+
+      if(!(segment & 1)) {
+        segment = m_timing.phase_seg2 & SEGMENT_MASK;
+        phase_error = o.sync_jump_width;
+        n.resync_done = false;
+        n.state = SyncState::ST_PHASE_SEG2;
+      }
+      break;
+
+    case SyncState::ST_PHASE_SEG2:
+      if(!o.got_falling_edge && phase_error > 0)
+        phase_error--;
+
+      // Shorten by the phase error
+      if(o.got_falling_edge && o.resync_allowed && !o.resync_done) {
+        segment >>= phase_error;
+        n.resync_done = true;
+      }
+
+      if(!(segment & 1)) {
+        segment = 0;
+        phase_error = 0;
+        // RTL: an edge detected in this clock cycle is lost
+        n.got_falling_edge = false;
+        n.state = SyncState::ST_SYNC_SEG;
+      }
+      break;
+    }
+
+    n.segment = segment;
+    n.phase_error = phase_error;
+  }
+
+  Timing m_timing;
+  Registers m_r;
+};
+
+/**
+ * A model::Node behind a Btl. The node processes a bit at each Rx sample
+ * point, and hands the next bit to transmit to the BTL right after it
+ * (RTL: the BSP takes a few clock cycles more).
+ */
+class BtlNode
+{
+public:
+  explicit BtlNode(const Timing& timing = Timing())
+    : m_btl(timing)
+  {
+    m_tx_msg = CanMsg{};
+    m_rx_msg = CanMsg{};
+  }
+
+  /**
+   * Start transmitting msg. The start is deferred to the next Rx sample
+   * point, which is between two bits for the node.
+   */
+  void start_tx(const CanMsg& msg)
+  {
+    m_tx_msg = msg;
+    m_tx_start = true;
+  }
+
+  bool tx_busy() const { return m_tx_start || m_node.tx_busy(); }
+
+  /**
+   * One clock cycle with can_rx on CAN_RX.
+   * Returns true at an Rx sample point (BTL_RX_BIT_VALID).
+   */
+  bool clock(bool can_rx)
+  {
+    m_btl.clock(can_rx, m_tx_bit, m_tx_bit_valid, m_node.bsp_tx_active(), m_rx_stop);
+    m_tx_bit_valid = false;
+    m_rx_stop = false;
+
+    if(!m_btl.rx_bit_valid())
+      return false;
+
+    m_node.set_btl_rx_synced(m_btl.rx_synced());
+    m_node.rx_bit(m_btl.rx_bit_value());
+    m_rx_stop = m_btl.rx_synced() && !m_node.btl_rx_synced();
+
+    const uint32_t events = m_node.events();
+    if(events & model::EVENT_RX_MSG_VALID)
+      m_rx_msg = m_node.rx_msg();
+    m_events |= events;
+
+    if(m_tx_start) {
+      m_node.start_tx(m_tx_msg);
+      m_tx_start = false;
+    }
+
+    m_tx_bit = m_node.tx_bit();
+    m_tx_bit_valid = true;
+    return true;
+  }
+
+  bool can_tx() const { return m_btl.can_tx(); }
+
+  // Events since the last call
+  uint32_t take_events()
+  {
+    const uint32_t events = m_events;
+    m_events = 0;
+    return events;
+  }
+
+  // Message of the last EVENT_RX_MSG_VALID
+  const CanMsg& rx_msg() const { return m_rx_msg; }
+
+  model::Node& node() { return m_node; }
+  const model::Node& node() const { return m_node; }
+  Btl& btl() { return m_btl; }
+  const Btl& btl() const { return m_btl; }
+
+private:
+  Btl m_btl;
+  model::Node m_node;
+  CanMsg m_tx_msg;
+  CanMsg m_rx_msg;
+  uint32_t m_events = 0;
+  bool m_tx_start = false;
+  bool m_tx_bit = true;
+  bool m_tx_bit_valid = false;
+  bool m_rx_stop = false;
+};
+
+/**
+ * Placement and analog properties of a node on a Network
+ */
+struct NodeConfig {
+  Timing timing;
+  double clock_freq  = CLOCK_FREQ_DEFAULT;  // Actual frequency of the oscillator
+  double clock_phase = 0.0;                 // First rising edge, in clock periods
+  double position    = 0.0;                 // Along the bus, m
+  double tx_delay    = 0.0;                 // Transceiver, from CAN_TX to the bus, s
+  double rx_delay    = 0.0;                 // Transceiver, from the bus to CAN_RX, s
+  double jitter      = 0.0;                 // Standard deviation of each edge on the bus, s
+};
+
+/**
+ * BtlNodes with independent clocks on a bus with propagation delay
+ */
+class Network
+{
+public:
+  explicit Network(uint64_t seed = 1)
+    : m_rng(seed)
+  {}
+
+  // Add nodes before the first call to run_until()
+  unsigned int add_node(const NodeConfig& config)
+  {
+    Station station;
+    station.config = config;
+    station.node = BtlNode(config.timing);
+    station.period = 1.0 / config.clock_freq;
+    station.next_clock = config.clock_phase * station.period;
+    m_stations.push_back(station);
+
+    m_driven.assign(m_stations.size() * m_stations.size(), 0);
+    return m_stations.size() - 1;
+  }
+
+  unsigned int size() const { return m_stations.size(); }
+  BtlNode& node(unsigned int index) { return m_stations[index].node; }
+  const BtlNode& node(unsigned int index) const { return m_stations[index].node; }
+  double now() const { return m_now; }
+
+  /**
+   * Run all clock edges before time (s)
+   */
+  void run_until(double time)
+  {
+    const unsigned int n = m_stations.size();
+
+    while(n > 0) {
+      unsigned int k = 0;
+      for(unsigned int i = 1; i < n; i++) {
+        if(m_stations[i].next_clock < m_stations[k].next_clock)
+          k = i;
+      }
+
+      Station& station = m_stations[k];
+      const double t = station.next_clock;
+      if(t >= time)
+        break;
+
+      while(!m_arrivals.empty() && m_arrivals.top().time <= t) {
+        arrive(m_arrivals.top());
+        m_arrivals.pop();
+      }
+
+      m_now = t;
+      const bool can_tx = station.node.can_tx();
+      const bool sampled = station.node.clock(station.dominant_sources == 0);
+
+      if(station.node.can_tx() != can_tx)
+        transmit(k, t);
+
+      if(sampled) {
+        if(station.last_edge > station.last_sample)
+          station.min_setup = std::min(station.min_setup, t - station.last_edge);
+        station.last_sample = t;
+      }
+
+      station.clocks++;
+      station.next_clock = (station.config.clock_phase + station.clocks) * station.period;
+    }
+    m_now = time;
+  }
+
+  /**
+   * Shortest time from an edge on CAN_RX to the next Rx sample point, and
+   * from an Rx sample point to the next edge, seen by a node
+   */
+  double min_setup(unsigned int index) const { return m_stations[index].min_setup; }
+  double min_hold(unsigned int index) const { return m_stations[index].min_hold; }
+
+private:
+  struct Station {
+    NodeConfig config;
+    BtlNode node;
+    double period = 0.0;
+    double next_clock = 0.0;
+    uint64_t clocks = 0;
+    unsigned int dominant_sources = 0;  // Nodes seen driving dominant at CAN_RX
+    double last_edge = -std::numeric_limits<double>::infinity();
+    double last_sample = -std::numeric_limits<double>::infinity();
+    double min_setup = std::numeric_limits<double>::infinity();
+    double min_hold = std::numeric_limits<double>::infinity();
+  };
+
+  struct Arrival {
+    double time;
+    uint16_t src;
+    uint16_t dst;
+    bool dominant;
+
+    bool operator>(const Arrival& other) const { return time > other.time; }
+  };
+
+  // CAN_TX of node src changed at time t
+  void transmit(unsigned int src, double t)
+  {
+    const Station& from = m_stations[src];
+    double jitter = 0.0;
+    if(from.config.jitter > 0.0) {
+      jitter = m_normal(m_rng) * from.config.jitter;
+      jitter = std::max(-4 * from.config.jitter, std::min(4 * from.config.jitter, jitter));
+    }
+
+    const double t_bus = t + from.config.tx_delay + jitter;
+    for(unsigned int dst = 0; dst < m_stations.size(); dst++) {
+      const Station& to = m_stations[dst];
+      const double distance = std::abs(to.config.position - from.config.position);
+
+      Arrival arrival;
+      arrival.time = t_bus + distance * CABLE_DELAY + to.config.rx_delay;
+      arrival.src = src;
+      arrival.dst = dst;
+      arrival.dominant = !from.node.can_tx();
+      m_arrivals.push(arrival);
+    }
+  }
+
+  // Wired-AND at CAN_RX of the destination
+  void arrive(const Arrival& arrival)
+  {
+    Station& station = m_stations[arrival.dst];
+    uint8_t& driven = m_driven[arrival.dst * m_stations.size() + arrival.src];
+    if(driven == arrival.dominant)
+      return;
+
+    const bool recessive = station.dominant_sources == 0;
+    driven = arrival.dominant;
+    station.dominant_sources += arrival.dominant ? 1 : -1;
+
+    if(recessive != (station.dominant_sources == 0)) {
+      if(station.last_sample > station.last_edge)
+        station.min_hold = std::min(station.min_hold, arrival.time - station.last_sample);
+      station.last_edge = arrival.time;
+    }
+  }
+
+  std::vector<Station> m_stations;
+  std::vector<uint8_t> m_driven;  // [dst][src], dominant from src seen at dst
+  std::priority_queue<Arrival, std::vector<Arrival>, std::greater<Arrival>> m_arrivals;
+  std::mt19937_64 m_rng;
+  std::normal_distribution<double> m_normal;
+  double m_now = 0.0;
+};
+
+//-----------------------------------------------------------------------------
+// Monte Carlo study
+//-----------------------------------------------------------------------------
+
+constexpr unsigned int STUDY_NODES_MAX = 8;
+
+/**
+ * One setting of the BTL registers on one bus. Each run draws the clock
+ * error of each node uniformly from +/- clock_tolerance_ppm and the clock
+ * phases at random. The nodes are spread evenly along the bus, from one end
+ * to the other.
+ */
+struct StudyConfig {
+  Timing timing;
+  double clock_freq          = CLOCK_FREQ_DEFAULT;
+  unsigned int nodes         = 4;      // 2 to STUDY_NODES_MAX
+  double bus_length          = 10.0;   // m
+  double clock_tolerance_ppm = 100.0;
+  double tx_delay            = 75e-9;
+  double rx_delay            = 75e-9;
+  double jitter              = 2e-9;
+  unsigned int frames        = 100;    // Per run, some of them start at the same time
+  unsigned int runs          = 64;
+  unsigned int threads       = 0;      // 0 for one per core
+  uint64_t seed              = 1;
+};
+
+struct RunResult {
+  uint64_t bits = 0;
+  uint64_t frames_started = 0;
+  uint64_t frames_sent = 0;      // EVENT_TX_DONE
+  uint64_t frames_received = 0;  // EVENT_RX_MSG_VALID with a message that was sent
+  uint64_t frames_corrupt = 0;   // EVENT_RX_MSG_VALID with a message that was not sent
+  uint64_t frames_missing = 0;   // Sent, but not received by all the other nodes
+  uint64_t errors = 0;           // Bit, ACK, CRC, form and stuff error counters of all nodes
+  double min_setup = std::numeric_limits<double>::infinity();
+  double min_hold = std::numeric_limits<double>::infinity();
+
+  bool ok() const
+  {
+    return frames_sent == frames_started && frames_corrupt == 0 && frames_missing == 0 &&
+           errors == 0;
+  }
+};
+
+struct StudyResult {
+  unsigned int runs = 0;
+  unsigned int failed_runs = 0;
+  int first_failed_run = -1;
+  RunResult total;  // Sums, and the minimum margins
+};
+
+inline bool same_msg(const CanMsg& a, const CanMsg& b)
+{
+  if(a.arb_id_a != b.arb_id_a || a.ext_id != b.ext_id || a.remote_frame != b.remote_frame ||
+     a.data_length != b.data_length)
+    return false;
+  if(a.ext_id && a.arb_id_b != b.arb_id_b)
+    return false;
+  if(!a.remote_frame) {
+    for(unsigned int i = 0; i < a.data_length && i < 8; i++) {
+      if(a.payload[i] != b.payload[i])
+        return false;
+    }
+  }
+  return true;
+}
+
+// The low bits of ID A are the node number, no two nodes send the same ID
+inline CanMsg study_msg(std::mt19937_64& rng, unsigned int node)
+{
+  const uint64_t r = rng();
+  CanMsg msg = CanMsg{};
+  msg.ext_id = r & 1;
+  msg.remote_frame = ((r >> 1) & 0xF) == 0;
+  msg.arb_id_a = ((r >> 8) & 0x7F8) | node;
+  msg.arb_id_b = msg.ext_id ? (r >> 20) & 0x3FFFF : 0;
+  msg.data_length = (r >> 40) % 9;
+
+  const uint64_t payload = rng();
+  for(unsigned int i = 0; i < 8; i++)
+    msg.payload[i] = i < msg.data_length && !msg.remote_frame ? uint8_t(payload >> (8 * i)) : 0;
+  return msg;
+}
+
+inline RunResult run_once(const StudyConfig& config, unsigned int run)
+{
+  std::seed_seq seq{uint32_t(config.seed), uint32_t(config.seed >> 32), uint32_t(run)};
+  std::mt19937_64 rng(seq);
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+  const unsigned int nodes = std::max(2u, std::min(config.nodes, STUDY_NODES_MAX));
+  Network network(rng());
+
+  for(unsigned int i = 0; i < nodes; i++) {
+    NodeConfig node;
+    node.timing = config.timing;
+    node.clock_freq = config.clock_freq *
+                      (1.0 + (2.0 * uniform(rng) - 1.0) * config.clock_tolerance_ppm * 1e-6);
+    node.clock_phase = uniform(rng);
+    node.position = config.bus_length * i / (nodes - 1);
+    node.tx_delay = config.tx_delay;
+    node.rx_delay = config.rx_delay;
+    node.jitter = config.jitter;
+    network.add_node(node);
+    network.node(i).node().set_tx_retransmit_en(true);
+  }
+
+  RunResult result;
+  std::vector<CanMsg> tx_msg(nodes, CanMsg{});
+  std::vector<CanMsg> prev_tx_msg(nodes, CanMsg{});
+  std::vector<bool> has_tx_msg(nodes, false);
+
+  const double bit_time = config.timing.clocks_per_bit() / config.clock_freq;
+  const uint64_t bits_max = 400ull * config.frames + 1000;
+  unsigned int idle_bits = 0;
+
+  for(uint64_t bit = 0; bit < bits_max; bit++) {
+    bool busy = false;
+
+    for(unsigned int i = 0; i < nodes; i++) {
+      BtlNode& node = network.node(i);
+      const uint32_t events = node.take_events();
+
+      if(events & model::EVENT_TX_DONE)
+        result.frames_sent++;
+
+      if(events & model::EVENT_RX_MSG_VALID) {
+        bool sent = false;
+        for(unsigned int j = 0; j < nodes; j++) {
+          if(j != i && has_tx_msg[j] && (same_msg(node.rx_msg(), tx_msg[j]) ||
+                                         same_msg(node.rx_msg(), prev_tx_msg[j])))
+            sent = true;
+        }
+        if(sent)
+          result.frames_received++;
+        else
+          result.frames_corrupt++;
+      }
+
+      busy = busy || node.tx_busy();
+    }
+
+    idle_bits = busy ? 0 : idle_bits + 1;
+
+    if(result.frames_started == config.frames && idle_bits > 20)
+      break;
+
+    // New frames after a random gap, on one or (one in four) two nodes
+    if(!busy && result.frames_started < config.frames && rng() % 4 == 0) {
+      const unsigned int first = rng() % nodes;
+      const unsigned int second = rng() % 4 == 0 ? (first + 1 + rng() % (nodes - 1)) % nodes : first;
+
+      for(unsigned int i : {first, second}) {
+        if(result.frames_started == config.frames || network.node(i).tx_busy())
+          continue;
+        prev_tx_msg[i] = tx_msg[i];
+        tx_msg[i] = study_msg(rng, i);
+        has_tx_msg[i] = true;
+        network.node(i).start_tx(tx_msg[i]);
+        result.frames_started++;
+      }
+    }
+
+    network.run_until((bit + 1) * bit_time);
+    result.bits++;
+  }
+
+  const uint64_t expected = result.frames_sent * (nodes - 1);
+  result.frames_missing = expected > result.frames_received ? expected - result.frames_received : 0;
+
+  for(unsigned int i = 0; i < nodes; i++) {
+    const model::Node& node = network.node(i).node();
+    for(Counter counter : {Counter::TX_BIT_ERROR, Counter::TX_ACK_ERROR, Counter::RX_CRC_ERROR,
+                           Counter::RX_FORM_ERROR, Counter::RX_STUFF_ERROR})
+      result.errors += node.counter(counter);
+
+    result.min_setup = std::min(result.min_setup, network.min_setup(i));
+    result.min_hold = std::min(result.min_hold, network.min_hold(i));
+  }
+
+  return result;
+}
+
+/**
+ * config.runs runs of run_once() on all cores
+ */
+inline StudyResult run_study(const StudyConfig& config)
+{
+  std::vector<RunResult> runs(config.runs);
+  sim::run_sharded(config.runs, [&](unsigned int run) { runs[run] = run_once(config, run); },
+                   config.threads);
+
+  StudyResult result;
+  result.runs = config.runs;
+
+  for(unsigned int run = 0; run < config.runs; run++) {
+    const RunResult& r = runs[run];
+    if(!r.ok()) {
+      if(result.failed_runs == 0)
+        result.first_failed_run = run;
+      result.failed_runs++;
+    }
+
+    result.total.bits += r.bits;
+    result.total.frames_started += r.frames_started;
+    result.total.frames_sent += r.frames_sent;
+    result.total.frames_received += r.frames_received;
+    result.total.frames_corrupt += r.frames_corrupt;
+    result.total.frames_missing += r.frames_missing;
+    result.total.errors += r.errors;
+    result.total.min_setup = std::min(result.total.min_setup, r.min_setup);
+    result.total.min_hold = std::min(result.total.min_hold, r.min_hold);
+  }
+
+  return result;
+}
+
+} // namespace btl
+} // namespace canola
+
+#endif
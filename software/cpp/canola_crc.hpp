@@ -0,0 +1,425 @@
+/**
+ * @file   canola_crc.hpp
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  CAN CRC-15 (polynomial 0x4599), same result as canola_crc.vhd.
+ *
+ *         Input is a bit stream packed MSB first: bit 7 of byte 0 is the
+ *         first bit on the bus. The length is given in bits, so fields that
+ *         are not byte aligned (a CAN frame up to the CRC field never is)
+ *         can be handled without padding.
+ *
+ *         Implementations:
+ *         - crc15_serial(): bit by bit, port of canola_crc.vhd (reference)
+ *         - crc15_table():  one byte per step with a 256-entry table
+ *         - crc15_slice8(): slicing-by-8, eight bytes per step
+ *         - crc15_clmul():  folding with carry-less multiply, PCLMULQDQ on
+ *                           x86-64, PMULL on AArch64 (when built with +crypto)
+ *
+ *         crc15() uses the fastest implementation the CPU supports, selected
+ *         once at runtime. All functions take the CRC register value to
+ *         continue from, so a frame can be processed in several calls.
+ */
+
+#ifndef CANOLA_CRC_HPP
+#define CANOLA_CRC_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define CANOLA_CRC_HAVE_PCLMUL
+#elif defined(__aarch64__) && (defined(__ARM_FEATURE_CRYPTO) || defined(__ARM_FEATURE_AES))
+#include <arm_neon.h>
+#define CANOLA_CRC_HAVE_PMULL
+#if defined(__linux__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+#endif
+
+namespace canola
+{
+
+// Same as C_CAN_CRC_WIDTH in canola_pkg.vhd and c_polynomial in canola_crc.vhd
+constexpr unsigned int CRC15_WIDTH = 15;
+constexpr uint16_t CRC15_POLYNOMIAL = 0x4599;
+constexpr uint16_t CRC15_MASK = 0x7FFF;
+
+/**
+ * One step of canola_crc.vhd: shift in one bit
+ */
+inline uint16_t crc15_bit(uint16_t crc, bool bit)
+{
+  const bool crc_next = bit ^ ((crc >> (CRC15_WIDTH-1)) & 1);
+  crc = (crc << 1) & CRC15_MASK;
+  return crc_next ? crc ^ CRC15_POLYNOMIAL : crc;
+}
+
+/**
+ * Bit-serial reference implementation
+ */
+inline uint16_t crc15_serial(const uint8_t* data, size_t num_bits, uint16_t crc = 0)
+{
+  for(size_t i = 0; i < num_bits; i++)
+    crc = crc15_bit(crc, (data[i / 8] >> (7 - i % 8)) & 1);
+  return crc;
+}
+
+namespace detail
+{
+
+// The table based implementations keep the 15-bit CRC left aligned in a
+// 16-bit register (crc << 1), which makes the steps the same as for a
+// 16-bit CRC with polynomial 0x4599 << 1.
+constexpr uint16_t CRC15_POLYNOMIAL_LEFT = CRC15_POLYNOMIAL << 1;
+
+struct Crc15Tables {
+  // table[k][b]: CRC of byte b followed by k zero bytes
+  uint16_t table[8][256];
+
+  // tail[n][v]: CRC of the n-bit value v, for the last bits of an input
+  uint16_t tail[8][128];
+
+  Crc15Tables()
+  {
+    for(unsigned int b = 0; b < 256; b++) {
+      uint16_t crc = b << 8;
+      for(unsigned int i = 0; i < 8; i++)
+        crc = (crc & 0x8000) ? (crc << 1) ^ CRC15_POLYNOMIAL_LEFT : crc << 1;
+      table[0][b] = crc;
+    }
+
+    for(unsigned int k = 1; k < 8; k++) {
+      for(unsigned int b = 0; b < 256; b++) {
+        const uint16_t prev = table[k-1][b];
+        table[k][b] = (prev << 8) ^ table[0][prev >> 8];
+      }
+    }
+
+    for(unsigned int n = 1; n < 8; n++) {
+      for(unsigned int v = 0; v < (1u << n); v++) {
+        uint16_t crc = v << (16 - n);
+        for(unsigned int i = 0; i < n; i++)
+          crc = (crc & 0x8000) ? (crc << 1) ^ CRC15_POLYNOMIAL_LEFT : crc << 1;
+        tail[n][v] = crc;
+      }
+    }
+  }
+};
+
+inline const Crc15Tables& crc15_tables()
+{
+  static const Crc15Tables tables;
+  return tables;
+}
+
+inline uint16_t crc15_left_bytes(const uint16_t* table, const uint8_t* data, size_t num_bytes,
+                                 uint16_t crc_left)
+{
+  for(size_t i = 0; i < num_bytes; i++)
+    crc_left = (crc_left << 8) ^ table[(crc_left >> 8) ^ data[i]];
+  return crc_left;
+}
+
+// Shift in the n (less than 8) least significant bits of value
+inline uint16_t crc15_left_bits(const Crc15Tables& tables, uint16_t crc_left,
+                                unsigned int value, unsigned int n)
+{
+  if(n == 0)
+    return crc_left;
+  return (crc_left << n) ^ tables.tail[n][(crc_left >> (16 - n)) ^ value];
+}
+
+// The last num_bits % 8 bits, which are in the top bits of the last byte
+inline uint16_t crc15_tail(const uint8_t* data, size_t num_bits, uint16_t crc_left)
+{
+  const unsigned int n = num_bits % 8;
+
+  if(n == 0)
+    return crc_left >> 1;
+  return crc15_left_bits(crc15_tables(), crc_left, data[num_bits / 8] >> (8 - n), n) >> 1;
+}
+
+inline uint64_t load_be64(const uint8_t* p)
+{
+  uint64_t value;
+  std::memcpy(&value, p, sizeof(value));
+#if defined(__GNUC__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  value = __builtin_bswap64(value);
+#elif !defined(__GNUC__)
+  uint64_t be = 0;
+  for(unsigned int i = 0; i < 8; i++)
+    be = (be << 8) | p[i];
+  value = be;
+#endif
+  return value;
+}
+
+inline void store_be64(uint8_t* p, uint64_t value)
+{
+  for(unsigned int i = 0; i < 8; i++)
+    p[i] = value >> (56 - 8*i);
+}
+
+/**
+ * x^n mod P(x), where P(x) = x^15 + 0x4599
+ */
+constexpr uint16_t crc15_xpow(unsigned int n)
+{
+  uint32_t r = 1;
+  for(unsigned int i = 0; i < n; i++) {
+    r <<= 1;
+    if(r & 0x8000)
+      r ^= 0x8000 | CRC15_POLYNOMIAL;
+  }
+  return r;
+}
+
+} // namespace detail
+
+/**
+ * Byte-wise table implementation
+ */
+inline uint16_t crc15_table(const uint8_t* data, size_t num_bits, uint16_t crc = 0)
+{
+  const uint16_t* table = detail::crc15_tables().table[0];
+  const uint16_t crc_left = detail::crc15_left_bytes(table, data, num_bits / 8, crc << 1);
+  return detail::crc15_tail(data, num_bits, crc_left);
+}
+
+/**
+ * Slicing-by-8 implementation
+ */
+inline uint16_t crc15_slice8(const uint8_t* data, size_t num_bits, uint16_t crc = 0)
+{
+  const auto& t = detail::crc15_tables().table;
+  const size_t num_bytes = num_bits / 8;
+  uint16_t crc_left = crc << 1;
+  size_t i = 0;
+
+  for(; i + 8 <= num_bytes; i += 8) {
+    const uint64_t w = detail::load_be64(data + i) ^ (uint64_t(crc_left) << 48);
+    crc_left = t[7][w >> 56] ^ t[6][(w >> 48) & 0xFF] ^
+               t[5][(w >> 40) & 0xFF] ^ t[4][(w >> 32) & 0xFF] ^
+               t[3][(w >> 24) & 0xFF] ^ t[2][(w >> 16) & 0xFF] ^
+               t[1][(w >> 8) & 0xFF] ^ t[0][w & 0xFF];
+  }
+
+  crc_left = detail::crc15_left_bytes(t[0], data + i, num_bytes - i, crc_left);
+  return detail::crc15_tail(data, num_bits, crc_left);
+}
+
+#if defined(CANOLA_CRC_HAVE_PCLMUL) || defined(CANOLA_CRC_HAVE_PMULL)
+namespace detail
+{
+
+#if defined(CANOLA_CRC_HAVE_PCLMUL)
+#define CANOLA_CRC_CLMUL_TARGET __attribute__((target("pclmul,sse4.1")))
+
+// 64 x 64 -> 128 bit carry-less multiply
+CANOLA_CRC_CLMUL_TARGET
+inline void clmul64(uint64_t a, uint64_t b, uint64_t& hi, uint64_t& lo)
+{
+  const __m128i p = _mm_clmulepi64_si128(_mm_cvtsi64_si128(a), _mm_cvtsi64_si128(b), 0x00);
+  lo = _mm_cvtsi128_si64(p);
+  hi = _mm_extract_epi64(p, 1);
+}
+#else
+#define CANOLA_CRC_CLMUL_TARGET
+
+inline void clmul64(uint64_t a, uint64_t b, uint64_t& hi, uint64_t& lo)
+{
+  const poly128_t p = vmull_p64(a, b);
+  const uint64x2_t v = vreinterpretq_u64_p128(p);
+  lo = vgetq_lane_u64(v, 0);
+  hi = vgetq_lane_u64(v, 1);
+}
+#endif
+
+// A 128-bit block of the message as a polynomial, hi holds the first 64 bits
+struct Block128 {
+  uint64_t hi;
+  uint64_t lo;
+};
+
+// Multiply a block by x^(n+64) and x^n, as x^(n+64) mod P and x^n mod P.
+// The result is congruent to block * x^n, and fits in 128 bits since the
+// constants are below x^15.
+CANOLA_CRC_CLMUL_TARGET
+inline Block128 crc15_fold(Block128 block, uint64_t k_hi, uint64_t k_lo)
+{
+  uint64_t h1, l1, h2, l2;
+  clmul64(block.hi, k_hi, h1, l1);
+  clmul64(block.lo, k_lo, h2, l2);
+  return Block128{h1 ^ h2, l1 ^ l2};
+}
+
+CANOLA_CRC_CLMUL_TARGET
+inline Block128 crc15_load_block(const uint8_t* p)
+{
+  return Block128{load_be64(p), load_be64(p + 8)};
+}
+
+// Returns the CRC left aligned, num_bytes must be at least 16
+CANOLA_CRC_CLMUL_TARGET
+inline uint16_t crc15_clmul_bytes(const uint8_t* data, size_t num_bytes, uint16_t crc)
+{
+  // Fold distances: 4 blocks (512 bits) and 1 block (128 bits)
+  constexpr uint64_t K576 = crc15_xpow(512 + 64);
+  constexpr uint64_t K512 = crc15_xpow(512);
+  constexpr uint64_t K192 = crc15_xpow(128 + 64);
+  constexpr uint64_t K128 = crc15_xpow(128);
+
+  // The initial CRC register value is XORed into the first 15 bits
+  Block128 acc = crc15_load_block(data);
+  acc.hi ^= uint64_t(crc) << 49;
+  size_t i = 16;
+
+  if(num_bytes >= 128) {
+    Block128 acc4[4] = {acc, crc15_load_block(data + 16),
+                        crc15_load_block(data + 32), crc15_load_block(data + 48)};
+    i = 64;
+
+    for(; i + 64 <= num_bytes; i += 64) {
+      for(unsigned int j = 0; j < 4; j++) {
+        const Block128 folded = crc15_fold(acc4[j], K576, K512);
+        const Block128 next = crc15_load_block(data + i + 16*j);
+        acc4[j] = Block128{folded.hi ^ next.hi, folded.lo ^ next.lo};
+      }
+    }
+
+    acc = acc4[0];
+    for(unsigned int j = 1; j < 4; j++) {
+      const Block128 folded = crc15_fold(acc, K192, K128);
+      acc = Block128{folded.hi ^ acc4[j].hi, folded.lo ^ acc4[j].lo};
+    }
+  }
+
+  for(; i + 16 <= num_bytes; i += 16) {
+    const Block128 folded = crc15_fold(acc, K192, K128);
+    const Block128 next = crc15_load_block(data + i);
+    acc = Block128{folded.hi ^ next.hi, folded.lo ^ next.lo};
+  }
+
+  // The CRC of the remaining 128-bit block and bytes, starting from zero,
+  // is the CRC of the whole message
+  uint8_t last[16];
+  store_be64(last, acc.hi);
+  store_be64(last + 8, acc.lo);
+
+  const uint16_t* table = crc15_tables().table[0];
+  uint16_t crc_left = crc15_left_bytes(table, last, 16, 0);
+  return crc15_left_bytes(table, data + i, num_bytes - i, crc_left);
+}
+
+} // namespace detail
+
+/**
+ * Carry-less multiply implementation, inputs shorter than CRC15_CLMUL_MIN_BYTES
+ * use crc15_slice8(). Only call this if crc15_clmul_supported() returns true.
+ */
+constexpr size_t CRC15_CLMUL_MIN_BYTES = 128;
+
+inline uint16_t crc15_clmul(const uint8_t* data, size_t num_bits, uint16_t crc = 0)
+{
+  if(num_bits < 8 * CRC15_CLMUL_MIN_BYTES)
+    return crc15_slice8(data, num_bits, crc);
+
+  const uint16_t crc_left = detail::crc15_clmul_bytes(data, num_bits / 8, crc);
+  return detail::crc15_tail(data, num_bits, crc_left);
+}
+#endif
+
+/**
+ * True if crc15_clmul() is available in this build and supported by the CPU
+ */
+inline bool crc15_clmul_supported()
+{
+#if defined(CANOLA_CRC_HAVE_PCLMUL)
+  return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+#elif defined(CANOLA_CRC_HAVE_PMULL) && defined(__linux__)
+  return (getauxval(AT_HWCAP) & HWCAP_PMULL) != 0;
+#elif defined(CANOLA_CRC_HAVE_PMULL)
+  return true;
+#else
+  return false;
+#endif
+}
+
+typedef uint16_t (*Crc15Function)(const uint8_t* data, size_t num_bits, uint16_t crc);
+
+/**
+ * The implementation used by crc15(), and its name
+ */
+inline Crc15Function crc15_select(const char** name = nullptr)
+{
+#if defined(CANOLA_CRC_HAVE_PCLMUL) || defined(CANOLA_CRC_HAVE_PMULL)
+  if(crc15_clmul_supported()) {
+    if(name)
+      *name = "clmul";
+    return crc15_clmul;
+  }
+#endif
+  if(name)
+    *name = "slice8";
+  return crc15_slice8;
+}
+
+/**
+ * CRC-15 of num_bits bits, using the fastest implementation for this CPU
+ */
+inline uint16_t crc15(const uint8_t* data, size_t num_bits, uint16_t crc = 0)
+{
+  static const Crc15Function function = crc15_select();
+  return function(data, num_bits, crc);
+}
+
+/**
+ * Shift the num_bits (up to 64) least significant bits of value into the
+ * CRC, most significant bit first. For fields of a frame, e.g.
+ * crc = crc15_update(crc, msg.arb_id_a, 11)
+ */
+inline uint16_t crc15_update(uint16_t crc, uint64_t value, unsigned int num_bits)
+{
+  const detail::Crc15Tables& tables = detail::crc15_tables();
+  uint16_t crc_left = crc << 1;
+
+  for(; num_bits >= 8; num_bits -= 8) {
+    const uint8_t byte = value >> (num_bits - 8);
+    crc_left = (crc_left << 8) ^ tables.table[0][(crc_left >> 8) ^ byte];
+  }
+
+  crc_left = detail::crc15_left_bits(tables, crc_left, value & ((1u << num_bits) - 1), num_bits);
+  return crc_left >> 1;
+}
+
+/**
+ * CRC-15 of num_bits bits packed MSB first in 64-bit words (bit 63 of
+ * words[0] is the first bit), slicing-by-8 on each word
+ */
+inline uint16_t crc15_words(const uint64_t* words, size_t num_bits, uint16_t crc = 0)
+{
+  const auto& t = detail::crc15_tables().table;
+  uint16_t crc_left = crc << 1;
+  size_t i = 0;
+
+  for(; (i + 1) * 64 <= num_bits; i++) {
+    const uint64_t w = words[i] ^ (uint64_t(crc_left) << 48);
+    crc_left = t[7][w >> 56] ^ t[6][(w >> 48) & 0xFF] ^
+               t[5][(w >> 40) & 0xFF] ^ t[4][(w >> 32) & 0xFF] ^
+               t[3][(w >> 24) & 0xFF] ^ t[2][(w >> 16) & 0xFF] ^
+               t[1][(w >> 8) & 0xFF] ^ t[0][w & 0xFF];
+  }
+
+  const unsigned int remaining = num_bits - 64*i;
+  if(remaining == 0)
+    return crc_left >> 1;
+  return crc15_update(crc_left >> 1, words[i] >> (64 - remaining), remaining);
+}
+
+} // namespace canola
+
+#endif
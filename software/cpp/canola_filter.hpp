@@ -0,0 +1,533 @@
+/**
+ * @file   canola_filter.hpp
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Software acceptance filter for received CAN messages.
+ *
+ *         Up to FILTER_RULES_MAX ID/mask rules are compiled into:
+ *         - A 2048-bit bitmap for standard (11-bit) IDs, O(1) lookup
+ *         - Sorted, merged ID intervals for extended (29-bit) IDs, with a
+ *           linear fallback list for masks that do not expand to a
+ *           reasonable number of intervals
+ *
+ *         Single lookups use a binary search over the intervals. Batches
+ *         look up the standard IDs in the bitmap first, and then search
+ *         the extended IDs in a tree of the interval start IDs where each
+ *         node is compared against the ID with SIMD, 16 entries at a time.
+ *
+ *         FilterEngine holds two compiled tables and swaps between them, so
+ *         the rules can be replaced at runtime while another thread (or an
+ *         interrupt handler) keeps filtering without taking a lock.
+ */
+
+#ifndef CANOLA_FILTER_HPP
+#define CANOLA_FILTER_HPP
+
+#include "canola.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace canola
+{
+
+// Same as C_ACCEPTANCE_FILTERS_MAX in canola_pkg.vhd
+constexpr unsigned int FILTER_RULES_MAX = 256;
+
+constexpr uint32_t STD_ID_MASK = 0x7FF;
+constexpr uint32_t EXT_ID_MASK = 0x1FFFFFFF;
+
+/**
+ * Acceptance filter rule. A message is accepted when the ID bits that are
+ * set in mask are equal to the ones in id, and the frame type matches.
+ * For extended frames the ID is the full 29-bit ID: (arb_id_a << 18) | arb_id_b
+ */
+struct FilterRule {
+  uint32_t id;
+  uint32_t mask;
+  bool ext_id;
+};
+
+/**
+ * Key used for filter lookup: the 11-bit or 29-bit ID, with bit 31 set
+ * for extended frames
+ */
+constexpr uint32_t FILTER_KEY_EXT = uint32_t(1) << 31;
+
+inline uint32_t filter_key(const CanMsg& msg)
+{
+  if(msg.ext_id)
+    return FILTER_KEY_EXT | ((msg.arb_id_a & STD_ID_MASK) << 18) | (msg.arb_id_b & 0x3FFFF);
+  else
+    return msg.arb_id_a & STD_ID_MASK;
+}
+
+
+class FilterTable
+{
+public:
+  // Extended ID masks that expand to more intervals than this go to the
+  // linear fallback list instead
+  static constexpr unsigned int MAX_INTERVALS_PER_RULE = 64;
+
+  // Table that rejects all messages
+  FilterTable() { clear(); }
+
+  static FilterTable accept_all()
+  {
+    FilterTable table;
+    FilterRule rules[2] = {{0, 0, false}, {0, 0, true}};
+    table.compile(rules, 2);
+    return table;
+  }
+
+  /**
+   * Compile rules into the table. Returns false, and leaves the table
+   * unchanged, if there are more than FILTER_RULES_MAX rules.
+   */
+  bool compile(const FilterRule* rules, size_t num_rules)
+  {
+    if(num_rules > FILTER_RULES_MAX)
+      return false;
+
+    clear();
+
+    for(size_t i = 0; i < num_rules; i++) {
+      if(rules[i].ext_id)
+        add_ext_rule(rules[i].id & EXT_ID_MASK, rules[i].mask & EXT_ID_MASK);
+      else
+        add_std_rule(rules[i].id & STD_ID_MASK, rules[i].mask & STD_ID_MASK);
+    }
+
+    merge_intervals();
+    build_search_tree();
+    return true;
+  }
+
+  bool match(uint32_t key) const
+  {
+    if((key & FILTER_KEY_EXT) == 0)
+      return (m_std_bitmap[(key >> 5) & 63] >> (key & 31)) & 1;
+
+    return match_ext(key & EXT_ID_MASK);
+  }
+
+  bool match(const CanMsg& msg) const { return match(filter_key(msg)); }
+
+  /**
+   * Check num_keys filter keys, and set accepted[i] for each of them.
+   * Returns the number of accepted keys.
+   */
+  size_t match_batch(const uint32_t* keys, size_t num_keys, bool* accepted) const
+  {
+    size_t count = 0;
+
+#if defined(__GNUC__)
+    constexpr size_t CHUNK = 64;
+    uint32_t ext_index[CHUNK];
+
+    for(size_t i = 0; i < num_keys; i += CHUNK) {
+      const size_t n = std::min(CHUNK, num_keys - i);
+      size_t num_ext = 0;
+
+      // Look up standard IDs in the bitmap, and collect the extended IDs
+      // without branching on the frame type
+      for(size_t j = 0; j < n; j++) {
+        const uint32_t key = keys[i+j];
+        const uint32_t is_ext = key >> 31;
+
+        accepted[i+j] = (m_std_bitmap[(key >> 5) & 63] >> (key & 31)) & ~is_ext & 1;
+        ext_index[num_ext] = j;
+        num_ext += is_ext;
+      }
+
+      for(size_t e = 0; e < num_ext; e++)
+        accepted[i + ext_index[e]] = match_ext_simd(keys[i + ext_index[e]] & EXT_ID_MASK);
+
+      for(size_t j = 0; j < n; j++)
+        count += accepted[i+j];
+    }
+#else
+    for(size_t i = 0; i < num_keys; i++) {
+      accepted[i] = match(keys[i]);
+      count += accepted[i];
+    }
+#endif
+
+    return count;
+  }
+
+  size_t num_ext_intervals() const { return m_ext_intervals.size(); }
+  size_t num_ext_masked() const { return m_ext_masked.size(); }
+
+private:
+  struct Interval {
+    uint32_t first;
+    uint32_t last;
+  };
+
+  void clear()
+  {
+    std::fill(m_std_bitmap, m_std_bitmap + 64, 0);
+    m_ext_intervals.clear();
+    m_ext_masked.clear();
+    m_search_tree.clear();
+    m_masked_id.clear();
+    m_masked_mask.clear();
+  }
+
+  void add_std_rule(uint32_t id, uint32_t mask)
+  {
+    const uint32_t dont_care = ~mask & STD_ID_MASK;
+    const uint32_t base = id & mask;
+    uint32_t sub = 0;
+
+    // Enumerate all subsets of the don't care bits
+    do {
+      uint32_t std_id = base | sub;
+      m_std_bitmap[std_id >> 5] |= uint32_t(1) << (std_id & 31);
+      sub = (sub - dont_care) & dont_care;
+    } while(sub != 0);
+  }
+
+  void add_ext_rule(uint32_t id, uint32_t mask)
+  {
+    const uint32_t dont_care = ~mask & EXT_ID_MASK;
+
+    // Don't care bits below the lowest mask bit give one contiguous interval,
+    // each combination of the don't care bits above it gives another interval
+    const uint32_t low = mask == 0 ? EXT_ID_MASK : (mask & -mask) - 1;
+    const uint32_t high = dont_care & ~low;
+    const uint32_t base = id & mask;
+
+    if(popcount(high) > log2(MAX_INTERVALS_PER_RULE)) {
+      m_ext_masked.push_back(FilterRule{base, mask, true});
+      return;
+    }
+
+    uint32_t sub = 0;
+    do {
+      m_ext_intervals.push_back(Interval{base | sub, base | sub | low});
+      sub = (sub - high) & high;
+    } while(sub != 0);
+  }
+
+  void merge_intervals()
+  {
+    std::sort(m_ext_intervals.begin(), m_ext_intervals.end(),
+              [](const Interval& a, const Interval& b) { return a.first < b.first; });
+
+    size_t n = 0;
+    for(size_t i = 0; i < m_ext_intervals.size(); i++) {
+      if(n > 0 && m_ext_intervals[i].first <= uint64_t(m_ext_intervals[n-1].last) + 1)
+        m_ext_intervals[n-1].last = std::max(m_ext_intervals[n-1].last, m_ext_intervals[i].last);
+      else
+        m_ext_intervals[n++] = m_ext_intervals[i];
+    }
+    m_ext_intervals.resize(n);
+  }
+
+  /**
+   * Build the search tree used for batches from the merged intervals.
+   * Level 0 has the first ID of each interval, and each level above has the
+   * first ID of each node of the level below, up to a single root node.
+   * Unused entries are UINT32_MAX, which is above any extended ID.
+   * The fallback rules are laid out in arrays of whole SIMD vectors, padded
+   * with rules that never match.
+   */
+  void build_search_tree()
+  {
+    if(!m_ext_intervals.empty()) {
+      std::vector<uint32_t> level;
+
+      for(const Interval& iv : m_ext_intervals)
+        level.push_back(iv.first);
+
+      while(true) {
+        level.resize((level.size() + SEARCH_NODE - 1) / SEARCH_NODE * SEARCH_NODE, UINT32_MAX);
+        m_search_tree.push_back(level);
+
+        if(level.size() == SEARCH_NODE)
+          break;
+
+        std::vector<uint32_t> parent;
+        for(size_t i = 0; i < level.size(); i += SEARCH_NODE)
+          parent.push_back(level[i]);
+        level.swap(parent);
+      }
+    }
+
+    for(const FilterRule& rule : m_ext_masked) {
+      m_masked_id.push_back(rule.id);
+      m_masked_mask.push_back(rule.mask);
+    }
+
+    while(m_masked_id.size() % SEARCH_LANES != 0) {
+      m_masked_id.push_back(UINT32_MAX);
+      m_masked_mask.push_back(UINT32_MAX);
+    }
+  }
+
+  bool match_ext(uint32_t ext_id) const
+  {
+    auto it = std::upper_bound(m_ext_intervals.begin(), m_ext_intervals.end(), ext_id,
+                               [](uint32_t id, const Interval& iv) { return id < iv.first; });
+
+    if(it != m_ext_intervals.begin() && ext_id <= (it-1)->last)
+      return true;
+
+    for(const FilterRule& rule : m_ext_masked) {
+      if(((ext_id ^ rule.id) & rule.mask) == 0)
+        return true;
+    }
+
+    return false;
+  }
+
+  static unsigned int popcount(uint32_t x)
+  {
+    unsigned int n = 0;
+    for(; x != 0; x &= x - 1)
+      n++;
+    return n;
+  }
+
+  static constexpr unsigned int log2(unsigned int x)
+  {
+    return x <= 1 ? 0 : 1 + log2(x/2);
+  }
+
+  // Entries per search tree node, and entries compared at a time (one
+  // 256-bit vector with AVX2, otherwise 128-bit SSE/NEON vectors)
+  static constexpr size_t SEARCH_NODE = 16;
+#if defined(__AVX2__)
+  static constexpr size_t SEARCH_LANES = 8;
+#else
+  static constexpr size_t SEARCH_LANES = 4;
+#endif
+
+#if defined(__GNUC__)
+  // GCC/Clang vector extensions, compiled to SSE/AVX on x86 and NEON on ARM
+  typedef uint32_t u32xN __attribute__((vector_size(SEARCH_LANES*sizeof(uint32_t))));
+  typedef int32_t i32xN __attribute__((vector_size(SEARCH_LANES*sizeof(uint32_t))));
+
+  // Number of entries in a search tree node that are <= ext_id
+  static unsigned int count_le(const uint32_t* node, uint32_t ext_id)
+  {
+    const u32xN id = u32xN{} + ext_id;
+    i32xN le = {};
+
+    for(size_t i = 0; i < SEARCH_NODE; i += SEARCH_LANES) {
+      u32xN entries;
+      std::memcpy(&entries, node + i, sizeof(entries));
+      le += entries <= id;
+    }
+
+    int count = 0;
+    for(size_t j = 0; j < SEARCH_LANES; j++)
+      count -= le[j];
+
+    return count;
+  }
+
+  bool match_ext_simd(uint32_t ext_id) const
+  {
+    // No entry in the root node is <= ext_id when it is below all
+    // intervals, the nodes below it always have at least one
+    const unsigned int root_count = m_search_tree.empty() ? 0 : count_le(m_search_tree.back().data(), ext_id);
+
+    if(root_count > 0) {
+      size_t index = root_count - 1;
+
+      for(size_t level = m_search_tree.size() - 1; level-- > 0;)
+        index = index*SEARCH_NODE + count_le(m_search_tree[level].data() + index*SEARCH_NODE, ext_id) - 1;
+
+      if(ext_id <= m_ext_intervals[index].last)
+        return true;
+    }
+
+    const u32xN id = u32xN{} + ext_id;
+
+    for(size_t i = 0; i < m_masked_id.size(); i += SEARCH_LANES) {
+      u32xN rule_id;
+      u32xN rule_mask;
+      std::memcpy(&rule_id, &m_masked_id[i], sizeof(rule_id));
+      std::memcpy(&rule_mask, &m_masked_mask[i], sizeof(rule_mask));
+
+      const i32xN hit = ((id ^ rule_id) & rule_mask) == 0;
+
+      int any = 0;
+      for(size_t j = 0; j < SEARCH_LANES; j++)
+        any |= hit[j];
+
+      if(any)
+        return true;
+    }
+
+    return false;
+  }
+#endif
+
+  uint32_t m_std_bitmap[2048/32];
+  std::vector<Interval> m_ext_intervals;
+  std::vector<FilterRule> m_ext_masked;
+
+  // Layout of the extended ID tables for batches
+  std::vector<std::vector<uint32_t>> m_search_tree;
+  std::vector<uint32_t> m_masked_id;
+  std::vector<uint32_t> m_masked_mask;
+};
+
+
+/**
+ * Acceptance filter with rules that can be replaced at runtime.
+ *
+ * accept() and accept_batch() may be called concurrently from any number
+ * of threads (or interrupt handlers), and never block. set_rules() must
+ * only be called from one thread at a time. It compiles the new rules into
+ * the inactive table, waits for readers that may still be looking at that
+ * table from before the previous swap, and then makes it the active one.
+ * Initially all messages are accepted.
+ */
+class FilterEngine
+{
+public:
+  FilterEngine()
+  {
+    m_tables[0] = FilterTable::accept_all();
+  }
+
+  FilterEngine(const FilterEngine&) = delete;
+  FilterEngine& operator=(const FilterEngine&) = delete;
+
+  bool set_rules(const FilterRule* rules, size_t num_rules)
+  {
+    if(num_rules > FILTER_RULES_MAX)
+      return false;
+
+    const unsigned int next = 1 - m_active.load();
+
+    while(m_readers[next].load() != 0) {
+      // Spin, readers only hold a table for the duration of one lookup
+    }
+
+    m_tables[next].compile(rules, num_rules);
+    m_active.store(next);
+
+    return true;
+  }
+
+  void set_accept_all()
+  {
+    FilterRule rules[2] = {{0, 0, false}, {0, 0, true}};
+    set_rules(rules, 2);
+  }
+
+  bool accept(const CanMsg& msg) const
+  {
+    const unsigned int table = acquire();
+    bool accepted = m_tables[table].match(msg);
+    m_readers[table].fetch_sub(1);
+    return accepted;
+  }
+
+  /**
+   * Filter a batch of messages, sets accepted[i] for each message.
+   * Returns number of accepted messages.
+   */
+  size_t accept_batch(const CanMsg* msgs, size_t num_msgs, bool* accepted) const
+  {
+    constexpr size_t CHUNK = 64;
+    uint32_t keys[CHUNK];
+    size_t count = 0;
+
+    const unsigned int table = acquire();
+
+    for(size_t i = 0; i < num_msgs; i += CHUNK) {
+      size_t n = std::min(CHUNK, num_msgs - i);
+
+      for(size_t j = 0; j < n; j++)
+        keys[j] = filter_key(msgs[i+j]);
+
+      count += m_tables[table].match_batch(keys, n, accepted + i);
+    }
+
+    m_readers[table].fetch_sub(1);
+    return count;
+  }
+
+private:
+  // Register as reader of the active table, returns table index
+  unsigned int acquire() const
+  {
+    while(true) {
+      const unsigned int table = m_active.load();
+      m_readers[table].fetch_add(1);
+
+      // The table may have become inactive (and be about to be rewritten)
+      // before we registered, in that case try again
+      if(m_active.load() == table)
+        return table;
+
+      m_readers[table].fetch_sub(1);
+    }
+  }
+
+  FilterTable m_tables[2];
+  std::atomic<unsigned int> m_active{0};
+  mutable std::atomic<unsigned int> m_readers[2] = {{0}, {0}};
+};
+
+
+/**
+ * Load rules into the acceptance filter bank of the controller, so that
+ * messages that don't match any rule are dropped in hardware without raising
+ * an interrupt. num_hw_filters is the number of filters the controller was
+ * built with (G_ACCEPTANCE_FILTERS). Returns false, and leaves hardware
+ * filtering disabled, if there are more rules than hardware filters. In that
+ * case use FilterEngine to filter the messages in software instead.
+ */
+template <typename RegisterIO>
+bool load_acceptance_filters(Canola<RegisterIO>& can, const FilterRule* rules, size_t num_rules,
+                             unsigned int num_hw_filters)
+{
+  can.set_acceptance_filter_enable(false);
+
+  if(num_rules > num_hw_filters)
+    return false;
+
+  for(unsigned int i = 0; i < num_hw_filters; i++) {
+    if(i >= num_rules) {
+      can.disable_acceptance_filter(i);
+      continue;
+    }
+
+    CanMsg id = {};
+    CanMsg mask = {};
+
+    id.ext_id = rules[i].ext_id;
+    mask.ext_id = true;
+
+    if(rules[i].ext_id) {
+      id.arb_id_a = (rules[i].id >> 18) & STD_ID_MASK;
+      id.arb_id_b = rules[i].id & 0x3FFFF;
+      mask.arb_id_a = (rules[i].mask >> 18) & STD_ID_MASK;
+      mask.arb_id_b = rules[i].mask & 0x3FFFF;
+    } else {
+      id.arb_id_a = rules[i].id & STD_ID_MASK;
+      mask.arb_id_a = rules[i].mask & STD_ID_MASK;
+    }
+
+    can.set_acceptance_filter(i, id, mask);
+  }
+
+  can.set_acceptance_filter_enable(true);
+  return true;
+}
+
+} // namespace canola
+
+#endif
@@ -0,0 +1,248 @@
+/**
+ * @file   canola_io.hpp
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Register access backends (RegisterIO policies) for the
+ *         Canola C++ driver in canola.hpp.
+ *
+ *         A RegisterIO policy is any class that provides:
+ *           uint32_t read(uint32_t offset);
+ *           void write(uint32_t offset, uint32_t value);
+ *         where offset is a byte offset relative to the base address of
+ *         the Canola AXI-slave (e.g. CANOLA_AXI_SLAVE::STATUS_OFFSET).
+ *
+ *         A policy may additionally provide 64-bit accesses to an 8-byte
+ *         aligned pair of registers (low word at the lower address):
+ *           uint64_t read64(uint32_t offset);
+ *           void write64(uint32_t offset, uint64_t value);
+ *         which are used by the burst functions in the driver to merge two
+ *         register accesses into one bus transaction.
+ */
+
+#ifndef CANOLA_IO_HPP
+#define CANOLA_IO_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#if defined(__has_include)
+#if __has_include("xil_io.h")
+#define CANOLA_HAVE_XIL_IO 1
+#include "xil_io.h"
+#endif
+#endif
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace canola
+{
+
+#if defined(CANOLA_HAVE_XIL_IO)
+/**
+ * Bare-metal backend using the Xilinx standalone BSP (Xil_In32/Xil_Out32),
+ * same as the C driver in canola_zynq_test.
+ */
+class XilIO
+{
+public:
+  explicit XilIO(UINTPTR baseaddr) : m_baseaddr(baseaddr) {}
+
+  uint32_t read(uint32_t offset) const
+  {
+    return Xil_In32(m_baseaddr + offset);
+  }
+
+  void write(uint32_t offset, uint32_t value)
+  {
+    Xil_Out32(m_baseaddr + offset, value);
+  }
+
+private:
+  UINTPTR m_baseaddr;
+};
+#endif
+
+
+/**
+ * Backend for a register space that is already mapped into the address
+ * space of the process (Linux /dev/mem or UIO mmap, or a plain pointer on
+ * bare-metal). Does not own the mapping.
+ */
+class MmapIO
+{
+public:
+  explicit MmapIO(volatile void* base)
+    : m_base(static_cast<volatile uint32_t*>(base)) {}
+
+  uint32_t read(uint32_t offset) const
+  {
+    return m_base[offset/sizeof(uint32_t)];
+  }
+
+  void write(uint32_t offset, uint32_t value)
+  {
+    m_base[offset/sizeof(uint32_t)] = value;
+  }
+
+  volatile uint32_t* base() const { return m_base; }
+
+private:
+  volatile uint32_t* m_base;
+};
+
+
+/**
+ * MmapIO with 64-bit accesses (e.g. LDRD/STRD on ARM). Only use this when
+ * the interconnect in front of the AXI-Lite slave splits 64-bit transfers
+ * into 32-bit transfers (e.g. AXI interconnect with protocol converter on
+ * the Zynq GP ports).
+ */
+class MmapIO64 : public MmapIO
+{
+public:
+  explicit MmapIO64(volatile void* base) : MmapIO(base) {}
+
+  uint64_t read64(uint32_t offset) const
+  {
+    return *reinterpret_cast<volatile uint64_t*>(base() + offset/sizeof(uint32_t));
+  }
+
+  void write64(uint32_t offset, uint64_t value)
+  {
+    *reinterpret_cast<volatile uint64_t*>(base() + offset/sizeof(uint32_t)) = value;
+  }
+};
+
+
+#if defined(__linux__)
+/**
+ * Maps the physical address range of a Canola AXI-slave through /dev/mem.
+ * Owns the mapping, use io() to get an MmapIO backend for it.
+ */
+class DevMemMapping
+{
+public:
+  DevMemMapping(uint64_t phys_baseaddr, size_t size = 0x1000)
+    : m_size(size)
+  {
+    int fd = ::open("/dev/mem", O_RDWR | O_SYNC);
+    if(fd < 0)
+      return;
+
+    void* ptr = ::mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                       fd, static_cast<off_t>(phys_baseaddr));
+    ::close(fd);
+
+    if(ptr != MAP_FAILED)
+      m_base = ptr;
+  }
+
+  ~DevMemMapping()
+  {
+    if(m_base != nullptr)
+      ::munmap(m_base, m_size);
+  }
+
+  DevMemMapping(const DevMemMapping&) = delete;
+  DevMemMapping& operator=(const DevMemMapping&) = delete;
+
+  bool is_open() const { return m_base != nullptr; }
+  MmapIO io() const { return MmapIO(m_base); }
+
+private:
+  void* m_base = nullptr;
+  size_t m_size;
+};
+#endif
+
+
+/**
+ * In-memory register file for unit testing the driver on a host.
+ * Registers simply hold the last value written to them. The number of
+ * register reads and writes (bus transactions) is counted.
+ */
+class MockIO
+{
+public:
+  static constexpr size_t REG_SPACE_SIZE = 0x400;
+
+  MockIO() { m_regs.fill(0); }
+
+  uint32_t read(uint32_t offset) const
+  {
+    m_read_count++;
+    return m_regs[index(offset)];
+  }
+
+  void write(uint32_t offset, uint32_t value)
+  {
+    m_write_count++;
+    m_regs[index(offset)] = value;
+  }
+
+  // Backdoor access that does not affect the read/write counters,
+  // e.g. to emulate the controller updating a read-only register
+  uint32_t peek(uint32_t offset) const { return m_regs[index(offset)]; }
+  void poke(uint32_t offset, uint32_t value) { m_regs[index(offset)] = value; }
+
+  uint64_t read_count() const { return m_read_count; }
+  uint64_t write_count() const { return m_write_count; }
+  void reset_counts() { m_read_count = 0; m_write_count = 0; }
+
+private:
+  static size_t index(uint32_t offset)
+  {
+    return (offset % REG_SPACE_SIZE) / sizeof(uint32_t);
+  }
+
+protected:
+  std::array<uint32_t, REG_SPACE_SIZE/sizeof(uint32_t)> m_regs;
+  mutable uint64_t m_read_count = 0;
+  uint64_t m_write_count = 0;
+};
+
+
+/**
+ * MockIO with 64-bit accesses, each counted as one transaction
+ */
+class MockIO64 : public MockIO
+{
+public:
+  uint64_t read64(uint32_t offset) const
+  {
+    m_read_count++;
+    return uint64_t(peek(offset)) | (uint64_t(peek(offset+4)) << 32);
+  }
+
+  void write64(uint32_t offset, uint64_t value)
+  {
+    m_write_count++;
+    poke(offset, uint32_t(value));
+    poke(offset+4, uint32_t(value >> 32));
+  }
+};
+
+
+/**
+ * Detect if a RegisterIO policy provides read64()/write64()
+ */
+template <typename IO, typename = void>
+struct has_wide_access {
+  static constexpr bool value = false;
+};
+
+template <typename IO>
+struct has_wide_access<IO, decltype(void(std::declval<IO&>().write64(0, 0)),
+                                    void(std::declval<const IO&>().read64(0)))> {
+  static constexpr bool value = true;
+};
+
+} // namespace canola
+
+#endif
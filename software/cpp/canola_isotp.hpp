@@ -0,0 +1,783 @@
+/**
+ * @file   canola_isotp.hpp
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  ISO 15765-2 (ISO-TP) transport on top of the C++ driver, for
+ *         messages longer than the 8 bytes of a CAN frame, e.g. for
+ *         diagnostics and firmware updates.
+ *
+ *         Messages of up to 7 bytes are sent as a single frame, longer
+ *         messages as a first frame, followed by consecutive frames of 7
+ *         bytes each when the receiver has answered with a flow control
+ *         frame. Messages of up to 4095 bytes have the 12-bit length in the
+ *         first frame, longer messages (up to 4 GB) the 32-bit escape
+ *         length of ISO 15765-2:2016. Only normal addressing on classic CAN
+ *         is supported: a session sends with one arbitration ID and
+ *         receives with another, either 11 or 29 bits.
+ *
+ *         A Transport has any number of sessions for one controller, looked
+ *         up by the arbitration ID of received frames. Each session can send
+ *         and receive a message at the same time. There are no buffers in
+ *         the transport: send() segments the message from the caller's
+ *         buffer, and receive() gives a buffer that the next message is
+ *         reassembled into. The buffers must be kept until the result of
+ *         the transfer is no longer Result::BUSY.
+ *
+ *         Received frames are passed to on_msg() (e.g. from
+ *         Canola::drain()), and poll() sends the next frames and checks
+ *         timeouts. poll() should be called often, or after the Tx done
+ *         and Rx valid interrupts. Times are in ns from a monotonic clock,
+ *         passed in by the caller.
+ *
+ *         Frames are sent with a range of Tx mailboxes, so that several
+ *         consecutive frames are queued in the controller and the bus is
+ *         kept busy between calls to poll(). Mailboxes with the same ID are
+ *         sent in the order of the mailbox number, including on
+ *         retransmits, so a session only loads a frame into a mailbox with
+ *         a higher number than its frames that are pending, and starts
+ *         from the lowest mailbox again when they are all sent. With the
+ *         mailboxes disabled, frames are sent with the TX registers, one
+ *         frame per call to poll().
+ *
+ *         A frame that fails ends the message with Result::TX_FAILED, so
+ *         retransmit should be enabled (Canola::set_retransmit_enable()),
+ *         or a frame that loses arbitration fails.
+ */
+
+#ifndef CANOLA_ISOTP_HPP
+#define CANOLA_ISOTP_HPP
+
+#include "canola.hpp"
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+namespace canola
+{
+namespace isotp
+{
+
+// Protocol control information, upper nibble of the first byte
+enum FrameType : uint8_t {
+  SINGLE_FRAME      = 0,
+  FIRST_FRAME       = 1,
+  CONSECUTIVE_FRAME = 2,
+  FLOW_CONTROL      = 3
+};
+
+enum FlowStatus : uint8_t {
+  FLOW_CONTINUE = 0,
+  FLOW_WAIT     = 1,
+  FLOW_OVERFLOW = 2
+};
+
+constexpr uint32_t SINGLE_FRAME_MAX       = 7;
+constexpr uint32_t FIRST_FRAME_12BIT_MAX  = 4095;
+constexpr uint32_t CONSECUTIVE_FRAME_DATA = 7;
+constexpr uint8_t  PADDING_BYTE_DEFAULT   = 0xCC;
+constexpr uint64_t TIMEOUT_NS_DEFAULT     = 1000000000;  // N_As, N_Bs, N_Cr
+constexpr unsigned int WAIT_FRAMES_MAX_DEFAULT = 10;     // N_WFTmax
+constexpr unsigned int MAILBOXES_MAX      = 32;
+
+/**
+ * STmin of a flow control frame in ns. Reserved values are taken as the
+ * longest STmin, 127 ms.
+ */
+inline uint64_t st_min_ns(uint8_t st_min)
+{
+  if(st_min <= 0x7F)
+    return uint64_t(st_min) * 1000000;
+  if(st_min >= 0xF1 && st_min <= 0xF9)
+    return uint64_t(st_min - 0xF0) * 100000;
+  return 127000000;
+}
+
+/**
+ * Shortest STmin of at least us microseconds
+ */
+inline uint8_t encode_st_min(uint32_t us)
+{
+  if(us == 0)
+    return 0;
+  if(us <= 900)
+    return uint8_t(0xF0 + (us + 99) / 100);
+
+  const uint32_t ms = (us + 999) / 1000;
+  return uint8_t(ms < 0x7F ? ms : 0x7F);
+}
+
+/**
+ * IDs of a session, 11-bit, or 29-bit (arb_id_a << 18 | arb_id_b) with
+ * ext_id
+ */
+struct Address {
+  uint32_t tx_id;
+  uint32_t rx_id;
+  bool ext_id;
+};
+
+struct Options {
+  // Flow control sent when receiving a message: consecutive frames between
+  // flow control frames (0 for all of them), and the minimum time from the
+  // end of one consecutive frame to the start of the next
+  uint8_t block_size = 0;
+  uint32_t st_min_us = 0;
+
+  // Pad frames to 8 bytes with padding_byte, or send them with the data
+  // length they need
+  bool padding = true;
+  uint8_t padding_byte = PADDING_BYTE_DEFAULT;
+
+  // Time to wait for a frame to be sent, for flow control and for the
+  // next consecutive frame
+  uint64_t timeout_ns = TIMEOUT_NS_DEFAULT;
+
+  // Flow control frames with FLOW_WAIT accepted in a row
+  unsigned int wait_frames_max = WAIT_FRAMES_MAX_DEFAULT;
+};
+
+enum class Result {
+  IDLE,          // No message sent or buffer given
+  BUSY,          // Sending, or receiving/waiting for a message
+  DONE,
+  TIMEOUT,
+  OVERFLOW,      // Message longer than the receive buffer, or FLOW_OVERFLOW
+  WRONG_SN,      // Consecutive frame out of sequence
+  INVALID_FLOW,  // Flow control with a reserved flow status
+  WAIT_OVERRUN,  // More than wait_frames_max FLOW_WAIT
+  TX_FAILED,     // A frame could not be sent (mailbox failed)
+  ABORTED
+};
+
+inline const char* to_string(Result result)
+{
+  switch(result) {
+  case Result::IDLE:         return "IDLE";
+  case Result::BUSY:         return "BUSY";
+  case Result::DONE:         return "DONE";
+  case Result::TIMEOUT:      return "TIMEOUT";
+  case Result::OVERFLOW:     return "OVERFLOW";
+  case Result::WRONG_SN:     return "WRONG_SN";
+  case Result::INVALID_FLOW: return "INVALID_FLOW";
+  case Result::WAIT_OVERRUN: return "WAIT_OVERRUN";
+  case Result::TX_FAILED:    return "TX_FAILED";
+  case Result::ABORTED:      return "ABORTED";
+  }
+  return "?";
+}
+
+struct Stats {
+  uint64_t frames_sent = 0;
+  uint64_t frames_received = 0;   // For a session
+  uint64_t frames_ignored = 0;    // For a session, but invalid or not expected
+  uint64_t messages_sent = 0;
+  uint64_t messages_received = 0;
+};
+
+// Key of an ID in the session lookup, with the extended flag in the MSB
+inline uint32_t id_key(uint32_t id, bool ext_id)
+{
+  return ext_id ? (id | 0x80000000u) : id;
+}
+
+inline uint32_t id_key(const CanMsg& msg)
+{
+  return msg.ext_id ? ((msg.arb_id_a << 18) | msg.arb_id_b | 0x80000000u) : msg.arb_id_a;
+}
+
+
+template <typename RegisterIO>
+class Transport
+{
+public:
+  /**
+   * Frames are sent with Tx mailboxes first_mailbox to
+   * first_mailbox + num_mailboxes - 1, which must be enabled (see
+   * Canola::set_tx_mailbox_enable()) and not used by anything else, or with
+   * the TX registers when num_mailboxes is 0.
+   */
+  explicit Transport(Canola<RegisterIO>& can, unsigned int first_mailbox = 0,
+                     unsigned int num_mailboxes = 0)
+    : m_can(can), m_first_mailbox(first_mailbox),
+      m_num_mailboxes(num_mailboxes < MAILBOXES_MAX ? num_mailboxes : MAILBOXES_MAX) {}
+
+  /**
+   * Add a session. Returns the session number, or -1 if another session
+   * receives with the same ID.
+   */
+  int open(const Address& address, const Options& options = Options())
+  {
+    const uint32_t key = id_key(address.rx_id, address.ext_id);
+    if(m_lookup.count(key) != 0)
+      return -1;
+
+    m_lookup[key] = m_sessions.size();
+    m_sessions.emplace_back();
+    m_sessions.back().address = address;
+    m_sessions.back().options = options;
+    return m_sessions.size() - 1;
+  }
+
+  /**
+   * Send length bytes from data, which must be kept until tx_result() is
+   * no longer Result::BUSY. Returns false if the session is already
+   * sending a message.
+   */
+  bool send(unsigned int session, const uint8_t* data, uint32_t length, uint64_t now_ns)
+  {
+    Session& s = m_sessions[session];
+    if(s.tx_state != TxState::IDLE || length == 0)
+      return false;
+
+    s.tx_data = data;
+    s.tx_length = length;
+    s.tx_offset = 0;
+    s.tx_sn = 1;
+    s.tx_transfer++;
+    s.tx_state = TxState::FIRST;
+    s.tx_result = Result::BUSY;
+    s.tx_deadline_ns = now_ns + s.options.timeout_ns;
+
+    activate(session);
+    send_frames(s, session, now_ns);
+    return true;
+  }
+
+  /**
+   * Reassemble the next message for the session into buffer, of size
+   * bytes, which must be kept until rx_result() is no longer Result::BUSY.
+   * A first frame that does not fit is answered with FLOW_OVERFLOW.
+   * Returns false while a message is being received.
+   */
+  bool receive(unsigned int session, uint8_t* buffer, uint32_t size)
+  {
+    Session& s = m_sessions[session];
+    if(s.rx_state == RxState::RECEIVING)
+      return false;
+
+    s.rx_buffer = buffer;
+    s.rx_size = size;
+    s.rx_length = 0;
+    s.rx_state = RxState::WAITING;
+    s.rx_result = Result::BUSY;
+    return true;
+  }
+
+  // Stop sending and receiving. The receive buffer is released.
+  void abort(unsigned int session)
+  {
+    Session& s = m_sessions[session];
+    if(s.tx_state != TxState::IDLE)
+      finish_tx(s, session, Result::ABORTED);
+    if(s.rx_state != RxState::IDLE)
+      finish_rx(s, Result::ABORTED);
+  }
+
+  Result tx_result(unsigned int session) const { return m_sessions[session].tx_result; }
+  Result rx_result(unsigned int session) const { return m_sessions[session].rx_result; }
+
+  // Length of the message received (Result::DONE), or being received
+  uint32_t rx_length(unsigned int session) const { return m_sessions[session].rx_length; }
+
+  unsigned int num_sessions() const { return m_sessions.size(); }
+  const Stats& stats() const { return m_stats; }
+
+  // True while a session is sending or receiving a message
+  bool busy() const { return !m_active.empty(); }
+
+  /**
+   * Handle a received frame. Returns false if it is not for a session.
+   */
+  bool on_msg(const CanMsg& msg, uint64_t now_ns)
+  {
+    if(msg.remote_frame || msg.data_length == 0)
+      return false;
+
+    const auto it = m_lookup.find(id_key(msg));
+    if(it == m_lookup.end())
+      return false;
+
+    const unsigned int session = it->second;
+    Session& s = m_sessions[session];
+    bool valid = false;
+
+    m_stats.frames_received++;
+
+    switch(msg.payload[0] >> 4) {
+    case SINGLE_FRAME:      valid = rx_single_frame(s, msg); break;
+    case FIRST_FRAME:       valid = rx_first_frame(s, session, msg, now_ns); break;
+    case CONSECUTIVE_FRAME: valid = rx_consecutive_frame(s, session, msg, now_ns); break;
+    case FLOW_CONTROL:      valid = rx_flow_control(s, session, msg, now_ns); break;
+    }
+
+    if(!valid)
+      m_stats.frames_ignored++;
+
+    return true;
+  }
+
+  /**
+   * Check for frames that have been sent, send the next frames and check
+   * timeouts
+   */
+  void poll(uint64_t now_ns)
+  {
+    update_tx(now_ns);
+
+    for(size_t i = 0; i < m_active.size();) {
+      const unsigned int session = m_active[i];
+      Session& s = m_sessions[session];
+
+      if(s.fc_pending)
+        send_flow_control(s, session);
+
+      if(s.rx_state == RxState::RECEIVING && now_ns > s.rx_deadline_ns)
+        finish_rx(s, Result::TIMEOUT);
+
+      if(s.tx_state != TxState::IDLE) {
+        send_frames(s, session, now_ns);
+        if(now_ns > s.tx_deadline_ns)
+          finish_tx(s, session, Result::TIMEOUT);
+      }
+
+      if(s.tx_state == TxState::IDLE && s.rx_state != RxState::RECEIVING && !s.fc_pending) {
+        s.active = false;
+        m_active[i] = m_active.back();
+        m_active.pop_back();
+      } else {
+        i++;
+      }
+    }
+  }
+
+private:
+  enum class TxState : uint8_t {
+    IDLE,
+    FIRST,          // Single or first frame not loaded yet
+    WAIT_FC,        // Waiting for flow control
+    CONSECUTIVE,    // Loading consecutive frames
+    WAIT_DONE       // All frames loaded, waiting for them to be sent
+  };
+
+  enum class RxState : uint8_t {
+    IDLE,           // No buffer
+    WAITING,        // Waiting for a single or first frame
+    RECEIVING       // Waiting for consecutive frames
+  };
+
+  struct Session {
+    Address address;
+    Options options;
+    bool active = false;
+
+    TxState tx_state = TxState::IDLE;
+    Result tx_result = Result::IDLE;
+    const uint8_t* tx_data = nullptr;
+    uint32_t tx_length = 0;
+    uint32_t tx_offset = 0;          // Bytes loaded into frames
+    uint8_t tx_sn = 0;
+    uint32_t tx_transfer = 0;        // Tells frames of an aborted message apart
+    unsigned int tx_in_flight = 0;   // Frames of this message loaded and not sent
+    int tx_last_mailbox = -1;        // Highest mailbox with a frame in flight
+    unsigned int tx_block_left = 0;  // Consecutive frames until flow control, 0 for no limit
+    unsigned int tx_waits = 0;
+    uint64_t tx_st_min_ns = 0;
+    uint64_t tx_next_ns = 0;         // Earliest time for the next consecutive frame
+    uint64_t tx_deadline_ns = 0;
+
+    RxState rx_state = RxState::IDLE;
+    Result rx_result = Result::IDLE;
+    uint8_t* rx_buffer = nullptr;
+    uint32_t rx_size = 0;
+    uint32_t rx_length = 0;
+    uint32_t rx_offset = 0;
+    uint8_t rx_sn = 0;
+    unsigned int rx_block_left = 0;
+    uint64_t rx_deadline_ns = 0;
+
+    bool fc_pending = false;
+    FlowStatus fc_status = FLOW_CONTINUE;
+  };
+
+  // What was loaded into a mailbox
+  struct TxFrame {
+    unsigned int session;
+    uint32_t transfer;
+    bool flow_control;
+  };
+
+  void activate(unsigned int session)
+  {
+    if(!m_sessions[session].active) {
+      m_sessions[session].active = true;
+      m_active.push_back(session);
+    }
+  }
+
+  CanMsg new_frame(const Session& s) const
+  {
+    CanMsg msg = CanMsg{};
+    msg.ext_id = s.address.ext_id;
+    msg.arb_id_a = s.address.ext_id ? (s.address.tx_id >> 18) & 0x7FF : s.address.tx_id & 0x7FF;
+    msg.arb_id_b = s.address.ext_id ? s.address.tx_id & 0x3FFFF : 0;
+    return msg;
+  }
+
+  void set_length(const Session& s, CanMsg& msg, unsigned int length) const
+  {
+    if(s.options.padding) {
+      std::memset(msg.payload + length, s.options.padding_byte, 8 - length);
+      msg.data_length = 8;
+    } else {
+      msg.data_length = length;
+    }
+  }
+
+  /**
+   * Load a frame into the TX registers or a free mailbox. Data frames of a
+   * session go in mailboxes above its frames in flight, to keep them in
+   * order. Returns false if there is no room.
+   */
+  bool load(Session& s, unsigned int session, const CanMsg& msg, bool flow_control)
+  {
+    int mailbox = -1;
+    const TxFrame frame = {session, s.tx_transfer, flow_control};
+
+    if(m_num_mailboxes == 0) {
+      if(m_tx_regs_used || m_can.is_busy())
+        return false;
+
+      m_can.send_msg_burst(msg);
+      m_tx_regs_used = true;
+      m_tx_regs_frame = frame;
+    } else {
+      for(int i = flow_control ? 0 : s.tx_last_mailbox + 1; i < int(m_num_mailboxes); i++) {
+        if(!(m_mailboxes_used & (uint32_t(1) << i))) {
+          mailbox = i;
+          break;
+        }
+      }
+
+      if(mailbox < 0 || !m_can.send_msg_mailbox(m_first_mailbox + mailbox, msg))
+        return false;
+
+      m_mailboxes_used |= uint32_t(1) << mailbox;
+      m_mailbox_frames[mailbox] = frame;
+    }
+
+    if(!flow_control) {
+      s.tx_in_flight++;
+      s.tx_last_mailbox = mailbox;
+    }
+
+    m_stats.frames_sent++;
+    return true;
+  }
+
+  // Look for frames that have been sent
+  void update_tx(uint64_t now_ns)
+  {
+    if(m_num_mailboxes == 0) {
+      if(m_tx_regs_used && !m_can.is_busy()) {
+        m_tx_regs_used = false;
+        tx_frame_done(m_tx_regs_frame, false, now_ns);
+      }
+      return;
+    }
+
+    if(m_mailboxes_used == 0)
+      return;
+
+    const uint32_t sent = m_mailboxes_used & ~(m_can.tx_mailbox_pending() >> m_first_mailbox);
+    if(sent == 0)
+      return;
+
+    const uint32_t failed = (m_can.tx_mailbox_status().failed >> m_first_mailbox) & sent;
+    m_mailboxes_used &= ~sent;
+
+    for(unsigned int i = 0; i < m_num_mailboxes; i++) {
+      if(sent & (uint32_t(1) << i))
+        tx_frame_done(m_mailbox_frames[i], (failed & (uint32_t(1) << i)) != 0, now_ns);
+    }
+  }
+
+  void tx_frame_done(const TxFrame& frame, bool failed, uint64_t now_ns)
+  {
+    Session& s = m_sessions[frame.session];
+
+    // A lost flow control frame makes the sender time out
+    if(frame.flow_control || frame.transfer != s.tx_transfer || s.tx_state == TxState::IDLE)
+      return;
+
+    if(--s.tx_in_flight == 0)
+      s.tx_last_mailbox = -1;
+
+    if(failed) {
+      finish_tx(s, frame.session, Result::TX_FAILED);
+      return;
+    }
+
+    // STmin and N_Bs count from the end of the frame
+    s.tx_next_ns = now_ns + s.tx_st_min_ns;
+    s.tx_deadline_ns = now_ns + s.options.timeout_ns;
+
+    if(s.tx_state == TxState::WAIT_DONE && s.tx_in_flight == 0) {
+      m_stats.messages_sent++;
+      finish_tx(s, frame.session, Result::DONE);
+    }
+  }
+
+  void send_frames(Session& s, unsigned int session, uint64_t now_ns)
+  {
+    if(s.tx_state == TxState::FIRST) {
+      CanMsg msg = new_frame(s);
+      unsigned int header, data;
+
+      if(s.tx_length <= SINGLE_FRAME_MAX) {
+        msg.payload[0] = (SINGLE_FRAME << 4) | s.tx_length;
+        header = 1;
+        data = s.tx_length;
+      } else if(s.tx_length <= FIRST_FRAME_12BIT_MAX) {
+        msg.payload[0] = (FIRST_FRAME << 4) | (s.tx_length >> 8);
+        msg.payload[1] = uint8_t(s.tx_length);
+        header = 2;
+        data = 6;
+      } else {
+        msg.payload[0] = FIRST_FRAME << 4;
+        msg.payload[1] = 0;
+        for(unsigned int i = 0; i < 4; i++)
+          msg.payload[2 + i] = uint8_t(s.tx_length >> (24 - 8 * i));
+        header = 6;
+        data = 2;
+      }
+
+      std::memcpy(msg.payload + header, s.tx_data, data);
+      set_length(s, msg, header + data);
+
+      if(!load(s, session, msg, false))
+        return;
+
+      s.tx_offset = data;
+      s.tx_waits = 0;
+      s.tx_state = s.tx_length <= SINGLE_FRAME_MAX ? TxState::WAIT_DONE : TxState::WAIT_FC;
+      return;
+    }
+
+    while(s.tx_state == TxState::CONSECUTIVE) {
+      // With an STmin, one frame at a time
+      if(s.tx_st_min_ns > 0 && (s.tx_in_flight > 0 || now_ns < s.tx_next_ns))
+        return;
+
+      const uint32_t left = s.tx_length - s.tx_offset;
+      const unsigned int data = left < CONSECUTIVE_FRAME_DATA ? left : CONSECUTIVE_FRAME_DATA;
+      CanMsg msg = new_frame(s);
+
+      msg.payload[0] = (CONSECUTIVE_FRAME << 4) | s.tx_sn;
+      std::memcpy(msg.payload + 1, s.tx_data + s.tx_offset, data);
+      set_length(s, msg, 1 + data);
+
+      if(!load(s, session, msg, false))
+        return;
+
+      s.tx_offset += data;
+      s.tx_sn = (s.tx_sn + 1) & 0xF;
+
+      if(s.tx_offset == s.tx_length)
+        s.tx_state = TxState::WAIT_DONE;
+      else if(s.tx_block_left > 0 && --s.tx_block_left == 0)
+        s.tx_state = TxState::WAIT_FC;
+    }
+  }
+
+  void finish_tx(Session& s, unsigned int session, Result result)
+  {
+    // Frames of the message still in the mailboxes are not sent
+    if(result != Result::DONE && m_num_mailboxes > 0) {
+      uint32_t abort = 0;
+      for(unsigned int i = 0; i < m_num_mailboxes; i++) {
+        const TxFrame& frame = m_mailbox_frames[i];
+        if((m_mailboxes_used & (uint32_t(1) << i)) && frame.session == session &&
+           frame.transfer == s.tx_transfer && !frame.flow_control)
+          abort |= uint32_t(1) << i;
+      }
+      if(abort != 0)
+        m_can.abort_tx_mailboxes(abort << m_first_mailbox);
+    }
+
+    s.tx_state = TxState::IDLE;
+    s.tx_result = result;
+    s.tx_data = nullptr;
+    s.tx_in_flight = 0;
+    s.tx_last_mailbox = -1;
+  }
+
+  void finish_rx(Session& s, Result result)
+  {
+    s.rx_state = RxState::IDLE;
+    s.rx_result = result;
+    s.rx_buffer = nullptr;
+  }
+
+  void queue_flow_control(Session& s, unsigned int session, FlowStatus status)
+  {
+    s.fc_pending = true;
+    s.fc_status = status;
+    activate(session);
+    send_flow_control(s, session);
+  }
+
+  void send_flow_control(Session& s, unsigned int session)
+  {
+    CanMsg msg = new_frame(s);
+    msg.payload[0] = (FLOW_CONTROL << 4) | s.fc_status;
+    msg.payload[1] = s.options.block_size;
+    msg.payload[2] = encode_st_min(s.options.st_min_us);
+    set_length(s, msg, 3);
+
+    if(load(s, session, msg, true))
+      s.fc_pending = false;
+  }
+
+  bool rx_single_frame(Session& s, const CanMsg& msg)
+  {
+    const unsigned int length = msg.payload[0] & 0xF;
+    if(length == 0 || length > SINGLE_FRAME_MAX || length + 1 > msg.data_length ||
+       s.rx_state == RxState::IDLE)
+      return false;
+
+    // A single frame while receiving starts a new message
+    if(length > s.rx_size) {
+      finish_rx(s, Result::OVERFLOW);
+      return true;
+    }
+
+    std::memcpy(s.rx_buffer, msg.payload + 1, length);
+    s.rx_length = length;
+    m_stats.messages_received++;
+    finish_rx(s, Result::DONE);
+    return true;
+  }
+
+  bool rx_first_frame(Session& s, unsigned int session, const CanMsg& msg, uint64_t now_ns)
+  {
+    if(msg.data_length < 8)
+      return false;
+
+    uint32_t length = (uint32_t(msg.payload[0] & 0xF) << 8) | msg.payload[1];
+    unsigned int header = 2;
+
+    if(length == 0) {
+      length = (uint32_t(msg.payload[2]) << 24) | (uint32_t(msg.payload[3]) << 16) |
+               (uint32_t(msg.payload[4]) << 8) | msg.payload[5];
+      header = 6;
+      if(length <= FIRST_FRAME_12BIT_MAX)
+        return false;
+    } else if(length <= SINGLE_FRAME_MAX) {
+      return false;
+    }
+
+    if(s.rx_state == RxState::IDLE || length > s.rx_size) {
+      if(s.rx_state != RxState::IDLE)
+        finish_rx(s, Result::OVERFLOW);
+      queue_flow_control(s, session, FLOW_OVERFLOW);
+      return true;
+    }
+
+    std::memcpy(s.rx_buffer, msg.payload + header, 8 - header);
+    s.rx_length = length;
+    s.rx_offset = 8 - header;
+    s.rx_sn = 1;
+    s.rx_block_left = s.options.block_size;
+    s.rx_deadline_ns = now_ns + s.options.timeout_ns;
+    s.rx_state = RxState::RECEIVING;
+
+    queue_flow_control(s, session, FLOW_CONTINUE);
+    return true;
+  }
+
+  bool rx_consecutive_frame(Session& s, unsigned int session, const CanMsg& msg, uint64_t now_ns)
+  {
+    if(s.rx_state != RxState::RECEIVING)
+      return false;
+
+    if((msg.payload[0] & 0xF) != s.rx_sn) {
+      finish_rx(s, Result::WRONG_SN);
+      return true;
+    }
+
+    const uint32_t left = s.rx_length - s.rx_offset;
+    const unsigned int data = left < CONSECUTIVE_FRAME_DATA ? left : CONSECUTIVE_FRAME_DATA;
+    if(data + 1 > msg.data_length)
+      return false;
+
+    std::memcpy(s.rx_buffer + s.rx_offset, msg.payload + 1, data);
+    s.rx_offset += data;
+    s.rx_sn = (s.rx_sn + 1) & 0xF;
+    s.rx_deadline_ns = now_ns + s.options.timeout_ns;
+
+    if(s.rx_offset == s.rx_length) {
+      m_stats.messages_received++;
+      finish_rx(s, Result::DONE);
+    } else if(s.rx_block_left > 0 && --s.rx_block_left == 0) {
+      s.rx_block_left = s.options.block_size;
+      queue_flow_control(s, session, FLOW_CONTINUE);
+    }
+
+    return true;
+  }
+
+  bool rx_flow_control(Session& s, unsigned int session, const CanMsg& msg, uint64_t now_ns)
+  {
+    if(s.tx_state != TxState::WAIT_FC || msg.data_length < 3)
+      return false;
+
+    switch(msg.payload[0] & 0xF) {
+    case FLOW_CONTINUE:
+      s.tx_block_left = msg.payload[1];
+      s.tx_st_min_ns = st_min_ns(msg.payload[2]);
+      s.tx_waits = 0;
+      s.tx_deadline_ns = now_ns + s.options.timeout_ns;
+      s.tx_state = TxState::CONSECUTIVE;
+      send_frames(s, session, now_ns);
+      break;
+
+    case FLOW_WAIT:
+      if(++s.tx_waits > s.options.wait_frames_max)
+        finish_tx(s, session, Result::WAIT_OVERRUN);
+      else
+        s.tx_deadline_ns = now_ns + s.options.timeout_ns;
+      break;
+
+    case FLOW_OVERFLOW:
+      finish_tx(s, session, Result::OVERFLOW);
+      break;
+
+    default:
+      finish_tx(s, session, Result::INVALID_FLOW);
+      break;
+    }
+
+    return true;
+  }
+
+  Canola<RegisterIO>& m_can;
+  unsigned int m_first_mailbox;
+  unsigned int m_num_mailboxes;
+
+  std::vector<Session> m_sessions;
+  std::unordered_map<uint32_t, unsigned int> m_lookup;  // id_key() of rx_id
+  std::vector<unsigned int> m_active;
+
+  uint32_t m_mailboxes_used = 0;  // Relative to m_first_mailbox
+  TxFrame m_mailbox_frames[MAILBOXES_MAX] = {};
+  bool m_tx_regs_used = false;
+  TxFrame m_tx_regs_frame = {};
+
+  Stats m_stats;
+};
+
+} // namespace isotp
+} // namespace canola
+
+#endif
@@ -0,0 +1,1610 @@
+/**
+ * @file   canola_model.hpp
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Bit-level host model of the Canola CAN controller.
+ *
+ *         Node mirrors canola_frame_tx_fsm.vhd, canola_frame_rx_fsm.vhd,
+ *         canola_bsp.vhd, canola_eml.vhd and the status counters in
+ *         canola_top.vhd state for state, but is stepped once per CAN bit
+ *         instead of once per clock cycle:
+ *         - The BTL is ideal, all nodes on a Bus see the same bit value
+ *           (wired-AND of the bits they drive) at the same time
+ *         - States the RTL only passes through within a bit (SETUP_*,
+ *           ERROR, DONE, ...) are processed in the same call, in the order
+ *           the handshakes between the modules happen in the RTL
+ *         - Acceptance filters, Rx FIFO and Tx mailboxes are not modelled,
+ *           all received messages are accepted
+ *
+ *         Quirks of the RTL are kept on purpose (marked RTL in the comments),
+ *         the model should behave like the hardware and not like the CAN
+ *         specification.
+ */
+
+#ifndef CANOLA_MODEL_HPP
+#define CANOLA_MODEL_HPP
+
+#include "canola.hpp"
+#include "canola_crc.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace canola
+{
+namespace model
+{
+
+// Same as the constants in canola_pkg.vhd
+constexpr unsigned int ID_A_LENGTH         = 11;
+constexpr unsigned int ID_B_LENGTH         = 18;
+constexpr unsigned int DLC_LENGTH          = 4;
+constexpr unsigned int DLC_MAX_VALUE       = 8;
+constexpr unsigned int CRC_LENGTH          = 15;
+constexpr unsigned int EOF_LENGTH          = 7;
+constexpr unsigned int IFS_LENGTH          = 3;
+constexpr unsigned int BSP_DATA_LENGTH     = 64;
+constexpr unsigned int STUFF_BIT_THRESHOLD = 5;
+constexpr unsigned int ERROR_FLAG_LENGTH   = 6;
+
+constexpr unsigned int ERROR_COUNT_MAX                      = 511;
+constexpr unsigned int ERROR_PASSIVE_THRESHOLD              = 128;
+constexpr unsigned int BUS_OFF_THRESHOLD                    = 256;
+constexpr unsigned int RECESSIVE_11_EXIT_BUS_OFF_THRESHOLD  = 128;
+constexpr unsigned int REC_SUCCESS_ERROR_PASSIVE_JUMP_VALUE = 120;
+constexpr unsigned int TEC_ERROR_INCREASE                   = 8;
+constexpr unsigned int REC_ERROR_INCREASE                   = 1;
+constexpr unsigned int REC_ACTIVE_FLAG_BIT_ERROR_INCREASE   = 8;
+
+// Bits in a can_msg_t register
+constexpr unsigned int MSG_BITS = ID_A_LENGTH + ID_B_LENGTH + 2 + DLC_LENGTH + 8*8;
+
+constexpr unsigned int RETRANSMIT_COUNT_MAX_DEFAULT = 4;
+constexpr unsigned int RETRANSMIT_COUNT_FOREVER     = 0;
+
+/**
+ * States in the same order as in canola_pkg.vhd, so that the value is the
+ * same as 'pos of the VHDL state in a simulation
+ */
+enum class BspRxState : uint8_t {
+  ST_IDLE, ST_WAIT_BTL_RX_RDY, ST_PROCESS_BIT, ST_DATA_BIT, ST_BIT_DESTUFF,
+  ST_WAIT_BUS_IDLE, ST_CHECK_BUS_IDLE
+};
+
+enum class BspTxState : uint8_t {
+  ST_IDLE, ST_WAIT_TX_DATA, ST_PROCESS_NEXT_TX_BIT, ST_WAIT_BTL_TX_RDY,
+  ST_WAIT_BTL_TX_DONE, ST_WAIT_BTL_RX_VALID, ST_SEND_ERROR_FLAG
+};
+
+enum class FrameRxState : uint8_t {
+  ST_IDLE, ST_RECV_SOF, ST_RECV_ID_A, ST_RECV_SRR_RTR, ST_RECV_IDE, ST_RECV_ID_B,
+  ST_RECV_EXT_FRAME_RTR, ST_RECV_R1, ST_RECV_R0, ST_RECV_DLC, ST_RECV_DATA,
+  ST_RECV_CRC, ST_RECV_CRC_DELIM, ST_SEND_RECV_ACK, ST_RECV_ACK_DELIM, ST_RECV_EOF,
+  ST_ERROR, ST_WAIT_ERROR_FLAG, ST_DONE, ST_WAIT_BUS_IDLE
+};
+
+enum class FrameTxState : uint8_t {
+  ST_IDLE, ST_WAIT_FOR_BUS_IDLE, ST_SETUP_SOF, ST_SETUP_ID_A, ST_SETUP_SRR_RTR,
+  ST_SETUP_IDE, ST_SETUP_ID_B, ST_SETUP_EXT_RTR, ST_SETUP_R1, ST_SETUP_R0,
+  ST_SETUP_DLC, ST_SETUP_DATA, ST_SETUP_CRC, ST_SETUP_CRC_DELIM, ST_SETUP_ACK_SLOT,
+  ST_SETUP_ACK_DELIM, ST_SETUP_EOF, ST_SETUP_ERROR_FLAG, ST_SEND_SOF, ST_SEND_ID_A,
+  ST_SEND_SRR_RTR, ST_SEND_IDE, ST_SEND_ID_B, ST_SEND_EXT_RTR, ST_SEND_R1, ST_SEND_R0,
+  ST_SEND_DLC, ST_SEND_DATA, ST_SEND_CRC, ST_SEND_CRC_DELIM, ST_SEND_RECV_ACK_SLOT,
+  ST_SEND_ACK_DELIM, ST_SEND_EOF, ST_SEND_ERROR_FLAG, ST_ARB_LOST, ST_BIT_ERROR,
+  ST_ACK_ERROR, ST_RETRANSMIT, ST_DONE
+};
+
+inline const char* state_name(BspRxState state)
+{
+  static const char* const names[] = {
+    "ST_IDLE", "ST_WAIT_BTL_RX_RDY", "ST_PROCESS_BIT", "ST_DATA_BIT", "ST_BIT_DESTUFF",
+    "ST_WAIT_BUS_IDLE", "ST_CHECK_BUS_IDLE"
+  };
+  return names[static_cast<unsigned int>(state)];
+}
+
+inline const char* state_name(BspTxState state)
+{
+  static const char* const names[] = {
+    "ST_IDLE", "ST_WAIT_TX_DATA", "ST_PROCESS_NEXT_TX_BIT", "ST_WAIT_BTL_TX_RDY",
+    "ST_WAIT_BTL_TX_DONE", "ST_WAIT_BTL_RX_VALID", "ST_SEND_ERROR_FLAG"
+  };
+  return names[static_cast<unsigned int>(state)];
+}
+
+inline const char* state_name(FrameRxState state)
+{
+  static const char* const names[] = {
+    "ST_IDLE", "ST_RECV_SOF", "ST_RECV_ID_A", "ST_RECV_SRR_RTR", "ST_RECV_IDE", "ST_RECV_ID_B",
+    "ST_RECV_EXT_FRAME_RTR", "ST_RECV_R1", "ST_RECV_R0", "ST_RECV_DLC", "ST_RECV_DATA",
+    "ST_RECV_CRC", "ST_RECV_CRC_DELIM", "ST_SEND_RECV_ACK", "ST_RECV_ACK_DELIM", "ST_RECV_EOF",
+    "ST_ERROR", "ST_WAIT_ERROR_FLAG", "ST_DONE", "ST_WAIT_BUS_IDLE"
+  };
+  return names[static_cast<unsigned int>(state)];
+}
+
+inline const char* state_name(FrameTxState state)
+{
+  static const char* const names[] = {
+    "ST_IDLE", "ST_WAIT_FOR_BUS_IDLE", "ST_SETUP_SOF", "ST_SETUP_ID_A", "ST_SETUP_SRR_RTR",
+    "ST_SETUP_IDE", "ST_SETUP_ID_B", "ST_SETUP_EXT_RTR", "ST_SETUP_R1", "ST_SETUP_R0",
+    "ST_SETUP_DLC", "ST_SETUP_DATA", "ST_SETUP_CRC", "ST_SETUP_CRC_DELIM", "ST_SETUP_ACK_SLOT",
+    "ST_SETUP_ACK_DELIM", "ST_SETUP_EOF", "ST_SETUP_ERROR_FLAG", "ST_SEND_SOF", "ST_SEND_ID_A",
+    "ST_SEND_SRR_RTR", "ST_SEND_IDE", "ST_SEND_ID_B", "ST_SEND_EXT_RTR", "ST_SEND_R1", "ST_SEND_R0",
+    "ST_SEND_DLC", "ST_SEND_DATA", "ST_SEND_CRC", "ST_SEND_CRC_DELIM", "ST_SEND_RECV_ACK_SLOT",
+    "ST_SEND_ACK_DELIM", "ST_SEND_EOF", "ST_SEND_ERROR_FLAG", "ST_ARB_LOST", "ST_BIT_ERROR",
+    "ST_ACK_ERROR", "ST_RETRANSMIT", "ST_DONE"
+  };
+  return names[static_cast<unsigned int>(state)];
+}
+
+inline const char* state_name(ErrorState state)
+{
+  static const char* const names[] = {"ERROR_ACTIVE", "ERROR_PASSIVE", "BUS_OFF"};
+  return names[static_cast<unsigned int>(state)];
+}
+
+/**
+ * Pulses from a Node during the last bit, corresponds to the count up
+ * signals of the status counters in canola_top.vhd
+ */
+enum Event : uint32_t {
+  EVENT_TX_DONE           = 1 << 0,
+  EVENT_TX_FAILED         = 1 << 1,
+  EVENT_TX_ACK_ERROR      = 1 << 2,
+  EVENT_TX_ARB_LOST       = 1 << 3,
+  EVENT_TX_BIT_ERROR      = 1 << 4,
+  EVENT_TX_RETRANSMITTING = 1 << 5,
+  EVENT_RX_MSG_VALID      = 1 << 6,
+  EVENT_RX_CRC_ERROR      = 1 << 7,
+  EVENT_RX_FORM_ERROR     = 1 << 8,
+  EVENT_RX_STUFF_ERROR    = 1 << 9
+};
+
+/**
+ * A register of the RTL that a Node keeps between two bits, see
+ * Node::for_each_register()
+ */
+struct StateRegister {
+  const char* name;    // Member of Node, without the m_ prefix
+  const char* entity;  // Entity the register is in
+  unsigned int width;  // Number of bits in the model
+  bool voted;          // Updated from a triple-output voter every clock cycle with TMR
+};
+
+/**
+ * One Canola controller (canola_top without the AXI-slave)
+ */
+class Node
+{
+public:
+  explicit Node(unsigned int retransmit_count_max = RETRANSMIT_COUNT_MAX_DEFAULT)
+    : m_retransmit_count_max(retransmit_count_max)
+  {
+    m_tx_msg_in = CanMsg{};
+    m_rx_msg = CanMsg{};
+    reset();
+  }
+
+  void reset()
+  {
+    m_btl_rx_synced = false;
+    m_btl_prev_bit = true;
+
+    m_bsp_rx_state = BspRxState::ST_IDLE;
+    m_bsp_rx_data = 0;
+    bsp_rx_enter_idle();
+    m_bsp_rx_overflow = false;
+    m_bsp_rx_active_error_flag = false;
+    m_bsp_rx_passive_error_flag = false;
+    m_bsp_rx_destuff_en = true;
+
+    m_bsp_tx_state = BspTxState::ST_IDLE;
+    m_bsp_tx_active = false;
+    m_bsp_tx_data = 0;
+    m_bsp_tx_data_count = 0;
+    m_bsp_tx_write_counter = 0;
+    m_bsp_tx_bit = true;
+    m_bsp_tx_error_flag_shift_reg = 0;
+    bsp_tx_enter_idle();
+    clear_bsp_tx_pulses();
+
+    m_recessive_shift_reg = 0;
+    m_recessive_bit_count = 0;
+    m_tec = 0;
+    m_rec = 0;
+
+    m_tx_state = FrameTxState::ST_IDLE;
+    m_tx_busy = false;
+    m_tx_retransmit_attempts = 0;
+    m_tx_eml_error_state = ErrorState::ERROR_ACTIVE;
+    m_tx_active_error_flag_bit_error = false;
+    m_tx_msg = CanMsg{};
+
+    m_rx_state = FrameRxState::ST_IDLE;
+    m_rx_eml_error_state = ErrorState::ERROR_ACTIVE;
+    m_rx_crc_calc = 0;
+    m_rx_crc_mismatch = false;
+    m_rx_tx_arb_won = false;
+    m_rx_active_error_flag_bit_error = false;
+    m_rx_tx_bit_error = false;
+    m_rx_crc_error = false;
+    m_rx_form_error = false;
+    m_rx_stuff_error = false;
+    // RTL: only the first data byte of the Rx message register is reset
+    m_rx_msg.payload[0] = 0;
+
+    m_events = 0;
+    m_counters = Counters{};
+  }
+
+  /**
+   * TX_MSG input and TX_START pulse between two bits.
+   * Returns false if the Tx FSM ignored the start (busy or bus off).
+   */
+  bool start_tx(const CanMsg& msg)
+  {
+    m_tx_msg_in = msg;
+
+    if(m_tx_state != FrameTxState::ST_IDLE || m_tx_eml_error_state == ErrorState::BUS_OFF)
+      return false;
+
+    m_tx_busy = true;
+    m_tx_msg = msg;
+    m_tx_state = FrameTxState::ST_WAIT_FOR_BUS_IDLE;
+    settle();
+    return true;
+  }
+
+  /**
+   * TX_MSG input without starting, picked up on retransmit when
+   * TX_MSG_RELOAD is set (like the Tx mailboxes do). The retransmit
+   * attempts restart for the reloaded message.
+   */
+  void set_tx_msg(const CanMsg& msg) { m_tx_msg_in = msg; }
+
+  void set_tx_retransmit_en(bool enable) { m_tx_retransmit_en = enable; }
+  void set_tx_msg_reload(bool enable) { m_tx_msg_reload = enable; }
+  void set_tx_abort(bool abort) { m_tx_abort = abort; }
+
+  /**
+   * Bit driven on CAN_TX for the current bit
+   */
+  bool tx_bit() const
+  {
+    return m_bsp_tx_state == BspTxState::ST_WAIT_BTL_TX_RDY ? m_bsp_tx_bit : true;
+  }
+
+  /**
+   * Process the bit sampled on CAN_RX for the current bit
+   */
+  void rx_bit(bool bit)
+  {
+    m_events = 0;
+    clear_bsp_tx_pulses();
+
+    const bool tx_sent = bsp_tx_send();
+
+    // BTL: Hard synchronization on falling edge while not synced
+    if(!m_btl_rx_synced && m_btl_prev_bit && !bit)
+      m_btl_rx_synced = true;
+    m_btl_prev_bit = bit;
+
+    eml_recessive_bit(bit);
+
+    if(tx_sent)
+      bsp_tx_readback(bit);
+
+    frame_rx_fsm_eof_bit(bit);
+    frame_tx_fsm_bit();
+    frame_tx_fsm_settle(false);
+    bsp_rx_bit(bit);
+    frame_rx_fsm_bit();
+    eml_update_bus_off();
+    settle();
+  }
+
+  uint32_t events() const { return m_events; }
+
+  bool tx_busy() const { return m_tx_busy; }
+
+  /**
+   * BTL_RX_SYNCED and BTL_TX_ACTIVE, for a cycle-level BTL in front of the
+   * node (see canola_btl.hpp). It sets BTL_RX_SYNCED before each rx_bit(),
+   * and gets BTL_RX_STOP when rx_bit() clears it.
+   */
+  bool btl_rx_synced() const { return m_btl_rx_synced; }
+  void set_btl_rx_synced(bool synced) { m_btl_rx_synced = synced; }
+  bool bsp_tx_active() const { return m_bsp_tx_active; }
+
+  /**
+   * Content of the Rx message register. It is updated field by field while
+   * a frame is received, and is only valid after EVENT_RX_MSG_VALID.
+   */
+  const CanMsg& rx_msg() const { return m_rx_msg; }
+
+  ErrorState error_state() const
+  {
+    if(m_tec >= BUS_OFF_THRESHOLD)
+      return ErrorState::BUS_OFF;
+    else if(m_tec >= ERROR_PASSIVE_THRESHOLD || m_rec >= ERROR_PASSIVE_THRESHOLD)
+      return ErrorState::ERROR_PASSIVE;
+    else
+      return ErrorState::ERROR_ACTIVE;
+  }
+
+  unsigned int transmit_error_count() const { return m_tec; }
+  unsigned int receive_error_count() const { return m_rec; }
+  unsigned int recessive_bits_count() const { return m_recessive_bit_count; }
+
+  uint32_t counter(Counter counter) const
+  {
+    switch(counter) {
+    case Counter::TX_MSG_SENT:    return m_counters.tx_msg_sent;
+    case Counter::TX_FAILED:      return m_counters.tx_failed;
+    case Counter::TX_ACK_ERROR:   return m_counters.tx_ack_error;
+    case Counter::TX_ARB_LOST:    return m_counters.tx_arb_lost;
+    case Counter::TX_BIT_ERROR:   return m_counters.tx_bit_error;
+    case Counter::TX_RETRANSMIT:  return m_counters.tx_retransmit;
+    case Counter::RX_MSG_RECV:    return m_counters.rx_msg_recv;
+    case Counter::RX_CRC_ERROR:   return m_counters.rx_crc_error;
+    case Counter::RX_FORM_ERROR:  return m_counters.rx_form_error;
+    case Counter::RX_STUFF_ERROR: return m_counters.rx_stuff_error;
+    }
+    return 0;
+  }
+
+  void reset_counters(uint32_t mask)
+  {
+    if(mask & RESET_TX_MSG_SENT)    m_counters.tx_msg_sent = 0;
+    if(mask & RESET_TX_FAILED)      m_counters.tx_failed = 0;
+    if(mask & RESET_TX_ACK_ERROR)   m_counters.tx_ack_error = 0;
+    if(mask & RESET_TX_ARB_LOST)    m_counters.tx_arb_lost = 0;
+    if(mask & RESET_TX_BIT_ERROR)   m_counters.tx_bit_error = 0;
+    if(mask & RESET_TX_RETRANSMIT)  m_counters.tx_retransmit = 0;
+    if(mask & RESET_RX_MSG_RECV)    m_counters.rx_msg_recv = 0;
+    if(mask & RESET_RX_CRC_ERROR)   m_counters.rx_crc_error = 0;
+    if(mask & RESET_RX_FORM_ERROR)  m_counters.rx_form_error = 0;
+    if(mask & RESET_RX_STUFF_ERROR) m_counters.rx_stuff_error = 0;
+  }
+
+  FrameTxState frame_tx_state() const { return m_tx_state; }
+  FrameRxState frame_rx_state() const { return m_rx_state; }
+  BspTxState bsp_tx_state() const { return m_bsp_tx_state; }
+  BspRxState bsp_rx_state() const { return m_bsp_rx_state; }
+
+  /**
+   * Calls visit(reg, get) for each register the node keeps between two bits,
+   * where reg is a StateRegister and get(node) returns a reference to the
+   * register in node. Pulses that only last for the bit they are produced
+   * in, the configuration and the TX_MSG inputs are not included.
+   * Used for fault injection and voting between replicas (canola_seu.hpp).
+   */
+  template <typename Visitor>
+  static void for_each_register(Visitor&& visit)
+  {
+    visit(StateRegister{"btl_rx_synced", "canola_btl", 1, true},
+          [](auto& n) -> auto& { return n.m_btl_rx_synced; });
+    visit(StateRegister{"btl_prev_bit", "canola_btl", 1, false},
+          [](auto& n) -> auto& { return n.m_btl_prev_bit; });
+
+    visit(StateRegister{"bsp_rx_state", "canola_bsp", 3, true},
+          [](auto& n) -> auto& { return n.m_bsp_rx_state; });
+    visit(StateRegister{"bsp_rx_data", "canola_bsp", 64, false},
+          [](auto& n) -> auto& { return n.m_bsp_rx_data; });
+    visit(StateRegister{"bsp_rx_data_count", "canola_bsp", 7, false},
+          [](auto& n) -> auto& { return n.m_bsp_rx_data_count; });
+    visit(StateRegister{"bsp_rx_window", "canola_bsp", 6, false},
+          [](auto& n) -> auto& { return n.m_bsp_rx_window; });
+    visit(StateRegister{"bsp_rx_crc", "canola_bsp", CRC_LENGTH, true},
+          [](auto& n) -> auto& { return n.m_bsp_rx_crc; });
+    visit(StateRegister{"bsp_rx_stop_reg", "canola_bsp", 1, false},
+          [](auto& n) -> auto& { return n.m_bsp_rx_stop_reg; });
+    visit(StateRegister{"bsp_rx_start_of_frame", "canola_bsp", 1, false},
+          [](auto& n) -> auto& { return n.m_bsp_rx_start_of_frame; });
+    visit(StateRegister{"bsp_rx_overflow", "canola_bsp", 1, false},
+          [](auto& n) -> auto& { return n.m_bsp_rx_overflow; });
+
+    visit(StateRegister{"bsp_tx_state", "canola_bsp", 3, true},
+          [](auto& n) -> auto& { return n.m_bsp_tx_state; });
+    visit(StateRegister{"bsp_tx_write_counter", "canola_bsp", 7, false},
+          [](auto& n) -> auto& { return n.m_bsp_tx_write_counter; });
+    visit(StateRegister{"bsp_tx_bit", "canola_bsp", 1, false},
+          [](auto& n) -> auto& { return n.m_bsp_tx_bit; });
+    visit(StateRegister{"bsp_tx_window", "canola_bsp", 5, false},
+          [](auto& n) -> auto& { return n.m_bsp_tx_window; });
+    visit(StateRegister{"bsp_tx_crc", "canola_bsp", CRC_LENGTH, true},
+          [](auto& n) -> auto& { return n.m_bsp_tx_crc; });
+    visit(StateRegister{"bsp_tx_error_flag_shift_reg", "canola_bsp", ERROR_FLAG_LENGTH, false},
+          [](auto& n) -> auto& { return n.m_bsp_tx_error_flag_shift_reg; });
+    visit(StateRegister{"bsp_tx_send_ack", "canola_bsp", 1, false},
+          [](auto& n) -> auto& { return n.m_bsp_tx_send_ack; });
+    visit(StateRegister{"bsp_tx_send_error_flag", "canola_bsp", 1, false},
+          [](auto& n) -> auto& { return n.m_bsp_tx_send_error_flag; });
+    visit(StateRegister{"bsp_tx_frame_started", "canola_bsp", 1, false},
+          [](auto& n) -> auto& { return n.m_bsp_tx_frame_started; });
+    visit(StateRegister{"bsp_tx_stuff_bit", "canola_bsp", 1, false},
+          [](auto& n) -> auto& { return n.m_bsp_tx_stuff_bit; });
+    visit(StateRegister{"recessive_shift_reg", "canola_bsp", 11, false},
+          [](auto& n) -> auto& { return n.m_recessive_shift_reg; });
+
+    visit(StateRegister{"recessive_bit_count", "up_counter", 9, true},
+          [](auto& n) -> auto& { return n.m_recessive_bit_count; });
+    visit(StateRegister{"tec", "counter_saturating", 9, true},
+          [](auto& n) -> auto& { return n.m_tec; });
+    visit(StateRegister{"rec", "counter_saturating", 9, true},
+          [](auto& n) -> auto& { return n.m_rec; });
+
+    // Width of retransmit_attempts is for RETRANSMIT_COUNT_MAX_DEFAULT
+    visit(StateRegister{"tx_state", "canola_frame_tx_fsm", 6, true},
+          [](auto& n) -> auto& { return n.m_tx_state; });
+    visit(StateRegister{"tx_busy", "canola_frame_tx_fsm", 1, false},
+          [](auto& n) -> auto& { return n.m_tx_busy; });
+    visit(StateRegister{"tx_retransmit_attempts", "canola_frame_tx_fsm", 3, false},
+          [](auto& n) -> auto& { return n.m_tx_retransmit_attempts; });
+    visit(StateRegister{"tx_eml_error_state", "canola_frame_tx_fsm", 2, false},
+          [](auto& n) -> auto& { return n.m_tx_eml_error_state; });
+    visit(StateRegister{"tx_active_error_flag_bit_error", "canola_frame_tx_fsm", 1, false},
+          [](auto& n) -> auto& { return n.m_tx_active_error_flag_bit_error; });
+    visit(StateRegister{"tx_msg", "canola_frame_tx_fsm", MSG_BITS, false},
+          [](auto& n) -> auto& { return n.m_tx_msg; });
+    visit(StateRegister{"bsp_tx_active", "canola_frame_tx_fsm", 1, false},
+          [](auto& n) -> auto& { return n.m_bsp_tx_active; });
+    visit(StateRegister{"bsp_tx_data", "canola_frame_tx_fsm", 64, false},
+          [](auto& n) -> auto& { return n.m_bsp_tx_data; });
+    visit(StateRegister{"bsp_tx_data_count", "canola_frame_tx_fsm", 7, false},
+          [](auto& n) -> auto& { return n.m_bsp_tx_data_count; });
+
+    visit(StateRegister{"rx_state", "canola_frame_rx_fsm", 5, true},
+          [](auto& n) -> auto& { return n.m_rx_state; });
+    visit(StateRegister{"rx_eml_error_state", "canola_frame_rx_fsm", 2, false},
+          [](auto& n) -> auto& { return n.m_rx_eml_error_state; });
+    visit(StateRegister{"rx_crc_calc", "canola_frame_rx_fsm", CRC_LENGTH, false},
+          [](auto& n) -> auto& { return n.m_rx_crc_calc; });
+    visit(StateRegister{"rx_crc_mismatch", "canola_frame_rx_fsm", 1, false},
+          [](auto& n) -> auto& { return n.m_rx_crc_mismatch; });
+    visit(StateRegister{"rx_tx_arb_won", "canola_frame_rx_fsm", 1, false},
+          [](auto& n) -> auto& { return n.m_rx_tx_arb_won; });
+    visit(StateRegister{"rx_active_error_flag_bit_error", "canola_frame_rx_fsm", 1, false},
+          [](auto& n) -> auto& { return n.m_rx_active_error_flag_bit_error; });
+    visit(StateRegister{"rx_srr_rtr_bit", "canola_frame_rx_fsm", 1, false},
+          [](auto& n) -> auto& { return n.m_rx_srr_rtr_bit; });
+    visit(StateRegister{"rx_tx_bit_error", "canola_frame_rx_fsm", 1, false},
+          [](auto& n) -> auto& { return n.m_rx_tx_bit_error; });
+    visit(StateRegister{"rx_crc_error", "canola_frame_rx_fsm", 1, false},
+          [](auto& n) -> auto& { return n.m_rx_crc_error; });
+    visit(StateRegister{"rx_form_error", "canola_frame_rx_fsm", 1, false},
+          [](auto& n) -> auto& { return n.m_rx_form_error; });
+    visit(StateRegister{"rx_stuff_error", "canola_frame_rx_fsm", 1, false},
+          [](auto& n) -> auto& { return n.m_rx_stuff_error; });
+    visit(StateRegister{"rx_msg", "canola_frame_rx_fsm", MSG_BITS, false},
+          [](auto& n) -> auto& { return n.m_rx_msg; });
+
+    visit(StateRegister{"tx_msg_sent_count", "canola_counters", 32, true},
+          [](auto& n) -> auto& { return n.m_counters.tx_msg_sent; });
+    visit(StateRegister{"tx_failed_count", "canola_counters", 32, true},
+          [](auto& n) -> auto& { return n.m_counters.tx_failed; });
+    visit(StateRegister{"tx_ack_error_count", "canola_counters", 32, true},
+          [](auto& n) -> auto& { return n.m_counters.tx_ack_error; });
+    visit(StateRegister{"tx_arb_lost_count", "canola_counters", 32, true},
+          [](auto& n) -> auto& { return n.m_counters.tx_arb_lost; });
+    visit(StateRegister{"tx_bit_error_count", "canola_counters", 32, true},
+          [](auto& n) -> auto& { return n.m_counters.tx_bit_error; });
+    visit(StateRegister{"tx_retransmit_count", "canola_counters", 32, true},
+          [](auto& n) -> auto& { return n.m_counters.tx_retransmit; });
+    visit(StateRegister{"rx_msg_recv_count", "canola_counters", 32, true},
+          [](auto& n) -> auto& { return n.m_counters.rx_msg_recv; });
+    visit(StateRegister{"rx_crc_error_count", "canola_counters", 32, true},
+          [](auto& n) -> auto& { return n.m_counters.rx_crc_error; });
+    visit(StateRegister{"rx_form_error_count", "canola_counters", 32, true},
+          [](auto& n) -> auto& { return n.m_counters.rx_form_error; });
+    visit(StateRegister{"rx_stuff_error_count", "canola_counters", 32, true},
+          [](auto& n) -> auto& { return n.m_counters.rx_stuff_error; });
+  }
+
+  /**
+   * Moves the FSMs out of states the model does not hold between two bits,
+   * after their registers were written from the outside (an upset, see
+   * canola_seu.hpp), like the RTL does in the clock cycles that follow:
+   * states the model only passes through within a bit continue to the
+   * state that waits for the next bit, illegal encodings go to the state of
+   * the `when others` branch. canola_frame_tx_fsm.vhd has no `when others`
+   * branch, the Tx FSM keeps an illegal state.
+   */
+  void settle_states()
+  {
+    switch(m_bsp_rx_state) {
+    case BspRxState::ST_IDLE:
+    case BspRxState::ST_WAIT_BTL_RX_RDY:
+    case BspRxState::ST_WAIT_BUS_IDLE:
+      break;
+    case BspRxState::ST_PROCESS_BIT:
+    case BspRxState::ST_DATA_BIT:
+    case BspRxState::ST_BIT_DESTUFF:
+      m_bsp_rx_state = BspRxState::ST_WAIT_BTL_RX_RDY;
+      break;
+    case BspRxState::ST_CHECK_BUS_IDLE:
+      m_bsp_rx_state = BspRxState::ST_WAIT_BUS_IDLE;
+      break;
+    default:
+      // RTL: when others also pulses BTL_RX_STOP
+      m_btl_rx_synced = false;
+      bsp_rx_enter_idle();
+      break;
+    }
+
+    switch(m_bsp_tx_state) {
+    case BspTxState::ST_IDLE:
+    case BspTxState::ST_WAIT_TX_DATA:
+    case BspTxState::ST_PROCESS_NEXT_TX_BIT:
+    case BspTxState::ST_WAIT_BTL_TX_RDY:
+      break;
+    case BspTxState::ST_WAIT_BTL_TX_DONE:
+    case BspTxState::ST_WAIT_BTL_RX_VALID:
+      m_bsp_tx_state = BspTxState::ST_WAIT_BTL_TX_RDY;
+      break;
+    case BspTxState::ST_SEND_ERROR_FLAG:
+      bsp_tx_error_flag_next();
+      break;
+    default:
+      bsp_tx_enter_idle();
+      break;
+    }
+
+    frame_rx_fsm_settle();
+    settle();
+  }
+
+private:
+  struct Counters {
+    uint32_t tx_msg_sent;
+    uint32_t tx_failed;
+    uint32_t tx_ack_error;
+    uint32_t tx_arb_lost;
+    uint32_t tx_bit_error;
+    uint32_t tx_retransmit;
+    uint32_t rx_msg_recv;
+    uint32_t rx_crc_error;
+    uint32_t rx_form_error;
+    uint32_t rx_stuff_error;
+  };
+
+  static uint64_t low_bits(uint64_t value, unsigned int length)
+  {
+    return length >= 64 ? value : value & ((uint64_t(1) << length) - 1);
+  }
+
+  // Processes that run every clock cycle in the RTL, after a bit
+  void settle()
+  {
+    frame_tx_fsm_settle(true);
+    bsp_tx_settle();
+  }
+
+  //---------------------------------------------------------------------------
+  // BSP Rx (canola_bsp.vhd, proc_bsp_rx)
+  //---------------------------------------------------------------------------
+  bool bsp_rx_active() const { return m_bsp_rx_state != BspRxState::ST_IDLE; }
+
+  bool bsp_rx_ifs() const
+  {
+    return m_bsp_rx_state == BspRxState::ST_WAIT_BUS_IDLE ||
+      m_bsp_rx_state == BspRxState::ST_CHECK_BUS_IDLE;
+  }
+
+  unsigned int bsp_rx_data_count() const { return m_bsp_rx_data_count; }
+
+  // First length bits in BSP_RX_DATA, first bit is the MSB of the value
+  uint64_t bsp_rx_data(unsigned int length) const
+  {
+    return m_bsp_rx_data >> (BSP_DATA_LENGTH - length);
+  }
+
+  void bsp_rx_clear()
+  {
+    m_bsp_rx_data_count = 0;
+    m_bsp_rx_overflow = false;
+  }
+
+  void bsp_rx_stop()
+  {
+    // RTL: the stop request is cleared in ST_IDLE
+    if(m_bsp_rx_state != BspRxState::ST_IDLE)
+      m_bsp_rx_stop_reg = true;
+  }
+
+  void bsp_rx_enter_idle()
+  {
+    m_bsp_rx_state = BspRxState::ST_IDLE;
+    m_bsp_rx_stop_reg = false;
+    m_bsp_rx_start_of_frame = false;
+    m_bsp_rx_window = 0x3F;
+    m_bsp_rx_data_count = 0;
+    m_bsp_rx_crc = 0;
+  }
+
+  void bsp_rx_bit(bool bit)
+  {
+    m_bsp_rx_active_error_flag = false;
+    m_bsp_rx_passive_error_flag = false;
+    m_bsp_rx_destuff_en = frame_rx_destuff_en();
+
+    switch(m_bsp_rx_state) {
+    case BspRxState::ST_IDLE:
+      if(!m_btl_rx_synced)
+        return;
+
+      // The bit the BTL synced on is the SOF bit. BSP_RX_ACTIVE goes high on
+      // the falling edge, so the Rx FSM clears the data before the bit is sampled.
+      m_bsp_rx_start_of_frame = true;
+      m_bsp_rx_state = BspRxState::ST_WAIT_BTL_RX_RDY;
+      frame_rx_fsm_settle();
+      // fall through
+    case BspRxState::ST_WAIT_BTL_RX_RDY:
+      m_bsp_rx_window = ((m_bsp_rx_window << 1) | bit) & 0x3F;
+
+      // ST_PROCESS_BIT
+      if(m_bsp_rx_window == 0) {
+        m_bsp_rx_active_error_flag = true;
+        m_bsp_rx_state = BspRxState::ST_WAIT_BUS_IDLE;
+      } else if(m_bsp_rx_stop_reg) {
+        m_bsp_rx_window = 0;
+        m_bsp_rx_state = BspRxState::ST_WAIT_BUS_IDLE;
+      } else if(m_bsp_rx_window == 0x3F && m_bsp_rx_destuff_en) {
+        m_bsp_rx_passive_error_flag = true;
+        m_bsp_rx_window = 0;
+        m_bsp_rx_state = BspRxState::ST_WAIT_BUS_IDLE;
+      } else if(m_bsp_rx_destuff_en &&
+                (((m_bsp_rx_window >> 1) == 0x1F && !m_bsp_rx_start_of_frame) ||
+                 (m_bsp_rx_window >> 1) == 0)) {
+        // ST_BIT_DESTUFF: stuff bit is discarded
+      } else {
+        bsp_rx_data_bit(bit);
+      }
+      return;
+
+    case BspRxState::ST_WAIT_BUS_IDLE:
+      m_bsp_rx_window = ((m_bsp_rx_window << 1) | bit) & 0x3F;
+
+      // ST_CHECK_BUS_IDLE
+      if((m_bsp_rx_window & 0x7) == 0x7) {
+        // BTL_RX_STOP
+        m_btl_rx_synced = false;
+        bsp_rx_enter_idle();
+      }
+      return;
+
+    default:
+      return;
+    }
+  }
+
+  // ST_DATA_BIT
+  void bsp_rx_data_bit(bool bit)
+  {
+    m_bsp_rx_start_of_frame = false;
+
+    // RTL: bits in BSP_RX_DATA after the data count are not cleared, they
+    // keep their values from previous fields and frames
+    if(m_bsp_rx_data_count < BSP_DATA_LENGTH) {
+      const uint64_t mask = uint64_t(1) << (BSP_DATA_LENGTH - 1 - m_bsp_rx_data_count);
+      m_bsp_rx_data = bit ? m_bsp_rx_data | mask : m_bsp_rx_data & ~mask;
+      m_bsp_rx_data_count++;
+    } else {
+      m_bsp_rx_overflow = true;
+    }
+
+    m_bsp_rx_crc = crc15_bit(m_bsp_rx_crc, bit);
+  }
+
+  //---------------------------------------------------------------------------
+  // BSP Tx (canola_bsp.vhd, proc_bsp_tx)
+  //---------------------------------------------------------------------------
+  void clear_bsp_tx_pulses()
+  {
+    m_bsp_tx_done = false;
+    m_bsp_tx_rx_mismatch = false;
+    m_bsp_tx_rx_stuff_mismatch = false;
+    m_bsp_error_flag_done = false;
+    m_bsp_active_error_flag_bit_error = false;
+  }
+
+  void bsp_tx_enter_idle()
+  {
+    m_bsp_tx_state = BspTxState::ST_IDLE;
+    m_bsp_tx_send_ack = false;
+    m_bsp_tx_frame_started = false;
+    m_bsp_tx_crc = 0;
+    m_bsp_tx_send_error_flag = false;
+    m_bsp_tx_stuff_bit = false;
+    m_bsp_tx_window = 0x1F;
+  }
+
+  // BSP_TX_WRITE_EN from the Tx FSM
+  bool frame_tx_write_en() const
+  {
+    return m_tx_state >= FrameTxState::ST_SEND_SOF && m_tx_state <= FrameTxState::ST_SEND_EOF;
+  }
+
+  // BSP_TX_BIT_STUFF_EN from the Tx FSM
+  bool frame_tx_stuff_en() const
+  {
+    return m_tx_state != FrameTxState::ST_SEND_RECV_ACK_SLOT &&
+      m_tx_state != FrameTxState::ST_SEND_ACK_DELIM &&
+      m_tx_state != FrameTxState::ST_SEND_EOF;
+  }
+
+  // ST_WAIT_BTL_TX_RDY and ST_WAIT_BTL_TX_DONE, returns true if a bit was sent
+  bool bsp_tx_send()
+  {
+    if(m_bsp_tx_state != BspTxState::ST_WAIT_BTL_TX_RDY)
+      return false;
+
+    m_bsp_tx_window = ((m_bsp_tx_window << 1) | m_bsp_tx_bit) & 0x1F;
+
+    if(!m_bsp_tx_stuff_bit)
+      m_bsp_tx_crc = crc15_bit(m_bsp_tx_crc, m_bsp_tx_bit);
+
+    // RTL: the stuff bit flag is cleared before the bit is read back, so a
+    // stuff bit that is not read back is reported as BSP_TX_RX_MISMATCH
+    m_bsp_tx_stuff_bit = false;
+    m_bsp_tx_state = BspTxState::ST_WAIT_BTL_RX_VALID;
+    return true;
+  }
+
+  // ST_WAIT_BTL_RX_VALID
+  void bsp_tx_readback(bool bit)
+  {
+    if(m_bsp_tx_bit != bit) {
+      if(m_bsp_tx_send_error_flag && !m_bsp_tx_bit)
+        m_bsp_active_error_flag_bit_error = true;
+      else if(m_bsp_tx_send_error_flag)
+        m_bsp_tx_error_flag_shift_reg = 1;  // Passive error flag restarts on dominant bits
+      else if(m_bsp_tx_stuff_bit)
+        m_bsp_tx_rx_stuff_mismatch = true;
+      else
+        m_bsp_tx_rx_mismatch = true;
+    }
+
+    if(m_bsp_tx_send_error_flag) {
+      bsp_tx_error_flag_next();
+    } else if(m_bsp_tx_active) {
+      if(m_bsp_tx_write_counter == m_bsp_tx_data_count) {
+        m_bsp_tx_done = true;
+        m_bsp_tx_state = BspTxState::ST_WAIT_TX_DATA;
+      } else {
+        m_bsp_tx_state = BspTxState::ST_PROCESS_NEXT_TX_BIT;
+      }
+    } else {
+      bsp_tx_enter_idle();
+    }
+  }
+
+  // ST_SEND_ERROR_FLAG
+  void bsp_tx_error_flag_next()
+  {
+    m_bsp_tx_send_error_flag = true;
+
+    if(m_bsp_tx_error_flag_shift_reg == 0) {
+      m_bsp_error_flag_done = true;
+      bsp_tx_enter_idle();
+    } else {
+      m_bsp_tx_error_flag_shift_reg = (m_bsp_tx_error_flag_shift_reg << 1) & 0x3F;
+      m_bsp_tx_state = BspTxState::ST_WAIT_BTL_TX_RDY;
+    }
+  }
+
+  // BSP_SEND_ERROR_FLAG, overrides the current state
+  void bsp_tx_send_error_flag()
+  {
+    m_bsp_tx_bit = error_state() != ErrorState::ERROR_ACTIVE;
+    m_bsp_tx_error_flag_shift_reg = 1;
+    bsp_tx_error_flag_next();
+  }
+
+  // BSP_RX_SEND_ACK, only accepted in ST_IDLE
+  void bsp_tx_send_ack()
+  {
+    if(m_bsp_tx_state == BspTxState::ST_IDLE) {
+      m_bsp_tx_bit = false;
+      m_bsp_tx_send_ack = true;
+      m_bsp_tx_state = BspTxState::ST_WAIT_BTL_TX_RDY;
+    }
+  }
+
+  void bsp_tx_settle()
+  {
+    for(;;) {
+      switch(m_bsp_tx_state) {
+      case BspTxState::ST_IDLE:
+        if(!m_bsp_tx_active)
+          return;
+        m_bsp_tx_state = BspTxState::ST_WAIT_TX_DATA;
+        break;
+
+      case BspTxState::ST_WAIT_TX_DATA:
+        if(!m_bsp_tx_active) {
+          bsp_tx_enter_idle();
+        } else if(frame_tx_write_en()) {
+          m_bsp_tx_write_counter = 0;
+          m_bsp_tx_state = BspTxState::ST_PROCESS_NEXT_TX_BIT;
+        } else {
+          return;
+        }
+        break;
+
+      case BspTxState::ST_PROCESS_NEXT_TX_BIT:
+      {
+        const bool frame_started = m_bsp_tx_frame_started;
+        m_bsp_tx_frame_started = true;
+
+        if(!m_bsp_tx_active) {
+          bsp_tx_enter_idle();
+          break;
+        } else if(m_bsp_tx_write_counter == m_bsp_tx_data_count) {
+          m_bsp_tx_done = true;
+          m_bsp_tx_state = BspTxState::ST_WAIT_TX_DATA;
+          return;
+        }
+
+        if(frame_tx_stuff_en() && frame_started && m_bsp_tx_window == 0x1F) {
+          m_bsp_tx_bit = false;
+          m_bsp_tx_stuff_bit = true;
+        } else if(frame_tx_stuff_en() && frame_started && m_bsp_tx_window == 0) {
+          m_bsp_tx_bit = true;
+          m_bsp_tx_stuff_bit = true;
+        } else if(m_bsp_tx_write_counter < BSP_DATA_LENGTH) {
+          m_bsp_tx_bit = (m_bsp_tx_data >> (BSP_DATA_LENGTH - 1 - m_bsp_tx_write_counter)) & 1;
+          m_bsp_tx_write_counter++;
+        } else {
+          // Out of range only after an upset in the counters (canola_seu.hpp).
+          // The 7 bit counter wraps around.
+          m_bsp_tx_bit = false;
+          m_bsp_tx_write_counter = (m_bsp_tx_write_counter + 1) & 0x7F;
+        }
+        m_bsp_tx_state = BspTxState::ST_WAIT_BTL_TX_RDY;
+        break;
+      }
+
+      case BspTxState::ST_WAIT_BTL_TX_RDY:
+        if(!m_bsp_tx_active && !m_bsp_tx_send_ack && !m_bsp_tx_send_error_flag)
+          bsp_tx_enter_idle();
+        return;
+
+      default:
+        return;
+      }
+    }
+  }
+
+  //---------------------------------------------------------------------------
+  // EML (canola_eml.vhd)
+  //---------------------------------------------------------------------------
+  void eml_tec_increase(unsigned int value)
+  {
+    m_tec = m_tec + value > ERROR_COUNT_MAX ? ERROR_COUNT_MAX : m_tec + value;
+  }
+
+  void eml_rec_increase(unsigned int value)
+  {
+    m_rec = m_rec + value > ERROR_COUNT_MAX ? ERROR_COUNT_MAX : m_rec + value;
+  }
+
+  void eml_tx_bit_error()
+  {
+    eml_tec_increase(TEC_ERROR_INCREASE);
+    m_events |= EVENT_TX_BIT_ERROR;
+    m_counters.tx_bit_error++;
+  }
+
+  void eml_tx_ack_error()
+  {
+    // A transmitter that is error passive does not count missing ACKs
+    if(error_state() == ErrorState::ERROR_ACTIVE)
+      eml_tec_increase(TEC_ERROR_INCREASE);
+  }
+
+  void eml_tx_active_error_flag_bit_error()
+  {
+    eml_tec_increase(TEC_ERROR_INCREASE);
+  }
+
+  void eml_tx_success()
+  {
+    if(m_tec > 0)
+      m_tec--;
+  }
+
+  void eml_rx_active_error_flag_bit_error()
+  {
+    eml_rec_increase(REC_ACTIVE_FLAG_BIT_ERROR_INCREASE);
+  }
+
+  void eml_rx_success()
+  {
+    if(m_rec >= ERROR_PASSIVE_THRESHOLD)
+      m_rec = REC_SUCCESS_ERROR_PASSIVE_JUMP_VALUE;
+    else if(m_rec > 0)
+      m_rec--;
+  }
+
+  // Detection of 11 consecutive recessive bits (canola_top.vhd)
+  void eml_recessive_bit(bool bit)
+  {
+    m_recessive_shift_reg = ((m_recessive_shift_reg << 1) | bit) & 0x7FF;
+
+    if(m_recessive_shift_reg == 0x7FF) {
+      m_recessive_shift_reg &= ~1u;
+
+      if(error_state() == ErrorState::BUS_OFF)
+        m_recessive_bit_count++;
+    }
+
+    eml_update_bus_off();
+  }
+
+  void eml_update_bus_off()
+  {
+    if(error_state() != ErrorState::BUS_OFF) {
+      m_recessive_bit_count = 0;
+    } else if(m_recessive_bit_count == RECESSIVE_11_EXIT_BUS_OFF_THRESHOLD) {
+      m_tec = 0;
+      m_rec = 0;
+      m_recessive_bit_count = 0;
+    }
+  }
+
+  //---------------------------------------------------------------------------
+  // Frame Tx FSM (canola_frame_tx_fsm.vhd)
+  //---------------------------------------------------------------------------
+
+  // SETUP_* states: data for the next field to the BSP
+  void frame_tx_setup(uint64_t value, unsigned int length, FrameTxState next_state)
+  {
+    m_bsp_tx_data = low_bits(value, length) << (BSP_DATA_LENGTH - length);
+    m_bsp_tx_data_count = length;
+    m_tx_state = next_state;
+  }
+
+  // SEND_* states that report a bit error on mismatch
+  void frame_tx_send(FrameTxState next_state)
+  {
+    if(m_bsp_tx_rx_mismatch) {
+      m_bsp_tx_active = false;
+      m_tx_state = FrameTxState::ST_BIT_ERROR;
+    } else if(m_bsp_tx_done) {
+      m_tx_state = next_state;
+    }
+  }
+
+  // Reaction to the BSP pulses for the bit that was sent
+  void frame_tx_fsm_bit()
+  {
+    using S = FrameTxState;
+
+    switch(m_tx_state) {
+    case S::ST_SEND_SOF:   frame_tx_send(S::ST_SETUP_ID_A); break;
+    case S::ST_SEND_R1:    frame_tx_send(S::ST_SETUP_R0); break;
+    case S::ST_SEND_R0:    frame_tx_send(S::ST_SETUP_DLC); break;
+    case S::ST_SEND_DATA:  frame_tx_send(S::ST_SETUP_CRC); break;
+    case S::ST_SEND_CRC:   frame_tx_send(S::ST_SETUP_CRC_DELIM); break;
+    case S::ST_SEND_CRC_DELIM: frame_tx_send(S::ST_SETUP_ACK_SLOT); break;
+    case S::ST_SEND_ACK_DELIM: frame_tx_send(S::ST_SETUP_EOF); break;
+    case S::ST_SEND_EOF:   frame_tx_send(S::ST_DONE); break;
+    case S::ST_SEND_SRR_RTR: frame_tx_send(S::ST_SETUP_IDE); break;
+    case S::ST_SEND_EXT_RTR: frame_tx_send(S::ST_SETUP_R1); break;
+
+    case S::ST_SEND_ID_A:
+      if(m_bsp_tx_rx_stuff_mismatch) {
+        m_bsp_tx_active = false;
+        m_tx_state = S::ST_SEND_ERROR_FLAG;
+      } else if(m_bsp_tx_rx_mismatch) {
+        m_bsp_tx_active = false;
+        m_tx_state = S::ST_ARB_LOST;
+      } else if(m_bsp_tx_done) {
+        m_tx_state = S::ST_SETUP_SRR_RTR;
+      }
+      break;
+
+    case S::ST_SEND_IDE:
+      if(m_bsp_tx_rx_mismatch && m_tx_msg.ext_id) {
+        m_bsp_tx_active = false;
+        m_tx_state = S::ST_ARB_LOST;
+      } else if(m_bsp_tx_rx_mismatch) {
+        m_bsp_tx_active = false;
+        m_tx_state = S::ST_BIT_ERROR;
+      } else if(m_bsp_tx_done && m_tx_msg.ext_id) {
+        m_tx_state = S::ST_SETUP_ID_B;
+      } else if(m_bsp_tx_done) {
+        frame_tx_arb_won();
+        m_tx_state = S::ST_SETUP_R0;
+      }
+      break;
+
+    case S::ST_SEND_ID_B:
+      if(m_bsp_tx_rx_mismatch) {
+        m_bsp_tx_active = false;
+        m_tx_state = S::ST_ARB_LOST;
+      } else if(m_bsp_tx_done) {
+        m_tx_state = S::ST_SETUP_EXT_RTR;
+      }
+      break;
+
+    case S::ST_SEND_DLC:
+      if(m_tx_msg.remote_frame || m_tx_msg.data_length == 0)
+        frame_tx_send(S::ST_SETUP_CRC);
+      else
+        frame_tx_send(S::ST_SETUP_DATA);
+      break;
+
+    case S::ST_SEND_RECV_ACK_SLOT:
+      if(m_bsp_tx_done && m_bsp_tx_rx_mismatch)
+        m_tx_state = S::ST_SETUP_ACK_DELIM;  // Dominant ACK from a receiver
+      else if(m_bsp_tx_done)
+        m_tx_state = S::ST_ACK_ERROR;
+      break;
+
+    case S::ST_SEND_ERROR_FLAG:
+      if(m_tx_eml_error_state == ErrorState::ERROR_ACTIVE && m_bsp_active_error_flag_bit_error) {
+        if(!m_tx_active_error_flag_bit_error)
+          eml_tx_active_error_flag_bit_error();
+        m_tx_active_error_flag_bit_error = true;
+      }
+      if(m_bsp_error_flag_done)
+        m_tx_state = S::ST_RETRANSMIT;
+      break;
+
+    default:
+      break;
+    }
+  }
+
+  // TX_ARB_WON to the Rx FSM
+  void frame_tx_arb_won()
+  {
+    if(m_rx_state != FrameRxState::ST_IDLE)
+      m_rx_tx_arb_won = true;
+  }
+
+  // States that do not wait for the BSP. ST_WAIT_FOR_BUS_IDLE is only
+  // evaluated when the Rx side has processed the bit (check_bus_idle).
+  void frame_tx_fsm_settle(bool check_bus_idle)
+  {
+    using S = FrameTxState;
+    const CanMsg& msg = m_tx_msg;
+
+    for(;;) {
+      switch(m_tx_state) {
+      case S::ST_IDLE:
+        m_bsp_tx_active = false;
+        m_tx_busy = false;
+        m_tx_retransmit_attempts = 0;
+        m_tx_eml_error_state = error_state();
+        return;
+
+      case S::ST_WAIT_FOR_BUS_IDLE:
+        m_tx_active_error_flag_bit_error = false;
+        if(!check_bus_idle || bsp_rx_active() || bsp_rx_ifs())
+          return;
+        m_bsp_tx_active = true;
+        m_tx_state = S::ST_SETUP_SOF;
+        break;
+
+      case S::ST_SETUP_SOF:
+        frame_tx_setup(0, 1, S::ST_SEND_SOF);
+        break;
+      case S::ST_SETUP_ID_A:
+        frame_tx_setup(msg.arb_id_a, ID_A_LENGTH, S::ST_SEND_ID_A);
+        break;
+      case S::ST_SETUP_SRR_RTR:
+        frame_tx_setup(msg.ext_id ? 1 : msg.remote_frame, 1, S::ST_SEND_SRR_RTR);
+        break;
+      case S::ST_SETUP_IDE:
+        frame_tx_setup(msg.ext_id, 1, S::ST_SEND_IDE);
+        break;
+      case S::ST_SETUP_ID_B:
+        frame_tx_setup(msg.arb_id_b, ID_B_LENGTH, S::ST_SEND_ID_B);
+        break;
+      case S::ST_SETUP_EXT_RTR:
+        frame_tx_arb_won();
+        frame_tx_setup(msg.remote_frame, 1, S::ST_SEND_EXT_RTR);
+        break;
+      case S::ST_SETUP_R1:
+        frame_tx_setup(0, 1, S::ST_SEND_R1);
+        break;
+      case S::ST_SETUP_R0:
+        frame_tx_setup(0, 1, S::ST_SEND_R0);
+        break;
+      case S::ST_SETUP_DLC:
+        frame_tx_setup(msg.data_length, DLC_LENGTH, S::ST_SEND_DLC);
+        break;
+
+      case S::ST_SETUP_DATA:
+      {
+        uint64_t data = 0;
+        for(unsigned int i = 0; i < 8; i++)
+          data = (data << 8) | msg.payload[i];
+
+        // RTL: DLC values above 8 are out of range for the BSP data count
+        unsigned int length = 8 * (msg.data_length & 0xF);
+        if(length > BSP_DATA_LENGTH)
+          length = BSP_DATA_LENGTH;
+
+        m_bsp_tx_data = data;
+        m_bsp_tx_data_count = length;
+        m_tx_state = S::ST_SEND_DATA;
+        break;
+      }
+
+      case S::ST_SETUP_CRC:
+        frame_tx_setup(m_bsp_tx_crc, CRC_LENGTH, S::ST_SEND_CRC);
+        break;
+      case S::ST_SETUP_CRC_DELIM:
+        frame_tx_setup(1, 1, S::ST_SEND_CRC_DELIM);
+        break;
+      case S::ST_SETUP_ACK_SLOT:
+        frame_tx_setup(1, 1, S::ST_SEND_RECV_ACK_SLOT);
+        break;
+      case S::ST_SETUP_ACK_DELIM:
+        frame_tx_setup(1, 1, S::ST_SEND_ACK_DELIM);
+        break;
+      case S::ST_SETUP_EOF:
+        frame_tx_setup(0x7F, EOF_LENGTH, S::ST_SEND_EOF);
+        break;
+
+      case S::ST_SETUP_ERROR_FLAG:
+        bsp_tx_send_error_flag();
+        m_tx_state = S::ST_SEND_ERROR_FLAG;
+        break;
+
+      case S::ST_ARB_LOST:
+        m_events |= EVENT_TX_ARB_LOST;
+        m_counters.tx_arb_lost++;
+        m_tx_state = S::ST_RETRANSMIT;
+        break;
+
+      // The Tx FSM does not wait for the error flag, it waits for the bus
+      // to be idle again if the message is retransmitted
+      case S::ST_BIT_ERROR:
+        bsp_tx_send_error_flag();
+        eml_tx_bit_error();
+        m_tx_state = S::ST_RETRANSMIT;
+        break;
+
+      case S::ST_ACK_ERROR:
+        bsp_tx_send_error_flag();
+        eml_tx_ack_error();
+        m_events |= EVENT_TX_ACK_ERROR;
+        m_counters.tx_ack_error++;
+        m_tx_state = S::ST_RETRANSMIT;
+        break;
+
+      case S::ST_RETRANSMIT:
+        if(!m_tx_retransmit_en || m_tx_abort ||
+           (m_retransmit_count_max != RETRANSMIT_COUNT_FOREVER &&
+            m_tx_retransmit_attempts == m_retransmit_count_max)) {
+          m_events |= EVENT_TX_FAILED;
+          m_counters.tx_failed++;
+          m_tx_state = S::ST_IDLE;
+        } else {
+          m_events |= EVENT_TX_RETRANSMITTING;
+          m_counters.tx_retransmit++;
+          // A reloaded message is a new message with its own attempts
+          if(m_tx_msg_reload) {
+            m_tx_msg = m_tx_msg_in;
+            m_tx_retransmit_attempts = 0;
+          } else {
+            m_tx_retransmit_attempts++;
+          }
+          m_tx_state = S::ST_WAIT_FOR_BUS_IDLE;
+        }
+        break;
+
+      case S::ST_DONE:
+        m_bsp_tx_active = false;
+        eml_tx_success();
+        m_events |= EVENT_TX_DONE;
+        m_counters.tx_msg_sent++;
+        m_tx_state = S::ST_IDLE;
+        break;
+
+      default:
+        // ST_SEND_* states wait for the BSP
+        return;
+      }
+    }
+  }
+
+  //---------------------------------------------------------------------------
+  // Frame Rx FSM (canola_frame_rx_fsm.vhd)
+  //---------------------------------------------------------------------------
+  bool frame_rx_destuff_en() const
+  {
+    using S = FrameRxState;
+    return m_rx_state != S::ST_SEND_RECV_ACK && m_rx_state != S::ST_RECV_ACK_DELIM &&
+      m_rx_state != S::ST_RECV_EOF && m_rx_state != S::ST_ERROR &&
+      m_rx_state != S::ST_WAIT_ERROR_FLAG && m_rx_state != S::ST_WAIT_BUS_IDLE;
+  }
+
+  // ST_RECV_EOF checks the raw bits on the bus, not the BSP output
+  void frame_rx_fsm_eof_bit(bool bit)
+  {
+    if(m_rx_state == FrameRxState::ST_RECV_EOF &&
+       bsp_rx_data_count() < EOF_LENGTH-1 && !bit) {
+      m_rx_form_error = true;
+      m_rx_state = FrameRxState::ST_ERROR;
+    }
+  }
+
+  // Error flags detected by the BSP in a part of the frame that is stuffed
+  void frame_rx_fsm_bit()
+  {
+    using S = FrameRxState;
+
+    if(m_rx_state == S::ST_WAIT_ERROR_FLAG) {
+      if(m_rx_eml_error_state == ErrorState::ERROR_ACTIVE && m_bsp_active_error_flag_bit_error) {
+        if(!m_rx_active_error_flag_bit_error)
+          eml_rx_active_error_flag_bit_error();
+        m_rx_active_error_flag_bit_error = true;
+      }
+      if(m_bsp_error_flag_done) {
+        bsp_rx_stop();
+        m_rx_state = S::ST_WAIT_BUS_IDLE;
+      }
+    }
+
+    if(m_rx_state != S::ST_IDLE && m_bsp_rx_destuff_en &&
+       (m_bsp_rx_active_error_flag || m_bsp_rx_passive_error_flag)) {
+      m_rx_stuff_error = true;
+      m_rx_state = S::ST_ERROR;
+    }
+
+    frame_rx_fsm_settle();
+  }
+
+  // Returns true and clears the BSP data when a field of length bits is received
+  bool frame_rx_field(unsigned int length)
+  {
+    if(bsp_rx_data_count() != length)
+      return false;
+    bsp_rx_clear();
+    return true;
+  }
+
+  void frame_rx_fsm_settle()
+  {
+    using S = FrameRxState;
+    CanMsg& msg = m_rx_msg;
+
+    for(;;) {
+      if(m_rx_state != S::ST_IDLE && m_rx_state < S::ST_RECV_EOF && !bsp_rx_active()) {
+        m_rx_state = S::ST_ERROR;
+        continue;
+      }
+
+      switch(m_rx_state) {
+      case S::ST_IDLE:
+        m_rx_crc_mismatch = false;
+        m_rx_active_error_flag_bit_error = false;
+        m_rx_tx_arb_won = false;
+        m_rx_eml_error_state = error_state();
+        if(!bsp_rx_active())
+          return;
+        bsp_rx_clear();
+        m_rx_state = S::ST_RECV_SOF;
+        break;
+
+      case S::ST_RECV_SOF:
+        if(!frame_rx_field(1))
+          return;
+        if(bsp_rx_data(1) == 0) {
+          m_rx_state = S::ST_RECV_ID_A;
+        } else {
+          m_rx_form_error = true;
+          m_rx_state = S::ST_ERROR;
+        }
+        break;
+
+      case S::ST_RECV_ID_A:
+        if(!frame_rx_field(ID_A_LENGTH))
+          return;
+        msg.arb_id_a = bsp_rx_data(ID_A_LENGTH);
+        m_rx_state = S::ST_RECV_SRR_RTR;
+        break;
+
+      case S::ST_RECV_SRR_RTR:
+        if(!frame_rx_field(1))
+          return;
+        m_rx_srr_rtr_bit = bsp_rx_data(1);
+        m_rx_state = S::ST_RECV_IDE;
+        break;
+
+      case S::ST_RECV_IDE:
+        if(!frame_rx_field(1))
+          return;
+        msg.ext_id = bsp_rx_data(1);
+        if(msg.ext_id && !m_rx_srr_rtr_bit) {
+          m_rx_form_error = true;
+          m_rx_state = S::ST_ERROR;
+        } else if(msg.ext_id) {
+          m_rx_state = S::ST_RECV_ID_B;
+        } else {
+          msg.remote_frame = m_rx_srr_rtr_bit;
+          m_rx_state = S::ST_RECV_R0;
+        }
+        break;
+
+      case S::ST_RECV_ID_B:
+        if(!frame_rx_field(ID_B_LENGTH))
+          return;
+        msg.arb_id_b = bsp_rx_data(ID_B_LENGTH);
+        m_rx_state = S::ST_RECV_EXT_FRAME_RTR;
+        break;
+
+      case S::ST_RECV_EXT_FRAME_RTR:
+        if(!frame_rx_field(1))
+          return;
+        msg.remote_frame = bsp_rx_data(1);
+        m_rx_state = S::ST_RECV_R1;
+        break;
+
+      case S::ST_RECV_R1:
+        if(!frame_rx_field(1))
+          return;
+        m_rx_state = S::ST_RECV_R0;
+        break;
+
+      case S::ST_RECV_R0:
+        if(!frame_rx_field(1))
+          return;
+        m_rx_state = S::ST_RECV_DLC;
+        break;
+
+      case S::ST_RECV_DLC:
+        if(!frame_rx_field(DLC_LENGTH))
+          return;
+        if(bsp_rx_data(DLC_LENGTH) > DLC_MAX_VALUE) {
+          m_rx_form_error = true;
+          m_rx_state = S::ST_ERROR;
+          break;
+        }
+        msg.data_length = bsp_rx_data(DLC_LENGTH);
+        if(msg.remote_frame) {
+          m_rx_crc_calc = m_bsp_rx_crc;
+          m_rx_state = S::ST_RECV_CRC;
+        } else {
+          m_rx_state = S::ST_RECV_DATA;
+        }
+        break;
+
+      case S::ST_RECV_DATA:
+        if(!frame_rx_field(8 * msg.data_length))
+          return;
+        for(unsigned int i = 0; i < 8; i++)
+          msg.payload[i] = m_bsp_rx_data >> (BSP_DATA_LENGTH - 8*(i+1));
+        m_rx_crc_calc = m_bsp_rx_crc;
+        m_rx_state = S::ST_RECV_CRC;
+        break;
+
+      case S::ST_RECV_CRC:
+        if(!frame_rx_field(CRC_LENGTH))
+          return;
+        m_rx_crc_mismatch = bsp_rx_data(CRC_LENGTH) != m_rx_crc_calc;
+        m_rx_state = S::ST_RECV_CRC_DELIM;
+        break;
+
+      case S::ST_RECV_CRC_DELIM:
+        if(!frame_rx_field(1))
+          return;
+        if(bsp_rx_data(1) != 1) {
+          m_rx_form_error = true;
+          m_rx_state = S::ST_ERROR;
+        } else {
+          if(!m_rx_crc_mismatch && !m_rx_tx_arb_won)
+            bsp_tx_send_ack();
+          m_rx_state = S::ST_SEND_RECV_ACK;
+        }
+        break;
+
+      case S::ST_SEND_RECV_ACK:
+        if(!frame_rx_field(1))
+          return;
+        if(!m_rx_crc_mismatch && bsp_rx_data(1) != 0 && !m_rx_tx_arb_won) {
+          // ACK was sent, but not read back
+          m_rx_tx_bit_error = true;
+          m_rx_state = S::ST_ERROR;
+        } else {
+          m_rx_state = S::ST_RECV_ACK_DELIM;
+        }
+        break;
+
+      case S::ST_RECV_ACK_DELIM:
+        if(!frame_rx_field(1))
+          return;
+        if(m_rx_crc_mismatch) {
+          m_rx_crc_error = true;
+          m_rx_state = S::ST_ERROR;
+        } else if(bsp_rx_data(1) != 1 && !m_rx_tx_arb_won) {
+          m_rx_form_error = true;
+          m_rx_state = S::ST_ERROR;
+        } else {
+          m_rx_state = S::ST_RECV_EOF;
+        }
+        break;
+
+      case S::ST_RECV_EOF:
+        if(bsp_rx_data_count() != EOF_LENGTH-1)
+          return;
+        bsp_rx_clear();
+        m_rx_state = S::ST_DONE;
+        break;
+
+      case S::ST_ERROR:
+        if(!m_rx_tx_arb_won) {
+          bsp_tx_send_error_flag();
+
+          if(m_rx_tx_bit_error)
+            eml_tx_bit_error();
+          if(m_rx_stuff_error) {
+            eml_rec_increase(REC_ERROR_INCREASE);
+            m_events |= EVENT_RX_STUFF_ERROR;
+            m_counters.rx_stuff_error++;
+          } else if(m_rx_crc_error) {
+            eml_rec_increase(REC_ERROR_INCREASE);
+            m_events |= EVENT_RX_CRC_ERROR;
+            m_counters.rx_crc_error++;
+          } else if(m_rx_form_error) {
+            eml_rec_increase(REC_ERROR_INCREASE);
+            m_events |= EVENT_RX_FORM_ERROR;
+            m_counters.rx_form_error++;
+          }
+          m_rx_state = S::ST_WAIT_ERROR_FLAG;
+        } else {
+          m_rx_state = S::ST_WAIT_BUS_IDLE;
+        }
+        m_rx_tx_bit_error = false;
+        m_rx_stuff_error = false;
+        m_rx_crc_error = false;
+        m_rx_form_error = false;
+        break;
+
+      case S::ST_WAIT_ERROR_FLAG:
+        // Waits for pulses from the BSP in the next bits
+        return;
+
+      case S::ST_DONE:
+        if(!m_rx_tx_arb_won) {
+          eml_rx_success();
+          m_events |= EVENT_RX_MSG_VALID;
+          m_counters.rx_msg_recv++;
+        }
+        bsp_rx_stop();
+        m_rx_state = S::ST_WAIT_BUS_IDLE;
+        break;
+
+      case S::ST_WAIT_BUS_IDLE:
+        if(bsp_rx_active() || bsp_rx_ifs())
+          return;
+        m_rx_state = S::ST_IDLE;
+        break;
+
+      default:
+        // RTL: when others, an illegal state encoding after an upset
+        m_rx_state = S::ST_IDLE;
+        break;
+      }
+    }
+  }
+
+  // Configuration and Tx inputs
+  unsigned int m_retransmit_count_max;
+  bool m_tx_retransmit_en = false;
+  bool m_tx_msg_reload = false;
+  bool m_tx_abort = false;
+  CanMsg m_tx_msg_in;
+
+  // BTL
+  bool m_btl_rx_synced;
+  bool m_btl_prev_bit;
+
+  // BSP Rx
+  BspRxState m_bsp_rx_state;
+  uint64_t m_bsp_rx_data;
+  unsigned int m_bsp_rx_data_count;
+  uint8_t m_bsp_rx_window;
+  uint16_t m_bsp_rx_crc;
+  bool m_bsp_rx_stop_reg;
+  bool m_bsp_rx_start_of_frame;
+  bool m_bsp_rx_overflow;
+  bool m_bsp_rx_active_error_flag;
+  bool m_bsp_rx_passive_error_flag;
+  bool m_bsp_rx_destuff_en;
+
+  // BSP Tx
+  BspTxState m_bsp_tx_state;
+  bool m_bsp_tx_active;
+  uint64_t m_bsp_tx_data;
+  unsigned int m_bsp_tx_data_count;
+  unsigned int m_bsp_tx_write_counter;
+  bool m_bsp_tx_bit;
+  uint8_t m_bsp_tx_window;
+  uint16_t m_bsp_tx_crc;
+  uint8_t m_bsp_tx_error_flag_shift_reg;
+  bool m_bsp_tx_send_ack;
+  bool m_bsp_tx_send_error_flag;
+  bool m_bsp_tx_frame_started;
+  bool m_bsp_tx_stuff_bit;
+  bool m_bsp_tx_done;
+  bool m_bsp_tx_rx_mismatch;
+  bool m_bsp_tx_rx_stuff_mismatch;
+  bool m_bsp_error_flag_done;
+  bool m_bsp_active_error_flag_bit_error;
+
+  // EML
+  uint16_t m_recessive_shift_reg;
+  unsigned int m_recessive_bit_count;
+  unsigned int m_tec;
+  unsigned int m_rec;
+
+  // Frame Tx FSM
+  FrameTxState m_tx_state;
+  bool m_tx_busy;
+  unsigned int m_tx_retransmit_attempts;
+  ErrorState m_tx_eml_error_state;
+  bool m_tx_active_error_flag_bit_error;
+  CanMsg m_tx_msg;
+
+  // Frame Rx FSM
+  FrameRxState m_rx_state;
+  ErrorState m_rx_eml_error_state;
+  uint16_t m_rx_crc_calc;
+  bool m_rx_crc_mismatch;
+  bool m_rx_tx_arb_won;
+  bool m_rx_active_error_flag_bit_error;
+  bool m_rx_srr_rtr_bit = false;
+  bool m_rx_tx_bit_error;
+  bool m_rx_crc_error;
+  bool m_rx_form_error;
+  bool m_rx_stuff_error;
+  CanMsg m_rx_msg;
+
+  uint32_t m_events;
+  Counters m_counters;
+};
+
+/**
+ * Nodes connected to the same CAN bus. An external driver (e.g. a bus
+ * functional model in a test, or a fault injector) can drive the bus too.
+ */
+class Bus
+{
+public:
+  void attach(Node& node) { m_nodes.push_back(&node); }
+
+  /**
+   * Run one bit, returns the bit value on the bus
+   */
+  bool step(bool ext_tx_bit = true)
+  {
+    bool bit = ext_tx_bit;
+
+    for(const Node* node : m_nodes)
+      bit = bit && node->tx_bit();
+
+    for(Node* node : m_nodes)
+      node->rx_bit(bit);
+
+    m_bit_count++;
+    return bit;
+  }
+
+  uint64_t bit_count() const { return m_bit_count; }
+
+private:
+  std::vector<Node*> m_nodes;
+  uint64_t m_bit_count = 0;
+};
+
+} // namespace model
+} // namespace canola
+
+#endif
@@ -0,0 +1,1017 @@
+/**
+ * @file   canola_regs.hpp
+ * @brief  Compile-time typed register and field accessors for canola_axi_slave.
+ *
+ *         Generated by source/scripts/gen_canola_regs.py from
+ *         source/json/canola.json - DO NOT EDIT.
+ */
+
+#ifndef CANOLA_REGS_HPP
+#define CANOLA_REGS_HPP
+
+#include <cstdint>
+
+namespace canola
+{
+namespace reg
+{
+
+enum class Access { RO, RW, PULSE };
+
+template <uint32_t Offset, uint32_t Width>
+struct Field {
+  static_assert(Width >= 1 && Width <= 32, "Field width out of range");
+  static_assert(Offset + Width <= 32, "Field does not fit in 32-bit register");
+
+  static constexpr uint32_t offset = Offset;
+  static constexpr uint32_t width  = Width;
+  static constexpr uint32_t mask   = uint32_t((uint64_t(1) << Width) - 1) << Offset;
+
+  // Extract field value from register value
+  static constexpr uint32_t get(uint32_t reg) { return (reg & mask) >> Offset; }
+
+  // Register value with only this field set to value
+  static constexpr uint32_t set(uint32_t value) { return (value << Offset) & mask; }
+
+  // Replace this field in register value
+  static constexpr uint32_t insert(uint32_t reg, uint32_t value) { return (reg & ~mask) | set(value); }
+};
+
+namespace detail
+{
+constexpr uint32_t mask_or() { return 0; }
+
+template <typename F, typename... Fs>
+constexpr uint32_t mask_or(F, Fs... fs) { return F::mask | mask_or(fs...); }
+
+constexpr bool disjoint(uint32_t) { return true; }
+
+template <typename F, typename... Fs>
+constexpr bool disjoint(uint32_t used, F, Fs... fs) {
+  return (used & F::mask) == 0 && disjoint(used | F::mask, fs...);
+}
+} // namespace detail
+
+template <uint32_t Address, uint32_t Reset, Access Mode, typename... Fields>
+struct Register {
+  static_assert(Address % 4 == 0, "Register address is not 32-bit aligned");
+  static_assert(detail::disjoint(0, Fields()...), "Register has overlapping fields");
+  static_assert((Reset & ~detail::mask_or(Fields()...)) == 0, "Reset value outside of fields");
+
+  static constexpr uint32_t address  = Address;
+  static constexpr uint32_t reset    = Reset;
+  static constexpr uint32_t mask     = detail::mask_or(Fields()...);
+  static constexpr Access   access   = Mode;
+  static constexpr bool     readable = Mode != Access::PULSE;
+  static constexpr bool     writable = Mode != Access::RO;
+};
+
+namespace detail
+{
+constexpr bool unique_addresses(const uint32_t* addr, unsigned int n)
+{
+  for(unsigned int i = 0; i < n; i++)
+    for(unsigned int j = i+1; j < n; j++)
+      if(addr[i] == addr[j])
+        return false;
+  return true;
+}
+} // namespace detail
+
+/* Register: STATUS (RO) - Status register */
+struct STATUS : Register<0x0, 0x0, Access::RO, Field<0, 1>, Field<1, 1>, Field<2, 1>, Field<3, 1>, Field<4, 2>> {
+  using RX_MSG_VALID = Field<0, 1>;
+  using TX_BUSY = Field<1, 1>;
+  using TX_DONE = Field<2, 1>;
+  using TX_FAILED = Field<3, 1>;
+  using ERROR_STATE = Field<4, 2>;
+
+  struct Value {
+    uint32_t RX_MSG_VALID;
+    uint32_t TX_BUSY;
+    uint32_t TX_DONE;
+    uint32_t TX_FAILED;
+    uint32_t ERROR_STATE;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return RX_MSG_VALID::set(v.RX_MSG_VALID) |
+      TX_BUSY::set(v.TX_BUSY) |
+      TX_DONE::set(v.TX_DONE) |
+      TX_FAILED::set(v.TX_FAILED) |
+      ERROR_STATE::set(v.ERROR_STATE);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{RX_MSG_VALID::get(reg), TX_BUSY::get(reg), TX_DONE::get(reg), TX_FAILED::get(reg), ERROR_STATE::get(reg)};
+  }
+};
+
+/* Register: CONTROL (PULSE) - Control register */
+struct CONTROL : Register<0x4, 0x0, Access::PULSE, Field<0, 1>, Field<1, 1>, Field<2, 1>, Field<3, 1>, Field<4, 1>, Field<5, 1>, Field<6, 1>, Field<7, 1>, Field<8, 1>, Field<9, 1>, Field<10, 1>, Field<11, 1>, Field<12, 1>, Field<13, 1>, Field<14, 1>, Field<15, 1>> {
+  using TX_START = Field<0, 1>;
+  using RESET_TX_MSG_SENT_COUNTER = Field<1, 1>;
+  using RESET_TX_FAILED_COUNTER = Field<2, 1>;
+  using RESET_TX_ACK_ERROR_COUNTER = Field<3, 1>;
+  using RESET_TX_ARB_LOST_COUNTER = Field<4, 1>;
+  using RESET_TX_BIT_ERROR_COUNTER = Field<5, 1>;
+  using RESET_TX_RETRANSMIT_COUNTER = Field<6, 1>;
+  using RESET_RX_MSG_RECV_COUNTER = Field<7, 1>;
+  using RESET_RX_CRC_ERROR_COUNTER = Field<8, 1>;
+  using RESET_RX_FORM_ERROR_COUNTER = Field<9, 1>;
+  using RESET_RX_STUFF_ERROR_COUNTER = Field<10, 1>;
+  using FILTER_WRITE = Field<11, 1>;
+  using RX_FIFO_POP = Field<12, 1>;
+  using RX_FIFO_FLUSH = Field<13, 1>;
+  using RX_FIFO_CLEAR_OVERFLOW = Field<14, 1>;
+  using TX_MAILBOX_LOAD = Field<15, 1>;
+
+  struct Value {
+    uint32_t TX_START;
+    uint32_t RESET_TX_MSG_SENT_COUNTER;
+    uint32_t RESET_TX_FAILED_COUNTER;
+    uint32_t RESET_TX_ACK_ERROR_COUNTER;
+    uint32_t RESET_TX_ARB_LOST_COUNTER;
+    uint32_t RESET_TX_BIT_ERROR_COUNTER;
+    uint32_t RESET_TX_RETRANSMIT_COUNTER;
+    uint32_t RESET_RX_MSG_RECV_COUNTER;
+    uint32_t RESET_RX_CRC_ERROR_COUNTER;
+    uint32_t RESET_RX_FORM_ERROR_COUNTER;
+    uint32_t RESET_RX_STUFF_ERROR_COUNTER;
+    uint32_t FILTER_WRITE;
+    uint32_t RX_FIFO_POP;
+    uint32_t RX_FIFO_FLUSH;
+    uint32_t RX_FIFO_CLEAR_OVERFLOW;
+    uint32_t TX_MAILBOX_LOAD;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return TX_START::set(v.TX_START) |
+      RESET_TX_MSG_SENT_COUNTER::set(v.RESET_TX_MSG_SENT_COUNTER) |
+      RESET_TX_FAILED_COUNTER::set(v.RESET_TX_FAILED_COUNTER) |
+      RESET_TX_ACK_ERROR_COUNTER::set(v.RESET_TX_ACK_ERROR_COUNTER) |
+      RESET_TX_ARB_LOST_COUNTER::set(v.RESET_TX_ARB_LOST_COUNTER) |
+      RESET_TX_BIT_ERROR_COUNTER::set(v.RESET_TX_BIT_ERROR_COUNTER) |
+      RESET_TX_RETRANSMIT_COUNTER::set(v.RESET_TX_RETRANSMIT_COUNTER) |
+      RESET_RX_MSG_RECV_COUNTER::set(v.RESET_RX_MSG_RECV_COUNTER) |
+      RESET_RX_CRC_ERROR_COUNTER::set(v.RESET_RX_CRC_ERROR_COUNTER) |
+      RESET_RX_FORM_ERROR_COUNTER::set(v.RESET_RX_FORM_ERROR_COUNTER) |
+      RESET_RX_STUFF_ERROR_COUNTER::set(v.RESET_RX_STUFF_ERROR_COUNTER) |
+      FILTER_WRITE::set(v.FILTER_WRITE) |
+      RX_FIFO_POP::set(v.RX_FIFO_POP) |
+      RX_FIFO_FLUSH::set(v.RX_FIFO_FLUSH) |
+      RX_FIFO_CLEAR_OVERFLOW::set(v.RX_FIFO_CLEAR_OVERFLOW) |
+      TX_MAILBOX_LOAD::set(v.TX_MAILBOX_LOAD);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{TX_START::get(reg), RESET_TX_MSG_SENT_COUNTER::get(reg), RESET_TX_FAILED_COUNTER::get(reg), RESET_TX_ACK_ERROR_COUNTER::get(reg), RESET_TX_ARB_LOST_COUNTER::get(reg), RESET_TX_BIT_ERROR_COUNTER::get(reg), RESET_TX_RETRANSMIT_COUNTER::get(reg), RESET_RX_MSG_RECV_COUNTER::get(reg), RESET_RX_CRC_ERROR_COUNTER::get(reg), RESET_RX_FORM_ERROR_COUNTER::get(reg), RESET_RX_STUFF_ERROR_COUNTER::get(reg), FILTER_WRITE::get(reg), RX_FIFO_POP::get(reg), RX_FIFO_FLUSH::get(reg), RX_FIFO_CLEAR_OVERFLOW::get(reg), TX_MAILBOX_LOAD::get(reg)};
+  }
+};
+
+/* Register: CONFIG (RW) - Configuration register */
+struct CONFIG : Register<0x8, 0x0, Access::RW, Field<0, 1>, Field<1, 1>, Field<2, 1>, Field<3, 1>, Field<4, 1>> {
+  using TX_RETRANSMIT_EN = Field<0, 1>;
+  using BTL_TRIPLE_SAMPLING_EN = Field<1, 1>;
+  using ACCEPTANCE_FILTER_EN = Field<2, 1>;
+  using RX_FIFO_EN = Field<3, 1>;
+  using TX_MAILBOX_EN = Field<4, 1>;
+
+  struct Value {
+    uint32_t TX_RETRANSMIT_EN;
+    uint32_t BTL_TRIPLE_SAMPLING_EN;
+    uint32_t ACCEPTANCE_FILTER_EN;
+    uint32_t RX_FIFO_EN;
+    uint32_t TX_MAILBOX_EN;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return TX_RETRANSMIT_EN::set(v.TX_RETRANSMIT_EN) |
+      BTL_TRIPLE_SAMPLING_EN::set(v.BTL_TRIPLE_SAMPLING_EN) |
+      ACCEPTANCE_FILTER_EN::set(v.ACCEPTANCE_FILTER_EN) |
+      RX_FIFO_EN::set(v.RX_FIFO_EN) |
+      TX_MAILBOX_EN::set(v.TX_MAILBOX_EN);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{TX_RETRANSMIT_EN::get(reg), BTL_TRIPLE_SAMPLING_EN::get(reg), ACCEPTANCE_FILTER_EN::get(reg), RX_FIFO_EN::get(reg), TX_MAILBOX_EN::get(reg)};
+  }
+};
+
+/* Register: BTL_PROP_SEG (RW) - Propagation bit timing segment */
+struct BTL_PROP_SEG : Register<0x20, 0x7, Access::RW, Field<0, 16>> {
+  using VALUE = Field<0, 16>;
+
+  struct Value {
+    uint32_t VALUE;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return VALUE::set(v.VALUE);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{VALUE::get(reg)};
+  }
+};
+
+/* Register: BTL_PHASE_SEG1 (RW) - Phase 1 bit timing segment */
+struct BTL_PHASE_SEG1 : Register<0x24, 0x7, Access::RW, Field<0, 16>> {
+  using VALUE = Field<0, 16>;
+
+  struct Value {
+    uint32_t VALUE;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return VALUE::set(v.VALUE);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{VALUE::get(reg)};
+  }
+};
+
+/* Register: BTL_PHASE_SEG2 (RW) - Phase segment 2 of bit timing */
+struct BTL_PHASE_SEG2 : Register<0x28, 0x7, Access::RW, Field<0, 16>> {
+  using VALUE = Field<0, 16>;
+
+  struct Value {
+    uint32_t VALUE;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return VALUE::set(v.VALUE);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{VALUE::get(reg)};
+  }
+};
+
+/* Register: BTL_SYNC_JUMP_WIDTH (RW) - Synchronization jump width */
+struct BTL_SYNC_JUMP_WIDTH : Register<0x2c, 0x1, Access::RW, Field<0, 3>> {
+  using VALUE = Field<0, 3>;
+
+  struct Value {
+    uint32_t VALUE;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return VALUE::set(v.VALUE);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{VALUE::get(reg)};
+  }
+};
+
+/* Register: TIME_QUANTA_CLOCK_SCALE (RW) - Clock prescale ratio for time quanta generator */
+struct TIME_QUANTA_CLOCK_SCALE : Register<0x30, 0xf, Access::RW, Field<0, 8>> {
+  using VALUE = Field<0, 8>;
+
+  struct Value {
+    uint32_t VALUE;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return VALUE::set(v.VALUE);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{VALUE::get(reg)};
+  }
+};
+
+/* Register: TRANSMIT_ERROR_COUNT (RO) - Transmit Error Counter (TEC) of Error Management Logic (EML) */
+struct TRANSMIT_ERROR_COUNT : Register<0x34, 0x0, Access::RO, Field<0, 16>> {
+  using VALUE = Field<0, 16>;
+
+  struct Value {
+    uint32_t VALUE;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return VALUE::set(v.VALUE);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{VALUE::get(reg)};
+  }
+};
+
+/* Register: RECEIVE_ERROR_COUNT (RO) - Receive Error Counter (REC) of Error Management Logic (EML) */
+struct RECEIVE_ERROR_COUNT : Register<0x38, 0x0, Access::RO, Field<0, 16>> {
+  using VALUE = Field<0, 16>;
+
+  struct Value {
+    uint32_t VALUE;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return VALUE::set(v.VALUE);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{VALUE::get(reg)};
+  }
+};
+
+/* Register: TX_MSG_SENT_COUNT (RO) - Number of successfully transmitted messages */
+struct TX_MSG_SENT_COUNT : Register<0x3c, 0x0, Access::RO, Field<0, 32>> {
+  using VALUE = Field<0, 32>;
+
+  struct Value {
+    uint32_t VALUE;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return VALUE::set(v.VALUE);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{VALUE::get(reg)};
+  }
+};
+
+/* Register: TX_FAILED_COUNT (RO) - Number of successfully transmitted messages */
+struct TX_FAILED_COUNT : Register<0x40, 0x0, Access::RO, Field<0, 32>> {
+  using VALUE = Field<0, 32>;
+
+  struct Value {
+    uint32_t VALUE;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return VALUE::set(v.VALUE);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{VALUE::get(reg)};
+  }
+};
+
+/* Register: TX_ACK_ERROR_COUNT (RO) - Number of transmitted messages where ACK was missing */
+struct TX_ACK_ERROR_COUNT : Register<0x44, 0x0, Access::RO, Field<0, 32>> {
+  using VALUE = Field<0, 32>;
+
+  struct Value {
+    uint32_t VALUE;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return VALUE::set(v.VALUE);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{VALUE::get(reg)};
+  }
+};
+
+/* Register: TX_ARB_LOST_COUNT (RO) - Number of times arbitration was lost while attempting to send message */
+struct TX_ARB_LOST_COUNT : Register<0x48, 0x0, Access::RO, Field<0, 32>> {
+  using VALUE = Field<0, 32>;
+
+  struct Value {
+    uint32_t VALUE;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return VALUE::set(v.VALUE);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{VALUE::get(reg)};
+  }
+};
+
+/* Register: TX_BIT_ERROR_COUNT (RO) - Number of transmit bit errors (read-back bit didn't match transmitted bit) */
+struct TX_BIT_ERROR_COUNT : Register<0x4c, 0x0, Access::RO, Field<0, 32>> {
+  using VALUE = Field<0, 32>;
+
+  struct Value {
+    uint32_t VALUE;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return VALUE::set(v.VALUE);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{VALUE::get(reg)};
+  }
+};
+
+/* Register: TX_RETRANSMIT_COUNT (RO) - Number attempts at retransmitting messages that failed to send. */
+struct TX_RETRANSMIT_COUNT : Register<0x50, 0x0, Access::RO, Field<0, 32>> {
+  using VALUE = Field<0, 32>;
+
+  struct Value {
+    uint32_t VALUE;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return VALUE::set(v.VALUE);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{VALUE::get(reg)};
+  }
+};
+
+/* Register: RX_MSG_RECV_COUNT (RO) - Number of messages that were successfully received */
+struct RX_MSG_RECV_COUNT : Register<0x54, 0x0, Access::RO, Field<0, 32>> {
+  using VALUE = Field<0, 32>;
+
+  struct Value {
+    uint32_t VALUE;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return VALUE::set(v.VALUE);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{VALUE::get(reg)};
+  }
+};
+
+/* Register: RX_CRC_ERROR_COUNT (RO) - Number of received messages with CRC error */
+struct RX_CRC_ERROR_COUNT : Register<0x58, 0x0, Access::RO, Field<0, 32>> {
+  using VALUE = Field<0, 32>;
+
+  struct Value {
+    uint32_t VALUE;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return VALUE::set(v.VALUE);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{VALUE::get(reg)};
+  }
+};
+
+/* Register: RX_FORM_ERROR_COUNT (RO) - Number of received messages with form error */
+struct RX_FORM_ERROR_COUNT : Register<0x5c, 0x0, Access::RO, Field<0, 32>> {
+  using VALUE = Field<0, 32>;
+
+  struct Value {
+    uint32_t VALUE;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return VALUE::set(v.VALUE);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{VALUE::get(reg)};
+  }
+};
+
+/* Register: RX_STUFF_ERROR_COUNT (RO) - Number of received messages with stuff error */
+struct RX_STUFF_ERROR_COUNT : Register<0x60, 0x0, Access::RO, Field<0, 32>> {
+  using VALUE = Field<0, 32>;
+
+  struct Value {
+    uint32_t VALUE;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return VALUE::set(v.VALUE);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{VALUE::get(reg)};
+  }
+};
+
+/* Register: TX_MSG_ID (RW) - Number of received messages with stuff error */
+struct TX_MSG_ID : Register<0x64, 0x0, Access::RW, Field<0, 1>, Field<1, 1>, Field<2, 18>, Field<20, 11>> {
+  using EXT_ID_EN = Field<0, 1>;
+  using RTR_EN = Field<1, 1>;
+  using ARB_ID_B = Field<2, 18>;
+  using ARB_ID_A = Field<20, 11>;
+
+  struct Value {
+    uint32_t EXT_ID_EN;
+    uint32_t RTR_EN;
+    uint32_t ARB_ID_B;
+    uint32_t ARB_ID_A;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return EXT_ID_EN::set(v.EXT_ID_EN) |
+      RTR_EN::set(v.RTR_EN) |
+      ARB_ID_B::set(v.ARB_ID_B) |
+      ARB_ID_A::set(v.ARB_ID_A);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{EXT_ID_EN::get(reg), RTR_EN::get(reg), ARB_ID_B::get(reg), ARB_ID_A::get(reg)};
+  }
+};
+
+/* Register: TX_PAYLOAD_LENGTH (RW) - Transmit payload length */
+struct TX_PAYLOAD_LENGTH : Register<0x68, 0x0, Access::RW, Field<0, 4>> {
+  using VALUE = Field<0, 4>;
+
+  struct Value {
+    uint32_t VALUE;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return VALUE::set(v.VALUE);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{VALUE::get(reg)};
+  }
+};
+
+/* Register: TX_PAYLOAD_0 (RW) - Tx payload bytes 0 to 3 */
+struct TX_PAYLOAD_0 : Register<0x6c, 0x0, Access::RW, Field<0, 8>, Field<8, 8>, Field<16, 8>, Field<24, 8>> {
+  using PAYLOAD_BYTE_0 = Field<0, 8>;
+  using PAYLOAD_BYTE_1 = Field<8, 8>;
+  using PAYLOAD_BYTE_2 = Field<16, 8>;
+  using PAYLOAD_BYTE_3 = Field<24, 8>;
+
+  struct Value {
+    uint32_t PAYLOAD_BYTE_0;
+    uint32_t PAYLOAD_BYTE_1;
+    uint32_t PAYLOAD_BYTE_2;
+    uint32_t PAYLOAD_BYTE_3;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return PAYLOAD_BYTE_0::set(v.PAYLOAD_BYTE_0) |
+      PAYLOAD_BYTE_1::set(v.PAYLOAD_BYTE_1) |
+      PAYLOAD_BYTE_2::set(v.PAYLOAD_BYTE_2) |
+      PAYLOAD_BYTE_3::set(v.PAYLOAD_BYTE_3);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{PAYLOAD_BYTE_0::get(reg), PAYLOAD_BYTE_1::get(reg), PAYLOAD_BYTE_2::get(reg), PAYLOAD_BYTE_3::get(reg)};
+  }
+};
+
+/* Register: TX_PAYLOAD_1 (RW) - Tx payload bytes 4 to 7 */
+struct TX_PAYLOAD_1 : Register<0x70, 0x0, Access::RW, Field<0, 8>, Field<8, 8>, Field<16, 8>, Field<24, 8>> {
+  using PAYLOAD_BYTE_4 = Field<0, 8>;
+  using PAYLOAD_BYTE_5 = Field<8, 8>;
+  using PAYLOAD_BYTE_6 = Field<16, 8>;
+  using PAYLOAD_BYTE_7 = Field<24, 8>;
+
+  struct Value {
+    uint32_t PAYLOAD_BYTE_4;
+    uint32_t PAYLOAD_BYTE_5;
+    uint32_t PAYLOAD_BYTE_6;
+    uint32_t PAYLOAD_BYTE_7;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return PAYLOAD_BYTE_4::set(v.PAYLOAD_BYTE_4) |
+      PAYLOAD_BYTE_5::set(v.PAYLOAD_BYTE_5) |
+      PAYLOAD_BYTE_6::set(v.PAYLOAD_BYTE_6) |
+      PAYLOAD_BYTE_7::set(v.PAYLOAD_BYTE_7);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{PAYLOAD_BYTE_4::get(reg), PAYLOAD_BYTE_5::get(reg), PAYLOAD_BYTE_6::get(reg), PAYLOAD_BYTE_7::get(reg)};
+  }
+};
+
+/* Register: RX_MSG_ID (RO) - Number of received messages with stuff error */
+struct RX_MSG_ID : Register<0x74, 0x0, Access::RO, Field<0, 1>, Field<1, 1>, Field<2, 18>, Field<20, 11>> {
+  using EXT_ID_EN = Field<0, 1>;
+  using RTR_EN = Field<1, 1>;
+  using ARB_ID_B = Field<2, 18>;
+  using ARB_ID_A = Field<20, 11>;
+
+  struct Value {
+    uint32_t EXT_ID_EN;
+    uint32_t RTR_EN;
+    uint32_t ARB_ID_B;
+    uint32_t ARB_ID_A;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return EXT_ID_EN::set(v.EXT_ID_EN) |
+      RTR_EN::set(v.RTR_EN) |
+      ARB_ID_B::set(v.ARB_ID_B) |
+      ARB_ID_A::set(v.ARB_ID_A);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{EXT_ID_EN::get(reg), RTR_EN::get(reg), ARB_ID_B::get(reg), ARB_ID_A::get(reg)};
+  }
+};
+
+/* Register: RX_PAYLOAD_LENGTH (RO) - Received payload length */
+struct RX_PAYLOAD_LENGTH : Register<0x78, 0x0, Access::RO, Field<0, 4>> {
+  using VALUE = Field<0, 4>;
+
+  struct Value {
+    uint32_t VALUE;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return VALUE::set(v.VALUE);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{VALUE::get(reg)};
+  }
+};
+
+/* Register: RX_PAYLOAD_0 (RO) - Rx payload bytes 0 to 3 */
+struct RX_PAYLOAD_0 : Register<0x7c, 0x0, Access::RO, Field<0, 8>, Field<8, 8>, Field<16, 8>, Field<24, 8>> {
+  using PAYLOAD_BYTE_0 = Field<0, 8>;
+  using PAYLOAD_BYTE_1 = Field<8, 8>;
+  using PAYLOAD_BYTE_2 = Field<16, 8>;
+  using PAYLOAD_BYTE_3 = Field<24, 8>;
+
+  struct Value {
+    uint32_t PAYLOAD_BYTE_0;
+    uint32_t PAYLOAD_BYTE_1;
+    uint32_t PAYLOAD_BYTE_2;
+    uint32_t PAYLOAD_BYTE_3;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return PAYLOAD_BYTE_0::set(v.PAYLOAD_BYTE_0) |
+      PAYLOAD_BYTE_1::set(v.PAYLOAD_BYTE_1) |
+      PAYLOAD_BYTE_2::set(v.PAYLOAD_BYTE_2) |
+      PAYLOAD_BYTE_3::set(v.PAYLOAD_BYTE_3);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{PAYLOAD_BYTE_0::get(reg), PAYLOAD_BYTE_1::get(reg), PAYLOAD_BYTE_2::get(reg), PAYLOAD_BYTE_3::get(reg)};
+  }
+};
+
+/* Register: RX_PAYLOAD_1 (RO) - Rx payload bytes 4 to 7 */
+struct RX_PAYLOAD_1 : Register<0x80, 0x0, Access::RO, Field<0, 8>, Field<8, 8>, Field<16, 8>, Field<24, 8>> {
+  using PAYLOAD_BYTE_4 = Field<0, 8>;
+  using PAYLOAD_BYTE_5 = Field<8, 8>;
+  using PAYLOAD_BYTE_6 = Field<16, 8>;
+  using PAYLOAD_BYTE_7 = Field<24, 8>;
+
+  struct Value {
+    uint32_t PAYLOAD_BYTE_4;
+    uint32_t PAYLOAD_BYTE_5;
+    uint32_t PAYLOAD_BYTE_6;
+    uint32_t PAYLOAD_BYTE_7;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return PAYLOAD_BYTE_4::set(v.PAYLOAD_BYTE_4) |
+      PAYLOAD_BYTE_5::set(v.PAYLOAD_BYTE_5) |
+      PAYLOAD_BYTE_6::set(v.PAYLOAD_BYTE_6) |
+      PAYLOAD_BYTE_7::set(v.PAYLOAD_BYTE_7);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{PAYLOAD_BYTE_4::get(reg), PAYLOAD_BYTE_5::get(reg), PAYLOAD_BYTE_6::get(reg), PAYLOAD_BYTE_7::get(reg)};
+  }
+};
+
+/* Register: FILTER_INDEX (RW) - Acceptance filter to write with FILTER_WRITE */
+struct FILTER_INDEX : Register<0x84, 0x0, Access::RW, Field<0, 8>> {
+  using VALUE = Field<0, 8>;
+
+  struct Value {
+    uint32_t VALUE;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return VALUE::set(v.VALUE);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{VALUE::get(reg)};
+  }
+};
+
+/* Register: FILTER_ID (RW) - Acceptance filter ID */
+struct FILTER_ID : Register<0x88, 0x0, Access::RW, Field<0, 1>, Field<1, 1>, Field<2, 18>, Field<20, 11>, Field<31, 1>> {
+  using EXT_ID_EN = Field<0, 1>;
+  using RTR_EN = Field<1, 1>;
+  using ARB_ID_B = Field<2, 18>;
+  using ARB_ID_A = Field<20, 11>;
+  using ENABLE = Field<31, 1>;
+
+  struct Value {
+    uint32_t EXT_ID_EN;
+    uint32_t RTR_EN;
+    uint32_t ARB_ID_B;
+    uint32_t ARB_ID_A;
+    uint32_t ENABLE;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return EXT_ID_EN::set(v.EXT_ID_EN) |
+      RTR_EN::set(v.RTR_EN) |
+      ARB_ID_B::set(v.ARB_ID_B) |
+      ARB_ID_A::set(v.ARB_ID_A) |
+      ENABLE::set(v.ENABLE);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{EXT_ID_EN::get(reg), RTR_EN::get(reg), ARB_ID_B::get(reg), ARB_ID_A::get(reg), ENABLE::get(reg)};
+  }
+};
+
+/* Register: FILTER_MASK (RW) - Acceptance filter mask, set bits must match FILTER_ID */
+struct FILTER_MASK : Register<0x8c, 0x0, Access::RW, Field<0, 1>, Field<1, 1>, Field<2, 18>, Field<20, 11>> {
+  using EXT_ID_EN = Field<0, 1>;
+  using RTR_EN = Field<1, 1>;
+  using ARB_ID_B = Field<2, 18>;
+  using ARB_ID_A = Field<20, 11>;
+
+  struct Value {
+    uint32_t EXT_ID_EN;
+    uint32_t RTR_EN;
+    uint32_t ARB_ID_B;
+    uint32_t ARB_ID_A;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return EXT_ID_EN::set(v.EXT_ID_EN) |
+      RTR_EN::set(v.RTR_EN) |
+      ARB_ID_B::set(v.ARB_ID_B) |
+      ARB_ID_A::set(v.ARB_ID_A);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{EXT_ID_EN::get(reg), RTR_EN::get(reg), ARB_ID_B::get(reg), ARB_ID_A::get(reg)};
+  }
+};
+
+/* Register: RX_FILTER_HIT (RO) - Index of acceptance filter that matched the received message, zero when filtering is disabled */
+struct RX_FILTER_HIT : Register<0x90, 0x0, Access::RO, Field<0, 8>> {
+  using VALUE = Field<0, 8>;
+
+  struct Value {
+    uint32_t VALUE;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return VALUE::set(v.VALUE);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{VALUE::get(reg)};
+  }
+};
+
+/* Register: RX_FIFO_STATUS (RO) - Rx FIFO status register */
+struct RX_FIFO_STATUS : Register<0x94, 0x0, Access::RO, Field<0, 9>, Field<9, 1>, Field<10, 1>, Field<11, 1>> {
+  using FILL_LEVEL = Field<0, 9>;
+  using EMPTY = Field<9, 1>;
+  using FULL = Field<10, 1>;
+  using OVERFLOW = Field<11, 1>;
+
+  struct Value {
+    uint32_t FILL_LEVEL;
+    uint32_t EMPTY;
+    uint32_t FULL;
+    uint32_t OVERFLOW;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return FILL_LEVEL::set(v.FILL_LEVEL) |
+      EMPTY::set(v.EMPTY) |
+      FULL::set(v.FULL) |
+      OVERFLOW::set(v.OVERFLOW);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{FILL_LEVEL::get(reg), EMPTY::get(reg), FULL::get(reg), OVERFLOW::get(reg)};
+  }
+};
+
+/* Register: RX_FIFO_IRQ_LEVEL (RW) - The Rx valid interrupt is pulsed when a message is stored in the Rx FIFO and the fill level is at or above this value */
+struct RX_FIFO_IRQ_LEVEL : Register<0x98, 0x1, Access::RW, Field<0, 9>> {
+  using VALUE = Field<0, 9>;
+
+  struct Value {
+    uint32_t VALUE;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return VALUE::set(v.VALUE);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{VALUE::get(reg)};
+  }
+};
+
+/* Register: TX_MAILBOX_INDEX (RW) - Tx mailbox to write with TX_MAILBOX_LOAD */
+struct TX_MAILBOX_INDEX : Register<0x9c, 0x0, Access::RW, Field<0, 5>> {
+  using VALUE = Field<0, 5>;
+
+  struct Value {
+    uint32_t VALUE;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return VALUE::set(v.VALUE);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{VALUE::get(reg)};
+  }
+};
+
+/* Register: TX_MAILBOX_ABORT (PULSE) - Abort pending Tx mailboxes (one bit per mailbox). Aborted mailboxes are reported as failed */
+struct TX_MAILBOX_ABORT : Register<0xa0, 0x0, Access::PULSE, Field<0, 32>> {
+  using VALUE = Field<0, 32>;
+
+  struct Value {
+    uint32_t VALUE;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return VALUE::set(v.VALUE);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{VALUE::get(reg)};
+  }
+};
+
+/* Register: TX_MAILBOX_PENDING (RO) - Tx mailboxes waiting to be sent (one bit per mailbox) */
+struct TX_MAILBOX_PENDING : Register<0xa4, 0x0, Access::RO, Field<0, 32>> {
+  using VALUE = Field<0, 32>;
+
+  struct Value {
+    uint32_t VALUE;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return VALUE::set(v.VALUE);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{VALUE::get(reg)};
+  }
+};
+
+/* Register: TX_MAILBOX_DONE (RO) - Tx mailboxes that were sent successfully. Cleared when the mailbox is loaded */
+struct TX_MAILBOX_DONE : Register<0xa8, 0x0, Access::RO, Field<0, 32>> {
+  using VALUE = Field<0, 32>;
+
+  struct Value {
+    uint32_t VALUE;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return VALUE::set(v.VALUE);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{VALUE::get(reg)};
+  }
+};
+
+/* Register: TX_MAILBOX_FAILED (RO) - Tx mailboxes that failed to send or were aborted. Cleared when the mailbox is loaded */
+struct TX_MAILBOX_FAILED : Register<0xac, 0x0, Access::RO, Field<0, 32>> {
+  using VALUE = Field<0, 32>;
+
+  struct Value {
+    uint32_t VALUE;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return VALUE::set(v.VALUE);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{VALUE::get(reg)};
+  }
+};
+
+/* Register: TX_MAILBOX_COUNT (RO) - Number of Tx mailboxes in the controller */
+struct TX_MAILBOX_COUNT : Register<0xb0, 0x0, Access::RO, Field<0, 6>> {
+  using VALUE = Field<0, 6>;
+
+  struct Value {
+    uint32_t VALUE;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return VALUE::set(v.VALUE);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{VALUE::get(reg)};
+  }
+};
+
+/* Register: TIMESTAMP (RO) - Free-running timestamp counter, counts clock cycles and wraps around */
+struct TIMESTAMP : Register<0xb4, 0x0, Access::RO, Field<0, 32>> {
+  using VALUE = Field<0, 32>;
+
+  struct Value {
+    uint32_t VALUE;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return VALUE::set(v.VALUE);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{VALUE::get(reg)};
+  }
+};
+
+/* Register: RX_TIMESTAMP (RO) - Value of TIMESTAMP when the received message was accepted, at the end of frame (with RX_MSG_VALID). Stored with the message in the Rx FIFO */
+struct RX_TIMESTAMP : Register<0xb8, 0x0, Access::RO, Field<0, 32>> {
+  using VALUE = Field<0, 32>;
+
+  struct Value {
+    uint32_t VALUE;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return VALUE::set(v.VALUE);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{VALUE::get(reg)};
+  }
+};
+
+/* Register: TX_TIMESTAMP (RO) - Value of TIMESTAMP when the last transmitted message was done, at the end of frame (with TX_DONE) */
+struct TX_TIMESTAMP : Register<0xbc, 0x0, Access::RO, Field<0, 32>> {
+  using VALUE = Field<0, 32>;
+
+  struct Value {
+    uint32_t VALUE;
+  };
+
+  static constexpr uint32_t pack(const Value& v) {
+    return VALUE::set(v.VALUE);
+  }
+
+  static constexpr Value unpack(uint32_t reg) {
+    return Value{VALUE::get(reg)};
+  }
+};
+
+constexpr uint32_t ALL_ADDRESSES[] = {
+  STATUS::address,
+  CONTROL::address,
+  CONFIG::address,
+  BTL_PROP_SEG::address,
+  BTL_PHASE_SEG1::address,
+  BTL_PHASE_SEG2::address,
+  BTL_SYNC_JUMP_WIDTH::address,
+  TIME_QUANTA_CLOCK_SCALE::address,
+  TRANSMIT_ERROR_COUNT::address,
+  RECEIVE_ERROR_COUNT::address,
+  TX_MSG_SENT_COUNT::address,
+  TX_FAILED_COUNT::address,
+  TX_ACK_ERROR_COUNT::address,
+  TX_ARB_LOST_COUNT::address,
+  TX_BIT_ERROR_COUNT::address,
+  TX_RETRANSMIT_COUNT::address,
+  RX_MSG_RECV_COUNT::address,
+  RX_CRC_ERROR_COUNT::address,
+  RX_FORM_ERROR_COUNT::address,
+  RX_STUFF_ERROR_COUNT::address,
+  TX_MSG_ID::address,
+  TX_PAYLOAD_LENGTH::address,
+  TX_PAYLOAD_0::address,
+  TX_PAYLOAD_1::address,
+  RX_MSG_ID::address,
+  RX_PAYLOAD_LENGTH::address,
+  RX_PAYLOAD_0::address,
+  RX_PAYLOAD_1::address,
+  FILTER_INDEX::address,
+  FILTER_ID::address,
+  FILTER_MASK::address,
+  RX_FILTER_HIT::address,
+  RX_FIFO_STATUS::address,
+  RX_FIFO_IRQ_LEVEL::address,
+  TX_MAILBOX_INDEX::address,
+  TX_MAILBOX_ABORT::address,
+  TX_MAILBOX_PENDING::address,
+  TX_MAILBOX_DONE::address,
+  TX_MAILBOX_FAILED::address,
+  TX_MAILBOX_COUNT::address,
+  TIMESTAMP::address,
+  RX_TIMESTAMP::address,
+  TX_TIMESTAMP::address
+};
+
+static_assert(detail::unique_addresses(ALL_ADDRESSES, sizeof(ALL_ADDRESSES)/sizeof(ALL_ADDRESSES[0])),
+              "Two registers share the same address");
+
+} // namespace reg
+} // namespace canola
+
+#endif
@@ -0,0 +1,326 @@
+/**
+ * @file   canola_regs_check.hpp
+ * @brief  Compile-time check that the register layout in canola_regs.hpp
+ *         matches canola_axi_slave.hpp. Any mismatch fails the build.
+ *
+ *         Generated by source/scripts/gen_canola_regs.py from
+ *         source/json/canola.json - DO NOT EDIT.
+ */
+
+#ifndef CANOLA_REGS_CHECK_HPP
+#define CANOLA_REGS_CHECK_HPP
+
+#include "canola_axi_slave.hpp"
+#include "canola_regs.hpp"
+
+namespace canola
+{
+namespace reg
+{
+namespace check
+{
+namespace ref = CANOLA_AXI_SLAVE;
+
+/* STATUS */
+static_assert(STATUS::address == ref::STATUS_OFFSET, "STATUS: address mismatch");
+static_assert(STATUS::reset == ref::STATUS_RESET, "STATUS: reset mismatch");
+static_assert(STATUS::RX_MSG_VALID::offset == ref::STATUS_RX_MSG_VALID_OFFSET && STATUS::RX_MSG_VALID::width == ref::STATUS_RX_MSG_VALID_WIDTH &&
+              STATUS::RX_MSG_VALID::mask == ref::STATUS_RX_MSG_VALID_MASK, "STATUS_RX_MSG_VALID: layout mismatch");
+static_assert(STATUS::TX_BUSY::offset == ref::STATUS_TX_BUSY_OFFSET && STATUS::TX_BUSY::width == ref::STATUS_TX_BUSY_WIDTH &&
+              STATUS::TX_BUSY::mask == ref::STATUS_TX_BUSY_MASK, "STATUS_TX_BUSY: layout mismatch");
+static_assert(STATUS::TX_DONE::offset == ref::STATUS_TX_DONE_OFFSET && STATUS::TX_DONE::width == ref::STATUS_TX_DONE_WIDTH &&
+              STATUS::TX_DONE::mask == ref::STATUS_TX_DONE_MASK, "STATUS_TX_DONE: layout mismatch");
+static_assert(STATUS::TX_FAILED::offset == ref::STATUS_TX_FAILED_OFFSET && STATUS::TX_FAILED::width == ref::STATUS_TX_FAILED_WIDTH &&
+              STATUS::TX_FAILED::mask == ref::STATUS_TX_FAILED_MASK, "STATUS_TX_FAILED: layout mismatch");
+static_assert(STATUS::ERROR_STATE::offset == ref::STATUS_ERROR_STATE_OFFSET && STATUS::ERROR_STATE::width == ref::STATUS_ERROR_STATE_WIDTH &&
+              STATUS::ERROR_STATE::mask == ref::STATUS_ERROR_STATE_MASK, "STATUS_ERROR_STATE: layout mismatch");
+
+/* CONTROL */
+static_assert(CONTROL::address == ref::CONTROL_OFFSET, "CONTROL: address mismatch");
+static_assert(CONTROL::reset == ref::CONTROL_RESET, "CONTROL: reset mismatch");
+static_assert(CONTROL::TX_START::offset == ref::CONTROL_TX_START_OFFSET && CONTROL::TX_START::width == ref::CONTROL_TX_START_WIDTH &&
+              CONTROL::TX_START::mask == ref::CONTROL_TX_START_MASK, "CONTROL_TX_START: layout mismatch");
+static_assert(CONTROL::RESET_TX_MSG_SENT_COUNTER::offset == ref::CONTROL_RESET_TX_MSG_SENT_COUNTER_OFFSET && CONTROL::RESET_TX_MSG_SENT_COUNTER::width == ref::CONTROL_RESET_TX_MSG_SENT_COUNTER_WIDTH &&
+              CONTROL::RESET_TX_MSG_SENT_COUNTER::mask == ref::CONTROL_RESET_TX_MSG_SENT_COUNTER_MASK, "CONTROL_RESET_TX_MSG_SENT_COUNTER: layout mismatch");
+static_assert(CONTROL::RESET_TX_FAILED_COUNTER::offset == ref::CONTROL_RESET_TX_FAILED_COUNTER_OFFSET && CONTROL::RESET_TX_FAILED_COUNTER::width == ref::CONTROL_RESET_TX_FAILED_COUNTER_WIDTH &&
+              CONTROL::RESET_TX_FAILED_COUNTER::mask == ref::CONTROL_RESET_TX_FAILED_COUNTER_MASK, "CONTROL_RESET_TX_FAILED_COUNTER: layout mismatch");
+static_assert(CONTROL::RESET_TX_ACK_ERROR_COUNTER::offset == ref::CONTROL_RESET_TX_ACK_ERROR_COUNTER_OFFSET && CONTROL::RESET_TX_ACK_ERROR_COUNTER::width == ref::CONTROL_RESET_TX_ACK_ERROR_COUNTER_WIDTH &&
+              CONTROL::RESET_TX_ACK_ERROR_COUNTER::mask == ref::CONTROL_RESET_TX_ACK_ERROR_COUNTER_MASK, "CONTROL_RESET_TX_ACK_ERROR_COUNTER: layout mismatch");
+static_assert(CONTROL::RESET_TX_ARB_LOST_COUNTER::offset == ref::CONTROL_RESET_TX_ARB_LOST_COUNTER_OFFSET && CONTROL::RESET_TX_ARB_LOST_COUNTER::width == ref::CONTROL_RESET_TX_ARB_LOST_COUNTER_WIDTH &&
+              CONTROL::RESET_TX_ARB_LOST_COUNTER::mask == ref::CONTROL_RESET_TX_ARB_LOST_COUNTER_MASK, "CONTROL_RESET_TX_ARB_LOST_COUNTER: layout mismatch");
+static_assert(CONTROL::RESET_TX_BIT_ERROR_COUNTER::offset == ref::CONTROL_RESET_TX_BIT_ERROR_COUNTER_OFFSET && CONTROL::RESET_TX_BIT_ERROR_COUNTER::width == ref::CONTROL_RESET_TX_BIT_ERROR_COUNTER_WIDTH &&
+              CONTROL::RESET_TX_BIT_ERROR_COUNTER::mask == ref::CONTROL_RESET_TX_BIT_ERROR_COUNTER_MASK, "CONTROL_RESET_TX_BIT_ERROR_COUNTER: layout mismatch");
+static_assert(CONTROL::RESET_TX_RETRANSMIT_COUNTER::offset == ref::CONTROL_RESET_TX_RETRANSMIT_COUNTER_OFFSET && CONTROL::RESET_TX_RETRANSMIT_COUNTER::width == ref::CONTROL_RESET_TX_RETRANSMIT_COUNTER_WIDTH &&
+              CONTROL::RESET_TX_RETRANSMIT_COUNTER::mask == ref::CONTROL_RESET_TX_RETRANSMIT_COUNTER_MASK, "CONTROL_RESET_TX_RETRANSMIT_COUNTER: layout mismatch");
+static_assert(CONTROL::RESET_RX_MSG_RECV_COUNTER::offset == ref::CONTROL_RESET_RX_MSG_RECV_COUNTER_OFFSET && CONTROL::RESET_RX_MSG_RECV_COUNTER::width == ref::CONTROL_RESET_RX_MSG_RECV_COUNTER_WIDTH &&
+              CONTROL::RESET_RX_MSG_RECV_COUNTER::mask == ref::CONTROL_RESET_RX_MSG_RECV_COUNTER_MASK, "CONTROL_RESET_RX_MSG_RECV_COUNTER: layout mismatch");
+static_assert(CONTROL::RESET_RX_CRC_ERROR_COUNTER::offset == ref::CONTROL_RESET_RX_CRC_ERROR_COUNTER_OFFSET && CONTROL::RESET_RX_CRC_ERROR_COUNTER::width == ref::CONTROL_RESET_RX_CRC_ERROR_COUNTER_WIDTH &&
+              CONTROL::RESET_RX_CRC_ERROR_COUNTER::mask == ref::CONTROL_RESET_RX_CRC_ERROR_COUNTER_MASK, "CONTROL_RESET_RX_CRC_ERROR_COUNTER: layout mismatch");
+static_assert(CONTROL::RESET_RX_FORM_ERROR_COUNTER::offset == ref::CONTROL_RESET_RX_FORM_ERROR_COUNTER_OFFSET && CONTROL::RESET_RX_FORM_ERROR_COUNTER::width == ref::CONTROL_RESET_RX_FORM_ERROR_COUNTER_WIDTH &&
+              CONTROL::RESET_RX_FORM_ERROR_COUNTER::mask == ref::CONTROL_RESET_RX_FORM_ERROR_COUNTER_MASK, "CONTROL_RESET_RX_FORM_ERROR_COUNTER: layout mismatch");
+static_assert(CONTROL::RESET_RX_STUFF_ERROR_COUNTER::offset == ref::CONTROL_RESET_RX_STUFF_ERROR_COUNTER_OFFSET && CONTROL::RESET_RX_STUFF_ERROR_COUNTER::width == ref::CONTROL_RESET_RX_STUFF_ERROR_COUNTER_WIDTH &&
+              CONTROL::RESET_RX_STUFF_ERROR_COUNTER::mask == ref::CONTROL_RESET_RX_STUFF_ERROR_COUNTER_MASK, "CONTROL_RESET_RX_STUFF_ERROR_COUNTER: layout mismatch");
+static_assert(CONTROL::FILTER_WRITE::offset == ref::CONTROL_FILTER_WRITE_OFFSET && CONTROL::FILTER_WRITE::width == ref::CONTROL_FILTER_WRITE_WIDTH &&
+              CONTROL::FILTER_WRITE::mask == ref::CONTROL_FILTER_WRITE_MASK, "CONTROL_FILTER_WRITE: layout mismatch");
+static_assert(CONTROL::RX_FIFO_POP::offset == ref::CONTROL_RX_FIFO_POP_OFFSET && CONTROL::RX_FIFO_POP::width == ref::CONTROL_RX_FIFO_POP_WIDTH &&
+              CONTROL::RX_FIFO_POP::mask == ref::CONTROL_RX_FIFO_POP_MASK, "CONTROL_RX_FIFO_POP: layout mismatch");
+static_assert(CONTROL::RX_FIFO_FLUSH::offset == ref::CONTROL_RX_FIFO_FLUSH_OFFSET && CONTROL::RX_FIFO_FLUSH::width == ref::CONTROL_RX_FIFO_FLUSH_WIDTH &&
+              CONTROL::RX_FIFO_FLUSH::mask == ref::CONTROL_RX_FIFO_FLUSH_MASK, "CONTROL_RX_FIFO_FLUSH: layout mismatch");
+static_assert(CONTROL::RX_FIFO_CLEAR_OVERFLOW::offset == ref::CONTROL_RX_FIFO_CLEAR_OVERFLOW_OFFSET && CONTROL::RX_FIFO_CLEAR_OVERFLOW::width == ref::CONTROL_RX_FIFO_CLEAR_OVERFLOW_WIDTH &&
+              CONTROL::RX_FIFO_CLEAR_OVERFLOW::mask == ref::CONTROL_RX_FIFO_CLEAR_OVERFLOW_MASK, "CONTROL_RX_FIFO_CLEAR_OVERFLOW: layout mismatch");
+static_assert(CONTROL::TX_MAILBOX_LOAD::offset == ref::CONTROL_TX_MAILBOX_LOAD_OFFSET && CONTROL::TX_MAILBOX_LOAD::width == ref::CONTROL_TX_MAILBOX_LOAD_WIDTH &&
+              CONTROL::TX_MAILBOX_LOAD::mask == ref::CONTROL_TX_MAILBOX_LOAD_MASK, "CONTROL_TX_MAILBOX_LOAD: layout mismatch");
+
+/* CONFIG */
+static_assert(CONFIG::address == ref::CONFIG_OFFSET, "CONFIG: address mismatch");
+static_assert(CONFIG::reset == ref::CONFIG_RESET, "CONFIG: reset mismatch");
+static_assert(CONFIG::TX_RETRANSMIT_EN::offset == ref::CONFIG_TX_RETRANSMIT_EN_OFFSET && CONFIG::TX_RETRANSMIT_EN::width == ref::CONFIG_TX_RETRANSMIT_EN_WIDTH &&
+              CONFIG::TX_RETRANSMIT_EN::mask == ref::CONFIG_TX_RETRANSMIT_EN_MASK, "CONFIG_TX_RETRANSMIT_EN: layout mismatch");
+static_assert(CONFIG::BTL_TRIPLE_SAMPLING_EN::offset == ref::CONFIG_BTL_TRIPLE_SAMPLING_EN_OFFSET && CONFIG::BTL_TRIPLE_SAMPLING_EN::width == ref::CONFIG_BTL_TRIPLE_SAMPLING_EN_WIDTH &&
+              CONFIG::BTL_TRIPLE_SAMPLING_EN::mask == ref::CONFIG_BTL_TRIPLE_SAMPLING_EN_MASK, "CONFIG_BTL_TRIPLE_SAMPLING_EN: layout mismatch");
+static_assert(CONFIG::ACCEPTANCE_FILTER_EN::offset == ref::CONFIG_ACCEPTANCE_FILTER_EN_OFFSET && CONFIG::ACCEPTANCE_FILTER_EN::width == ref::CONFIG_ACCEPTANCE_FILTER_EN_WIDTH &&
+              CONFIG::ACCEPTANCE_FILTER_EN::mask == ref::CONFIG_ACCEPTANCE_FILTER_EN_MASK, "CONFIG_ACCEPTANCE_FILTER_EN: layout mismatch");
+static_assert(CONFIG::RX_FIFO_EN::offset == ref::CONFIG_RX_FIFO_EN_OFFSET && CONFIG::RX_FIFO_EN::width == ref::CONFIG_RX_FIFO_EN_WIDTH &&
+              CONFIG::RX_FIFO_EN::mask == ref::CONFIG_RX_FIFO_EN_MASK, "CONFIG_RX_FIFO_EN: layout mismatch");
+static_assert(CONFIG::TX_MAILBOX_EN::offset == ref::CONFIG_TX_MAILBOX_EN_OFFSET && CONFIG::TX_MAILBOX_EN::width == ref::CONFIG_TX_MAILBOX_EN_WIDTH &&
+              CONFIG::TX_MAILBOX_EN::mask == ref::CONFIG_TX_MAILBOX_EN_MASK, "CONFIG_TX_MAILBOX_EN: layout mismatch");
+
+/* BTL_PROP_SEG */
+static_assert(BTL_PROP_SEG::address == ref::BTL_PROP_SEG_OFFSET, "BTL_PROP_SEG: address mismatch");
+static_assert(BTL_PROP_SEG::reset == ref::BTL_PROP_SEG_RESET, "BTL_PROP_SEG: reset mismatch");
+
+/* BTL_PHASE_SEG1 */
+static_assert(BTL_PHASE_SEG1::address == ref::BTL_PHASE_SEG1_OFFSET, "BTL_PHASE_SEG1: address mismatch");
+static_assert(BTL_PHASE_SEG1::reset == ref::BTL_PHASE_SEG1_RESET, "BTL_PHASE_SEG1: reset mismatch");
+
+/* BTL_PHASE_SEG2 */
+static_assert(BTL_PHASE_SEG2::address == ref::BTL_PHASE_SEG2_OFFSET, "BTL_PHASE_SEG2: address mismatch");
+static_assert(BTL_PHASE_SEG2::reset == ref::BTL_PHASE_SEG2_RESET, "BTL_PHASE_SEG2: reset mismatch");
+
+/* BTL_SYNC_JUMP_WIDTH */
+static_assert(BTL_SYNC_JUMP_WIDTH::address == ref::BTL_SYNC_JUMP_WIDTH_OFFSET, "BTL_SYNC_JUMP_WIDTH: address mismatch");
+static_assert(BTL_SYNC_JUMP_WIDTH::reset == ref::BTL_SYNC_JUMP_WIDTH_RESET, "BTL_SYNC_JUMP_WIDTH: reset mismatch");
+
+/* TIME_QUANTA_CLOCK_SCALE */
+static_assert(TIME_QUANTA_CLOCK_SCALE::address == ref::TIME_QUANTA_CLOCK_SCALE_OFFSET, "TIME_QUANTA_CLOCK_SCALE: address mismatch");
+static_assert(TIME_QUANTA_CLOCK_SCALE::reset == ref::TIME_QUANTA_CLOCK_SCALE_RESET, "TIME_QUANTA_CLOCK_SCALE: reset mismatch");
+
+/* TRANSMIT_ERROR_COUNT */
+static_assert(TRANSMIT_ERROR_COUNT::address == ref::TRANSMIT_ERROR_COUNT_OFFSET, "TRANSMIT_ERROR_COUNT: address mismatch");
+static_assert(TRANSMIT_ERROR_COUNT::reset == ref::TRANSMIT_ERROR_COUNT_RESET, "TRANSMIT_ERROR_COUNT: reset mismatch");
+
+/* RECEIVE_ERROR_COUNT */
+static_assert(RECEIVE_ERROR_COUNT::address == ref::RECEIVE_ERROR_COUNT_OFFSET, "RECEIVE_ERROR_COUNT: address mismatch");
+static_assert(RECEIVE_ERROR_COUNT::reset == ref::RECEIVE_ERROR_COUNT_RESET, "RECEIVE_ERROR_COUNT: reset mismatch");
+
+/* TX_MSG_SENT_COUNT */
+static_assert(TX_MSG_SENT_COUNT::address == ref::TX_MSG_SENT_COUNT_OFFSET, "TX_MSG_SENT_COUNT: address mismatch");
+static_assert(TX_MSG_SENT_COUNT::reset == ref::TX_MSG_SENT_COUNT_RESET, "TX_MSG_SENT_COUNT: reset mismatch");
+
+/* TX_FAILED_COUNT */
+static_assert(TX_FAILED_COUNT::address == ref::TX_FAILED_COUNT_OFFSET, "TX_FAILED_COUNT: address mismatch");
+static_assert(TX_FAILED_COUNT::reset == ref::TX_FAILED_COUNT_RESET, "TX_FAILED_COUNT: reset mismatch");
+
+/* TX_ACK_ERROR_COUNT */
+static_assert(TX_ACK_ERROR_COUNT::address == ref::TX_ACK_ERROR_COUNT_OFFSET, "TX_ACK_ERROR_COUNT: address mismatch");
+static_assert(TX_ACK_ERROR_COUNT::reset == ref::TX_ACK_ERROR_COUNT_RESET, "TX_ACK_ERROR_COUNT: reset mismatch");
+
+/* TX_ARB_LOST_COUNT */
+static_assert(TX_ARB_LOST_COUNT::address == ref::TX_ARB_LOST_COUNT_OFFSET, "TX_ARB_LOST_COUNT: address mismatch");
+static_assert(TX_ARB_LOST_COUNT::reset == ref::TX_ARB_LOST_COUNT_RESET, "TX_ARB_LOST_COUNT: reset mismatch");
+
+/* TX_BIT_ERROR_COUNT */
+static_assert(TX_BIT_ERROR_COUNT::address == ref::TX_BIT_ERROR_COUNT_OFFSET, "TX_BIT_ERROR_COUNT: address mismatch");
+static_assert(TX_BIT_ERROR_COUNT::reset == ref::TX_BIT_ERROR_COUNT_RESET, "TX_BIT_ERROR_COUNT: reset mismatch");
+
+/* TX_RETRANSMIT_COUNT */
+static_assert(TX_RETRANSMIT_COUNT::address == ref::TX_RETRANSMIT_COUNT_OFFSET, "TX_RETRANSMIT_COUNT: address mismatch");
+static_assert(TX_RETRANSMIT_COUNT::reset == ref::TX_RETRANSMIT_COUNT_RESET, "TX_RETRANSMIT_COUNT: reset mismatch");
+
+/* RX_MSG_RECV_COUNT */
+static_assert(RX_MSG_RECV_COUNT::address == ref::RX_MSG_RECV_COUNT_OFFSET, "RX_MSG_RECV_COUNT: address mismatch");
+static_assert(RX_MSG_RECV_COUNT::reset == ref::RX_MSG_RECV_COUNT_RESET, "RX_MSG_RECV_COUNT: reset mismatch");
+
+/* RX_CRC_ERROR_COUNT */
+static_assert(RX_CRC_ERROR_COUNT::address == ref::RX_CRC_ERROR_COUNT_OFFSET, "RX_CRC_ERROR_COUNT: address mismatch");
+static_assert(RX_CRC_ERROR_COUNT::reset == ref::RX_CRC_ERROR_COUNT_RESET, "RX_CRC_ERROR_COUNT: reset mismatch");
+
+/* RX_FORM_ERROR_COUNT */
+static_assert(RX_FORM_ERROR_COUNT::address == ref::RX_FORM_ERROR_COUNT_OFFSET, "RX_FORM_ERROR_COUNT: address mismatch");
+static_assert(RX_FORM_ERROR_COUNT::reset == ref::RX_FORM_ERROR_COUNT_RESET, "RX_FORM_ERROR_COUNT: reset mismatch");
+
+/* RX_STUFF_ERROR_COUNT */
+static_assert(RX_STUFF_ERROR_COUNT::address == ref::RX_STUFF_ERROR_COUNT_OFFSET, "RX_STUFF_ERROR_COUNT: address mismatch");
+static_assert(RX_STUFF_ERROR_COUNT::reset == ref::RX_STUFF_ERROR_COUNT_RESET, "RX_STUFF_ERROR_COUNT: reset mismatch");
+
+/* TX_MSG_ID */
+static_assert(TX_MSG_ID::address == ref::TX_MSG_ID_OFFSET, "TX_MSG_ID: address mismatch");
+static_assert(TX_MSG_ID::reset == ref::TX_MSG_ID_RESET, "TX_MSG_ID: reset mismatch");
+static_assert(TX_MSG_ID::EXT_ID_EN::offset == ref::TX_MSG_ID_EXT_ID_EN_OFFSET && TX_MSG_ID::EXT_ID_EN::width == ref::TX_MSG_ID_EXT_ID_EN_WIDTH &&
+              TX_MSG_ID::EXT_ID_EN::mask == ref::TX_MSG_ID_EXT_ID_EN_MASK, "TX_MSG_ID_EXT_ID_EN: layout mismatch");
+static_assert(TX_MSG_ID::RTR_EN::offset == ref::TX_MSG_ID_RTR_EN_OFFSET && TX_MSG_ID::RTR_EN::width == ref::TX_MSG_ID_RTR_EN_WIDTH &&
+              TX_MSG_ID::RTR_EN::mask == ref::TX_MSG_ID_RTR_EN_MASK, "TX_MSG_ID_RTR_EN: layout mismatch");
+static_assert(TX_MSG_ID::ARB_ID_B::offset == ref::TX_MSG_ID_ARB_ID_B_OFFSET && TX_MSG_ID::ARB_ID_B::width == ref::TX_MSG_ID_ARB_ID_B_WIDTH &&
+              TX_MSG_ID::ARB_ID_B::mask == ref::TX_MSG_ID_ARB_ID_B_MASK, "TX_MSG_ID_ARB_ID_B: layout mismatch");
+static_assert(TX_MSG_ID::ARB_ID_A::offset == ref::TX_MSG_ID_ARB_ID_A_OFFSET && TX_MSG_ID::ARB_ID_A::width == ref::TX_MSG_ID_ARB_ID_A_WIDTH &&
+              TX_MSG_ID::ARB_ID_A::mask == ref::TX_MSG_ID_ARB_ID_A_MASK, "TX_MSG_ID_ARB_ID_A: layout mismatch");
+
+/* TX_PAYLOAD_LENGTH */
+static_assert(TX_PAYLOAD_LENGTH::address == ref::TX_PAYLOAD_LENGTH_OFFSET, "TX_PAYLOAD_LENGTH: address mismatch");
+static_assert(TX_PAYLOAD_LENGTH::reset == ref::TX_PAYLOAD_LENGTH_RESET, "TX_PAYLOAD_LENGTH: reset mismatch");
+
+/* TX_PAYLOAD_0 */
+static_assert(TX_PAYLOAD_0::address == ref::TX_PAYLOAD_0_OFFSET, "TX_PAYLOAD_0: address mismatch");
+static_assert(TX_PAYLOAD_0::reset == ref::TX_PAYLOAD_0_RESET, "TX_PAYLOAD_0: reset mismatch");
+static_assert(TX_PAYLOAD_0::PAYLOAD_BYTE_0::offset == ref::TX_PAYLOAD_0_PAYLOAD_BYTE_0_OFFSET && TX_PAYLOAD_0::PAYLOAD_BYTE_0::width == ref::TX_PAYLOAD_0_PAYLOAD_BYTE_0_WIDTH &&
+              TX_PAYLOAD_0::PAYLOAD_BYTE_0::mask == ref::TX_PAYLOAD_0_PAYLOAD_BYTE_0_MASK, "TX_PAYLOAD_0_PAYLOAD_BYTE_0: layout mismatch");
+static_assert(TX_PAYLOAD_0::PAYLOAD_BYTE_1::offset == ref::TX_PAYLOAD_0_PAYLOAD_BYTE_1_OFFSET && TX_PAYLOAD_0::PAYLOAD_BYTE_1::width == ref::TX_PAYLOAD_0_PAYLOAD_BYTE_1_WIDTH &&
+              TX_PAYLOAD_0::PAYLOAD_BYTE_1::mask == ref::TX_PAYLOAD_0_PAYLOAD_BYTE_1_MASK, "TX_PAYLOAD_0_PAYLOAD_BYTE_1: layout mismatch");
+static_assert(TX_PAYLOAD_0::PAYLOAD_BYTE_2::offset == ref::TX_PAYLOAD_0_PAYLOAD_BYTE_2_OFFSET && TX_PAYLOAD_0::PAYLOAD_BYTE_2::width == ref::TX_PAYLOAD_0_PAYLOAD_BYTE_2_WIDTH &&
+              TX_PAYLOAD_0::PAYLOAD_BYTE_2::mask == ref::TX_PAYLOAD_0_PAYLOAD_BYTE_2_MASK, "TX_PAYLOAD_0_PAYLOAD_BYTE_2: layout mismatch");
+static_assert(TX_PAYLOAD_0::PAYLOAD_BYTE_3::offset == ref::TX_PAYLOAD_0_PAYLOAD_BYTE_3_OFFSET && TX_PAYLOAD_0::PAYLOAD_BYTE_3::width == ref::TX_PAYLOAD_0_PAYLOAD_BYTE_3_WIDTH &&
+              TX_PAYLOAD_0::PAYLOAD_BYTE_3::mask == ref::TX_PAYLOAD_0_PAYLOAD_BYTE_3_MASK, "TX_PAYLOAD_0_PAYLOAD_BYTE_3: layout mismatch");
+
+/* TX_PAYLOAD_1 */
+static_assert(TX_PAYLOAD_1::address == ref::TX_PAYLOAD_1_OFFSET, "TX_PAYLOAD_1: address mismatch");
+static_assert(TX_PAYLOAD_1::reset == ref::TX_PAYLOAD_1_RESET, "TX_PAYLOAD_1: reset mismatch");
+static_assert(TX_PAYLOAD_1::PAYLOAD_BYTE_4::offset == ref::TX_PAYLOAD_1_PAYLOAD_BYTE_4_OFFSET && TX_PAYLOAD_1::PAYLOAD_BYTE_4::width == ref::TX_PAYLOAD_1_PAYLOAD_BYTE_4_WIDTH &&
+              TX_PAYLOAD_1::PAYLOAD_BYTE_4::mask == ref::TX_PAYLOAD_1_PAYLOAD_BYTE_4_MASK, "TX_PAYLOAD_1_PAYLOAD_BYTE_4: layout mismatch");
+static_assert(TX_PAYLOAD_1::PAYLOAD_BYTE_5::offset == ref::TX_PAYLOAD_1_PAYLOAD_BYTE_5_OFFSET && TX_PAYLOAD_1::PAYLOAD_BYTE_5::width == ref::TX_PAYLOAD_1_PAYLOAD_BYTE_5_WIDTH &&
+              TX_PAYLOAD_1::PAYLOAD_BYTE_5::mask == ref::TX_PAYLOAD_1_PAYLOAD_BYTE_5_MASK, "TX_PAYLOAD_1_PAYLOAD_BYTE_5: layout mismatch");
+static_assert(TX_PAYLOAD_1::PAYLOAD_BYTE_6::offset == ref::TX_PAYLOAD_1_PAYLOAD_BYTE_6_OFFSET && TX_PAYLOAD_1::PAYLOAD_BYTE_6::width == ref::TX_PAYLOAD_1_PAYLOAD_BYTE_6_WIDTH &&
+              TX_PAYLOAD_1::PAYLOAD_BYTE_6::mask == ref::TX_PAYLOAD_1_PAYLOAD_BYTE_6_MASK, "TX_PAYLOAD_1_PAYLOAD_BYTE_6: layout mismatch");
+static_assert(TX_PAYLOAD_1::PAYLOAD_BYTE_7::offset == ref::TX_PAYLOAD_1_PAYLOAD_BYTE_7_OFFSET && TX_PAYLOAD_1::PAYLOAD_BYTE_7::width == ref::TX_PAYLOAD_1_PAYLOAD_BYTE_7_WIDTH &&
+              TX_PAYLOAD_1::PAYLOAD_BYTE_7::mask == ref::TX_PAYLOAD_1_PAYLOAD_BYTE_7_MASK, "TX_PAYLOAD_1_PAYLOAD_BYTE_7: layout mismatch");
+
+/* RX_MSG_ID */
+static_assert(RX_MSG_ID::address == ref::RX_MSG_ID_OFFSET, "RX_MSG_ID: address mismatch");
+static_assert(RX_MSG_ID::reset == ref::RX_MSG_ID_RESET, "RX_MSG_ID: reset mismatch");
+static_assert(RX_MSG_ID::EXT_ID_EN::offset == ref::RX_MSG_ID_EXT_ID_EN_OFFSET && RX_MSG_ID::EXT_ID_EN::width == ref::RX_MSG_ID_EXT_ID_EN_WIDTH &&
+              RX_MSG_ID::EXT_ID_EN::mask == ref::RX_MSG_ID_EXT_ID_EN_MASK, "RX_MSG_ID_EXT_ID_EN: layout mismatch");
+static_assert(RX_MSG_ID::RTR_EN::offset == ref::RX_MSG_ID_RTR_EN_OFFSET && RX_MSG_ID::RTR_EN::width == ref::RX_MSG_ID_RTR_EN_WIDTH &&
+              RX_MSG_ID::RTR_EN::mask == ref::RX_MSG_ID_RTR_EN_MASK, "RX_MSG_ID_RTR_EN: layout mismatch");
+static_assert(RX_MSG_ID::ARB_ID_B::offset == ref::RX_MSG_ID_ARB_ID_B_OFFSET && RX_MSG_ID::ARB_ID_B::width == ref::RX_MSG_ID_ARB_ID_B_WIDTH &&
+              RX_MSG_ID::ARB_ID_B::mask == ref::RX_MSG_ID_ARB_ID_B_MASK, "RX_MSG_ID_ARB_ID_B: layout mismatch");
+static_assert(RX_MSG_ID::ARB_ID_A::offset == ref::RX_MSG_ID_ARB_ID_A_OFFSET && RX_MSG_ID::ARB_ID_A::width == ref::RX_MSG_ID_ARB_ID_A_WIDTH &&
+              RX_MSG_ID::ARB_ID_A::mask == ref::RX_MSG_ID_ARB_ID_A_MASK, "RX_MSG_ID_ARB_ID_A: layout mismatch");
+
+/* RX_PAYLOAD_LENGTH */
+static_assert(RX_PAYLOAD_LENGTH::address == ref::RX_PAYLOAD_LENGTH_OFFSET, "RX_PAYLOAD_LENGTH: address mismatch");
+static_assert(RX_PAYLOAD_LENGTH::reset == ref::RX_PAYLOAD_LENGTH_RESET, "RX_PAYLOAD_LENGTH: reset mismatch");
+
+/* RX_PAYLOAD_0 */
+static_assert(RX_PAYLOAD_0::address == ref::RX_PAYLOAD_0_OFFSET, "RX_PAYLOAD_0: address mismatch");
+static_assert(RX_PAYLOAD_0::reset == ref::RX_PAYLOAD_0_RESET, "RX_PAYLOAD_0: reset mismatch");
+static_assert(RX_PAYLOAD_0::PAYLOAD_BYTE_0::offset == ref::RX_PAYLOAD_0_PAYLOAD_BYTE_0_OFFSET && RX_PAYLOAD_0::PAYLOAD_BYTE_0::width == ref::RX_PAYLOAD_0_PAYLOAD_BYTE_0_WIDTH &&
+              RX_PAYLOAD_0::PAYLOAD_BYTE_0::mask == ref::RX_PAYLOAD_0_PAYLOAD_BYTE_0_MASK, "RX_PAYLOAD_0_PAYLOAD_BYTE_0: layout mismatch");
+static_assert(RX_PAYLOAD_0::PAYLOAD_BYTE_1::offset == ref::RX_PAYLOAD_0_PAYLOAD_BYTE_1_OFFSET && RX_PAYLOAD_0::PAYLOAD_BYTE_1::width == ref::RX_PAYLOAD_0_PAYLOAD_BYTE_1_WIDTH &&
+              RX_PAYLOAD_0::PAYLOAD_BYTE_1::mask == ref::RX_PAYLOAD_0_PAYLOAD_BYTE_1_MASK, "RX_PAYLOAD_0_PAYLOAD_BYTE_1: layout mismatch");
+static_assert(RX_PAYLOAD_0::PAYLOAD_BYTE_2::offset == ref::RX_PAYLOAD_0_PAYLOAD_BYTE_2_OFFSET && RX_PAYLOAD_0::PAYLOAD_BYTE_2::width == ref::RX_PAYLOAD_0_PAYLOAD_BYTE_2_WIDTH &&
+              RX_PAYLOAD_0::PAYLOAD_BYTE_2::mask == ref::RX_PAYLOAD_0_PAYLOAD_BYTE_2_MASK, "RX_PAYLOAD_0_PAYLOAD_BYTE_2: layout mismatch");
+static_assert(RX_PAYLOAD_0::PAYLOAD_BYTE_3::offset == ref::RX_PAYLOAD_0_PAYLOAD_BYTE_3_OFFSET && RX_PAYLOAD_0::PAYLOAD_BYTE_3::width == ref::RX_PAYLOAD_0_PAYLOAD_BYTE_3_WIDTH &&
+              RX_PAYLOAD_0::PAYLOAD_BYTE_3::mask == ref::RX_PAYLOAD_0_PAYLOAD_BYTE_3_MASK, "RX_PAYLOAD_0_PAYLOAD_BYTE_3: layout mismatch");
+
+/* RX_PAYLOAD_1 */
+static_assert(RX_PAYLOAD_1::address == ref::RX_PAYLOAD_1_OFFSET, "RX_PAYLOAD_1: address mismatch");
+static_assert(RX_PAYLOAD_1::reset == ref::RX_PAYLOAD_1_RESET, "RX_PAYLOAD_1: reset mismatch");
+static_assert(RX_PAYLOAD_1::PAYLOAD_BYTE_4::offset == ref::RX_PAYLOAD_1_PAYLOAD_BYTE_4_OFFSET && RX_PAYLOAD_1::PAYLOAD_BYTE_4::width == ref::RX_PAYLOAD_1_PAYLOAD_BYTE_4_WIDTH &&
+              RX_PAYLOAD_1::PAYLOAD_BYTE_4::mask == ref::RX_PAYLOAD_1_PAYLOAD_BYTE_4_MASK, "RX_PAYLOAD_1_PAYLOAD_BYTE_4: layout mismatch");
+static_assert(RX_PAYLOAD_1::PAYLOAD_BYTE_5::offset == ref::RX_PAYLOAD_1_PAYLOAD_BYTE_5_OFFSET && RX_PAYLOAD_1::PAYLOAD_BYTE_5::width == ref::RX_PAYLOAD_1_PAYLOAD_BYTE_5_WIDTH &&
+              RX_PAYLOAD_1::PAYLOAD_BYTE_5::mask == ref::RX_PAYLOAD_1_PAYLOAD_BYTE_5_MASK, "RX_PAYLOAD_1_PAYLOAD_BYTE_5: layout mismatch");
+static_assert(RX_PAYLOAD_1::PAYLOAD_BYTE_6::offset == ref::RX_PAYLOAD_1_PAYLOAD_BYTE_6_OFFSET && RX_PAYLOAD_1::PAYLOAD_BYTE_6::width == ref::RX_PAYLOAD_1_PAYLOAD_BYTE_6_WIDTH &&
+              RX_PAYLOAD_1::PAYLOAD_BYTE_6::mask == ref::RX_PAYLOAD_1_PAYLOAD_BYTE_6_MASK, "RX_PAYLOAD_1_PAYLOAD_BYTE_6: layout mismatch");
+static_assert(RX_PAYLOAD_1::PAYLOAD_BYTE_7::offset == ref::RX_PAYLOAD_1_PAYLOAD_BYTE_7_OFFSET && RX_PAYLOAD_1::PAYLOAD_BYTE_7::width == ref::RX_PAYLOAD_1_PAYLOAD_BYTE_7_WIDTH &&
+              RX_PAYLOAD_1::PAYLOAD_BYTE_7::mask == ref::RX_PAYLOAD_1_PAYLOAD_BYTE_7_MASK, "RX_PAYLOAD_1_PAYLOAD_BYTE_7: layout mismatch");
+
+/* FILTER_INDEX */
+static_assert(FILTER_INDEX::address == ref::FILTER_INDEX_OFFSET, "FILTER_INDEX: address mismatch");
+static_assert(FILTER_INDEX::reset == ref::FILTER_INDEX_RESET, "FILTER_INDEX: reset mismatch");
+
+/* FILTER_ID */
+static_assert(FILTER_ID::address == ref::FILTER_ID_OFFSET, "FILTER_ID: address mismatch");
+static_assert(FILTER_ID::reset == ref::FILTER_ID_RESET, "FILTER_ID: reset mismatch");
+static_assert(FILTER_ID::EXT_ID_EN::offset == ref::FILTER_ID_EXT_ID_EN_OFFSET && FILTER_ID::EXT_ID_EN::width == ref::FILTER_ID_EXT_ID_EN_WIDTH &&
+              FILTER_ID::EXT_ID_EN::mask == ref::FILTER_ID_EXT_ID_EN_MASK, "FILTER_ID_EXT_ID_EN: layout mismatch");
+static_assert(FILTER_ID::RTR_EN::offset == ref::FILTER_ID_RTR_EN_OFFSET && FILTER_ID::RTR_EN::width == ref::FILTER_ID_RTR_EN_WIDTH &&
+              FILTER_ID::RTR_EN::mask == ref::FILTER_ID_RTR_EN_MASK, "FILTER_ID_RTR_EN: layout mismatch");
+static_assert(FILTER_ID::ARB_ID_B::offset == ref::FILTER_ID_ARB_ID_B_OFFSET && FILTER_ID::ARB_ID_B::width == ref::FILTER_ID_ARB_ID_B_WIDTH &&
+              FILTER_ID::ARB_ID_B::mask == ref::FILTER_ID_ARB_ID_B_MASK, "FILTER_ID_ARB_ID_B: layout mismatch");
+static_assert(FILTER_ID::ARB_ID_A::offset == ref::FILTER_ID_ARB_ID_A_OFFSET && FILTER_ID::ARB_ID_A::width == ref::FILTER_ID_ARB_ID_A_WIDTH &&
+              FILTER_ID::ARB_ID_A::mask == ref::FILTER_ID_ARB_ID_A_MASK, "FILTER_ID_ARB_ID_A: layout mismatch");
+static_assert(FILTER_ID::ENABLE::offset == ref::FILTER_ID_ENABLE_OFFSET && FILTER_ID::ENABLE::width == ref::FILTER_ID_ENABLE_WIDTH &&
+              FILTER_ID::ENABLE::mask == ref::FILTER_ID_ENABLE_MASK, "FILTER_ID_ENABLE: layout mismatch");
+
+/* FILTER_MASK */
+static_assert(FILTER_MASK::address == ref::FILTER_MASK_OFFSET, "FILTER_MASK: address mismatch");
+static_assert(FILTER_MASK::reset == ref::FILTER_MASK_RESET, "FILTER_MASK: reset mismatch");
+static_assert(FILTER_MASK::EXT_ID_EN::offset == ref::FILTER_MASK_EXT_ID_EN_OFFSET && FILTER_MASK::EXT_ID_EN::width == ref::FILTER_MASK_EXT_ID_EN_WIDTH &&
+              FILTER_MASK::EXT_ID_EN::mask == ref::FILTER_MASK_EXT_ID_EN_MASK, "FILTER_MASK_EXT_ID_EN: layout mismatch");
+static_assert(FILTER_MASK::RTR_EN::offset == ref::FILTER_MASK_RTR_EN_OFFSET && FILTER_MASK::RTR_EN::width == ref::FILTER_MASK_RTR_EN_WIDTH &&
+              FILTER_MASK::RTR_EN::mask == ref::FILTER_MASK_RTR_EN_MASK, "FILTER_MASK_RTR_EN: layout mismatch");
+static_assert(FILTER_MASK::ARB_ID_B::offset == ref::FILTER_MASK_ARB_ID_B_OFFSET && FILTER_MASK::ARB_ID_B::width == ref::FILTER_MASK_ARB_ID_B_WIDTH &&
+              FILTER_MASK::ARB_ID_B::mask == ref::FILTER_MASK_ARB_ID_B_MASK, "FILTER_MASK_ARB_ID_B: layout mismatch");
+static_assert(FILTER_MASK::ARB_ID_A::offset == ref::FILTER_MASK_ARB_ID_A_OFFSET && FILTER_MASK::ARB_ID_A::width == ref::FILTER_MASK_ARB_ID_A_WIDTH &&
+              FILTER_MASK::ARB_ID_A::mask == ref::FILTER_MASK_ARB_ID_A_MASK, "FILTER_MASK_ARB_ID_A: layout mismatch");
+
+/* RX_FILTER_HIT */
+static_assert(RX_FILTER_HIT::address == ref::RX_FILTER_HIT_OFFSET, "RX_FILTER_HIT: address mismatch");
+static_assert(RX_FILTER_HIT::reset == ref::RX_FILTER_HIT_RESET, "RX_FILTER_HIT: reset mismatch");
+
+/* RX_FIFO_STATUS */
+static_assert(RX_FIFO_STATUS::address == ref::RX_FIFO_STATUS_OFFSET, "RX_FIFO_STATUS: address mismatch");
+static_assert(RX_FIFO_STATUS::reset == ref::RX_FIFO_STATUS_RESET, "RX_FIFO_STATUS: reset mismatch");
+static_assert(RX_FIFO_STATUS::FILL_LEVEL::offset == ref::RX_FIFO_STATUS_FILL_LEVEL_OFFSET && RX_FIFO_STATUS::FILL_LEVEL::width == ref::RX_FIFO_STATUS_FILL_LEVEL_WIDTH &&
+              RX_FIFO_STATUS::FILL_LEVEL::mask == ref::RX_FIFO_STATUS_FILL_LEVEL_MASK, "RX_FIFO_STATUS_FILL_LEVEL: layout mismatch");
+static_assert(RX_FIFO_STATUS::EMPTY::offset == ref::RX_FIFO_STATUS_EMPTY_OFFSET && RX_FIFO_STATUS::EMPTY::width == ref::RX_FIFO_STATUS_EMPTY_WIDTH &&
+              RX_FIFO_STATUS::EMPTY::mask == ref::RX_FIFO_STATUS_EMPTY_MASK, "RX_FIFO_STATUS_EMPTY: layout mismatch");
+static_assert(RX_FIFO_STATUS::FULL::offset == ref::RX_FIFO_STATUS_FULL_OFFSET && RX_FIFO_STATUS::FULL::width == ref::RX_FIFO_STATUS_FULL_WIDTH &&
+              RX_FIFO_STATUS::FULL::mask == ref::RX_FIFO_STATUS_FULL_MASK, "RX_FIFO_STATUS_FULL: layout mismatch");
+static_assert(RX_FIFO_STATUS::OVERFLOW::offset == ref::RX_FIFO_STATUS_OVERFLOW_OFFSET && RX_FIFO_STATUS::OVERFLOW::width == ref::RX_FIFO_STATUS_OVERFLOW_WIDTH &&
+              RX_FIFO_STATUS::OVERFLOW::mask == ref::RX_FIFO_STATUS_OVERFLOW_MASK, "RX_FIFO_STATUS_OVERFLOW: layout mismatch");
+
+/* RX_FIFO_IRQ_LEVEL */
+static_assert(RX_FIFO_IRQ_LEVEL::address == ref::RX_FIFO_IRQ_LEVEL_OFFSET, "RX_FIFO_IRQ_LEVEL: address mismatch");
+static_assert(RX_FIFO_IRQ_LEVEL::reset == ref::RX_FIFO_IRQ_LEVEL_RESET, "RX_FIFO_IRQ_LEVEL: reset mismatch");
+
+/* TX_MAILBOX_INDEX */
+static_assert(TX_MAILBOX_INDEX::address == ref::TX_MAILBOX_INDEX_OFFSET, "TX_MAILBOX_INDEX: address mismatch");
+static_assert(TX_MAILBOX_INDEX::reset == ref::TX_MAILBOX_INDEX_RESET, "TX_MAILBOX_INDEX: reset mismatch");
+
+/* TX_MAILBOX_ABORT */
+static_assert(TX_MAILBOX_ABORT::address == ref::TX_MAILBOX_ABORT_OFFSET, "TX_MAILBOX_ABORT: address mismatch");
+static_assert(TX_MAILBOX_ABORT::reset == ref::TX_MAILBOX_ABORT_RESET, "TX_MAILBOX_ABORT: reset mismatch");
+
+/* TX_MAILBOX_PENDING */
+static_assert(TX_MAILBOX_PENDING::address == ref::TX_MAILBOX_PENDING_OFFSET, "TX_MAILBOX_PENDING: address mismatch");
+static_assert(TX_MAILBOX_PENDING::reset == ref::TX_MAILBOX_PENDING_RESET, "TX_MAILBOX_PENDING: reset mismatch");
+
+/* TX_MAILBOX_DONE */
+static_assert(TX_MAILBOX_DONE::address == ref::TX_MAILBOX_DONE_OFFSET, "TX_MAILBOX_DONE: address mismatch");
+static_assert(TX_MAILBOX_DONE::reset == ref::TX_MAILBOX_DONE_RESET, "TX_MAILBOX_DONE: reset mismatch");
+
+/* TX_MAILBOX_FAILED */
+static_assert(TX_MAILBOX_FAILED::address == ref::TX_MAILBOX_FAILED_OFFSET, "TX_MAILBOX_FAILED: address mismatch");
+static_assert(TX_MAILBOX_FAILED::reset == ref::TX_MAILBOX_FAILED_RESET, "TX_MAILBOX_FAILED: reset mismatch");
+
+/* TX_MAILBOX_COUNT */
+static_assert(TX_MAILBOX_COUNT::address == ref::TX_MAILBOX_COUNT_OFFSET, "TX_MAILBOX_COUNT: address mismatch");
+static_assert(TX_MAILBOX_COUNT::reset == ref::TX_MAILBOX_COUNT_RESET, "TX_MAILBOX_COUNT: reset mismatch");
+
+/* TIMESTAMP */
+static_assert(TIMESTAMP::address == ref::TIMESTAMP_OFFSET, "TIMESTAMP: address mismatch");
+static_assert(TIMESTAMP::reset == ref::TIMESTAMP_RESET, "TIMESTAMP: reset mismatch");
+
+/* RX_TIMESTAMP */
+static_assert(RX_TIMESTAMP::address == ref::RX_TIMESTAMP_OFFSET, "RX_TIMESTAMP: address mismatch");
+static_assert(RX_TIMESTAMP::reset == ref::RX_TIMESTAMP_RESET, "RX_TIMESTAMP: reset mismatch");
+
+/* TX_TIMESTAMP */
+static_assert(TX_TIMESTAMP::address == ref::TX_TIMESTAMP_OFFSET, "TX_TIMESTAMP: address mismatch");
+static_assert(TX_TIMESTAMP::reset == ref::TX_TIMESTAMP_RESET, "TX_TIMESTAMP: reset mismatch");
+
+} // namespace check
+} // namespace reg
+} // namespace canola
+
+#endif
@@ -0,0 +1,340 @@
+/**
+ * @file   canola_replay.hpp
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Replays a frame trace (canola_trace.hpp) into Canola controllers,
+ *         with the inter-frame timing of the recording, scaled in time, or
+ *         as fast as the bus allows.
+ *
+ *         Frames are sent on a schedule against a monotonic clock: the
+ *         first frame is sent at once, and each following frame when the
+ *         time since the first recorded frame (times the scale) has passed.
+ *         Recorded times are at the end of the frame, so the start of each
+ *         frame is found by subtracting frame_length() bits at the bit rate
+ *         of the bus (Options::bit_rate).
+ *
+ *         Waiting is a hybrid: sleep (clock_nanosleep) until spin_ns before
+ *         the frame is due, then spin on the clock, so the send is not
+ *         delayed by the wakeup latency of the kernel. A frame that is late
+ *         is sent as soon as possible, without moving the schedule of the
+ *         frames after it.
+ *
+ *         The records are read in place from the trace, and the page of a
+ *         record PREFETCH_RECORDS ahead is touched before waiting, so page
+ *         faults in the mapping are taken while there is time to spare.
+ *
+ *         The drift of each send from its schedule (the time between when
+ *         the frame was due and when the Tx buffer of the controller was
+ *         written) is collected in a log-linear histogram.
+ *
+ *         The clock is a policy, SteadyClock for real time, or e.g. the
+ *         time of a simulated bus (see canola_replay.cpp).
+ */
+
+#ifndef CANOLA_REPLAY_HPP
+#define CANOLA_REPLAY_HPP
+
+#include "canola.hpp"
+#include "canola_bit_timing.hpp"
+#include "canola_stuff.hpp"
+#include "canola_trace.hpp"
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+
+namespace canola
+{
+namespace replay
+{
+
+constexpr uint64_t SPIN_NS_DEFAULT  = 100000;
+constexpr uint64_t PREFETCH_RECORDS = 256;    // 8 kB ahead
+
+enum class Mode {
+  ORIGINAL,   // Timing of the recording
+  SCALED,     // Timing of the recording times Options::scale
+  AS_FAST_AS_POSSIBLE
+};
+
+struct Options {
+  Mode mode = Mode::ORIGINAL;
+
+  // Mode::SCALED: 2.0 replays at half the speed, 0.5 at twice the speed
+  double scale = 1.0;
+
+  // Bit rate of the recorded bus, for the start of frame of the records.
+  // 0 to schedule by the recorded times as they are.
+  double bit_rate = BIT_RATE_DEFAULT;
+
+  // Spin instead of sleeping for the last spin_ns before a frame is due
+  uint64_t spin_ns = SPIN_NS_DEFAULT;
+
+  // Replay records of frames the recorded controller sent (Tx) and/or
+  // received (Rx). A recording of several controllers on the same bus has
+  // each frame once as Tx and once more per receiver.
+  bool replay_tx = true;
+  bool replay_rx = true;
+};
+
+
+/**
+ * Monotonic clock of the host (CLOCK_MONOTONIC, the same clock as
+ * trace::now_ns())
+ */
+class SteadyClock
+{
+public:
+  uint64_t now() const { return trace::now_ns(); }
+
+  void sleep_until(uint64_t time_ns)
+  {
+    struct timespec ts;
+    ts.tv_sec = time_t(time_ns / 1000000000);
+    ts.tv_nsec = long(time_ns % 1000000000);
+    while(::clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR)
+      ;
+  }
+
+  void spin()
+  {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__arm__) || defined(__aarch64__)
+    __asm__ volatile("yield");
+#endif
+  }
+};
+
+
+/**
+ * Histogram of drift in ns, with 16 buckets per power of two (a percentile
+ * is within about 6 %). Drifts of 2^32 ns (4.3 s) or more are counted in
+ * the last bucket.
+ */
+class DriftStats
+{
+public:
+  static constexpr unsigned int SUB_BITS = 4;
+  static constexpr unsigned int SUB_COUNT = 1u << SUB_BITS;
+  static constexpr unsigned int BUCKETS = (32 - SUB_BITS + 1) * SUB_COUNT;
+
+  void reset() { *this = DriftStats(); }
+
+  void record(uint64_t drift_ns)
+  {
+    const uint32_t value = drift_ns > 0xFFFFFFFFu ? 0xFFFFFFFFu : uint32_t(drift_ns);
+
+    m_buckets[bucket(value)]++;
+    m_count++;
+    m_sum += drift_ns;
+    if(drift_ns < m_min)
+      m_min = drift_ns;
+    if(drift_ns > m_max)
+      m_max = drift_ns;
+  }
+
+  uint64_t count() const { return m_count; }
+  uint64_t min() const { return m_count > 0 ? m_min : 0; }
+  uint64_t max() const { return m_max; }
+  double mean() const { return m_count > 0 ? double(m_sum) / m_count : 0.0; }
+
+  // Drift that percentile (0 to 100) of the sends are at or below
+  uint64_t percentile(double percentile) const
+  {
+    if(m_count == 0)
+      return 0;
+
+    uint64_t rank = uint64_t(percentile / 100.0 * m_count + 0.999999);
+    if(rank == 0)
+      rank = 1;
+
+    uint64_t seen = 0;
+    for(unsigned int i = 0; i < BUCKETS; i++) {
+      seen += m_buckets[i];
+      if(seen >= rank) {
+        const uint64_t value = bucket_value(i);
+        // Exact at the ends
+        return value < m_min ? m_min : value > m_max ? m_max : value;
+      }
+    }
+
+    return m_max;
+  }
+
+private:
+  static unsigned int bucket(uint32_t value)
+  {
+    if(value < SUB_COUNT)
+      return value;
+
+    const unsigned int msb = 31 - __builtin_clz(value);
+    const unsigned int sub = (value >> (msb - SUB_BITS)) & (SUB_COUNT - 1);
+    return (msb - SUB_BITS + 1) * SUB_COUNT + sub;
+  }
+
+  // Midpoint of the values in a bucket
+  static uint64_t bucket_value(unsigned int bucket)
+  {
+    if(bucket < SUB_COUNT)
+      return bucket;
+
+    const unsigned int shift = bucket / SUB_COUNT - 1;
+    const uint64_t lowest = uint64_t(SUB_COUNT + bucket % SUB_COUNT) << shift;
+    return lowest + (((uint64_t(1) << shift) - 1) >> 1);
+  }
+
+  uint64_t m_buckets[BUCKETS] = {};
+  uint64_t m_count = 0;
+  uint64_t m_sum = 0;
+  uint64_t m_min = UINT64_MAX;
+  uint64_t m_max = 0;
+};
+
+
+/**
+ * Sends the records of a trace with controllers. Each recorded controller
+ * index is mapped to a controller with map(), records of controllers that
+ * are not mapped are skipped.
+ */
+template <typename RegisterIO, typename Clock = SteadyClock>
+class Replayer
+{
+public:
+  explicit Replayer(const Options& options = Options(), Clock clock = Clock())
+    : m_options(options), m_clock(clock) {}
+
+  Options& options() { return m_options; }
+  Clock& clock() { return m_clock; }
+
+  void map(unsigned int recorded_controller, Canola<RegisterIO>& can)
+  {
+    m_targets[recorded_controller & 0xFF] = &can;
+  }
+
+  /**
+   * Replay count records. Returns the number of frames sent, which is
+   * less than count if records were skipped or stop() was called.
+   */
+  uint64_t run(const trace::Record* records, uint64_t count)
+  {
+    const bool timed = m_options.mode != Mode::AS_FAST_AS_POSSIBLE;
+    const double scale = m_options.mode == Mode::SCALED ? m_options.scale : 1.0;
+    const double bit_ns = m_options.bit_rate > 0.0 ? 1e9 / m_options.bit_rate : 0.0;
+
+    Canola<RegisterIO>* prev = nullptr;
+    uint64_t start_ns = 0;
+    int64_t first_sof_ns = 0;
+
+    m_sent = 0;
+    m_skipped = 0;
+    m_drift.reset();
+    m_stop.store(false, std::memory_order_relaxed);
+
+    for(uint64_t i = 0; i < count && !m_stop.load(std::memory_order_relaxed); i++) {
+      const trace::Record& rec = records[i];
+
+      if(i + PREFETCH_RECORDS < count)
+        m_sink = records[i + PREFETCH_RECORDS].time_ns;
+
+      Canola<RegisterIO>* can = target(rec);
+      if(can == nullptr) {
+        m_skipped++;
+        continue;
+      }
+
+      const CanMsg msg = trace::to_msg(rec);
+      const int64_t sof_ns = int64_t(rec.time_ns) - int64_t(frame_length(msg) * bit_ns + 0.5);
+      uint64_t due_ns = 0;
+
+      if(prev == nullptr) {
+        start_ns = m_clock.now();
+        first_sof_ns = sof_ns;
+        due_ns = start_ns;
+      } else if(timed) {
+        // Records out of order are due at once
+        const int64_t offset_ns = sof_ns - first_sof_ns;
+        due_ns = start_ns + (offset_ns > 0 ? uint64_t(double(offset_ns) * scale + 0.5) : 0);
+        wait_until(due_ns);
+      } else {
+        // As fast as possible, but in the order of the recording: frames
+        // from different controllers would otherwise be reordered by
+        // arbitration
+        while(prev->is_busy())
+          m_clock.spin();
+      }
+
+      // The previous frame from the same controller may still be in the
+      // Tx buffer, e.g. when the bus was busier than in the recording
+      while(can->is_busy())
+        m_clock.spin();
+
+      const uint64_t sent_ns = m_clock.now();
+      can->send_msg_burst(msg);
+
+      if(timed && prev != nullptr)
+        m_drift.record(sent_ns - due_ns);
+
+      m_last_ns = sent_ns;
+      m_start_ns = start_ns;
+      m_sent++;
+      prev = can;
+    }
+
+    return m_sent;
+  }
+
+  uint64_t run(const trace::TraceReader& reader) { return run(reader.records(), reader.count()); }
+
+  // Stop run() (from another thread) before the next frame
+  void stop() { m_stop.store(true, std::memory_order_relaxed); }
+
+  uint64_t sent() const { return m_sent; }
+  uint64_t skipped() const { return m_skipped; }
+
+  // Time from the first to the last frame sent by run()
+  uint64_t duration_ns() const { return m_sent > 0 ? m_last_ns - m_start_ns : 0; }
+
+  // Drift of every frame sent except the first, for the timed modes
+  const DriftStats& drift() const { return m_drift; }
+
+private:
+  Canola<RegisterIO>* target(const trace::Record& rec) const
+  {
+    const bool tx = (rec.flags & trace::FLAG_TX) != 0;
+    if((tx && !m_options.replay_tx) || (!tx && !m_options.replay_rx))
+      return nullptr;
+    return m_targets[rec.controller];
+  }
+
+  void wait_until(uint64_t due_ns)
+  {
+    for(;;) {
+      const uint64_t now_ns = m_clock.now();
+      if(now_ns >= due_ns)
+        return;
+
+      if(due_ns - now_ns > m_options.spin_ns)
+        m_clock.sleep_until(due_ns - m_options.spin_ns);
+      else
+        m_clock.spin();
+    }
+  }
+
+  Options m_options;
+  Clock m_clock;
+  Canola<RegisterIO>* m_targets[256] = {};
+  std::atomic<bool> m_stop{false};
+  DriftStats m_drift;
+  uint64_t m_sent = 0;
+  uint64_t m_skipped = 0;
+  uint64_t m_start_ns = 0;
+  uint64_t m_last_ns = 0;
+  volatile uint64_t m_sink = 0;
+};
+
+} // namespace replay
+} // namespace canola
+
+#endif
@@ -0,0 +1,688 @@
+/**
+ * @file   canola_seu.hpp
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Single event upset (SEU) fault injection in the bit-level model of
+ *         the Canola CAN controller, with and without TMR.
+ *
+ *         TmrNode is three model::Node replicas, the way canola_top_tmr
+ *         triplicates the blocks in the *_tmr_wrapper entities: the CAN_TX
+ *         output, the events, the Rx message and the counters are voted,
+ *         and the registers with a triple-output voter (FSM states, CRCs,
+ *         error counters and status counters, StateRegister::voted) are set
+ *         to the voted value after every bit. A flipped input of a
+ *         triple-output voter is the same as a flipped register in one
+ *         replica. Signals between the blocks inside a node are not voted in
+ *         the model, an upset in one replica can spread to the other blocks
+ *         of the same replica before the voted registers correct it.
+ *
+ *         A campaign runs the DUT (a Node or a TmrNode) on a bus with two
+ *         other nodes and random traffic. After a warm-up the bus is
+ *         checkpointed, and a fault-free (golden) run from the checkpoint
+ *         records the outputs of the DUT for each bit and a copy of the bus
+ *         every snapshot_interval bits. Each injection forks the snapshot
+ *         before the injection time, so at most snapshot_interval-1 bits are
+ *         replayed, flips one bit of one register (in one replica for TMR),
+ *         and runs until the outputs differ from the golden run (a failure),
+ *         the state is equal to the golden run again (masked) or the
+ *         observation window ends (latent, or a failure if a counter
+ *         differs). Checkpoints are independent, and are run on all cores
+ *         with sim::run_sharded().
+ *
+ *         A single upset can not make the TMR variant fail, unless it
+ *         hits a part that is not triplicated. Two upsets in different
+ *         replicas can, when the first one is still there when the second
+ *         one hits: registers that are voted every cycle are corrected after
+ *         one bit, the others stay wrong until they are overwritten.
+ *
+ *         Upsets are injected between two bits. Acceptance filters, Rx FIFO,
+ *         Tx mailboxes and the AXI-slave are not included, they are not
+ *         triplicated in either variant.
+ */
+
+#ifndef CANOLA_SEU_HPP
+#define CANOLA_SEU_HPP
+
+#include "canola.hpp"
+#include "canola_model.hpp"
+#include "canola_sim.hpp"
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace canola
+{
+namespace seu
+{
+
+//-----------------------------------------------------------------------------
+// Operations on a register, for each type of register in model::Node
+//-----------------------------------------------------------------------------
+inline void flip_bit(bool& value, unsigned int)
+{
+  value = !value;
+}
+
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value>::type flip_bit(T& value, unsigned int bit)
+{
+  value = T(value ^ (T(1) << bit));
+}
+
+template <typename T>
+typename std::enable_if<std::is_enum<T>::value>::type flip_bit(T& value, unsigned int bit)
+{
+  using U = typename std::underlying_type<T>::type;
+  value = T(U(U(value) ^ (U(1) << bit)));
+}
+
+// Bits in the order of the fields of can_msg_t
+inline void flip_bit(CanMsg& msg, unsigned int bit)
+{
+  if(bit < model::ID_A_LENGTH)
+    return flip_bit(msg.arb_id_a, bit);
+  bit -= model::ID_A_LENGTH;
+
+  if(bit < model::ID_B_LENGTH)
+    return flip_bit(msg.arb_id_b, bit);
+  bit -= model::ID_B_LENGTH;
+
+  if(bit == 0)
+    return flip_bit(msg.remote_frame, 0);
+  if(bit == 1)
+    return flip_bit(msg.ext_id, 0);
+  bit -= 2;
+
+  if(bit < model::DLC_LENGTH)
+    return flip_bit(msg.data_length, bit);
+  bit -= model::DLC_LENGTH;
+
+  flip_bit(msg.payload[bit / 8], bit % 8);
+}
+
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value, T>::type majority(T a, T b, T c)
+{
+  return T((a & b) | (a & c) | (b & c));
+}
+
+template <typename T>
+typename std::enable_if<std::is_enum<T>::value, T>::type majority(T a, T b, T c)
+{
+  using U = typename std::underlying_type<T>::type;
+  return T(majority(U(a), U(b), U(c)));
+}
+
+inline CanMsg majority(const CanMsg& a, const CanMsg& b, const CanMsg& c)
+{
+  CanMsg msg;
+  msg.arb_id_a = majority(a.arb_id_a, b.arb_id_a, c.arb_id_a);
+  msg.arb_id_b = majority(a.arb_id_b, b.arb_id_b, c.arb_id_b);
+  msg.remote_frame = majority(a.remote_frame, b.remote_frame, c.remote_frame);
+  msg.ext_id = majority(a.ext_id, b.ext_id, c.ext_id);
+  msg.data_length = majority(a.data_length, b.data_length, c.data_length);
+  for(unsigned int i = 0; i < 8; i++)
+    msg.payload[i] = majority(a.payload[i], b.payload[i], c.payload[i]);
+  return msg;
+}
+
+template <typename T>
+bool same(const T& a, const T& b)
+{
+  return a == b;
+}
+
+inline bool same(const CanMsg& a, const CanMsg& b)
+{
+  if(a.arb_id_a != b.arb_id_a || a.arb_id_b != b.arb_id_b || a.remote_frame != b.remote_frame ||
+     a.ext_id != b.ext_id || a.data_length != b.data_length)
+    return false;
+
+  for(unsigned int i = 0; i < 8; i++) {
+    if(a.payload[i] != b.payload[i])
+      return false;
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+// Operations on all registers of a node
+//-----------------------------------------------------------------------------
+inline std::vector<model::StateRegister> state_registers()
+{
+  std::vector<model::StateRegister> regs;
+  model::Node::for_each_register([&](const model::StateRegister& reg, auto) {
+    regs.push_back(reg);
+  });
+  return regs;
+}
+
+/**
+ * Flip one bit of a register, index is the position of the register in
+ * state_registers()
+ */
+inline void flip_register_bit(model::Node& node, unsigned int index, unsigned int bit)
+{
+  unsigned int i = 0;
+  model::Node::for_each_register([&](const model::StateRegister&, auto get) {
+    if(i++ == index)
+      flip_bit(get(node), bit);
+  });
+  node.settle_states();
+}
+
+inline bool same_state(const model::Node& a, const model::Node& b)
+{
+  bool equal = true;
+  model::Node::for_each_register([&](const model::StateRegister&, auto get) {
+    equal = equal && same(get(a), get(b));
+  });
+  return equal;
+}
+
+/**
+ * Three replicas of a node, see the description at the top of the file
+ */
+class TmrNode
+{
+public:
+  static constexpr unsigned int REPLICAS = 3;
+
+  explicit TmrNode(unsigned int retransmit_count_max = model::RETRANSMIT_COUNT_MAX_DEFAULT)
+    : m_replicas{{model::Node(retransmit_count_max), model::Node(retransmit_count_max),
+                  model::Node(retransmit_count_max)}}
+  {
+  }
+
+  bool start_tx(const CanMsg& msg)
+  {
+    const bool started_0 = m_replicas[0].start_tx(msg);
+    const bool started_1 = m_replicas[1].start_tx(msg);
+    const bool started_2 = m_replicas[2].start_tx(msg);
+    return majority(started_0, started_1, started_2);
+  }
+
+  void set_tx_retransmit_en(bool enable)
+  {
+    for(model::Node& node : m_replicas)
+      node.set_tx_retransmit_en(enable);
+  }
+
+  bool tx_bit() const
+  {
+    return majority(m_replicas[0].tx_bit(), m_replicas[1].tx_bit(), m_replicas[2].tx_bit());
+  }
+
+  void rx_bit(bool bit)
+  {
+    for(model::Node& node : m_replicas)
+      node.rx_bit(bit);
+
+    model::Node::for_each_register([&](const model::StateRegister& reg, auto get) {
+      if(reg.voted) {
+        const auto voted = majority(get(m_replicas[0]), get(m_replicas[1]), get(m_replicas[2]));
+        get(m_replicas[0]) = voted;
+        get(m_replicas[1]) = voted;
+        get(m_replicas[2]) = voted;
+      }
+    });
+  }
+
+  uint32_t events() const
+  {
+    return majority(m_replicas[0].events(), m_replicas[1].events(), m_replicas[2].events());
+  }
+
+  bool tx_busy() const
+  {
+    return majority(m_replicas[0].tx_busy(), m_replicas[1].tx_busy(), m_replicas[2].tx_busy());
+  }
+
+  CanMsg rx_msg() const
+  {
+    return majority(m_replicas[0].rx_msg(), m_replicas[1].rx_msg(), m_replicas[2].rx_msg());
+  }
+
+  uint32_t counter(Counter counter) const
+  {
+    return majority(m_replicas[0].counter(counter), m_replicas[1].counter(counter),
+                    m_replicas[2].counter(counter));
+  }
+
+  unsigned int transmit_error_count() const
+  {
+    return majority(m_replicas[0].transmit_error_count(), m_replicas[1].transmit_error_count(),
+                    m_replicas[2].transmit_error_count());
+  }
+
+  unsigned int receive_error_count() const
+  {
+    return majority(m_replicas[0].receive_error_count(), m_replicas[1].receive_error_count(),
+                    m_replicas[2].receive_error_count());
+  }
+
+  // True when no replica differs from the others
+  bool replicas_agree() const
+  {
+    return same_state(m_replicas[0], m_replicas[1]) && same_state(m_replicas[0], m_replicas[2]);
+  }
+
+  model::Node& replica(unsigned int index) { return m_replicas[index]; }
+  const model::Node& replica(unsigned int index) const { return m_replicas[index]; }
+
+private:
+  std::array<model::Node, REPLICAS> m_replicas;
+};
+
+inline bool same_state(const TmrNode& a, const TmrNode& b)
+{
+  for(unsigned int i = 0; i < TmrNode::REPLICAS; i++) {
+    if(!same_state(a.replica(i), b.replica(i)))
+      return false;
+  }
+  return true;
+}
+
+inline unsigned int replicas(const model::Node&) { return 1; }
+inline unsigned int replicas(const TmrNode&) { return TmrNode::REPLICAS; }
+
+inline model::Node& replica(model::Node& node, unsigned int) { return node; }
+inline model::Node& replica(TmrNode& node, unsigned int index) { return node.replica(index); }
+
+inline bool replicas_agree(const model::Node&) { return true; }
+inline bool replicas_agree(const TmrNode& node) { return node.replicas_agree(); }
+
+/**
+ * Counters that software can read from the controller
+ */
+template <typename DutA, typename DutB>
+bool same_counters(const DutA& a, const DutB& b)
+{
+  static const Counter counters[] = {
+    Counter::TX_MSG_SENT, Counter::TX_FAILED, Counter::TX_ACK_ERROR, Counter::TX_ARB_LOST,
+    Counter::TX_BIT_ERROR, Counter::TX_RETRANSMIT, Counter::RX_MSG_RECV, Counter::RX_CRC_ERROR,
+    Counter::RX_FORM_ERROR, Counter::RX_STUFF_ERROR
+  };
+
+  for(Counter counter : counters) {
+    if(a.counter(counter) != b.counter(counter))
+      return false;
+  }
+
+  return a.transmit_error_count() == b.transmit_error_count() &&
+    a.receive_error_count() == b.receive_error_count();
+}
+
+//-----------------------------------------------------------------------------
+// Campaign
+//-----------------------------------------------------------------------------
+
+// splitmix64, for random numbers that only depend on a seed and a position
+inline uint64_t mix(uint64_t x)
+{
+  x += 0x9E3779B97F4A7C15ull;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+  return x ^ (x >> 31);
+}
+
+// Hash of the fields of a received message that are valid
+inline uint64_t msg_hash(const CanMsg& msg)
+{
+  uint64_t hash = mix(msg.arb_id_a | uint64_t(msg.ext_id ? msg.arb_id_b : 0) << 11 |
+                      uint64_t(msg.ext_id) << 29 | uint64_t(msg.remote_frame) << 30 |
+                      uint64_t(msg.data_length) << 32);
+
+  if(!msg.remote_frame) {
+    for(unsigned int i = 0; i < msg.data_length && i < 8; i++)
+      hash = mix(hash ^ msg.payload[i]);
+  }
+  return hash;
+}
+
+/**
+ * Outputs of the DUT during one bit
+ */
+struct BitOutput {
+  bool tx_bit;
+  uint32_t events;
+  uint64_t rx_msg_hash;  // 0 without EVENT_RX_MSG_VALID
+
+  bool operator==(const BitOutput& other) const
+  {
+    return tx_bit == other.tx_bit && events == other.events && rx_msg_hash == other.rx_msg_hash;
+  }
+};
+
+/**
+ * The DUT and two other nodes on a bus. A node that is not busy starts a
+ * random message with probability 1/TRAFFIC_PERIOD per bit. The traffic only
+ * depends on the seed, the bit number and whether the nodes are busy, so a
+ * copy of a Scenario continues exactly like the original.
+ */
+template <typename Dut>
+class Scenario
+{
+public:
+  static constexpr unsigned int NODES = 3;  // The DUT is node 0
+  static constexpr unsigned int TRAFFIC_PERIOD = 256;
+
+  explicit Scenario(uint64_t seed)
+    : m_seed(seed)
+  {
+    m_dut.set_tx_retransmit_en(true);
+    for(model::Node& node : m_nodes)
+      node.set_tx_retransmit_en(true);
+  }
+
+  BitOutput step()
+  {
+    const uint64_t r = mix(m_seed ^ mix(m_bit));
+
+    for(unsigned int i = 0; i < NODES; i++) {
+      if(((r >> (16 * i)) & 0xFFFF) % TRAFFIC_PERIOD != 0)
+        continue;
+
+      if(i == 0 && !m_dut.tx_busy())
+        m_dut.start_tx(random_msg(r + i, i));
+      else if(i > 0 && !m_nodes[i-1].tx_busy())
+        m_nodes[i-1].start_tx(random_msg(r + i, i));
+    }
+
+    bool bit = m_dut.tx_bit();
+    for(const model::Node& node : m_nodes)
+      bit = bit && node.tx_bit();
+
+    m_dut.rx_bit(bit);
+    for(model::Node& node : m_nodes)
+      node.rx_bit(bit);
+
+    m_bit++;
+
+    BitOutput out;
+    out.tx_bit = m_dut.tx_bit();
+    out.events = m_dut.events();
+    out.rx_msg_hash = (out.events & model::EVENT_RX_MSG_VALID) ? msg_hash(m_dut.rx_msg()) : 0;
+    return out;
+  }
+
+  void run(uint64_t bits)
+  {
+    for(uint64_t i = 0; i < bits; i++)
+      step();
+  }
+
+  Dut& dut() { return m_dut; }
+  const Dut& dut() const { return m_dut; }
+  uint64_t bit_count() const { return m_bit; }
+
+private:
+  // The two low bits of ID A are the node number, no two nodes send the same ID
+  static CanMsg random_msg(uint64_t seed, unsigned int node)
+  {
+    const uint64_t r = mix(seed);
+    CanMsg msg = CanMsg{};
+    msg.ext_id = r & 1;
+    msg.remote_frame = ((r >> 1) & 0xF) == 0;
+    msg.arb_id_a = ((r >> 8) & 0x7FC) | node;
+    msg.arb_id_b = msg.ext_id ? (r >> 20) & 0x3FFFF : 0;
+    msg.data_length = (r >> 40) % 9;
+
+    const uint64_t payload = mix(r);
+    for(unsigned int i = 0; i < 8; i++)
+      msg.payload[i] = i < msg.data_length && !msg.remote_frame ? uint8_t(payload >> (8 * i)) : 0;
+    return msg;
+  }
+
+  Dut m_dut;
+  std::array<model::Node, NODES-1> m_nodes;
+  uint64_t m_seed;
+  uint64_t m_bit = 0;
+};
+
+enum Outcome {
+  MASKED,        // State equal to the golden run again
+  LATENT,        // State still differs at the end of the observation window
+  FAIL_BUS,      // DUT drove a different bit on the bus
+  FAIL_EVENT,    // Different events (interrupts, status) from the DUT
+  FAIL_DATA,     // DUT received a different message
+  FAIL_COUNTER,  // Counters readable by software differ at the end of the window
+  OUTCOME_COUNT
+};
+
+inline const char* outcome_name(Outcome outcome)
+{
+  static const char* const names[] = {"masked", "latent", "bus", "event", "data", "counter"};
+  return names[outcome];
+}
+
+struct CampaignConfig {
+  uint64_t injections = 1000000;
+  unsigned int checkpoints = 64;            // Independent warm-ups, run in parallel
+  unsigned int warmup_bits = 20000;         // Bits from reset to checkpoint
+  unsigned int injection_bits = 2048;       // Injection times, bits after the checkpoint
+  unsigned int observation_bits = 4096;     // Bits after the injection
+  unsigned int snapshot_interval = 16;      // Bits between the golden run copies
+  unsigned int upsets = 1;                  // Upsets per injection, 1 or 2
+  unsigned int upset_spacing = 1024;        // Maximum bits between two upsets
+  unsigned int threads = 0;                 // 0 for one per core
+  uint64_t seed = 1;
+};
+
+/**
+ * One bit flip, time is counted in bits from the checkpoint
+ */
+struct Upset {
+  unsigned int time;
+  unsigned int replica;
+  unsigned int reg;
+  unsigned int bit;
+};
+
+struct RegisterResult {
+  model::StateRegister reg;
+  unsigned int replicas;
+  uint64_t injections = 0;
+  uint64_t outcomes[OUTCOME_COUNT] = {};
+  uint64_t masked_bits = 0;  // Sum of the bits until masked, for the masked injections
+
+  uint64_t failures() const
+  {
+    return outcomes[FAIL_BUS] + outcomes[FAIL_EVENT] + outcomes[FAIL_DATA] + outcomes[FAIL_COUNTER];
+  }
+
+  double failure_rate() const { return injections ? double(failures()) / injections : 0.0; }
+
+  /**
+   * Cross-section in units of the cross-section of one flip-flop: the
+   * number of bits of the register (in all replicas) that lead to a failure
+   * when hit
+   */
+  double cross_section() const { return failure_rate() * reg.width * replicas; }
+
+  double mean_masked_bits() const
+  {
+    return outcomes[MASKED] ? double(masked_bits) / outcomes[MASKED] : 0.0;
+  }
+
+  void add(const RegisterResult& other)
+  {
+    injections += other.injections;
+    for(unsigned int i = 0; i < OUTCOME_COUNT; i++)
+      outcomes[i] += other.outcomes[i];
+    masked_bits += other.masked_bits;
+  }
+};
+
+/**
+ * Golden run from a checkpoint, and injections that fork from it
+ */
+template <typename Dut>
+class Checkpoint
+{
+public:
+  Checkpoint(const Scenario<Dut>& scenario, const CampaignConfig& config)
+    : m_config(config)
+  {
+    const unsigned int interval = config.snapshot_interval;
+    const unsigned int length = config.injection_bits + config.observation_bits + interval;
+    Scenario<Dut> golden = scenario;
+
+    m_trace.reserve(length);
+    for(unsigned int i = 0; i < length; i++) {
+      if(i % interval == 0)
+        m_snapshots.push_back(golden);
+      m_trace.push_back(golden.step());
+    }
+    m_snapshots.push_back(golden);
+  }
+
+  /**
+   * Inject the upsets (sorted by time, at most two) into the DUT, returns
+   * the outcome and for masked upsets the number of bits from the first
+   * upset until the state was equal to the golden run again
+   */
+  Outcome inject(const Upset* upsets, unsigned int num_upsets, unsigned int& masked_bits) const
+  {
+    const unsigned int interval = m_config.snapshot_interval;
+    const unsigned int time = upsets[0].time;
+    Scenario<Dut> s = m_snapshots[time / interval];
+    unsigned int t = time - time % interval;
+
+    for(; t < time; t++)
+      s.step();
+
+    const unsigned int end = (time + m_config.observation_bits) / interval * interval;
+
+    unsigned int next_upset = 0;
+
+    for(; t < end; t++) {
+      for(; next_upset < num_upsets && upsets[next_upset].time == t; next_upset++) {
+        const Upset& upset = upsets[next_upset];
+        flip_register_bit(replica(s.dut(), upset.replica), upset.reg, upset.bit);
+      }
+
+      // With TMR the good replicas follow the golden run as long as the
+      // outputs do, the state is masked when the replicas agree again
+      const bool masked = replicas(s.dut()) > 1 ? replicas_agree(s.dut()) :
+        t % interval == 0 && same_state(s.dut(), m_snapshots[t / interval].dut());
+
+      if(masked && next_upset == num_upsets) {
+        masked_bits = t - time;
+        return MASKED;
+      }
+
+      const BitOutput out = s.step();
+      const BitOutput& golden = m_trace[t];
+
+      if(out == golden)
+        continue;
+      else if(out.rx_msg_hash && golden.rx_msg_hash && out.rx_msg_hash != golden.rx_msg_hash)
+        return FAIL_DATA;
+      else if(out.tx_bit != golden.tx_bit)
+        return FAIL_BUS;
+      else
+        return FAIL_EVENT;
+    }
+
+    if(!same_counters(s.dut(), m_snapshots[end / interval].dut()))
+      return FAIL_COUNTER;
+    else if(same_state(s.dut(), m_snapshots[end / interval].dut()))
+      return MASKED;
+    return LATENT;
+  }
+
+  const Scenario<Dut>& snapshot(unsigned int index) const { return m_snapshots[index]; }
+  const std::vector<BitOutput>& trace() const { return m_trace; }
+
+private:
+  const CampaignConfig& m_config;
+  std::vector<Scenario<Dut>> m_snapshots;
+  std::vector<BitOutput> m_trace;
+};
+
+/**
+ * Run a campaign with Dut (model::Node or TmrNode), returns the results per
+ * register in the order of state_registers(). Injections are spread evenly
+ * over the registers, and uniformly over the bits and replicas of a register
+ * and the injection times.
+ *
+ * With two upsets per injection the second upset hits a random bit of all
+ * registers, in another replica for TMR, up to upset_spacing bits after the
+ * first. The result is counted for the register of the first upset.
+ */
+template <typename Dut>
+std::vector<RegisterResult> run_campaign(const CampaignConfig& config)
+{
+  const std::vector<model::StateRegister> regs = state_registers();
+  const unsigned int num_regs = regs.size();
+  const unsigned int num_replicas = replicas(Dut());
+
+  std::vector<RegisterResult> results(num_regs);
+  for(unsigned int i = 0; i < num_regs; i++) {
+    results[i].reg = regs[i];
+    results[i].replicas = num_replicas;
+  }
+
+  unsigned int total_width = 0;
+  for(const model::StateRegister& reg : regs)
+    total_width += reg.width;
+
+  std::mutex results_mutex;
+
+  sim::run_sharded(config.checkpoints, [&](unsigned int index) {
+    const uint64_t seed = mix(config.seed * config.checkpoints + index);
+    const uint64_t first = config.injections * index / config.checkpoints;
+    const uint64_t last = config.injections * (index + 1) / config.checkpoints;
+
+    Scenario<Dut> scenario(seed);
+    scenario.run(config.warmup_bits);
+    const Checkpoint<Dut> checkpoint(scenario, config);
+
+    std::vector<RegisterResult> local(num_regs);
+
+    for(uint64_t n = first; n < last; n++) {
+      const uint64_t r = mix(seed ^ mix(n));
+      Upset upsets[2];
+      const unsigned int reg = n % num_regs;
+      upsets[0].reg = reg;
+      upsets[0].bit = (r & 0xFFFF) % regs[reg].width;
+      upsets[0].replica = ((r >> 16) & 0xFFFF) % num_replicas;
+      upsets[0].time = (r >> 32) % config.injection_bits;
+
+      if(config.upsets > 1) {
+        const uint64_t r2 = mix(r);
+        unsigned int bit = (r2 & 0xFFFFFFFF) % total_width;
+        unsigned int reg2 = 0;
+        while(bit >= regs[reg2].width)
+          bit -= regs[reg2++].width;
+
+        upsets[1].reg = reg2;
+        upsets[1].bit = bit;
+        upsets[1].replica = num_replicas > 1 ?
+          (upsets[0].replica + 1 + (r2 >> 32) % (num_replicas - 1)) % num_replicas : 0;
+        upsets[1].time = upsets[0].time + (r2 >> 48) % config.upset_spacing;
+      }
+
+      unsigned int masked_bits = 0;
+      const Outcome outcome = checkpoint.inject(upsets, config.upsets > 1 ? 2 : 1, masked_bits);
+
+      local[reg].injections++;
+      local[reg].outcomes[outcome]++;
+      local[reg].masked_bits += masked_bits;
+    }
+
+    std::lock_guard<std::mutex> lock(results_mutex);
+    for(unsigned int i = 0; i < num_regs; i++)
+      results[i].add(local[i]);
+  }, config.threads);
+
+  return results;
+}
+
+} // namespace seu
+} // namespace canola
+
+#endif
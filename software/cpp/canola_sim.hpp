@@ -0,0 +1,804 @@
+/**
+ * @file   canola_sim.hpp
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Simulated Canola controllers on a simulated CAN bus, with the
+ *         register interface of canola_axi_slave, so that the driver in
+ *         canola.hpp runs against them unmodified.
+ *
+ *         Controller is a model::Node (see canola_model.hpp) with the
+ *         registers, acceptance filters, Rx FIFO, Tx mailboxes, timestamp counter
+ *         and interrupt lines of canola_axi_slave.vhd around it. The AXI-slave
+ *         parts are modelled by behaviour and not cycle by cycle: register
+ *         writes take effect immediately, between two CAN bits.
+ *
+ *         SimIO is a RegisterIO policy for a Controller, use it with
+ *         Canola<SimIO>. Bus connects any number of controllers with a
+ *         wired-AND bus, and calls an interrupt handler for a controller
+ *         after each bit that pulsed one of its interrupt lines. The driver
+ *         code (in the interrupt handlers, or between calls to Bus::run())
+ *         takes no simulated time.
+ *
+ *         A bus is simulated by one thread. run_sharded() runs independent
+ *         buses (e.g. the same test with different seeds) on all cores.
+ */
+
+#ifndef CANOLA_SIM_HPP
+#define CANOLA_SIM_HPP
+
+#include "canola.hpp"
+#include "canola_model.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace canola
+{
+namespace sim
+{
+
+// Same as the constants in canola_pkg.vhd
+constexpr unsigned int ACCEPTANCE_FILTERS_MAX     = 256;
+constexpr unsigned int ACCEPTANCE_FILTERS_DEFAULT = 16;
+constexpr unsigned int RX_FIFO_DEPTH_MAX          = 256;
+constexpr unsigned int RX_FIFO_DEPTH_DEFAULT      = 16;
+constexpr unsigned int TX_MAILBOXES_MAX           = 32;
+constexpr unsigned int TX_MAILBOXES_DEFAULT       = 8;
+
+/**
+ * Generics of canola_axi_slave (and G_RETRANSMIT_COUNT_MAX of canola_top)
+ */
+struct Config {
+  unsigned int acceptance_filters   = ACCEPTANCE_FILTERS_DEFAULT;
+  unsigned int rx_fifo_depth        = RX_FIFO_DEPTH_DEFAULT;
+  unsigned int tx_mailboxes         = TX_MAILBOXES_DEFAULT;
+  unsigned int retransmit_count_max = model::RETRANSMIT_COUNT_MAX_DEFAULT;
+};
+
+/**
+ * Interrupt outputs of canola_axi_slave, pulsed for one bit
+ */
+enum Irq : uint32_t {
+  IRQ_RX_VALID  = 1 << 0,   // CAN_RX_VALID_IRQ
+  IRQ_TX_DONE   = 1 << 1,   // CAN_TX_DONE_IRQ
+  IRQ_TX_FAILED = 1 << 2    // CAN_TX_FAILED_IRQ
+};
+
+/**
+ * One canola_axi_slave
+ */
+class Controller
+{
+public:
+  explicit Controller(const Config& config = Config())
+    : m_config(config)
+    , m_node(config.retransmit_count_max)
+    , m_filters(std::min(config.acceptance_filters, ACCEPTANCE_FILTERS_MAX))
+    , m_mailbox_msgs(std::min(config.tx_mailboxes, TX_MAILBOXES_MAX))
+  {
+    m_config.rx_fifo_depth = std::max(1u, std::min(config.rx_fifo_depth, RX_FIFO_DEPTH_MAX));
+    m_rx_fifo_ram.resize(m_config.rx_fifo_depth, RxFifoEntry{CanMsg{}, 0, 0});
+    reset();
+  }
+
+  /**
+   * AXI_RESET. Like the RTL, the content of the filter, Rx FIFO and
+   * mailbox RAMs is not reset, only the enable and pending flags.
+   */
+  void reset()
+  {
+    m_node.reset();
+
+    m_regs.fill(0);
+    for(uint32_t address : reg::ALL_ADDRESSES)
+      m_regs[address / 4] = reset_value(address);
+    apply_config();
+
+    for(Filter& filter : m_filters)
+      filter.enable = false;
+    m_rx_filter_hit = 0;
+    m_rx_msg_recv_count = 0;
+    m_rx_msg_valid = false;
+    m_timestamp = 0;
+    m_rx_timestamp = 0;
+    m_tx_timestamp = 0;
+
+    rx_fifo_flush();
+    reset_mailboxes();
+    m_irqs = 0;
+  }
+
+  uint32_t read(uint32_t offset) const
+  {
+    switch(offset) {
+    case reg::STATUS::address:
+    {
+      // TX_DONE and TX_FAILED are not driven by the AXI slave
+      reg::STATUS::Value status{};
+      status.RX_MSG_VALID = rx_fifo_enabled() ? m_rx_fifo_count > 0 : m_rx_msg_valid;
+      status.TX_BUSY = m_node.tx_busy();
+      status.ERROR_STATE = static_cast<uint32_t>(m_node.error_state());
+      return reg::STATUS::pack(status);
+    }
+    case reg::TRANSMIT_ERROR_COUNT::address:
+      return m_node.transmit_error_count();
+    case reg::RECEIVE_ERROR_COUNT::address:
+      return m_node.receive_error_count();
+
+    case reg::TX_MSG_SENT_COUNT::address:
+    case reg::TX_FAILED_COUNT::address:
+    case reg::TX_ACK_ERROR_COUNT::address:
+    case reg::TX_ARB_LOST_COUNT::address:
+    case reg::TX_BIT_ERROR_COUNT::address:
+    case reg::TX_RETRANSMIT_COUNT::address:
+    case reg::RX_CRC_ERROR_COUNT::address:
+    case reg::RX_FORM_ERROR_COUNT::address:
+    case reg::RX_STUFF_ERROR_COUNT::address:
+      return m_node.counter(static_cast<Counter>(offset));
+    case reg::RX_MSG_RECV_COUNT::address:
+      // Only counts messages that passed the acceptance filter
+      return m_rx_msg_recv_count;
+
+    case reg::RX_MSG_ID::address:
+      return pack_msg_id(rx_msg());
+    case reg::RX_PAYLOAD_LENGTH::address:
+      return rx_msg().data_length;
+    case reg::RX_PAYLOAD_0::address:
+      return pack_payload(rx_msg().payload);
+    case reg::RX_PAYLOAD_1::address:
+      return pack_payload(rx_msg().payload + 4);
+    case reg::RX_FILTER_HIT::address:
+      return rx_fifo_enabled() ? m_rx_fifo_ram[m_rx_fifo_rd_ptr].filter_hit : m_rx_filter_hit;
+
+    case reg::RX_FIFO_STATUS::address:
+    {
+      reg::RX_FIFO_STATUS::Value fifo_status{};
+      fifo_status.FILL_LEVEL = m_rx_fifo_count;
+      fifo_status.EMPTY = m_rx_fifo_count == 0;
+      fifo_status.FULL = m_rx_fifo_count == m_config.rx_fifo_depth;
+      fifo_status.OVERFLOW = m_rx_fifo_overflow;
+      return reg::RX_FIFO_STATUS::pack(fifo_status);
+    }
+
+    case reg::TX_MAILBOX_PENDING::address:
+      return m_mailbox_pending;
+    case reg::TX_MAILBOX_DONE::address:
+      return m_mailbox_done;
+    case reg::TX_MAILBOX_FAILED::address:
+      return m_mailbox_failed;
+    case reg::TX_MAILBOX_COUNT::address:
+      return m_mailbox_msgs.size();
+
+    case reg::TIMESTAMP::address:
+      return m_timestamp;
+    case reg::RX_TIMESTAMP::address:
+      return rx_fifo_enabled() ? m_rx_fifo_ram[m_rx_fifo_rd_ptr].timestamp : m_rx_timestamp;
+    case reg::TX_TIMESTAMP::address:
+      return m_tx_timestamp;
+
+    case reg::CONTROL::address:
+    case reg::TX_MAILBOX_ABORT::address:
+      return 0;
+    }
+
+    return offset / 4 < m_regs.size() ? m_regs[offset / 4] : 0;
+  }
+
+  void write(uint32_t offset, uint32_t value)
+  {
+    switch(offset) {
+    case reg::CONTROL::address:
+      control(value);
+      break;
+
+    case reg::CONFIG::address:
+      m_regs[offset / 4] = value & reg::CONFIG::mask;
+      apply_config();
+      break;
+
+    case reg::TX_MAILBOX_ABORT::address:
+      if(mailboxes_enabled()) {
+        m_mailbox_abort_req |= value & m_mailbox_pending;
+        abort_mailboxes();
+        select_mailbox();
+      }
+      break;
+
+    default:
+      if(offset / 4 < m_regs.size() && writable(offset))
+        m_regs[offset / 4] = value & register_mask(offset);
+      break;
+    }
+  }
+
+  bool tx_bit() const { return m_node.tx_bit(); }
+
+  /**
+   * Process the bit on the bus, and update the AXI-slave parts with the
+   * pulses from the node
+   */
+  void rx_bit(bool bit)
+  {
+    // The timestamp counter counts clock cycles, at the current bit timing
+    m_timestamp += clocks_per_bit();
+
+    m_node.rx_bit(bit);
+
+    const uint32_t events = m_node.events();
+    m_irqs = 0;
+
+    if(events & model::EVENT_RX_MSG_VALID)
+      receive();
+
+    if(mailboxes_enabled())
+      update_mailboxes(events);
+
+    if(events & model::EVENT_TX_DONE) {
+      m_tx_timestamp = m_timestamp;
+      m_irqs |= IRQ_TX_DONE;
+    }
+    if(events & model::EVENT_TX_FAILED)
+      m_irqs |= IRQ_TX_FAILED;
+  }
+
+  // Interrupts pulsed during the last bit, combination of Irq
+  uint32_t irqs() const { return m_irqs; }
+
+  model::Node& node() { return m_node; }
+  const model::Node& node() const { return m_node; }
+  const Config& config() const { return m_config; }
+
+private:
+  struct Filter {
+    uint32_t id;
+    uint32_t mask;
+    bool enable;
+  };
+
+  static constexpr size_t REG_SPACE_SIZE = 0x100;
+
+  struct RxFifoEntry {
+    CanMsg msg;
+    uint32_t filter_hit;
+    uint32_t timestamp;
+  };
+
+  static uint32_t reset_value(uint32_t address)
+  {
+    switch(address) {
+    case reg::BTL_PROP_SEG::address:            return reg::BTL_PROP_SEG::reset;
+    case reg::BTL_PHASE_SEG1::address:          return reg::BTL_PHASE_SEG1::reset;
+    case reg::BTL_PHASE_SEG2::address:          return reg::BTL_PHASE_SEG2::reset;
+    case reg::BTL_SYNC_JUMP_WIDTH::address:     return reg::BTL_SYNC_JUMP_WIDTH::reset;
+    case reg::TIME_QUANTA_CLOCK_SCALE::address: return reg::TIME_QUANTA_CLOCK_SCALE::reset;
+    case reg::RX_FIFO_IRQ_LEVEL::address:       return reg::RX_FIFO_IRQ_LEVEL::reset;
+    }
+    return 0;
+  }
+
+  static uint32_t register_mask(uint32_t address)
+  {
+    switch(address) {
+    case reg::BTL_PROP_SEG::address:            return reg::BTL_PROP_SEG::mask;
+    case reg::BTL_PHASE_SEG1::address:          return reg::BTL_PHASE_SEG1::mask;
+    case reg::BTL_PHASE_SEG2::address:          return reg::BTL_PHASE_SEG2::mask;
+    case reg::BTL_SYNC_JUMP_WIDTH::address:     return reg::BTL_SYNC_JUMP_WIDTH::mask;
+    case reg::TIME_QUANTA_CLOCK_SCALE::address: return reg::TIME_QUANTA_CLOCK_SCALE::mask;
+    case reg::TX_MSG_ID::address:               return reg::TX_MSG_ID::mask;
+    case reg::TX_PAYLOAD_LENGTH::address:       return reg::TX_PAYLOAD_LENGTH::mask;
+    case reg::TX_PAYLOAD_0::address:            return reg::TX_PAYLOAD_0::mask;
+    case reg::TX_PAYLOAD_1::address:            return reg::TX_PAYLOAD_1::mask;
+    case reg::FILTER_INDEX::address:            return reg::FILTER_INDEX::mask;
+    case reg::FILTER_ID::address:               return reg::FILTER_ID::mask;
+    case reg::FILTER_MASK::address:             return reg::FILTER_MASK::mask;
+    case reg::RX_FIFO_IRQ_LEVEL::address:       return reg::RX_FIFO_IRQ_LEVEL::mask;
+    case reg::TX_MAILBOX_INDEX::address:        return reg::TX_MAILBOX_INDEX::mask;
+    }
+    return 0;
+  }
+
+  static bool writable(uint32_t address) { return register_mask(address) != 0; }
+
+  static uint32_t pack_msg_id(const CanMsg& msg)
+  {
+    reg::RX_MSG_ID::Value msg_id{};
+    msg_id.EXT_ID_EN = msg.ext_id;
+    msg_id.RTR_EN = msg.remote_frame;
+    msg_id.ARB_ID_B = msg.arb_id_b;
+    msg_id.ARB_ID_A = msg.arb_id_a;
+    return reg::RX_MSG_ID::pack(msg_id);
+  }
+
+  static uint32_t pack_payload(const uint8_t* bytes)
+  {
+    reg::RX_PAYLOAD_0::Value payload{};
+    payload.PAYLOAD_BYTE_0 = bytes[0];
+    payload.PAYLOAD_BYTE_1 = bytes[1];
+    payload.PAYLOAD_BYTE_2 = bytes[2];
+    payload.PAYLOAD_BYTE_3 = bytes[3];
+    return reg::RX_PAYLOAD_0::pack(payload);
+  }
+
+  uint32_t reg_value(uint32_t address) const { return m_regs[address / 4]; }
+
+  uint32_t clocks_per_bit() const
+  {
+    // The BTL segment registers are thermometer coded
+    const uint32_t quanta = 1 + __builtin_popcount(reg_value(reg::BTL_PROP_SEG::address)) +
+                            __builtin_popcount(reg_value(reg::BTL_PHASE_SEG1::address)) +
+                            __builtin_popcount(reg_value(reg::BTL_PHASE_SEG2::address));
+    return (reg_value(reg::TIME_QUANTA_CLOCK_SCALE::address) + 1) * quanta;
+  }
+
+  bool config_bit(uint32_t mask) const { return (reg_value(reg::CONFIG::address) & mask) != 0; }
+  bool rx_fifo_enabled() const { return config_bit(reg::CONFIG::RX_FIFO_EN::mask); }
+  bool mailboxes_enabled() const { return config_bit(reg::CONFIG::TX_MAILBOX_EN::mask); }
+
+  // The message in the TX registers (s_can_tx_msg in the AXI slave)
+  CanMsg tx_regs_msg() const
+  {
+    const uint32_t msg_id = reg_value(reg::TX_MSG_ID::address);
+    const uint32_t payload[2] = {reg_value(reg::TX_PAYLOAD_0::address),
+                                 reg_value(reg::TX_PAYLOAD_1::address)};
+    CanMsg msg;
+
+    msg.ext_id = reg::TX_MSG_ID::EXT_ID_EN::get(msg_id) != 0;
+    msg.remote_frame = reg::TX_MSG_ID::RTR_EN::get(msg_id) != 0;
+    msg.arb_id_a = reg::TX_MSG_ID::ARB_ID_A::get(msg_id);
+    msg.arb_id_b = reg::TX_MSG_ID::ARB_ID_B::get(msg_id);
+    msg.data_length = reg_value(reg::TX_PAYLOAD_LENGTH::address);
+
+    for(unsigned int i = 0; i < 8; i++)
+      msg.payload[i] = payload[i / 4] >> (8 * (i % 4));
+
+    return msg;
+  }
+
+  // The message in the RX registers, the head of the Rx FIFO when it is
+  // enabled (RD_MSG, also when it is empty), or else the Rx message
+  // register of the Rx FSM
+  const CanMsg& rx_msg() const
+  {
+    if(rx_fifo_enabled())
+      return m_rx_fifo_ram[m_rx_fifo_rd_ptr].msg;
+    return m_node.rx_msg();
+  }
+
+  void rx_fifo_flush()
+  {
+    m_rx_fifo_rd_ptr = 0;
+    m_rx_fifo_wr_ptr = 0;
+    m_rx_fifo_count = 0;
+    m_rx_fifo_overflow = false;
+  }
+
+  void apply_config()
+  {
+    m_node.set_tx_retransmit_en(config_bit(reg::CONFIG::TX_RETRANSMIT_EN::mask));
+    update_tx_msg_reload();
+
+    // The Rx FIFO is flushed and the mailboxes are held in reset while
+    // they are disabled, the single message RX_MSG_VALID is held cleared
+    // while the Rx FIFO is enabled
+    if(!rx_fifo_enabled())
+      rx_fifo_flush();
+    else
+      m_rx_msg_valid = false;
+
+    if(!mailboxes_enabled())
+      reset_mailboxes();
+    else
+      select_mailbox();
+  }
+
+  void control(uint32_t value)
+  {
+    const uint32_t reset_mask = value & RESET_ALL_COUNTERS;
+    if(reset_mask != 0) {
+      m_node.reset_counters(reset_mask);
+      if(reset_mask & RESET_RX_MSG_RECV)
+        m_rx_msg_recv_count = 0;
+    }
+
+    if(reg::CONTROL::FILTER_WRITE::get(value)) {
+      const uint32_t index = reg_value(reg::FILTER_INDEX::address);
+      const uint32_t filter_id = reg_value(reg::FILTER_ID::address);
+
+      if(index < m_filters.size()) {
+        m_filters[index] = {filter_id & ~reg::FILTER_ID::ENABLE::mask,
+                            reg_value(reg::FILTER_MASK::address),
+                            reg::FILTER_ID::ENABLE::get(filter_id) != 0};
+      }
+    }
+
+    if(reg::CONTROL::RX_FIFO_FLUSH::get(value)) {
+      rx_fifo_flush();
+    } else {
+      // Without the Rx FIFO, pop only clears RX_MSG_VALID
+      if(reg::CONTROL::RX_FIFO_POP::get(value) && !rx_fifo_enabled())
+        m_rx_msg_valid = false;
+
+      if(reg::CONTROL::RX_FIFO_POP::get(value) && m_rx_fifo_count > 0) {
+        m_rx_fifo_rd_ptr = (m_rx_fifo_rd_ptr + 1) % m_config.rx_fifo_depth;
+        m_rx_fifo_count--;
+      }
+      if(reg::CONTROL::RX_FIFO_CLEAR_OVERFLOW::get(value))
+        m_rx_fifo_overflow = false;
+    }
+
+    if(reg::CONTROL::TX_START::get(value) && !mailboxes_enabled())
+      m_node.start_tx(tx_regs_msg());
+
+    if(reg::CONTROL::TX_MAILBOX_LOAD::get(value) && mailboxes_enabled()) {
+      const uint32_t index = reg_value(reg::TX_MAILBOX_INDEX::address);
+      const uint32_t bit = uint32_t(1) << index;
+
+      if(index < m_mailbox_msgs.size() && (m_mailbox_pending & bit) == 0) {
+        m_mailbox_msgs[index] = tx_regs_msg();
+        m_mailbox_pending |= bit;
+        m_mailbox_done &= ~bit;
+        m_mailbox_failed &= ~bit;
+        m_mailbox_abort_req &= ~bit;
+        select_mailbox();
+      }
+    }
+  }
+
+  bool filter_match(const Filter& filter, uint32_t msg_id) const
+  {
+    return ((filter.id ^ msg_id) & filter.mask) == 0;
+  }
+
+  // Acceptance filter, Rx FIFO and Rx valid interrupt for a received message
+  void receive()
+  {
+    const CanMsg& msg = m_node.rx_msg();
+    bool accept = true;
+
+    if(!config_bit(reg::CONFIG::ACCEPTANCE_FILTER_EN::mask)) {
+      m_rx_filter_hit = 0;
+    } else {
+      // ID B is not part of standard frames, and may hold the ID B value
+      // of a previous extended frame
+      CanMsg filter_msg = msg;
+      if(!filter_msg.ext_id)
+        filter_msg.arb_id_b = 0;
+
+      const uint32_t msg_id = pack_msg_id(filter_msg);
+      accept = false;
+
+      for(size_t i = 0; i < m_filters.size(); i++) {
+        if(m_filters[i].enable && filter_match(m_filters[i], msg_id)) {
+          m_rx_filter_hit = i;
+          accept = true;
+          break;
+        }
+      }
+    }
+
+    if(!accept)
+      return;
+
+    if(m_rx_msg_recv_count != UINT32_MAX)
+      m_rx_msg_recv_count++;
+
+    m_rx_timestamp = m_timestamp;
+
+    if(!rx_fifo_enabled()) {
+      m_rx_msg_valid = true;
+      m_irqs |= IRQ_RX_VALID;
+      return;
+    }
+
+    if(m_rx_fifo_count == m_config.rx_fifo_depth) {
+      m_rx_fifo_overflow = true;
+      return;
+    }
+
+    m_rx_fifo_ram[m_rx_fifo_wr_ptr] = {msg, m_rx_filter_hit, m_timestamp};
+    m_rx_fifo_wr_ptr = (m_rx_fifo_wr_ptr + 1) % m_config.rx_fifo_depth;
+    m_rx_fifo_count++;
+
+    if(m_rx_fifo_count >= reg_value(reg::RX_FIFO_IRQ_LEVEL::address))
+      m_irqs |= IRQ_RX_VALID;
+  }
+
+  /**
+   * Priority of a message in a mailbox, lower value wins arbitration.
+   * Same as msg_priority() in canola_tx_mailboxes.vhd.
+   */
+  static uint32_t msg_priority(const CanMsg& msg)
+  {
+    if(msg.ext_id)
+      return (msg.arb_id_a << 21) | (3u << 19) | (msg.arb_id_b << 1) | msg.remote_frame;
+    else
+      return (msg.arb_id_a << 21) | (uint32_t(msg.remote_frame) << 20);
+  }
+
+  void reset_mailboxes()
+  {
+    m_mailbox_pending = 0;
+    m_mailbox_done = 0;
+    m_mailbox_failed = 0;
+    m_mailbox_abort_req = 0;
+    m_mailbox_active = false;
+    m_mailbox_in_flight = 0;
+    m_mailbox_selected = 0;
+    m_node.set_tx_abort(false);
+  }
+
+  // Abort pending mailboxes that the Tx FSM is not sending
+  void abort_mailboxes()
+  {
+    uint32_t abort = m_mailbox_abort_req & m_mailbox_pending;
+    if(m_mailbox_active)
+      abort &= ~(uint32_t(1) << m_mailbox_in_flight);
+
+    m_mailbox_pending &= ~abort;
+    m_mailbox_failed |= abort;
+    m_mailbox_abort_req &= ~abort;
+  }
+
+  /**
+   * Offer the highest priority pending mailbox to the Tx FSM. It is picked
+   * up on a retransmit (TX_MSG_RELOAD), or started if the Tx FSM is idle.
+   */
+  void select_mailbox()
+  {
+    const uint32_t candidates = m_mailbox_pending & ~m_mailbox_abort_req;
+    bool valid = false;
+    unsigned int best = 0;
+
+    for(unsigned int i = 0; i < m_mailbox_msgs.size(); i++) {
+      if((candidates & (uint32_t(1) << i)) &&
+         (!valid || msg_priority(m_mailbox_msgs[i]) < msg_priority(m_mailbox_msgs[best]))) {
+        best = i;
+        valid = true;
+      }
+    }
+
+    m_node.set_tx_abort(!valid);
+    if(!valid)
+      return;
+
+    m_node.set_tx_msg(m_mailbox_msgs[best]);
+    m_mailbox_selected = best;
+
+    if(!m_mailbox_active && !m_node.tx_busy() && m_node.start_tx(m_mailbox_msgs[best])) {
+      m_mailbox_active = true;
+      m_mailbox_in_flight = best;
+    }
+
+    update_tx_msg_reload();
+  }
+
+  // The Tx FSM only reloads the offered message (and restarts its retransmit
+  // attempts) when it is another mailbox than the one in flight
+  void update_tx_msg_reload()
+  {
+    m_node.set_tx_msg_reload(mailboxes_enabled() && m_mailbox_selected != m_mailbox_in_flight);
+  }
+
+  void update_mailboxes(uint32_t events)
+  {
+    // The Tx FSM reloaded the mailbox that was offered to it
+    if(events & model::EVENT_TX_RETRANSMITTING) {
+      m_mailbox_in_flight = m_mailbox_selected;
+      update_tx_msg_reload();
+    }
+
+    if(m_mailbox_active && (events & (model::EVENT_TX_DONE | model::EVENT_TX_FAILED))) {
+      const uint32_t bit = uint32_t(1) << m_mailbox_in_flight;
+
+      m_mailbox_active = false;
+      m_mailbox_pending &= ~bit;
+      m_mailbox_abort_req &= ~bit;
+      if(events & model::EVENT_TX_DONE)
+        m_mailbox_done |= bit;
+      else
+        m_mailbox_failed |= bit;
+    }
+
+    // The selection only changes when a mailbox is done, failed or aborted.
+    // A mailbox that was not started (bus off) is retried every bit.
+    if((events & (model::EVENT_TX_DONE | model::EVENT_TX_FAILED)) || m_mailbox_abort_req != 0 ||
+       (!m_mailbox_active && m_mailbox_pending != 0)) {
+      abort_mailboxes();
+      select_mailbox();
+    }
+  }
+
+  Config m_config;
+  model::Node m_node;
+
+  // RW registers, indexed by address/4
+  std::array<uint32_t, REG_SPACE_SIZE / 4> m_regs;
+
+  std::vector<Filter> m_filters;
+  uint32_t m_rx_filter_hit;
+  uint32_t m_rx_msg_recv_count;
+  bool m_rx_msg_valid;
+
+  uint32_t m_timestamp;
+  uint32_t m_rx_timestamp;
+  uint32_t m_tx_timestamp;
+
+  std::vector<RxFifoEntry> m_rx_fifo_ram;
+  unsigned int m_rx_fifo_rd_ptr;
+  unsigned int m_rx_fifo_wr_ptr;
+  uint32_t m_rx_fifo_count;
+  bool m_rx_fifo_overflow;
+
+  std::vector<CanMsg> m_mailbox_msgs;
+  uint32_t m_mailbox_pending;
+  uint32_t m_mailbox_done;
+  uint32_t m_mailbox_failed;
+  uint32_t m_mailbox_abort_req;
+  bool m_mailbox_active;
+  unsigned int m_mailbox_in_flight;
+  unsigned int m_mailbox_selected;
+
+  uint32_t m_irqs;
+};
+
+
+/**
+ * RegisterIO policy for a simulated controller. Does not own the
+ * controller, and can be copied freely.
+ */
+class SimIO
+{
+public:
+  explicit SimIO(Controller& controller) : m_controller(&controller) {}
+
+  uint32_t read(uint32_t offset) const
+  {
+    return m_controller->read(offset);
+  }
+
+  void write(uint32_t offset, uint32_t value)
+  {
+    m_controller->write(offset, value);
+  }
+
+  Controller& controller() const { return *m_controller; }
+
+private:
+  Controller* m_controller;
+};
+
+
+/**
+ * Controllers connected to the same CAN bus. Time on the bus is counted
+ * in bits, and converted to seconds with the bit rate.
+ */
+class Bus
+{
+public:
+  using IrqHandler = std::function<void(uint32_t irqs)>;
+
+  explicit Bus(double bit_rate = BIT_RATE_DEFAULT) : m_bit_rate(bit_rate) {}
+
+  /**
+   * Add a controller to the bus, and return its index. The controller
+   * stays at the same address for the lifetime of the bus.
+   */
+  unsigned int add(const Config& config = Config())
+  {
+    m_controllers.emplace_back(new Controller(config));
+    m_irq_handlers.emplace_back();
+    return m_controllers.size() - 1;
+  }
+
+  unsigned int size() const { return m_controllers.size(); }
+  Controller& controller(unsigned int index) { return *m_controllers[index]; }
+  SimIO io(unsigned int index) { return SimIO(*m_controllers[index]); }
+
+  /**
+   * handler(irqs) is called after each bit where controller index pulsed
+   * an interrupt, like an interrupt service routine
+   */
+  void set_irq_handler(unsigned int index, IrqHandler handler)
+  {
+    m_irq_handlers[index] = std::move(handler);
+  }
+
+  /**
+   * Run one bit, returns the bit value on the bus. ext_tx_bit is driven
+   * on the bus along with the controllers, e.g. to inject errors.
+   */
+  bool step(bool ext_tx_bit = true)
+  {
+    bool bit = ext_tx_bit;
+
+    for(const auto& controller : m_controllers)
+      bit = bit && controller->tx_bit();
+
+    for(const auto& controller : m_controllers)
+      controller->rx_bit(bit);
+
+    m_bit_count++;
+
+    for(size_t i = 0; i < m_controllers.size(); i++) {
+      if(m_controllers[i]->irqs() != 0 && m_irq_handlers[i])
+        m_irq_handlers[i](m_controllers[i]->irqs());
+    }
+
+    return bit;
+  }
+
+  void run(uint64_t num_bits)
+  {
+    for(uint64_t i = 0; i < num_bits; i++)
+      step();
+  }
+
+  void run_for(double seconds)
+  {
+    run(static_cast<uint64_t>(seconds * m_bit_rate + 0.5));
+  }
+
+  /**
+   * Run until done() returns true, checked before each bit, or for at
+   * most max_bits bits. Returns the value of done().
+   */
+  template <typename Predicate>
+  bool run_until(Predicate&& done, uint64_t max_bits = UINT64_MAX)
+  {
+    for(uint64_t i = 0; i < max_bits; i++) {
+      if(done())
+        return true;
+      step();
+    }
+    return done();
+  }
+
+  uint64_t bit_count() const { return m_bit_count; }
+  double bit_rate() const { return m_bit_rate; }
+
+  // Simulated time since the bus was created
+  double time() const { return m_bit_count / m_bit_rate; }
+
+private:
+  std::vector<std::unique_ptr<Controller>> m_controllers;
+  std::vector<IrqHandler> m_irq_handlers;
+  double m_bit_rate;
+  uint64_t m_bit_count = 0;
+};
+
+
+/**
+ * Call shard(index) for index 0 to num_shards-1 on num_threads threads
+ * (0 for one per core). Each shard should simulate its own buses, the
+ * shards are handed out to the threads as they become idle.
+ */
+template <typename Shard>
+void run_sharded(unsigned int num_shards, Shard&& shard, unsigned int num_threads = 0)
+{
+  if(num_threads == 0)
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  num_threads = std::min(num_threads, num_shards);
+
+  std::atomic<unsigned int> next_shard(0);
+  std::vector<std::thread> threads;
+
+  for(unsigned int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&]() {
+      for(unsigned int i = next_shard++; i < num_shards; i = next_shard++)
+        shard(i);
+    });
+  }
+
+  for(std::thread& thread : threads)
+    thread.join();
+}
+
+} // namespace sim
+} // namespace canola
+
+#endif
@@ -0,0 +1,615 @@
+/**
+ * @file   canola_stuff.hpp
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Bit stuffing and frame encoding/decoding, same as canola_bsp.vhd.
+ *
+ *         A frame is converted to and from the exact bit stream on the bus,
+ *         and frame_length() gives the exact number of bits on the bus for
+ *         a message, including stuff bits.
+ *
+ *         Bit streams are packed MSB first in uint64_t words: bit 63 of
+ *         word 0 is the first bit (SOF). Stuffing works on 64 bits at a time:
+ *         runs of 5 identical bits (C_STUFF_BIT_THRESHOLD) are found with
+ *         shifts and a count of leading zeros, so the cost depends on the
+ *         number of stuff bits instead of the number of bits.
+ *
+ *         frame_lengths() calculates lengths for a batch of messages. It
+ *         transposes the frames so that one bit in a word belongs to one
+ *         frame, and runs the stuffing rules on 64 frames per word
+ *         (and 64 * FRAME_BATCH_LANES frames per vector with GCC).
+ */
+
+#ifndef CANOLA_STUFF_HPP
+#define CANOLA_STUFF_HPP
+
+#include "canola.hpp"
+#include "canola_crc.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace canola
+{
+
+// Fields between the CRC and the end of frame, none of them are stuffed
+constexpr unsigned int FRAME_CRC_DELIM_LENGTH = 1;
+constexpr unsigned int FRAME_ACK_LENGTH = 2;       // ACK slot and delimiter
+constexpr unsigned int FRAME_EOF_LENGTH = 7;
+constexpr unsigned int FRAME_TRAILER_LENGTH =
+  FRAME_CRC_DELIM_LENGTH + FRAME_ACK_LENGTH + FRAME_EOF_LENGTH;
+
+// Minimum number of recessive bits between two frames (intermission).
+// Add this to frame_length() for the time a frame occupies the bus.
+constexpr unsigned int FRAME_IFS_LENGTH = 3;
+
+// SOF up to and including the CRC, without stuff bits
+constexpr unsigned int FRAME_STD_HEADER_LENGTH = 19;   // SOF, ID, RTR, IDE, R0, DLC
+constexpr unsigned int FRAME_EXT_HEADER_LENGTH = 39;   // SOF, ID A, SRR, IDE, ID B, RTR, R1, R0, DLC
+constexpr unsigned int FRAME_UNSTUFFED_MAX = FRAME_EXT_HEADER_LENGTH + 64 + CRC15_WIDTH;
+
+// A stuff bit at most every 4 bits after the first 5
+constexpr unsigned int FRAME_STUFF_BITS_MAX = (FRAME_UNSTUFFED_MAX - 1) / 4;
+constexpr unsigned int FRAME_LENGTH_MAX = FRAME_UNSTUFFED_MAX + FRAME_STUFF_BITS_MAX + FRAME_TRAILER_LENGTH;
+constexpr unsigned int FRAME_WORDS = (FRAME_LENGTH_MAX + 63) / 64;
+
+/**
+ * A frame as bits on the bus, MSB first
+ */
+struct FrameBits {
+  uint64_t words[FRAME_WORDS];
+  unsigned int num_bits;
+};
+
+enum class DecodeStatus {
+  OK,
+  STUFF_ERROR,      // Six identical bits in the stuffed part of the frame
+  CRC_ERROR,
+  FORM_ERROR,       // A fixed-form bit (SRR, IDE, delimiters, EOF) has the wrong value
+  TRUNCATED         // The frame ends before EOF
+};
+
+namespace detail
+{
+
+inline uint64_t top_mask(unsigned int n)
+{
+  return n == 0 ? 0 : ~uint64_t(0) << (64 - n);
+}
+
+/**
+ * Append bits to an MSB first bit stream, value holds the bits in its n
+ * most significant bits and zeros below them
+ */
+struct BitWriter {
+  uint64_t* words;
+  size_t num_bits;
+
+  void put(uint64_t value, unsigned int n)
+  {
+    const unsigned int offset = num_bits % 64;
+    uint64_t* word = words + num_bits / 64;
+
+    if(offset == 0) {
+      *word = value;
+    } else {
+      *word |= value >> offset;
+      if(offset + n > 64)
+        word[1] = value << (64 - offset);
+    }
+
+    num_bits += n;
+  }
+
+  void put_field(uint64_t value, unsigned int n)
+  {
+    put(value << (64 - n), n);
+  }
+};
+
+/**
+ * Up to 64 bits from position pos, left aligned, zeros after the end
+ */
+inline uint64_t read_bits(const uint64_t* words, size_t num_bits, size_t pos)
+{
+  const size_t index = pos / 64;
+  const unsigned int offset = pos % 64;
+  uint64_t value = words[index] << offset;
+
+  if(offset != 0 && (index + 1) * 64 < num_bits)
+    value |= words[index + 1] >> (64 - offset);
+
+  const size_t remaining = num_bits - pos;
+  return remaining >= 64 ? value : value & top_mask(remaining);
+}
+
+/**
+ * Run of identical bits at the end of the stuffed stream: the value of the
+ * last bit, and the length of the run (0 before SOF, at most 4)
+ */
+struct StuffRun {
+  bool last;
+  unsigned int length;
+};
+
+/**
+ * Position of the first bit in the k bits of x that ends a run of 5
+ * identical bits, when continuing from run. Returns 64 if there is none.
+ */
+inline unsigned int find_stuff_position(uint64_t x, unsigned int k, StuffRun run)
+{
+  // eq: bit is equal to the previous bit
+  uint64_t eq = ~(x ^ ((x >> 1) | (uint64_t(run.last) << 63)));
+  if(run.length == 0)
+    eq &= ~(uint64_t(1) << 63);
+
+  // Equal bits before the start of x, from the run at the end of the stream
+  const uint64_t context = run.length <= 1 ? 0 : (uint64_t(1) << (run.length - 1)) - 1;
+
+  const uint64_t run5 = eq &
+    ((eq >> 1) | (context << 63)) &
+    ((eq >> 2) | (context << 62)) &
+    ((eq >> 3) | (context << 61)) &
+    top_mask(k);
+
+  return run5 == 0 ? 64 : __builtin_clzll(run5);
+}
+
+/**
+ * Run at the end of the k bits of x, which had no stuff positions
+ */
+inline StuffRun end_run(uint64_t x, unsigned int k, StuffRun run)
+{
+  const bool last = (x >> (64 - k)) & 1;
+  uint64_t eq = ~(x ^ ((x >> 1) | (uint64_t(run.last) << 63)));
+  if(run.length == 0)
+    eq &= ~(uint64_t(1) << 63);
+
+  // Equal bits counted backwards from the last bit
+  const uint64_t tail = ~(eq >> (64 - k));
+  const unsigned int equal = tail == 0 ? 64 : __builtin_ctzll(tail);
+
+  if(equal >= k)
+    return StuffRun{last, std::min(4u, run.length + k)};
+  return StuffRun{last, std::min(4u, equal + 1)};
+}
+
+} // namespace detail
+
+/**
+ * Insert stuff bits in num_bits bits from in, starting at SOF, and write the
+ * result to out. Returns the number of bits written, out must have room for
+ * num_bits + num_bits/4 bits.
+ */
+inline size_t stuff_bits(const uint64_t* in, size_t num_bits, uint64_t* out)
+{
+  detail::BitWriter writer{out, 0};
+  detail::StuffRun run{true, 0};
+  size_t pos = 0;
+
+  while(pos < num_bits) {
+    const unsigned int k = num_bits - pos < 64 ? num_bits - pos : 64;
+    const uint64_t x = detail::read_bits(in, num_bits, pos);
+    const unsigned int j = detail::find_stuff_position(x, k, run);
+
+    if(j == 64) {
+      writer.put(x, k);
+      run = detail::end_run(x, k, run);
+      pos += k;
+    } else {
+      // Bits up to the end of the run, and a stuff bit of the opposite value
+      const bool bit = (x >> (63 - j)) & 1;
+      writer.put(x & detail::top_mask(j + 1), j + 1);
+      writer.put(uint64_t(!bit) << 63, 1);
+      run = detail::StuffRun{!bit, 1};
+      pos += j + 1;
+    }
+  }
+
+  return writer.num_bits;
+}
+
+/**
+ * Number of stuff bits stuff_bits() would insert
+ */
+inline unsigned int count_stuff_bits(const uint64_t* in, size_t num_bits)
+{
+  detail::StuffRun run{true, 0};
+  unsigned int count = 0;
+  size_t pos = 0;
+
+  while(pos < num_bits) {
+    const unsigned int k = num_bits - pos < 64 ? num_bits - pos : 64;
+    const uint64_t x = detail::read_bits(in, num_bits, pos);
+    const unsigned int j = detail::find_stuff_position(x, k, run);
+
+    if(j == 64) {
+      run = detail::end_run(x, k, run);
+      pos += k;
+    } else {
+      const bool bit = (x >> (63 - j)) & 1;
+      run = detail::StuffRun{!bit, 1};
+      pos += j + 1;
+      count++;
+    }
+  }
+
+  return count;
+}
+
+/**
+ * Remove stuff bits from a bit stream starting at SOF, until max_out bits
+ * have been written to out. A stuff bit right after the last bit is also
+ * removed, as after the last bit of the CRC.
+ * Returns the number of bits written, consumed is set to the number of bits
+ * read from in. Returns with stuff_error set if six identical bits are found.
+ */
+inline size_t destuff_bits(const uint64_t* in, size_t num_bits, uint64_t* out, size_t max_out,
+                           size_t& consumed, bool& stuff_error)
+{
+  detail::BitWriter writer{out, 0};
+  detail::StuffRun run{true, 0};
+  size_t pos = 0;
+
+  stuff_error = false;
+
+  while(pos < num_bits && writer.num_bits < max_out) {
+    size_t k = num_bits - pos < 64 ? num_bits - pos : 64;
+    if(k > max_out - writer.num_bits)
+      k = max_out - writer.num_bits;
+
+    const uint64_t x = detail::read_bits(in, num_bits, pos) & detail::top_mask(k);
+    const unsigned int j = detail::find_stuff_position(x, k, run);
+
+    if(j == 64) {
+      writer.put(x, k);
+      run = detail::end_run(x, k, run);
+      pos += k;
+      continue;
+    }
+
+    const bool bit = (x >> (63 - j)) & 1;
+    writer.put(x & detail::top_mask(j + 1), j + 1);
+    pos += j + 1;
+
+    if(pos >= num_bits)
+      break;
+
+    const bool stuff_bit = detail::read_bits(in, num_bits, pos) >> 63;
+    if(stuff_bit == bit) {
+      stuff_error = true;
+      break;
+    }
+
+    run = detail::StuffRun{stuff_bit, 1};
+    pos++;
+  }
+
+  consumed = pos;
+  return writer.num_bits;
+}
+
+/**
+ * Number of bits from SOF to the end of the CRC, without stuff bits
+ */
+inline unsigned int frame_unstuffed_length(const CanMsg& msg)
+{
+  const unsigned int data_bytes = msg.remote_frame ? 0 : (msg.data_length > 8 ? 8 : msg.data_length);
+  return (msg.ext_id ? FRAME_EXT_HEADER_LENGTH : FRAME_STD_HEADER_LENGTH) + 8*data_bytes + CRC15_WIDTH;
+}
+
+/**
+ * Write the bits from SOF to the end of the CRC, without stuff bits,
+ * and return the number of bits. words must have room for
+ * FRAME_UNSTUFFED_MAX bits.
+ */
+inline unsigned int pack_frame(const CanMsg& msg, uint64_t* words)
+{
+  detail::BitWriter writer{words, 0};
+
+  auto field = [&](uint64_t value, unsigned int length) {
+    writer.put_field(value, length);
+  };
+
+  field(0, 1);                                  // SOF
+  field(msg.arb_id_a & 0x7FF, 11);
+  if(msg.ext_id) {
+    field(0x3, 2);                              // SRR, IDE
+    field(msg.arb_id_b & 0x3FFFF, 18);
+    field(msg.remote_frame, 1);
+    field(0, 2);                                // R1, R0
+  } else {
+    field(msg.remote_frame, 1);
+    field(0, 2);                                // IDE, R0
+  }
+  field(msg.data_length & 0xF, 4);
+
+  if(!msg.remote_frame) {
+    const unsigned int data_bytes = msg.data_length > 8 ? 8 : msg.data_length;
+    for(unsigned int i = 0; i < data_bytes; i++)
+      field(msg.payload[i], 8);
+  }
+
+  writer.put_field(crc15_words(words, writer.num_bits), CRC15_WIDTH);
+  return writer.num_bits;
+}
+
+/**
+ * Frame as it appears on the bus, from SOF to the end of EOF. The ACK slot
+ * is dominant if ack is true (acknowledged by a receiver), and recessive
+ * as sent by the transmitter otherwise. Returns the number of bits.
+ */
+inline unsigned int encode_frame(const CanMsg& msg, FrameBits& frame, bool ack = true)
+{
+  uint64_t unstuffed[FRAME_WORDS];
+  const unsigned int num_bits = pack_frame(msg, unstuffed);
+
+  detail::BitWriter writer{frame.words, stuff_bits(unstuffed, num_bits, frame.words)};
+  writer.put_field(1, FRAME_CRC_DELIM_LENGTH);
+  writer.put_field(ack ? 0x1 : 0x3, FRAME_ACK_LENGTH);
+  writer.put_field(0x7F, FRAME_EOF_LENGTH);
+
+  frame.num_bits = writer.num_bits;
+  return frame.num_bits;
+}
+
+/**
+ * Number of bits on the bus from SOF to the end of EOF
+ */
+inline unsigned int frame_length(const CanMsg& msg)
+{
+  uint64_t unstuffed[FRAME_WORDS];
+  const unsigned int num_bits = pack_frame(msg, unstuffed);
+  return num_bits + count_stuff_bits(unstuffed, num_bits) + FRAME_TRAILER_LENGTH;
+}
+
+/**
+ * Decode a frame from the bits on the bus, starting at SOF. If frame_bits is
+ * given, it is set to the number of bits up to the end of EOF.
+ */
+inline DecodeStatus decode_frame(const uint64_t* words, size_t num_bits, CanMsg& msg,
+                                 unsigned int* frame_bits = nullptr)
+{
+  uint64_t bits[FRAME_WORDS] = {};
+  size_t consumed;
+  bool stuff_error;
+
+  // The header first, to find the length of the rest. The standard header
+  // is read first, a short frame can end before the extended header would.
+  size_t length = destuff_bits(words, num_bits, bits, FRAME_STD_HEADER_LENGTH, consumed, stuff_error);
+
+  if(stuff_error)
+    return DecodeStatus::STUFF_ERROR;
+  if(length < FRAME_STD_HEADER_LENGTH)
+    return DecodeStatus::TRUNCATED;
+
+  auto field = [&](unsigned int pos, unsigned int n) {
+    return detail::read_bits(bits, FRAME_UNSTUFFED_MAX, pos) >> (64 - n);
+  };
+
+  if(field(0, 1) != 0)
+    return DecodeStatus::FORM_ERROR;
+
+  msg.arb_id_a = field(1, 11);
+  msg.ext_id = field(13, 1);
+
+  unsigned int dlc_pos;
+  if(msg.ext_id) {
+    length = destuff_bits(words, num_bits, bits, FRAME_EXT_HEADER_LENGTH, consumed, stuff_error);
+
+    if(stuff_error)
+      return DecodeStatus::STUFF_ERROR;
+    if(length < FRAME_EXT_HEADER_LENGTH)
+      return DecodeStatus::TRUNCATED;
+    if(field(12, 1) != 1)                       // SRR
+      return DecodeStatus::FORM_ERROR;
+    msg.arb_id_b = field(14, 18);
+    msg.remote_frame = field(32, 1);
+    dlc_pos = 35;
+  } else {
+    msg.arb_id_b = 0;
+    msg.remote_frame = field(12, 1);
+    dlc_pos = 15;
+  }
+  msg.data_length = field(dlc_pos, 4);
+
+  // Everything up to the CRC
+  const unsigned int unstuffed_length = frame_unstuffed_length(msg);
+  length = destuff_bits(words, num_bits, bits, unstuffed_length, consumed, stuff_error);
+
+  if(stuff_error)
+    return DecodeStatus::STUFF_ERROR;
+  if(length < unstuffed_length || consumed + FRAME_TRAILER_LENGTH > num_bits)
+    return DecodeStatus::TRUNCATED;
+
+  const unsigned int data_pos = dlc_pos + 4;
+  const unsigned int crc_pos = unstuffed_length - CRC15_WIDTH;
+
+  for(unsigned int i = 0; i < 8; i++)
+    msg.payload[i] = data_pos + 8*i < crc_pos ? field(data_pos + 8*i, 8) : 0;
+
+  uint16_t crc = 0;
+  for(unsigned int pos = 0; pos < crc_pos; pos += 32) {
+    const unsigned int n = crc_pos - pos < 32 ? crc_pos - pos : 32;
+    crc = crc15_update(crc, field(pos, n), n);
+  }
+  if(crc != field(crc_pos, CRC15_WIDTH))
+    return DecodeStatus::CRC_ERROR;
+
+  // CRC delimiter, ACK delimiter and EOF are recessive, the ACK slot can be either
+  const uint64_t trailer = detail::read_bits(words, num_bits, consumed) >> (64 - FRAME_TRAILER_LENGTH);
+  if((trailer | (uint64_t(1) << (FRAME_TRAILER_LENGTH - 2))) != (uint64_t(1) << FRAME_TRAILER_LENGTH) - 1)
+    return DecodeStatus::FORM_ERROR;
+
+  if(frame_bits)
+    *frame_bits = consumed + FRAME_TRAILER_LENGTH;
+
+  return DecodeStatus::OK;
+}
+
+namespace detail
+{
+
+/**
+ * Transpose a 64x64 bit matrix, bit 63-c of row r is swapped with
+ * bit 63-r of row c
+ */
+inline void transpose64(uint64_t* a)
+{
+  uint64_t m = 0x00000000FFFFFFFF;
+
+  for(unsigned int j = 32; j != 0; j >>= 1, m ^= m << j) {
+    for(unsigned int k = 0; k < 64; k = (k + j + 1) & ~j) {
+      const uint64_t t = (a[k] ^ (a[k + j] >> j)) & m;
+      a[k] ^= t;
+      a[k + j] ^= t << j;
+    }
+  }
+}
+
+// Positions of the bits in the batch, frames are aligned at the end of the CRC
+constexpr unsigned int BATCH_POSITIONS = 128;
+constexpr unsigned int BATCH_FIRST_POSITION = BATCH_POSITIONS - FRAME_UNSTUFFED_MAX;
+
+/**
+ * The unstuffed bits of a frame, aligned so that the CRC ends at position
+ * 127 of hi:lo, and recessive/dominant bits alternating before SOF so that
+ * they never cause stuffing
+ */
+inline void batch_frame_bits(const CanMsg& msg, uint64_t& hi, uint64_t& lo)
+{
+  uint64_t words[FRAME_WORDS];
+  const unsigned int length = pack_frame(msg, words);
+  const unsigned int shift = BATCH_POSITIONS - length;
+
+  if(shift >= 64) {
+    lo = words[0] >> (shift - 64);
+    hi = 0;
+  } else {
+    lo = (words[1] >> shift) | (words[0] << (64 - shift));
+    hi = words[0] >> shift;
+  }
+
+  // The bit before SOF (bit 'length' of hi:lo) is recessive
+  const uint64_t pad = length % 2 == 0 ? 0x5555555555555555 : 0xAAAAAAAAAAAAAAAA;
+  if(length < 64) {
+    lo |= pad & (~uint64_t(0) << length);
+    hi = pad;
+  } else {
+    hi |= pad & (~uint64_t(0) << (length - 64));
+  }
+}
+
+/**
+ * Count stuff bits in 64 frames per bit of W, from bit planes where
+ * plane[p] holds position p of all frames. Counts are returned as five
+ * bit planes.
+ */
+template<typename W>
+inline void batch_count_stuff(const W* plane, W* count)
+{
+  const W zero = plane[0] ^ plane[0];
+  W prev = ~zero;                // Recessive before SOF of the longest frames
+  W run0 = zero;                 // Run length - 1, two bit planes
+  W run1 = zero;
+
+  for(unsigned int k = 0; k < 5; k++)
+    count[k] = zero;
+
+  for(unsigned int p = BATCH_FIRST_POSITION; p < BATCH_POSITIONS; p++) {
+    const W bit = plane[p];
+    const W eq = ~(bit ^ prev);
+
+    // Fifth identical bit, a stuff bit of the opposite value follows
+    // and starts a new run
+    const W stuff = eq & run1 & run0;
+    const W grow = eq & ~stuff;
+
+    run1 = grow & (run1 ^ run0);
+    run0 = grow & ~run0;
+    prev = bit ^ stuff;
+
+    W carry = stuff;
+    for(unsigned int k = 0; k < 5; k++) {
+      const W next = count[k] & carry;
+      count[k] ^= carry;
+      carry = next;
+    }
+  }
+}
+
+#if defined(__GNUC__)
+constexpr unsigned int FRAME_BATCH_LANES = 4;
+typedef uint64_t u64xL __attribute__((vector_size(FRAME_BATCH_LANES*sizeof(uint64_t))));
+#else
+constexpr unsigned int FRAME_BATCH_LANES = 1;
+typedef uint64_t u64xL;
+#endif
+
+} // namespace detail
+
+constexpr unsigned int FRAME_BATCH_LANES = detail::FRAME_BATCH_LANES;
+constexpr unsigned int FRAME_BATCH_SIZE = 64 * FRAME_BATCH_LANES;
+
+/**
+ * frame_length() for count messages
+ */
+inline void frame_lengths(const CanMsg* msgs, size_t count, uint16_t* lengths)
+{
+  using detail::u64xL;
+  using detail::BATCH_POSITIONS;
+
+  size_t i = 0;
+
+  for(; i + FRAME_BATCH_SIZE <= count; i += FRAME_BATCH_SIZE) {
+    uint64_t planes[FRAME_BATCH_LANES][BATCH_POSITIONS];
+
+    for(unsigned int lane = 0; lane < FRAME_BATCH_LANES; lane++) {
+      uint64_t* hi = planes[lane];
+      uint64_t* lo = planes[lane] + 64;
+
+      for(unsigned int f = 0; f < 64; f++)
+        detail::batch_frame_bits(msgs[i + 64*lane + f], hi[f], lo[f]);
+
+      detail::transpose64(hi);
+      detail::transpose64(lo);
+    }
+
+    u64xL plane[BATCH_POSITIONS];
+    for(unsigned int p = 0; p < BATCH_POSITIONS; p++) {
+#if defined(__GNUC__)
+      for(unsigned int lane = 0; lane < FRAME_BATCH_LANES; lane++)
+        plane[p][lane] = planes[lane][p];
+#else
+      plane[p] = planes[0][p];
+#endif
+    }
+
+    u64xL stuff_count[5];
+    detail::batch_count_stuff(plane, stuff_count);
+
+    for(unsigned int lane = 0; lane < FRAME_BATCH_LANES; lane++) {
+      for(unsigned int f = 0; f < 64; f++) {
+        const CanMsg& msg = msgs[i + 64*lane + f];
+        unsigned int stuff = 0;
+
+        for(unsigned int k = 0; k < 5; k++) {
+#if defined(__GNUC__)
+          stuff |= ((stuff_count[k][lane] >> (63 - f)) & 1) << k;
+#else
+          stuff |= ((stuff_count[k] >> (63 - f)) & 1) << k;
+#endif
+        }
+
+        lengths[i + 64*lane + f] = frame_unstuffed_length(msg) + stuff + FRAME_TRAILER_LENGTH;
+      }
+    }
+  }
+
+  for(; i < count; i++)
+    lengths[i] = frame_length(msgs[i]);
+}
+
+} // namespace canola
+
+#endif
@@ -0,0 +1,570 @@
+/**
+ * @file   canola_telemetry.hpp
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Counter telemetry for Canola controllers: periodic snapshots of
+ *         the status/error counters of all controllers, with deltas and
+ *         rates per interval, published in a shared-memory ring and served
+ *         in the Prometheus text format.
+ *
+ *         Sampler reads the counters of all controllers back to back with
+ *         Canola::read_counters() (no printing, no allocation), then
+ *         computes the deltas. The 32-bit counters wrap around, which the
+ *         unsigned subtraction handles, and they can be reset by
+ *         reset_counters(), which is detected because no counter can count
+ *         faster than once per COUNT_BITS_MIN bits on the bus.
+ *
+ *         SampleRing is a lock-free ring (one writer, any number of
+ *         readers) that can be placed in POSIX shared memory with
+ *         SharedRing, so the sampler and the exporter can be separate
+ *         processes. Exporter answers HTTP requests for /metrics on a local
+ *         port with format_prometheus() of the last sample.
+ */
+
+#ifndef CANOLA_TELEMETRY_HPP
+#define CANOLA_TELEMETRY_HPP
+
+#include "canola.hpp"
+#include "canola_bit_timing.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+namespace canola
+{
+namespace telemetry
+{
+
+constexpr unsigned int CONTROLLERS_MAX    = 16;
+constexpr unsigned int RING_SLOTS_DEFAULT = 64;
+constexpr uint16_t EXPORTER_PORT_DEFAULT  = 9101;
+constexpr const char* SHM_NAME_DEFAULT    = "/canola_telemetry";
+
+// No counter counts more often than once per this many bits on the bus. The
+// shortest event is an error frame after a bit error in SOF: 1 + 6 + 8 + 3
+// bits.
+constexpr unsigned int COUNT_BITS_MIN = 16;
+
+struct CounterInfo {
+  const char* name;  // Prometheus metric name, without _total
+  const char* help;
+};
+
+// Indexed by counter_index()
+constexpr CounterInfo COUNTER_INFO[NUM_COUNTERS] = {
+  {"canola_tx_msg_sent",    "Messages sent"},
+  {"canola_tx_failed",      "Messages that failed to send"},
+  {"canola_tx_ack_error",   "Sent messages without ACK"},
+  {"canola_tx_arb_lost",    "Times arbitration was lost"},
+  {"canola_tx_bit_error",   "Transmit bit errors"},
+  {"canola_tx_retransmit",  "Attempts at retransmitting messages"},
+  {"canola_rx_msg_recv",    "Messages received"},
+  {"canola_rx_crc_error",   "Received messages with CRC error"},
+  {"canola_rx_form_error",  "Received messages with form error"},
+  {"canola_rx_stuff_error", "Received messages with stuff error"}
+};
+
+/**
+ * Counters of one controller in a sample
+ */
+struct ControllerSample {
+  CounterValues values;          // Register values
+  uint32_t delta[NUM_COUNTERS];  // Since the previous sample
+  uint64_t total[NUM_COUNTERS];  // Register value at the first sample, plus the deltas since
+  double rate[NUM_COUNTERS];     // Delta per second
+  uint32_t reset_mask;           // Bit counter_index() set if the counter was reset
+};
+
+struct Sample {
+  uint64_t sequence;     // From 1, 0 before the first sample
+  uint64_t time_ns;      // Monotonic clock
+  uint64_t interval_ns;  // Since the previous sample, 0 for the first
+  uint32_t controllers;
+  ControllerSample controller[CONTROLLERS_MAX];
+};
+
+inline uint64_t now_ns()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Increment of a 32-bit counter register from prev to value, across a
+ * wraparound. An increment larger than max_increment can not have happened
+ * on the bus, so the counter was reset in between, and has counted to
+ * value since.
+ */
+inline uint32_t counter_delta(uint32_t prev, uint32_t value, uint64_t max_increment, bool& reset)
+{
+  const uint32_t delta = value - prev;
+  reset = delta > max_increment;
+  return reset ? value : delta;
+}
+
+/**
+ * Samples the counters of up to CONTROLLERS_MAX controllers. Add all
+ * controllers before the first sample().
+ */
+template <typename RegisterIO>
+class Sampler
+{
+public:
+  explicit Sampler(double bit_rate = BIT_RATE_DEFAULT) : m_bit_rate(bit_rate) {}
+
+  bool add(const Canola<RegisterIO>& can)
+  {
+    if(m_controllers.size() >= CONTROLLERS_MAX)
+      return false;
+    m_controllers.push_back(&can);
+    return true;
+  }
+
+  unsigned int size() const { return m_controllers.size(); }
+
+  /**
+   * Read all controllers, then compute the deltas, totals and rates since
+   * the previous sample. time_ns is the time of the sample on a monotonic
+   * clock, e.g. now_ns().
+   */
+  const Sample& sample(uint64_t time_ns)
+  {
+    CounterValues values[CONTROLLERS_MAX];
+    const unsigned int n = m_controllers.size();
+
+    for(unsigned int i = 0; i < n; i++)
+      values[i] = m_controllers[i]->read_counters();
+
+    const bool first = m_sample.sequence == 0;
+    const uint64_t interval_ns = first ? 0 : time_ns - m_sample.time_ns;
+    const double seconds = 1e-9 * interval_ns;
+    const uint64_t max_increment = uint64_t(seconds * m_bit_rate / COUNT_BITS_MIN) + 1;
+
+    m_sample.sequence++;
+    m_sample.time_ns = time_ns;
+    m_sample.interval_ns = interval_ns;
+    m_sample.controllers = n;
+
+    for(unsigned int i = 0; i < n; i++) {
+      ControllerSample& c = m_sample.controller[i];
+      c.reset_mask = 0;
+
+      for(unsigned int j = 0; j < NUM_COUNTERS; j++) {
+        if(first) {
+          c.delta[j] = 0;
+          c.total[j] = values[i].count[j];
+          c.rate[j] = 0.0;
+          continue;
+        }
+
+        bool reset = false;
+        c.delta[j] = counter_delta(c.values.count[j], values[i].count[j], max_increment, reset);
+        c.total[j] += c.delta[j];
+        c.rate[j] = seconds > 0.0 ? c.delta[j] / seconds : 0.0;
+        if(reset)
+          c.reset_mask |= 1u << j;
+      }
+
+      c.values = values[i];
+    }
+
+    return m_sample;
+  }
+
+  const Sample& sample() { return sample(now_ns()); }
+
+  const Sample& last() const { return m_sample; }
+
+private:
+  std::vector<const Canola<RegisterIO>*> m_controllers;
+  double m_bit_rate;
+  Sample m_sample = {};
+};
+
+
+/**
+ * Ring of the last samples, in memory that may be shared between
+ * processes. One writer, any number of readers, without locks: the
+ * sequence number of a slot is 0 while it is written (a seqlock), and a
+ * reader that sees it change while it copies the sample gives up.
+ */
+class SampleRing
+{
+public:
+  static constexpr uint32_t MAGIC   = 0x434e5452;  // "CNTR"
+  static constexpr uint32_t VERSION = 1;
+
+  struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slots;
+    uint32_t sample_size;
+    std::atomic<uint64_t> head;  // Sequence number of the last sample written
+  };
+
+  struct Slot {
+    std::atomic<uint64_t> sequence;
+    Sample sample;
+  };
+
+  // Bytes of memory for a ring of slots samples
+  static size_t size(unsigned int slots) { return sizeof(Header) + slots * sizeof(Slot); }
+
+  SampleRing() = default;
+
+  // Initialize a ring in memory of size(slots) bytes
+  static SampleRing create(void* memory, unsigned int slots)
+  {
+    SampleRing ring;
+    ring.m_header = new(memory) Header;
+    ring.m_header->magic = MAGIC;
+    ring.m_header->version = VERSION;
+    ring.m_header->slots = slots;
+    ring.m_header->sample_size = sizeof(Sample);
+    ring.m_header->head.store(0, std::memory_order_relaxed);
+
+    ring.m_slots = reinterpret_cast<Slot*>(ring.m_header + 1);
+    for(unsigned int i = 0; i < slots; i++)
+      new(&ring.m_slots[i]) Slot{{0}, Sample{}};
+
+    std::atomic_thread_fence(std::memory_order_release);
+    return ring;
+  }
+
+  // Use a ring created by create(), not valid if the layout does not match
+  static SampleRing attach(const void* memory, size_t bytes)
+  {
+    SampleRing ring;
+    const Header* header = static_cast<const Header*>(memory);
+
+    if(bytes < sizeof(Header) || header->magic != MAGIC || header->version != VERSION ||
+       header->sample_size != sizeof(Sample) || bytes < size(header->slots))
+      return ring;
+
+    ring.m_header = const_cast<Header*>(header);
+    ring.m_slots = reinterpret_cast<Slot*>(ring.m_header + 1);
+    return ring;
+  }
+
+  bool is_valid() const { return m_header != nullptr; }
+  unsigned int slots() const { return m_header->slots; }
+  uint64_t head() const { return m_header->head.load(std::memory_order_acquire); }
+
+  void push(const Sample& sample)
+  {
+    Slot& slot = m_slots[sample.sequence % m_header->slots];
+
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.sample = sample;
+    slot.sequence.store(sample.sequence, std::memory_order_release);
+
+    m_header->head.store(sample.sequence, std::memory_order_release);
+  }
+
+  // Copy sample number sequence, false if it is not written yet, or is
+  // being or has been overwritten
+  bool read(uint64_t sequence, Sample& sample) const
+  {
+    const Slot& slot = m_slots[sequence % m_header->slots];
+
+    if(sequence == 0 || slot.sequence.load(std::memory_order_acquire) != sequence)
+      return false;
+
+    sample = slot.sample;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.sequence.load(std::memory_order_relaxed) == sequence;
+  }
+
+  // Copy the last sample, false if there is none yet
+  bool latest(Sample& sample) const
+  {
+    // The writer can only overwrite the slot if it is a whole ring ahead
+    for(unsigned int attempt = 0; attempt < 4; attempt++) {
+      if(read(head(), sample))
+        return true;
+    }
+    return false;
+  }
+
+private:
+  Header* m_header = nullptr;
+  Slot* m_slots = nullptr;
+};
+
+
+#if defined(__linux__)
+/**
+ * SampleRing in a POSIX shared memory object. The sampler creates it, and
+ * owns (unlinks) it. Exporters open it read-only.
+ */
+class SharedRing
+{
+public:
+  SharedRing() = default;
+  SharedRing(const SharedRing&) = delete;
+  SharedRing& operator=(const SharedRing&) = delete;
+
+  ~SharedRing()
+  {
+    if(m_memory != nullptr)
+      ::munmap(m_memory, m_size);
+    if(m_owner)
+      ::shm_unlink(m_name.c_str());
+  }
+
+  bool create(const std::string& name, unsigned int slots = RING_SLOTS_DEFAULT)
+  {
+    int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if(fd < 0)
+      return false;
+
+    m_name = name;
+    m_owner = true;
+    m_size = SampleRing::size(slots);
+
+    if(::ftruncate(fd, off_t(m_size)) == 0)
+      map(fd, PROT_READ | PROT_WRITE);
+    ::close(fd);
+
+    if(m_memory != nullptr)
+      m_ring = SampleRing::create(m_memory, slots);
+    return m_ring.is_valid();
+  }
+
+  bool open(const std::string& name)
+  {
+    int fd = ::shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+    if(fd < 0)
+      return false;
+
+    struct stat st;
+    if(::fstat(fd, &st) == 0) {
+      m_size = size_t(st.st_size);
+      map(fd, PROT_READ);
+    }
+    ::close(fd);
+
+    if(m_memory != nullptr)
+      m_ring = SampleRing::attach(m_memory, m_size);
+    return m_ring.is_valid();
+  }
+
+  SampleRing& ring() { return m_ring; }
+  const SampleRing& ring() const { return m_ring; }
+
+private:
+  void map(int fd, int prot)
+  {
+    void* ptr = ::mmap(nullptr, m_size, prot, MAP_SHARED, fd, 0);
+    if(ptr != MAP_FAILED)
+      m_memory = ptr;
+  }
+
+  std::string m_name;
+  bool m_owner = false;
+  void* m_memory = nullptr;
+  size_t m_size = 0;
+  SampleRing m_ring;
+};
+#endif
+
+
+/**
+ * Sample in the Prometheus text exposition format. The counters are the
+ * 64-bit totals, which keep counting across wraparounds and resets of the
+ * registers. The rates are over the last sample interval.
+ */
+inline std::string format_prometheus(const Sample& sample)
+{
+  std::string out;
+  char line[256];
+
+  out.reserve(4096 + 1024 * sample.controllers);
+
+  auto header = [&](const char* name, const char* suffix, const char* help, const char* type) {
+    snprintf(line, sizeof(line), "# HELP %s%s %s\n# TYPE %s%s %s\n", name, suffix, help, name,
+             suffix, type);
+    out += line;
+  };
+
+  for(unsigned int j = 0; j < NUM_COUNTERS; j++) {
+    header(COUNTER_INFO[j].name, "_total", COUNTER_INFO[j].help, "counter");
+    for(unsigned int i = 0; i < sample.controllers; i++) {
+      snprintf(line, sizeof(line), "%s_total{controller=\"%u\"} %llu\n", COUNTER_INFO[j].name, i,
+               (unsigned long long)sample.controller[i].total[j]);
+      out += line;
+    }
+  }
+
+  for(unsigned int j = 0; j < NUM_COUNTERS; j++) {
+    snprintf(line, sizeof(line), "%s per second over the last sample interval",
+             COUNTER_INFO[j].help);
+    const std::string help = line;
+    header(COUNTER_INFO[j].name, "_rate", help.c_str(), "gauge");
+    for(unsigned int i = 0; i < sample.controllers; i++) {
+      snprintf(line, sizeof(line), "%s_rate{controller=\"%u\"} %.6g\n", COUNTER_INFO[j].name, i,
+               sample.controller[i].rate[j]);
+      out += line;
+    }
+  }
+
+  header("canola_transmit_error_count", "", "Transmit error counter (TEC)", "gauge");
+  for(unsigned int i = 0; i < sample.controllers; i++) {
+    snprintf(line, sizeof(line), "canola_transmit_error_count{controller=\"%u\"} %u\n", i,
+             sample.controller[i].values.transmit_error_count);
+    out += line;
+  }
+
+  header("canola_receive_error_count", "", "Receive error counter (REC)", "gauge");
+  for(unsigned int i = 0; i < sample.controllers; i++) {
+    snprintf(line, sizeof(line), "canola_receive_error_count{controller=\"%u\"} %u\n", i,
+             sample.controller[i].values.receive_error_count);
+    out += line;
+  }
+
+  header("canola_error_state", "", "0 error active, 1 error passive, 2 bus off", "gauge");
+  for(unsigned int i = 0; i < sample.controllers; i++) {
+    snprintf(line, sizeof(line), "canola_error_state{controller=\"%u\"} %u\n", i,
+             static_cast<unsigned int>(sample.controller[i].values.error_state));
+    out += line;
+  }
+
+  header("canola_telemetry_samples", "_total", "Samples taken", "counter");
+  snprintf(line, sizeof(line), "canola_telemetry_samples_total %llu\n",
+           (unsigned long long)sample.sequence);
+  out += line;
+
+  header("canola_telemetry_interval_seconds", "", "Last sample interval", "gauge");
+  snprintf(line, sizeof(line), "canola_telemetry_interval_seconds %.9f\n",
+           1e-9 * sample.interval_ns);
+  out += line;
+
+  return out;
+}
+
+
+#if defined(__linux__)
+/**
+ * Minimal HTTP server for a Prometheus scraper: one request per
+ * connection, GET /metrics (or /) only.
+ */
+class Exporter
+{
+public:
+  Exporter() = default;
+  Exporter(const Exporter&) = delete;
+  Exporter& operator=(const Exporter&) = delete;
+
+  ~Exporter()
+  {
+    if(m_fd >= 0)
+      ::close(m_fd);
+  }
+
+  // Listen on address:port, port 0 for any free port (see port())
+  bool listen(uint16_t port = EXPORTER_PORT_DEFAULT, const char* address = "127.0.0.1")
+  {
+    m_fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if(m_fd < 0)
+      return false;
+
+    int one = 1;
+    ::setsockopt(m_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if(::inet_pton(AF_INET, address, &addr.sin_addr) != 1 ||
+       ::bind(m_fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0 ||
+       ::listen(m_fd, 8) != 0)
+      return false;
+
+    socklen_t len = sizeof(addr);
+    ::getsockname(m_fd, reinterpret_cast<struct sockaddr*>(&addr), &len);
+    m_port = ntohs(addr.sin_port);
+    return true;
+  }
+
+  uint16_t port() const { return m_port; }
+
+  /**
+   * Wait up to timeout_ms for a connection, and answer its request with
+   * body(), a std::string (empty if there is no sample yet). Returns false
+   * if there was no connection.
+   */
+  template <typename Body>
+  bool serve(int timeout_ms, Body&& body)
+  {
+    struct pollfd pfd = {m_fd, POLLIN, 0};
+    if(::poll(&pfd, 1, timeout_ms) <= 0)
+      return false;
+
+    int fd = ::accept4(m_fd, nullptr, nullptr, SOCK_CLOEXEC);
+    if(fd < 0)
+      return false;
+
+    struct timeval timeout = {1, 0};
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    // Only the request line matters, the rest of the headers are ignored
+    std::string request;
+    char buf[1024];
+    while(request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+      ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+      if(n <= 0)
+        break;
+      request.append(buf, size_t(n));
+    }
+
+    std::string content;
+    const char* status = "404 Not Found";
+    if(request.compare(0, 13, "GET /metrics ") == 0 || request.compare(0, 6, "GET / ") == 0) {
+      content = body();
+      status = content.empty() ? "503 Service Unavailable" : "200 OK";
+    }
+
+    char head[256];
+    snprintf(head, sizeof(head),
+             "HTTP/1.1 %s\r\nContent-Type: text/plain; version=0.0.4\r\n"
+             "Content-Length: %zu\r\nConnection: close\r\n\r\n", status, content.size());
+
+    const std::string response = head + content;
+    for(size_t sent = 0; sent < response.size(); ) {
+      ssize_t n = ::send(fd, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+      if(n <= 0)
+        break;
+      sent += size_t(n);
+    }
+
+    ::close(fd);
+    return true;
+  }
+
+private:
+  int m_fd = -1;
+  uint16_t m_port = 0;
+};
+#endif
+
+} // namespace telemetry
+} // namespace canola
+
+#endif
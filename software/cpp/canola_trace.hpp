@@ -0,0 +1,336 @@
+/**
+ * @file   canola_trace.hpp
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Frame trace recorder for Canola controllers: every received and
+ *         transmitted message is appended to a memory-mapped file, as a
+ *         fixed 32-byte record, for offline analysis or for a reader that
+ *         follows the file while it is written.
+ *
+ *         The file is allocated at its full size (header plus capacity
+ *         records) and mapped (and prefaulted) when it is created, so
+ *         TraceWriter::append() is a copy of 32 bytes into the mapping and
+ *         a store of the record count: no system calls and no allocation.
+ *         When the file is full, records are dropped and counted.
+ *
+ *         There is one writer, e.g. the thread that serves all controllers
+ *         with UioPoller, and any number of readers (TraceReader), in the
+ *         same or other processes. The writer stores the count with release
+ *         semantics after the record is written, so a reader never sees a
+ *         partial record. On close() the writer marks the trace as closed
+ *         and trims the file to the records that were written.
+ */
+
+#ifndef CANOLA_TRACE_HPP
+#define CANOLA_TRACE_HPP
+
+#include "canola.hpp"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace canola
+{
+namespace trace
+{
+
+constexpr uint64_t CAPACITY_DEFAULT = 1 << 20;  // 32 MB
+
+enum RecordFlags : uint8_t {
+  FLAG_TX           = 0x01,  // Transmitted by the controller, received otherwise
+  FLAG_EXT_ID       = 0x02,
+  FLAG_REMOTE_FRAME = 0x04
+};
+
+/**
+ * One message in the trace. Same fields as CanMsg (and can_msg_t in the C
+ * driver), with the arbitration ID in one word.
+ */
+struct Record {
+  uint64_t time_ns;      // Monotonic clock of the host when recorded
+  uint32_t timestamp;    // RX_TIMESTAMP or TX_TIMESTAMP of the controller
+  uint32_t arb_id;       // arb_id_a, or (arb_id_a << 18) | arb_id_b with FLAG_EXT_ID
+  uint8_t controller;
+  uint8_t flags;         // RecordFlags
+  uint8_t data_length;
+  uint8_t reserved[5];   // Zero
+  uint8_t payload[8];
+};
+
+static_assert(sizeof(Record) == 32, "Trace record must be 32 bytes");
+
+inline uint64_t now_ns()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline Record to_record(unsigned int controller, bool tx, const CanMsg& msg, uint32_t timestamp,
+                        uint64_t time_ns)
+{
+  Record rec;
+
+  rec.time_ns = time_ns;
+  rec.timestamp = timestamp;
+  rec.arb_id = msg.ext_id ? (msg.arb_id_a << 18) | msg.arb_id_b : msg.arb_id_a;
+  rec.controller = uint8_t(controller);
+  rec.flags = (tx ? FLAG_TX : 0) | (msg.ext_id ? FLAG_EXT_ID : 0) |
+              (msg.remote_frame ? FLAG_REMOTE_FRAME : 0);
+  rec.data_length = msg.data_length;
+  std::memset(rec.reserved, 0, sizeof(rec.reserved));
+  std::memcpy(rec.payload, msg.payload, sizeof(rec.payload));
+
+  return rec;
+}
+
+inline CanMsg to_msg(const Record& rec)
+{
+  CanMsg msg = CanMsg{};
+
+  msg.ext_id = (rec.flags & FLAG_EXT_ID) != 0;
+  msg.remote_frame = (rec.flags & FLAG_REMOTE_FRAME) != 0;
+  msg.arb_id_a = msg.ext_id ? rec.arb_id >> 18 : rec.arb_id;
+  msg.arb_id_b = msg.ext_id ? rec.arb_id & 0x3FFFF : 0;
+  msg.data_length = rec.data_length;
+  msg.timestamp = rec.timestamp;
+  std::memcpy(msg.payload, rec.payload, sizeof(msg.payload));
+
+  return msg;
+}
+
+
+/**
+ * Start of the trace file, followed by the records
+ */
+struct Header {
+  static constexpr uint32_t MAGIC   = 0x43545243;  // "CTRC"
+  static constexpr uint32_t VERSION = 1;
+
+  uint32_t magic;
+  uint32_t version;
+  uint32_t record_size;
+  uint32_t reserved;
+  uint64_t capacity;             // Records the file was allocated for
+  uint64_t start_time_ns;        // now_ns() when the trace was created
+  std::atomic<uint64_t> count;   // Records written
+  std::atomic<uint64_t> dropped; // Records dropped because the file was full
+  std::atomic<uint32_t> closed;  // Set when the writer is done
+  uint32_t padding[3];
+};
+
+static_assert(sizeof(Header) == 64, "Trace header must be 64 bytes");
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t),
+              "Atomic counters must have the same layout in every process");
+
+
+class TraceWriter
+{
+public:
+  TraceWriter() = default;
+  TraceWriter(const TraceWriter&) = delete;
+  TraceWriter& operator=(const TraceWriter&) = delete;
+
+  ~TraceWriter() { close(); }
+
+  /**
+   * Create (or replace) the trace file at path, allocated for capacity
+   * records. With prefault, all pages are mapped in now, so that append()
+   * does not take page faults.
+   */
+  bool create(const std::string& path, uint64_t capacity = CAPACITY_DEFAULT,
+              bool prefault = true)
+  {
+    close();
+
+    m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if(m_fd < 0)
+      return false;
+
+    m_size = sizeof(Header) + capacity * sizeof(Record);
+
+    // Allocate the blocks now, a write to a hole in a full file system
+    // would be a SIGBUS in append()
+    int err = ::posix_fallocate(m_fd, 0, off_t(m_size));
+    if(err == EOPNOTSUPP || err == EINVAL)
+      err = ::ftruncate(m_fd, off_t(m_size));
+
+    void* ptr = MAP_FAILED;
+    if(err == 0)
+      ptr = ::mmap(nullptr, m_size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | (prefault ? MAP_POPULATE : 0), m_fd, 0);
+
+    if(ptr == MAP_FAILED) {
+      ::close(m_fd);
+      m_fd = -1;
+      return false;
+    }
+
+    m_header = new(ptr) Header;
+    m_header->magic = Header::MAGIC;
+    m_header->version = Header::VERSION;
+    m_header->record_size = sizeof(Record);
+    m_header->reserved = 0;
+    m_header->capacity = capacity;
+    m_header->start_time_ns = now_ns();
+    m_header->count.store(0, std::memory_order_relaxed);
+    m_header->dropped.store(0, std::memory_order_relaxed);
+    m_header->closed.store(0, std::memory_order_release);
+
+    m_records = reinterpret_cast<Record*>(m_header + 1);
+    m_capacity = capacity;
+    m_count = 0;
+    return true;
+  }
+
+  bool is_open() const { return m_header != nullptr; }
+  uint64_t count() const { return m_count; }
+  uint64_t capacity() const { return m_capacity; }
+  uint64_t dropped() const { return m_header->dropped.load(std::memory_order_relaxed); }
+
+  // Returns false, and counts the record as dropped, when the file is full
+  bool append(const Record& rec)
+  {
+    if(m_count == m_capacity) {
+      m_header->dropped.store(dropped() + 1, std::memory_order_relaxed);
+      return false;
+    }
+
+    m_records[m_count] = rec;
+    m_header->count.store(++m_count, std::memory_order_release);
+    return true;
+  }
+
+  // Received message, with the timestamp read by the driver
+  bool rx(unsigned int controller, const CanMsg& msg, uint64_t time_ns = now_ns())
+  {
+    return append(to_record(controller, false, msg, msg.timestamp, time_ns));
+  }
+
+  // Transmitted message, with the TX_TIMESTAMP of the controller
+  bool tx(unsigned int controller, const CanMsg& msg, uint32_t timestamp,
+          uint64_t time_ns = now_ns())
+  {
+    return append(to_record(controller, true, msg, timestamp, time_ns));
+  }
+
+  /**
+   * Mark the trace as closed for readers, and trim the file to the records
+   * written. Readers only access records below the count, which are kept.
+   */
+  void close()
+  {
+    if(m_header == nullptr)
+      return;
+
+    m_header->closed.store(1, std::memory_order_release);
+    ::munmap(m_header, m_size);
+    m_header = nullptr;
+    m_records = nullptr;
+
+    if(::ftruncate(m_fd, off_t(sizeof(Header) + m_count * sizeof(Record))) != 0) {
+      // Keeps the full size, which is still a valid trace
+    }
+    ::close(m_fd);
+    m_fd = -1;
+  }
+
+private:
+  int m_fd = -1;
+  size_t m_size = 0;
+  Header* m_header = nullptr;
+  Record* m_records = nullptr;
+  uint64_t m_capacity = 0;
+  uint64_t m_count = 0;
+};
+
+
+/**
+ * Read-only view of a trace file, while it is written or after. Records
+ * are read in place from the mapping.
+ */
+class TraceReader
+{
+public:
+  TraceReader() = default;
+  TraceReader(const TraceReader&) = delete;
+  TraceReader& operator=(const TraceReader&) = delete;
+
+  ~TraceReader()
+  {
+    if(m_header != nullptr)
+      ::munmap(const_cast<Header*>(m_header), m_size);
+  }
+
+  bool open(const std::string& path)
+  {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0)
+      return false;
+
+    struct stat st;
+    void* ptr = MAP_FAILED;
+    if(::fstat(fd, &st) == 0 && size_t(st.st_size) >= sizeof(Header)) {
+      m_size = size_t(st.st_size);
+      ptr = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+
+    if(ptr == MAP_FAILED)
+      return false;
+
+    const Header* header = static_cast<const Header*>(ptr);
+    if(header->magic != Header::MAGIC || header->version != Header::VERSION ||
+       header->record_size != sizeof(Record)) {
+      ::munmap(ptr, m_size);
+      return false;
+    }
+
+    m_header = header;
+    m_records = reinterpret_cast<const Record*>(header + 1);
+    m_max_count = (m_size - sizeof(Header)) / sizeof(Record);
+    return true;
+  }
+
+  bool is_open() const { return m_header != nullptr; }
+
+  /**
+   * Records written so far. All records below the count are complete. A
+   * record past the end of the file as it was mapped is not counted,
+   * which only happens if the file was changed by something else.
+   */
+  uint64_t count() const
+  {
+    const uint64_t count = m_header->count.load(std::memory_order_acquire);
+    return count < m_max_count ? count : m_max_count;
+  }
+
+  // The writer is done, count() is final
+  bool closed() const { return m_header->closed.load(std::memory_order_acquire) != 0; }
+
+  uint64_t dropped() const { return m_header->dropped.load(std::memory_order_relaxed); }
+  uint64_t capacity() const { return m_header->capacity; }
+  uint64_t start_time_ns() const { return m_header->start_time_ns; }
+
+  const Record* records() const { return m_records; }
+  const Record& operator[](uint64_t index) const { return m_records[index]; }
+
+private:
+  size_t m_size = 0;
+  const Header* m_header = nullptr;
+  const Record* m_records = nullptr;
+  uint64_t m_max_count = 0;
+};
+
+} // namespace trace
+} // namespace canola
+
+#endif
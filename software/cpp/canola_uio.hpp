@@ -0,0 +1,450 @@
+/**
+ * @file   canola_uio.hpp
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Linux userspace (UIO) driver support for the Canola CAN controller
+ *         AXI-slave. The register space of each controller is mmapped
+ *         through UIO, and the CAN_RX_VALID_IRQ, CAN_TX_DONE_IRQ and
+ *         CAN_TX_FAILED_IRQ lines are exposed as pollable file descriptors,
+ *         so that one thread can serve all controllers with epoll.
+ *
+ *         The UIO generic platform driver (uio_pdrv_genirq) supports one
+ *         interrupt per UIO device, so each interrupt line of a controller
+ *         needs its own UIO device in the device tree. E.g.:
+ *
+ *           canola0: canola@43c00000 {
+ *             compatible = "generic-uio";
+ *             reg = <0x43c00000 0x10000>;
+ *             interrupts = <0 29 1>;     // CAN_RX_VALID_IRQ
+ *           };
+ *           canola0_tx_done {
+ *             compatible = "generic-uio";
+ *             interrupts = <0 30 1>;     // CAN_TX_DONE_IRQ
+ *           };
+ *           canola0_tx_failed {
+ *             compatible = "generic-uio";
+ *             interrupts = <0 31 1>;     // CAN_TX_FAILED_IRQ
+ *           };
+ *
+ *         For testing on a plain Linux machine, FakeUio provides the same
+ *         interface backed by a memory file (register space) and eventfds
+ *         (interrupts).
+ */
+
+#ifndef CANOLA_UIO_HPP
+#define CANOLA_UIO_HPP
+
+#include "canola.hpp"
+#include "canola_io.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace canola
+{
+
+enum class Irq : unsigned int {
+  RX_VALID  = 0,
+  TX_DONE   = 1,
+  TX_FAILED = 2
+};
+
+constexpr unsigned int NUM_IRQS = 3;
+
+
+/**
+ * Pollable file descriptor for one interrupt line. Either a UIO device
+ * (/dev/uioX, 32-bit event counter) or an eventfd (64-bit event counter),
+ * the latter is used by FakeUio.
+ */
+class IrqSource
+{
+public:
+  enum class Kind { UIO, EVENTFD };
+
+  IrqSource() = default;
+  IrqSource(int fd, Kind kind) : m_fd(fd), m_kind(kind) {}
+
+  IrqSource(IrqSource&& other) noexcept
+    : m_fd(other.m_fd), m_kind(other.m_kind)
+  {
+    other.m_fd = -1;
+  }
+
+  IrqSource& operator=(IrqSource&& other) noexcept
+  {
+    std::swap(m_fd, other.m_fd);
+    std::swap(m_kind, other.m_kind);
+    return *this;
+  }
+
+  IrqSource(const IrqSource&) = delete;
+  IrqSource& operator=(const IrqSource&) = delete;
+
+  ~IrqSource()
+  {
+    if(m_fd >= 0)
+      ::close(m_fd);
+  }
+
+  bool is_open() const { return m_fd >= 0; }
+  int fd() const { return m_fd; }
+
+  /**
+   * (Re)enable the interrupt. UIO masks the interrupt in the kernel
+   * when it fires, and it has to be unmasked after each event.
+   */
+  bool enable()
+  {
+    if(m_kind != Kind::UIO)
+      return true;
+
+    uint32_t unmask = 1;
+    return ::write(m_fd, &unmask, sizeof(unmask)) == sizeof(unmask);
+  }
+
+  /**
+   * Consume a pending event. Returns the UIO total interrupt count (UIO),
+   * or the number of events since the last call (eventfd). Returns -1 if
+   * no event was pending (non-blocking fd) or on error.
+   */
+  int64_t acknowledge()
+  {
+    if(m_kind == Kind::UIO) {
+      uint32_t count;
+      if(::read(m_fd, &count, sizeof(count)) != sizeof(count))
+        return -1;
+      return count;
+    } else {
+      uint64_t count;
+      if(::read(m_fd, &count, sizeof(count)) != sizeof(count))
+        return -1;
+      return int64_t(count);
+    }
+  }
+
+private:
+  int m_fd = -1;
+  Kind m_kind = Kind::UIO;
+};
+
+
+/**
+ * One Canola controller accessed from userspace: mapped register space and
+ * the three interrupt lines.
+ */
+class UioDevice
+{
+public:
+  static constexpr size_t DEFAULT_MAP_SIZE = 0x1000;
+
+  UioDevice() = default;
+
+  UioDevice(UioDevice&& other) noexcept { swap(other); }
+  UioDevice& operator=(UioDevice&& other) noexcept { swap(other); return *this; }
+  UioDevice(const UioDevice&) = delete;
+  UioDevice& operator=(const UioDevice&) = delete;
+
+  ~UioDevice() { unmap(); }
+
+  /**
+   * Open a controller through UIO.
+   * @param regs_dev Device with the register space as map 0, e.g. "/dev/uio0".
+   *                 This device also delivers CAN_RX_VALID_IRQ.
+   * @param tx_done_dev   Device for CAN_TX_DONE_IRQ (may be empty)
+   * @param tx_failed_dev Device for CAN_TX_FAILED_IRQ (may be empty)
+   * @param map_size Size of register space mapping
+   */
+  bool open(const std::string& regs_dev,
+            const std::string& tx_done_dev,
+            const std::string& tx_failed_dev,
+            size_t map_size = DEFAULT_MAP_SIZE)
+  {
+    int regs_fd = ::open(regs_dev.c_str(), O_RDWR | O_CLOEXEC | O_NONBLOCK);
+    if(regs_fd < 0)
+      return false;
+
+    // Map 0 of a UIO device is mapped by using offset 0*pagesize
+    if(!map(regs_fd, map_size)) {
+      ::close(regs_fd);
+      return false;
+    }
+
+    m_irqs[unsigned(Irq::RX_VALID)] = IrqSource(regs_fd, IrqSource::Kind::UIO);
+
+    if(!open_irq(Irq::TX_DONE, tx_done_dev) || !open_irq(Irq::TX_FAILED, tx_failed_dev))
+      return false;
+
+    for(auto& irq : m_irqs) {
+      if(irq.is_open())
+        irq.enable();
+    }
+
+    return true;
+  }
+
+  /**
+   * Open a fake controller: register space backed by a memory file, and
+   * interrupts backed by eventfds. Takes ownership of the file descriptors.
+   */
+  bool open_fake(int mem_fd, int rx_valid_efd, int tx_done_efd, int tx_failed_efd,
+                 size_t map_size = DEFAULT_MAP_SIZE)
+  {
+    bool mapped = map(mem_fd, map_size);
+    ::close(mem_fd);
+
+    m_irqs[unsigned(Irq::RX_VALID)]  = IrqSource(rx_valid_efd, IrqSource::Kind::EVENTFD);
+    m_irqs[unsigned(Irq::TX_DONE)]   = IrqSource(tx_done_efd, IrqSource::Kind::EVENTFD);
+    m_irqs[unsigned(Irq::TX_FAILED)] = IrqSource(tx_failed_efd, IrqSource::Kind::EVENTFD);
+
+    return mapped;
+  }
+
+  bool is_open() const { return m_base != nullptr; }
+
+  MmapIO io() const { return MmapIO(m_base); }
+  IrqSource& irq(Irq irq) { return m_irqs[unsigned(irq)]; }
+
+private:
+  bool map(int fd, size_t size)
+  {
+    void* ptr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if(ptr == MAP_FAILED)
+      return false;
+
+    m_base = ptr;
+    m_map_size = size;
+    return true;
+  }
+
+  void unmap()
+  {
+    if(m_base != nullptr)
+      ::munmap(m_base, m_map_size);
+    m_base = nullptr;
+  }
+
+  bool open_irq(Irq irq, const std::string& dev)
+  {
+    if(dev.empty())
+      return true;
+
+    int fd = ::open(dev.c_str(), O_RDWR | O_CLOEXEC | O_NONBLOCK);
+    if(fd < 0)
+      return false;
+
+    m_irqs[unsigned(irq)] = IrqSource(fd, IrqSource::Kind::UIO);
+    return true;
+  }
+
+  void swap(UioDevice& other)
+  {
+    std::swap(m_base, other.m_base);
+    std::swap(m_map_size, other.m_map_size);
+    for(unsigned int i = 0; i < NUM_IRQS; i++)
+      std::swap(m_irqs[i], other.m_irqs[i]);
+  }
+
+  void* m_base = nullptr;
+  size_t m_map_size = 0;
+  IrqSource m_irqs[NUM_IRQS];
+};
+
+
+/**
+ * Waits for interrupts from any number of controllers with one epoll
+ * instance. Events are acknowledged, and the interrupt re-enabled, before
+ * they are returned. Check is_open() after construction, add() and wait()
+ * fail if the epoll instance could not be created.
+ */
+class UioPoller
+{
+public:
+  struct Event {
+    unsigned int dev_index;
+    Irq irq;
+  };
+
+  UioPoller() : m_epoll_fd(::epoll_create1(EPOLL_CLOEXEC)) {}
+
+  ~UioPoller()
+  {
+    if(m_epoll_fd >= 0)
+      ::close(m_epoll_fd);
+  }
+
+  UioPoller(const UioPoller&) = delete;
+  UioPoller& operator=(const UioPoller&) = delete;
+
+  bool is_open() const { return m_epoll_fd >= 0; }
+
+  /**
+   * Add all open interrupt lines of dev. The device must outlive the poller.
+   * dev_index is returned in Event::dev_index for events from this device.
+   * If an interrupt line can not be added, the lines of dev that were
+   * already added are removed again, and false is returned.
+   */
+  bool add(UioDevice& dev, unsigned int dev_index)
+  {
+    if(!is_open())
+      return false;
+
+    const size_t num_entries = m_entries.size();
+
+    for(unsigned int i = 0; i < NUM_IRQS; i++) {
+      IrqSource& irq = dev.irq(static_cast<Irq>(i));
+      if(!irq.is_open())
+        continue;
+
+      m_entries.push_back(Entry{&irq, dev_index, static_cast<Irq>(i)});
+
+      struct epoll_event ev = {};
+      ev.events = EPOLLIN;
+      ev.data.ptr = &m_entries.back();
+
+      if(::epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, irq.fd(), &ev) != 0) {
+        m_entries.pop_back();
+
+        while(m_entries.size() > num_entries) {
+          ::epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, m_entries.back().source->fd(), nullptr);
+          m_entries.pop_back();
+        }
+
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * Wait for interrupts. Returns number of events written to events,
+   * 0 on timeout, or -1 on error. timeout_ms < 0 waits forever.
+   */
+  int wait(Event* events, int max_events, int timeout_ms = -1)
+  {
+    struct epoll_event ev[MAX_EVENTS];
+
+    if(!is_open())
+      return -1;
+
+    if(max_events > MAX_EVENTS)
+      max_events = MAX_EVENTS;
+
+    int n = ::epoll_wait(m_epoll_fd, ev, max_events, timeout_ms);
+
+    for(int i = 0; i < n; i++) {
+      const Entry* entry = static_cast<const Entry*>(ev[i].data.ptr);
+
+      entry->source->acknowledge();
+      entry->source->enable();
+
+      events[i].dev_index = entry->dev_index;
+      events[i].irq = entry->irq;
+    }
+
+    return n;
+  }
+
+private:
+  static constexpr int MAX_EVENTS = 64;
+
+  struct Entry {
+    IrqSource* source;
+    unsigned int dev_index;
+    Irq irq;
+  };
+
+  int m_epoll_fd;
+  std::deque<Entry> m_entries; // deque: pointers to elements stay valid
+};
+
+
+/**
+ * Fake UIO controller for testing on a machine without the hardware.
+ * The register space is an anonymous memory file, and the interrupts are
+ * eventfds. device() returns a UioDevice that shares both, so a test (or
+ * a simulator) can update registers through regs() and fire interrupts
+ * with raise(), while the code under test uses the UioDevice.
+ */
+class FakeUio
+{
+public:
+  explicit FakeUio(size_t map_size = UioDevice::DEFAULT_MAP_SIZE)
+    : m_map_size(map_size)
+  {
+    char name[] = "/tmp/canola_fake_uio_XXXXXX";
+    m_mem_fd = ::mkstemp(name);
+    if(m_mem_fd < 0)
+      return;
+
+    ::unlink(name);
+    if(::ftruncate(m_mem_fd, off_t(map_size)) != 0)
+      return;
+
+    void* ptr = ::mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_mem_fd, 0);
+    if(ptr != MAP_FAILED)
+      m_base = ptr;
+
+    for(auto& efd : m_efds)
+      efd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  }
+
+  ~FakeUio()
+  {
+    if(m_base != nullptr)
+      ::munmap(m_base, m_map_size);
+    for(int efd : m_efds) {
+      if(efd >= 0)
+        ::close(efd);
+    }
+    if(m_mem_fd >= 0)
+      ::close(m_mem_fd);
+  }
+
+  FakeUio(const FakeUio&) = delete;
+  FakeUio& operator=(const FakeUio&) = delete;
+
+  bool is_open() const
+  {
+    return m_base != nullptr && m_efds[0] >= 0 && m_efds[1] >= 0 && m_efds[2] >= 0;
+  }
+
+  // Register space as seen by the "hardware" side
+  MmapIO regs() const { return MmapIO(m_base); }
+
+  // Fire an interrupt
+  bool raise(Irq irq)
+  {
+    uint64_t one = 1;
+    return ::write(m_efds[unsigned(irq)], &one, sizeof(one)) == sizeof(one);
+  }
+
+  // Open a UioDevice backed by this fake device
+  bool device(UioDevice& dev) const
+  {
+    return dev.open_fake(::dup(m_mem_fd),
+                         ::dup(m_efds[unsigned(Irq::RX_VALID)]),
+                         ::dup(m_efds[unsigned(Irq::TX_DONE)]),
+                         ::dup(m_efds[unsigned(Irq::TX_FAILED)]),
+                         m_map_size);
+  }
+
+private:
+  size_t m_map_size;
+  int m_mem_fd = -1;
+  int m_efds[NUM_IRQS] = {-1, -1, -1};
+  void* m_base = nullptr;
+};
+
+} // namespace canola
+
+#endif
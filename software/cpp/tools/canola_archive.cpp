@@ -0,0 +1,568 @@
+/**
+ * @file   canola_archive.cpp
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Compressed archive of frame traces, see canola_archive.hpp.
+ *
+ *         check:  Converts a generated trace with periodic messages and
+ *                 bursts of rare IDs to an archive, and checks that all
+ *                 frames come back, and that queries by ID, time range and
+ *                 controller find the same frames as a scan of the trace
+ *                 while skipping blocks. Also with tiny blocks and blocks
+ *                 with more than 256 IDs.
+ *         bench [frames=5000000]:
+ *                 Size and conversion speed for a generated trace, and the
+ *                 time of a full decode and of a query for a rare ID,
+ *                 compared to a scan of the trace.
+ *         convert <trace> <archive> [block_frames=4096]:
+ *                 Converts a trace from canola_trace.hpp.
+ *         query <archive> [id=<hex>] [ext=<hex>] [from=<s>] [to=<s>] [controller=<n>]:
+ *                 Prints the frames that match, times in seconds from the
+ *                 start of the trace.
+ *         info <archive>:
+ *                 Frames, blocks and size.
+ *
+ *         Build: g++ -std=c++14 -O2 -march=native -pthread -I.. canola_archive.cpp -o canola_archive
+ */
+
+#include "canola_archive.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace canola;
+
+static unsigned int g_errors = 0;
+
+static void check(bool ok, const char* what, uint64_t index)
+{
+  if(!ok) {
+    if(g_errors < 10)
+      printf("%s (%llu)\n", what, (unsigned long long)index);
+    g_errors++;
+  }
+}
+
+// Same format as canola_trace dump
+static int format_record(char* buf, size_t size, const trace::Record& rec, uint64_t start_ns)
+{
+  const double seconds = 1e-9 * double(int64_t(rec.time_ns - start_ns));
+  int len = snprintf(buf, size, "%14.6f  %u %s %10lu  %*lx%s [%u]", seconds, rec.controller,
+                     (rec.flags & trace::FLAG_TX) ? "Tx" : "Rx", (unsigned long)rec.timestamp,
+                     (rec.flags & trace::FLAG_EXT_ID) ? 8 : 3, (unsigned long)rec.arb_id,
+                     (rec.flags & trace::FLAG_REMOTE_FRAME) ? " R" : "  ", rec.data_length);
+
+  if(!(rec.flags & trace::FLAG_REMOTE_FRAME)) {
+    for(unsigned int i = 0; i < rec.data_length && i < 8 && len < int(size); i++)
+      len += snprintf(buf + len, size - len, " %02x", rec.payload[i]);
+  }
+
+  return len;
+}
+
+static std::string temp_path(const char* name)
+{
+  const char* dir = getenv("TMPDIR");
+  return std::string(dir != nullptr ? dir : "/tmp") + "/canola_archive_" +
+         std::to_string(::getpid()) + "_" + name;
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+//-----------------------------------------------------------------------------
+// Traffic
+//-----------------------------------------------------------------------------
+
+/**
+ * Bus traffic like on a vehicle: messages with fixed IDs sent periodically
+ * (1 ms to 1 s) by four controllers, with a counter and slowly changing
+ * signals in the payload, plus bursts of diagnostic messages with IDs that
+ * are seldom seen. Host time starts at start_ns, the controller timestamps
+ * count at 100 MHz.
+ */
+static std::vector<trace::Record> generate_traffic(uint64_t num_frames, uint64_t start_ns,
+                                                   unsigned int seed = 1)
+{
+  struct Periodic {
+    uint64_t next_ns;
+    uint64_t period_ns;
+    CanMsg msg;
+    unsigned int controller;
+    bool operator>(const Periodic& other) const { return next_ns > other.next_ns; }
+  };
+
+  std::mt19937 rng(seed);
+  std::priority_queue<Periodic, std::vector<Periodic>, std::greater<Periodic>> queue;
+  const uint64_t periods_ms[] = {1, 5, 10, 10, 20, 20, 50, 100, 100, 100, 500, 1000};
+
+  for(unsigned int i = 0; i < 60; i++) {
+    Periodic p = {};
+    p.period_ns = periods_ms[rng() % 12] * 1000000;
+    p.next_ns = start_ns + rng() % p.period_ns;
+    p.controller = rng() % 4;
+    p.msg.ext_id = i % 4 == 3;
+    p.msg.arb_id_a = 0x100 + rng() % 0x500;  // No diagnostic IDs
+    p.msg.arb_id_b = p.msg.ext_id ? rng() % 262144 : 0;
+    p.msg.data_length = rng() % 9;
+    for(unsigned int b = 0; b < 8; b++)
+      p.msg.payload[b] = b < p.msg.data_length ? rng() % 256 : 0;
+    queue.push(p);
+  }
+
+  std::vector<trace::Record> records;
+  records.reserve(num_frames);
+
+  while(records.size() < num_frames) {
+    Periodic p = queue.top();
+    queue.pop();
+
+    // Jitter of the sender and the recorder
+    const uint64_t time_ns = p.next_ns + rng() % 20000;
+    records.push_back(trace::to_record(p.controller, false, p.msg, uint32_t(time_ns / 10),
+                                       time_ns));
+
+    // Counter in the first byte, a signal that changes now and then
+    if(p.msg.data_length > 0)
+      p.msg.payload[0]++;
+    if(p.msg.data_length > 2 && rng() % 16 == 0)
+      p.msg.payload[2] += rng() % 5 - 2;
+    p.next_ns += p.period_ns;
+    queue.push(p);
+
+    // Now and then a diagnostic session of request and response frames
+    if(rng() % 20000 == 0) {
+      const uint32_t request = 0x7E0 + rng() % 8;
+      uint64_t diag_ns = time_ns + 10000;
+      for(unsigned int n = 0; n < 40 && records.size() < num_frames; n++) {
+        CanMsg msg = CanMsg{};
+        msg.arb_id_a = n % 2 ? request + 8 : request;
+        msg.data_length = 8;
+        for(unsigned int b = 0; b < 8; b++)
+          msg.payload[b] = rng() % 256;
+        records.push_back(trace::to_record(n % 2 ? 1 : 0, n % 2 == 0, msg,
+                                           uint32_t(diag_ns / 10), diag_ns));
+        diag_ns += 200000;
+      }
+    }
+  }
+
+  // Sessions overlap the periodic frames a little, keep the trace in time order
+  std::stable_sort(records.begin(), records.end(),
+                   [](const trace::Record& a, const trace::Record& b) {
+                     return a.time_ns < b.time_ns;
+                   });
+  return records;
+}
+
+static bool write_archive(const std::string& path, const std::vector<trace::Record>& records,
+                          uint64_t start_ns, unsigned int block_frames)
+{
+  archive::ArchiveWriter writer;
+  if(!writer.create(path, start_ns, block_frames))
+    return false;
+  for(const trace::Record& rec : records)
+    writer.append(rec);
+  return writer.close();
+}
+
+//-----------------------------------------------------------------------------
+// Check
+//-----------------------------------------------------------------------------
+static void check_varint()
+{
+  const int64_t values[] = {0, 1, -1, 63, -64, 64, 127, 128, 1 << 20, -(1 << 20), INT64_MAX,
+                            INT64_MIN};
+
+  for(unsigned int i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+    std::vector<uint8_t> buf;
+    archive::put_varint(buf, archive::zigzag(values[i]));
+
+    const uint8_t* pos = buf.data();
+    uint64_t value = 0;
+    check(archive::get_varint(pos, buf.data() + buf.size(), value) &&
+          pos == buf.data() + buf.size() && archive::unzigzag(value) == values[i], "Varint", i);
+
+    pos = buf.data();
+    check(!archive::get_varint(pos, buf.data() + buf.size() - 1, value), "Short varint", i);
+  }
+}
+
+static bool same_records(const std::vector<trace::Record>& a, const std::vector<trace::Record>& b)
+{
+  return a.size() == b.size() &&
+         (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(trace::Record)) == 0);
+}
+
+// Query the archive, and the records directly, for the same frames
+template <typename Match>
+static void check_query(const archive::ArchiveReader& reader,
+                        const std::vector<trace::Record>& records, const archive::Query& q,
+                        Match&& match, const char* name, bool expect_skip)
+{
+  std::vector<trace::Record> expected;
+  for(const trace::Record& rec : records) {
+    if(match(rec))
+      expected.push_back(rec);
+  }
+
+  std::vector<trace::Record> found;
+  archive::QueryStats stats;
+  const uint64_t count = reader.query(q, [&](const trace::Record& rec) { found.push_back(rec); },
+                                      &stats);
+
+  check(count == expected.size() && same_records(found, expected), name, found.size());
+  check(!expect_skip || stats.blocks_skipped + stats.blocks_no_entry > 0, "Blocks skipped",
+        stats.blocks_skipped);
+
+  printf("  %-28s %8zu frames, %5llu of %5llu blocks decoded\n", name, found.size(),
+         (unsigned long long)stats.blocks_decoded, (unsigned long long)reader.num_blocks());
+}
+
+static void check_queries(const std::string& path, const std::vector<trace::Record>& records)
+{
+  archive::ArchiveReader reader;
+  check(reader.open(path), "Open", 0);
+  if(!reader.is_open())
+    return;
+
+  // A rare diagnostic ID, and a periodic one
+  uint32_t rare_id = 0;
+  for(const trace::Record& rec : records) {
+    if(rec.arb_id >= 0x7E0 && !(rec.flags & trace::FLAG_EXT_ID)) {
+      rare_id = rec.arb_id;
+      break;
+    }
+  }
+  check(rare_id != 0, "No diagnostic session in the traffic", 0);
+  const trace::Record& periodic = records[records.size() / 2];
+  const bool periodic_ext = periodic.flags & trace::FLAG_EXT_ID;
+
+  archive::Query q;
+  q.set_id(rare_id, false);
+  check_query(reader, records, q, [&](const trace::Record& rec) {
+      return rec.arb_id == rare_id && !(rec.flags & trace::FLAG_EXT_ID);
+    }, "Rare ID", true);
+
+  q.set_id(periodic.arb_id, periodic_ext);
+  check_query(reader, records, q, [&](const trace::Record& rec) {
+      return rec.arb_id == periodic.arb_id && bool(rec.flags & trace::FLAG_EXT_ID) == periodic_ext;
+    }, "Periodic ID", false);
+
+  // Same bit in the ID bitmap as the periodic ID, but not in any block
+  const uint32_t other_id = periodic_ext ? periodic.arb_id ^ 1 : (periodic.arb_id << 18) | 1;
+  q.set_id(other_id, true);
+  check_query(reader, records, q, [&](const trace::Record& rec) {
+      return rec.arb_id == other_id && (rec.flags & trace::FLAG_EXT_ID);
+    }, "ID not in the dictionaries", true);
+
+  const uint64_t span_ns = records.back().time_ns - records.front().time_ns;
+  archive::Query range;
+  range.from_ns = records.front().time_ns + span_ns / 3;
+  range.to_ns = records.front().time_ns + span_ns / 3 + span_ns / 50;
+  check_query(reader, records, range, [&](const trace::Record& rec) {
+      return rec.time_ns >= range.from_ns && rec.time_ns < range.to_ns;
+    }, "Time range", true);
+
+  range.controller = 2;
+  check_query(reader, records, range, [&](const trace::Record& rec) {
+      return rec.time_ns >= range.from_ns && rec.time_ns < range.to_ns && rec.controller == 2;
+    }, "Time range, controller 2", true);
+
+  range.set_id(rare_id, false);
+  check_query(reader, records, range, [&](const trace::Record& rec) {
+      return rec.time_ns >= range.from_ns && rec.time_ns < range.to_ns && rec.controller == 2 &&
+             rec.arb_id == rare_id && !(rec.flags & trace::FLAG_EXT_ID);
+    }, "Time range, controller, ID", true);
+}
+
+static void check_roundtrip(const std::string& path, const std::vector<trace::Record>& records,
+                            unsigned int block_frames, const char* name)
+{
+  check(write_archive(path, records, 0, block_frames), "Write", block_frames);
+
+  archive::ArchiveReader reader;
+  check(reader.open(path), "Open", block_frames);
+  if(!reader.is_open())
+    return;
+
+  std::vector<trace::Record> all;
+  reader.query(archive::Query(), [&](const trace::Record& rec) { all.push_back(rec); });
+
+  check(reader.num_frames() == records.size(), "Frames", reader.num_frames());
+  check(same_records(all, records), name, all.size());
+}
+
+static int run_check()
+{
+  constexpr uint64_t NUM_FRAMES = 500000;
+  const uint64_t start_ns = 1000000000;
+  const std::string trace_path = temp_path("check.trace");
+  const std::string archive_path = temp_path("check.archive");
+
+  check_varint();
+
+  std::vector<trace::Record> records = generate_traffic(NUM_FRAMES, start_ns);
+
+  // Through a trace file, as the converter does it
+  {
+    trace::TraceWriter writer;
+    check(writer.create(trace_path, records.size()), "Create trace", 0);
+    for(const trace::Record& rec : records)
+      writer.append(rec);
+  }
+
+  trace::TraceReader trace_reader;
+  check(trace_reader.open(trace_path), "Open trace", 0);
+  if(trace_reader.is_open()) {
+    archive::ArchiveWriter writer;
+    check(writer.create(archive_path, trace_reader.start_time_ns()), "Create archive", 0);
+    for(uint64_t i = 0; i < trace_reader.count(); i++)
+      writer.append(trace_reader[i]);
+    check(writer.close(), "Close archive", 0);
+  }
+
+  archive::ArchiveReader reader;
+  check(reader.open(archive_path), "Open archive", 0);
+  if(reader.is_open()) {
+    std::vector<trace::Record> all;
+    reader.query(archive::Query(), [&](const trace::Record& rec) { all.push_back(rec); });
+    check(same_records(all, records), "All frames", all.size());
+
+    const double raw = sizeof(trace::Header) + records.size() * sizeof(trace::Record);
+    printf("%zu frames: trace %.1f MB, archive %.1f MB (%.1f bytes per frame, %.1fx)\n",
+           records.size(), 1e-6 * raw, 1e-6 * reader.size(), double(reader.size()) / records.size(),
+           raw / reader.size());
+  }
+
+  check_queries(archive_path, records);
+
+  // Small and odd blocks, one frame per block, and more than 256 IDs in a block
+  std::vector<trace::Record> few(records.begin(), records.begin() + 1000);
+  check_roundtrip(archive_path, few, 1, "One frame per block");
+  check_roundtrip(archive_path, few, 7, "Seven frames per block");
+
+  std::mt19937 rng(3);
+  for(trace::Record& rec : few)
+    rec.arb_id = (rec.flags & trace::FLAG_EXT_ID) ? rng() % (1u << 29) : rng() % 2048;
+  check_roundtrip(archive_path, few, 4096, "Wide dictionary");
+
+  check_roundtrip(archive_path, std::vector<trace::Record>(), 4096, "Empty archive");
+
+  // An archive that was not closed has no index
+  {
+    archive::ArchiveWriter writer;
+    writer.create(archive_path);
+    for(const trace::Record& rec : few)
+      writer.append(rec);
+    archive::ArchiveReader unclosed;
+    check(!unclosed.open(archive_path), "Open without index", 0);
+  }
+
+  ::unlink(trace_path.c_str());
+  ::unlink(archive_path.c_str());
+
+  printf("%s (%u errors)\n", g_errors == 0 ? "OK" : "FAILED", g_errors);
+  return g_errors == 0 ? 0 : 1;
+}
+
+//-----------------------------------------------------------------------------
+// Bench
+//-----------------------------------------------------------------------------
+static void run_bench(uint64_t num_frames)
+{
+  const std::string path = temp_path("bench.archive");
+  const std::vector<trace::Record> records = generate_traffic(num_frames, 0);
+
+  auto start = std::chrono::steady_clock::now();
+  write_archive(path, records, 0, archive::BLOCK_FRAMES_DEFAULT);
+  const double write_seconds = seconds_since(start);
+
+  archive::ArchiveReader reader;
+  if(!reader.open(path)) {
+    printf("Could not open %s\n", path.c_str());
+    return;
+  }
+
+  uint64_t sum = 0;
+  start = std::chrono::steady_clock::now();
+  reader.query(archive::Query(), [&](const trace::Record& rec) { sum += rec.payload[0]; });
+  const double decode_seconds = seconds_since(start);
+
+  uint32_t rare_id = 0x7E0;
+  for(const trace::Record& rec : records) {
+    if(rec.arb_id >= 0x7E0 && !(rec.flags & trace::FLAG_EXT_ID)) {
+      rare_id = rec.arb_id;
+      break;
+    }
+  }
+
+  archive::Query q;
+  q.set_id(rare_id, false);
+  archive::QueryStats stats;
+  start = std::chrono::steady_clock::now();
+  reader.query(q, [&](const trace::Record& rec) { sum += rec.payload[0]; }, &stats);
+  const double query_seconds = seconds_since(start);
+
+  uint64_t scan_matches = 0;
+  start = std::chrono::steady_clock::now();
+  for(const trace::Record& rec : records)
+    scan_matches += rec.arb_id == rare_id && !(rec.flags & trace::FLAG_EXT_ID);
+  const double scan_seconds = seconds_since(start);
+
+  const double raw = double(records.size()) * sizeof(trace::Record);
+  printf("%zu frames, %.1f MB as trace, %.1f MB archived (%.1f bytes per frame, %.1fx)\n",
+         records.size(), 1e-6 * raw, 1e-6 * reader.size(), double(reader.size()) / records.size(),
+         raw / reader.size());
+  printf("Convert:                %8.1f M frames/s\n", 1e-6 * records.size() / write_seconds);
+  printf("Decode all:             %8.1f M frames/s\n", 1e-6 * records.size() / decode_seconds);
+  printf("Query for ID %03x:       %8.2f ms (%llu frames, %llu of %llu blocks decoded)\n", rare_id,
+         1e3 * query_seconds, (unsigned long long)stats.frames_matched,
+         (unsigned long long)stats.blocks_decoded, (unsigned long long)reader.num_blocks());
+  printf("Scan of trace in memory: %7.2f ms (%llu frames)\n", 1e3 * scan_seconds,
+         (unsigned long long)scan_matches);
+  if(sum == 1)
+    printf("\n");
+
+  ::unlink(path.c_str());
+}
+
+//-----------------------------------------------------------------------------
+// Converter and query
+//-----------------------------------------------------------------------------
+static int run_convert(const char* trace_path, const char* archive_path, unsigned int block_frames)
+{
+  trace::TraceReader reader;
+  if(!reader.open(trace_path)) {
+    printf("Could not open %s\n", trace_path);
+    return 1;
+  }
+
+  archive::ArchiveWriter writer;
+  if(!writer.create(archive_path, reader.start_time_ns(), block_frames)) {
+    printf("Could not create %s\n", archive_path);
+    return 1;
+  }
+
+  const uint64_t count = reader.count();
+  for(uint64_t i = 0; i < count; i++)
+    writer.append(reader[i]);
+
+  if(!writer.close()) {
+    printf("Could not write %s\n", archive_path);
+    return 1;
+  }
+
+  const double raw = sizeof(trace::Header) + count * sizeof(trace::Record);
+  printf("%llu frames, %.1f MB to %.1f MB\n", (unsigned long long)count, 1e-6 * raw,
+         1e-6 * writer.size());
+  return 0;
+}
+
+static int run_query(const char* path, int argc, char** argv)
+{
+  archive::ArchiveReader reader;
+  if(!reader.open(path)) {
+    printf("Could not open %s\n", path);
+    return 1;
+  }
+
+  const uint64_t start_ns = reader.header().start_time_ns;
+  archive::Query q;
+
+  for(int i = 0; i < argc; i++) {
+    const char* value = strchr(argv[i], '=');
+    if(value == nullptr) {
+      printf("Unknown argument %s\n", argv[i]);
+      return 1;
+    }
+    value++;
+
+    if(strncmp(argv[i], "id=", 3) == 0)
+      q.set_id(strtoul(value, nullptr, 16), false);
+    else if(strncmp(argv[i], "ext=", 4) == 0)
+      q.set_id(strtoul(value, nullptr, 16), true);
+    else if(strncmp(argv[i], "from=", 5) == 0)
+      q.from_ns = start_ns + uint64_t(strtod(value, nullptr) * 1e9);
+    else if(strncmp(argv[i], "to=", 3) == 0)
+      q.to_ns = start_ns + uint64_t(strtod(value, nullptr) * 1e9);
+    else if(strncmp(argv[i], "controller=", 11) == 0)
+      q.controller = atoi(value);
+    else {
+      printf("Unknown argument %s\n", argv[i]);
+      return 1;
+    }
+  }
+
+  char line[128];
+  archive::QueryStats stats;
+  const uint64_t count = reader.query(q, [&](const trace::Record& rec) {
+      format_record(line, sizeof(line), rec, start_ns);
+      puts(line);
+    }, &stats);
+
+  if(count == ~uint64_t(0)) {
+    printf("Corrupt block\n");
+    return 1;
+  }
+
+  fprintf(stderr, "%llu frames, %llu of %llu blocks decoded\n", (unsigned long long)count,
+          (unsigned long long)stats.blocks_decoded, (unsigned long long)reader.num_blocks());
+  return 0;
+}
+
+static int run_info(const char* path)
+{
+  archive::ArchiveReader reader;
+  if(!reader.open(path)) {
+    printf("Could not open %s\n", path);
+    return 1;
+  }
+
+  printf("Frames:        %llu\n", (unsigned long long)reader.num_frames());
+  printf("Blocks:        %llu of up to %u frames\n", (unsigned long long)reader.num_blocks(),
+         reader.header().block_frames);
+  printf("Size:          %zu bytes (%.1f bytes per frame)\n", reader.size(),
+         reader.num_frames() > 0 ? double(reader.size()) / reader.num_frames() : 0.0);
+
+  if(reader.num_blocks() > 0) {
+    const uint64_t start_ns = reader.header().start_time_ns;
+    printf("Time:          %.6f to %.6f s\n",
+           1e-9 * double(int64_t(reader.block(0).min_time_ns - start_ns)),
+           1e-9 * double(int64_t(reader.block(reader.num_blocks() - 1).max_time_ns - start_ns)));
+  }
+
+  return 0;
+}
+
+int main(int argc, char** argv)
+{
+  const char* mode = argc > 1 ? argv[1] : "check";
+
+  if(strcmp(mode, "check") == 0) {
+    return run_check();
+  } else if(strcmp(mode, "bench") == 0) {
+    run_bench(argc > 2 ? strtoull(argv[2], nullptr, 0) : 5000000);
+    return 0;
+  } else if(strcmp(mode, "convert") == 0 && argc > 3) {
+    return run_convert(argv[2], argv[3], argc > 4 ? strtoul(argv[4], nullptr, 0) :
+                                                    archive::BLOCK_FRAMES_DEFAULT);
+  } else if(strcmp(mode, "query") == 0 && argc > 2) {
+    return run_query(argv[2], argc - 3, argv + 3);
+  } else if(strcmp(mode, "info") == 0 && argc > 2) {
+    return run_info(argv[2]);
+  }
+
+  printf("Usage: %s check|bench [frames]|convert <trace> <archive> [block_frames]|"
+         "query <archive> [id=<hex>] [ext=<hex>] [from=<s>] [to=<s>] [controller=<n>]|"
+         "info <archive>\n", argv[0]);
+  return 1;
+}
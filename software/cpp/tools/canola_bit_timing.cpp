@@ -0,0 +1,252 @@
+/**
+ * @file   canola_bit_timing.cpp
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Bit timing solver for the BTL_* registers, see canola_bit_timing.hpp.
+ *
+ *         check:  Checks that the constexpr solver gives the same result as
+ *                 at run time, that it finds the best legal setting for
+ *                 some bit rates and bus lengths with the 50 and 100 MHz
+ *                 clocks (and none where the registers can not do it), and
+ *                 that frames get through with the settings in the
+ *                 cycle-level BTL model (canola_btl.hpp).
+ *         solve <clock_hz> <bit_rate> [length_m=0] [delay_ns=0] [sample_point=0.875]:
+ *                 Prints every legal setting, best first.
+ *         header [clock_hz] [bit_rate] [length_m] [delay_ns] [sample_point]:
+ *                 Prints canola_bit_timing.h for the C firmware (defaults
+ *                 to BIT_TIMING_DEFAULT).
+ *
+ *         Build: g++ -std=c++14 -O2 -march=native -pthread -I.. canola_bit_timing.cpp -o canola_bit_timing
+ */
+
+#include "canola_bit_timing.hpp"
+#include "canola_btl.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace canola;
+
+static unsigned int g_errors = 0;
+
+static void check(bool ok, const char* what, uint64_t index)
+{
+  if(!ok) {
+    if(g_errors < 10)
+      printf("%s (%llu)\n", what, (unsigned long long)index);
+    g_errors++;
+  }
+}
+
+struct Problem {
+  double clock_freq = CLOCK_FREQ_DEFAULT;
+  double bit_rate = BIT_RATE_DEFAULT;
+  double bus_length = BUS_LENGTH_DEFAULT;
+  double transceiver_delay = TRANSCEIVER_DELAY_DEFAULT;
+  double sample_point_target = SAMPLE_POINT_TARGET_DEFAULT;
+};
+
+// Every legal setting for a problem, best first
+static std::vector<BitTiming> candidates(const Problem& p)
+{
+  const double prop_delay = propagation_delay(p.clock_freq, p.bus_length, p.transceiver_delay);
+  std::vector<BitTiming> timings;
+
+  for(uint32_t scale = 0; scale < (1u << TIME_QUANTA_SCALE_WIDTH); scale++)
+    for(unsigned int prop = 1; prop <= BTL_SEGMENT_WIDTH; prop++)
+      for(unsigned int ps1 = 1; ps1 <= BTL_SEGMENT_WIDTH; ps1++)
+        for(unsigned int ps2 = 1; ps2 <= BTL_SEGMENT_WIDTH; ps2++)
+          for(unsigned int sjw = 1; sjw <= BTL_SYNC_JUMP_WIDTH_MAX; sjw++) {
+            const BitTiming t = make_bit_timing(p.clock_freq, p.bit_rate, prop_delay, scale, prop,
+                                                ps1, ps2, sjw);
+            if(t.valid)
+              timings.push_back(t);
+          }
+
+  std::stable_sort(timings.begin(), timings.end(), [&](const BitTiming& a, const BitTiming& b) {
+    return better_bit_timing(a, b, p.sample_point_target);
+  });
+  return timings;
+}
+
+static bool same_timing(const BitTiming& a, const BitTiming& b)
+{
+  return a.valid == b.valid && a.time_quanta_clock_scale == b.time_quanta_clock_scale &&
+         a.prop_seg == b.prop_seg && a.phase_seg1 == b.phase_seg1 &&
+         a.phase_seg2 == b.phase_seg2 && a.sync_jump_width == b.sync_jump_width;
+}
+
+// Solved at build time, must match what the solver gives at run time
+constexpr BitTiming TIMING_500K_20M = solve_bit_timing(100e6, 500e3, 20.0, 150e-9);
+constexpr BitTiming TIMING_125K_50MHZ = solve_bit_timing(50e6, 125e3, 100.0, 150e-9);
+
+static_assert(TIMING_500K_20M.valid, "No bit timing for 500 kbit on 20 m");
+static_assert(TIMING_125K_50MHZ.valid, "No bit timing for 125 kbit with 50 MHz");
+
+static int run_check()
+{
+  volatile double clock_freq = 100e6;
+  check(same_timing(TIMING_500K_20M, solve_bit_timing(clock_freq, 500e3, 20.0, 150e-9)),
+        "constexpr solver", 0);
+  check(same_timing(TIMING_125K_50MHZ, solve_bit_timing(clock_freq / 2, 125e3, 100.0, 150e-9)),
+        "constexpr solver", 1);
+  check(same_timing(BIT_TIMING_DEFAULT,
+                    solve_bit_timing(clock_freq, BIT_RATE_DEFAULT, BUS_LENGTH_DEFAULT,
+                                     TRANSCEIVER_DELAY_DEFAULT)),
+        "constexpr solver", 2);
+
+  // Bit rates and bus lengths the solver should handle, and some it can not:
+  // too slow for TIME_QUANTA_CLOCK_SCALE, or a propagation delay that does
+  // not fit in PROP_SEG
+  struct Case {
+    double clock_freq;
+    double bit_rate;
+    double bus_length;
+    bool valid;
+    bool exact;
+  };
+  const Case cases[] = {
+    {100e6, 1e6,   1.0,   true,  true},
+    {100e6, 500e3, 20.0,  true,  true},
+    {100e6, 250e3, 40.0,  true,  false},
+    {100e6, 125e3, 1.0,   false, false},
+    {100e6, 1e6,   20.0,  false, false},
+    {50e6,  1e6,   1.0,   false, false},
+    {50e6,  500e3, 20.0,  true,  true},
+    {50e6,  250e3, 40.0,  true,  true},
+    {50e6,  125e3, 100.0, true,  false}
+  };
+
+  for(unsigned int i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    const Case& c = cases[i];
+    Problem p;
+    p.clock_freq = c.clock_freq;
+    p.bit_rate = c.bit_rate;
+    p.bus_length = c.bus_length;
+    const BitTiming t = solve_bit_timing(p.clock_freq, p.bit_rate, p.bus_length,
+                                         p.transceiver_delay, p.sample_point_target);
+
+    printf("%3.0f MHz %5.0f kbit %5.1f m: ", c.clock_freq / 1e6, c.bit_rate / 1e3, c.bus_length);
+    check(t.valid == c.valid, "Solution", i);
+    if(!t.valid) {
+      printf("no solution\n");
+      continue;
+    }
+
+    // The best of all legal settings, with a SJW that is as large as the
+    // phase segments allow
+    const std::vector<BitTiming> all = candidates(p);
+    check(!all.empty() && !better_bit_timing(all.front(), t, p.sample_point_target),
+          "Not the best solution", i);
+    check(!c.exact || t.bit_rate_error < 1e-9, "Bit rate error", i);
+    check(t.prop_seg_margin >= 0.0, "PROP_SEG margin", i);
+    check(t.phase_seg2 >= BTL_PHASE_SEG2_MIN, "PHASE_SEG2", i);
+    check(t.sync_jump_width == std::min(std::min(t.phase_seg1, t.phase_seg2),
+                                        BTL_SYNC_JUMP_WIDTH_MAX),
+          "SJW", i);
+
+    // Frames get through in the BTL model, on the bus the timing was solved for
+    btl::StudyConfig config;
+    config.timing = btl::Timing::from_bit_timing(t);
+    config.clock_freq = c.clock_freq;
+    config.bus_length = c.bus_length;
+    config.tx_delay = config.rx_delay = p.transceiver_delay / 2;
+    config.runs = 4;
+    config.frames = 20;
+
+    const btl::StudyResult result = btl::run_study(config);
+    check(result.failed_runs == 0 && result.total.frames_sent > 0, "BTL model", i);
+
+    printf("scale %2u, prop %u, ps1 %u, ps2 %u, sjw %u, sample point %.1f%%, "
+           "error %.2f%%, %u/%u runs failed\n",
+           t.time_quanta_clock_scale, t.prop_seg, t.phase_seg1, t.phase_seg2,
+           t.sync_jump_width, 100.0 * t.sample_point, 100.0 * t.bit_rate_error,
+           result.failed_runs, result.runs);
+  }
+
+  printf("%s (%u errors)\n", g_errors == 0 ? "OK" : "FAILED", g_errors);
+  return g_errors == 0 ? 0 : 1;
+}
+
+static void run_solve(const Problem& p)
+{
+  printf("%.0f Hz clock, %.0f bit/s, %.1f m, propagation delay %.1f ns\n", p.clock_freq,
+         p.bit_rate, p.bus_length,
+         1e9 * propagation_delay(p.clock_freq, p.bus_length, p.transceiver_delay));
+  printf("%5s %4s %4s %4s %4s %12s %9s %8s %8s %10s\n", "Scale", "Prop", "PS1", "PS2", "SJW",
+         "Bit rate", "Error", "Sample", "Tol ppm", "Margin ns");
+
+  for(const BitTiming& t : candidates(p))
+    printf("%5u %4u %4u %4u %4u %12.0f %8.3f%% %7.1f%% %8.0f %10.1f\n", t.time_quanta_clock_scale,
+           t.prop_seg, t.phase_seg1, t.phase_seg2, t.sync_jump_width, t.bit_rate,
+           100.0 * t.bit_rate_error, 100.0 * t.sample_point, 1e6 * t.clock_tolerance,
+           1e9 * t.prop_seg_margin);
+}
+
+static int run_header(const Problem& p)
+{
+  const BitTiming t = solve_bit_timing(p.clock_freq, p.bit_rate, p.bus_length,
+                                       p.transceiver_delay, p.sample_point_target);
+  if(!t.valid) {
+    fprintf(stderr, "No bit timing for %.0f bit/s with a %.0f Hz clock on %.1f m\n", p.bit_rate,
+            p.clock_freq, p.bus_length);
+    return 1;
+  }
+
+  printf("#ifndef CANOLA_BIT_TIMING_H\n");
+  printf("#define CANOLA_BIT_TIMING_H\n\n");
+  printf("/* Generated by canola_bit_timing header, do not edit */\n");
+  printf("/* %.0f Hz clock, %.0f bit/s, %.1f m, %.0f ns transceiver loop delay */\n",
+         p.clock_freq, p.bit_rate, p.bus_length, 1e9 * p.transceiver_delay);
+  printf("/* Sample point %.1f%%, oscillator tolerance %.0f ppm, PROP_SEG margin %.1f ns */\n\n",
+         100.0 * t.sample_point, 1e6 * t.clock_tolerance, 1e9 * t.prop_seg_margin);
+  printf("#define CANOLA_TIME_QUANTA_CLOCK_SCALE %u\n", t.time_quanta_clock_scale);
+  printf("#define CANOLA_BTL_PROP_SEG 0x%x\n", btl_segment(t.prop_seg));
+  printf("#define CANOLA_BTL_PHASE_SEG1 0x%x\n", btl_segment(t.phase_seg1));
+  printf("#define CANOLA_BTL_PHASE_SEG2 0x%x\n", btl_segment(t.phase_seg2));
+  printf("#define CANOLA_BTL_SYNC_JUMP_WIDTH %u\n\n", t.sync_jump_width);
+  printf("#endif\n");
+  return 0;
+}
+
+static Problem parse_problem(int argc, char** argv)
+{
+  Problem p;
+  if(argc > 2)
+    p.clock_freq = strtod(argv[2], nullptr);
+  if(argc > 3)
+    p.bit_rate = strtod(argv[3], nullptr);
+  // The defaults are for the short bus on the ZYBO board, a given clock and
+  // bit rate are for any bus
+  if(argc > 2) {
+    p.bus_length = 0.0;
+    p.transceiver_delay = 0.0;
+  }
+  if(argc > 4)
+    p.bus_length = strtod(argv[4], nullptr);
+  if(argc > 5)
+    p.transceiver_delay = 1e-9 * strtod(argv[5], nullptr);
+  if(argc > 6)
+    p.sample_point_target = strtod(argv[6], nullptr);
+  return p;
+}
+
+int main(int argc, char** argv)
+{
+  const char* mode = argc > 1 ? argv[1] : "check";
+
+  if(strcmp(mode, "check") == 0) {
+    return run_check();
+  } else if(strcmp(mode, "solve") == 0 && argc > 3) {
+    run_solve(parse_problem(argc, argv));
+    return 0;
+  } else if(strcmp(mode, "header") == 0) {
+    return run_header(parse_problem(argc, argv));
+  }
+
+  printf("Usage: %s check|solve|header [clock_hz] [bit_rate] [length_m] [delay_ns] [sample_point]\n",
+         argv[0]);
+  return 1;
+}
@@ -0,0 +1,249 @@
+/**
+ * @file   canola_btl_study.cpp
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Monte Carlo bit-timing studies with the cycle-level BTL model in
+ *         canola_btl.hpp.
+ *
+ *         check:  Checks the bit period and the hard synchronization of Btl
+ *                 for a few settings, and that frames get through on an
+ *                 ideal bus and with clock errors within the tolerance of
+ *                 the setting, but not with clock errors far outside it.
+ *         study [runs=64] [frames=100] [length_m=10] [ppm=100] [threads=0]:
+ *                 Runs the settings canola_init() uses (BIT_TIMING_DEFAULT)
+ *                 at 1 Mbit.
+ *         sweep [runs=16] [frames=50] [ppm=100] [threads=0]:
+ *                 Runs every setting of the segments that gives 1 Mbit with
+ *                 the 100 MHz clock, on 1, 10, 20 and 40 m of cable.
+ *
+ *         Build: g++ -std=c++14 -O2 -march=native -pthread -I.. canola_btl_study.cpp -o canola_btl_study
+ */
+
+#include "canola_btl.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace canola;
+
+static unsigned int g_errors = 0;
+
+static void check(bool ok, const char* what, uint64_t index)
+{
+  if(!ok) {
+    if(g_errors < 10)
+      printf("%s (%llu)\n", what, (unsigned long long)index);
+    g_errors++;
+  }
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// From the falling edge on CAN_RX to the restart of the time quanta generator,
+// plus the registered sample point and Rx bit
+static const unsigned int HARD_SYNC_LATENCY = 6;
+
+// Clock cycles from a falling edge on an idle bus to the first Rx sample point
+static unsigned int hard_sync_clocks(const btl::Timing& timing, unsigned int idle_clocks)
+{
+  btl::Btl btl(timing);
+  for(unsigned int i = 0; i < idle_clocks; i++)
+    btl.clock(true, true, false, false, false);
+
+  // Sample points that were on their way at the edge belong to the idle bus
+  for(unsigned int i = 1; i < 1000; i++) {
+    btl.clock(false, true, false, false, false);
+    if(btl.rx_bit_valid() && i > HARD_SYNC_LATENCY)
+      return i;
+  }
+  return 0;
+}
+
+static void check_btl()
+{
+  const btl::Timing timings[] = {
+    btl::Timing(),
+    btl::Timing::from_quanta(19, 1, 2, 1, 1),
+    btl::Timing::from_quanta(0, 4, 4, 4, 4),
+    btl::Timing::from_quanta(31, 2, 1, 3, 2)
+  };
+
+  unsigned int short_sync_segs = 0;
+  for(unsigned int t = 0; t < sizeof(timings) / sizeof(timings[0]); t++) {
+    const btl::Timing& timing = timings[t];
+
+    // Sample points on a recessive bus
+    btl::Btl btl(timing);
+    std::vector<unsigned int> samples;
+    for(unsigned int i = 0; i < 50 * timing.clocks_per_bit(); i++) {
+      btl.clock(true, true, false, false, false);
+      if(btl.rx_bit_valid())
+        samples.push_back(i);
+    }
+    for(unsigned int i = 2; i < samples.size(); i++)
+      check(samples[i] - samples[i-1] == timing.clocks_per_bit(), "Bit period", t);
+
+    // The first sample point after a hard sync is HARD_SYNC_LATENCY clock
+    // cycles after the end of PHASE_SEG1. RTL: SYNC_SEG is one time quantum
+    // short when a time quanta pulse was on its way at the restart.
+    const unsigned int tq = timing.time_quanta_clock_scale + 1;
+    const unsigned int sample_point =
+      tq * (1 + btl::Timing::quanta(timing.prop_seg) + btl::Timing::quanta(timing.phase_seg1));
+
+    for(unsigned int idle = 1000; idle < 1000 + tq; idle++) {
+      const unsigned int clocks = hard_sync_clocks(timing, idle);
+      if(clocks == sample_point + HARD_SYNC_LATENCY - tq)
+        short_sync_segs++;
+      else
+        check(clocks == sample_point + HARD_SYNC_LATENCY, "Hard sync latency", t);
+    }
+  }
+
+  printf("Btl: %u errors (%u hard syncs with a short SYNC_SEG)\n", g_errors, short_sync_segs);
+}
+
+static btl::StudyResult check_study(btl::StudyConfig config, const char* what, bool expect_ok)
+{
+  const btl::StudyResult result = btl::run_study(config);
+  printf("%s: %u/%u runs failed, %llu frames sent\n", what, result.failed_runs, result.runs,
+         (unsigned long long)result.total.frames_sent);
+
+  if(expect_ok)
+    check(result.failed_runs == 0 && result.total.frames_sent > 0, what, result.first_failed_run);
+  else
+    check(result.failed_runs > 0, what, 0);
+  return result;
+}
+
+static int run_check()
+{
+  check_btl();
+
+  btl::StudyConfig config;
+  config.runs = 8;
+  config.frames = 30;
+
+  btl::StudyConfig ideal = config;
+  ideal.bus_length = 0.0;
+  ideal.clock_tolerance_ppm = 0.0;
+  ideal.tx_delay = ideal.rx_delay = ideal.jitter = 0.0;
+  check_study(ideal, "Ideal bus", true);
+
+  const double tolerance_ppm = 1e6 * config.timing.clock_tolerance();
+
+  btl::StudyConfig drift = config;
+  drift.bus_length = 1.0;
+  drift.clock_tolerance_ppm = 0.5 * tolerance_ppm;
+  check_study(drift, "Half the clock tolerance", true);
+
+  drift.clock_tolerance_ppm = 5.0 * tolerance_ppm;
+  check_study(drift, "5 times the clock tolerance", false);
+
+  printf("%s (%u errors)\n", g_errors == 0 ? "OK" : "FAILED", g_errors);
+  return g_errors == 0 ? 0 : 1;
+}
+
+static void print_header()
+{
+  printf("%5s %4s %4s %4s %4s %8s %7s %8s %6s %10s %10s %8s %8s %8s %9s %9s\n", "Scale", "Prop",
+         "PS1", "PS2", "SJW", "Sample", "Tol ppm", "Length", "Runs", "Failed", "Frames",
+         "Corrupt", "Missing", "Errors", "Setup ns", "Hold ns");
+}
+
+static void print_result(const btl::StudyConfig& config, const btl::StudyResult& result)
+{
+  const btl::Timing& t = config.timing;
+  printf("%5u %4u %4u %4u %4u %7.1f%% %7.0f %7.1fm %6u %10u %10llu %8llu %8llu %8llu %9.1f %9.1f\n",
+         t.time_quanta_clock_scale, btl::Timing::quanta(t.prop_seg),
+         btl::Timing::quanta(t.phase_seg1), btl::Timing::quanta(t.phase_seg2),
+         t.effective_sjw(), 100.0 * t.sample_point(), 1e6 * t.clock_tolerance(),
+         config.bus_length, result.runs, result.failed_runs,
+         (unsigned long long)result.total.frames_sent,
+         (unsigned long long)result.total.frames_corrupt,
+         (unsigned long long)result.total.frames_missing,
+         (unsigned long long)result.total.errors, 1e9 * result.total.min_setup,
+         1e9 * result.total.min_hold);
+}
+
+static void run_default(const btl::StudyConfig& config)
+{
+  auto start = std::chrono::steady_clock::now();
+  const btl::StudyResult result = btl::run_study(config);
+  const double seconds = seconds_since(start);
+
+  print_header();
+  print_result(config, result);
+  printf("%llu bits in %.1f s, %.0f node bits/s\n", (unsigned long long)result.total.bits,
+         seconds, result.total.bits * config.nodes / seconds);
+  if(result.failed_runs > 0)
+    printf("First failed run: %d\n", result.first_failed_run);
+}
+
+static void run_sweep(btl::StudyConfig config)
+{
+  auto start = std::chrono::steady_clock::now();
+  const unsigned int clocks_per_bit = unsigned(config.clock_freq / BIT_RATE_DEFAULT + 0.5);
+  const double lengths[] = {1.0, 10.0, 20.0, 40.0};
+
+  print_header();
+  for(unsigned int prop = 1; prop <= BTL_SEGMENT_WIDTH; prop++) {
+    for(unsigned int ps1 = 1; ps1 <= BTL_SEGMENT_WIDTH; ps1++) {
+      for(unsigned int ps2 = 1; ps2 <= BTL_SEGMENT_WIDTH; ps2++) {
+        const unsigned int quanta = 1 + prop + ps1 + ps2;
+        const unsigned int scale = clocks_per_bit / quanta - 1;
+        if(clocks_per_bit % quanta != 0 || scale >= (1u << TIME_QUANTA_SCALE_WIDTH))
+          continue;
+
+        const unsigned int sjw = std::min(BTL_SYNC_JUMP_WIDTH_MAX, std::min(ps1, ps2));
+        config.timing = btl::Timing::from_quanta(scale, prop, ps1, ps2, sjw);
+
+        for(double length : lengths) {
+          config.bus_length = length;
+          print_result(config, btl::run_study(config));
+        }
+      }
+    }
+  }
+  printf("Sweep in %.1f s\n", seconds_since(start));
+}
+
+int main(int argc, char** argv)
+{
+  const char* mode = argc > 1 ? argv[1] : "check";
+
+  btl::StudyConfig config;
+
+  if(strcmp(mode, "check") == 0) {
+    return run_check();
+  } else if(strcmp(mode, "study") == 0) {
+    if(argc > 2)
+      config.runs = strtoul(argv[2], nullptr, 0);
+    if(argc > 3)
+      config.frames = strtoul(argv[3], nullptr, 0);
+    if(argc > 4)
+      config.bus_length = strtod(argv[4], nullptr);
+    if(argc > 5)
+      config.clock_tolerance_ppm = strtod(argv[5], nullptr);
+    if(argc > 6)
+      config.threads = strtoul(argv[6], nullptr, 0);
+    run_default(config);
+    return 0;
+  } else if(strcmp(mode, "sweep") == 0) {
+    config.runs = argc > 2 ? strtoul(argv[2], nullptr, 0) : 16;
+    config.frames = argc > 3 ? strtoul(argv[3], nullptr, 0) : 50;
+    if(argc > 4)
+      config.clock_tolerance_ppm = strtod(argv[4], nullptr);
+    if(argc > 5)
+      config.threads = strtoul(argv[5], nullptr, 0);
+    run_sweep(config);
+    return 0;
+  }
+
+  printf("Usage: %s check|study|sweep [runs] [frames] [length_m] [ppm] [threads]\n", argv[0]);
+  return 1;
+}
@@ -0,0 +1,449 @@
+/**
+ * @file   canola_bus_sim.cpp
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Tests with several simulated Canola controllers on one bus
+ *         (canola_sim.hpp), driven by the C++ driver in canola.hpp. Each
+ *         test runs on many independent buses with different seeds, spread
+ *         over all cores.
+ *
+ *         sequence:    Same as canola_sequence_send_test in the ZYBO test
+ *                      firmware. Four controllers take turns sending a
+ *                      random message, and the test checks after 2 ms that
+ *                      the sender got the Tx done interrupt and the others
+ *                      received the message, with Rx timestamps at the end
+ *                      of the frame, close to the Tx timestamp.
+ *         arbitration: Four controllers fill all their Tx mailboxes at the
+ *                      same time. A fifth controller checks that the
+ *                      messages are received in priority order, through
+ *                      its Rx FIFO.
+ *         errors:      Three controllers send messages with retransmission
+ *                      enabled while random dominant bits are forced on the
+ *                      bus. Checks that every message that was reported
+ *                      done was received by the others, and that no
+ *                      corrupted message was received.
+ *
+ *         Build: g++ -std=c++14 -O2 -march=native -pthread -I.. canola_bus_sim.cpp -o canola_bus_sim
+ */
+
+#include "canola.hpp"
+#include "canola_sim.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace canola;
+
+using Driver = Canola<sim::SimIO>;
+
+struct BusResult {
+  uint64_t messages = 0;
+  uint64_t bits = 0;
+  uint64_t errors = 0;
+  uint64_t counters[10] = {};
+  double sim_seconds = 0;
+};
+
+static const Counter COUNTERS[10] = {
+  Counter::TX_MSG_SENT, Counter::TX_FAILED, Counter::TX_ACK_ERROR, Counter::TX_ARB_LOST,
+  Counter::TX_BIT_ERROR, Counter::TX_RETRANSMIT, Counter::RX_MSG_RECV, Counter::RX_CRC_ERROR,
+  Counter::RX_FORM_ERROR, Counter::RX_STUFF_ERROR
+};
+
+static const char* const COUNTER_NAMES[10] = {
+  "TX_MSG_SENT", "TX_FAILED", "TX_ACK_ERROR", "TX_ARB_LOST", "TX_BIT_ERROR",
+  "TX_RETRANSMIT", "RX_MSG_RECV", "RX_CRC_ERROR", "RX_FORM_ERROR", "RX_STUFF_ERROR"
+};
+
+static void error(BusResult& result, unsigned int bus_index, const char* what)
+{
+  // Only print errors for the first few buses
+  if(bus_index < 4 && result.errors < 5)
+    printf("Bus %u: %s\n", bus_index, what);
+  result.errors++;
+}
+
+static void add_counters(BusResult& result, std::vector<Driver>& drivers, sim::Bus& bus)
+{
+  for(Driver& driver : drivers) {
+    for(unsigned int i = 0; i < 10; i++)
+      result.counters[i] += driver.counter(COUNTERS[i]);
+  }
+  result.bits = bus.bit_count();
+  result.sim_seconds = bus.time();
+}
+
+/**
+ * Same as canola_generate_rand_msg() in the test firmware
+ */
+static CanMsg random_msg(std::mt19937& rng)
+{
+  CanMsg msg = CanMsg{};
+
+  msg.arb_id_a = rng() % 2048;
+  msg.arb_id_b = rng() % 262144;
+  msg.ext_id = rng() % 2;
+  msg.remote_frame = rng() % 2;
+  msg.data_length = rng() % 9;
+
+  for(unsigned int i = 0; i < msg.data_length; i++)
+    msg.payload[i] = msg.remote_frame ? 0 : rng() % 256;
+
+  return msg;
+}
+
+// Lower value wins arbitration, the order of the bits on the bus
+static uint32_t msg_priority(const CanMsg& msg)
+{
+  if(msg.ext_id)
+    return (msg.arb_id_a << 21) | (3u << 19) | (msg.arb_id_b << 1) | msg.remote_frame;
+  else
+    return (msg.arb_id_a << 21) | (uint32_t(msg.remote_frame) << 20);
+}
+
+//-----------------------------------------------------------------------------
+// Sequence send test
+//-----------------------------------------------------------------------------
+static BusResult sequence_bus(unsigned int bus_index, unsigned int num_msgs)
+{
+  constexpr unsigned int NUM_CONTROLLERS = 4;
+
+  BusResult result;
+  std::mt19937 rng(bus_index + 1);
+  sim::Bus bus;
+  std::vector<Driver> drivers;
+  std::vector<std::vector<CanMsg>> rx_msgs(NUM_CONTROLLERS);
+  std::vector<bool> got_tx_done(NUM_CONTROLLERS);
+
+  for(unsigned int i = 0; i < NUM_CONTROLLERS; i++) {
+    drivers.emplace_back(bus.io(bus.add()));
+    drivers[i].init();
+    drivers[i].set_rx_timestamp_enable(true);
+
+    // Interrupt handlers of the test firmware
+    bus.set_irq_handler(i, [&, i](uint32_t irqs) {
+      if(irqs & sim::IRQ_RX_VALID)
+        rx_msgs[i].push_back(drivers[i].get_msg());
+      if(irqs & sim::IRQ_TX_DONE)
+        got_tx_done[i] = true;
+    });
+  }
+
+  bus.run(20);
+
+  for(unsigned int n = 0; n < num_msgs; n++) {
+    const unsigned int tx = n % NUM_CONTROLLERS;
+
+    bus.run_until([&]() { return !drivers[tx].is_busy(); });
+
+    const CanMsg msg = random_msg(rng);
+    const uint32_t start_timestamp = drivers[tx].timestamp();
+    got_tx_done[tx] = false;
+    drivers[tx].send_msg(msg);
+
+    // Sleep 2 ms
+    bus.run_for(2e-3);
+
+    if(!got_tx_done[tx])
+      error(result, bus_index, "Sender did not get Tx done");
+
+    // All controllers were started at the same time, so their timestamp
+    // counters are equal. The sender is done at the last bit of EOF, and
+    // the receivers accept the message at the next to last bit.
+    const uint32_t tx_timestamp = drivers[tx].tx_timestamp();
+    const uint32_t frame_time = tx_timestamp - start_timestamp;
+
+    if(frame_time == 0 || frame_time > 200 * BIT_TIMING_DEFAULT.clocks_per_bit())
+      error(result, bus_index, "Tx timestamp not within the frame");
+
+    for(unsigned int rx = 0; rx < NUM_CONTROLLERS; rx++) {
+      if(rx == tx)
+        continue;
+
+      if(rx_msgs[rx].size() != 1 || !compare_messages(rx_msgs[rx][0], msg))
+        error(result, bus_index, "Message not received, or received message did not match");
+      else if(tx_timestamp - rx_msgs[rx][0].timestamp > 2 * BIT_TIMING_DEFAULT.clocks_per_bit())
+        error(result, bus_index, "Rx timestamp not at the end of the frame");
+
+      rx_msgs[rx].clear();
+    }
+
+    result.messages++;
+  }
+
+  add_counters(result, drivers, bus);
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+// Arbitration between Tx mailboxes
+//-----------------------------------------------------------------------------
+static BusResult arbitration_bus(unsigned int bus_index, unsigned int num_rounds)
+{
+  constexpr unsigned int NUM_SENDERS = 4;
+
+  BusResult result;
+  std::mt19937 rng(bus_index + 1);
+  sim::Bus bus;
+  std::vector<Driver> drivers;
+  std::vector<CanMsg> received;
+
+  // A message in a low priority mailbox loses arbitration many times, and
+  // would fail after the default G_RETRANSMIT_COUNT_MAX of 4 retransmits
+  sim::Config config;
+  config.retransmit_count_max = model::RETRANSMIT_COUNT_FOREVER;
+
+  for(unsigned int i = 0; i <= NUM_SENDERS; i++) {
+    drivers.emplace_back(bus.io(bus.add(config)));
+    drivers[i].init();
+    drivers[i].set_retransmit_enable(true);
+  }
+
+  for(unsigned int i = 0; i < NUM_SENDERS; i++)
+    drivers[i].set_tx_mailbox_enable(true);
+
+  Driver& listener = drivers[NUM_SENDERS];
+  listener.set_rx_fifo_enable(true);
+  bus.set_irq_handler(NUM_SENDERS, [&](uint32_t irqs) {
+    if(irqs & sim::IRQ_RX_VALID)
+      listener.drain([&](const CanMsg& msg) { received.push_back(msg); });
+  });
+
+  bus.run(20);
+
+  for(unsigned int round = 0; round < num_rounds; round++) {
+    std::vector<CanMsg> sent;
+    received.clear();
+
+    // The ID A of a message identifies the sender, so that no two senders
+    // send the same ID, which is not allowed on a CAN bus
+    for(unsigned int tx = 0; tx < NUM_SENDERS; tx++) {
+      const unsigned int count = drivers[tx].tx_mailbox_count();
+
+      for(unsigned int mailbox = 0; mailbox < count; mailbox++) {
+        CanMsg msg = random_msg(rng);
+        msg.arb_id_a = (msg.arb_id_a & ~3u) | tx;
+
+        if(!drivers[tx].send_msg_mailbox(mailbox, msg))
+          error(result, bus_index, "Mailbox busy");
+        sent.push_back(msg);
+      }
+    }
+
+    const bool done = bus.run_until([&]() {
+      for(unsigned int tx = 0; tx < NUM_SENDERS; tx++) {
+        if(drivers[tx].tx_mailbox_status().pending != 0)
+          return false;
+      }
+      return true;
+    }, 200 * sent.size());
+
+    // Let the listener receive the last message
+    bus.run(10);
+
+    if(!done)
+      error(result, bus_index, "Mailboxes still pending");
+    if(received.size() != sent.size())
+      error(result, bus_index, "Wrong number of messages received");
+
+    // Each controller starts sending as soon as its first mailbox is loaded,
+    // before the others are, so the first message can be out of order
+    for(size_t i = 2; i < received.size(); i++) {
+      if(msg_priority(received[i]) < msg_priority(received[i-1]))
+        error(result, bus_index, "Messages not received in priority order");
+    }
+
+    for(const CanMsg& msg : received) {
+      bool found = false;
+      for(const CanMsg& sent_msg : sent)
+        found = found || compare_messages(msg, sent_msg);
+      if(!found)
+        error(result, bus_index, "Received message that was not sent");
+    }
+
+    for(unsigned int tx = 0; tx < NUM_SENDERS; tx++) {
+      const Driver::TxMailboxStatus status = drivers[tx].tx_mailbox_status();
+      const uint32_t all = (uint64_t(1) << drivers[tx].tx_mailbox_count()) - 1;
+
+      if(status.done != all || status.failed != 0)
+        error(result, bus_index, "Mailbox not done, or failed");
+    }
+
+    result.messages += sent.size();
+  }
+
+  add_counters(result, drivers, bus);
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+// Random errors on the bus
+//-----------------------------------------------------------------------------
+static BusResult errors_bus(unsigned int bus_index, unsigned int num_msgs, double error_rate)
+{
+  constexpr unsigned int NUM_CONTROLLERS = 3;
+
+  BusResult result;
+  std::mt19937 rng(bus_index + 1);
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  sim::Bus bus;
+  std::vector<Driver> drivers;
+
+  // Messages to send from each controller, the sender and a sequence
+  // number are in the first three payload bytes
+  std::vector<std::vector<CanMsg>> tx_msgs(NUM_CONTROLLERS);
+  std::vector<unsigned int> tx_next(NUM_CONTROLLERS, 0);
+  std::vector<std::vector<uint8_t>> tx_result(NUM_CONTROLLERS);  // 0 pending, 1 done, 2 failed
+
+  // Number of times message (tx, seq) was received by each controller
+  std::vector<std::vector<std::vector<unsigned int>>> rx_count(NUM_CONTROLLERS);
+
+  for(unsigned int i = 0; i < NUM_CONTROLLERS; i++) {
+    for(unsigned int seq = 0; seq < num_msgs; seq++) {
+      CanMsg msg = random_msg(rng);
+      msg.arb_id_a = (msg.arb_id_a & ~3u) | i;
+      msg.remote_frame = false;
+      msg.data_length = 3 + rng() % 6;
+      msg.payload[0] = i;
+      msg.payload[1] = seq >> 8;
+      msg.payload[2] = seq;
+      tx_msgs[i].push_back(msg);
+    }
+    tx_result[i].resize(num_msgs, 0);
+    rx_count[i].assign(NUM_CONTROLLERS, std::vector<unsigned int>(num_msgs, 0));
+  }
+
+  for(unsigned int i = 0; i < NUM_CONTROLLERS; i++) {
+    drivers.emplace_back(bus.io(bus.add()));
+    drivers[i].init();
+    drivers[i].set_retransmit_enable(true);
+
+    bus.set_irq_handler(i, [&, i](uint32_t irqs) {
+      if(irqs & (sim::IRQ_TX_DONE | sim::IRQ_TX_FAILED))
+        tx_result[i][tx_next[i] - 1] = (irqs & sim::IRQ_TX_DONE) ? 1 : 2;
+
+      if(irqs & sim::IRQ_RX_VALID) {
+        const CanMsg msg = drivers[i].get_msg();
+        const unsigned int tx = msg.payload[0];
+        const unsigned int seq = (msg.payload[1] << 8) | msg.payload[2];
+
+        if(tx >= NUM_CONTROLLERS || tx == i || seq >= num_msgs ||
+           !compare_messages(msg, tx_msgs[tx][seq]))
+          error(result, bus_index, "Received corrupted message");
+        else
+          rx_count[i][tx][seq]++;
+      }
+    });
+  }
+
+  bus.run(20);
+
+  // Start the next message on the idle controllers, returns true when all
+  // messages have been sent
+  auto send_next = [&]() {
+    bool finished = true;
+
+    for(unsigned int i = 0; i < NUM_CONTROLLERS; i++) {
+      if(drivers[i].is_busy()) {
+        finished = false;
+      } else if(tx_next[i] < num_msgs) {
+        finished = false;
+
+        // The driver cannot start a message while bus off
+        if(drivers[i].error_state() != ErrorState::BUS_OFF)
+          drivers[i].send_msg(tx_msgs[i][tx_next[i]++]);
+      }
+    }
+
+    return finished;
+  };
+
+  const uint64_t max_bits = uint64_t(num_msgs) * NUM_CONTROLLERS * 2000;
+  for(uint64_t n = 0; n < max_bits && !send_next(); n++)
+    bus.step(uniform(rng) >= error_rate);
+
+  // Let the last message be received, without errors
+  bus.run(20);
+
+  for(unsigned int tx = 0; tx < NUM_CONTROLLERS; tx++) {
+    for(unsigned int seq = 0; seq < num_msgs; seq++) {
+      if(tx_result[tx][seq] == 0) {
+        error(result, bus_index, "Message not sent");
+        continue;
+      }
+
+      for(unsigned int rx = 0; rx < NUM_CONTROLLERS; rx++) {
+        if(rx != tx && tx_result[tx][seq] == 1 && rx_count[rx][tx][seq] == 0)
+          error(result, bus_index, "Message reported done was not received");
+      }
+    }
+    result.messages += num_msgs;
+  }
+
+  add_counters(result, drivers, bus);
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+
+template <typename BusFunction>
+static int run_buses(const char* name, unsigned int num_buses, unsigned int num_threads,
+                     BusFunction&& bus_function)
+{
+  std::vector<BusResult> results(num_buses);
+
+  auto start = std::chrono::steady_clock::now();
+  sim::run_sharded(num_buses, [&](unsigned int i) { results[i] = bus_function(i); }, num_threads);
+  const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  BusResult total;
+  for(const BusResult& result : results) {
+    total.messages += result.messages;
+    total.bits += result.bits;
+    total.errors += result.errors;
+    total.sim_seconds += result.sim_seconds;
+    for(unsigned int i = 0; i < 10; i++)
+      total.counters[i] += result.counters[i];
+  }
+
+  printf("%s: %u buses, %llu messages, %.2f s of bus time in %.2f s (%.1fx real time), "
+         "%.1f Mbit/s\n", name, num_buses, (unsigned long long)total.messages,
+         total.sim_seconds, seconds, total.sim_seconds / seconds, total.bits / seconds / 1e6);
+
+  for(unsigned int i = 0; i < 10; i++)
+    printf("  %-16s %llu\n", COUNTER_NAMES[i], (unsigned long long)total.counters[i]);
+
+  printf("%s (%llu errors)\n", total.errors == 0 ? "OK" : "FAILED", (unsigned long long)total.errors);
+  return total.errors == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[])
+{
+  const char* mode = argc > 1 ? argv[1] : "sequence";
+  const unsigned int num_msgs = argc > 2 ? atoi(argv[2]) : 10000;
+  const unsigned int num_buses = argc > 3 ? atoi(argv[3]) : 16;
+  const unsigned int num_threads = argc > 4 ? atoi(argv[4]) : 0;
+
+  if(strcmp(mode, "sequence") == 0) {
+    return run_buses(mode, num_buses, num_threads, [&](unsigned int i) {
+      return sequence_bus(i, num_msgs);
+    });
+  } else if(strcmp(mode, "arbitration") == 0) {
+    return run_buses(mode, num_buses, num_threads, [&](unsigned int i) {
+      return arbitration_bus(i, num_msgs);
+    });
+  } else if(strcmp(mode, "errors") == 0) {
+    const double error_rate = argc > 5 ? atof(argv[5]) : 1e-4;
+    return run_buses(mode, num_buses, num_threads, [&](unsigned int i) {
+      return errors_bus(i, std::min(num_msgs, 65536u), error_rate);
+    });
+  }
+
+  printf("Usage: %s sequence|arbitration [messages/rounds] [buses] [threads]\n"
+         "       %s errors [messages] [buses] [threads] [error rate]\n"
+         "       threads = 0: one per core\n", argv[0], argv[0]);
+  return 1;
+}
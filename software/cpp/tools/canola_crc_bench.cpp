@@ -0,0 +1,333 @@
+/**
+ * @file   canola_crc_bench.cpp
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Checks the CRC-15 implementations in canola_crc.hpp against the
+ *         bit-serial port of canola_crc.vhd, and measures their throughput.
+ *
+ *         check: Exhaustive over all CRC register values for every byte and
+ *                every bit string up to 10 bits, then all bit lengths up to
+ *                4096 bits and random long buffers at all alignments.
+ *         bench: Throughput for buffers of different sizes, and for
+ *                computing the CRC of random CAN frames.
+ *
+ *         Build: g++ -std=c++14 -O2 -march=native -I.. canola_crc_bench.cpp -o canola_crc_bench
+ */
+
+#include "canola.hpp"
+#include "canola_crc.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace canola;
+
+struct Implementation {
+  const char* name;
+  Crc15Function function;
+};
+
+static std::vector<Implementation> implementations()
+{
+  std::vector<Implementation> impls = {
+    {"serial", crc15_serial},
+    {"table", crc15_table},
+    {"slice8", crc15_slice8}
+  };
+
+#if defined(CANOLA_CRC_HAVE_PCLMUL) || defined(CANOLA_CRC_HAVE_PMULL)
+  if(crc15_clmul_supported())
+    impls.push_back({"clmul", crc15_clmul});
+#endif
+
+  impls.push_back({"crc15", crc15});
+  return impls;
+}
+
+static unsigned int g_errors = 0;
+
+static void check_crc(const char* name, uint16_t crc, uint16_t expected,
+                      size_t num_bits, uint16_t init)
+{
+  if(crc != expected) {
+    if(g_errors < 10)
+      printf("%s: CRC 0x%04X, expected 0x%04X (%zu bits, init 0x%04X)\n",
+             name, crc, expected, num_bits, init);
+    g_errors++;
+  }
+}
+
+/**
+ * Pack the bits of a frame from SOF to the end of the data field,
+ * MSB first, and return the number of bits
+ */
+static size_t pack_frame(const CanMsg& msg, uint8_t* buffer)
+{
+  size_t num_bits = 0;
+
+  auto push = [&](uint64_t value, unsigned int length) {
+    for(unsigned int i = length; i > 0; i--, num_bits++) {
+      const uint8_t mask = 0x80 >> (num_bits % 8);
+      if((value >> (i - 1)) & 1)
+        buffer[num_bits / 8] |= mask;
+      else
+        buffer[num_bits / 8] &= ~mask;
+    }
+  };
+
+  push(0, 1);                                   // SOF
+  push(msg.arb_id_a, 11);
+  if(msg.ext_id) {
+    push(1, 1);                                 // SRR
+    push(1, 1);                                 // IDE
+    push(msg.arb_id_b, 18);
+    push(msg.remote_frame, 1);
+    push(0, 1);                                 // R1
+  } else {
+    push(msg.remote_frame, 1);
+    push(0, 1);                                 // IDE
+  }
+  push(0, 1);                                   // R0
+  push(msg.data_length, 4);
+
+  if(!msg.remote_frame) {
+    for(unsigned int i = 0; i < msg.data_length; i++)
+      push(msg.payload[i], 8);
+  }
+
+  return num_bits;
+}
+
+/**
+ * The CRC of a frame computed field by field with crc15_update()
+ */
+static uint16_t frame_crc_fields(const CanMsg& msg)
+{
+  uint16_t crc = crc15_update(0, 0, 1);
+  crc = crc15_update(crc, msg.arb_id_a, 11);
+  if(msg.ext_id) {
+    crc = crc15_update(crc, 0x3, 2);
+    crc = crc15_update(crc, msg.arb_id_b, 18);
+    crc = crc15_update(crc, msg.remote_frame << 1, 2);
+  } else {
+    crc = crc15_update(crc, msg.remote_frame << 1, 2);
+  }
+  crc = crc15_update(crc, msg.data_length, 5);
+
+  if(!msg.remote_frame) {
+    for(unsigned int i = 0; i < msg.data_length; i++)
+      crc = crc15_update(crc, msg.payload[i], 8);
+  }
+
+  return crc;
+}
+
+static CanMsg random_msg(std::mt19937& rng)
+{
+  CanMsg msg;
+  msg.ext_id = rng() & 1;
+  msg.remote_frame = (rng() & 3) == 0;
+  msg.arb_id_a = rng() & 0x7FF;
+  msg.arb_id_b = msg.ext_id ? rng() & 0x3FFFF : 0;
+  msg.data_length = rng() % 9;
+  for(unsigned int i = 0; i < 8; i++)
+    msg.payload[i] = rng();
+  return msg;
+}
+
+static int run_check()
+{
+  const std::vector<Implementation> impls = implementations();
+  std::mt19937 rng(1);
+
+  printf("Implementations:");
+  for(const Implementation& impl : impls)
+    printf(" %s", impl.name);
+  printf("\n");
+
+  // All CRC register values and all bytes
+  for(uint32_t init = 0; init <= CRC15_MASK; init++) {
+    for(uint32_t byte = 0; byte < 256; byte++) {
+      const uint8_t data = byte;
+      const uint16_t expected = crc15_serial(&data, 8, init);
+
+      for(const Implementation& impl : impls)
+        check_crc(impl.name, impl.function(&data, 8, init), expected, 8, init);
+      check_crc("update", crc15_update(init, byte, 8), expected, 8, init);
+    }
+  }
+  printf("All bytes, all CRC values: %u errors\n", g_errors);
+
+  // All CRC register values and all bit strings of 1 to 10 bits
+  for(uint32_t init = 0; init <= CRC15_MASK; init++) {
+    for(unsigned int num_bits = 1; num_bits <= 10; num_bits++) {
+      for(uint32_t value = 0; value < (1u << num_bits); value++) {
+        const uint8_t data[2] = {uint8_t(value << (16 - num_bits) >> 8),
+                                 uint8_t(value << (16 - num_bits))};
+        const uint16_t expected = crc15_serial(data, num_bits, init);
+
+        check_crc("table", crc15_table(data, num_bits, init), expected, num_bits, init);
+        check_crc("crc15", crc15(data, num_bits, init), expected, num_bits, init);
+        check_crc("update", crc15_update(init, value, num_bits), expected, num_bits, init);
+      }
+    }
+  }
+  printf("All bit strings up to 10 bits, all CRC values: %u errors\n", g_errors);
+
+  // Every bit length up to 4096 bits, at every alignment of the buffer
+  std::vector<uint8_t> buffer((1 << 16) + 16);
+  for(uint8_t& byte : buffer)
+    byte = rng();
+
+  for(size_t num_bits = 0; num_bits <= 4096; num_bits++) {
+    const size_t offset = num_bits % 16;
+    const uint16_t init = rng() & CRC15_MASK;
+    const uint16_t expected = crc15_serial(&buffer[offset], num_bits, init);
+
+    for(const Implementation& impl : impls)
+      check_crc(impl.name, impl.function(&buffer[offset], num_bits, init), expected, num_bits, init);
+  }
+  printf("All bit lengths up to 4096 bits: %u errors\n", g_errors);
+
+  // Random lengths up to 64 KiB
+  for(unsigned int n = 0; n < 1000; n++) {
+    const size_t offset = rng() % 16;
+    const size_t num_bits = rng() % (8 * (buffer.size() - 16));
+    const uint16_t init = rng() & CRC15_MASK;
+    const uint16_t expected = crc15_serial(&buffer[offset], num_bits, init);
+
+    for(const Implementation& impl : impls)
+      check_crc(impl.name, impl.function(&buffer[offset], num_bits, init), expected, num_bits, init);
+  }
+  printf("Random lengths up to 64 KiB: %u errors\n", g_errors);
+
+  // Frames, packed and field by field
+  uint8_t frame[16];
+  for(unsigned int n = 0; n < 1000000; n++) {
+    const CanMsg msg = random_msg(rng);
+    const size_t num_bits = pack_frame(msg, frame);
+    const uint16_t expected = crc15_serial(frame, num_bits);
+
+    check_crc("crc15 frame", crc15(frame, num_bits), expected, num_bits, 0);
+    check_crc("update frame", frame_crc_fields(msg), expected, num_bits, 0);
+  }
+  printf("Random frames: %u errors\n", g_errors);
+
+  printf("%s (%u errors)\n", g_errors == 0 ? "OK" : "FAILED", g_errors);
+  return g_errors == 0 ? 0 : 1;
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static int run_bench()
+{
+  const std::vector<Implementation> impls = implementations();
+  const char* selected = nullptr;
+  crc15_select(&selected);
+  printf("crc15() uses %s\n\n", selected);
+
+  std::mt19937 rng(1);
+  std::vector<uint8_t> buffer(1 << 20);
+  for(uint8_t& byte : buffer)
+    byte = rng();
+
+  const size_t sizes[] = {8, 16, 64, 256, 4096, 1 << 20};
+
+  printf("%-8s", "bytes");
+  for(const Implementation& impl : impls)
+    printf(" %10s", impl.name);
+  printf("   (MB/s)\n");
+
+  for(size_t size : sizes) {
+    printf("%-8zu", size);
+
+    for(const Implementation& impl : impls) {
+      // Roughly the same amount of data for all sizes, less for serial
+      const size_t total = impl.function == crc15_serial ? (16 << 20) : (256 << 20);
+      const size_t iterations = total / size;
+      uint16_t crc = 0;
+
+      auto start = std::chrono::steady_clock::now();
+      for(size_t i = 0; i < iterations; i++)
+        crc = impl.function(&buffer[(i * 64) % (buffer.size() - size + 1)], 8 * size, crc);
+      const double seconds = seconds_since(start);
+
+      printf(" %10.0f", iterations * size / seconds / 1e6);
+      if(crc == 0xFFFF)
+        printf("!");  // Keep the result alive
+    }
+    printf("\n");
+  }
+
+  // CRC of random frames, from SOF to the end of the data field
+  const unsigned int num_frames = 1 << 16;
+  std::vector<uint8_t> frames(16 * num_frames);
+  std::vector<size_t> frame_bits(num_frames);
+  std::vector<CanMsg> msgs(num_frames);
+
+  for(unsigned int i = 0; i < num_frames; i++) {
+    msgs[i] = random_msg(rng);
+    frame_bits[i] = pack_frame(msgs[i], &frames[16 * i]);
+  }
+
+  printf("\n%-8s", "frames");
+  for(const Implementation& impl : impls)
+    printf(" %10s", impl.name);
+  printf(" %10s   (Mframes/s)\n", "update");
+
+  printf("%-8s", "");
+  for(const Implementation& impl : impls) {
+    const unsigned int rounds = impl.function == crc15_serial ? 4 : 64;
+    uint16_t crc = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for(unsigned int r = 0; r < rounds; r++) {
+      for(unsigned int i = 0; i < num_frames; i++)
+        crc ^= impl.function(&frames[16 * i], frame_bits[i], 0);
+    }
+    const double seconds = seconds_since(start);
+
+    printf(" %10.1f", double(rounds) * num_frames / seconds / 1e6);
+    if(crc == 0xFFFF)
+      printf("!");
+  }
+
+  {
+    const unsigned int rounds = 64;
+    uint16_t crc = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for(unsigned int r = 0; r < rounds; r++) {
+      for(unsigned int i = 0; i < num_frames; i++)
+        crc ^= frame_crc_fields(msgs[i]);
+    }
+    const double seconds = seconds_since(start);
+
+    printf(" %10.1f", double(rounds) * num_frames / seconds / 1e6);
+    if(crc == 0xFFFF)
+      printf("!");
+  }
+  printf("\n");
+
+  return 0;
+}
+
+int main(int argc, char** argv)
+{
+  const char* mode = argc > 1 ? argv[1] : "check";
+
+  if(strcmp(mode, "check") == 0) {
+    return run_check();
+  } else if(strcmp(mode, "bench") == 0) {
+    return run_bench();
+  }
+
+  printf("Usage: %s check|bench\n", argv[0]);
+  return 1;
+}
@@ -0,0 +1,656 @@
+/**
+ * @file   canola_isotp.cpp
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  ISO-TP transport, see canola_isotp.hpp.
+ *
+ *         check:  Sends messages of 1 byte to 10 kB between two simulated
+ *                 controllers (canola_sim.hpp), with Tx mailboxes and with
+ *                 the TX registers, with and without block size, STmin,
+ *                 padding and extended IDs. A third controller records the
+ *                 frames on the bus, which are checked against a reference
+ *                 segmentation, for the block size and for STmin. Also
+ *                 checks 32 sessions sending both ways at the same time,
+ *                 overflow, timeouts, wrong sequence numbers, flow control
+ *                 WAIT and failed frames, and that a 4 kB message keeps
+ *                 the bus busy with the mailboxes.
+ *         bench:  Bus load and time for a 4 kB message with the TX
+ *                 registers and with 8 and 32 mailboxes, with poll() called
+ *                 every 1 to 200 us, and the CPU time per frame to segment
+ *                 and reassemble.
+ *
+ *         Build: g++ -std=c++14 -O2 -march=native -pthread -I.. canola_isotp.cpp -o canola_isotp
+ */
+
+#include "canola_isotp.hpp"
+#include "canola_sim.hpp"
+#include "canola_stuff.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace canola;
+
+static unsigned int g_errors = 0;
+
+static void check(bool ok, const char* what, uint64_t index)
+{
+  if(!ok) {
+    if(g_errors < 10)
+      printf("%s (%llu)\n", what, (unsigned long long)index);
+    g_errors++;
+  }
+}
+
+static CanMsg make_msg(uint32_t id, bool ext_id, std::initializer_list<uint8_t> payload)
+{
+  CanMsg msg = CanMsg{};
+  msg.ext_id = ext_id;
+  msg.arb_id_a = ext_id ? (id >> 18) & 0x7FF : id;
+  msg.arb_id_b = ext_id ? id & 0x3FFFF : 0;
+  for(uint8_t byte : payload)
+    msg.payload[msg.data_length++] = byte;
+  return msg;
+}
+
+/**
+ * Frames of a message, written out from the standard without using the
+ * transport, to compare with what is on the bus
+ */
+static std::vector<CanMsg> reference_frames(uint32_t id, bool ext_id, const uint8_t* data,
+                                            uint32_t length, const isotp::Options& options)
+{
+  std::vector<CanMsg> frames;
+  std::vector<uint8_t> bytes;
+  uint32_t offset = 0;
+
+  if(length <= 7) {
+    bytes = {uint8_t(length)};
+  } else if(length <= 4095) {
+    bytes = {uint8_t(0x10 | (length >> 8)), uint8_t(length)};
+  } else {
+    bytes = {0x10, 0x00, uint8_t(length >> 24), uint8_t(length >> 16), uint8_t(length >> 8),
+             uint8_t(length)};
+  }
+
+  for(unsigned int sn = 1;; sn++) {
+    while(bytes.size() < 8 && offset < length)
+      bytes.push_back(data[offset++]);
+    while(options.padding && bytes.size() < 8)
+      bytes.push_back(options.padding_byte);
+
+    CanMsg msg = make_msg(id, ext_id, {});
+    std::memcpy(msg.payload, bytes.data(), bytes.size());
+    msg.data_length = bytes.size();
+    frames.push_back(msg);
+
+    if(offset == length)
+      return frames;
+    bytes = {uint8_t(0x20 | (sn & 0xF))};
+  }
+}
+
+static bool same_frame(const CanMsg& a, const CanMsg& b)
+{
+  return a.arb_id_a == b.arb_id_a && a.arb_id_b == b.arb_id_b && a.ext_id == b.ext_id &&
+         a.data_length == b.data_length &&
+         std::memcmp(a.payload, b.payload, a.data_length) == 0;
+}
+
+//-----------------------------------------------------------------------------
+// Simulated link
+//-----------------------------------------------------------------------------
+
+/**
+ * Two controllers with a transport each, and a third controller that
+ * records all frames on the bus and can send frames of its own. The
+ * transports are served (Rx FIFO drained and poll()) every poll_bits bits,
+ * as if that were the delay until the driver gets to run. Frames are
+ * retransmitted until they are sent, as they must be when both nodes send
+ * at the same time.
+ */
+class Link
+{
+public:
+  struct Node {
+    Node(sim::SimIO io, unsigned int mailboxes) : can(io), transport(can, 0, mailboxes)
+    {
+      can.init();
+      can.set_rx_fifo_enable(true);
+      can.set_retransmit_enable(true);
+      can.set_tx_mailbox_enable(mailboxes > 0);
+    }
+
+    Canola<sim::SimIO> can;
+    isotp::Transport<sim::SimIO> transport;
+  };
+
+  Link(unsigned int mailboxes, unsigned int poll_bits, unsigned int hw_mailboxes = 8)
+    : m_poll_bits(poll_bits)
+  {
+    sim::Config config;
+    config.tx_mailboxes = hw_mailboxes;
+    config.retransmit_count_max = model::RETRANSMIT_COUNT_FOREVER;
+
+    for(unsigned int i = 0; i < 2; i++)
+      m_nodes.emplace_back(new Node(m_bus.io(m_bus.add(config)), mailboxes));
+
+    m_monitor.reset(new Canola<sim::SimIO>(m_bus.io(m_bus.add(config))));
+    m_monitor->init();
+    m_monitor->set_rx_fifo_enable(true);
+    m_monitor->set_rx_timestamp_enable(true);
+
+    m_bus.run(20);
+  }
+
+  isotp::Transport<sim::SimIO>& tp(unsigned int node) { return m_nodes[node]->transport; }
+  Canola<sim::SimIO>& monitor() { return *m_monitor; }
+  sim::Bus& bus() { return m_bus; }
+
+  // Frames seen by the monitor, with RX_TIMESTAMP
+  std::vector<CanMsg>& log() { return m_log; }
+
+  uint64_t now_ns() const { return uint64_t(m_bus.bit_count() * (1e9 / m_bus.bit_rate()) + 0.5); }
+
+  void serve()
+  {
+    const uint64_t now = now_ns();
+
+    m_monitor->drain([this](const CanMsg& msg) { m_log.push_back(msg); });
+
+    for(auto& node : m_nodes) {
+      node->can.drain([&](const CanMsg& msg) { node->transport.on_msg(msg, now); });
+      node->transport.poll(now);
+    }
+  }
+
+  template <typename Predicate>
+  bool run_until(Predicate&& done, uint64_t max_bits)
+  {
+    return m_bus.run_until([&]() {
+      if(m_bus.bit_count() % m_poll_bits == 0)
+        serve();
+      return done();
+    }, max_bits);
+  }
+
+  // Run until both transports are idle, and the monitor has the last frame
+  bool run_idle(uint64_t max_bits)
+  {
+    const bool idle = run_until([this]() { return !tp(0).busy() && !tp(1).busy(); }, max_bits);
+    m_bus.run(m_poll_bits + 20);
+    serve();
+    return idle;
+  }
+
+private:
+  sim::Bus m_bus;
+  std::vector<std::unique_ptr<Node>> m_nodes;
+  std::unique_ptr<Canola<sim::SimIO>> m_monitor;
+  std::vector<CanMsg> m_log;
+  unsigned int m_poll_bits;
+};
+
+// From the start of the first frame in log to the end of the last, the
+// fraction of the time the bus was busy with frames and intermissions
+static double bus_load(const std::vector<CanMsg>& log)
+{
+  const double cycles_per_bit = CLOCK_FREQ_DEFAULT / BIT_RATE_DEFAULT;
+  double busy_bits = 0;
+
+  for(size_t i = 0; i < log.size(); i++)
+    busy_bits += frame_length(log[i]) + (i + 1 < log.size() ? FRAME_IFS_LENGTH : 0);
+
+  const double span_bits = uint32_t(log.back().timestamp - log.front().timestamp) / cycles_per_bit +
+                           frame_length(log.front());
+  return busy_bits / span_bits;
+}
+
+//-----------------------------------------------------------------------------
+// Check
+//-----------------------------------------------------------------------------
+static void check_st_min()
+{
+  check(isotp::st_min_ns(0x00) == 0, "STmin 0x00", 0);
+  check(isotp::st_min_ns(0x7F) == 127000000, "STmin 0x7F", 0x7F);
+  check(isotp::st_min_ns(0xF1) == 100000, "STmin 0xF1", 0xF1);
+  check(isotp::st_min_ns(0xF9) == 900000, "STmin 0xF9", 0xF9);
+  check(isotp::st_min_ns(0x80) == 127000000, "STmin reserved", 0x80);
+  check(isotp::st_min_ns(0xFA) == 127000000, "STmin reserved", 0xFA);
+
+  const uint32_t us[] = {0, 1, 100, 101, 900, 901, 1000, 1001, 127000, 200000};
+  const uint8_t encoded[] = {0x00, 0xF1, 0xF1, 0xF2, 0xF9, 0x01, 0x01, 0x02, 0x7F, 0x7F};
+  for(unsigned int i = 0; i < sizeof(us) / sizeof(us[0]); i++)
+    check(isotp::encode_st_min(us[i]) == encoded[i], "Encode STmin", us[i]);
+
+  for(uint32_t t = 0; t <= 127000; t += 7)
+    check(isotp::st_min_ns(isotp::encode_st_min(t)) >= uint64_t(t) * 1000, "STmin too short", t);
+}
+
+struct TransferConfig {
+  const char* name;
+  unsigned int mailboxes;
+  uint8_t block_size;
+  uint32_t st_min_us;
+  bool padding;
+  bool ext_id;
+};
+
+static const uint32_t TESTER_ID = 0x7E0;
+static const uint32_t ECU_ID = 0x7E8;
+static const uint32_t TESTER_EXT_ID = 0x18DA10F1;
+static const uint32_t ECU_EXT_ID = 0x18DAF110;
+
+/**
+ * Send a message from node from to the other node on link, and check that
+ * it arrives in the buffer, without writing past it, and that the frames
+ * on the bus are as the standard says
+ */
+static void check_transfer(Link& link, unsigned int from, const TransferConfig& config,
+                           uint32_t length, std::mt19937& rng, uint64_t index)
+{
+  constexpr unsigned int GUARD = 16;
+  const unsigned int to = 1 - from;
+  const uint32_t tx_id = config.ext_id ? (from == 0 ? TESTER_EXT_ID : ECU_EXT_ID)
+                                       : (from == 0 ? TESTER_ID : ECU_ID);
+  const uint32_t rx_id = config.ext_id ? (from == 0 ? ECU_EXT_ID : TESTER_EXT_ID)
+                                       : (from == 0 ? ECU_ID : TESTER_ID);
+
+  std::vector<uint8_t> data(length);
+  for(uint8_t& byte : data)
+    byte = rng() % 256;
+
+  std::vector<uint8_t> buffer(length + GUARD, 0xA5);
+
+  isotp::Options options;
+  options.block_size = config.block_size;
+  options.st_min_us = config.st_min_us;
+  options.padding = config.padding;
+
+  link.log().clear();
+  check(link.tp(to).receive(0, buffer.data(), length), "Receive", index);
+  check(link.tp(from).send(0, data.data(), length, link.now_ns()), "Send", index);
+  check(link.run_idle(uint64_t(length) * 5000 + 100000), "Transfer did not finish", index);
+
+  check(link.tp(from).tx_result(0) == isotp::Result::DONE, "Tx result", index);
+  check(link.tp(to).rx_result(0) == isotp::Result::DONE, "Rx result", index);
+  check(link.tp(to).rx_length(0) == length, "Rx length", index);
+  check(std::memcmp(buffer.data(), data.data(), length) == 0, "Data", index);
+
+  bool guard_ok = true;
+  for(unsigned int i = 0; i < GUARD; i++)
+    guard_ok = guard_ok && buffer[length + i] == 0xA5;
+  check(guard_ok, "Written past the buffer", index);
+
+  // Frames from the sender as in the standard, and block size and STmin
+  const std::vector<CanMsg> expected = reference_frames(tx_id, config.ext_id, data.data(),
+                                                        length, options);
+  const double cycles_per_bit = CLOCK_FREQ_DEFAULT / BIT_RATE_DEFAULT;
+  size_t n = 0;
+  unsigned int block = 0;
+  const CanMsg* prev = nullptr;
+
+  for(const CanMsg& msg : link.log()) {
+    if(isotp::id_key(msg) == isotp::id_key(rx_id, config.ext_id)) {
+      check(msg.data_length >= 3 && msg.payload[0] == 0x30 &&
+            msg.payload[1] == config.block_size &&
+            msg.payload[2] == isotp::encode_st_min(config.st_min_us), "Flow control", index);
+      block = 0;
+      continue;
+    }
+
+    check(n < expected.size() && same_frame(msg, expected[n]), "Frame", index * 10000 + n);
+
+    if(n >= 1 && config.block_size > 0)
+      check(block < config.block_size, "Block size", index * 10000 + n);
+
+    if(n >= 2 && config.st_min_us > 0) {
+      const double gap_bits = uint32_t(msg.timestamp - prev->timestamp) / cycles_per_bit -
+                              frame_length(msg);
+      check(gap_bits * (1e6 / BIT_RATE_DEFAULT) >= config.st_min_us, "STmin", index * 10000 + n);
+    }
+
+    block++;
+    prev = &msg;
+    n++;
+  }
+
+  check(n == expected.size(), "Number of frames", index);
+}
+
+static void check_transfers()
+{
+  const TransferConfig configs[] = {
+    {"8 mailboxes",                     8, 0, 0,    true,  false},
+    {"8 mailboxes, BS 4",               8, 4, 0,    true,  false},
+    {"8 mailboxes, BS 1, STmin 300 us", 8, 1, 300,  false, true},
+    {"8 mailboxes, STmin 2 ms",         8, 0, 2000, true,  false},
+    {"TX registers",                    0, 0, 0,    true,  false},
+    {"TX registers, BS 2, STmin 100 us",0, 2, 100,  false, true},
+  };
+  const uint32_t lengths[] = {1, 7, 8, 13, 62, 63, 111, 112, 4095, 4096, 10000};
+
+  std::mt19937 rng(1);
+  uint64_t index = 0;
+
+  for(const TransferConfig& config : configs) {
+    Link link(config.mailboxes, 20);
+    isotp::Options options;
+    options.block_size = config.block_size;
+    options.st_min_us = config.st_min_us;
+    options.padding = config.padding;
+
+    const uint32_t tester_id = config.ext_id ? TESTER_EXT_ID : TESTER_ID;
+    const uint32_t ecu_id = config.ext_id ? ECU_EXT_ID : ECU_ID;
+    link.tp(0).open({tester_id, ecu_id, config.ext_id}, options);
+    link.tp(1).open({ecu_id, tester_id, config.ext_id}, options);
+
+    const unsigned int errors = g_errors;
+    for(uint32_t length : lengths) {
+      // Long STmin is slow to simulate
+      if(config.st_min_us >= 1000 && length > 1000)
+        continue;
+      for(unsigned int from = 0; from < 2; from++)
+        check_transfer(link, from, config, length, rng, index++);
+    }
+
+    printf("  %-34s %s\n", config.name, g_errors == errors ? "ok" : "FAILED");
+  }
+}
+
+// 32 sessions on each side, all sending both ways at once
+static void check_concurrent()
+{
+  constexpr unsigned int SESSIONS = 32;
+
+  Link link(8, 20);
+  std::mt19937 rng(2);
+  std::vector<std::vector<uint8_t>> data[2], buffers[2];
+
+  for(unsigned int i = 0; i < SESSIONS; i++) {
+    const bool ext = i % 2 == 1;
+    const uint32_t tester_id = ext ? 0x18DA00F1 | (i << 8) : 0x600 + i;
+    const uint32_t ecu_id = ext ? 0x18DAF100 | i : 0x680 + i;
+
+    isotp::Options options;
+    options.block_size = rng() % 9;
+    options.padding = rng() % 2;
+    options.timeout_ns = 10000000000;  // The bus is busy for 2 s, the highest IDs go first
+
+    check(link.tp(0).open({tester_id, ecu_id, ext}, options) == int(i), "Open", i);
+    check(link.tp(1).open({ecu_id, tester_id, ext}, options) == int(i), "Open", i);
+  }
+
+  check(link.tp(0).open({0x123, 0x680, false}) == -1, "Open with an Rx ID in use", 0);
+
+  for(unsigned int node = 0; node < 2; node++) {
+    for(unsigned int i = 0; i < SESSIONS; i++) {
+      const uint32_t length = 1 + rng() % 3000;
+      data[node].emplace_back(length);
+      for(uint8_t& byte : data[node].back())
+        byte = rng() % 256;
+      buffers[node].emplace_back(3000, 0);
+      link.tp(node).receive(i, buffers[node].back().data(), 3000);
+    }
+  }
+
+  for(unsigned int node = 0; node < 2; node++) {
+    for(unsigned int i = 0; i < SESSIONS; i++)
+      link.tp(node).send(i, data[node][i].data(), data[node][i].size(), link.now_ns());
+  }
+
+  check(link.run_idle(50000000), "Concurrent transfers did not finish", 0);
+
+  for(unsigned int node = 0; node < 2; node++) {
+    for(unsigned int i = 0; i < SESSIONS; i++) {
+      const std::vector<uint8_t>& sent = data[1 - node][i];
+      check(link.tp(1 - node).tx_result(i) == isotp::Result::DONE, "Concurrent Tx", i);
+      check(link.tp(node).rx_result(i) == isotp::Result::DONE &&
+            link.tp(node).rx_length(i) == sent.size() &&
+            std::memcmp(buffers[node][i].data(), sent.data(), sent.size()) == 0,
+            "Concurrent Rx", i);
+    }
+  }
+
+  check(link.tp(0).stats().messages_sent == SESSIONS &&
+        link.tp(0).stats().messages_received == SESSIONS &&
+        link.tp(0).stats().frames_ignored == 0, "Stats", 0);
+
+  printf("  %-34s %s\n", "32 sessions both ways", "done");
+}
+
+static void check_errors()
+{
+  const isotp::Result DONE = isotp::Result::DONE;
+  uint8_t data[200] = {};
+  uint8_t buffer[200] = {};
+
+  isotp::Options options;
+  options.timeout_ns = 5000000;
+  options.wait_frames_max = 2;
+
+  Link link(8, 20);
+  link.tp(0).open({TESTER_ID, ECU_ID, false}, options);
+  link.tp(1).open({ECU_ID, TESTER_ID, false}, options);
+  link.tp(0).open({0x700, 0x708, false}, options);   // Nobody on the other end
+
+  // Longer than the buffer
+  link.tp(1).receive(0, buffer, 100);
+  link.tp(0).send(0, data, 200, link.now_ns());
+  link.run_idle(100000);
+  check(link.tp(0).tx_result(0) == isotp::Result::OVERFLOW, "Overflow Tx", 0);
+  check(link.tp(1).rx_result(0) == isotp::Result::OVERFLOW, "Overflow Rx", 0);
+
+  // No buffer
+  link.tp(0).send(0, data, 200, link.now_ns());
+  link.run_idle(100000);
+  check(link.tp(0).tx_result(0) == isotp::Result::OVERFLOW, "Overflow without a buffer", 0);
+  check(link.tp(1).rx_result(0) == isotp::Result::OVERFLOW, "Rx result kept", 0);
+
+  // Single frame longer than the buffer
+  link.tp(1).receive(0, buffer, 3);
+  link.tp(0).send(0, data, 5, link.now_ns());
+  link.run_idle(100000);
+  check(link.tp(0).tx_result(0) == DONE && link.tp(1).rx_result(0) == isotp::Result::OVERFLOW,
+        "Single frame overflow", 0);
+
+  // No flow control (N_Bs)
+  link.tp(0).send(1, data, 100, link.now_ns());
+  const uint64_t start_ns = link.now_ns();
+  link.run_idle(100000);
+  check(link.tp(0).tx_result(1) == isotp::Result::TIMEOUT &&
+        link.now_ns() - start_ns >= options.timeout_ns, "Flow control timeout", 0);
+
+  // Sender stops (N_Cr)
+  link.tp(1).receive(0, buffer, 200);
+  link.tp(0).send(0, data, 200, link.now_ns());
+  link.run_until([&]() { return link.tp(1).rx_length(0) == 200 && link.log().size() > 5; },
+                 100000);
+  link.tp(0).abort(0);
+  link.run_idle(100000);
+  check(link.tp(0).tx_result(0) == isotp::Result::ABORTED, "Abort", 0);
+  check(link.tp(1).rx_result(0) == isotp::Result::TIMEOUT, "Consecutive frame timeout", 0);
+
+  // Next message after the errors
+  link.tp(1).receive(0, buffer, 200);
+  link.tp(0).send(0, data, 200, link.now_ns());
+  link.run_idle(100000);
+  check(link.tp(0).tx_result(0) == DONE && link.tp(1).rx_result(0) == DONE,
+        "Message after errors", 0);
+
+  // Frames from the monitor controller
+  auto inject = [&](const CanMsg& msg) {
+    link.monitor().send_msg(msg);
+    link.run_until([&]() { return !link.monitor().is_busy(); }, 1000);
+    link.bus().run(40);
+    link.serve();
+  };
+
+  // Wrong sequence number
+  link.tp(1).receive(0, buffer, 200);
+  inject(make_msg(TESTER_ID, false, {0x10, 20, 1, 2, 3, 4, 5, 6}));
+  inject(make_msg(TESTER_ID, false, {0x22, 7, 8, 9, 10, 11, 12, 13}));
+  check(link.tp(1).rx_result(0) == isotp::Result::WRONG_SN, "Wrong sequence number", 0);
+  link.run_idle(10000);
+
+  // Flow control WAIT, too many and then a reserved flow status
+  link.log().clear();
+  link.tp(0).send(1, data, 100, link.now_ns());
+  link.run_until([&]() { return !link.log().empty(); }, 1000);
+  for(unsigned int i = 0; i < 2; i++)
+    inject(make_msg(0x708, false, {0x31, 0, 0}));
+  check(link.tp(0).tx_result(1) == isotp::Result::BUSY, "Flow control WAIT", 0);
+  inject(make_msg(0x708, false, {0x31, 0, 0}));
+  check(link.tp(0).tx_result(1) == isotp::Result::WAIT_OVERRUN, "Wait overrun", 0);
+
+  link.tp(0).send(1, data, 100, link.now_ns());
+  link.bus().run(300);
+  inject(make_msg(0x708, false, {0x35, 0, 0}));
+  check(link.tp(0).tx_result(1) == isotp::Result::INVALID_FLOW, "Invalid flow status", 0);
+
+  // Unexpected frames are ignored
+  const uint64_t ignored = link.tp(1).stats().frames_ignored;
+  inject(make_msg(TESTER_ID, false, {0x21, 1, 2, 3, 4, 5, 6, 7}));
+  inject(make_msg(TESTER_ID, false, {0x30, 0, 0}));
+  check(link.tp(1).stats().frames_ignored == ignored + 2, "Unexpected frames", 0);
+
+  link.run_idle(10000);
+
+  // Alone on a bus, nobody acknowledges the first frame
+  sim::Bus bus;
+  Canola<sim::SimIO> can(bus.io(bus.add()));
+  can.init();
+  can.set_tx_mailbox_enable(true);
+  isotp::Transport<sim::SimIO> transport(can, 0, 8);
+  transport.open({TESTER_ID, ECU_ID, false}, options);
+  transport.send(0, data, 100, 0);
+  bus.run_until([&]() {
+    transport.poll(uint64_t(bus.time() * 1e9));
+    return !transport.busy();
+  }, 100000);
+  check(transport.tx_result(0) == isotp::Result::TX_FAILED, "Failed frame", 0);
+
+  printf("  %-34s %s\n", "Errors and timeouts", "done");
+}
+
+// Bus load while sending a 4 kB message, with poll() every poll_bits
+static double load_4k(unsigned int mailboxes, unsigned int hw_mailboxes, unsigned int poll_bits,
+                      double* seconds = nullptr)
+{
+  Link link(mailboxes, poll_bits, hw_mailboxes);
+  std::vector<uint8_t> data(4096, 0x55), buffer(4096);
+
+  link.tp(0).open({TESTER_ID, ECU_ID, false});
+  link.tp(1).open({ECU_ID, TESTER_ID, false});
+  link.tp(1).receive(0, buffer.data(), buffer.size());
+
+  const double start = link.bus().time();
+  link.tp(0).send(0, data.data(), data.size(), link.now_ns());
+  link.run_idle(10000000);
+  check(link.tp(1).rx_result(0) == isotp::Result::DONE && buffer == data, "4 kB message", poll_bits);
+
+  if(seconds != nullptr)
+    *seconds = link.bus().time() - start;
+  return bus_load(link.log());
+}
+
+static int run_check()
+{
+  check_st_min();
+  check_transfers();
+  check_concurrent();
+  check_errors();
+
+  // With poll() every 50 us, the mailboxes keep the bus busy, the TX
+  // registers leave a gap after each frame
+  const double mailbox_load = load_4k(8, 8, 50);
+  const double regs_load = load_4k(0, 8, 50);
+  printf("  %-34s %.1f %% bus load (TX registers %.1f %%)\n", "4 kB with 8 mailboxes, 50 us poll",
+         100.0 * mailbox_load, 100.0 * regs_load);
+  check(mailbox_load > 0.95, "Bus load with mailboxes", 0);
+  check(mailbox_load > regs_load + 0.1, "Bus load with mailboxes vs TX registers", 0);
+
+  printf("%s (%u errors)\n", g_errors == 0 ? "OK" : "FAILED", g_errors);
+  return g_errors == 0 ? 0 : 1;
+}
+
+//-----------------------------------------------------------------------------
+// Bench
+//-----------------------------------------------------------------------------
+static double ns_per(std::chrono::steady_clock::time_point start, uint64_t count)
+{
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+         count;
+}
+
+static int run_bench()
+{
+  const unsigned int periods[] = {1, 10, 20, 50, 100, 200};
+
+  printf("4 kB message at 1 Mbit/s, bus load (time) with poll() every n us:\n");
+  printf("  %-10s %20s %20s %20s\n", "n", "TX registers", "8 mailboxes", "32 mailboxes");
+  for(unsigned int period : periods) {
+    double t[3];
+    const double load[3] = {load_4k(0, 8, period, &t[0]), load_4k(8, 8, period, &t[1]),
+                            load_4k(32, 32, period, &t[2])};
+    printf("  %-10u", period);
+    for(unsigned int i = 0; i < 3; i++)
+      printf(" %8.1f %% (%5.1f ms)", 100.0 * load[i], 1e3 * t[i]);
+    printf("\n");
+  }
+
+  // CPU time on the host, with registers in memory
+  constexpr unsigned int MESSAGES = 2000;
+  MockIO io;
+  Canola<MockIO> can(io);
+  isotp::Transport<MockIO> sender(can), receiver(can);
+  sender.open({TESTER_ID, ECU_ID, false});
+  receiver.open({ECU_ID, TESTER_ID, false});
+
+  std::vector<uint8_t> data(4096, 0x55), buffer(4096);
+  const std::vector<CanMsg> frames = reference_frames(TESTER_ID, false, data.data(), data.size(),
+                                                      isotp::Options());
+  const CanMsg flow_control = make_msg(ECU_ID, false, {0x30, 0, 0, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC});
+
+  auto start = std::chrono::steady_clock::now();
+  for(unsigned int m = 0; m < MESSAGES; m++) {
+    sender.send(0, data.data(), data.size(), 0);
+    sender.poll(0);
+    sender.on_msg(flow_control, 0);
+    while(sender.busy())
+      sender.poll(0);
+  }
+  const double segment_ns = ns_per(start, uint64_t(MESSAGES) * frames.size());
+
+  start = std::chrono::steady_clock::now();
+  for(unsigned int m = 0; m < MESSAGES; m++) {
+    receiver.receive(0, buffer.data(), buffer.size());
+    for(const CanMsg& frame : frames)
+      receiver.on_msg(frame, 0);
+  }
+  const double reassemble_ns = ns_per(start, uint64_t(MESSAGES) * frames.size());
+
+  check(sender.stats().messages_sent == MESSAGES &&
+        receiver.stats().messages_received == MESSAGES && buffer == data, "Bench", 0);
+
+  printf("CPU time per frame: segment %.1f ns, reassemble %.1f ns\n", segment_ns, reassemble_ns);
+  return g_errors == 0 ? 0 : 1;
+}
+
+int main(int argc, char** argv)
+{
+  const std::string mode = argc > 1 ? argv[1] : "";
+
+  if(mode == "check")
+    return run_check();
+  if(mode == "bench")
+    return run_bench();
+
+  printf("Usage: %s check|bench\n", argv[0]);
+  return 1;
+}
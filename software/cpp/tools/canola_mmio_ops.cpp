@@ -0,0 +1,86 @@
+/**
+ * @file   canola_mmio_ops.cpp
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Reports the number of MMIO operations (register bus transactions)
+ *         per frame for the regular and the burst send/receive functions of
+ *         the C++ driver, using the MockIO backends.
+ *
+ *         Build: g++ -std=c++14 -O2 -I.. canola_mmio_ops.cpp -o canola_mmio_ops
+ */
+
+#include "canola.hpp"
+#include <cstdio>
+#include <cstdlib>
+
+using namespace canola;
+
+static CanMsg generate_rand_msg(void)
+{
+  CanMsg msg = {};
+
+  msg.arb_id_a = rand() % 2048;
+  msg.ext_id = (rand() % 2) == 1;
+  msg.arb_id_b = msg.ext_id ? rand() % 262144 : 0;
+  msg.remote_frame = (rand() % 2) == 1;
+  msg.data_length = rand() % 9;
+
+  for(unsigned int i = 0; i < msg.data_length && !msg.remote_frame; i++)
+    msg.payload[i] = rand() % 256;
+
+  return msg;
+}
+
+// Emulate reception of msg by copying the TX registers to the RX registers
+static void loopback(MockIO& io)
+{
+  io.poke(reg::RX_MSG_ID::address, io.peek(reg::TX_MSG_ID::address));
+  io.poke(reg::RX_PAYLOAD_LENGTH::address, io.peek(reg::TX_PAYLOAD_LENGTH::address));
+  io.poke(reg::RX_PAYLOAD_0::address, io.peek(reg::TX_PAYLOAD_0::address));
+  io.poke(reg::RX_PAYLOAD_1::address, io.peek(reg::TX_PAYLOAD_1::address));
+}
+
+template <typename IO>
+static void run(const char* name, unsigned int num_frames, bool burst)
+{
+  Canola<IO> can{IO()};
+  uint64_t tx_ops = 0;
+  uint64_t rx_ops = 0;
+  unsigned int errors = 0;
+
+  srand(0);
+
+  for(unsigned int i = 0; i < num_frames; i++) {
+    CanMsg msg = generate_rand_msg();
+
+    can.io().reset_counts();
+    if(burst)
+      can.send_msg_burst(msg);
+    else
+      can.send_msg(msg);
+    tx_ops += can.io().write_count() + can.io().read_count();
+
+    loopback(can.io());
+
+    can.io().reset_counts();
+    CanMsg msg_rx = burst ? can.get_msg_burst() : can.get_msg();
+    rx_ops += can.io().write_count() + can.io().read_count();
+
+    if(!compare_messages(msg, msg_rx))
+      errors++;
+  }
+
+  printf("%-24s TX: %.2f ops/frame  RX: %.2f ops/frame  (%u mismatches)\n",
+         name, double(tx_ops)/num_frames, double(rx_ops)/num_frames, errors);
+}
+
+int main(int argc, char* argv[])
+{
+  unsigned int num_frames = argc > 1 ? atoi(argv[1]) : 100000;
+
+  run<MockIO>("send/get_msg", num_frames, false);
+  run<MockIO>("burst (32-bit)", num_frames, true);
+  run<MockIO64>("burst (64-bit)", num_frames, true);
+
+  return 0;
+}
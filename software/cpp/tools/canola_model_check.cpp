@@ -0,0 +1,1015 @@
+/**
+ * @file   canola_model_check.cpp
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Cross-check and soak test for the bit-level model in canola_model.hpp.
+ *
+ *         check: Replays the stimulus of canola_top_tb.vhd (tests #1 - #14)
+ *                against the model, with a CAN bus functional model written
+ *                from the CAN specification (same features as can_bfm_pkg),
+ *                and checks the same things as the testbench.
+ *         soak:  Random traffic between nodes on independent buses, one
+ *                bus per thread, checks that every message is received by
+ *                all other nodes and reports the throughput.
+ *         trace: Prints bus value and FSM states bit by bit for one frame,
+ *                for comparison with a list from a simulation.
+ *
+ *         Build: g++ -std=c++14 -O2 -march=native -pthread -I.. canola_model_check.cpp -o canola_model_check
+ */
+
+#include "canola_model.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace canola;
+using namespace canola::model;
+
+static unsigned int g_errors = 0;
+
+static void check(bool ok, unsigned int test_num, const char* what)
+{
+  if(!ok) {
+    if(g_errors < 50)
+      printf("Test #%u: %s\n", test_num, what);
+    g_errors++;
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Random messages, same distribution as generate_random_can_message in
+// canola_top_tb.vhd
+//-----------------------------------------------------------------------------
+class MsgGenerator
+{
+public:
+  explicit MsgGenerator(uint32_t seed) : m_rng(seed) {}
+
+  CanMsg random_msg(bool ext_id, bool allow_remote_frame = true)
+  {
+    CanMsg msg = CanMsg{};
+
+    msg.data_length = std::lround(uniform() * 8);
+    msg.remote_frame = uniform() > 0.5 && allow_remote_frame;
+    msg.ext_id = ext_id;
+
+    if(ext_id) {
+      uint32_t id = std::lround(uniform() * ((1 << 29) - 1));
+      msg.arb_id_a = id >> ID_B_LENGTH;
+      msg.arb_id_b = id & 0x3FFFF;
+    } else {
+      msg.arb_id_a = std::lround(uniform() * ((1 << 11) - 1));
+    }
+
+    if(!msg.remote_frame) {
+      for(unsigned int i = 0; i < msg.data_length; i++)
+        msg.payload[i] = std::lround(uniform() * 255);
+    }
+
+    return msg;
+  }
+
+  double uniform() { return std::uniform_real_distribution<double>(0.0, 1.0)(m_rng); }
+  uint32_t operator()() { return m_rng(); }
+
+private:
+  std::mt19937 m_rng;
+};
+
+static uint32_t msg_id(const CanMsg& msg)
+{
+  return msg.ext_id ? (msg.arb_id_a << ID_B_LENGTH) | msg.arb_id_b : msg.arb_id_a;
+}
+
+static void set_msg_id(CanMsg& msg, uint32_t id)
+{
+  if(msg.ext_id) {
+    msg.arb_id_a = (id >> ID_B_LENGTH) & 0x7FF;
+    msg.arb_id_b = id & 0x3FFFF;
+  } else {
+    msg.arb_id_a = id & 0x7FF;
+  }
+}
+
+// Same comparison as check_value() for can_msg_t in canola_tb_pkg.vhd
+static bool msg_equal(const CanMsg& value, const CanMsg& exp)
+{
+  if(value.ext_id != exp.ext_id || value.arb_id_a != exp.arb_id_a)
+    return false;
+  if(exp.ext_id && value.arb_id_b != exp.arb_id_b)
+    return false;
+  if(value.remote_frame != exp.remote_frame || value.data_length != exp.data_length)
+    return false;
+  if(!exp.remote_frame)
+    return memcmp(value.payload, exp.payload, exp.data_length) == 0;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+// CAN bus functional model
+//-----------------------------------------------------------------------------
+struct Bench {
+  Node dut;
+  Bus bus;
+  uint32_t events = 0;  // Events from the DUT since last cleared
+  std::vector<bool> bus_bits;
+
+  Bench() { bus.attach(dut); }
+
+  bool step(bool bfm_bit = true)
+  {
+    bool bit = bus.step(bfm_bit);
+    events |= dut.events();
+    bus_bits.push_back(bit);
+    return bit;
+  }
+
+  void idle(unsigned int num_bits)
+  {
+    for(unsigned int i = 0; i < num_bits; i++)
+      step();
+  }
+
+  void reset_dut()
+  {
+    dut.reset();
+    dut.set_tx_retransmit_en(false);
+  }
+};
+
+struct ErrorGen {
+  bool crc_error;
+  bool stuff_error;
+  bool form_error;
+  unsigned int form_error_pos;  // 0: SRR, 1: CRC delim, 2: ACK delim, 3-8: EOF bit 0-5
+};
+
+struct BfmTxStatus {
+  bool arb_lost = false;
+  bool bit_error = false;
+  bool ack_received = false;
+  size_t eof_start = 0;         // Index in Bench::bus_bits of first EOF bit
+  size_t end = 0;               // Index in Bench::bus_bits after the last bit driven
+};
+
+// CRC as described in the CAN 2.0B specification, section 3.1.1
+static uint16_t bfm_crc(const std::vector<bool>& bits)
+{
+  uint16_t crc_rg = 0;
+  for(bool next_bit : bits) {
+    bool crc_nxt = next_bit ^ ((crc_rg >> 14) & 1);
+    crc_rg = (crc_rg << 1) & 0x7FFF;
+    if(crc_nxt)
+      crc_rg ^= 0x4599;
+  }
+  return crc_rg;
+}
+
+static void push_bits(std::vector<bool>& bits, uint32_t value, unsigned int length)
+{
+  for(int i = length-1; i >= 0; i--)
+    bits.push_back((value >> i) & 1);
+}
+
+// Bits from SOF to the end of the arbitration field, and from SOF to the last CRC bit
+static std::vector<bool> bfm_frame_bits(const CanMsg& msg, bool crc_error, size_t& arb_end)
+{
+  std::vector<bool> bits;
+
+  push_bits(bits, 0, 1);
+  push_bits(bits, msg.arb_id_a, 11);
+  if(msg.ext_id) {
+    push_bits(bits, 1, 1);                // SRR
+    push_bits(bits, 1, 1);                // IDE
+    push_bits(bits, msg.arb_id_b, 18);
+    push_bits(bits, msg.remote_frame, 1);
+    arb_end = bits.size();
+    push_bits(bits, 0, 2);                // R1, R0
+  } else {
+    push_bits(bits, msg.remote_frame, 1);
+    arb_end = bits.size();
+    push_bits(bits, 0, 2);                // IDE, R0
+  }
+  push_bits(bits, msg.data_length, 4);
+
+  if(!msg.remote_frame) {
+    for(unsigned int i = 0; i < msg.data_length && i < 8; i++)
+      push_bits(bits, msg.payload[i], 8);
+  }
+
+  uint16_t crc = bfm_crc(bits);
+  if(crc_error)
+    crc = ~crc & 0x7FFF;
+  push_bits(bits, crc, 15);
+
+  return bits;
+}
+
+struct StuffedBit {
+  bool value;
+  bool stuff;
+  size_t index;                 // Index in unstuffed bits
+};
+
+static std::vector<StuffedBit> bfm_stuff(const std::vector<bool>& bits)
+{
+  std::vector<StuffedBit> stuffed;
+  unsigned int run = 0;
+  bool prev = true;
+
+  for(size_t i = 0; i < bits.size(); i++) {
+    run = (i > 0 && bits[i] == prev) ? run + 1 : 1;
+    stuffed.push_back(StuffedBit{bits[i], false, i});
+    prev = bits[i];
+
+    if(run == 5) {
+      stuffed.push_back(StuffedBit{!prev, true, i});
+      prev = !prev;
+      run = 1;
+    }
+  }
+
+  return stuffed;
+}
+
+/**
+ * Send a message from the BFM, starting on the next bit. Stops driving the bus
+ * after arbitration loss, a bit error or an injected stuff or form error.
+ */
+static BfmTxStatus bfm_write(Bench& bench, const CanMsg& msg, const ErrorGen& error_gen)
+{
+  BfmTxStatus status;
+  size_t arb_end;
+  std::vector<bool> bits = bfm_frame_bits(msg, error_gen.crc_error, arb_end);
+
+  if(error_gen.form_error && error_gen.form_error_pos == 0 && msg.ext_id)
+    bits[12] = false;           // SRR
+
+  std::vector<StuffedBit> stuffed = bfm_stuff(bits);
+  bool stuff_error_done = false;
+  bool form_error_srr = error_gen.form_error && error_gen.form_error_pos == 0 && msg.ext_id;
+
+  for(const StuffedBit& sbit : stuffed) {
+    bool value = sbit.value;
+
+    if(sbit.stuff && error_gen.stuff_error && !stuff_error_done) {
+      value = !value;           // Same value as the bits before it
+      stuff_error_done = true;
+    }
+
+    bool bus_bit = bench.step(value);
+
+    if(bus_bit != value) {
+      if(!sbit.stuff && sbit.index > 0 && sbit.index < arb_end)
+        status.arb_lost = true;
+      else
+        status.bit_error = true;
+      status.end = bench.bus_bits.size();
+      return status;
+    }
+
+    if(stuff_error_done || (form_error_srr && sbit.index == 12)) {
+      status.end = bench.bus_bits.size();
+      return status;
+    }
+  }
+
+  // CRC delimiter, ACK slot, ACK delimiter and EOF.
+  // Bit 0 is the CRC delimiter, bit 1 the ACK slot, bit 2 the ACK delimiter,
+  // and bits 3 to 9 EOF. Form error position 1 maps to bit 0, 2 to bit 2,
+  // and 3-8 to EOF bit 0-5.
+  unsigned int form_error_bit = 3+EOF_LENGTH;  // None
+  if(error_gen.form_error && error_gen.form_error_pos == 1)
+    form_error_bit = 0;
+  else if(error_gen.form_error && error_gen.form_error_pos == 2)
+    form_error_bit = 2;
+  else if(error_gen.form_error && error_gen.form_error_pos >= 3)
+    form_error_bit = error_gen.form_error_pos;
+
+  for(unsigned int pos = 0; pos < 3+EOF_LENGTH; pos++) {
+    bool value = pos != form_error_bit;
+
+    if(pos == 3)
+      status.eof_start = bench.bus_bits.size();
+
+    bool bus_bit = bench.step(value);
+
+    if(pos == 1) {
+      status.ack_received = !bus_bit;
+    } else if(value != bus_bit) {
+      status.bit_error = true;
+      status.end = bench.bus_bits.size();
+      return status;
+    }
+
+    if(pos == form_error_bit)
+      break;
+  }
+
+  status.end = bench.bus_bits.size();
+  return status;
+}
+
+/**
+ * Receive a message with the BFM and acknowledge it
+ */
+static bool bfm_read(Bench& bench, CanMsg& msg, unsigned int timeout)
+{
+  unsigned int wait = 0;
+  while(bench.step()) {
+    if(++wait > timeout)
+      return false;
+  }
+
+  std::vector<bool> bits;
+  bits.push_back(false);
+  unsigned int run = 1;
+  bool prev = false;
+
+  // Reads the next bit that is not a stuff bit
+  auto read_bit = [&](bool& ok) {
+    bool bit = bench.step();
+    if(run == 5) {
+      if(bit == prev)
+        ok = false;             // Stuff error
+      run = 1;
+      prev = bit;
+      bit = bench.step();
+    }
+    run = (bit == prev) ? run + 1 : 1;
+    prev = bit;
+    bits.push_back(bit);
+    return bit;
+  };
+
+  auto read_field = [&](unsigned int length, bool& ok) {
+    uint32_t value = 0;
+    for(unsigned int i = 0; i < length; i++)
+      value = (value << 1) | read_bit(ok);
+    return value;
+  };
+
+  bool ok = true;
+  msg = CanMsg{};
+  msg.arb_id_a = read_field(11, ok);
+  bool srr_rtr = read_field(1, ok);
+  msg.ext_id = read_field(1, ok);
+
+  if(msg.ext_id) {
+    msg.arb_id_b = read_field(18, ok);
+    msg.remote_frame = read_field(1, ok);
+    read_field(2, ok);
+  } else {
+    msg.remote_frame = srr_rtr;
+    read_field(1, ok);
+  }
+
+  msg.data_length = read_field(4, ok);
+
+  if(!msg.remote_frame) {
+    for(unsigned int i = 0; i < msg.data_length && i < 8; i++)
+      msg.payload[i] = read_field(8, ok);
+  }
+
+  const uint16_t crc_calc = bfm_crc(bits);
+  const uint16_t crc = read_field(15, ok);
+
+  // Stuff bit after the last CRC bit
+  if(run == 5 && bench.step() == prev)
+    ok = false;
+
+  ok = ok && crc == crc_calc;
+
+  ok = bench.step() && ok;      // CRC delimiter
+  bench.step(!ok);              // ACK slot
+  ok = bench.step() && ok;      // ACK delimiter
+
+  for(unsigned int i = 0; i < EOF_LENGTH; i++)
+    ok = bench.step() && ok;
+
+  return ok;
+}
+
+// Wait for 6 dominant bits in a row, starting within timeout bits
+static bool bfm_recv_active_error_flag(Bench& bench, unsigned int timeout)
+{
+  unsigned int run = 0;
+  for(unsigned int i = 0; i < timeout + ERROR_FLAG_LENGTH; i++) {
+    run = bench.step() ? 0 : run + 1;
+    if(run == ERROR_FLAG_LENGTH)
+      return true;
+  }
+  return false;
+}
+
+static bool bfm_recv_passive_error_flag(Bench& bench)
+{
+  for(unsigned int i = 0; i < ERROR_FLAG_LENGTH; i++) {
+    if(!bench.step())
+      return false;
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+// Tests from canola_top_tb.vhd
+//-----------------------------------------------------------------------------
+static void test_bfm_to_dut(Bench& bench, MsgGenerator& gen, unsigned int test_num, bool ext_id)
+{
+  CanMsg msg = gen.random_msg(ext_id);
+  uint32_t rx_count = bench.dut.counter(Counter::RX_MSG_RECV);
+
+  bench.events = 0;
+  BfmTxStatus status = bfm_write(bench, msg, ErrorGen{});
+  bench.idle(IFS_LENGTH + 1);
+
+  check(status.ack_received, test_num, "BFM did not receive ACK");
+  check(bench.events & EVENT_RX_MSG_VALID, test_num, "Message not received");
+  check(msg_equal(bench.dut.rx_msg(), msg), test_num, "Received message differs");
+  check(bench.dut.counter(Counter::RX_MSG_RECV) == rx_count + 1, test_num, "Rx message count");
+}
+
+static void test_dut_to_bfm(Bench& bench, MsgGenerator& gen, unsigned int test_num, bool ext_id)
+{
+  CanMsg msg = gen.random_msg(ext_id);
+  CanMsg bfm_msg;
+  uint32_t tx_count = bench.dut.counter(Counter::TX_MSG_SENT);
+
+  bench.dut.start_tx(msg);
+  check(bfm_read(bench, bfm_msg, 10), test_num, "BFM did not receive message");
+  check(msg_equal(bfm_msg, msg), test_num, "Message received by BFM differs");
+  bench.idle(IFS_LENGTH + 1);
+
+  check(!bench.dut.tx_busy(), test_num, "Still busy");
+  check(bench.dut.counter(Counter::TX_MSG_SENT) == tx_count + 1, test_num, "Tx message sent count");
+  check(bench.dut.counter(Counter::TX_ACK_ERROR) == 0, test_num, "Tx ACK error count");
+}
+
+// Arbitration loss, the BFM message has higher priority (lower ID)
+static void test_arb_loss(Bench& bench, MsgGenerator& gen, bool retransmit_en)
+{
+  const unsigned int test_num = 5;
+  bool ext_id = gen() % 2;
+  CanMsg dut_msg = gen.random_msg(ext_id);
+  CanMsg bfm_msg = gen.random_msg(ext_id);
+
+  if(msg_id(dut_msg) == 0)
+    set_msg_id(dut_msg, 1);
+  set_msg_id(bfm_msg, msg_id(dut_msg) - 1);
+
+  uint32_t arb_lost = bench.dut.counter(Counter::TX_ARB_LOST);
+  uint32_t rx_count = bench.dut.counter(Counter::RX_MSG_RECV);
+  uint32_t retransmit_count = bench.dut.counter(Counter::TX_RETRANSMIT);
+
+  bench.dut.set_tx_retransmit_en(retransmit_en);
+  bench.dut.start_tx(dut_msg);
+  BfmTxStatus status = bfm_write(bench, bfm_msg, ErrorGen{});
+
+  check(!status.arb_lost && !status.bit_error, test_num, "BFM lost arbitration");
+  check(status.ack_received, test_num, "BFM did not receive ACK");
+  check(bench.dut.counter(Counter::TX_ARB_LOST) == arb_lost + 1, test_num, "Arbitration lost count");
+  check(bench.dut.counter(Counter::RX_MSG_RECV) == rx_count + 1, test_num, "Rx message count");
+  check(msg_equal(bench.dut.rx_msg(), bfm_msg), test_num, "Received message differs");
+
+  if(retransmit_en) {
+    CanMsg msg;
+    check(bfm_read(bench, msg, 10), test_num, "BFM did not receive retransmitted message");
+    check(msg_equal(msg, dut_msg), test_num, "Retransmitted message differs");
+    check(bench.dut.counter(Counter::TX_RETRANSMIT) == retransmit_count + 1, test_num,
+          "Retransmit count");
+  }
+
+  bench.idle(IFS_LENGTH + 1);
+  check(!bench.dut.tx_busy(), test_num, "Still busy");
+  bench.dut.set_tx_retransmit_en(false);
+}
+
+// The DUT wins arbitration, and gets no ACK since the BFM lost
+static void test_arb_win(Bench& bench, MsgGenerator& gen)
+{
+  const unsigned int test_num = 6;
+  bool ext_id = gen() % 2;
+  CanMsg dut_msg = gen.random_msg(ext_id);
+  CanMsg bfm_msg = gen.random_msg(ext_id);
+
+  if(msg_id(bfm_msg) == 0)
+    set_msg_id(bfm_msg, 1);
+  set_msg_id(dut_msg, msg_id(bfm_msg) - 1);
+
+  uint32_t arb_lost = bench.dut.counter(Counter::TX_ARB_LOST);
+  uint32_t ack_error = bench.dut.counter(Counter::TX_ACK_ERROR);
+
+  bench.dut.start_tx(dut_msg);
+  BfmTxStatus status = bfm_write(bench, bfm_msg, ErrorGen{});
+
+  check(status.arb_lost, test_num, "BFM did not lose arbitration");
+  check(bfm_recv_active_error_flag(bench, 200), test_num, "No active error flag");
+  bench.idle(IFS_LENGTH + 1);
+
+  check(bench.dut.counter(Counter::TX_ACK_ERROR) == ack_error + 1, test_num, "ACK error count");
+  check(bench.dut.counter(Counter::TX_ARB_LOST) == arb_lost, test_num, "Arbitration lost count");
+  check(!bench.dut.tx_busy(), test_num, "Still busy");
+}
+
+static void test_rx_error(Bench& bench, MsgGenerator& gen, unsigned int test_num,
+                          const ErrorGen& error_gen)
+{
+  CanMsg msg = gen.random_msg(gen() % 2);
+
+  if(error_gen.stuff_error) {
+    // Make sure the message has a stuff bit
+    msg.remote_frame = false;
+    if(msg.data_length == 0)
+      msg.data_length = 1;
+    msg.payload[0] = 0xFF;
+  }
+
+  ErrorGen gen_error = error_gen;
+  if(gen_error.form_error) {
+    size_t arb_end;
+    std::vector<bool> bits = bfm_frame_bits(msg, false, arb_end);
+    bool crc_last_zeros = !bits[bits.size()-1] && !bits[bits.size()-2] &&
+      !bits[bits.size()-3] && !bits[bits.size()-4];
+
+    do {
+      gen_error.form_error_pos = gen() % 9;
+    } while((gen_error.form_error_pos == 0 && !msg.ext_id) ||
+            (gen_error.form_error_pos == 1 && crc_last_zeros));
+  }
+
+  const bool error_active = bench.dut.error_state() == ErrorState::ERROR_ACTIVE;
+  uint32_t rx_count = bench.dut.counter(Counter::RX_MSG_RECV);
+  uint32_t crc_errors = bench.dut.counter(Counter::RX_CRC_ERROR);
+  uint32_t form_errors = bench.dut.counter(Counter::RX_FORM_ERROR);
+  uint32_t stuff_errors = bench.dut.counter(Counter::RX_STUFF_ERROR);
+  unsigned int rec = bench.dut.receive_error_count();
+
+  BfmTxStatus status = bfm_write(bench, msg, gen_error);
+
+  if(error_gen.crc_error && error_active) {
+    // Error flag after the ACK delimiter
+    const size_t flag_start = status.eof_start;
+    bench.idle(flag_start + ERROR_FLAG_LENGTH > bench.bus_bits.size() ?
+               flag_start + ERROR_FLAG_LENGTH - bench.bus_bits.size() : 0);
+    bool flag = true;
+    for(size_t i = flag_start; i < flag_start + ERROR_FLAG_LENGTH; i++)
+      flag = flag && !bench.bus_bits[i];
+    check(flag, test_num, "No active error flag after ACK delimiter");
+    check(!status.ack_received, test_num, "ACK received for message with CRC error");
+  } else if(error_active) {
+    check(bfm_recv_active_error_flag(bench, 20), test_num, "No active error flag");
+  }
+
+  bench.idle(20);
+
+  check(bench.dut.receive_error_count() == std::min(rec + 1, ERROR_COUNT_MAX), test_num,
+        "Receive error count");
+  check(bench.dut.counter(Counter::RX_MSG_RECV) == rx_count, test_num, "Rx message count");
+  check(bench.dut.counter(Counter::RX_CRC_ERROR) == crc_errors + error_gen.crc_error,
+        test_num, "CRC error count");
+  check(bench.dut.counter(Counter::RX_STUFF_ERROR) == stuff_errors + error_gen.stuff_error,
+        test_num, "Stuff error count");
+  check(bench.dut.counter(Counter::RX_FORM_ERROR) == form_errors + error_gen.form_error,
+        test_num, "Form error count");
+}
+
+// Test #10: ERROR ACTIVE -> PASSIVE on missing ACKs, and back after successful transmits
+static void test_ack_errors(Bench& bench, MsgGenerator& gen)
+{
+  const unsigned int test_num = 10;
+  bench.reset_dut();
+
+  for(unsigned int n = 0; n < 2*BUS_OFF_THRESHOLD/8; n++) {
+    uint32_t ack_error = bench.dut.counter(Counter::TX_ACK_ERROR);
+    uint32_t tx_count = bench.dut.counter(Counter::TX_MSG_SENT);
+    bool error_active = bench.dut.error_state() == ErrorState::ERROR_ACTIVE;
+
+    bench.dut.start_tx(gen.random_msg(true));
+
+    if(error_active)
+      check(bfm_recv_active_error_flag(bench, 200), test_num, "No active error flag");
+
+    for(unsigned int i = 0; i < 200 && bench.dut.tx_busy(); i++)
+      bench.step();
+
+    check(!bench.dut.tx_busy(), test_num, "Still busy");
+    check(bench.dut.counter(Counter::TX_MSG_SENT) == tx_count, test_num, "Tx message sent count");
+    check(bench.dut.counter(Counter::TX_ACK_ERROR) == ack_error + 1, test_num, "ACK error count");
+
+    const unsigned int tec = bench.dut.transmit_error_count();
+    if(tec < ERROR_PASSIVE_THRESHOLD) {
+      check(tec == (n+1)*8, test_num, "Transmit error count increase");
+      check(bench.dut.error_state() == ErrorState::ERROR_ACTIVE, test_num, "Not error active");
+    } else {
+      check(tec == ERROR_PASSIVE_THRESHOLD, test_num, "Transmit error count error passive");
+      check(bench.dut.error_state() == ErrorState::ERROR_PASSIVE, test_num, "Not error passive");
+    }
+
+    bench.idle(9);
+  }
+
+  for(unsigned int n = 0; n < ERROR_PASSIVE_THRESHOLD; n++) {
+    CanMsg msg = gen.random_msg(true);
+    CanMsg bfm_msg;
+    uint32_t tx_count = bench.dut.counter(Counter::TX_MSG_SENT);
+
+    bench.dut.start_tx(msg);
+    check(bfm_read(bench, bfm_msg, 200) && msg_equal(bfm_msg, msg), test_num,
+          "BFM did not receive message");
+    bench.idle(2);
+
+    check(bench.dut.counter(Counter::TX_MSG_SENT) == tx_count + 1, test_num, "Tx message sent count");
+    check(bench.dut.transmit_error_count() == ERROR_PASSIVE_THRESHOLD-(n+1), test_num,
+          "Transmit error count decrease");
+    check(bench.dut.error_state() == ErrorState::ERROR_ACTIVE, test_num, "Not error active");
+  }
+}
+
+// Test #12: BUS OFF after too many Tx bit errors, and back to ERROR ACTIVE
+static void test_bus_off(Bench& bench, MsgGenerator& gen)
+{
+  const unsigned int test_num = 12;
+  bench.reset_dut();
+
+  for(unsigned int n = 0; bench.dut.error_state() != ErrorState::BUS_OFF && n < 100; n++) {
+    uint32_t arb_lost = bench.dut.counter(Counter::TX_ARB_LOST);
+    uint32_t tx_count = bench.dut.counter(Counter::TX_MSG_SENT);
+    uint32_t ack_error = bench.dut.counter(Counter::TX_ACK_ERROR);
+    uint32_t bit_error = bench.dut.counter(Counter::TX_BIT_ERROR);
+
+    bench.dut.start_tx(gen.random_msg(true));
+
+    // Wait till after the (extended) arbitration field, and a random number of bits
+    for(unsigned int i = 0; i < 50 && bench.dut.frame_tx_state() != FrameTxState::ST_SEND_EXT_RTR; i++)
+      bench.step();
+    bench.idle(gen() % 9);
+
+    // Overwrite a recessive bit from the controller with a dominant bit
+    while(!bench.dut.tx_bit())
+      bench.step();
+    const ErrorState error_state = bench.dut.error_state();
+    bench.step(false);
+
+    if(error_state == ErrorState::ERROR_ACTIVE)
+      check(bfm_recv_active_error_flag(bench, 0), test_num, "No active error flag");
+    else
+      check(bfm_recv_passive_error_flag(bench), test_num, "No passive error flag");
+
+    for(unsigned int i = 0; i < IFS_LENGTH+1 && bench.dut.tx_busy(); i++)
+      bench.step();
+
+    check(!bench.dut.tx_busy(), test_num, "Still busy");
+    check(bench.dut.counter(Counter::TX_ARB_LOST) == arb_lost, test_num, "Arbitration lost count");
+    check(bench.dut.counter(Counter::TX_MSG_SENT) == tx_count, test_num, "Tx message sent count");
+    check(bench.dut.counter(Counter::TX_ACK_ERROR) == ack_error, test_num, "ACK error count");
+    check(bench.dut.counter(Counter::TX_BIT_ERROR) == bit_error + 1, test_num, "Tx bit error count");
+    check(bench.dut.transmit_error_count() == (n+1)*8, test_num, "Transmit error count increase");
+
+    const unsigned int tec = bench.dut.transmit_error_count();
+    const ErrorState exp_state = tec >= BUS_OFF_THRESHOLD ? ErrorState::BUS_OFF :
+      tec >= ERROR_PASSIVE_THRESHOLD ? ErrorState::ERROR_PASSIVE : ErrorState::ERROR_ACTIVE;
+    check(bench.dut.error_state() == exp_state, test_num, "Error state");
+  }
+
+  check(bench.dut.error_state() == ErrorState::BUS_OFF, test_num, "Not bus off");
+
+  // No transmit in BUS OFF
+  bench.idle(6);
+  check(!bench.dut.start_tx(gen.random_msg(false)), test_num, "Tx started in bus off");
+  for(unsigned int i = 0; i < 200; i++)
+    check(bench.step(), test_num, "Dominant bit transmitted in bus off");
+
+  // 128 occurrences of 11 recessive bits brings the controller out of BUS OFF
+  unsigned int count = bench.dut.recessive_bits_count();
+  unsigned int bits = 0;
+  while(bench.dut.error_state() == ErrorState::BUS_OFF && bits < 11*RECESSIVE_11_EXIT_BUS_OFF_THRESHOLD) {
+    bench.idle(11);
+    bits += 11;
+    if(bench.dut.error_state() == ErrorState::BUS_OFF) {
+      check(bench.dut.recessive_bits_count() == count + 1, test_num,
+            "Count of 11 recessive bits increase");
+      count = bench.dut.recessive_bits_count();
+    }
+  }
+
+  check(bench.dut.recessive_bits_count() == 0, test_num, "Count of 11 recessive bits not zero");
+  check(bench.dut.error_state() == ErrorState::ERROR_ACTIVE, test_num, "Not error active");
+}
+
+// Test #13: ERROR PASSIVE/ACTIVE states when receiving
+static void test_rx_error_passive(Bench& bench, MsgGenerator& gen)
+{
+  const unsigned int test_num = 13;
+  bench.reset_dut();
+
+  for(unsigned int n = 0; bench.dut.receive_error_count() < BUS_OFF_THRESHOLD && n < 1000; n++) {
+    ErrorGen error_gen = ErrorGen{};
+    error_gen.crc_error = n % 3 == 0;
+    error_gen.stuff_error = n % 3 == 1;
+    error_gen.form_error = n % 3 == 2;
+
+    test_rx_error(bench, gen, test_num, error_gen);
+
+    const ErrorState exp_state = bench.dut.receive_error_count() >= ERROR_PASSIVE_THRESHOLD ?
+      ErrorState::ERROR_PASSIVE : ErrorState::ERROR_ACTIVE;
+    check(bench.dut.error_state() == exp_state, test_num, "Error state");
+  }
+
+  check(bench.dut.receive_error_count() == BUS_OFF_THRESHOLD, test_num,
+        "Receive error count not at bus off threshold");
+  check(bench.dut.error_state() == ErrorState::ERROR_PASSIVE, test_num,
+        "Receive errors should not cause bus off");
+}
+
+// Test #14: Multiple controllers
+static void test_multiple_nodes(MsgGenerator& gen, unsigned int iterations)
+{
+  const unsigned int test_num = 14;
+  Node nodes[3];
+  Bus bus;
+
+  for(Node& node : nodes)
+    bus.attach(node);
+
+  for(unsigned int n = 0; n < iterations; n++) {
+    for(unsigned int tx = 0; tx < 3; tx++) {
+      CanMsg msg = gen.random_msg(gen() % 2);
+      uint32_t received = 0;
+
+      nodes[tx].start_tx(msg);
+
+      for(unsigned int i = 0; i < 200 + 10 && (nodes[tx].tx_busy() || i < 10); i++) {
+        bus.step();
+        for(unsigned int j = 0; j < 3; j++) {
+          if(nodes[j].events() & EVENT_RX_MSG_VALID)
+            received |= 1 << j;
+        }
+      }
+
+      for(unsigned int rx = 0; rx < 3; rx++) {
+        if(rx != tx) {
+          check(received & (1 << rx), test_num, "Message not received");
+          check(msg_equal(nodes[rx].rx_msg(), msg), test_num, "Received message differs");
+        }
+      }
+    }
+  }
+}
+
+static int run_check(unsigned int iterations, uint32_t seed)
+{
+  MsgGenerator gen(seed);
+  Bench bench;
+  bench.reset_dut();
+  bench.idle(20);
+
+  auto reset_if_not_active = [&]() {
+    if(bench.dut.error_state() != ErrorState::ERROR_ACTIVE)
+      bench.reset_dut();
+  };
+
+  printf("Test #1: Basic ID msg from BFM to Canola CAN controller\n");
+  for(unsigned int i = 0; i < iterations; i++)
+    test_bfm_to_dut(bench, gen, 1, false);
+
+  printf("Test #2: Basic ID msg from Canola CAN controller to BFM\n");
+  for(unsigned int i = 0; i < iterations; i++)
+    test_dut_to_bfm(bench, gen, 2, false);
+
+  printf("Test #3: Extended ID msg from BFM to Canola CAN controller\n");
+  for(unsigned int i = 0; i < iterations; i++)
+    test_bfm_to_dut(bench, gen, 3, true);
+
+  printf("Test #4: Extended ID msg from Canola CAN controller to BFM\n");
+  for(unsigned int i = 0; i < iterations; i++)
+    test_dut_to_bfm(bench, gen, 4, true);
+
+  printf("Test #5: Missing ACK and arbitration loss\n");
+  for(unsigned int i = 0; i < iterations; i++) {
+    reset_if_not_active();
+    test_arb_loss(bench, gen, i % 2);
+  }
+
+  printf("Test #6: Arbitration win, no ACK\n");
+  for(unsigned int i = 0; i < iterations; i++) {
+    reset_if_not_active();
+    test_arb_win(bench, gen);
+  }
+
+  printf("Test #7: CRC errors\n");
+  for(unsigned int i = 0; i < iterations; i++) {
+    reset_if_not_active();
+    test_rx_error(bench, gen, 7, ErrorGen{true, false, false, 0});
+  }
+
+  printf("Test #8: Stuff errors\n");
+  for(unsigned int i = 0; i < iterations; i++) {
+    reset_if_not_active();
+    test_rx_error(bench, gen, 8, ErrorGen{false, true, false, 0});
+  }
+
+  printf("Test #9: Form errors\n");
+  for(unsigned int i = 0; i < iterations; i++) {
+    reset_if_not_active();
+    test_rx_error(bench, gen, 9, ErrorGen{false, false, true, 0});
+  }
+
+  printf("Test #10: ERROR ACTIVE->PASSIVE on missing ACKs, but not BUS OFF\n");
+  test_ack_errors(bench, gen);
+
+  printf("Test #12: BUS OFF after too many Tx errors\n");
+  test_bus_off(bench, gen);
+
+  printf("Test #13: ERROR PASSIVE/ACTIVE states when receiving\n");
+  test_rx_error_passive(bench, gen);
+
+  printf("Test #14: Multiple CAN controllers\n");
+  test_multiple_nodes(gen, iterations);
+
+  printf("%u bits simulated, %s (%u errors)\n", unsigned(bench.bus.bit_count()),
+         g_errors == 0 ? "OK" : "FAILED", g_errors);
+  return g_errors == 0 ? 0 : 1;
+}
+
+//-----------------------------------------------------------------------------
+// Soak test
+//-----------------------------------------------------------------------------
+struct SoakResult {
+  uint64_t frames = 0;
+  uint64_t bits = 0;
+  unsigned int errors = 0;
+};
+
+/**
+ * Random traffic on one bus. ID A of a message identifies the node that
+ * sent it (ID A mod num_nodes), so that messages from one node are received
+ * in order, and two nodes never send the same ID A. The latter is required
+ * because the Tx FSM treats a mismatch on the SRR/RTR bit as a bit error and
+ * not as lost arbitration, so a basic and an extended frame with the same
+ * ID A would destroy each other.
+ */
+static SoakResult soak_bus(unsigned int num_nodes, uint64_t num_frames, uint32_t seed)
+{
+  MsgGenerator gen(seed);
+  std::vector<Node> nodes(num_nodes, Node(0));
+  std::vector<std::deque<CanMsg>> sent(num_nodes);
+  std::vector<std::vector<size_t>> rx_pos(num_nodes, std::vector<size_t>(num_nodes, 0));
+  std::vector<uint64_t> started(num_nodes, 0);
+  Bus bus;
+  SoakResult result;
+
+  for(Node& node : nodes) {
+    node.set_tx_retransmit_en(true);
+    bus.attach(node);
+  }
+
+  uint64_t frames_started = 0;
+
+  while(result.frames < num_frames) {
+    for(unsigned int i = 0; i < num_nodes; i++) {
+      if(!nodes[i].tx_busy() && frames_started < num_frames && gen() % 64 == 0) {
+        CanMsg msg = gen.random_msg(gen() % 2);
+        msg.arb_id_a = (msg.arb_id_a - msg.arb_id_a % num_nodes + i) % (1u << ID_A_LENGTH);
+        if(msg.arb_id_a % num_nodes != i)
+          msg.arb_id_a = i;
+
+        if(nodes[i].start_tx(msg)) {
+          sent[i].push_back(msg);
+          frames_started++;
+        }
+      }
+    }
+
+    bus.step();
+    result.bits++;
+
+    for(unsigned int rx = 0; rx < num_nodes; rx++) {
+      const uint32_t events = nodes[rx].events();
+
+      if(events & EVENT_TX_DONE)
+        result.frames++;
+
+      if(events & (EVENT_TX_FAILED | EVENT_RX_CRC_ERROR | EVENT_RX_FORM_ERROR |
+                   EVENT_RX_STUFF_ERROR | EVENT_TX_BIT_ERROR | EVENT_TX_ACK_ERROR))
+        result.errors++;
+
+      if(events & EVENT_RX_MSG_VALID) {
+        const CanMsg& msg = nodes[rx].rx_msg();
+        const unsigned int tx = msg.arb_id_a % num_nodes;
+        const size_t pos = rx_pos[rx][tx]++;
+
+        if(tx == rx || pos >= sent[tx].size() || !msg_equal(msg, sent[tx][pos]))
+          result.errors++;
+      }
+    }
+  }
+
+  // Let the last message be received
+  for(unsigned int i = 0; i < 20; i++)
+    bus.step();
+
+  for(unsigned int rx = 0; rx < num_nodes; rx++) {
+    for(unsigned int tx = 0; tx < num_nodes; tx++) {
+      if(tx != rx && rx_pos[rx][tx] != sent[tx].size())
+        result.errors++;
+    }
+    if(nodes[rx].transmit_error_count() != 0 || nodes[rx].receive_error_count() != 0)
+      result.errors++;
+  }
+
+  return result;
+}
+
+static int run_soak(unsigned int num_nodes, uint64_t num_frames, unsigned int num_threads)
+{
+  std::vector<SoakResult> results(num_threads);
+  std::vector<std::thread> threads;
+
+  auto start = std::chrono::steady_clock::now();
+
+  for(unsigned int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t]() {
+      results[t] = soak_bus(num_nodes, num_frames / num_threads, t + 1);
+    });
+  }
+
+  for(std::thread& thread : threads)
+    thread.join();
+
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  SoakResult total;
+  for(const SoakResult& result : results) {
+    total.frames += result.frames;
+    total.bits += result.bits;
+    total.errors += result.errors;
+  }
+
+  printf("%u nodes, %u buses: %llu frames, %llu bits in %.2f s, %.0f frames/s, %.1f Mbit/s\n",
+         num_nodes, num_threads, (unsigned long long)total.frames, (unsigned long long)total.bits,
+         seconds, total.frames / seconds, total.bits / seconds / 1e6);
+  printf("%s (%u errors)\n", total.errors == 0 ? "OK" : "FAILED", total.errors);
+
+  return total.errors == 0 ? 0 : 1;
+}
+
+//-----------------------------------------------------------------------------
+// Trace
+//-----------------------------------------------------------------------------
+static int run_trace(uint32_t seed)
+{
+  MsgGenerator gen(seed);
+  Node nodes[2];
+  Bus bus;
+
+  bus.attach(nodes[0]);
+  bus.attach(nodes[1]);
+  bus.step();
+
+  nodes[0].start_tx(gen.random_msg(gen() % 2));
+
+  printf("%5s %3s  %-22s %-22s %-21s %-18s\n", "bit", "bus",
+         "tx fsm (node 0)", "bsp tx (node 0)", "rx fsm (node 1)", "bsp rx (node 1)");
+
+  for(unsigned int i = 0; i < 200 && (nodes[0].tx_busy() || i < 12); i++) {
+    bool bit = bus.step();
+    printf("%5u %3u  %-22s %-22s %-21s %-18s\n", i, bit,
+           state_name(nodes[0].frame_tx_state()), state_name(nodes[0].bsp_tx_state()),
+           state_name(nodes[1].frame_rx_state()), state_name(nodes[1].bsp_rx_state()));
+  }
+
+  return 0;
+}
+
+int main(int argc, char* argv[])
+{
+  const char* mode = argc > 1 ? argv[1] : "check";
+
+  if(strcmp(mode, "check") == 0) {
+    unsigned int iterations = argc > 2 ? atoi(argv[2]) : 100;
+    uint32_t seed = argc > 3 ? atoi(argv[3]) : 1;
+    return run_check(iterations, seed);
+  } else if(strcmp(mode, "soak") == 0) {
+    unsigned int num_nodes = argc > 2 ? atoi(argv[2]) : 4;
+    uint64_t num_frames = argc > 3 ? atoll(argv[3]) : 1000000;
+    unsigned int num_threads = argc > 4 ? atoi(argv[4]) : std::thread::hardware_concurrency();
+    if(num_nodes < 2 || num_threads == 0) {
+      printf("At least 2 nodes and 1 thread\n");
+      return 1;
+    }
+    return run_soak(num_nodes, num_frames, num_threads);
+  } else if(strcmp(mode, "trace") == 0) {
+    return run_trace(argc > 2 ? atoi(argv[2]) : 1);
+  }
+
+  printf("Usage: %s check [iterations] [seed]\n"
+         "       %s soak [nodes] [frames] [threads]\n"
+         "       %s trace [seed]\n", argv[0], argv[0], argv[0]);
+  return 1;
+}
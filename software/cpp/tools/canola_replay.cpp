@@ -0,0 +1,436 @@
+/**
+ * @file   canola_replay.cpp
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Replay of frame traces into Canola controllers, see
+ *         canola_replay.hpp.
+ *
+ *         check:  Records random traffic of simulated controllers on one
+ *                 bus (canola_sim.hpp), replays the trace into controllers
+ *                 on a second bus, and checks that a listener there
+ *                 receives the same frames with the same timing, at the
+ *                 original and a scaled speed, and in order as fast as
+ *                 possible.
+ *         bench [frames=10000] [interval_us=100]:
+ *                 Drift from the schedule with the host clock, with frames
+ *                 sent to registers in memory, for sleeping only and for
+ *                 the hybrid spin/sleep wait.
+ *         replay <file> original|asap|<scale> <uio device>...:
+ *                 Replays a trace with controllers opened through UIO (e.g.
+ *                 /dev/uio0). Recorded controller n is replayed by device n.
+ *
+ *         Build: g++ -std=c++14 -O2 -march=native -pthread -I.. canola_replay.cpp -o canola_replay
+ */
+
+#include "canola_replay.hpp"
+#include "canola_sim.hpp"
+#include "canola_uio.hpp"
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace canola;
+
+static unsigned int g_errors = 0;
+
+static void check(bool ok, const char* what, uint64_t index)
+{
+  if(!ok) {
+    if(g_errors < 10)
+      printf("%s (%llu)\n", what, (unsigned long long)index);
+    g_errors++;
+  }
+}
+
+static void print_drift(const char* name, const replay::DriftStats& drift)
+{
+  printf("  %-22s %8llu %9.2f %9.2f %9.2f %9.2f %9.2f\n", name,
+         (unsigned long long)drift.count(), 1e-3 * drift.min(), 1e-3 * drift.percentile(50.0),
+         1e-3 * drift.percentile(99.0), 1e-3 * drift.percentile(99.9), 1e-3 * drift.max());
+}
+
+static void print_drift_header()
+{
+  printf("Drift (us):\n  %-22s %8s %9s %9s %9s %9s %9s\n", "", "Count", "Min", "p50", "p99",
+         "p99.9", "Max");
+}
+
+//-----------------------------------------------------------------------------
+// Check
+//-----------------------------------------------------------------------------
+
+/**
+ * Time of a simulated bus. Sleeping and spinning run the bus.
+ */
+class SimClock
+{
+public:
+  explicit SimClock(sim::Bus* bus = nullptr) : m_bus(bus) {}
+
+  uint64_t now() const { return uint64_t(m_bus->bit_count() * (1e9 / m_bus->bit_rate()) + 0.5); }
+
+  void sleep_until(uint64_t time_ns)
+  {
+    while(now() < time_ns)
+      m_bus->step();
+  }
+
+  void spin() { m_bus->step(); }
+
+private:
+  sim::Bus* m_bus;
+};
+
+static CanMsg random_msg(std::mt19937& rng)
+{
+  CanMsg msg = CanMsg{};
+
+  msg.arb_id_a = rng() % 2048;
+  msg.arb_id_b = rng() % 262144;
+  msg.ext_id = rng() % 2;
+  msg.remote_frame = rng() % 2;
+  msg.data_length = rng() % 9;
+
+  for(unsigned int i = 0; i < msg.data_length; i++)
+    msg.payload[i] = msg.remote_frame ? 0 : rng() % 256;
+
+  return msg;
+}
+
+static uint64_t bus_ns(const sim::Bus& bus)
+{
+  return uint64_t(bus.bit_count() * (1e9 / bus.bit_rate()) + 0.5);
+}
+
+// Four controllers send random messages with random gaps, longer than a
+// frame. The interrupt handlers record what is sent and received.
+static void record_bus(const std::string& path, unsigned int num_msgs)
+{
+  constexpr unsigned int NUM_CONTROLLERS = 4;
+
+  std::mt19937 rng(1);
+  sim::Bus bus;
+  std::vector<Canola<sim::SimIO>> drivers;
+  std::vector<CanMsg> pending(NUM_CONTROLLERS);
+  trace::TraceWriter writer;
+
+  check(writer.create(path, num_msgs * NUM_CONTROLLERS), "Create", 0);
+
+  for(unsigned int i = 0; i < NUM_CONTROLLERS; i++) {
+    drivers.emplace_back(bus.io(bus.add()));
+    drivers[i].init();
+    drivers[i].set_rx_timestamp_enable(true);
+
+    bus.set_irq_handler(i, [&, i](uint32_t irqs) {
+      if(irqs & sim::IRQ_RX_VALID)
+        writer.rx(i, drivers[i].get_msg(), bus_ns(bus));
+      if(irqs & sim::IRQ_TX_DONE)
+        writer.tx(i, pending[i], drivers[i].tx_timestamp(), bus_ns(bus));
+    });
+  }
+
+  bus.run(20);
+
+  for(unsigned int n = 0; n < num_msgs; n++) {
+    const unsigned int tx = rng() % NUM_CONTROLLERS;
+    bus.run(200 + rng() % 400);
+
+    pending[tx] = random_msg(rng);
+    drivers[tx].send_msg(pending[tx]);
+  }
+  bus.run(200);
+}
+
+struct Received {
+  CanMsg msg;
+  uint64_t time_ns;
+};
+
+// Replay the Tx records of the trace into four controllers on a new bus,
+// with a fifth controller that only listens
+template <typename Setup>
+static std::vector<Received> replay_bus(const trace::TraceReader& reader, Setup&& setup,
+                                        replay::DriftStats* drift = nullptr)
+{
+  constexpr unsigned int NUM_CONTROLLERS = 4;
+
+  sim::Bus bus;
+  std::vector<Canola<sim::SimIO>> drivers;
+  std::vector<Received> received;
+
+  for(unsigned int i = 0; i <= NUM_CONTROLLERS; i++) {
+    drivers.emplace_back(bus.io(bus.add()));
+    drivers[i].init();
+  }
+
+  bus.set_irq_handler(NUM_CONTROLLERS, [&](uint32_t irqs) {
+    if(irqs & sim::IRQ_RX_VALID)
+      received.push_back(Received{drivers[NUM_CONTROLLERS].get_msg(), bus_ns(bus)});
+  });
+
+  bus.run(20);
+
+  replay::Options options;
+  options.replay_rx = false;
+  setup(options);
+
+  replay::Replayer<sim::SimIO, SimClock> replayer(options, SimClock(&bus));
+  for(unsigned int i = 0; i < NUM_CONTROLLERS; i++)
+    replayer.map(i, drivers[i]);
+
+  const uint64_t sent = replayer.run(reader);
+  check(sent + replayer.skipped() == reader.count(), "Sent and skipped", sent);
+  bus.run(200);
+
+  if(drift != nullptr)
+    *drift = replayer.drift();
+  return received;
+}
+
+// The frames must be received in the order of the Tx records, and at the
+// recorded times (from the start of frame), scaled, to within a bit
+static void check_timed(const trace::TraceReader& reader, double scale)
+{
+  replay::DriftStats drift;
+  std::vector<Received> received = replay_bus(reader, [scale](replay::Options& options) {
+      options.mode = replay::Mode::SCALED;
+      options.scale = scale;
+    }, &drift);
+
+  std::vector<const trace::Record*> tx;
+  for(uint64_t r = 0; r < reader.count(); r++) {
+    if(reader[r].flags & trace::FLAG_TX)
+      tx.push_back(&reader[r]);
+  }
+
+  check(received.size() == tx.size(), "Received", received.size());
+
+  const double bit_ns = 1e9 / BIT_RATE_DEFAULT;
+  auto sof_ns = [&](const trace::Record& rec) {
+    return double(rec.time_ns) - frame_length(trace::to_msg(rec)) * bit_ns;
+  };
+
+  for(size_t n = 0; n < received.size() && n < tx.size(); n++) {
+    check(compare_messages(received[n].msg, trace::to_msg(*tx[n])), "Message", n);
+
+    // The listener receives the frame at its end, a frame length after
+    // the start of frame
+    const double expected = scale * (sof_ns(*tx[n]) - sof_ns(*tx[0])) +
+                            (double(tx[n]->time_ns) - sof_ns(*tx[n])) -
+                            (double(tx[0]->time_ns) - sof_ns(*tx[0]));
+    const double actual = double(received[n].time_ns) - double(received[0].time_ns);
+    check(std::abs(actual - expected) <= bit_ns, "Timing", n);
+  }
+
+  check(drift.count() + 1 == tx.size(), "Drift count", drift.count());
+  check(drift.max() <= bit_ns, "Drift", drift.max());
+
+  printf("Scale %.1f: %zu frames, drift max %.1f us\n", scale, received.size(),
+         1e-3 * drift.max());
+}
+
+// As fast as possible, the frames must still come in the recorded order,
+// and the bus must be nearly saturated
+static void check_asap(const trace::TraceReader& reader)
+{
+  std::vector<Received> received = replay_bus(reader, [](replay::Options& options) {
+      options.mode = replay::Mode::AS_FAST_AS_POSSIBLE;
+    });
+
+  uint64_t num_tx = 0;
+  uint64_t bits = 0;
+  for(uint64_t r = 0; r < reader.count(); r++) {
+    if(!(reader[r].flags & trace::FLAG_TX))
+      continue;
+
+    const CanMsg msg = trace::to_msg(reader[r]);
+    check(num_tx < received.size() && compare_messages(received[num_tx].msg, msg), "Order", num_tx);
+    if(num_tx > 0)
+      bits += frame_length(msg) + FRAME_IFS_LENGTH;
+    num_tx++;
+  }
+
+  check(received.size() == num_tx, "Received", received.size());
+  if(received.size() < 2)
+    return;
+
+  const double elapsed_bits = 1e-9 * BIT_RATE_DEFAULT *
+                              (received.back().time_ns - received.front().time_ns);
+  const double load = bits / elapsed_bits;
+  check(load > 0.9, "Bus load", uint64_t(100 * load));
+
+  printf("As fast as possible: %zu frames, bus load %.1f %%\n", received.size(), 100 * load);
+}
+
+// Only the frames controller 1 received (sent by the others), by the Rx
+// records of controller 1
+static void check_rx_records(const trace::TraceReader& reader)
+{
+  uint64_t expected = 0;
+  for(uint64_t r = 0; r < reader.count(); r++)
+    expected += reader[r].controller == 1 && !(reader[r].flags & trace::FLAG_TX);
+
+  sim::Bus bus;
+  std::vector<Canola<sim::SimIO>> drivers;
+  uint64_t received = 0;
+
+  for(unsigned int i = 0; i < 2; i++) {
+    drivers.emplace_back(bus.io(bus.add()));
+    drivers[i].init();
+  }
+  bus.set_irq_handler(1, [&](uint32_t irqs) { received += (irqs & sim::IRQ_RX_VALID) != 0; });
+
+  replay::Options options;
+  options.replay_tx = false;
+
+  replay::Replayer<sim::SimIO, SimClock> replayer(options, SimClock(&bus));
+  replayer.map(1, drivers[0]);
+
+  check(replayer.run(reader) == expected, "Rx records sent", replayer.sent());
+  bus.run(200);
+  check(received == expected, "Rx records received", received);
+}
+
+static int run_check()
+{
+  constexpr unsigned int NUM_MSGS = 1000;
+
+  const char* dir = getenv("TMPDIR");
+  const std::string path = std::string(dir != nullptr ? dir : "/tmp") + "/canola_replay_check_" +
+                           std::to_string(::getpid()) + ".trace";
+
+  record_bus(path, NUM_MSGS);
+
+  trace::TraceReader reader;
+  check(reader.open(path), "Open", 0);
+
+  if(reader.is_open()) {
+    check(reader.count() == NUM_MSGS * 4, "Recorded", reader.count());
+    check_timed(reader, 1.0);
+    check_timed(reader, 2.0);
+    check_asap(reader);
+    check_rx_records(reader);
+  }
+  ::unlink(path.c_str());
+
+  printf("%s (%u errors)\n", g_errors == 0 ? "OK" : "FAILED", g_errors);
+  return g_errors == 0 ? 0 : 1;
+}
+
+//-----------------------------------------------------------------------------
+// Bench
+//-----------------------------------------------------------------------------
+static replay::DriftStats bench_drift(const std::vector<trace::Record>& records, uint64_t spin_ns)
+{
+  std::vector<uint32_t> regs(0x400);
+  Canola<MmapIO> can{MmapIO(regs.data())};
+
+  replay::Options options;
+  options.bit_rate = 0.0;
+  options.spin_ns = spin_ns;
+
+  replay::Replayer<MmapIO> replayer(options);
+  replayer.map(0, can);
+  replayer.run(records.data(), records.size());
+
+  return replayer.drift();
+}
+
+static void run_bench(unsigned int num_frames, unsigned int interval_us)
+{
+  std::vector<trace::Record> records(num_frames);
+  std::mt19937 rng(2);
+
+  for(unsigned int n = 0; n < num_frames; n++)
+    records[n] = trace::to_record(0, true, random_msg(rng), 0, uint64_t(n) * interval_us * 1000);
+
+  printf("%u frames, %u us apart\n", num_frames, interval_us);
+  print_drift_header();
+  print_drift("Sleep", bench_drift(records, 0));
+  print_drift("Spin/sleep (100 us)", bench_drift(records, replay::SPIN_NS_DEFAULT));
+}
+
+//-----------------------------------------------------------------------------
+// Replay
+//-----------------------------------------------------------------------------
+static replay::Replayer<MmapIO>* g_replayer = nullptr;
+
+static void on_signal(int)
+{
+  if(g_replayer != nullptr)
+    g_replayer->stop();
+}
+
+static int run_replay(const char* path, const char* mode, int num_devs, char** devs)
+{
+  trace::TraceReader reader;
+  if(!reader.open(path)) {
+    printf("Could not open %s\n", path);
+    return 1;
+  }
+
+  std::vector<std::unique_ptr<UioDevice>> uio;
+  std::vector<Canola<MmapIO>> drivers;
+
+  drivers.reserve(num_devs);
+  for(int i = 0; i < num_devs; i++) {
+    uio.emplace_back(new UioDevice());
+    if(!uio.back()->open(devs[i], "", "")) {
+      printf("Could not open %s\n", devs[i]);
+      return 1;
+    }
+    drivers.emplace_back(uio.back()->io());
+  }
+
+  replay::Options options;
+  if(strcmp(mode, "asap") == 0) {
+    options.mode = replay::Mode::AS_FAST_AS_POSSIBLE;
+  } else if(strcmp(mode, "original") != 0) {
+    options.mode = replay::Mode::SCALED;
+    options.scale = strtod(mode, nullptr);
+  }
+
+  replay::Replayer<MmapIO> replayer(options);
+  for(int i = 0; i < num_devs; i++)
+    replayer.map(i, drivers[i]);
+
+  g_replayer = &replayer;
+  std::signal(SIGINT, on_signal);
+  std::signal(SIGTERM, on_signal);
+
+  replayer.run(reader);
+
+  printf("%llu frames sent, %llu records skipped, in %.3f s\n",
+         (unsigned long long)replayer.sent(), (unsigned long long)replayer.skipped(),
+         1e-9 * replayer.duration_ns());
+  if(options.mode != replay::Mode::AS_FAST_AS_POSSIBLE) {
+    print_drift_header();
+    print_drift("All controllers", replayer.drift());
+  }
+
+  return 0;
+}
+
+int main(int argc, char** argv)
+{
+  const char* mode = argc > 1 ? argv[1] : "check";
+
+  if(strcmp(mode, "check") == 0) {
+    return run_check();
+  } else if(strcmp(mode, "bench") == 0) {
+    run_bench(argc > 2 ? strtoul(argv[2], nullptr, 0) : 10000,
+              argc > 3 ? strtoul(argv[3], nullptr, 0) : 100);
+    return 0;
+  } else if(strcmp(mode, "replay") == 0 && argc > 4) {
+    return run_replay(argv[2], argv[3], argc - 4, argv + 4);
+  }
+
+  printf("Usage: %s check|bench [frames] [interval_us]|"
+         "replay <file> original|asap|<scale> <uio device>...\n", argv[0]);
+  return 1;
+}
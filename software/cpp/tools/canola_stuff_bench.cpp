@@ -0,0 +1,351 @@
+/**
+ * @file   canola_stuff_bench.cpp
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Checks the bit stuffing and frame codec in canola_stuff.hpp, and
+ *         measures its throughput.
+ *
+ *         check: Compares stuffing with a bit-serial implementation, frames
+ *                with the bits the model in canola_model.hpp puts on the bus,
+ *                frame_lengths() with frame_length(), and decodes all
+ *                encoded frames.
+ *         bench: Frames per second for frame_length(), frame_lengths(),
+ *                encode_frame() and decode_frame().
+ *
+ *         Build: g++ -std=c++14 -O2 -march=native -I.. canola_stuff_bench.cpp -o canola_stuff_bench
+ */
+
+#include "canola_model.hpp"
+#include "canola_stuff.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace canola;
+
+static unsigned int g_errors = 0;
+
+static void check(bool ok, const char* what, size_t index)
+{
+  if(!ok) {
+    if(g_errors < 10)
+      printf("%s (%zu)\n", what, index);
+    g_errors++;
+  }
+}
+
+static bool get_bit(const uint64_t* words, size_t pos)
+{
+  return (words[pos / 64] >> (63 - pos % 64)) & 1;
+}
+
+/**
+ * Bit-serial stuffing, the way canola_bsp.vhd does it
+ */
+static std::vector<bool> reference_stuff(const std::vector<bool>& bits)
+{
+  std::vector<bool> out;
+  unsigned int count = 0;
+  bool prev = true;
+
+  for(bool bit : bits) {
+    count = (count > 0 && bit == prev) ? count + 1 : 1;
+    prev = bit;
+    out.push_back(bit);
+
+    if(count == 5) {
+      out.push_back(!bit);
+      prev = !bit;
+      count = 1;
+    }
+  }
+
+  return out;
+}
+
+static std::vector<bool> to_vector(const uint64_t* words, size_t num_bits)
+{
+  std::vector<bool> bits;
+  for(size_t i = 0; i < num_bits; i++)
+    bits.push_back(get_bit(words, i));
+  return bits;
+}
+
+static void from_vector(const std::vector<bool>& bits, uint64_t* words)
+{
+  for(size_t i = 0; i < (bits.size() + 63) / 64; i++)
+    words[i] = 0;
+  for(size_t i = 0; i < bits.size(); i++)
+    words[i / 64] |= uint64_t(bits[i]) << (63 - i % 64);
+}
+
+/**
+ * Random bits with runs of 1 to 8 identical bits, so that there are
+ * plenty of stuff bits and runs across word boundaries
+ */
+static std::vector<bool> random_runs(std::mt19937& rng, size_t num_bits)
+{
+  std::vector<bool> bits;
+  bool value = rng() & 1;
+
+  while(bits.size() < num_bits) {
+    unsigned int run = 1 + rng() % 8;
+    for(unsigned int i = 0; i < run && bits.size() < num_bits; i++)
+      bits.push_back(value);
+    value = !value;
+  }
+
+  return bits;
+}
+
+/**
+ * Random messages, with many all-zero and all-one bytes and IDs
+ */
+static CanMsg random_msg(std::mt19937& rng)
+{
+  auto biased = [&](uint32_t mask) -> uint32_t {
+    switch(rng() % 4) {
+    case 0:  return 0;
+    case 1:  return mask;
+    default: return rng() & mask;
+    }
+  };
+
+  CanMsg msg;
+  msg.ext_id = rng() & 1;
+  msg.remote_frame = (rng() % 8) == 0;
+  msg.arb_id_a = biased(0x7FF);
+  msg.arb_id_b = msg.ext_id ? biased(0x3FFFF) : 0;
+  msg.data_length = rng() % 9;
+  for(unsigned int i = 0; i < 8; i++)
+    msg.payload[i] = i < msg.data_length && !msg.remote_frame ? biased(0xFF) : 0;
+  return msg;
+}
+
+static bool msg_equal(const CanMsg& a, const CanMsg& b)
+{
+  if(a.ext_id != b.ext_id || a.arb_id_a != b.arb_id_a || a.remote_frame != b.remote_frame ||
+     a.data_length != b.data_length || (a.ext_id && a.arb_id_b != b.arb_id_b))
+    return false;
+
+  if(!a.remote_frame)
+    return memcmp(a.payload, b.payload, a.data_length) == 0;
+  return true;
+}
+
+/**
+ * Bits the model puts on the bus from SOF to the end of EOF, when one node
+ * sends msg and another acknowledges it
+ */
+static std::vector<bool> model_frame(model::Bus& bus, model::Node& tx, unsigned int length,
+                                     const CanMsg& msg)
+{
+  std::vector<bool> bits;
+
+  tx.start_tx(msg);
+
+  bool bit = bus.step();
+  while(bit)
+    bit = bus.step();
+
+  bits.push_back(bit);
+  while(bits.size() < length)
+    bits.push_back(bus.step());
+
+  for(unsigned int i = 0; i < FRAME_IFS_LENGTH + 1; i++)
+    bus.step();
+
+  return bits;
+}
+
+static int run_check()
+{
+  std::mt19937 rng(1);
+
+  // Stuffing and destuffing of bit strings of all lengths
+  for(size_t n = 0; n < 200000; n++) {
+    const size_t num_bits = n % 400;
+    const std::vector<bool> bits = random_runs(rng, num_bits);
+    const std::vector<bool> expected = reference_stuff(bits);
+
+    uint64_t in[8], out[10], back[8];
+    from_vector(bits, in);
+
+    const size_t length = stuff_bits(in, num_bits, out);
+    check(length == expected.size(), "stuff_bits() length", n);
+    check(to_vector(out, length) == expected, "stuff_bits() bits", n);
+    check(count_stuff_bits(in, num_bits) == expected.size() - num_bits, "count_stuff_bits()", n);
+
+    size_t consumed;
+    bool stuff_error;
+    const size_t destuffed = destuff_bits(out, length, back, num_bits, consumed, stuff_error);
+    check(!stuff_error && destuffed == num_bits && consumed == length, "destuff_bits() length", n);
+    check(to_vector(back, destuffed) == bits, "destuff_bits() bits", n);
+  }
+  printf("Stuffing bit strings: %u errors\n", g_errors);
+
+  // Frames against the model, and decoding
+  model::Node tx, rx;
+  model::Bus bus;
+  bus.attach(tx);
+  bus.attach(rx);
+  bus.step();
+
+  const unsigned int num_msgs = 100000;
+  std::vector<CanMsg> msgs(num_msgs);
+
+  for(unsigned int n = 0; n < num_msgs; n++) {
+    const CanMsg msg = msgs[n] = random_msg(rng);
+
+    FrameBits frame;
+    const unsigned int length = encode_frame(msg, frame);
+
+    check(length == frame_length(msg), "frame_length()", n);
+
+    // Bit-serial stuffing of the unstuffed frame
+    uint64_t unstuffed[FRAME_WORDS];
+    const unsigned int unstuffed_length = pack_frame(msg, unstuffed);
+    check(unstuffed_length == frame_unstuffed_length(msg), "frame_unstuffed_length()", n);
+    check(reference_stuff(to_vector(unstuffed, unstuffed_length)).size() + FRAME_TRAILER_LENGTH == length,
+          "Stuffed frame length", n);
+
+    if(n < 20000)
+      check(model_frame(bus, tx, length, msg) == to_vector(frame.words, length), "Model bus bits", n);
+
+    CanMsg decoded;
+    unsigned int frame_bits = 0;
+    check(decode_frame(frame.words, length, decoded, &frame_bits) == DecodeStatus::OK, "decode_frame()", n);
+    check(msg_equal(decoded, msg) && frame_bits == length, "Decoded message", n);
+
+    // A stuff bit with the wrong value gives six identical bits
+    const std::vector<bool> bits = to_vector(frame.words, length);
+    unsigned int count = 0;
+    for(unsigned int i = 0; i + 1 < length - FRAME_TRAILER_LENGTH; i++) {
+      count = (i > 0 && bits[i] == bits[i-1]) ? count + 1 : 1;
+      if(count == 5) {
+        FrameBits bad = frame;
+        bad.words[(i + 1) / 64] ^= uint64_t(1) << (63 - (i + 1) % 64);
+        check(decode_frame(bad.words, length, decoded) == DecodeStatus::STUFF_ERROR, "Stuff error", n);
+        break;
+      }
+    }
+
+    // Recessive ACK slot is allowed, a dominant EOF bit is not
+    FrameBits no_ack;
+    encode_frame(msg, no_ack, false);
+    check(decode_frame(no_ack.words, length, decoded) == DecodeStatus::OK, "No ACK", n);
+
+    FrameBits bad_eof = frame;
+    const unsigned int eof_bit = length - 1 - rng() % FRAME_EOF_LENGTH;
+    bad_eof.words[eof_bit / 64] ^= uint64_t(1) << (63 - eof_bit % 64);
+    check(decode_frame(bad_eof.words, length, decoded) == DecodeStatus::FORM_ERROR, "EOF form error", n);
+    check(decode_frame(frame.words, length - 1, decoded) == DecodeStatus::TRUNCATED, "Truncated", n);
+  }
+  printf("Frames: %u errors\n", g_errors);
+
+  std::vector<uint16_t> lengths(num_msgs);
+  frame_lengths(msgs.data(), num_msgs, lengths.data());
+  for(unsigned int n = 0; n < num_msgs; n++)
+    check(lengths[n] == frame_length(msgs[n]), "frame_lengths()", n);
+  printf("Batch frame lengths: %u errors\n", g_errors);
+
+  printf("%s (%u errors)\n", g_errors == 0 ? "OK" : "FAILED", g_errors);
+  return g_errors == 0 ? 0 : 1;
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static int run_bench()
+{
+  std::mt19937 rng(1);
+  const unsigned int num_msgs = 1 << 16;
+  const unsigned int rounds = 32;
+  std::vector<CanMsg> msgs(num_msgs);
+  std::vector<FrameBits> frames(num_msgs);
+  std::vector<uint16_t> lengths(num_msgs);
+
+  for(CanMsg& msg : msgs)
+    msg = random_msg(rng);
+
+  auto report = [&](const char* name, double seconds, uint64_t sum) {
+    printf("%-16s %8.2f Mframes/s  (%llu)\n", name, double(rounds) * num_msgs / seconds / 1e6,
+           (unsigned long long)sum);
+  };
+
+  {
+    uint64_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(unsigned int r = 0; r < rounds; r++) {
+      for(const CanMsg& msg : msgs) {
+        uint64_t unstuffed[FRAME_WORDS];
+        const unsigned int length = pack_frame(msg, unstuffed);
+        sum += reference_stuff(to_vector(unstuffed, length)).size() + FRAME_TRAILER_LENGTH;
+      }
+    }
+    report("bit-serial", seconds_since(start), sum);
+  }
+
+  {
+    uint64_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(unsigned int r = 0; r < rounds; r++) {
+      for(const CanMsg& msg : msgs)
+        sum += frame_length(msg);
+    }
+    report("frame_length", seconds_since(start), sum);
+  }
+
+  {
+    uint64_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(unsigned int r = 0; r < rounds; r++) {
+      frame_lengths(msgs.data(), num_msgs, lengths.data());
+      sum += lengths[r];
+    }
+    report("frame_lengths", seconds_since(start), sum);
+  }
+
+  {
+    uint64_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(unsigned int r = 0; r < rounds; r++) {
+      for(unsigned int i = 0; i < num_msgs; i++)
+        sum += encode_frame(msgs[i], frames[i]);
+    }
+    report("encode_frame", seconds_since(start), sum);
+  }
+
+  {
+    uint64_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(unsigned int r = 0; r < rounds; r++) {
+      for(unsigned int i = 0; i < num_msgs; i++) {
+        CanMsg msg;
+        sum += decode_frame(frames[i].words, frames[i].num_bits, msg) == DecodeStatus::OK;
+      }
+    }
+    report("decode_frame", seconds_since(start), sum);
+  }
+
+  return 0;
+}
+
+int main(int argc, char** argv)
+{
+  const char* mode = argc > 1 ? argv[1] : "check";
+
+  if(strcmp(mode, "check") == 0) {
+    return run_check();
+  } else if(strcmp(mode, "bench") == 0) {
+    return run_bench();
+  }
+
+  printf("Usage: %s check|bench\n", argv[0]);
+  return 1;
+}
@@ -0,0 +1,522 @@
+/**
+ * @file   canola_telemetry.cpp
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Counter telemetry for Canola controllers, see canola_telemetry.hpp.
+ *
+ *         check:  Checks the deltas and totals against simulated controllers
+ *                 on a bus (canola_sim.hpp), wraparound and reset of the
+ *                 counters, the burst read, the ring with a concurrent
+ *                 reader, shared memory, and the exporter over a socket.
+ *         bench [samples=1000000]:
+ *                 Time per sample of four controllers, with registers in
+ *                 memory (MmapIO and MmapIO64), and per Prometheus page.
+ *         sample <interval_ms> <uio device>...:
+ *                 Samples controllers opened through UIO (e.g. /dev/uio0)
+ *                 into the shared memory ring, until SIGINT.
+ *         export [port=9101]:
+ *                 Serves the last sample in the ring to Prometheus at
+ *                 http://127.0.0.1:<port>/metrics, until SIGINT.
+ *
+ *         Build: g++ -std=c++14 -O2 -march=native -pthread -I.. canola_telemetry.cpp -o canola_telemetry -lrt
+ */
+
+#include "canola_telemetry.hpp"
+#include "canola_sim.hpp"
+#include "canola_uio.hpp"
+#include <arpa/inet.h>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace canola;
+
+static unsigned int g_errors = 0;
+static volatile std::sig_atomic_t g_stop = 0;
+
+static void check(bool ok, const char* what, uint64_t index)
+{
+  if(!ok) {
+    if(g_errors < 10)
+      printf("%s (%llu)\n", what, (unsigned long long)index);
+    g_errors++;
+  }
+}
+
+static void on_signal(int)
+{
+  g_stop = 1;
+}
+
+//-----------------------------------------------------------------------------
+// Check
+//-----------------------------------------------------------------------------
+static CanMsg generate_rand_msg(std::mt19937& rng)
+{
+  CanMsg msg = {};
+
+  msg.arb_id_a = rng() % 2048;
+  msg.data_length = rng() % 9;
+  for(unsigned int i = 0; i < msg.data_length; i++)
+    msg.payload[i] = rng() % 256;
+
+  return msg;
+}
+
+// Random traffic between simulated controllers, sampled every 2 ms of bus
+// time. The totals must follow the registers, and the deltas must add up.
+static void check_sim()
+{
+  constexpr unsigned int NUM_CONTROLLERS = 4;
+  constexpr unsigned int NUM_SAMPLES = 50;
+
+  std::mt19937 rng(1);
+  sim::Bus bus;
+  std::vector<Canola<sim::SimIO>> drivers;
+  telemetry::Sampler<sim::SimIO> sampler;
+
+  drivers.reserve(NUM_CONTROLLERS);
+  for(unsigned int i = 0; i < NUM_CONTROLLERS; i++) {
+    drivers.emplace_back(bus.io(bus.add()));
+    drivers[i].init();
+    sampler.add(drivers[i]);
+  }
+
+  uint64_t sum[NUM_CONTROLLERS][NUM_COUNTERS] = {};
+  uint64_t first[NUM_CONTROLLERS][NUM_COUNTERS] = {};
+
+  for(unsigned int s = 0; s < NUM_SAMPLES; s++) {
+    for(unsigned int i = 0; i < NUM_CONTROLLERS; i++) {
+      if(!drivers[i].is_busy() && rng() % 2 == 0)
+        drivers[i].send_msg(generate_rand_msg(rng));
+    }
+    bus.run_for(2e-3);
+
+    const telemetry::Sample& sample = sampler.sample(uint64_t(bus.time() * 1e9 + 0.5));
+    check(sample.sequence == s + 1 && sample.controllers == NUM_CONTROLLERS, "Sequence", s);
+
+    for(unsigned int i = 0; i < NUM_CONTROLLERS; i++) {
+      const telemetry::ControllerSample& c = sample.controller[i];
+      const CounterValues values = drivers[i].read_counters();
+
+      check(c.reset_mask == 0, "No resets", s);
+      check(c.values.transmit_error_count == drivers[i].transmit_error_count(), "TEC", s);
+      check(c.values.receive_error_count == drivers[i].receive_error_count(), "REC", s);
+      check(c.values.error_state == drivers[i].error_state(), "Error state", s);
+
+      for(unsigned int j = 0; j < NUM_COUNTERS; j++) {
+        check(c.values.count[j] == values.count[j], "Burst read", j);
+        check(c.total[j] == values.count[j], "Total", j);
+        if(s == 0)
+          first[i][j] = c.total[j];
+        sum[i][j] += c.delta[j];
+
+        const double seconds = 1e-9 * sample.interval_ns;
+        check(c.rate[j] == (seconds > 0.0 ? c.delta[j] / seconds : 0.0), "Rate", j);
+      }
+    }
+  }
+
+  uint64_t sent = 0;
+  for(unsigned int i = 0; i < NUM_CONTROLLERS; i++) {
+    sent += sampler.last().controller[i].total[counter_index(Counter::TX_MSG_SENT)];
+    for(unsigned int j = 0; j < NUM_COUNTERS; j++)
+      check(first[i][j] + sum[i][j] == sampler.last().controller[i].total[j], "Sum of deltas", j);
+  }
+  check(sent > 0, "Messages sent", 0);
+
+  // A reset of the registers is a reset, not a wraparound, and the totals
+  // keep counting
+  const telemetry::Sample before = sampler.last();
+  drivers[1].reset_counters();
+  drivers[1].send_msg(generate_rand_msg(rng));
+  bus.run_for(2e-3);
+
+  const telemetry::Sample& after = sampler.sample(uint64_t(bus.time() * 1e9 + 0.5));
+  const unsigned int tx_sent = counter_index(Counter::TX_MSG_SENT);
+  check(after.controller[1].reset_mask & (1u << tx_sent), "Reset detected", 0);
+  check(after.controller[1].delta[tx_sent] == 1, "Delta after reset", 0);
+  check(after.controller[1].total[tx_sent] == before.controller[1].total[tx_sent] + 1,
+        "Total after reset", 0);
+  check(after.controller[0].reset_mask == 0, "Reset of another controller", 0);
+
+  printf("Simulated bus: %llu messages sent in %u samples\n", (unsigned long long)sent,
+         NUM_SAMPLES + 1);
+}
+
+static void check_wraparound()
+{
+  const unsigned int rx_recv = counter_index(Counter::RX_MSG_RECV);
+  Canola<MockIO> can{MockIO()};
+  telemetry::Sampler<MockIO> sampler(1e6);
+  sampler.add(can);
+
+  can.io().poke(uint32_t(Counter::RX_MSG_RECV), 0xFFFFFF00);
+  sampler.sample(0);
+
+  // 0x200 messages in a second is possible at 1 Mbit, so this is a wraparound
+  can.io().poke(uint32_t(Counter::RX_MSG_RECV), 0x100);
+  const telemetry::Sample& s1 = sampler.sample(1000000000);
+  check(s1.controller[0].delta[rx_recv] == 0x200 && s1.controller[0].reset_mask == 0,
+        "Wraparound delta", 0);
+  check(s1.controller[0].total[rx_recv] == 0x100000100ull, "Wraparound total", 0);
+  check(s1.controller[0].rate[rx_recv] == 512.0, "Wraparound rate", 0);
+
+  // Going from 0x100 to 0x5 in 1 ms would take 2^32 messages
+  can.io().poke(uint32_t(Counter::RX_MSG_RECV), 0x5);
+  const telemetry::Sample& s2 = sampler.sample(1001000000);
+  check(s2.controller[0].delta[rx_recv] == 0x5 && s2.controller[0].reset_mask == 1u << rx_recv,
+        "Reset delta", 0);
+  check(s2.controller[0].total[rx_recv] == 0x100000105ull, "Reset total", 0);
+
+  bool reset = false;
+  check(telemetry::counter_delta(0xFFFFFFFF, 0, 1, reset) == 1 && !reset, "counter_delta", 0);
+  check(telemetry::counter_delta(10, 10, 0, reset) == 0 && !reset, "counter_delta", 1);
+  check(telemetry::counter_delta(10, 9, 1000, reset) == 9 && reset, "counter_delta", 2);
+}
+
+// Same values with and without 64-bit accesses, in fewer transactions
+static void check_burst_read()
+{
+  Canola<MockIO> can32{MockIO()};
+  Canola<MockIO64> can64{MockIO64()};
+
+  for(uint32_t offset = reg::TRANSMIT_ERROR_COUNT::address;
+      offset <= reg::RX_STUFF_ERROR_COUNT::address; offset += 4) {
+    can32.io().poke(offset, offset * 0x01010101u);
+    can64.io().poke(offset, offset * 0x01010101u);
+  }
+  can32.io().poke(reg::STATUS::address, 1u << 4);
+  can64.io().poke(reg::STATUS::address, 1u << 4);
+
+  const CounterValues v32 = can32.read_counters();
+  const CounterValues v64 = can64.read_counters();
+  const uint64_t reads32 = can32.io().read_count();
+  const uint64_t reads64 = can64.io().read_count();
+
+  check(v32.transmit_error_count == reg::TRANSMIT_ERROR_COUNT::address * 0x01010101u, "TEC", 0);
+  check(v32.receive_error_count == reg::RECEIVE_ERROR_COUNT::address * 0x01010101u, "REC", 0);
+  check(v32.error_state == ErrorState::ERROR_PASSIVE, "Error state", 0);
+  check(v64.transmit_error_count == v32.transmit_error_count &&
+        v64.receive_error_count == v32.receive_error_count &&
+        v64.error_state == v32.error_state, "64-bit read", 0);
+
+  for(unsigned int j = 0; j < NUM_COUNTERS; j++) {
+    check(v32.count[j] == can32.counter(Counter(reg::TX_MSG_SENT_COUNT::address + 4 * j)),
+          "Counter", j);
+    check(v64.count[j] == v32.count[j], "64-bit read", j);
+  }
+
+  printf("Burst read: %llu transactions, %llu with 64-bit accesses\n",
+         (unsigned long long)reads32, (unsigned long long)reads64);
+  check(reads32 == 13 && reads64 == 8, "Transactions", 0);
+}
+
+static telemetry::Sample ring_sample(uint64_t sequence)
+{
+  telemetry::Sample sample = {};
+  sample.sequence = sequence;
+  sample.time_ns = sequence * 1000;
+  sample.controllers = telemetry::CONTROLLERS_MAX;
+  for(unsigned int i = 0; i < telemetry::CONTROLLERS_MAX; i++)
+    for(unsigned int j = 0; j < NUM_COUNTERS; j++)
+      sample.controller[i].total[j] = sequence * NUM_COUNTERS + j;
+  return sample;
+}
+
+static bool ring_sample_ok(const telemetry::Sample& sample)
+{
+  for(unsigned int i = 0; i < telemetry::CONTROLLERS_MAX; i++)
+    for(unsigned int j = 0; j < NUM_COUNTERS; j++)
+      if(sample.controller[i].total[j] != sample.sequence * NUM_COUNTERS + j)
+        return false;
+  return sample.time_ns == sample.sequence * 1000;
+}
+
+// A reader copies the latest sample while the writer goes around a small
+// ring as fast as it can. It must never see a torn sample.
+static void check_ring()
+{
+  constexpr unsigned int SLOTS = 4;
+  constexpr uint64_t NUM_SAMPLES = 100000;
+
+  std::vector<uint64_t> memory(telemetry::SampleRing::size(SLOTS) / sizeof(uint64_t) + 1);
+  telemetry::SampleRing ring = telemetry::SampleRing::create(memory.data(), SLOTS);
+  const telemetry::SampleRing reader =
+    telemetry::SampleRing::attach(memory.data(), memory.size() * sizeof(uint64_t));
+  check(reader.is_valid(), "Attach", 0);
+
+  telemetry::Sample sample;
+  check(!reader.latest(sample), "Empty ring", 0);
+
+  std::atomic<bool> done(false);
+  uint64_t reads = 0;
+  uint64_t torn = 0;
+  uint64_t backwards = 0;
+
+  std::thread thread([&] {
+    telemetry::Sample copy;
+    uint64_t last = 0;
+    while(!done.load()) {
+      if(!reader.latest(copy))
+        continue;
+      reads++;
+      if(!ring_sample_ok(copy))
+        torn++;
+      if(copy.sequence < last)
+        backwards++;
+      last = copy.sequence;
+    }
+  });
+
+  for(uint64_t n = 1; n <= NUM_SAMPLES; n++)
+    ring.push(ring_sample(n));
+  done = true;
+  thread.join();
+
+  printf("Ring: %llu samples written, %llu read while writing\n",
+         (unsigned long long)NUM_SAMPLES, (unsigned long long)reads);
+  check(torn == 0, "Torn sample", torn);
+  check(backwards == 0, "Sample older than the previous one", backwards);
+
+  check(reader.latest(sample) && sample.sequence == NUM_SAMPLES && ring_sample_ok(sample),
+        "Latest", 0);
+  check(reader.read(NUM_SAMPLES - SLOTS + 1, sample) && ring_sample_ok(sample), "Oldest", 0);
+  check(!reader.read(NUM_SAMPLES - SLOTS, sample), "Overwritten", 0);
+  check(!reader.read(NUM_SAMPLES + 1, sample), "Not written yet", 0);
+
+  // Between processes, through shared memory
+  const std::string name = "/canola_telemetry_check_" + std::to_string(getpid());
+  telemetry::SharedRing writer_shm;
+  telemetry::SharedRing reader_shm;
+  check(writer_shm.create(name, SLOTS), "Create shared memory", 0);
+  check(reader_shm.open(name), "Open shared memory", 0);
+
+  if(writer_shm.ring().is_valid() && reader_shm.ring().is_valid()) {
+    writer_shm.ring().push(ring_sample(42));
+    check(reader_shm.ring().latest(sample) && sample.sequence == 42 && ring_sample_ok(sample),
+          "Shared memory", 0);
+  }
+}
+
+static std::string http_get(uint16_t port, const char* path)
+{
+  std::string response;
+  int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  if(::connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == 0) {
+    const std::string request = std::string("GET ") + path + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    ::send(fd, request.data(), request.size(), MSG_NOSIGNAL);
+
+    char buf[4096];
+    ssize_t n;
+    while((n = ::recv(fd, buf, sizeof(buf), 0)) > 0)
+      response.append(buf, size_t(n));
+  }
+
+  ::close(fd);
+  return response;
+}
+
+static void check_exporter()
+{
+  telemetry::Exporter exporter;
+  check(exporter.listen(0), "Listen", 0);
+
+  telemetry::Sample sample = ring_sample(7);
+  sample.controllers = 2;
+  sample.interval_ns = 500000000;
+  sample.controller[1].rate[counter_index(Counter::RX_CRC_ERROR)] = 2.5;
+  sample.controller[1].values.error_state = ErrorState::BUS_OFF;
+
+  std::thread thread([&] {
+    for(unsigned int i = 0; i < 2; i++)
+      exporter.serve(5000, [&] { return telemetry::format_prometheus(sample); });
+  });
+
+  const std::string metrics = http_get(exporter.port(), "/metrics");
+  const std::string missing = http_get(exporter.port(), "/other");
+  thread.join();
+
+  const char* expected[] = {
+    "HTTP/1.1 200 OK\r\n",
+    "# TYPE canola_tx_msg_sent_total counter\n",
+    "canola_tx_msg_sent_total{controller=\"0\"} 70\n",
+    "canola_rx_stuff_error_total{controller=\"1\"} 79\n",
+    "canola_rx_crc_error_rate{controller=\"1\"} 2.5\n",
+    "canola_error_state{controller=\"1\"} 2\n",
+    "canola_telemetry_samples_total 7\n",
+    "canola_telemetry_interval_seconds 0.500000000\n"
+  };
+  for(unsigned int i = 0; i < sizeof(expected) / sizeof(expected[0]); i++)
+    check(metrics.find(expected[i]) != std::string::npos, expected[i], i);
+  check(metrics.find("controller=\"2\"") == std::string::npos, "Unused controller", 0);
+  check(missing.compare(0, 22, "HTTP/1.1 404 Not Found") == 0, "404", 0);
+
+  printf("Exporter: %zu bytes for 2 controllers\n", metrics.size());
+}
+
+static int run_check()
+{
+  check_sim();
+  check_wraparound();
+  check_burst_read();
+  check_ring();
+  check_exporter();
+
+  printf("%s (%u errors)\n", g_errors == 0 ? "OK" : "FAILED", g_errors);
+  return g_errors == 0 ? 0 : 1;
+}
+
+//-----------------------------------------------------------------------------
+// Bench
+//-----------------------------------------------------------------------------
+template <typename IO>
+static double bench_sample(unsigned int num_samples)
+{
+  constexpr unsigned int NUM_CONTROLLERS = 4;
+
+  std::vector<std::vector<uint32_t>> regs(NUM_CONTROLLERS, std::vector<uint32_t>(0x400));
+  std::vector<Canola<IO>> drivers;
+  telemetry::Sampler<IO> sampler;
+
+  drivers.reserve(NUM_CONTROLLERS);
+  for(unsigned int i = 0; i < NUM_CONTROLLERS; i++) {
+    drivers.emplace_back(IO(regs[i].data()));
+    sampler.add(drivers[i]);
+  }
+
+  const uint32_t tx_sent = reg::TX_MSG_SENT_COUNT::address / 4;
+  auto start = std::chrono::steady_clock::now();
+  for(unsigned int n = 0; n < num_samples; n++) {
+    regs[n % NUM_CONTROLLERS][tx_sent]++;
+    sampler.sample(uint64_t(n + 1) * 1000000);
+  }
+  const double seconds =
+    std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  if(sampler.last().controller[0].total[0] != regs[0][tx_sent])
+    printf("Wrong total\n");
+  return 1e9 * seconds / num_samples;
+}
+
+static void run_bench(unsigned int num_samples)
+{
+  printf("Sample of 4 controllers, MmapIO:   %8.1f ns\n", bench_sample<MmapIO>(num_samples));
+  printf("Sample of 4 controllers, MmapIO64: %8.1f ns\n", bench_sample<MmapIO64>(num_samples));
+
+  telemetry::Sample sample = ring_sample(1);
+  sample.controllers = 4;
+
+  const unsigned int num_pages = num_samples / 100 + 1;
+  size_t bytes = 0;
+  auto start = std::chrono::steady_clock::now();
+  for(unsigned int n = 0; n < num_pages; n++)
+    bytes += telemetry::format_prometheus(sample).size();
+  const double seconds =
+    std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  printf("Prometheus page for 4 controllers: %8.1f us (%zu bytes)\n", 1e6 * seconds / num_pages,
+         bytes / num_pages);
+}
+
+//-----------------------------------------------------------------------------
+// Sampler and exporter processes
+//-----------------------------------------------------------------------------
+static int run_sample(unsigned int interval_ms, int num_devs, char** devs)
+{
+  std::vector<std::unique_ptr<UioDevice>> uio;
+  std::vector<Canola<MmapIO>> drivers;
+  telemetry::Sampler<MmapIO> sampler;
+
+  drivers.reserve(num_devs);
+  for(int i = 0; i < num_devs; i++) {
+    uio.emplace_back(new UioDevice());
+    if(!uio.back()->open(devs[i], "", "")) {
+      printf("Could not open %s\n", devs[i]);
+      return 1;
+    }
+    drivers.emplace_back(uio.back()->io());
+    if(!sampler.add(drivers.back())) {
+      printf("At most %u controllers\n", telemetry::CONTROLLERS_MAX);
+      return 1;
+    }
+  }
+
+  telemetry::SharedRing shm;
+  if(!shm.create(telemetry::SHM_NAME_DEFAULT)) {
+    printf("Could not create %s\n", telemetry::SHM_NAME_DEFAULT);
+    return 1;
+  }
+
+  std::signal(SIGINT, on_signal);
+  std::signal(SIGTERM, on_signal);
+
+  auto next = std::chrono::steady_clock::now();
+  while(!g_stop) {
+    shm.ring().push(sampler.sample());
+    next += std::chrono::milliseconds(interval_ms);
+    std::this_thread::sleep_until(next);
+  }
+
+  return 0;
+}
+
+static int run_export(uint16_t port)
+{
+  telemetry::SharedRing shm;
+  if(!shm.open(telemetry::SHM_NAME_DEFAULT)) {
+    printf("Could not open %s, is the sampler running?\n", telemetry::SHM_NAME_DEFAULT);
+    return 1;
+  }
+
+  telemetry::Exporter exporter;
+  if(!exporter.listen(port)) {
+    printf("Could not listen on port %u\n", port);
+    return 1;
+  }
+
+  std::signal(SIGINT, on_signal);
+  std::signal(SIGTERM, on_signal);
+
+  telemetry::Sample sample;
+  while(!g_stop) {
+    exporter.serve(200, [&] {
+      return shm.ring().latest(sample) ? telemetry::format_prometheus(sample) : std::string();
+    });
+  }
+
+  return 0;
+}
+
+int main(int argc, char** argv)
+{
+  const char* mode = argc > 1 ? argv[1] : "check";
+
+  if(strcmp(mode, "check") == 0) {
+    return run_check();
+  } else if(strcmp(mode, "bench") == 0) {
+    run_bench(argc > 2 ? strtoul(argv[2], nullptr, 0) : 1000000);
+    return 0;
+  } else if(strcmp(mode, "sample") == 0 && argc > 3) {
+    return run_sample(strtoul(argv[2], nullptr, 0), argc - 3, argv + 3);
+  } else if(strcmp(mode, "export") == 0) {
+    return run_export(argc > 2 ? strtoul(argv[2], nullptr, 0) : telemetry::EXPORTER_PORT_DEFAULT);
+  }
+
+  printf("Usage: %s check|bench [samples]|sample <interval_ms> <uio device>...|export [port]\n",
+         argv[0]);
+  return 1;
+}
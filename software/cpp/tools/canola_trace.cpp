@@ -0,0 +1,434 @@
+/**
+ * @file   canola_trace.cpp
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Frame trace recorder for Canola controllers, see canola_trace.hpp.
+ *
+ *         check:  Records the traffic of simulated controllers on a bus
+ *                 (canola_sim.hpp) and checks the trace against what was
+ *                 sent, checks a reader that follows a trace while it is
+ *                 written as fast as possible, and a full trace.
+ *         bench [records=10000000]:
+ *                 Time per record appended, compared to formatting the
+ *                 same frame as text.
+ *         record <file> <capacity> <uio device>...:
+ *                 Records the messages received by controllers opened
+ *                 through UIO (e.g. /dev/uio0), with the Rx FIFO enabled,
+ *                 until SIGINT.
+ *         follow <file>:
+ *                 Prints the records of a trace as they are written, until
+ *                 the writer closes it (or SIGINT).
+ *         dump <file>:
+ *                 Prints all records of a trace.
+ *
+ *         Build: g++ -std=c++14 -O2 -march=native -pthread -I.. canola_trace.cpp -o canola_trace
+ */
+
+#include "canola_trace.hpp"
+#include "canola_sim.hpp"
+#include "canola_uio.hpp"
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace canola;
+
+static unsigned int g_errors = 0;
+static volatile std::sig_atomic_t g_stop = 0;
+
+static void check(bool ok, const char* what, uint64_t index)
+{
+  if(!ok) {
+    if(g_errors < 10)
+      printf("%s (%llu)\n", what, (unsigned long long)index);
+    g_errors++;
+  }
+}
+
+static void on_signal(int)
+{
+  g_stop = 1;
+}
+
+// One line per record: time since the start of the trace, controller,
+// direction, controller timestamp, ID, DLC and payload
+static int format_record(char* buf, size_t size, const trace::Record& rec, uint64_t start_ns)
+{
+  const double seconds = 1e-9 * double(int64_t(rec.time_ns - start_ns));
+  int len = snprintf(buf, size, "%14.6f  %u %s %10lu  %*lx%s [%u]", seconds, rec.controller,
+                     (rec.flags & trace::FLAG_TX) ? "Tx" : "Rx", (unsigned long)rec.timestamp,
+                     (rec.flags & trace::FLAG_EXT_ID) ? 8 : 3, (unsigned long)rec.arb_id,
+                     (rec.flags & trace::FLAG_REMOTE_FRAME) ? " R" : "  ", rec.data_length);
+
+  if(!(rec.flags & trace::FLAG_REMOTE_FRAME)) {
+    for(unsigned int i = 0; i < rec.data_length && i < 8 && len < int(size); i++)
+      len += snprintf(buf + len, size - len, " %02x", rec.payload[i]);
+  }
+
+  return len;
+}
+
+static std::string temp_path()
+{
+  const char* dir = getenv("TMPDIR");
+  return std::string(dir != nullptr ? dir : "/tmp") + "/canola_trace_check_" +
+         std::to_string(::getpid()) + ".trace";
+}
+
+//-----------------------------------------------------------------------------
+// Check
+//-----------------------------------------------------------------------------
+static CanMsg random_msg(std::mt19937& rng)
+{
+  CanMsg msg = CanMsg{};
+
+  msg.arb_id_a = rng() % 2048;
+  msg.arb_id_b = rng() % 262144;
+  msg.ext_id = rng() % 2;
+  msg.remote_frame = rng() % 2;
+  msg.data_length = rng() % 9;
+
+  for(unsigned int i = 0; i < msg.data_length; i++)
+    msg.payload[i] = msg.remote_frame ? 0 : rng() % 256;
+
+  return msg;
+}
+
+// Four controllers take turns sending a random message, and the interrupt
+// handlers record what they send and receive. Every message must be in the
+// trace once as Tx and three times as Rx, with the same fields.
+static void check_sim(const std::string& path)
+{
+  constexpr unsigned int NUM_CONTROLLERS = 4;
+  constexpr unsigned int NUM_MSGS = 2000;
+
+  std::mt19937 rng(1);
+  sim::Bus bus;
+  std::vector<Canola<sim::SimIO>> drivers;
+  std::vector<CanMsg> sent;
+  trace::TraceWriter writer;
+
+  check(writer.create(path, NUM_MSGS * NUM_CONTROLLERS), "Create", 0);
+
+  auto bus_ns = [&bus]() { return uint64_t(bus.time() * 1e9 + 0.5); };
+
+  for(unsigned int i = 0; i < NUM_CONTROLLERS; i++) {
+    drivers.emplace_back(bus.io(bus.add()));
+    drivers[i].init();
+    drivers[i].set_rx_timestamp_enable(true);
+
+    bus.set_irq_handler(i, [&, i](uint32_t irqs) {
+      if(irqs & sim::IRQ_RX_VALID)
+        writer.rx(i, drivers[i].get_msg(), bus_ns());
+      if(irqs & sim::IRQ_TX_DONE)
+        writer.tx(i, sent.back(), drivers[i].tx_timestamp(), bus_ns());
+    });
+  }
+
+  bus.run(20);
+
+  for(unsigned int n = 0; n < NUM_MSGS; n++) {
+    const unsigned int tx = n % NUM_CONTROLLERS;
+    bus.run_until([&]() { return !drivers[tx].is_busy(); });
+
+    sent.push_back(random_msg(rng));
+    drivers[tx].send_msg(sent.back());
+    bus.run(200);
+  }
+  bus.run(200);
+  writer.close();
+
+  trace::TraceReader reader;
+  check(reader.open(path), "Open", 0);
+  if(!reader.is_open())
+    return;
+
+  check(reader.closed(), "Closed", 0);
+  check(reader.dropped() == 0, "Dropped", reader.dropped());
+  check(reader.count() == NUM_MSGS * NUM_CONTROLLERS, "Count", reader.count());
+
+  struct stat st;
+  check(::stat(path.c_str(), &st) == 0 && uint64_t(st.st_size) ==
+        sizeof(trace::Header) + reader.count() * sizeof(trace::Record), "Trimmed", 0);
+
+  // Records of message n: the three receivers in controller order, at the
+  // same bit, then the transmitter when TX_DONE is seen
+  uint64_t prev_ns = 0;
+  for(uint64_t r = 0; r < reader.count(); r++) {
+    const trace::Record& rec = reader[r];
+    const unsigned int n = r / NUM_CONTROLLERS;
+    const bool tx = r % NUM_CONTROLLERS == NUM_CONTROLLERS - 1;
+
+    if(n >= NUM_MSGS)
+      break;
+
+    check(compare_messages(trace::to_msg(rec), sent[n]), "Message", r);
+    check(bool(rec.flags & trace::FLAG_TX) == tx, "Direction", r);
+    check(!tx || rec.controller == n % NUM_CONTROLLERS, "Transmitter", r);
+    check(tx || rec.controller != n % NUM_CONTROLLERS, "Receiver", r);
+    check(rec.time_ns >= prev_ns, "Time", r);
+    check(rec.timestamp != 0, "Timestamp", r);
+    prev_ns = rec.time_ns;
+  }
+
+  printf("Simulated bus: %llu records\n", (unsigned long long)reader.count());
+}
+
+static trace::Record live_record(uint64_t index)
+{
+  trace::Record rec = {};
+  rec.time_ns = index * 1000;
+  rec.timestamp = uint32_t(index * 7);
+  rec.arb_id = uint32_t(index % 2048);
+  rec.controller = index % 4;
+  rec.data_length = index % 9;
+  for(unsigned int i = 0; i < 8; i++)
+    rec.payload[i] = uint8_t(index >> (i * 8));
+  return rec;
+}
+
+// A reader follows the trace, with its own mapping, while the writer
+// appends as fast as it can past the capacity. It must see every record,
+// in order, and never a partial one.
+static void check_live(const std::string& path)
+{
+  constexpr uint64_t CAPACITY = 4000000;
+  constexpr uint64_t NUM_RECORDS = 5000000;
+
+  trace::TraceWriter writer;
+  check(writer.create(path, CAPACITY), "Create live", 0);
+
+  trace::TraceReader reader;
+  check(reader.open(path), "Open live", 0);
+  if(!writer.is_open() || !reader.is_open())
+    return;
+
+  std::thread thread([&writer]() {
+    for(uint64_t n = 0; n < NUM_RECORDS; n++)
+      writer.append(live_record(n));
+    writer.close();
+  });
+
+  uint64_t read = 0;
+  uint64_t polls = 0;
+  uint64_t bad = 0;
+  for(;;) {
+    const bool closed = reader.closed();
+    const uint64_t count = reader.count();
+
+    for(; read < count; read++) {
+      const trace::Record expected = live_record(read);
+      if(std::memcmp(&reader[read], &expected, sizeof(trace::Record)) != 0)
+        bad++;
+    }
+
+    polls++;
+    if(closed)
+      break;
+  }
+  thread.join();
+
+  printf("Live: %llu records read in %llu polls while writing\n", (unsigned long long)read,
+         (unsigned long long)polls);
+  check(bad == 0, "Partial record", bad);
+  check(read == CAPACITY, "Read", read);
+  check(reader.dropped() == NUM_RECORDS - CAPACITY, "Dropped", reader.dropped());
+}
+
+static void check_format()
+{
+  std::mt19937 rng(2);
+
+  for(unsigned int n = 0; n < 10000; n++) {
+    const CanMsg msg = random_msg(rng);
+    const trace::Record rec = trace::to_record(n % 4, n % 2, msg, n, n);
+    const CanMsg back = trace::to_msg(rec);
+
+    check(compare_messages(msg, back) && back.timestamp == n, "Round trip", n);
+    check(rec.controller == n % 4 && bool(rec.flags & trace::FLAG_TX) == bool(n % 2),
+          "Controller and direction", n);
+  }
+
+  trace::TraceReader reader;
+  check(!reader.open("/dev/null"), "Open empty file", 0);
+}
+
+static int run_check()
+{
+  const std::string path = temp_path();
+
+  check_format();
+  check_sim(path);
+  check_live(path);
+  ::unlink(path.c_str());
+
+  printf("%s (%u errors)\n", g_errors == 0 ? "OK" : "FAILED", g_errors);
+  return g_errors == 0 ? 0 : 1;
+}
+
+//-----------------------------------------------------------------------------
+// Bench
+//-----------------------------------------------------------------------------
+static void run_bench(uint64_t num_records)
+{
+  const std::string path = temp_path();
+  std::mt19937 rng(3);
+  std::vector<CanMsg> msgs(1024);
+
+  for(CanMsg& msg : msgs)
+    msg = random_msg(rng);
+
+  trace::TraceWriter writer;
+  if(!writer.create(path, num_records)) {
+    printf("Could not create %s\n", path.c_str());
+    return;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  for(uint64_t n = 0; n < num_records; n++)
+    writer.rx(n % 4, msgs[n % msgs.size()]);
+  const double append_seconds =
+    std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  writer.close();
+  ::unlink(path.c_str());
+
+  // The same frames formatted as text, which is the least a log over a
+  // UART or to a file would cost before it is written anywhere
+  const uint64_t num_lines = num_records / 10 + 1;
+  char line[128];
+  size_t bytes = 0;
+  start = std::chrono::steady_clock::now();
+  for(uint64_t n = 0; n < num_lines; n++)
+    bytes += format_record(line, sizeof(line), trace::to_record(n % 4, false, msgs[n % msgs.size()],
+                                                                 0, n), 0);
+  const double format_seconds =
+    std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  printf("Append record (with clock):  %8.1f ns  (%.1f M records/s)\n",
+         1e9 * append_seconds / num_records, 1e-6 * num_records / append_seconds);
+  printf("Format record as text:       %8.1f ns  (%zu bytes)\n", 1e9 * format_seconds / num_lines,
+         bytes / num_lines);
+}
+
+//-----------------------------------------------------------------------------
+// Recorder and readers
+//-----------------------------------------------------------------------------
+static int run_record(const char* path, uint64_t capacity, int num_devs, char** devs)
+{
+  std::vector<std::unique_ptr<UioDevice>> uio;
+  std::vector<Canola<MmapIO>> drivers;
+  UioPoller poller;
+
+  drivers.reserve(num_devs);
+  for(int i = 0; i < num_devs; i++) {
+    uio.emplace_back(new UioDevice());
+    if(!uio.back()->open(devs[i], "", "") || !poller.add(*uio.back(), i)) {
+      printf("Could not open %s\n", devs[i]);
+      return 1;
+    }
+    drivers.emplace_back(uio.back()->io());
+    drivers.back().set_rx_fifo_enable(true);
+    drivers.back().set_rx_timestamp_enable(true);
+  }
+
+  trace::TraceWriter writer;
+  if(!writer.create(path, capacity)) {
+    printf("Could not create %s\n", path);
+    return 1;
+  }
+
+  std::signal(SIGINT, on_signal);
+  std::signal(SIGTERM, on_signal);
+
+  UioPoller::Event events[16];
+  bool overflow = false;
+  uint64_t overflows = 0;
+
+  while(!g_stop) {
+    const int n = poller.wait(events, 16, 200);
+
+    for(int i = 0; i < n; i++) {
+      const unsigned int dev = events[i].dev_index;
+      if(events[i].irq != Irq::RX_VALID)
+        continue;
+
+      const uint64_t time_ns = trace::now_ns();
+      drivers[dev].drain([&](const CanMsg& msg) { writer.rx(dev, msg, time_ns); }, &overflow);
+      overflows += overflow;
+    }
+  }
+
+  printf("%llu records, %llu dropped (trace full), %llu Rx FIFO overflows\n",
+         (unsigned long long)writer.count(), (unsigned long long)writer.dropped(),
+         (unsigned long long)overflows);
+  return 0;
+}
+
+static int run_print(const char* path, bool follow)
+{
+  trace::TraceReader reader;
+
+  // The writer may not have created the file yet
+  while(!reader.open(path)) {
+    if(!follow || g_stop) {
+      printf("Could not open %s\n", path);
+      return 1;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+
+  std::signal(SIGINT, on_signal);
+  std::signal(SIGTERM, on_signal);
+
+  char line[128];
+  uint64_t read = 0;
+  for(;;) {
+    const bool closed = !follow || reader.closed();
+    const uint64_t count = reader.count();
+
+    for(; read < count; read++) {
+      format_record(line, sizeof(line), reader[read], reader.start_time_ns());
+      puts(line);
+    }
+
+    if(closed || g_stop)
+      break;
+
+    fflush(stdout);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  if(reader.dropped() > 0)
+    printf("%llu records dropped (trace full)\n", (unsigned long long)reader.dropped());
+  return 0;
+}
+
+int main(int argc, char** argv)
+{
+  const char* mode = argc > 1 ? argv[1] : "check";
+
+  if(strcmp(mode, "check") == 0) {
+    return run_check();
+  } else if(strcmp(mode, "bench") == 0) {
+    run_bench(argc > 2 ? strtoull(argv[2], nullptr, 0) : 10000000);
+    return 0;
+  } else if(strcmp(mode, "record") == 0 && argc > 4) {
+    return run_record(argv[2], strtoull(argv[3], nullptr, 0), argc - 4, argv + 4);
+  } else if(strcmp(mode, "follow") == 0 && argc > 2) {
+    return run_print(argv[2], true);
+  } else if(strcmp(mode, "dump") == 0 && argc > 2) {
+    return run_print(argv[2], false);
+  }
+
+  printf("Usage: %s check|bench [records]|record <file> <capacity> <uio device>...|"
+         "follow <file>|dump <file>\n", argv[0]);
+  return 1;
+}
@@ -0,0 +1,285 @@
+/**
+ * @file   canola_uio.cpp
+ * @author Simon Voigt Nesbo
+ * @date   October 16, 2026
+ * @brief  Checks the UIO support in canola_uio.hpp with FakeUio devices.
+ *
+ *         check:  Register writes and reads through the mapping of a
+ *                 UioDevice are seen on the other side of the FakeUio
+ *                 (directly and through the C++ driver), raise() makes
+ *                 UioPoller::wait() return the right controller and
+ *                 interrupt, an event is only returned once and the
+ *                 interrupt fires again after it (re-arm), a failed add()
+ *                 leaves no interrupt lines behind in the poller, and a
+ *                 poller without an epoll instance fails cleanly.
+ *
+ *         Build: g++ -std=c++14 -O2 -I.. canola_uio.cpp -o canola_uio
+ */
+
+#include "canola_uio.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+
+using namespace canola;
+
+static unsigned int g_errors = 0;
+
+static void check(bool ok, const char* what, uint64_t index)
+{
+  if(!ok) {
+    if(g_errors < 10)
+      printf("%s (%llu)\n", what, (unsigned long long)index);
+    g_errors++;
+  }
+}
+
+static const Irq IRQS[NUM_IRQS] = {Irq::RX_VALID, Irq::TX_DONE, Irq::TX_FAILED};
+
+static CanMsg random_msg(std::mt19937& rng)
+{
+  CanMsg msg = CanMsg{};
+
+  msg.ext_id = rng() % 2;
+  msg.arb_id_a = rng() % 2048;
+  msg.arb_id_b = msg.ext_id ? rng() % 262144 : 0;
+  msg.remote_frame = rng() % 2;
+  msg.data_length = rng() % 9;
+
+  for(unsigned int i = 0; i < msg.data_length && !msg.remote_frame; i++)
+    msg.payload[i] = rng();
+
+  return msg;
+}
+
+// A set of fake controllers, opened as UioDevices and added to a poller
+struct FakeControllers {
+  std::vector<std::unique_ptr<FakeUio>> fakes;
+  std::vector<std::unique_ptr<UioDevice>> devs;
+
+  explicit FakeControllers(unsigned int num)
+  {
+    for(unsigned int i = 0; i < num; i++) {
+      fakes.emplace_back(new FakeUio());
+      devs.emplace_back(new UioDevice());
+      check(fakes.back()->is_open(), "FakeUio not open", i);
+      check(fakes.back()->device(*devs.back()), "Could not open UioDevice", i);
+    }
+  }
+};
+
+// Collect events until none are left, returns the number of events
+static int wait_all(UioPoller& poller, std::vector<UioPoller::Event>& events, int timeout_ms)
+{
+  UioPoller::Event buf[16];
+  int total = 0;
+
+  events.clear();
+  while(true) {
+    const int n = poller.wait(buf, 16, total == 0 ? timeout_ms : 0);
+    if(n <= 0)
+      return n < 0 ? n : total;
+
+    events.insert(events.end(), buf, buf + n);
+    total += n;
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Register access through the mapping
+//-----------------------------------------------------------------------------
+static void check_registers()
+{
+  FakeControllers ctrls(2);
+  std::mt19937 rng(1);
+
+  // Raw words over the whole mapping, both ways
+  for(unsigned int dev = 0; dev < 2; dev++) {
+    MmapIO uio = ctrls.devs[dev]->io();
+    MmapIO hw = ctrls.fakes[dev]->regs();
+
+    for(uint32_t offset = 0; offset < UioDevice::DEFAULT_MAP_SIZE; offset += 4) {
+      const uint32_t value = rng();
+      uio.write(offset, value);
+      check(hw.read(offset) == value, "UioDevice write not seen by FakeUio", offset);
+
+      hw.write(offset, ~value);
+      check(uio.read(offset) == ~value, "FakeUio write not seen by UioDevice", offset);
+    }
+  }
+
+  // The two controllers must not share register space
+  ctrls.devs[0]->io().write(reg::CONFIG::address, 0x11);
+  ctrls.devs[1]->io().write(reg::CONFIG::address, 0x22);
+  check(ctrls.fakes[0]->regs().read(reg::CONFIG::address) == 0x11, "Register spaces shared", 0);
+
+  // Messages through the driver, the "hardware" copies the TX registers to
+  // the RX registers like a loopback
+  Canola<MmapIO> driver(ctrls.devs[0]->io());
+  MmapIO hw = ctrls.fakes[0]->regs();
+
+  for(unsigned int i = 0; i < 1000; i++) {
+    const CanMsg msg = random_msg(rng);
+
+    driver.send_msg(msg);
+    hw.write(reg::RX_MSG_ID::address, hw.read(reg::TX_MSG_ID::address));
+    hw.write(reg::RX_PAYLOAD_LENGTH::address, hw.read(reg::TX_PAYLOAD_LENGTH::address));
+    hw.write(reg::RX_PAYLOAD_0::address, hw.read(reg::TX_PAYLOAD_0::address));
+    hw.write(reg::RX_PAYLOAD_1::address, hw.read(reg::TX_PAYLOAD_1::address));
+
+    check(compare_messages(driver.get_msg(), msg), "Message through mapping", i);
+  }
+
+  printf("  %-40s %s\n", "Register access", g_errors == 0 ? "ok" : "FAILED");
+}
+
+//-----------------------------------------------------------------------------
+// raise() -> wait(), and re-arm
+//-----------------------------------------------------------------------------
+static void check_events()
+{
+  constexpr unsigned int NUM_CTRLS = 4;
+  constexpr unsigned int DEV_INDEX_BASE = 10;
+
+  const unsigned int errors = g_errors;
+  FakeControllers ctrls(NUM_CTRLS);
+  UioPoller poller;
+  std::vector<UioPoller::Event> events;
+  std::mt19937 rng(2);
+
+  check(poller.is_open(), "Poller not open", 0);
+  for(unsigned int dev = 0; dev < NUM_CTRLS; dev++)
+    check(poller.add(*ctrls.devs[dev], DEV_INDEX_BASE + dev), "Could not add device", dev);
+
+  check(wait_all(poller, events, 0) == 0, "Event before any interrupt", 0);
+
+  // One interrupt at a time
+  for(unsigned int i = 0; i < 1000; i++) {
+    const unsigned int dev = rng() % NUM_CTRLS;
+    const Irq irq = IRQS[rng() % NUM_IRQS];
+
+    check(ctrls.fakes[dev]->raise(irq), "raise() failed", i);
+    check(wait_all(poller, events, 1000) == 1, "Not one event for one interrupt", i);
+
+    if(events.size() == 1) {
+      check(events[0].dev_index == DEV_INDEX_BASE + dev, "Wrong dev_index", i);
+      check(events[0].irq == irq, "Wrong irq", i);
+    }
+  }
+
+  // Several interrupts on several controllers at once, each line is
+  // reported once however many times it was raised
+  for(unsigned int i = 0; i < 1000; i++) {
+    bool raised[NUM_CTRLS][NUM_IRQS] = {};
+    unsigned int num_raised = 0;
+
+    for(unsigned int j = rng() % 16; j > 0; j--) {
+      const unsigned int dev = rng() % NUM_CTRLS;
+      const unsigned int irq = rng() % NUM_IRQS;
+
+      ctrls.fakes[dev]->raise(IRQS[irq]);
+      num_raised += !raised[dev][irq];
+      raised[dev][irq] = true;
+    }
+
+    check(wait_all(poller, events, num_raised ? 1000 : 0) == int(num_raised),
+          "Wrong number of events", i);
+
+    for(const UioPoller::Event& ev : events) {
+      const unsigned int dev = ev.dev_index - DEV_INDEX_BASE;
+      const unsigned int irq = static_cast<unsigned int>(ev.irq);
+      const bool valid = dev < NUM_CTRLS && irq < NUM_IRQS;
+
+      check(valid && raised[dev][irq], "Event for interrupt that was not raised", i);
+      if(valid)
+        raised[dev][irq] = false;
+    }
+  }
+
+  // Re-arm: an acknowledged event is not returned again, and the same line
+  // fires again on the next interrupt
+  for(unsigned int i = 0; i < 1000; i++) {
+    const unsigned int dev = i % NUM_CTRLS;
+    const Irq irq = IRQS[i % NUM_IRQS];
+
+    ctrls.fakes[dev]->raise(irq);
+    check(wait_all(poller, events, 1000) == 1, "No event after re-arm", i);
+    check(wait_all(poller, events, 0) == 0, "Event returned twice", i);
+    check(ctrls.devs[dev]->irq(irq).acknowledge() < 0, "Event not acknowledged", i);
+  }
+
+  printf("  %-40s %s\n", "Interrupts and re-arm", g_errors == errors ? "ok" : "FAILED");
+}
+
+//-----------------------------------------------------------------------------
+// Error handling
+//-----------------------------------------------------------------------------
+static void check_errors()
+{
+  const unsigned int errors = g_errors;
+  FakeControllers ctrls(2);
+  UioPoller poller;
+  std::vector<UioPoller::Event> events;
+
+  check(poller.add(*ctrls.devs[0], 0), "Could not add device", 0);
+
+  // Regular files can not be polled, so adding the TX_DONE line of the
+  // second controller fails after its RX_VALID line was added
+  char name[] = "/tmp/canola_uio_check_XXXXXX";
+  const int file_fd = ::mkstemp(name);
+  check(file_fd >= 0, "Could not create file", 0);
+  ::unlink(name);
+
+  ctrls.devs[1]->irq(Irq::TX_DONE) = IrqSource(file_fd, IrqSource::Kind::EVENTFD);
+  check(!poller.add(*ctrls.devs[1], 1), "add() did not fail", 1);
+
+  ctrls.fakes[1]->raise(Irq::RX_VALID);
+  check(wait_all(poller, events, 10) == 0, "Line left in poller after failed add()", 1);
+
+  ctrls.fakes[0]->raise(Irq::TX_FAILED);
+  check(wait_all(poller, events, 1000) == 1 && events[0].dev_index == 0 &&
+        events[0].irq == Irq::TX_FAILED, "Poller broken after failed add()", 0);
+
+  // No file descriptors left for the epoll instance
+  struct rlimit limit;
+  ::getrlimit(RLIMIT_NOFILE, &limit);
+
+  struct rlimit no_files = limit;
+  no_files.rlim_cur = 0;
+  ::setrlimit(RLIMIT_NOFILE, &no_files);
+  UioPoller closed_poller;
+  ::setrlimit(RLIMIT_NOFILE, &limit);
+
+  UioPoller::Event event;
+  check(!closed_poller.is_open(), "Poller open without file descriptors", 0);
+  check(!closed_poller.add(*ctrls.devs[0], 0), "add() to poller that is not open", 0);
+  check(closed_poller.wait(&event, 1, 0) == -1, "wait() on poller that is not open", 0);
+
+  printf("  %-40s %s\n", "Error handling", g_errors == errors ? "ok" : "FAILED");
+}
+
+static int run_check()
+{
+  check_registers();
+  check_events();
+  check_errors();
+
+  printf("%s (%u errors)\n", g_errors == 0 ? "OK" : "FAILED", g_errors);
+  return g_errors == 0 ? 0 : 1;
+}
+
+int main(int argc, char** argv)
+{
+  const std::string mode = argc > 1 ? argv[1] : "";
+
+  if(mode == "check")
+    return run_check();
+
+  printf("Usage: %s check\n", argv[0]);
+  return 1;
+}
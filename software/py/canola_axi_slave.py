@@ -106,6 +106,36 @@ class CANOLA_AXI_SLAVE_H:
     CONTROL_RESET_RX_STUFF_ERROR_COUNTER_RESET = 0x0
     CONTROL_RESET_RX_STUFF_ERROR_COUNTER_MASK = 0x400
 
+    """ Field: FILTER_WRITE """
+    CONTROL_FILTER_WRITE_OFFSET = 11
+    CONTROL_FILTER_WRITE_WIDTH = 1
+    CONTROL_FILTER_WRITE_RESET = 0x0
+    CONTROL_FILTER_WRITE_MASK = 0x800
+
+    """ Field: RX_FIFO_POP """
+    CONTROL_RX_FIFO_POP_OFFSET = 12
+    CONTROL_RX_FIFO_POP_WIDTH = 1
+    CONTROL_RX_FIFO_POP_RESET = 0x0
+    CONTROL_RX_FIFO_POP_MASK = 0x1000
+
+    """ Field: RX_FIFO_FLUSH """
+    CONTROL_RX_FIFO_FLUSH_OFFSET = 13
+    CONTROL_RX_FIFO_FLUSH_WIDTH = 1
+    CONTROL_RX_FIFO_FLUSH_RESET = 0x0
+    CONTROL_RX_FIFO_FLUSH_MASK = 0x2000
+
+    """ Field: RX_FIFO_CLEAR_OVERFLOW """
+    CONTROL_RX_FIFO_CLEAR_OVERFLOW_OFFSET = 14
+    CONTROL_RX_FIFO_CLEAR_OVERFLOW_WIDTH = 1
+    CONTROL_RX_FIFO_CLEAR_OVERFLOW_RESET = 0x0
+    CONTROL_RX_FIFO_CLEAR_OVERFLOW_MASK = 0x4000
+
+    """ Field: TX_MAILBOX_LOAD """
+    CONTROL_TX_MAILBOX_LOAD_OFFSET = 15
+    CONTROL_TX_MAILBOX_LOAD_WIDTH = 1
+    CONTROL_TX_MAILBOX_LOAD_RESET = 0x0
+    CONTROL_TX_MAILBOX_LOAD_MASK = 0x8000
+
     """ Register: CONFIG """
     CONFIG_OFFSET = 0x8
     CONFIG_RESET = 0x0
@@ -122,6 +152,24 @@ class CANOLA_AXI_SLAVE_H:
     CONFIG_BTL_TRIPLE_SAMPLING_EN_RESET = 0x0
     CONFIG_BTL_TRIPLE_SAMPLING_EN_MASK = 0x2
 
+    """ Field: ACCEPTANCE_FILTER_EN """
+    CONFIG_ACCEPTANCE_FILTER_EN_OFFSET = 2
+    CONFIG_ACCEPTANCE_FILTER_EN_WIDTH = 1
+    CONFIG_ACCEPTANCE_FILTER_EN_RESET = 0x0
+    CONFIG_ACCEPTANCE_FILTER_EN_MASK = 0x4
+
+    """ Field: RX_FIFO_EN """
+    CONFIG_RX_FIFO_EN_OFFSET = 3
+    CONFIG_RX_FIFO_EN_WIDTH = 1
+    CONFIG_RX_FIFO_EN_RESET = 0x0
+    CONFIG_RX_FIFO_EN_MASK = 0x8
+
+    """ Field: TX_MAILBOX_EN """
+    CONFIG_TX_MAILBOX_EN_OFFSET = 4
+    CONFIG_TX_MAILBOX_EN_WIDTH = 1
+    CONFIG_TX_MAILBOX_EN_RESET = 0x0
+    CONFIG_TX_MAILBOX_EN_MASK = 0x10
+
     """ Register: BTL_PROP_SEG """
     BTL_PROP_SEG_OFFSET = 0x20
     BTL_PROP_SEG_RESET = 0x7
@@ -366,3 +414,141 @@ class CANOLA_AXI_SLAVE_H:
     RX_PAYLOAD_1_PAYLOAD_BYTE_7_RESET = 0x0
     RX_PAYLOAD_1_PAYLOAD_BYTE_7_MASK = 0xff000000
 
+    """ Register: FILTER_INDEX """
+    FILTER_INDEX_OFFSET = 0x84
+    FILTER_INDEX_RESET = 0x0
+
+    """ Register: FILTER_ID """
+    FILTER_ID_OFFSET = 0x88
+    FILTER_ID_RESET = 0x0
+
+    """ Field: EXT_ID_EN """
+    FILTER_ID_EXT_ID_EN_OFFSET = 0
+    FILTER_ID_EXT_ID_EN_WIDTH = 1
+    FILTER_ID_EXT_ID_EN_RESET = 0x0
+    FILTER_ID_EXT_ID_EN_MASK = 0x1
+
+    """ Field: RTR_EN """
+    FILTER_ID_RTR_EN_OFFSET = 1
+    FILTER_ID_RTR_EN_WIDTH = 1
+    FILTER_ID_RTR_EN_RESET = 0x0
+    FILTER_ID_RTR_EN_MASK = 0x2
+
+    """ Field: ARB_ID_B """
+    FILTER_ID_ARB_ID_B_OFFSET = 2
+    FILTER_ID_ARB_ID_B_WIDTH = 18
+    FILTER_ID_ARB_ID_B_RESET = 0x0
+    FILTER_ID_ARB_ID_B_MASK = 0xffffc
+
+    """ Field: ARB_ID_A """
+    FILTER_ID_ARB_ID_A_OFFSET = 20
+    FILTER_ID_ARB_ID_A_WIDTH = 11
+    FILTER_ID_ARB_ID_A_RESET = 0x0
+    FILTER_ID_ARB_ID_A_MASK = 0x7ff00000
+
+    """ Field: ENABLE """
+    FILTER_ID_ENABLE_OFFSET = 31
+    FILTER_ID_ENABLE_WIDTH = 1
+    FILTER_ID_ENABLE_RESET = 0x0
+    FILTER_ID_ENABLE_MASK = 0x80000000
+
+    """ Register: FILTER_MASK """
+    FILTER_MASK_OFFSET = 0x8c
+    FILTER_MASK_RESET = 0x0
+
+    """ Field: EXT_ID_EN """
+    FILTER_MASK_EXT_ID_EN_OFFSET = 0
+    FILTER_MASK_EXT_ID_EN_WIDTH = 1
+    FILTER_MASK_EXT_ID_EN_RESET = 0x0
+    FILTER_MASK_EXT_ID_EN_MASK = 0x1
+
+    """ Field: RTR_EN """
+    FILTER_MASK_RTR_EN_OFFSET = 1
+    FILTER_MASK_RTR_EN_WIDTH = 1
+    FILTER_MASK_RTR_EN_RESET = 0x0
+    FILTER_MASK_RTR_EN_MASK = 0x2
+
+    """ Field: ARB_ID_B """
+    FILTER_MASK_ARB_ID_B_OFFSET = 2
+    FILTER_MASK_ARB_ID_B_WIDTH = 18
+    FILTER_MASK_ARB_ID_B_RESET = 0x0
+    FILTER_MASK_ARB_ID_B_MASK = 0xffffc
+
+    """ Field: ARB_ID_A """
+    FILTER_MASK_ARB_ID_A_OFFSET = 20
+    FILTER_MASK_ARB_ID_A_WIDTH = 11
+    FILTER_MASK_ARB_ID_A_RESET = 0x0
+    FILTER_MASK_ARB_ID_A_MASK = 0x7ff00000
+
+    """ Register: RX_FILTER_HIT """
+    RX_FILTER_HIT_OFFSET = 0x90
+    RX_FILTER_HIT_RESET = 0x0
+
+    """ Register: RX_FIFO_STATUS """
+    RX_FIFO_STATUS_OFFSET = 0x94
+    RX_FIFO_STATUS_RESET = 0x0
+
+    """ Field: FILL_LEVEL """
+    RX_FIFO_STATUS_FILL_LEVEL_OFFSET = 0
+    RX_FIFO_STATUS_FILL_LEVEL_WIDTH = 9
+    RX_FIFO_STATUS_FILL_LEVEL_RESET = 0x0
+    RX_FIFO_STATUS_FILL_LEVEL_MASK = 0x1ff
+
+    """ Field: EMPTY """
+    RX_FIFO_STATUS_EMPTY_OFFSET = 9
+    RX_FIFO_STATUS_EMPTY_WIDTH = 1
+    RX_FIFO_STATUS_EMPTY_RESET = 0x0
+    RX_FIFO_STATUS_EMPTY_MASK = 0x200
+
+    """ Field: FULL """
+    RX_FIFO_STATUS_FULL_OFFSET = 10
+    RX_FIFO_STATUS_FULL_WIDTH = 1
+    RX_FIFO_STATUS_FULL_RESET = 0x0
+    RX_FIFO_STATUS_FULL_MASK = 0x400
+
+    """ Field: OVERFLOW """
+    RX_FIFO_STATUS_OVERFLOW_OFFSET = 11
+    RX_FIFO_STATUS_OVERFLOW_WIDTH = 1
+    RX_FIFO_STATUS_OVERFLOW_RESET = 0x0
+    RX_FIFO_STATUS_OVERFLOW_MASK = 0x800
+
+    """ Register: RX_FIFO_IRQ_LEVEL """
+    RX_FIFO_IRQ_LEVEL_OFFSET = 0x98
+    RX_FIFO_IRQ_LEVEL_RESET = 0x1
+
+    """ Register: TX_MAILBOX_INDEX """
+    TX_MAILBOX_INDEX_OFFSET = 0x9c
+    TX_MAILBOX_INDEX_RESET = 0x0
+
+    """ Register: TX_MAILBOX_ABORT """
+    TX_MAILBOX_ABORT_OFFSET = 0xa0
+    TX_MAILBOX_ABORT_RESET = 0x0
+
+    """ Register: TX_MAILBOX_PENDING """
+    TX_MAILBOX_PENDING_OFFSET = 0xa4
+    TX_MAILBOX_PENDING_RESET = 0x0
+
+    """ Register: TX_MAILBOX_DONE """
+    TX_MAILBOX_DONE_OFFSET = 0xa8
+    TX_MAILBOX_DONE_RESET = 0x0
+
+    """ Register: TX_MAILBOX_FAILED """
+    TX_MAILBOX_FAILED_OFFSET = 0xac
+    TX_MAILBOX_FAILED_RESET = 0x0
+
+    """ Register: TX_MAILBOX_COUNT """
+    TX_MAILBOX_COUNT_OFFSET = 0xb0
+    TX_MAILBOX_COUNT_RESET = 0x0
+
+    """ Register: TIMESTAMP """
+    TIMESTAMP_OFFSET = 0xb4
+    TIMESTAMP_RESET = 0x0
+
+    """ Register: RX_TIMESTAMP """
+    RX_TIMESTAMP_OFFSET = 0xb8
+    RX_TIMESTAMP_RESET = 0x0
+
+    """ Register: TX_TIMESTAMP """
+    TX_TIMESTAMP_OFFSET = 0xbc
+    TX_TIMESTAMP_RESET = 0x0
+
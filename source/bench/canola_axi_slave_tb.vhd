@@ -6,7 +6,7 @@
 -- Author     : Simon Voigt Nesbo (svn@hvl.no)
 -- Company    : Western Norway University of Applied Sciences
 -- Created    : 2019-12-17
--- Last update: 2020-08-26
+-- Last update: 2026-10-16
 -- Platform   :
 -- Target     :
 -- Standard   : VHDL'08
@@ -19,6 +19,11 @@
 -- Revisions  :
 -- Date        Version  Author                  Description
 -- 2019-12-17  1.0      svn                     Created
+-- 2026-10-16  1.1      svn                     Test acceptance filters
+-- 2026-10-16  1.2      svn                     Test Rx FIFO
+-- 2026-10-16  1.3      svn                     Test Tx mailboxes
+-- 2026-10-16  1.4      svn                     Test timestamps
+-- 2026-10-16  1.5      svn                     Test Tx mailbox abort at retransmit
 -------------------------------------------------------------------------------
 
 use std.textio.all;
@@ -68,6 +73,17 @@ architecture tb of canola_axi_slave_tb is
 
   constant C_BUS_REG_WIDTH : natural := 32;
 
+  -- Number of messages sent back-to-back when testing the Rx FIFO,
+  -- one more than fits in the FIFO to test overflow
+  constant C_RX_FIFO_TEST_MSGS  : natural := C_RX_FIFO_DEPTH_DEFAULT+1;
+  constant C_RX_FIFO_IRQ_LEVEL  : natural := 4;
+
+  -- Number of Tx mailboxes loaded when testing the send order
+  constant C_TX_MAILBOX_TEST_MSGS : natural := 4;
+
+  -- Max number of register reads while waiting for a Tx mailbox to fail
+  constant C_TX_MAILBOX_POLL_MAX : natural := 100000;
+
   -- Generate a clock with a given period,
   -- based on clock_gen from Bitvis IRQC testbench
   procedure clock_gen(
@@ -129,6 +145,15 @@ architecture tb of canola_axi_slave_tb is
   -- Shared CAN bus signal
   signal s_can_bus_signal    : std_logic;
 
+  -- p_arb_lost pulls the bus dominant for the first ID bit of the next frame
+  -- from the controller after s_arb_lost_en is set, so it loses arbitration
+  signal s_arb_lost_en       : std_logic := '0';
+  signal s_arb_lost_tx       : std_logic := '1';
+
+  -- Set by p_tx_mailbox_reload when the Tx FSM decided to retransmit in the
+  -- cycle after the selected Tx mailbox was aborted
+  signal s_abort_at_retransmit : std_logic := '0';
+
   -- Used by p_can_ctrl_irq which monitors interrupts
   -- from the CAN controller and sets these persistent flags
   signal s_got_rx_valid_irq  : std_logic := '0';
@@ -180,6 +205,7 @@ begin
   s_can_bus_signal <= 'H';
   s_can_bus_signal <= '0' when s_can_ctrl_tx = '0' else 'Z';
   s_can_bus_signal <= '0' when s_can_bfm_tx  = '0' else 'Z';
+  s_can_bus_signal <= '0' when s_arb_lost_tx = '0' else 'Z';
   s_can_ctrl_rx    <= '1' ?= s_can_bus_signal;
   s_can_bfm_rx     <= '1' ?= s_can_bus_signal;
 
@@ -237,6 +263,33 @@ begin
         axi_rresp         => s_can_axi_rresp,
         axi_rvalid        => s_can_axi_rvalid,
         axi_rready        => s_can_axi_rready);
+
+    -- The Tx FSM decides to retransmit in the cycle before it pulses
+    -- TX_RETRANSMITTING, and reloads TX_MSG if TX_MSG_RELOAD is set then
+    p_tx_mailbox_reload : process (s_clk) is
+      alias a_tx_msg_reload is << signal .canola_axi_slave_tb.if_not_TMR_generate.INST_canola_axi_slave.INST_canola_tx_mailboxes.TX_MSG_RELOAD : std_logic >>;
+      alias a_tx_retransmitting is << signal .canola_axi_slave_tb.if_not_TMR_generate.INST_canola_axi_slave.INST_canola_tx_mailboxes.TX_RETRANSMITTING : std_logic >>;
+      alias a_settle is << signal .canola_axi_slave_tb.if_not_TMR_generate.INST_canola_axi_slave.INST_canola_tx_mailboxes.s_settle : std_logic >>;
+      alias a_best is << signal .canola_axi_slave_tb.if_not_TMR_generate.INST_canola_axi_slave.INST_canola_tx_mailboxes.s_best : natural >>;
+      alias a_best_valid is << signal .canola_axi_slave_tb.if_not_TMR_generate.INST_canola_axi_slave.INST_canola_tx_mailboxes.s_best_valid : std_logic >>;
+      alias a_abort_req is << signal .canola_axi_slave_tb.if_not_TMR_generate.INST_canola_axi_slave.INST_canola_tx_mailboxes.s_abort_req : std_logic_vector(0 to C_TX_MAILBOXES_DEFAULT-1) >>;
+
+      variable v_reload_aborted : boolean := false;
+      variable v_settle_aborted : boolean := false;
+    begin
+      if rising_edge(s_clk) then
+        if a_tx_retransmitting = '1' then
+          check_value(not v_reload_aborted, error,
+                      "Check that an aborted Tx mailbox is not reloaded for retransmission");
+          if v_settle_aborted then
+            s_abort_at_retransmit <= '1';
+          end if;
+        end if;
+
+        v_reload_aborted := a_tx_msg_reload = '1' and a_abort_req(a_best) = '1';
+        v_settle_aborted := a_settle = '1' and a_best_valid = '1' and a_abort_req(a_best) = '1';
+      end if;
+    end process p_tx_mailbox_reload;
   end generate if_not_TMR_generate;
 
   -----------------------------------------------------------------------------
@@ -275,9 +328,49 @@ begin
         axi_rresp               => s_can_axi_rresp,
         axi_rvalid              => s_can_axi_rvalid,
         axi_rready              => s_can_axi_rready);
+
+    -- The Tx FSM decides to retransmit in the cycle before it pulses
+    -- TX_RETRANSMITTING, and reloads TX_MSG if TX_MSG_RELOAD is set then
+    p_tx_mailbox_reload : process (s_clk) is
+      alias a_tx_msg_reload is << signal .canola_axi_slave_tb.if_TMR_generate.INST_canola_axi_slave_tmr.INST_canola_tx_mailboxes.TX_MSG_RELOAD : std_logic >>;
+      alias a_tx_retransmitting is << signal .canola_axi_slave_tb.if_TMR_generate.INST_canola_axi_slave_tmr.INST_canola_tx_mailboxes.TX_RETRANSMITTING : std_logic >>;
+      alias a_settle is << signal .canola_axi_slave_tb.if_TMR_generate.INST_canola_axi_slave_tmr.INST_canola_tx_mailboxes.s_settle : std_logic >>;
+      alias a_best is << signal .canola_axi_slave_tb.if_TMR_generate.INST_canola_axi_slave_tmr.INST_canola_tx_mailboxes.s_best : natural >>;
+      alias a_best_valid is << signal .canola_axi_slave_tb.if_TMR_generate.INST_canola_axi_slave_tmr.INST_canola_tx_mailboxes.s_best_valid : std_logic >>;
+      alias a_abort_req is << signal .canola_axi_slave_tb.if_TMR_generate.INST_canola_axi_slave_tmr.INST_canola_tx_mailboxes.s_abort_req : std_logic_vector(0 to C_TX_MAILBOXES_DEFAULT-1) >>;
+
+      variable v_reload_aborted : boolean := false;
+      variable v_settle_aborted : boolean := false;
+    begin
+      if rising_edge(s_clk) then
+        if a_tx_retransmitting = '1' then
+          check_value(not v_reload_aborted, error,
+                      "Check that an aborted Tx mailbox is not reloaded for retransmission");
+          if v_settle_aborted then
+            s_abort_at_retransmit <= '1';
+          end if;
+        end if;
+
+        v_reload_aborted := a_tx_msg_reload = '1' and a_abort_req(a_best) = '1';
+        v_settle_aborted := a_settle = '1' and a_best_valid = '1' and a_abort_req(a_best) = '1';
+      end if;
+    end process p_tx_mailbox_reload;
   end generate if_TMR_generate;
 
 
+  -- Make the controller lose arbitration in the first ID bit of its next
+  -- frame, which must be recessive
+  p_arb_lost : process is
+  begin
+    wait until s_arb_lost_en = '1';
+    wait until falling_edge(s_can_ctrl_tx);
+    wait for C_CAN_BAUD_PERIOD;
+    s_arb_lost_tx <= '0';
+    wait for C_CAN_BAUD_PERIOD;
+    s_arb_lost_tx <= '1';
+  end process p_arb_lost;
+
+
   -- Monitor CAN controller interrupts and set persistent flags
   p_can_ctrl_irq : process (s_can_rx_valid_irq, s_can_tx_done_irq,
                             s_can_tx_failed_irq, s_irq_reset) is
@@ -334,6 +427,8 @@ begin
     variable v_rx_form_error_count  : std_logic_vector(C_BUS_REG_WIDTH-1 downto 0);
     variable v_rx_stuff_error_count : std_logic_vector(C_BUS_REG_WIDTH-1 downto 0);
     variable v_receive_error_count  : unsigned(C_ERROR_COUNT_LENGTH-1 downto 0);
+    variable v_retransmit_count_load : std_logic_vector(C_BUS_REG_WIDTH-1 downto 0);
+    variable v_retransmit_count_fail : std_logic_vector(C_BUS_REG_WIDTH-1 downto 0);
 
     variable v_rand_baud_delay : natural;
     variable v_rand_real       : real;
@@ -397,6 +492,48 @@ begin
     variable v_count       : natural;
     variable v_test_num    : natural;
     variable v_data_length : natural;
+    variable v_accept_count : natural;
+    variable v_expect_accept : boolean;
+
+    type t_xmit_msg is record
+      arb_id       : std_logic_vector(28 downto 0);
+      ext_id       : std_logic;
+      remote_frame : std_logic;
+      data         : work.can_bfm_pkg.can_payload_t;
+      data_length  : natural;
+    end record t_xmit_msg;
+
+    type t_xmit_msg_array is array (0 to C_RX_FIFO_TEST_MSGS-1) of t_xmit_msg;
+
+    variable v_xmit_msgs : t_xmit_msg_array;
+
+    type t_mailbox_order is array (0 to C_TX_MAILBOX_TEST_MSGS-1) of natural;
+
+    -- Mailbox 0 is sent first since it is loaded while the bus is idle,
+    -- the rest are loaded while mailbox 0 is being sent and have
+    -- decreasing IDs (increasing priority)
+    constant C_TX_MAILBOX_ORDER : t_mailbox_order := (0, 3, 2, 1);
+
+    variable v_status_reg       : t_canola_axi_slave_data;
+    variable v_mailbox_reg      : t_canola_axi_slave_data;
+    variable v_mailbox_prev_reg : t_canola_axi_slave_data;
+    variable v_mailbox_order    : natural;
+    variable v_mailbox_1_sent   : boolean;
+
+    -- Timestamps before a frame, of the frame, and after the frame
+    variable v_timestamp_start : t_canola_axi_slave_data;
+    variable v_timestamp_frame : t_canola_axi_slave_data;
+    variable v_timestamp_now   : t_canola_axi_slave_data;
+
+    -- The frame timestamp is after the start, and not after the frame
+    impure function timestamp_in_frame return boolean is
+      variable v_frame : unsigned(C_CANOLA_AXI_SLAVE_DATA_WIDTH-1 downto 0);
+      variable v_now   : unsigned(C_CANOLA_AXI_SLAVE_DATA_WIDTH-1 downto 0);
+    begin
+      v_frame := unsigned(v_timestamp_frame) - unsigned(v_timestamp_start);
+      v_now   := unsigned(v_timestamp_now) - unsigned(v_timestamp_start);
+      return v_frame > 0 and v_frame <= v_now;
+    end function timestamp_in_frame;
 
 
     procedure axilite_write(
@@ -580,6 +717,44 @@ begin
     end procedure generate_random_can_message;
 
 
+    -- Set up acceptance filter. Only the ID bits are used for arb_id, the
+    -- remaining bits are given by the layout of FILTER_ID and FILTER_MASK.
+    procedure write_acceptance_filter (
+      constant index       : in natural;
+      constant arb_id      : in std_logic_vector(28 downto 0);
+      constant ext_id      : in std_logic;
+      constant arb_id_mask : in std_logic_vector(28 downto 0);
+      constant ext_id_mask : in std_logic;
+      constant enable      : in std_logic) is
+      variable v_filter_id_reg   : t_canola_axi_slave_data := (others => '0');
+      variable v_filter_mask_reg : t_canola_axi_slave_data := (others => '0');
+    begin
+      v_filter_id_reg(31)           := enable;
+      v_filter_id_reg(30 downto 20) := arb_id(C_ID_A_LENGTH+C_ID_B_LENGTH-1 downto C_ID_B_LENGTH);
+      v_filter_id_reg(19 downto 2)  := arb_id(C_ID_B_LENGTH-1 downto 0);
+      v_filter_id_reg(0)            := ext_id;
+
+      v_filter_mask_reg(30 downto 20) := arb_id_mask(C_ID_A_LENGTH+C_ID_B_LENGTH-1 downto C_ID_B_LENGTH);
+      v_filter_mask_reg(19 downto 2)  := arb_id_mask(C_ID_B_LENGTH-1 downto 0);
+      v_filter_mask_reg(0)            := ext_id_mask;
+
+      axilite_write(C_ADDR_FILTER_INDEX, std_logic_vector(to_unsigned(index, C_CANOLA_AXI_SLAVE_DATA_WIDTH)),
+                    "Write FILTER_INDEX register");
+      axilite_write(C_ADDR_FILTER_ID, v_filter_id_reg, "Write FILTER_ID register");
+      axilite_write(C_ADDR_FILTER_MASK, v_filter_mask_reg, "Write FILTER_MASK register");
+      axilite_write(C_ADDR_CONTROL, x"00000800", "Pulse FILTER_WRITE");
+    end procedure write_acceptance_filter;
+
+    -- Load the message in the v_xmit_* variables into a Tx mailbox
+    procedure load_tx_mailbox (
+      constant index : in natural) is
+    begin
+      write_msg_to_controller;
+      axilite_write(C_ADDR_TX_MAILBOX_INDEX, std_logic_vector(to_unsigned(index, C_CANOLA_AXI_SLAVE_DATA_WIDTH)),
+                    "Write TX_MAILBOX_INDEX register");
+      axilite_write(C_ADDR_CONTROL, x"00008000", "Pulse TX_MAILBOX_LOAD");
+    end procedure load_tx_mailbox;
+
     function resize_data (
       constant slv_in : std_logic_vector)
       return std_logic_vector is
@@ -736,6 +911,13 @@ begin
       read_msg_from_controller;
       check_value(v_recv_ext_id, v_xmit_ext_id, error, "Check extended ID bit");
 
+      -- Without the Rx FIFO, RX_MSG_VALID is set until the message is popped
+      axilite_read(C_ADDR_STATUS, v_status_reg, "Read STATUS register");
+      check_value(v_status_reg(0), '1', error, "Check STATUS.RX_MSG_VALID set");
+      axilite_write(C_ADDR_CONTROL, x"00001000", "Pop received message");
+      axilite_read(C_ADDR_STATUS, v_status_reg, "Read STATUS register");
+      check_value(v_status_reg(0), '0', error, "Check STATUS.RX_MSG_VALID cleared by RX_FIFO_POP");
+
       if v_xmit_ext_id = '1' then
         check_value(v_recv_arb_id, v_xmit_arb_id, error, "Check received ID");
       else
@@ -914,6 +1096,613 @@ begin
     axilite_check(C_ADDR_TX_MSG_SENT_COUNT, C_NUM_ITERATIONS*2, "Check number of messages sent");
     axilite_check(C_ADDR_TX_ACK_ERROR_COUNT, 0, "Check ACK error count is zero");
 
+    -----------------------------------------------------------------------------------------------
+    log(ID_LOG_HDR, "Test #6: Acceptance filters", C_SCOPE);
+    -----------------------------------------------------------------------------------------------
+    -- Filter 2: Accept standard ID 0x123 only
+    write_acceptance_filter(2, 11x"123" & 18x"0", '0', 11x"7FF" & 18x"0", '1', '1');
+
+    -- Filter 5: Accept extended IDs with ID A 0x55X (upper 7 bits of ID A)
+    write_acceptance_filter(5, 11x"550" & 18x"0", '1', 11x"7F0" & 18x"0", '1', '1');
+
+    axilite_write(C_ADDR_CONFIG, x"00000004", "Enable acceptance filters");
+    axilite_write(C_ADDR_CONTROL, x"00000080", "Reset RX_MSG_RECV_COUNT");
+
+    v_test_num     := 0;
+    v_accept_count := 0;
+
+    while v_test_num < C_NUM_ITERATIONS loop
+      pulse(s_irq_reset, s_clk, 1, "Reset IRQ flags");
+
+      uniform(seed1, seed2, v_rand_real);
+      if v_rand_real > 0.5 then
+        v_xmit_ext_id := '1';
+      else
+        v_xmit_ext_id := '0';
+      end if;
+
+      generate_random_can_message (v_xmit_arb_id,
+                                   v_xmit_data,
+                                   v_xmit_data_length,
+                                   v_xmit_remote_frame,
+                                   v_xmit_ext_id);
+
+      -- The standard ID is sent from ID A bits of v_xmit_arb_id
+      if v_xmit_ext_id = '0' then
+        v_xmit_arb_id(C_ID_A_LENGTH+C_ID_B_LENGTH-1 downto C_ID_B_LENGTH) := v_xmit_arb_id(C_ID_A_LENGTH-1 downto 0);
+      end if;
+
+      -- Make about half of the messages match one of the filters
+      uniform(seed1, seed2, v_rand_real);
+      if v_rand_real > 0.5 then
+        if v_xmit_ext_id = '1' then
+          v_xmit_arb_id(28 downto 22) := "1010101";
+        else
+          v_xmit_arb_id(28 downto 18) := 11x"123";
+        end if;
+      end if;
+
+      if v_xmit_ext_id = '1' then
+        v_expect_accept := v_xmit_arb_id(28 downto 22) = "1010101";
+      else
+        v_expect_accept := v_xmit_arb_id(28 downto 18) = 11x"123";
+      end if;
+
+      wait until rising_edge(s_clk);
+
+      can_uvvm_write(v_xmit_arb_id(C_ID_A_LENGTH+C_ID_B_LENGTH-1 downto C_ID_B_LENGTH),
+                     v_xmit_arb_id(C_ID_B_LENGTH-1 downto 0),
+                     v_xmit_ext_id,
+                     v_xmit_remote_frame,
+                     v_xmit_data,
+                     v_xmit_data_length,
+                     "Send random message with CAN BFM",
+                     s_clk,
+                     s_can_bfm_tx,
+                     s_can_bfm_rx,
+                     v_can_tx_status,
+                     C_CAN_RX_NO_ERROR_GEN,
+                     v_can_bfm_config);
+
+      wait until s_got_rx_valid_irq = '1' for 10*C_CAN_BAUD_PERIOD;
+
+      if v_expect_accept then
+        check_value(s_got_rx_valid_irq, '1', error, "Check that message was accepted.");
+        read_msg_from_controller;
+
+        if v_xmit_ext_id = '1' then
+          check_value(v_recv_arb_id, v_xmit_arb_id, error, "Check received ID");
+          axilite_check(C_ADDR_RX_FILTER_HIT, 5, "Check that filter 5 accepted message");
+        else
+          check_value(v_recv_arb_id(C_ID_A_LENGTH+C_ID_B_LENGTH-1 downto C_ID_B_LENGTH),
+                      v_xmit_arb_id(C_ID_A_LENGTH+C_ID_B_LENGTH-1 downto C_ID_B_LENGTH),
+                      error,
+                      "Check received ID");
+          axilite_check(C_ADDR_RX_FILTER_HIT, 2, "Check that filter 2 accepted message");
+        end if;
+
+        v_accept_count := v_accept_count + 1;
+      else
+        check_value(s_got_rx_valid_irq, '0', error, "Check that message was rejected.");
+      end if;
+
+      wait until rising_edge(s_can_baud_clk);
+      wait until rising_edge(s_can_baud_clk);
+
+      v_test_num := v_test_num + 1;
+    end loop;
+
+    axilite_check(C_ADDR_RX_MSG_RECV_COUNT, v_accept_count, "Check number of accepted messages");
+
+    axilite_write(C_ADDR_CONFIG, x"00000000", "Disable acceptance filters");
+
+    -- RX_FILTER_HIT must not keep the index of the last filter that matched
+    pulse(s_irq_reset, s_clk, 1, "Reset IRQ flags");
+
+    generate_random_can_message (v_xmit_arb_id,
+                                 v_xmit_data,
+                                 v_xmit_data_length,
+                                 v_xmit_remote_frame,
+                                 v_xmit_ext_id);
+
+    wait until rising_edge(s_clk);
+
+    can_uvvm_write(v_xmit_arb_id(C_ID_A_LENGTH+C_ID_B_LENGTH-1 downto C_ID_B_LENGTH),
+                   v_xmit_arb_id(C_ID_B_LENGTH-1 downto 0),
+                   v_xmit_ext_id,
+                   v_xmit_remote_frame,
+                   v_xmit_data,
+                   v_xmit_data_length,
+                   "Send random message with CAN BFM",
+                   s_clk,
+                   s_can_bfm_tx,
+                   s_can_bfm_rx,
+                   v_can_tx_status,
+                   C_CAN_RX_NO_ERROR_GEN,
+                   v_can_bfm_config);
+
+    wait until s_got_rx_valid_irq = '1' for 10*C_CAN_BAUD_PERIOD;
+    check_value(s_got_rx_valid_irq, '1', error, "Check that message was accepted with filtering disabled.");
+    axilite_check(C_ADDR_RX_FILTER_HIT, 0, "Check RX_FILTER_HIT cleared with filtering disabled");
+
+    wait until rising_edge(s_can_baud_clk);
+    wait until rising_edge(s_can_baud_clk);
+
+    -----------------------------------------------------------------------------------------------
+    log(ID_LOG_HDR, "Test #7: Back-to-back messages from BFM to Rx FIFO", C_SCOPE);
+    -----------------------------------------------------------------------------------------------
+    axilite_write(C_ADDR_RX_FIFO_IRQ_LEVEL,
+                  std_logic_vector(to_unsigned(C_RX_FIFO_IRQ_LEVEL, C_CANOLA_AXI_SLAVE_DATA_WIDTH)),
+                  "Set Rx FIFO IRQ level");
+    axilite_write(C_ADDR_CONFIG, x"00000008", "Enable Rx FIFO");
+    axilite_write(C_ADDR_CONTROL, x"00000080", "Reset RX_MSG_RECV_COUNT");
+    axilite_check(C_ADDR_RX_FIFO_STATUS, x"00000200", "Check that Rx FIFO is empty");
+
+    pulse(s_irq_reset, s_clk, 1, "Reset IRQ flags");
+
+    for msg_num in 0 to C_RX_FIFO_TEST_MSGS-1 loop
+      uniform(seed1, seed2, v_rand_real);
+      if v_rand_real > 0.5 then
+        v_xmit_ext_id := '1';
+      else
+        v_xmit_ext_id := '0';
+      end if;
+
+      generate_random_can_message (v_xmit_arb_id,
+                                   v_xmit_data,
+                                   v_xmit_data_length,
+                                   v_xmit_remote_frame,
+                                   v_xmit_ext_id);
+
+      v_xmit_msgs(msg_num) := (arb_id       => v_xmit_arb_id,
+                               ext_id       => v_xmit_ext_id,
+                               remote_frame => v_xmit_remote_frame,
+                               data         => v_xmit_data,
+                               data_length  => v_xmit_data_length);
+
+      -- No delay between frames, the BFM includes interframe spacing
+      can_uvvm_write(v_xmit_arb_id(C_ID_A_LENGTH+C_ID_B_LENGTH-1 downto C_ID_B_LENGTH),
+                     v_xmit_arb_id(C_ID_B_LENGTH-1 downto 0),
+                     v_xmit_ext_id,
+                     v_xmit_remote_frame,
+                     v_xmit_data,
+                     v_xmit_data_length,
+                     "Send random message with CAN BFM",
+                     s_clk,
+                     s_can_bfm_tx,
+                     s_can_bfm_rx,
+                     v_can_tx_status,
+                     C_CAN_RX_NO_ERROR_GEN,
+                     v_can_bfm_config);
+
+      if msg_num < C_RX_FIFO_IRQ_LEVEL-1 then
+        check_value(s_got_rx_valid_irq, '0', error, "Check no Rx IRQ below FIFO IRQ level");
+      end if;
+    end loop;
+
+    wait until rising_edge(s_can_baud_clk);
+    wait until rising_edge(s_can_baud_clk);
+
+    check_value(s_got_rx_valid_irq, '1', error, "Check Rx IRQ at FIFO IRQ level");
+
+    -- The last message did not fit in the FIFO, which is checked below
+    axilite_check(C_ADDR_RX_MSG_RECV_COUNT, C_RX_FIFO_TEST_MSGS, "Check number of received messages");
+
+    -- Drain FIFO
+    for msg_num in 0 to C_RX_FIFO_DEPTH_DEFAULT-1 loop
+      -- Overflow flag stays set until it is cleared
+      if msg_num = 0 then
+        axilite_check(C_ADDR_RX_FIFO_STATUS,
+                      std_logic_vector(to_unsigned(C_RX_FIFO_DEPTH_DEFAULT, C_CANOLA_AXI_SLAVE_DATA_WIDTH)) or x"00000C00",
+                      "Check Rx FIFO full with overflow");
+      else
+        axilite_check(C_ADDR_RX_FIFO_STATUS,
+                      std_logic_vector(to_unsigned(C_RX_FIFO_DEPTH_DEFAULT-msg_num, C_CANOLA_AXI_SLAVE_DATA_WIDTH)) or x"00000800",
+                      "Check Rx FIFO fill level");
+      end if;
+
+      read_msg_from_controller;
+      axilite_write(C_ADDR_CONTROL, x"00001000", "Pop message from Rx FIFO");
+
+      check_value(v_recv_ext_id, v_xmit_msgs(msg_num).ext_id, error, "Check extended ID bit");
+
+      if v_recv_ext_id = '1' then
+        check_value(v_recv_arb_id, v_xmit_msgs(msg_num).arb_id, error, "Check received ID");
+      else
+        check_value(v_recv_arb_id(C_ID_A_LENGTH+C_ID_B_LENGTH-1 downto C_ID_B_LENGTH),
+                    v_xmit_msgs(msg_num).arb_id(C_ID_A_LENGTH+C_ID_B_LENGTH-1 downto C_ID_B_LENGTH),
+                    error,
+                    "Check received ID");
+      end if;
+
+      check_value(v_recv_remote_frame, v_xmit_msgs(msg_num).remote_frame, error, "Check received RTR bit");
+      check_value(v_recv_data_length, v_xmit_msgs(msg_num).data_length, error, "Check data length");
+
+      if v_recv_remote_frame = '0' then
+        for idx in 0 to v_recv_data_length-1 loop
+          check_value(v_recv_data(idx), v_xmit_msgs(msg_num).data(idx), error, "Check received data");
+        end loop;
+      end if;
+    end loop;
+
+    axilite_check(C_ADDR_RX_FIFO_STATUS, x"00000A00", "Check Rx FIFO empty with overflow");
+    axilite_check(C_ADDR_STATUS, x"00000000", "Check STATUS.RX_MSG_VALID cleared");
+    axilite_write(C_ADDR_CONTROL, x"00004000", "Clear Rx FIFO overflow");
+    axilite_check(C_ADDR_RX_FIFO_STATUS, x"00000200", "Check Rx FIFO overflow cleared");
+
+    axilite_write(C_ADDR_CONFIG, x"00000000", "Disable Rx FIFO");
+
+    -----------------------------------------------------------------------------------------------
+    log(ID_LOG_HDR, "Test #8: Tx mailboxes", C_SCOPE);
+    -----------------------------------------------------------------------------------------------
+    axilite_write(C_ADDR_CONFIG, x"00000010", "Enable Tx mailboxes, retransmit disabled");
+    axilite_check(C_ADDR_TX_MAILBOX_COUNT, C_TX_MAILBOXES_DEFAULT, "Check number of Tx mailboxes");
+    axilite_check(C_ADDR_TX_MAILBOX_PENDING, 0, "Check no Tx mailboxes pending");
+
+    -- The BFM does not acknowledge the messages in this part of the test,
+    -- so each mailbox fails after one attempt (retransmit is disabled).
+    -- The order the mailboxes fail in is the order they were sent in.
+    v_xmit_ext_id := '0';
+
+    for mailbox in 0 to C_TX_MAILBOX_TEST_MSGS-1 loop
+      generate_random_can_message (v_xmit_arb_id,
+                                   v_xmit_data,
+                                   v_xmit_data_length,
+                                   v_xmit_remote_frame,
+                                   v_xmit_ext_id);
+
+      if mailbox = 0 then
+        v_xmit_arb_id(C_ID_A_LENGTH+C_ID_B_LENGTH-1 downto C_ID_B_LENGTH) := "11111100000";
+      else
+        v_xmit_arb_id(C_ID_A_LENGTH+C_ID_B_LENGTH-1 downto C_ID_B_LENGTH) :=
+          std_logic_vector(to_unsigned(16#400# - 16#10#*mailbox, C_ID_A_LENGTH));
+      end if;
+
+      load_tx_mailbox(mailbox);
+    end loop;
+
+    -- Loading a pending mailbox should be ignored,
+    -- this message would otherwise have been sent next
+    v_xmit_arb_id(C_ID_A_LENGTH+C_ID_B_LENGTH-1 downto C_ID_B_LENGTH) := "00000000001";
+    load_tx_mailbox(1);
+
+    axilite_check(C_ADDR_TX_MAILBOX_PENDING, x"0000000F", "Check Tx mailboxes pending");
+
+    v_mailbox_prev_reg := (others => '0');
+    v_mailbox_order    := 0;
+    v_count            := 0;
+
+    while v_mailbox_order < C_TX_MAILBOX_TEST_MSGS and v_count < C_TX_MAILBOX_POLL_MAX loop
+      axilite_read(C_ADDR_TX_MAILBOX_FAILED, v_mailbox_reg, "Read TX_MAILBOX_FAILED register");
+
+      if v_mailbox_reg /= v_mailbox_prev_reg then
+        check_value(v_mailbox_reg and not v_mailbox_prev_reg,
+                    std_logic_vector(shift_left(to_unsigned(1, C_CANOLA_AXI_SLAVE_DATA_WIDTH),
+                                                C_TX_MAILBOX_ORDER(v_mailbox_order))),
+                    error, "Check that Tx mailboxes are sent in priority order");
+
+        v_mailbox_prev_reg := v_mailbox_reg;
+        v_mailbox_order    := v_mailbox_order + 1;
+      end if;
+
+      v_count := v_count + 1;
+    end loop;
+
+    check_value(v_mailbox_order, C_TX_MAILBOX_TEST_MSGS, error, "Check that all Tx mailboxes failed");
+    axilite_check(C_ADDR_TX_MAILBOX_PENDING, 0, "Check no Tx mailboxes pending");
+    axilite_check(C_ADDR_TX_MAILBOX_DONE, 0, "Check no Tx mailboxes done");
+
+    -- Send one mailbox to the BFM, and abort another one that is loaded
+    -- while the first one is being sent
+    axilite_write(C_ADDR_CONTROL, x"00000002", "Reset TX_MSG_SENT_COUNT");
+
+    generate_random_can_message (v_xmit_arb_id,
+                                 v_xmit_data,
+                                 v_xmit_data_length,
+                                 v_xmit_remote_frame,
+                                 v_xmit_ext_id);
+
+    v_xmit_msgs(0) := (arb_id       => v_xmit_arb_id,
+                       ext_id       => v_xmit_ext_id,
+                       remote_frame => v_xmit_remote_frame,
+                       data         => v_xmit_data,
+                       data_length  => v_xmit_data_length);
+
+    load_tx_mailbox(2);
+
+    generate_random_can_message (v_xmit_arb_id,
+                                 v_xmit_data,
+                                 v_xmit_data_length,
+                                 v_xmit_remote_frame,
+                                 v_xmit_ext_id);
+    load_tx_mailbox(5);
+
+    axilite_write(C_ADDR_TX_MAILBOX_ABORT, x"00000020", "Abort Tx mailbox 5");
+
+    can_uvvm_check(v_xmit_msgs(0).arb_id(C_ID_A_LENGTH+C_ID_B_LENGTH-1 downto C_ID_B_LENGTH),
+                   v_xmit_msgs(0).arb_id(C_ID_B_LENGTH-1 downto 0),
+                   v_xmit_msgs(0).ext_id,
+                   v_xmit_msgs(0).remote_frame,
+                   '0', -- Don't send remote request and expect response
+                   v_xmit_msgs(0).data,
+                   v_xmit_msgs(0).data_length,
+                   "Receive and check message from Tx mailbox with CAN BFM",
+                   s_clk,
+                   s_can_bfm_tx,
+                   s_can_bfm_rx,
+                   error,
+                   v_can_bfm_config);
+
+    wait until rising_edge(s_can_baud_clk);
+    wait until rising_edge(s_can_baud_clk);
+
+    axilite_check(C_ADDR_TX_MAILBOX_PENDING, 0, "Check no Tx mailboxes pending");
+    axilite_check(C_ADDR_TX_MAILBOX_DONE, x"00000004", "Check Tx mailbox 2 done");
+    axilite_check(C_ADDR_TX_MAILBOX_FAILED, x"0000002B", "Check Tx mailbox 5 failed (aborted)");
+    axilite_check(C_ADDR_TX_MSG_SENT_COUNT, 1, "Check that aborted mailbox was not sent");
+
+    -- A higher priority mailbox that is loaded while a lower priority
+    -- mailbox is being retransmitted should get its own retransmit attempts,
+    -- and not continue with the attempts made for the other mailbox.
+    -- The BFM does not acknowledge the messages, so both mailboxes fail.
+    axilite_write(C_ADDR_CONFIG, x"00000011", "Enable Tx mailboxes and retransmit");
+    axilite_write(C_ADDR_CONTROL, x"00000040", "Reset TX_RETRANSMIT_COUNT");
+
+    generate_random_can_message (v_xmit_arb_id,
+                                 v_xmit_data,
+                                 v_xmit_data_length,
+                                 v_xmit_remote_frame,
+                                 v_xmit_ext_id);
+    v_xmit_arb_id(C_ID_A_LENGTH+C_ID_B_LENGTH-1 downto C_ID_B_LENGTH) := "11100000000";
+    load_tx_mailbox(0);
+
+    v_count := 0;
+    loop
+      axilite_read(C_ADDR_TX_RETRANSMIT_COUNT, v_retransmit_count_load, "Read TX_RETRANSMIT_COUNT register");
+      exit when unsigned(v_retransmit_count_load) >= 2 or v_count = C_TX_MAILBOX_POLL_MAX;
+      v_count := v_count + 1;
+    end loop;
+
+    check_value(unsigned(v_retransmit_count_load) >= 2 and
+                unsigned(v_retransmit_count_load) < C_RETRANSMIT_COUNT_MAX_DEFAULT, error,
+                "Check that low priority mailbox is being retransmitted");
+
+    v_xmit_arb_id(C_ID_A_LENGTH+C_ID_B_LENGTH-1 downto C_ID_B_LENGTH) := "00000010000";
+    load_tx_mailbox(1);
+
+    v_count := 0;
+    loop
+      axilite_read(C_ADDR_TX_MAILBOX_FAILED, v_mailbox_reg, "Read TX_MAILBOX_FAILED register");
+      exit when v_mailbox_reg(1) = '1' or v_count = C_TX_MAILBOX_POLL_MAX;
+      v_count := v_count + 1;
+    end loop;
+
+    axilite_read(C_ADDR_TX_RETRANSMIT_COUNT, v_retransmit_count_fail, "Read TX_RETRANSMIT_COUNT register");
+    check_value(v_mailbox_reg(1 downto 0), "10", error, "Check that high priority mailbox failed first");
+    check_value(unsigned(v_retransmit_count_fail) >=
+                unsigned(v_retransmit_count_load) + C_RETRANSMIT_COUNT_MAX_DEFAULT + 1, error,
+                "Check that high priority mailbox got its own retransmit attempts");
+
+    v_count := 0;
+    loop
+      axilite_read(C_ADDR_TX_MAILBOX_FAILED, v_mailbox_reg, "Read TX_MAILBOX_FAILED register");
+      exit when v_mailbox_reg(0) = '1' or v_count = C_TX_MAILBOX_POLL_MAX;
+      v_count := v_count + 1;
+    end loop;
+
+    check_value(v_mailbox_reg(0), '1', error, "Check that low priority mailbox failed");
+    axilite_check(C_ADDR_TX_RETRANSMIT_COUNT,
+                  std_logic_vector(unsigned(v_retransmit_count_fail) + C_RETRANSMIT_COUNT_MAX_DEFAULT),
+                  "Check that low priority mailbox restarted its retransmit attempts");
+    axilite_check(C_ADDR_TX_MAILBOX_PENDING, 0, "Check no Tx mailboxes pending");
+    axilite_check(C_ADDR_TX_MAILBOX_DONE, x"00000004", "Check only Tx mailbox 2 done");
+
+    -- A mailbox that is aborted in the cycle before the Tx FSM decides to
+    -- retransmit must not be reloaded and sent. Mailbox 0 loses arbitration
+    -- in its first ID bit (p_arb_lost), while the higher priority mailbox 1
+    -- is pending and is aborted at every clock cycle offset through that
+    -- bit. p_tx_mailbox_reload checks that an aborted mailbox is never
+    -- reloaded, and that one of the aborts hit the retransmit decision.
+    -- Mailbox 1 is only sent when it was aborted after it was reloaded,
+    -- and is then reported as done. The BFM sends a message back each time
+    -- to take back the receive error for the error frame after the lost
+    -- arbitration.
+    for delay in 0 to C_CAN_BAUD_PERIOD / C_CLK_PERIOD - 1 loop
+      generate_random_can_message (v_xmit_arb_id,
+                                   v_xmit_data,
+                                   v_xmit_data_length,
+                                   v_xmit_remote_frame,
+                                   v_xmit_ext_id);
+      v_xmit_arb_id(C_ID_A_LENGTH+C_ID_B_LENGTH-1 downto C_ID_B_LENGTH) := "11111111111";
+      v_xmit_ext_id       := '0';
+      v_xmit_remote_frame := '0';
+      v_xmit_data_length  := 0;
+
+      v_xmit_msgs(0) := (arb_id       => v_xmit_arb_id,
+                         ext_id       => v_xmit_ext_id,
+                         remote_frame => v_xmit_remote_frame,
+                         data         => v_xmit_data,
+                         data_length  => v_xmit_data_length);
+
+      s_arb_lost_en <= '1';
+      load_tx_mailbox(0);
+
+      v_xmit_arb_id(C_ID_A_LENGTH+C_ID_B_LENGTH-1 downto C_ID_B_LENGTH) := "00000010000";
+      v_xmit_msgs(1) := (arb_id       => v_xmit_arb_id,
+                         ext_id       => v_xmit_ext_id,
+                         remote_frame => v_xmit_remote_frame,
+                         data         => v_xmit_data,
+                         data_length  => v_xmit_data_length);
+      load_tx_mailbox(1);
+
+      wait until s_arb_lost_tx = '0' for 200*C_CAN_BAUD_PERIOD;
+      check_value(s_arb_lost_tx, '0', error, "Check that Tx mailbox 0 loses arbitration");
+      s_arb_lost_en <= '0';
+
+      for cycle in 1 to delay loop
+        wait until rising_edge(s_clk);
+      end loop;
+
+      axilite_write(C_ADDR_TX_MAILBOX_ABORT, x"00000002", "Abort Tx mailbox 1");
+
+      -- Stuff error after the lost arbitration, the bus is recessive
+      -- after the first ID bit
+      can_uvvm_recv_active_error_flag(20,
+                                      "Receive error flag after lost arbitration",
+                                      s_can_bfm_rx,
+                                      v_can_bfm_config);
+
+      v_mailbox_1_sent := false;
+
+      can_uvvm_read(v_recv_arb_id(C_ID_A_LENGTH+C_ID_B_LENGTH-1 downto C_ID_B_LENGTH),
+                    v_recv_arb_id(C_ID_B_LENGTH-1 downto 0),
+                    v_recv_ext_id,
+                    v_recv_remote_frame,
+                    v_recv_data,
+                    v_recv_data_length,
+                    "Receive message from Tx mailbox with CAN BFM",
+                    s_clk,
+                    s_can_bfm_tx,
+                    s_can_bfm_rx,
+                    v_recv_timeout,
+                    v_can_bfm_config);
+
+      if v_recv_arb_id = v_xmit_msgs(1).arb_id then
+        v_mailbox_1_sent := true;
+
+        can_uvvm_read(v_recv_arb_id(C_ID_A_LENGTH+C_ID_B_LENGTH-1 downto C_ID_B_LENGTH),
+                      v_recv_arb_id(C_ID_B_LENGTH-1 downto 0),
+                      v_recv_ext_id,
+                      v_recv_remote_frame,
+                      v_recv_data,
+                      v_recv_data_length,
+                      "Receive message from Tx mailbox with CAN BFM",
+                      s_clk,
+                      s_can_bfm_tx,
+                      s_can_bfm_rx,
+                      v_recv_timeout,
+                      v_can_bfm_config);
+      end if;
+
+      check_value(v_recv_arb_id(C_ID_A_LENGTH+C_ID_B_LENGTH-1 downto C_ID_B_LENGTH),
+                  v_xmit_msgs(0).arb_id(C_ID_A_LENGTH+C_ID_B_LENGTH-1 downto C_ID_B_LENGTH),
+                  error, "Check that Tx mailbox 0 was retransmitted");
+
+      wait until rising_edge(s_can_baud_clk);
+      wait until rising_edge(s_can_baud_clk);
+
+      axilite_check(C_ADDR_TX_MAILBOX_PENDING, 0, "Check no Tx mailboxes pending");
+      axilite_read(C_ADDR_TX_MAILBOX_DONE, v_mailbox_reg, "Read TX_MAILBOX_DONE register");
+
+      if v_mailbox_1_sent then
+        check_value(v_mailbox_reg(1 downto 0), "11", error,
+                    "Check Tx mailboxes 0 and 1 done (1 was aborted while in flight)");
+      else
+        check_value(v_mailbox_reg(1 downto 0), "01", error, "Check Tx mailbox 0 done");
+        axilite_read(C_ADDR_TX_MAILBOX_FAILED, v_mailbox_reg, "Read TX_MAILBOX_FAILED register");
+        check_value(v_mailbox_reg(1 downto 0), "10", error, "Check Tx mailbox 1 failed (aborted)");
+      end if;
+
+      can_uvvm_write(v_xmit_msgs(1).arb_id(C_ID_A_LENGTH+C_ID_B_LENGTH-1 downto C_ID_B_LENGTH),
+                     v_xmit_msgs(1).arb_id(C_ID_B_LENGTH-1 downto 0),
+                     v_xmit_msgs(1).ext_id,
+                     v_xmit_msgs(1).remote_frame,
+                     v_xmit_msgs(1).data,
+                     v_xmit_msgs(1).data_length,
+                     "Send message with CAN BFM",
+                     s_clk,
+                     s_can_bfm_tx,
+                     s_can_bfm_rx,
+                     v_can_tx_status,
+                     C_CAN_RX_NO_ERROR_GEN,
+                     v_can_bfm_config);
+
+      wait until rising_edge(s_can_baud_clk);
+      wait until rising_edge(s_can_baud_clk);
+    end loop;
+
+    check_value(s_abort_at_retransmit, '1', error,
+                "Check that a Tx mailbox was aborted just before a retransmit decision");
+
+    axilite_write(C_ADDR_CONFIG, x"00000000", "Disable Tx mailboxes");
+
+    -----------------------------------------------------------------------------------------------
+    log(ID_LOG_HDR, "Test #9: Timestamps", C_SCOPE);
+    -----------------------------------------------------------------------------------------------
+    axilite_read(C_ADDR_TIMESTAMP, v_timestamp_start, "Read TIMESTAMP");
+    wait for 100*C_CLK_PERIOD;
+    axilite_read(C_ADDR_TIMESTAMP, v_timestamp_now, "Read TIMESTAMP");
+    check_value(unsigned(v_timestamp_now) - unsigned(v_timestamp_start) >= 100, error,
+                "Check that TIMESTAMP counts clock cycles");
+
+    -- Message from BFM to controller
+    pulse(s_irq_reset, s_clk, 1, "Reset IRQ flags");
+    v_xmit_ext_id := '1';
+    generate_random_can_message (v_xmit_arb_id,
+                                 v_xmit_data,
+                                 v_xmit_data_length,
+                                 v_xmit_remote_frame,
+                                 v_xmit_ext_id);
+
+    axilite_read(C_ADDR_TIMESTAMP, v_timestamp_start, "Read TIMESTAMP before frame");
+
+    can_uvvm_write(v_xmit_arb_id(C_ID_A_LENGTH+C_ID_B_LENGTH-1 downto C_ID_B_LENGTH),
+                   v_xmit_arb_id(C_ID_B_LENGTH-1 downto 0),
+                   v_xmit_ext_id,
+                   v_xmit_remote_frame,
+                   v_xmit_data,
+                   v_xmit_data_length,
+                   "Send random message with CAN BFM",
+                   s_clk,
+                   s_can_bfm_tx,
+                   s_can_bfm_rx,
+                   v_can_tx_status,
+                   C_CAN_RX_NO_ERROR_GEN,
+                   v_can_bfm_config);
+
+    wait until s_got_rx_valid_irq = '1' for 10*C_CAN_BAUD_PERIOD;
+    check_value(s_got_rx_valid_irq, '1', error, "Check that CAN controller received msg.");
+
+    axilite_read(C_ADDR_RX_TIMESTAMP, v_timestamp_frame, "Read RX_TIMESTAMP");
+    axilite_read(C_ADDR_TIMESTAMP, v_timestamp_now, "Read TIMESTAMP after frame");
+    check_value(timestamp_in_frame, error, "Check RX_TIMESTAMP of received message");
+
+    wait until rising_edge(s_can_baud_clk);
+    wait until rising_edge(s_can_baud_clk);
+
+    -- Message from controller to BFM
+    generate_random_can_message (v_xmit_arb_id,
+                                 v_xmit_data,
+                                 v_xmit_data_length,
+                                 v_xmit_remote_frame,
+                                 v_xmit_ext_id);
+
+    write_msg_to_controller;
+
+    axilite_read(C_ADDR_TIMESTAMP, v_timestamp_start, "Read TIMESTAMP before frame");
+    axilite_write(C_ADDR_CONTROL, x"00000001", "Start transmit");
+
+    can_uvvm_check(v_xmit_arb_id(C_ID_A_LENGTH+C_ID_B_LENGTH-1 downto C_ID_B_LENGTH),
+                   v_xmit_arb_id(C_ID_B_LENGTH-1 downto 0),
+                   v_xmit_ext_id,
+                   v_xmit_remote_frame,
+                   '0', -- Don't send remote request and expect response
+                   v_xmit_data,
+                   v_xmit_data_length,
+                   "Receive and check message with CAN BFM",
+                   s_clk,
+                   s_can_bfm_tx,
+                   s_can_bfm_rx,
+                   error,
+                   v_can_bfm_config);
+
+    wait until rising_edge(s_can_baud_clk);
+    wait until rising_edge(s_can_baud_clk);
+
+    axilite_read(C_ADDR_TX_TIMESTAMP, v_timestamp_frame, "Read TX_TIMESTAMP");
+    axilite_read(C_ADDR_TIMESTAMP, v_timestamp_now, "Read TIMESTAMP after frame");
+    check_value(timestamp_in_frame, error, "Check TX_TIMESTAMP of transmitted message");
+
     -----------------------------------------------------------------------------------------------
     -- Simulation complete
     -----------------------------------------------------------------------------------------------
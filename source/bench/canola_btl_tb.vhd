@@ -6,7 +6,7 @@
 -- Author     : Simon Voigt Nesbo (svn@hvl.no)
 -- Company    :
 -- Created    : 2019-07-16
--- Last update: 2020-09-17
+-- Last update: 2026-10-16
 -- Platform   :
 -- Target     : Questasim
 -- Standard   : VHDL'08
@@ -19,6 +19,7 @@
 -- Revisions  :
 -- Date        Version  Author                  Description
 -- 2019-07-16  1.0      svn                     Created
+-- 2026-10-16  1.1      svn                     Test resync limited by SJW
 -------------------------------------------------------------------------------
 
 use std.textio.all;
@@ -51,6 +52,7 @@ architecture tb of canola_btl_tb is
   constant C_CAN_SAMPLE_POINT : real    := 0.7;
 
   constant C_TIME_QUANTA_CLOCK_SCALE_VAL : natural := 9;
+  constant C_TIME_QUANTA_PERIOD          : time    := C_CLK_PERIOD*(C_TIME_QUANTA_CLOCK_SCALE_VAL+1);
 
   constant C_DATA_LENGTH_MAX : natural := 1000;
   constant C_NUM_ITERATIONS  : natural := 10;
@@ -139,7 +141,12 @@ architecture tb of canola_btl_tb is
   signal s_phase_seg1      : std_logic_vector(C_PHASE_SEG1_WIDTH-1 downto 0);
   signal s_phase_seg2      : std_logic_vector(C_PHASE_SEG2_WIDTH-1 downto 0);
 
-  signal s_sync_jump_width : unsigned(C_SYNC_JUMP_WIDTH_BITSIZE-1 downto 0);
+  signal s_sync_jump_width : unsigned(C_SYNC_JUMP_WIDTH_BITSIZE-1 downto 0) :=
+    to_unsigned(2, C_SYNC_JUMP_WIDTH_BITSIZE);
+
+  -- Time between the last two Rx sample points (BTL_RX_BIT_VALID)
+  signal s_btl_rx_bit_valid_time     : time := 0 ns;
+  signal s_btl_rx_bit_valid_interval : time := 0 ns;
 
 
   shared variable seed1     : positive := 32564482;
@@ -153,7 +160,6 @@ begin
   s_prop_seg        <= "0111";
   s_phase_seg1      <= "0111";
   s_phase_seg2      <= "0111";
-  s_sync_jump_width <= to_unsigned(2, C_SYNC_JUMP_WIDTH_BITSIZE);
 
   -- Set up clock generators
   clock_gen(s_clk, s_clock_ena, C_CLK_PERIOD);
@@ -233,6 +239,17 @@ begin
   end process p_btl_receive;
 
 
+  p_btl_rx_bit_valid_interval: process (s_clk) is
+  begin
+    if rising_edge(s_clk) then
+      if s_btl_rx_bit_valid = '1' then
+        s_btl_rx_bit_valid_interval <= now - s_btl_rx_bit_valid_time;
+        s_btl_rx_bit_valid_time     <= now;
+      end if;
+    end if;
+  end process p_btl_rx_bit_valid_interval;
+
+
   -- Process for receiving bits that were transmitted via BTL off the bus line
   -- Puts the received bits in a vector. Vector and count is reset on start of frame.
   p_bus_receive: process is
@@ -527,9 +544,47 @@ begin
     end loop;
 
     ---------------------------------------------------------------------------
-    log(ID_LOG_HDR, "Test transmitting with BTL", C_SCOPE);
+    log(ID_LOG_HDR, "Test resynchronization limited by SJW", C_SCOPE);
     ---------------------------------------------------------------------------
     s_can_baud_error <= 0.0;
+
+    -- A falling edge 4.5 time quanta late (in PHASE_SEG1) has a larger phase
+    -- error than the SJW values tested here, so PHASE_SEG1 of that bit is
+    -- lengthened by exactly SJW time quanta, which moves the sample point
+    for sjw in 1 to 2 loop
+      s_sync_jump_width <= to_unsigned(sjw, C_SYNC_JUMP_WIDTH_BITSIZE);
+      s_can_rx          <= '1';
+      wait for 10*C_CAN_BAUD_PERIOD;
+
+      log(ID_SEQUENCER, "SJW " & to_string(sjw) & ": SOF, recessive bit, late falling edge", C_SCOPE);
+      s_can_rx <= '0';
+      wait for C_CAN_BAUD_PERIOD;
+      s_can_rx <= '1';
+      wait for C_CAN_BAUD_PERIOD + 45*C_CLK_PERIOD;
+      s_can_rx <= '0';
+
+      wait until rising_edge(s_clk) and s_btl_rx_bit_valid = '1';
+      wait until rising_edge(s_clk);
+      check_value(s_btl_rx_synced, '1', error, "Check that BTL is synced.");
+      check_value(s_btl_rx_bit_valid_interval, (10+sjw)*C_TIME_QUANTA_PERIOD, error,
+                  "Check that sample point moved by SJW time quanta.");
+
+      wait for C_CAN_BAUD_PERIOD;
+      s_can_rx <= '1';
+
+      s_btl_rx_stop <= '1';
+      wait until rising_edge(s_clk);
+      s_btl_rx_stop <= '0';
+      wait until rising_edge(s_clk);
+    end loop;
+
+    s_sync_jump_width <= to_unsigned(2, C_SYNC_JUMP_WIDTH_BITSIZE);
+    wait until rising_edge(s_can_baud_clk);
+    wait until rising_edge(s_can_baud_clk);
+
+    ---------------------------------------------------------------------------
+    log(ID_LOG_HDR, "Test transmitting with BTL", C_SCOPE);
+    ---------------------------------------------------------------------------
     v_test_num       := 0;
 
     while v_test_num < C_NUM_ITERATIONS loop
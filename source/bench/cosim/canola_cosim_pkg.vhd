@@ -0,0 +1,92 @@
+-------------------------------------------------------------------------------
+-- Title      : VHPIDIRECT interface for co-simulation with the test firmware
+-- Project    : Canola CAN Controller
+-------------------------------------------------------------------------------
+-- File       : canola_cosim_pkg.vhd
+-- Author     : Simon Voigt Nesbo (svn@hvl.no)
+-- Company    : Western Norway University of Applied Sciences
+-- Created    : 2026-10-16
+-- Last update: 2026-10-16
+-- Platform   :
+-- Target     :
+-- Standard   : VHDL'08
+-------------------------------------------------------------------------------
+-- Description: Foreign subprograms implemented in software/canola_cosim/cosim.c,
+--              used by canola_cosim_tb to get batches of register accesses
+--              from the Zynq test firmware, and to report interrupts back.
+--              GHDL only, the subprograms are linked in with VHPIDIRECT.
+-------------------------------------------------------------------------------
+-- Copyright (c) 2026
+-------------------------------------------------------------------------------
+-- Revisions  :
+-- Date        Version  Author                  Description
+-- 2026-10-16  1.0      svn                     Created
+-------------------------------------------------------------------------------
+
+package canola_cosim_pkg is
+
+  -- Operations in a batch, must match cosim.h
+  constant C_COSIM_OP_WRITE    : integer := 0;  -- AXI-lite write of data to addr
+  constant C_COSIM_OP_READ     : integer := 1;  -- AXI-lite read from addr
+  constant C_COSIM_OP_WAIT     : integer := 2;  -- Wait data us, or until an interrupt
+  constant C_COSIM_OP_IDLE     : integer := 3;  -- Wait data clock cycles
+  constant C_COSIM_OP_TX_FAULT : integer := 4;  -- Disconnect CAN_TX of controllers in data
+
+  constant C_COSIM_IRQ_LINES : natural := 12;
+
+  -- Report the interrupt edges since the last call (one bit per line), and
+  -- let the firmware run until it has a new batch of operations.
+  -- Returns the number of operations in the batch, or -1 when the firmware
+  -- has finished.
+  impure function cosim_sync (
+    irq_edges : integer;
+    now_us    : integer)
+    return integer;
+  attribute foreign of cosim_sync : function is "VHPIDIRECT cosim_sync";
+
+  -- Get operation number index in the current batch
+  procedure cosim_get_op (
+    index : in  integer;
+    kind  : out integer;
+    addr  : out integer;
+    data  : out integer);
+  attribute foreign of cosim_get_op : procedure is "VHPIDIRECT cosim_get_op";
+
+  -- Return the result of the read operation number index
+  procedure cosim_put_read (
+    index : in integer;
+    data  : in integer);
+  attribute foreign of cosim_put_read : procedure is "VHPIDIRECT cosim_put_read";
+
+end package canola_cosim_pkg;
+
+package body canola_cosim_pkg is
+
+  -- The bodies are replaced by the foreign functions when linked with GHDL
+
+  impure function cosim_sync (
+    irq_edges : integer;
+    now_us    : integer)
+    return integer is
+  begin
+    report "cosim_sync: VHPIDIRECT function not linked" severity failure;
+    return -1;
+  end function cosim_sync;
+
+  procedure cosim_get_op (
+    index : in  integer;
+    kind  : out integer;
+    addr  : out integer;
+    data  : out integer) is
+  begin
+    report "cosim_get_op: VHPIDIRECT procedure not linked" severity failure;
+  end procedure cosim_get_op;
+
+  procedure cosim_put_read (
+    index : in integer;
+    data  : in integer) is
+  begin
+    report "cosim_put_read: VHPIDIRECT procedure not linked" severity failure;
+  end procedure cosim_put_read;
+
+end package body canola_cosim_pkg;
@@ -0,0 +1,375 @@
+-------------------------------------------------------------------------------
+-- Title      : Co-simulation of the Zynq test firmware with Canola AXI slaves
+-- Project    : Canola CAN Controller
+-------------------------------------------------------------------------------
+-- File       : canola_cosim_tb.vhd
+-- Author     : Simon Voigt Nesbo (svn@hvl.no)
+-- Company    : Western Norway University of Applied Sciences
+-- Created    : 2026-10-16
+-- Last update: 2026-10-16
+-- Platform   :
+-- Target     :
+-- Standard   : VHDL'08
+-------------------------------------------------------------------------------
+-- Description: Four Canola AXI slaves on a shared CAN bus, like in the ZYBO
+--              test design, driven by the Zynq test firmware running in
+--              software/canola_cosim. The firmware hands over batches of
+--              register accesses through canola_cosim_pkg, which are
+--              performed here as AXI-lite transactions, and rising edges on
+--              the interrupt lines are reported back to the firmware.
+--              Built and run with GHDL, see software/canola_cosim/Makefile.
+-------------------------------------------------------------------------------
+-- Copyright (c) 2026
+-------------------------------------------------------------------------------
+-- Revisions  :
+-- Date        Version  Author                  Description
+-- 2026-10-16  1.0      svn                     Created
+-------------------------------------------------------------------------------
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+library work;
+use work.canola_axi_slave_pif_pkg.all;
+use work.canola_cosim_pkg.all;
+
+entity canola_cosim_tb is
+  generic (
+    G_TMR_TOP_MODULE_EN : boolean := false;  -- Use canola_axi_slave_tmr instead of canola_axi_slave
+    G_SEE_MITIGATION_EN : boolean := false); -- Enable TMR in canola_axi_slave_tmr
+end entity canola_cosim_tb;
+
+architecture tb of canola_cosim_tb is
+
+  constant C_CLK_PERIOD : time := 10 ns;  -- 100 MHz, FCLK_CLK0 in the block design
+
+  constant C_NUM_CTRL : natural := 4;
+
+  -- Address map from the block design, must match bsp/xparameters.h
+  constant C_BASEADDR_0      : unsigned(31 downto 0) := x"60000000";
+  constant C_BASEADDR_STRIDE : natural               := 16#10000#;
+
+  subtype t_axi_word is std_logic_vector(31 downto 0);
+  type t_axi_word_array is array (natural range <>) of t_axi_word;
+  type t_axi_resp_array is array (natural range <>) of std_logic_vector(1 downto 0);
+
+  constant C_NO_IRQ : std_logic_vector(C_COSIM_IRQ_LINES-1 downto 0) := (others => '0');
+
+  signal s_clk       : std_logic := '0';
+  signal s_reset     : std_logic := '1';
+  signal s_areset_n  : std_logic;
+
+  -- AXI-lite master, valid signals go to the selected slave only
+  signal s_axi_sel     : natural range 0 to C_NUM_CTRL-1 := 0;
+  signal s_axi_awaddr  : t_axi_word := (others => '0');
+  signal s_axi_awvalid : std_logic  := '0';
+  signal s_axi_awready : std_logic;
+  signal s_axi_wdata   : t_axi_word := (others => '0');
+  signal s_axi_wvalid  : std_logic  := '0';
+  signal s_axi_wready  : std_logic;
+  signal s_axi_bresp   : std_logic_vector(1 downto 0);
+  signal s_axi_bvalid  : std_logic;
+  signal s_axi_bready  : std_logic  := '0';
+  signal s_axi_araddr  : t_axi_word := (others => '0');
+  signal s_axi_arvalid : std_logic  := '0';
+  signal s_axi_arready : std_logic;
+  signal s_axi_rdata   : t_axi_word;
+  signal s_axi_rresp   : std_logic_vector(1 downto 0);
+  signal s_axi_rvalid  : std_logic;
+  signal s_axi_rready  : std_logic  := '0';
+
+  -- AXI-lite signals of each slave
+  signal s_awvalid : std_logic_vector(0 to C_NUM_CTRL-1);
+  signal s_awready : std_logic_vector(0 to C_NUM_CTRL-1);
+  signal s_wvalid  : std_logic_vector(0 to C_NUM_CTRL-1);
+  signal s_wready  : std_logic_vector(0 to C_NUM_CTRL-1);
+  signal s_bresp   : t_axi_resp_array(0 to C_NUM_CTRL-1);
+  signal s_bvalid  : std_logic_vector(0 to C_NUM_CTRL-1);
+  signal s_bready  : std_logic_vector(0 to C_NUM_CTRL-1);
+  signal s_arvalid : std_logic_vector(0 to C_NUM_CTRL-1);
+  signal s_arready : std_logic_vector(0 to C_NUM_CTRL-1);
+  signal s_rdata   : t_axi_word_array(0 to C_NUM_CTRL-1);
+  signal s_rresp   : t_axi_resp_array(0 to C_NUM_CTRL-1);
+  signal s_rvalid  : std_logic_vector(0 to C_NUM_CTRL-1);
+  signal s_rready  : std_logic_vector(0 to C_NUM_CTRL-1);
+
+  -- CAN controllers and shared CAN bus
+  signal s_can_tx  : std_logic_vector(0 to C_NUM_CTRL-1);
+  signal s_can_rx  : std_logic_vector(0 to C_NUM_CTRL-1);
+  signal s_can_bus : std_logic;
+
+  -- CAN_TX of a controller is not driving the bus when its bit is set
+  signal s_can_tx_fault : std_logic_vector(0 to C_NUM_CTRL-1) := (others => '0');
+
+  -- Interrupt lines in the same order as on xlconcat_0 in the block design:
+  -- Rx valid, Tx done and Tx failed for each controller
+  signal s_irq         : std_logic_vector(C_COSIM_IRQ_LINES-1 downto 0);
+  signal s_irq_d       : std_logic_vector(C_COSIM_IRQ_LINES-1 downto 0) := (others => '0');
+  signal s_irq_pending : std_logic_vector(C_COSIM_IRQ_LINES-1 downto 0) := (others => '0');
+  signal s_irq_ack     : std_logic := '0';
+
+begin
+
+  s_clk      <= not s_clk after C_CLK_PERIOD/2;
+  s_areset_n <= not s_reset;
+
+  s_can_bus <= 'H';
+
+  s_axi_awready <= s_awready(s_axi_sel);
+  s_axi_wready  <= s_wready(s_axi_sel);
+  s_axi_bresp   <= s_bresp(s_axi_sel);
+  s_axi_bvalid  <= s_bvalid(s_axi_sel);
+  s_axi_arready <= s_arready(s_axi_sel);
+  s_axi_rdata   <= s_rdata(s_axi_sel);
+  s_axi_rresp   <= s_rresp(s_axi_sel);
+  s_axi_rvalid  <= s_rvalid(s_axi_sel);
+
+  gen_can_ctrl : for i in 0 to C_NUM_CTRL-1 generate
+    constant C_BASEADDR : std_logic_vector(31 downto 0) :=
+      std_logic_vector(C_BASEADDR_0 + i*C_BASEADDR_STRIDE);
+  begin
+    s_can_bus   <= '0' when s_can_tx(i) = '0' and s_can_tx_fault(i) = '0' else 'Z';
+    s_can_rx(i) <= '1' ?= s_can_bus;
+
+    s_awvalid(i) <= s_axi_awvalid when s_axi_sel = i else '0';
+    s_wvalid(i)  <= s_axi_wvalid  when s_axi_sel = i else '0';
+    s_bready(i)  <= s_axi_bready  when s_axi_sel = i else '0';
+    s_arvalid(i) <= s_axi_arvalid when s_axi_sel = i else '0';
+    s_rready(i)  <= s_axi_rready  when s_axi_sel = i else '0';
+
+    if_not_TMR_generate : if not G_TMR_TOP_MODULE_EN generate
+      INST_canola_axi_slave : entity work.canola_axi_slave
+        generic map (
+          G_AXI_BASEADDR => C_BASEADDR)
+        port map (
+          CAN_RX            => s_can_rx(i),
+          CAN_TX            => s_can_tx(i),
+          CAN_RX_VALID_IRQ  => s_irq(3*i),
+          CAN_TX_DONE_IRQ   => s_irq(3*i+1),
+          CAN_TX_FAILED_IRQ => s_irq(3*i+2),
+          axi_clk           => s_clk,
+          axi_reset         => s_reset,
+          axi_aresetn       => s_areset_n,
+          axi_awaddr        => s_axi_awaddr,
+          axi_awvalid       => s_awvalid(i),
+          axi_awready       => s_awready(i),
+          axi_wdata         => s_axi_wdata,
+          axi_wvalid        => s_wvalid(i),
+          axi_wready        => s_wready(i),
+          axi_bresp         => s_bresp(i),
+          axi_bvalid        => s_bvalid(i),
+          axi_bready        => s_bready(i),
+          axi_araddr        => s_axi_araddr,
+          axi_arvalid       => s_arvalid(i),
+          axi_arready       => s_arready(i),
+          axi_rdata         => s_rdata(i),
+          axi_rresp         => s_rresp(i),
+          axi_rvalid        => s_rvalid(i),
+          axi_rready        => s_rready(i));
+    end generate if_not_TMR_generate;
+
+    if_TMR_generate : if G_TMR_TOP_MODULE_EN generate
+      INST_canola_axi_slave_tmr : entity work.canola_axi_slave_tmr
+        generic map (
+          G_AXI_BASEADDR       => C_BASEADDR,
+          G_SEE_MITIGATION_EN  => G_SEE_MITIGATION_EN,
+          G_MISMATCH_OUTPUT_EN => false)
+        port map (
+          CAN_RX                  => s_can_rx(i),
+          CAN_TX                  => s_can_tx(i),
+          CAN_RX_VALID_IRQ        => s_irq(3*i),
+          CAN_TX_DONE_IRQ         => s_irq(3*i+1),
+          CAN_TX_FAILED_IRQ       => s_irq(3*i+2),
+          VOTER_MISMATCH_LOGIC    => open,
+          VOTER_MISMATCH_COUNTERS => open,
+          axi_clk                 => s_clk,
+          axi_reset               => s_reset,
+          axi_aresetn             => s_areset_n,
+          axi_awaddr              => s_axi_awaddr,
+          axi_awvalid             => s_awvalid(i),
+          axi_awready             => s_awready(i),
+          axi_wdata               => s_axi_wdata,
+          axi_wvalid              => s_wvalid(i),
+          axi_wready              => s_wready(i),
+          axi_bresp               => s_bresp(i),
+          axi_bvalid              => s_bvalid(i),
+          axi_bready              => s_bready(i),
+          axi_araddr              => s_axi_araddr,
+          axi_arvalid             => s_arvalid(i),
+          axi_arready             => s_arready(i),
+          axi_rdata               => s_rdata(i),
+          axi_rresp               => s_rresp(i),
+          axi_rvalid              => s_rvalid(i),
+          axi_rready              => s_rready(i));
+    end generate if_TMR_generate;
+  end generate gen_can_ctrl;
+
+
+  -- Latch rising edges on the interrupt lines until they are reported to
+  -- the firmware. Edges in the cycle where s_irq_ack is set are kept.
+  p_irq_edges : process (s_clk) is
+    variable v_edges : std_logic_vector(C_COSIM_IRQ_LINES-1 downto 0);
+  begin
+    if rising_edge(s_clk) then
+      v_edges := to_stdlogicvector(to_bitvector(s_irq and not s_irq_d));
+      s_irq_d <= to_stdlogicvector(to_bitvector(s_irq));
+
+      if s_irq_ack = '1' then
+        s_irq_pending <= v_edges;
+      else
+        s_irq_pending <= s_irq_pending or v_edges;
+      end if;
+    end if;
+  end process p_irq_edges;
+
+
+  -- Perform the register accesses from the firmware in batches
+  p_firmware : process is
+    variable v_op_count  : integer;
+    variable v_kind      : integer;
+    variable v_addr      : integer;
+    variable v_data      : integer;
+    variable v_irq_edges : integer;
+    variable v_rdata     : t_axi_word;
+
+    -- Select the slave for an address, false if there is no slave there
+    procedure select_slave (
+      constant addr  : in  t_axi_word;
+      variable found : out boolean) is
+      variable v_index : natural;
+    begin
+      found := false;
+
+      if unsigned(addr) >= C_BASEADDR_0 then
+        v_index := to_integer((unsigned(addr) - C_BASEADDR_0) / C_BASEADDR_STRIDE);
+        if v_index < C_NUM_CTRL then
+          s_axi_sel <= v_index;
+          found     := true;
+        end if;
+      end if;
+    end procedure select_slave;
+
+    procedure axi_write (
+      constant addr : in t_axi_word;
+      constant data : in t_axi_word) is
+      variable v_found : boolean;
+    begin
+      select_slave(addr, v_found);
+      if not v_found then
+        report "Write to unmapped address 0x" & to_hstring(addr) severity warning;
+        return;
+      end if;
+
+      s_axi_awaddr  <= addr;
+      s_axi_awvalid <= '1';
+      s_axi_wdata   <= data;
+      s_axi_wvalid  <= '1';
+      s_axi_bready  <= '1';
+
+      wait until rising_edge(s_clk) and s_axi_awready = '1' and s_axi_wready = '1';
+      s_axi_awvalid <= '0';
+      s_axi_wvalid  <= '0';
+
+      wait until rising_edge(s_clk) and s_axi_bvalid = '1';
+      s_axi_bready <= '0';
+
+      assert s_axi_bresp = "00"
+        report "Write to 0x" & to_hstring(addr) & " failed" severity warning;
+    end procedure axi_write;
+
+    procedure axi_read (
+      constant addr : in  t_axi_word;
+      variable data : out t_axi_word) is
+      variable v_found : boolean;
+    begin
+      select_slave(addr, v_found);
+      if not v_found then
+        report "Read from unmapped address 0x" & to_hstring(addr) severity warning;
+        data := (others => '0');
+        return;
+      end if;
+
+      s_axi_araddr  <= addr;
+      s_axi_arvalid <= '1';
+      s_axi_rready  <= '1';
+
+      wait until rising_edge(s_clk) and s_axi_arready = '1';
+      s_axi_arvalid <= '0';
+
+      wait until rising_edge(s_clk) and s_axi_rvalid = '1';
+      s_axi_rready <= '0';
+      data         := s_axi_rdata;
+
+      assert s_axi_rresp = "00"
+        report "Read from 0x" & to_hstring(addr) & " failed" severity warning;
+    end procedure axi_read;
+
+    function to_word (
+      constant value : in integer)
+      return t_axi_word is
+    begin
+      return std_logic_vector(to_signed(value, 32));
+    end function to_word;
+
+  begin
+    s_reset <= '1';
+    wait for 10*C_CLK_PERIOD;
+    wait until rising_edge(s_clk);
+    s_reset <= '0';
+    wait for 10*C_CLK_PERIOD;
+    wait until rising_edge(s_clk);
+
+    loop
+      v_irq_edges := to_integer(unsigned(s_irq_pending));
+
+      if s_irq_pending /= C_NO_IRQ then
+        s_irq_ack <= '1';
+        wait until rising_edge(s_clk);
+        s_irq_ack <= '0';
+      end if;
+
+      v_op_count := cosim_sync(v_irq_edges, now / 1 us);
+      exit when v_op_count < 0;
+
+      for i in 0 to v_op_count-1 loop
+        cosim_get_op(i, v_kind, v_addr, v_data);
+
+        case v_kind is
+          when C_COSIM_OP_WRITE =>
+            axi_write(to_word(v_addr), to_word(v_data));
+
+          when C_COSIM_OP_READ =>
+            axi_read(to_word(v_addr), v_rdata);
+            cosim_put_read(i, to_integer(signed(v_rdata)));
+
+          when C_COSIM_OP_WAIT =>
+            -- Wake the firmware up early for interrupts
+            if s_irq_pending = C_NO_IRQ then
+              wait until s_irq_pending /= C_NO_IRQ for v_data * 1 us;
+            end if;
+            wait until rising_edge(s_clk);
+
+          when C_COSIM_OP_IDLE =>
+            for cycle in 1 to v_data loop
+              wait until rising_edge(s_clk);
+            end loop;
+
+          when C_COSIM_OP_TX_FAULT =>
+            for ctrl in 0 to C_NUM_CTRL-1 loop
+              s_can_tx_fault(ctrl) <= to_unsigned(v_data, C_NUM_CTRL)(ctrl);
+            end loop;
+            wait until rising_edge(s_clk);
+
+          when others =>
+            report "Unknown co-simulation operation " & integer'image(v_kind)
+              severity failure;
+        end case;
+      end loop;
+    end loop;
+
+    report "Firmware finished at " & time'image(now);
+    std.env.finish;
+  end process p_firmware;
+
+end architecture tb;
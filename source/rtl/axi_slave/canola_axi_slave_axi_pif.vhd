@@ -146,6 +146,11 @@ begin
             axi_pulse_regs_cycle.CONTROL.RESET_RX_CRC_ERROR_COUNTER <= wdata(8);
             axi_pulse_regs_cycle.CONTROL.RESET_RX_FORM_ERROR_COUNTER <= wdata(9);
             axi_pulse_regs_cycle.CONTROL.RESET_RX_STUFF_ERROR_COUNTER <= wdata(10);
+            axi_pulse_regs_cycle.CONTROL.FILTER_WRITE <= wdata(11);
+            axi_pulse_regs_cycle.CONTROL.RX_FIFO_POP <= wdata(12);
+            axi_pulse_regs_cycle.CONTROL.RX_FIFO_FLUSH <= wdata(13);
+            axi_pulse_regs_cycle.CONTROL.RX_FIFO_CLEAR_OVERFLOW <= wdata(14);
+            axi_pulse_regs_cycle.CONTROL.TX_MAILBOX_LOAD <= wdata(15);
           
           end if;
       
@@ -153,6 +158,9 @@ begin
           
             axi_rw_regs_i.CONFIG.TX_RETRANSMIT_EN <= wdata(0);
             axi_rw_regs_i.CONFIG.BTL_TRIPLE_SAMPLING_EN <= wdata(1);
+            axi_rw_regs_i.CONFIG.ACCEPTANCE_FILTER_EN <= wdata(2);
+            axi_rw_regs_i.CONFIG.RX_FIFO_EN <= wdata(3);
+            axi_rw_regs_i.CONFIG.TX_MAILBOX_EN <= wdata(4);
           
           end if;
       
@@ -219,6 +227,49 @@ begin
           
           end if;
       
+          if unsigned(awaddr_i) = resize(unsigned(C_BASEADDR) + unsigned(C_ADDR_FILTER_INDEX), 32) then
+          
+            axi_rw_regs_i.FILTER_INDEX <= wdata(7 downto 0);
+          
+          end if;
+      
+          if unsigned(awaddr_i) = resize(unsigned(C_BASEADDR) + unsigned(C_ADDR_FILTER_ID), 32) then
+          
+            axi_rw_regs_i.FILTER_ID.EXT_ID_EN <= wdata(0);
+            axi_rw_regs_i.FILTER_ID.RTR_EN <= wdata(1);
+            axi_rw_regs_i.FILTER_ID.ARB_ID_B <= wdata(19 downto 2);
+            axi_rw_regs_i.FILTER_ID.ARB_ID_A <= wdata(30 downto 20);
+            axi_rw_regs_i.FILTER_ID.ENABLE <= wdata(31);
+          
+          end if;
+      
+          if unsigned(awaddr_i) = resize(unsigned(C_BASEADDR) + unsigned(C_ADDR_FILTER_MASK), 32) then
+          
+            axi_rw_regs_i.FILTER_MASK.EXT_ID_EN <= wdata(0);
+            axi_rw_regs_i.FILTER_MASK.RTR_EN <= wdata(1);
+            axi_rw_regs_i.FILTER_MASK.ARB_ID_B <= wdata(19 downto 2);
+            axi_rw_regs_i.FILTER_MASK.ARB_ID_A <= wdata(30 downto 20);
+          
+          end if;
+      
+          if unsigned(awaddr_i) = resize(unsigned(C_BASEADDR) + unsigned(C_ADDR_RX_FIFO_IRQ_LEVEL), 32) then
+          
+            axi_rw_regs_i.RX_FIFO_IRQ_LEVEL <= wdata(8 downto 0);
+          
+          end if;
+      
+          if unsigned(awaddr_i) = resize(unsigned(C_BASEADDR) + unsigned(C_ADDR_TX_MAILBOX_INDEX), 32) then
+          
+            axi_rw_regs_i.TX_MAILBOX_INDEX <= wdata(4 downto 0);
+          
+          end if;
+      
+          if unsigned(awaddr_i) = resize(unsigned(C_BASEADDR) + unsigned(C_ADDR_TX_MAILBOX_ABORT), 32) then
+          
+            axi_pulse_regs_cycle.TX_MAILBOX_ABORT <= wdata(31 downto 0);
+          
+          end if;
+      
       end if;
   
     end if;
@@ -246,6 +297,28 @@ begin
   end if;
 end process p_pulse_CONTROL;
 
+p_pulse_TX_MAILBOX_ABORT : process(clk)
+variable cnt : natural range 0 to 0 := 0;
+begin
+  if rising_edge(clk) then
+    if areset_n = '0' then
+      axi_pulse_regs_i.TX_MAILBOX_ABORT <= c_canola_axi_slave_pulse_regs.TX_MAILBOX_ABORT;
+    else
+      if axi_pulse_regs_cycle.TX_MAILBOX_ABORT /= c_canola_axi_slave_pulse_regs.TX_MAILBOX_ABORT then
+        cnt := 0;
+        axi_pulse_regs_i.TX_MAILBOX_ABORT <= axi_pulse_regs_cycle.TX_MAILBOX_ABORT;
+      else
+        if cnt > 0 then
+          cnt := cnt - 1;
+        else
+          axi_pulse_regs_i.TX_MAILBOX_ABORT <= c_canola_axi_slave_pulse_regs.TX_MAILBOX_ABORT;
+        end if;
+      end if;
+
+    end if;
+  end if;
+end process p_pulse_TX_MAILBOX_ABORT;
+
   p_write_response : process(clk, areset_n)
   begin
     if areset_n = '0' then
@@ -312,6 +385,9 @@ end process p_pulse_CONTROL;
     
       reg_data_out(0) <= axi_rw_regs_i.CONFIG.TX_RETRANSMIT_EN;
       reg_data_out(1) <= axi_rw_regs_i.CONFIG.BTL_TRIPLE_SAMPLING_EN;
+      reg_data_out(2) <= axi_rw_regs_i.CONFIG.ACCEPTANCE_FILTER_EN;
+      reg_data_out(3) <= axi_rw_regs_i.CONFIG.RX_FIFO_EN;
+      reg_data_out(4) <= axi_rw_regs_i.CONFIG.TX_MAILBOX_EN;
     
     end if;
     
@@ -483,6 +559,100 @@ end process p_pulse_CONTROL;
     
     end if;
     
+    if unsigned(araddr_i) = resize(unsigned(C_BASEADDR) + unsigned(C_ADDR_FILTER_INDEX), 32) then
+    
+      reg_data_out(7 downto 0) <= axi_rw_regs_i.FILTER_INDEX;
+    
+    end if;
+    
+    if unsigned(araddr_i) = resize(unsigned(C_BASEADDR) + unsigned(C_ADDR_FILTER_ID), 32) then
+    
+      reg_data_out(0) <= axi_rw_regs_i.FILTER_ID.EXT_ID_EN;
+      reg_data_out(1) <= axi_rw_regs_i.FILTER_ID.RTR_EN;
+      reg_data_out(19 downto 2) <= axi_rw_regs_i.FILTER_ID.ARB_ID_B;
+      reg_data_out(30 downto 20) <= axi_rw_regs_i.FILTER_ID.ARB_ID_A;
+      reg_data_out(31) <= axi_rw_regs_i.FILTER_ID.ENABLE;
+    
+    end if;
+    
+    if unsigned(araddr_i) = resize(unsigned(C_BASEADDR) + unsigned(C_ADDR_FILTER_MASK), 32) then
+    
+      reg_data_out(0) <= axi_rw_regs_i.FILTER_MASK.EXT_ID_EN;
+      reg_data_out(1) <= axi_rw_regs_i.FILTER_MASK.RTR_EN;
+      reg_data_out(19 downto 2) <= axi_rw_regs_i.FILTER_MASK.ARB_ID_B;
+      reg_data_out(30 downto 20) <= axi_rw_regs_i.FILTER_MASK.ARB_ID_A;
+    
+    end if;
+    
+    if unsigned(araddr_i) = resize(unsigned(C_BASEADDR) + unsigned(C_ADDR_RX_FILTER_HIT), 32) then
+    
+      reg_data_out(7 downto 0) <= axi_ro_regs.RX_FILTER_HIT;
+    
+    end if;
+    
+    if unsigned(araddr_i) = resize(unsigned(C_BASEADDR) + unsigned(C_ADDR_RX_FIFO_STATUS), 32) then
+    
+      reg_data_out(8 downto 0) <= axi_ro_regs.RX_FIFO_STATUS.FILL_LEVEL;
+      reg_data_out(9) <= axi_ro_regs.RX_FIFO_STATUS.EMPTY;
+      reg_data_out(10) <= axi_ro_regs.RX_FIFO_STATUS.FULL;
+      reg_data_out(11) <= axi_ro_regs.RX_FIFO_STATUS.OVERFLOW;
+    
+    end if;
+    
+    if unsigned(araddr_i) = resize(unsigned(C_BASEADDR) + unsigned(C_ADDR_RX_FIFO_IRQ_LEVEL), 32) then
+    
+      reg_data_out(8 downto 0) <= axi_rw_regs_i.RX_FIFO_IRQ_LEVEL;
+    
+    end if;
+    
+    if unsigned(araddr_i) = resize(unsigned(C_BASEADDR) + unsigned(C_ADDR_TX_MAILBOX_INDEX), 32) then
+    
+      reg_data_out(4 downto 0) <= axi_rw_regs_i.TX_MAILBOX_INDEX;
+    
+    end if;
+    
+    if unsigned(araddr_i) = resize(unsigned(C_BASEADDR) + unsigned(C_ADDR_TX_MAILBOX_PENDING), 32) then
+    
+      reg_data_out(31 downto 0) <= axi_ro_regs.TX_MAILBOX_PENDING;
+    
+    end if;
+    
+    if unsigned(araddr_i) = resize(unsigned(C_BASEADDR) + unsigned(C_ADDR_TX_MAILBOX_DONE), 32) then
+    
+      reg_data_out(31 downto 0) <= axi_ro_regs.TX_MAILBOX_DONE;
+    
+    end if;
+    
+    if unsigned(araddr_i) = resize(unsigned(C_BASEADDR) + unsigned(C_ADDR_TX_MAILBOX_FAILED), 32) then
+    
+      reg_data_out(31 downto 0) <= axi_ro_regs.TX_MAILBOX_FAILED;
+    
+    end if;
+    
+    if unsigned(araddr_i) = resize(unsigned(C_BASEADDR) + unsigned(C_ADDR_TX_MAILBOX_COUNT), 32) then
+    
+      reg_data_out(5 downto 0) <= axi_ro_regs.TX_MAILBOX_COUNT;
+    
+    end if;
+    
+    if unsigned(araddr_i) = resize(unsigned(C_BASEADDR) + unsigned(C_ADDR_TIMESTAMP), 32) then
+    
+      reg_data_out(31 downto 0) <= axi_ro_regs.TIMESTAMP;
+    
+    end if;
+    
+    if unsigned(araddr_i) = resize(unsigned(C_BASEADDR) + unsigned(C_ADDR_RX_TIMESTAMP), 32) then
+    
+      reg_data_out(31 downto 0) <= axi_ro_regs.RX_TIMESTAMP;
+    
+    end if;
+    
+    if unsigned(araddr_i) = resize(unsigned(C_BASEADDR) + unsigned(C_ADDR_TX_TIMESTAMP), 32) then
+    
+      reg_data_out(31 downto 0) <= axi_ro_regs.TX_TIMESTAMP;
+    
+    end if;
+    
   end process p_mm_select_read;
 
   p_output : process(clk, areset_n)
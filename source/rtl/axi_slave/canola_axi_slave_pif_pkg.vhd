@@ -39,12 +39,30 @@ package canola_axi_slave_pif_pkg is
   constant C_ADDR_RX_PAYLOAD_LENGTH : t_canola_axi_slave_addr := 32X"78";
   constant C_ADDR_RX_PAYLOAD_0 : t_canola_axi_slave_addr := 32X"7C";
   constant C_ADDR_RX_PAYLOAD_1 : t_canola_axi_slave_addr := 32X"80";
+  constant C_ADDR_FILTER_INDEX : t_canola_axi_slave_addr := 32X"84";
+  constant C_ADDR_FILTER_ID : t_canola_axi_slave_addr := 32X"88";
+  constant C_ADDR_FILTER_MASK : t_canola_axi_slave_addr := 32X"8C";
+  constant C_ADDR_RX_FILTER_HIT : t_canola_axi_slave_addr := 32X"90";
+  constant C_ADDR_RX_FIFO_STATUS : t_canola_axi_slave_addr := 32X"94";
+  constant C_ADDR_RX_FIFO_IRQ_LEVEL : t_canola_axi_slave_addr := 32X"98";
+  constant C_ADDR_TX_MAILBOX_INDEX : t_canola_axi_slave_addr := 32X"9C";
+  constant C_ADDR_TX_MAILBOX_ABORT : t_canola_axi_slave_addr := 32X"A0";
+  constant C_ADDR_TX_MAILBOX_PENDING : t_canola_axi_slave_addr := 32X"A4";
+  constant C_ADDR_TX_MAILBOX_DONE : t_canola_axi_slave_addr := 32X"A8";
+  constant C_ADDR_TX_MAILBOX_FAILED : t_canola_axi_slave_addr := 32X"AC";
+  constant C_ADDR_TX_MAILBOX_COUNT : t_canola_axi_slave_addr := 32X"B0";
+  constant C_ADDR_TIMESTAMP : t_canola_axi_slave_addr := 32X"B4";
+  constant C_ADDR_RX_TIMESTAMP : t_canola_axi_slave_addr := 32X"B8";
+  constant C_ADDR_TX_TIMESTAMP : t_canola_axi_slave_addr := 32X"BC";
   
   -- RW Register Record Definitions
   
   type t_canola_axi_slave_rw_CONFIG is record
     TX_RETRANSMIT_EN : std_logic;
     BTL_TRIPLE_SAMPLING_EN : std_logic;
+    ACCEPTANCE_FILTER_EN : std_logic;
+    RX_FIFO_EN : std_logic;
+    TX_MAILBOX_EN : std_logic;
   end record;
   
   type t_canola_axi_slave_rw_TX_MSG_ID is record
@@ -68,6 +86,21 @@ package canola_axi_slave_pif_pkg is
     PAYLOAD_BYTE_7 : std_logic_vector(7 downto 0);
   end record;
   
+  type t_canola_axi_slave_rw_FILTER_ID is record
+    EXT_ID_EN : std_logic;
+    RTR_EN : std_logic;
+    ARB_ID_B : std_logic_vector(17 downto 0);
+    ARB_ID_A : std_logic_vector(10 downto 0);
+    ENABLE : std_logic;
+  end record;
+  
+  type t_canola_axi_slave_rw_FILTER_MASK is record
+    EXT_ID_EN : std_logic;
+    RTR_EN : std_logic;
+    ARB_ID_B : std_logic_vector(17 downto 0);
+    ARB_ID_A : std_logic_vector(10 downto 0);
+  end record;
+  
   type t_canola_axi_slave_rw_regs is record
     CONFIG : t_canola_axi_slave_rw_CONFIG;
     BTL_PROP_SEG : std_logic_vector(15 downto 0);
@@ -79,6 +112,11 @@ package canola_axi_slave_pif_pkg is
     TX_PAYLOAD_LENGTH : std_logic_vector(3 downto 0);
     TX_PAYLOAD_0 : t_canola_axi_slave_rw_TX_PAYLOAD_0;
     TX_PAYLOAD_1 : t_canola_axi_slave_rw_TX_PAYLOAD_1;
+    FILTER_INDEX : std_logic_vector(7 downto 0);
+    FILTER_ID : t_canola_axi_slave_rw_FILTER_ID;
+    FILTER_MASK : t_canola_axi_slave_rw_FILTER_MASK;
+    RX_FIFO_IRQ_LEVEL : std_logic_vector(8 downto 0);
+    TX_MAILBOX_INDEX : std_logic_vector(4 downto 0);
   end record;
 
   -- RW Register Reset Value Constant
@@ -86,7 +124,10 @@ package canola_axi_slave_pif_pkg is
   constant c_canola_axi_slave_rw_regs : t_canola_axi_slave_rw_regs := (
     CONFIG => (
       TX_RETRANSMIT_EN => '0',
-      BTL_TRIPLE_SAMPLING_EN => '0'),
+      BTL_TRIPLE_SAMPLING_EN => '0',
+      ACCEPTANCE_FILTER_EN => '0',
+      RX_FIFO_EN => '0',
+      TX_MAILBOX_EN => '0'),
     BTL_PROP_SEG => 16X"7",
     BTL_PHASE_SEG1 => 16X"7",
     BTL_PHASE_SEG2 => 16X"7",
@@ -107,7 +148,21 @@ package canola_axi_slave_pif_pkg is
       PAYLOAD_BYTE_4 => (others => '0'),
       PAYLOAD_BYTE_5 => (others => '0'),
       PAYLOAD_BYTE_6 => (others => '0'),
-      PAYLOAD_BYTE_7 => (others => '0')));
+      PAYLOAD_BYTE_7 => (others => '0')),
+    FILTER_INDEX => (others => '0'),
+    FILTER_ID => (
+      EXT_ID_EN => '0',
+      RTR_EN => '0',
+      ARB_ID_B => (others => '0'),
+      ARB_ID_A => (others => '0'),
+      ENABLE => '0'),
+    FILTER_MASK => (
+      EXT_ID_EN => '0',
+      RTR_EN => '0',
+      ARB_ID_B => (others => '0'),
+      ARB_ID_A => (others => '0')),
+    RX_FIFO_IRQ_LEVEL => 9X"1",
+    TX_MAILBOX_INDEX => (others => '0'));
 
   -- RO Register Record Definitions
   
@@ -140,6 +195,13 @@ package canola_axi_slave_pif_pkg is
     PAYLOAD_BYTE_7 : std_logic_vector(7 downto 0);
   end record;
   
+  type t_canola_axi_slave_ro_RX_FIFO_STATUS is record
+    FILL_LEVEL : std_logic_vector(8 downto 0);
+    EMPTY : std_logic;
+    FULL : std_logic;
+    OVERFLOW : std_logic;
+  end record;
+  
   type t_canola_axi_slave_ro_regs is record
     STATUS : t_canola_axi_slave_ro_STATUS;
     TRANSMIT_ERROR_COUNT : std_logic_vector(15 downto 0);
@@ -158,6 +220,15 @@ package canola_axi_slave_pif_pkg is
     RX_PAYLOAD_LENGTH : std_logic_vector(3 downto 0);
     RX_PAYLOAD_0 : t_canola_axi_slave_ro_RX_PAYLOAD_0;
     RX_PAYLOAD_1 : t_canola_axi_slave_ro_RX_PAYLOAD_1;
+    RX_FILTER_HIT : std_logic_vector(7 downto 0);
+    RX_FIFO_STATUS : t_canola_axi_slave_ro_RX_FIFO_STATUS;
+    TX_MAILBOX_PENDING : t_canola_axi_slave_data;
+    TX_MAILBOX_DONE : t_canola_axi_slave_data;
+    TX_MAILBOX_FAILED : t_canola_axi_slave_data;
+    TX_MAILBOX_COUNT : std_logic_vector(5 downto 0);
+    TIMESTAMP : t_canola_axi_slave_data;
+    RX_TIMESTAMP : t_canola_axi_slave_data;
+    TX_TIMESTAMP : t_canola_axi_slave_data;
   end record;
 
   -- RO Register Reset Value Constant
@@ -196,7 +267,20 @@ package canola_axi_slave_pif_pkg is
       PAYLOAD_BYTE_4 => (others => '0'),
       PAYLOAD_BYTE_5 => (others => '0'),
       PAYLOAD_BYTE_6 => (others => '0'),
-      PAYLOAD_BYTE_7 => (others => '0')));
+      PAYLOAD_BYTE_7 => (others => '0')),
+    RX_FILTER_HIT => (others => '0'),
+    RX_FIFO_STATUS => (
+      FILL_LEVEL => (others => '0'),
+      EMPTY => '0',
+      FULL => '0',
+      OVERFLOW => '0'),
+    TX_MAILBOX_PENDING => (others => '0'),
+    TX_MAILBOX_DONE => (others => '0'),
+    TX_MAILBOX_FAILED => (others => '0'),
+    TX_MAILBOX_COUNT => (others => '0'),
+    TIMESTAMP => (others => '0'),
+    RX_TIMESTAMP => (others => '0'),
+    TX_TIMESTAMP => (others => '0'));
   -- PULSE Register Record Definitions
   
   type t_canola_axi_slave_pulse_CONTROL is record
@@ -211,10 +295,16 @@ package canola_axi_slave_pif_pkg is
     RESET_RX_CRC_ERROR_COUNTER : std_logic;
     RESET_RX_FORM_ERROR_COUNTER : std_logic;
     RESET_RX_STUFF_ERROR_COUNTER : std_logic;
+    FILTER_WRITE : std_logic;
+    RX_FIFO_POP : std_logic;
+    RX_FIFO_FLUSH : std_logic;
+    RX_FIFO_CLEAR_OVERFLOW : std_logic;
+    TX_MAILBOX_LOAD : std_logic;
   end record;
   
   type t_canola_axi_slave_pulse_regs is record
     CONTROL : t_canola_axi_slave_pulse_CONTROL;
+    TX_MAILBOX_ABORT : t_canola_axi_slave_data;
   end record;
 
   -- PULSE Register Reset Value Constant
@@ -231,7 +321,13 @@ package canola_axi_slave_pif_pkg is
       RESET_RX_MSG_RECV_COUNTER => '0',
       RESET_RX_CRC_ERROR_COUNTER => '0',
       RESET_RX_FORM_ERROR_COUNTER => '0',
-      RESET_RX_STUFF_ERROR_COUNTER => '0'));
+      RESET_RX_STUFF_ERROR_COUNTER => '0',
+      FILTER_WRITE => '0',
+      RX_FIFO_POP => '0',
+      RX_FIFO_FLUSH => '0',
+      RX_FIFO_CLEAR_OVERFLOW => '0',
+      TX_MAILBOX_LOAD => '0'),
+    TX_MAILBOX_ABORT => (others => '0'));
 
 
 end package canola_axi_slave_pif_pkg;
\ No newline at end of file
@@ -14,7 +14,9 @@ entity canola_axi_slave_tmr is
 
   generic (
     -- User Generics Start
-
+    G_ACCEPTANCE_FILTERS : natural := C_ACCEPTANCE_FILTERS_DEFAULT;
+    G_RX_FIFO_DEPTH      : natural := C_RX_FIFO_DEPTH_DEFAULT;
+    G_TX_MAILBOXES       : natural := C_TX_MAILBOXES_DEFAULT;
     -- User Generics End
     -- AXI Bus Interface Generics
     G_AXI_BASEADDR            : std_logic_vector(31 downto 0) := X"00000000";
@@ -61,9 +63,53 @@ end entity canola_axi_slave_tmr;
 architecture behavior of canola_axi_slave_tmr is
 
   -- User Architecture Start
-  signal s_can_rx_msg      : can_msg_t;
-  signal s_can_tx_msg      : can_msg_t;
-  signal s_can_error_state : can_error_state_t;
+  signal s_can_rx_msg       : can_msg_t;
+  signal s_can_rx_msg_valid : std_logic;
+  signal s_can_tx_msg       : can_msg_t;
+  signal s_can_error_state  : can_error_state_t;
+  signal s_rx_filter_hit    : std_logic_vector(C_ACCEPTANCE_FILTER_INDEX_WIDTH-1 downto 0);
+
+  -- Message shown in the RX registers, either the last received message,
+  -- or the message at the head of the Rx FIFO when it is enabled.
+  -- Note: The Rx FIFO is not triplicated.
+  signal s_rx_msg             : can_msg_t;
+  signal s_rx_fifo_msg        : can_msg_t;
+  signal s_rx_fifo_filter_hit : std_logic_vector(C_ACCEPTANCE_FILTER_INDEX_WIDTH-1 downto 0);
+  signal s_rx_fifo_wr_en      : std_logic;
+  signal s_rx_fifo_flush      : std_logic;
+  signal s_rx_fifo_empty      : std_logic;
+  signal s_rx_fifo_irq        : std_logic;
+
+  -- Without the Rx FIFO, set when a message is received, and cleared when
+  -- it is popped with RX_FIFO_POP
+  signal s_rx_msg_valid : std_logic;
+
+  -- Message and start signal to the Tx FSM, either from the TX registers,
+  -- or from the Tx mailboxes when they are enabled.
+  -- Note: The Tx mailboxes are not triplicated.
+  signal s_tx_msg           : can_msg_t;
+  signal s_tx_start         : std_logic;
+  signal s_tx_abort         : std_logic;
+  signal s_tx_reload        : std_logic;
+  signal s_can_tx_busy      : std_logic;
+  signal s_can_tx_done      : std_logic;
+  signal s_can_tx_failed    : std_logic;
+  signal s_tx_mailbox_msg   : can_msg_t;
+  signal s_tx_mailbox_start : std_logic;
+  signal s_tx_mailbox_abort : std_logic;
+  signal s_tx_mailbox_reload : std_logic;
+  signal s_tx_mailbox_reset : std_logic;
+
+  -- Free-running timestamp counter, latched for received messages (when
+  -- they are accepted, with RX_MSG_VALID) and transmitted messages (TX_DONE).
+  -- Note: The timestamp counter is not triplicated.
+  signal s_timestamp         : unsigned(C_TIMESTAMP_WIDTH-1 downto 0);
+  signal s_rx_timestamp      : std_logic_vector(C_TIMESTAMP_WIDTH-1 downto 0);
+  signal s_rx_fifo_timestamp : std_logic_vector(C_TIMESTAMP_WIDTH-1 downto 0);
+  signal s_tx_timestamp      : std_logic_vector(C_TIMESTAMP_WIDTH-1 downto 0);
+
+  -- Acceptance filter entry, written to filter FILTER_INDEX on FILTER_WRITE
+  signal s_acceptance_filter : can_acceptance_filter_t;
 
   constant C_COUNTER_REG_WIDTH : natural := 32;
 
@@ -102,19 +148,100 @@ begin
   s_can_tx_msg.data(6)        <= axi_rw_regs.TX_PAYLOAD_1.PAYLOAD_BYTE_6;
   s_can_tx_msg.data(7)        <= axi_rw_regs.TX_PAYLOAD_1.PAYLOAD_BYTE_7;
 
-  axi_ro_regs.RX_MSG_ID.EXT_ID_EN         <= s_can_rx_msg.ext_id;
-  axi_ro_regs.RX_MSG_ID.RTR_EN            <= s_can_rx_msg.remote_request;
-  axi_ro_regs.RX_MSG_ID.ARB_ID_A          <= s_can_rx_msg.arb_id_a;
-  axi_ro_regs.RX_MSG_ID.ARB_ID_B          <= s_can_rx_msg.arb_id_b;
-  axi_ro_regs.RX_PAYLOAD_LENGTH           <= s_can_rx_msg.data_length;
-  axi_ro_regs.RX_PAYLOAD_0.PAYLOAD_BYTE_0 <= s_can_rx_msg.data(0);
-  axi_ro_regs.RX_PAYLOAD_0.PAYLOAD_BYTE_1 <= s_can_rx_msg.data(1);
-  axi_ro_regs.RX_PAYLOAD_0.PAYLOAD_BYTE_2 <= s_can_rx_msg.data(2);
-  axi_ro_regs.RX_PAYLOAD_0.PAYLOAD_BYTE_3 <= s_can_rx_msg.data(3);
-  axi_ro_regs.RX_PAYLOAD_1.PAYLOAD_BYTE_4 <= s_can_rx_msg.data(4);
-  axi_ro_regs.RX_PAYLOAD_1.PAYLOAD_BYTE_5 <= s_can_rx_msg.data(5);
-  axi_ro_regs.RX_PAYLOAD_1.PAYLOAD_BYTE_6 <= s_can_rx_msg.data(6);
-  axi_ro_regs.RX_PAYLOAD_1.PAYLOAD_BYTE_7 <= s_can_rx_msg.data(7);
+  s_tx_msg   <= s_tx_mailbox_msg when axi_rw_regs.CONFIG.TX_MAILBOX_EN = '1' else s_can_tx_msg;
+  s_tx_start <= s_tx_mailbox_start when axi_rw_regs.CONFIG.TX_MAILBOX_EN = '1' else
+                axi_pulse_regs.CONTROL.TX_START;
+  s_tx_abort <= s_tx_mailbox_abort and axi_rw_regs.CONFIG.TX_MAILBOX_EN;
+  s_tx_reload <= s_tx_mailbox_reload and axi_rw_regs.CONFIG.TX_MAILBOX_EN;
+
+  s_tx_mailbox_reset <= AXI_RESET or not axi_rw_regs.CONFIG.TX_MAILBOX_EN;
+
+  axi_ro_regs.TX_MAILBOX_COUNT <= std_logic_vector(to_unsigned(G_TX_MAILBOXES, axi_ro_regs.TX_MAILBOX_COUNT'length));
+
+  axi_ro_regs.STATUS.TX_BUSY <= s_can_tx_busy;
+  CAN_TX_DONE_IRQ            <= s_can_tx_done;
+  CAN_TX_FAILED_IRQ          <= s_can_tx_failed;
+
+  s_rx_msg <= s_rx_fifo_msg when axi_rw_regs.CONFIG.RX_FIFO_EN = '1' else s_can_rx_msg;
+
+  axi_ro_regs.RX_FILTER_HIT <= s_rx_fifo_filter_hit when axi_rw_regs.CONFIG.RX_FIFO_EN = '1' else
+                               s_rx_filter_hit;
+
+  axi_ro_regs.RX_MSG_ID.EXT_ID_EN         <= s_rx_msg.ext_id;
+  axi_ro_regs.RX_MSG_ID.RTR_EN            <= s_rx_msg.remote_request;
+  axi_ro_regs.RX_MSG_ID.ARB_ID_A          <= s_rx_msg.arb_id_a;
+  axi_ro_regs.RX_MSG_ID.ARB_ID_B          <= s_rx_msg.arb_id_b;
+  axi_ro_regs.RX_PAYLOAD_LENGTH           <= s_rx_msg.data_length;
+  axi_ro_regs.RX_PAYLOAD_0.PAYLOAD_BYTE_0 <= s_rx_msg.data(0);
+  axi_ro_regs.RX_PAYLOAD_0.PAYLOAD_BYTE_1 <= s_rx_msg.data(1);
+  axi_ro_regs.RX_PAYLOAD_0.PAYLOAD_BYTE_2 <= s_rx_msg.data(2);
+  axi_ro_regs.RX_PAYLOAD_0.PAYLOAD_BYTE_3 <= s_rx_msg.data(3);
+  axi_ro_regs.RX_PAYLOAD_1.PAYLOAD_BYTE_4 <= s_rx_msg.data(4);
+  axi_ro_regs.RX_PAYLOAD_1.PAYLOAD_BYTE_5 <= s_rx_msg.data(5);
+  axi_ro_regs.RX_PAYLOAD_1.PAYLOAD_BYTE_6 <= s_rx_msg.data(6);
+  axi_ro_regs.RX_PAYLOAD_1.PAYLOAD_BYTE_7 <= s_rx_msg.data(7);
+
+  s_acceptance_filter.ext_id              <= axi_rw_regs.FILTER_ID.EXT_ID_EN;
+  s_acceptance_filter.remote_request      <= axi_rw_regs.FILTER_ID.RTR_EN;
+  s_acceptance_filter.arb_id_a            <= axi_rw_regs.FILTER_ID.ARB_ID_A;
+  s_acceptance_filter.arb_id_b            <= axi_rw_regs.FILTER_ID.ARB_ID_B;
+  s_acceptance_filter.ext_id_mask         <= axi_rw_regs.FILTER_MASK.EXT_ID_EN;
+  s_acceptance_filter.remote_request_mask <= axi_rw_regs.FILTER_MASK.RTR_EN;
+  s_acceptance_filter.arb_id_a_mask       <= axi_rw_regs.FILTER_MASK.ARB_ID_A;
+  s_acceptance_filter.arb_id_b_mask       <= axi_rw_regs.FILTER_MASK.ARB_ID_B;
+
+  -- With the Rx FIFO enabled, the Rx valid interrupt is pulsed based on the
+  -- fill level of the FIFO instead of for every received message.
+  CAN_RX_VALID_IRQ <= s_rx_fifo_irq when axi_rw_regs.CONFIG.RX_FIFO_EN = '1' else
+                      s_can_rx_msg_valid;
+
+  axi_ro_regs.STATUS.RX_MSG_VALID <= not s_rx_fifo_empty when axi_rw_regs.CONFIG.RX_FIFO_EN = '1' else
+                                     s_rx_msg_valid;
+  axi_ro_regs.RX_FIFO_STATUS.EMPTY <= s_rx_fifo_empty;
+
+  s_rx_fifo_wr_en <= s_can_rx_msg_valid and axi_rw_regs.CONFIG.RX_FIFO_EN;
+  s_rx_fifo_flush <= axi_pulse_regs.CONTROL.RX_FIFO_FLUSH or not axi_rw_regs.CONFIG.RX_FIFO_EN;
+
+  axi_ro_regs.TIMESTAMP    <= std_logic_vector(s_timestamp);
+  axi_ro_regs.RX_TIMESTAMP <= s_rx_fifo_timestamp when axi_rw_regs.CONFIG.RX_FIFO_EN = '1' else
+                              s_rx_timestamp;
+  axi_ro_regs.TX_TIMESTAMP <= s_tx_timestamp;
+
+  proc_rx_msg_valid : process(AXI_CLK) is
+  begin
+    if rising_edge(AXI_CLK) then
+      if AXI_RESET = '1' or axi_rw_regs.CONFIG.RX_FIFO_EN = '1' then
+        s_rx_msg_valid <= '0';
+      elsif s_can_rx_msg_valid = '1' then
+        -- A new message replaces the one in the RX registers, also
+        -- when it is popped in the same cycle
+        s_rx_msg_valid <= '1';
+      elsif axi_pulse_regs.CONTROL.RX_FIFO_POP = '1' then
+        s_rx_msg_valid <= '0';
+      end if;
+    end if;
+  end process proc_rx_msg_valid;
+
+  proc_timestamp : process(AXI_CLK) is
+  begin
+    if rising_edge(AXI_CLK) then
+      if AXI_RESET = '1' then
+        s_timestamp    <= (others => '0');
+        s_rx_timestamp <= (others => '0');
+        s_tx_timestamp <= (others => '0');
+      else
+        s_timestamp <= s_timestamp + 1;
+
+        if s_can_rx_msg_valid = '1' then
+          s_rx_timestamp <= std_logic_vector(s_timestamp);
+        end if;
+
+        if s_can_tx_done = '1' then
+          s_tx_timestamp <= std_logic_vector(s_timestamp);
+        end if;
+      end if;
+    end if;
+  end process proc_timestamp;
 
   with s_can_error_state select
     axi_ro_regs.STATUS.ERROR_STATE <=
@@ -126,7 +253,8 @@ begin
     generic map (
       G_SEE_MITIGATION_EN       => G_SEE_MITIGATION_EN,
       G_MISMATCH_OUTPUT_EN      => G_MISMATCH_OUTPUT_EN,
-      G_TIME_QUANTA_SCALE_WIDTH => C_TIME_QUANTA_SCALE_WIDTH_DEFAULT)
+      G_TIME_QUANTA_SCALE_WIDTH => C_TIME_QUANTA_SCALE_WIDTH_DEFAULT,
+      G_ACCEPTANCE_FILTERS      => G_ACCEPTANCE_FILTERS)
     port map (
       CLK   => AXI_CLK,
       RESET => AXI_RESET,
@@ -137,15 +265,25 @@ begin
 
       -- Rx interface
       RX_MSG       => s_can_rx_msg,
-      RX_MSG_VALID => CAN_RX_VALID_IRQ,
+      RX_MSG_VALID => s_can_rx_msg_valid,
+
+      -- Acceptance filter
+      ACCEPTANCE_FILTER_EN        => axi_rw_regs.CONFIG.ACCEPTANCE_FILTER_EN,
+      ACCEPTANCE_FILTER_WR_EN     => axi_pulse_regs.CONTROL.FILTER_WRITE,
+      ACCEPTANCE_FILTER_WR_INDEX  => axi_rw_regs.FILTER_INDEX,
+      ACCEPTANCE_FILTER_WR_ENABLE => axi_rw_regs.FILTER_ID.ENABLE,
+      ACCEPTANCE_FILTER_WR_DATA   => s_acceptance_filter,
+      RX_FILTER_HIT               => s_rx_filter_hit,
 
       -- Tx interface
-      TX_MSG           => s_can_tx_msg,
-      TX_START         => axi_pulse_regs.CONTROL.TX_START,
+      TX_MSG           => s_tx_msg,
+      TX_START         => s_tx_start,
       TX_RETRANSMIT_EN => axi_rw_regs.CONFIG.TX_RETRANSMIT_EN,
-      TX_BUSY          => axi_ro_regs.STATUS.TX_BUSY,
-      TX_DONE          => CAN_TX_DONE_IRQ,
-      TX_FAILED        => CAN_TX_FAILED_IRQ,
+      TX_MSG_RELOAD    => s_tx_reload,
+      TX_ABORT         => s_tx_abort,
+      TX_BUSY          => s_can_tx_busy,
+      TX_DONE          => s_can_tx_done,
+      TX_FAILED        => s_can_tx_failed,
 
       BTL_TRIPLE_SAMPLING     => axi_rw_regs.CONFIG.BTL_TRIPLE_SAMPLING_EN,
       BTL_PROP_SEG            => axi_rw_regs.BTL_PROP_SEG(C_PROP_SEG_WIDTH-1 downto 0),
@@ -174,6 +312,51 @@ begin
       VOTER_MISMATCH => VOTER_MISMATCH_LOGIC
       );
 
+  INST_canola_rx_fifo : entity work.canola_rx_fifo
+    generic map (
+      G_DEPTH => G_RX_FIFO_DEPTH)
+    port map (
+      CLK            => AXI_CLK,
+      RESET          => AXI_RESET,
+      FLUSH          => s_rx_fifo_flush,
+      CLEAR_OVERFLOW => axi_pulse_regs.CONTROL.RX_FIFO_CLEAR_OVERFLOW,
+      WR_EN          => s_rx_fifo_wr_en,
+      WR_MSG         => s_can_rx_msg,
+      WR_FILTER_HIT  => s_rx_filter_hit,
+      WR_TIMESTAMP   => std_logic_vector(s_timestamp),
+      RD_EN          => axi_pulse_regs.CONTROL.RX_FIFO_POP,
+      RD_MSG         => s_rx_fifo_msg,
+      RD_FILTER_HIT  => s_rx_fifo_filter_hit,
+      RD_TIMESTAMP   => s_rx_fifo_timestamp,
+      FILL_LEVEL     => axi_ro_regs.RX_FIFO_STATUS.FILL_LEVEL,
+      EMPTY          => s_rx_fifo_empty,
+      FULL           => axi_ro_regs.RX_FIFO_STATUS.FULL,
+      OVERFLOW       => axi_ro_regs.RX_FIFO_STATUS.OVERFLOW,
+      IRQ_LEVEL      => axi_rw_regs.RX_FIFO_IRQ_LEVEL,
+      IRQ            => s_rx_fifo_irq);
+
+  INST_canola_tx_mailboxes : entity work.canola_tx_mailboxes
+    generic map (
+      G_NUM_MAILBOXES => G_TX_MAILBOXES)
+    port map (
+      CLK               => AXI_CLK,
+      RESET             => s_tx_mailbox_reset,
+      LOAD              => axi_pulse_regs.CONTROL.TX_MAILBOX_LOAD,
+      LOAD_INDEX        => axi_rw_regs.TX_MAILBOX_INDEX,
+      LOAD_MSG          => s_can_tx_msg,
+      ABORT             => axi_pulse_regs.TX_MAILBOX_ABORT,
+      PENDING           => axi_ro_regs.TX_MAILBOX_PENDING,
+      DONE              => axi_ro_regs.TX_MAILBOX_DONE,
+      FAILED            => axi_ro_regs.TX_MAILBOX_FAILED,
+      TX_MSG            => s_tx_mailbox_msg,
+      TX_START          => s_tx_mailbox_start,
+      TX_ABORT          => s_tx_mailbox_abort,
+      TX_MSG_RELOAD     => s_tx_mailbox_reload,
+      TX_BUSY           => s_can_tx_busy,
+      TX_DONE           => s_can_tx_done,
+      TX_FAILED         => s_can_tx_failed,
+      TX_RETRANSMITTING => s_tx_retransmit_count_up);
+
   INST_canola_counters_tmr : entity work.canola_counters_tmr
     generic map (
       G_SEE_MITIGATION_EN   => G_SEE_MITIGATION_EN,
@@ -0,0 +1,161 @@
+-------------------------------------------------------------------------------
+-- Title      : Acceptance filter bank for received CAN messages
+-- Project    : Canola CAN Controller
+-------------------------------------------------------------------------------
+-- File       : canola_acceptance_filter.vhd
+-- Author     : Simon Voigt Nesbø  <svn@hvl.no>
+-- Company    :
+-- Created    : 2026-10-16
+-- Last update: 2026-10-16
+-- Platform   :
+-- Standard   : VHDL'08
+-------------------------------------------------------------------------------
+-- Description: Bank of G_NUM_FILTERS ID/mask acceptance filters.
+--              The Rx FSM pulses MATCH_START when the ID fields of a frame
+--              have been received, and the filters are then checked one per
+--              clock cycle, starting at filter 0. The first enabled filter
+--              that matches the message accepts it, and its index is output
+--              on MATCH_INDEX. MATCH_DONE is held high from when the result
+--              is ready until the next MATCH_START.
+--              With G_NUM_FILTERS filters the result is ready at most
+--              G_NUM_FILTERS+1 clock cycles after MATCH_START, which for
+--              normal bit timing settings is well before the end of the
+--              frame. The Rx FSM holds back RX_MSG_VALID until it is ready.
+--              When FILTER_EN is low all messages are accepted immediately,
+--              and MATCH_INDEX is cleared, so that it does not hold the
+--              index of a filter that accepted an earlier message.
+--              The filter entries are kept in (distributed) RAM, only the
+--              enable bits are reset.
+-------------------------------------------------------------------------------
+-- Copyright (c) 2026
+-------------------------------------------------------------------------------
+-- Revisions  :
+-- Date        Version  Author  Description
+-- 2026-10-16  1.0      svn     Created
+-------------------------------------------------------------------------------
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+library work;
+use work.canola_pkg.all;
+
+entity canola_acceptance_filter is
+  generic (
+    G_NUM_FILTERS : natural range 1 to C_ACCEPTANCE_FILTERS_MAX := C_ACCEPTANCE_FILTERS_DEFAULT);
+  port (
+    CLK       : in std_logic;
+    RESET     : in std_logic;
+    FILTER_EN : in std_logic;
+
+    -- Write interface for filter entries
+    WR_EN     : in std_logic;
+    WR_INDEX  : in std_logic_vector(C_ACCEPTANCE_FILTER_INDEX_WIDTH-1 downto 0);
+    WR_ENABLE : in std_logic;           -- Enable/disable filter entry
+    WR_FILTER : in can_acceptance_filter_t;
+
+    -- Match interface to Rx FSM
+    RX_MSG       : in  can_msg_t;
+    MATCH_START  : in  std_logic;
+    MATCH_DONE   : out std_logic;
+    MATCH_ACCEPT : out std_logic;
+    MATCH_INDEX  : out std_logic_vector(C_ACCEPTANCE_FILTER_INDEX_WIDTH-1 downto 0)
+    );
+end entity canola_acceptance_filter;
+
+architecture rtl of canola_acceptance_filter is
+
+  type t_filter_ram is array (0 to G_NUM_FILTERS-1) of can_acceptance_filter_t;
+  signal s_filter_ram    : t_filter_ram;
+  signal s_filter_enable : std_logic_vector(0 to G_NUM_FILTERS-1);
+
+  attribute ram_style                 : string;
+  attribute ram_style of s_filter_ram : signal is "distributed";
+
+  signal s_msg         : can_msg_t;
+  signal s_busy        : std_logic;
+  signal s_index       : natural range 0 to G_NUM_FILTERS-1;
+  signal s_match_index : std_logic_vector(C_ACCEPTANCE_FILTER_INDEX_WIDTH-1 downto 0);
+
+  function filter_match (
+    constant filter : can_acceptance_filter_t;
+    constant msg    : can_msg_t)
+    return boolean is
+  begin
+    return ((filter.arb_id_a xor msg.arb_id_a) and filter.arb_id_a_mask) = (filter.arb_id_a'range => '0') and
+           ((filter.arb_id_b xor msg.arb_id_b) and filter.arb_id_b_mask) = (filter.arb_id_b'range => '0') and
+           ((filter.remote_request xor msg.remote_request) and filter.remote_request_mask) = '0' and
+           ((filter.ext_id xor msg.ext_id) and filter.ext_id_mask) = '0';
+  end function filter_match;
+
+begin  -- architecture rtl
+
+  MATCH_INDEX <= s_match_index;
+
+  proc_filter_write : process(CLK) is
+  begin
+    if rising_edge(CLK) then
+      if WR_EN = '1' and to_integer(unsigned(WR_INDEX)) < G_NUM_FILTERS then
+        s_filter_ram(to_integer(unsigned(WR_INDEX))) <= WR_FILTER;
+      end if;
+    end if;
+  end process proc_filter_write;
+
+  proc_filter_enable : process(CLK) is
+  begin
+    if rising_edge(CLK) then
+      if RESET = '1' then
+        s_filter_enable <= (others => '0');
+      elsif WR_EN = '1' and to_integer(unsigned(WR_INDEX)) < G_NUM_FILTERS then
+        s_filter_enable(to_integer(unsigned(WR_INDEX))) <= WR_ENABLE;
+      end if;
+    end if;
+  end process proc_filter_enable;
+
+  proc_match : process(CLK) is
+  begin
+    if rising_edge(CLK) then
+      if RESET = '1' then
+        s_busy        <= '0';
+        s_index       <= 0;
+        s_match_index <= (others => '0');
+        MATCH_DONE    <= '0';
+        MATCH_ACCEPT  <= '0';
+      elsif MATCH_START = '1' then
+        s_msg   <= RX_MSG;
+        s_index <= 0;
+
+        -- ID B is not part of standard frames, and may hold the ID B
+        -- value of a previous extended frame
+        if RX_MSG.ext_id = '0' then
+          s_msg.arb_id_b <= (others => '0');
+        end if;
+
+        if FILTER_EN = '0' then
+          s_busy        <= '0';
+          s_match_index <= (others => '0');
+          MATCH_DONE    <= '1';
+          MATCH_ACCEPT  <= '1';
+        else
+          s_busy       <= '1';
+          MATCH_DONE   <= '0';
+          MATCH_ACCEPT <= '0';
+        end if;
+      elsif s_busy = '1' then
+        if s_filter_enable(s_index) = '1' and filter_match(s_filter_ram(s_index), s_msg) then
+          s_busy        <= '0';
+          s_match_index <= std_logic_vector(to_unsigned(s_index, C_ACCEPTANCE_FILTER_INDEX_WIDTH));
+          MATCH_DONE    <= '1';
+          MATCH_ACCEPT  <= '1';
+        elsif s_index = G_NUM_FILTERS-1 then
+          -- No filters matched
+          s_busy     <= '0';
+          MATCH_DONE <= '1';
+        else
+          s_index <= s_index + 1;
+        end if;
+      end if;
+    end if;
+  end process proc_match;
+
+end architecture rtl;
@@ -6,7 +6,7 @@
 -- Author     : Simon Voigt Nesbø  <svn@hvl.no>
 -- Company    :
 -- Created    : 2019-07-01
--- Last update: 2020-09-12
+-- Last update: 2026-10-16
 -- Platform   :
 -- Standard   : VHDL'08
 -------------------------------------------------------------------------------
@@ -22,6 +22,7 @@
 -- Revisions  :
 -- Date        Version  Author  Description
 -- 2019-07-01  1.0      svn     Created
+-- 2026-10-16  1.1      svn     Limit sync jump width with minimum, not maximum
 -------------------------------------------------------------------------------
 
 library ieee;
@@ -166,7 +167,7 @@ begin  -- architecture rtl
     if rising_edge(CLK) then
 
       -- Sync jump width should be at least one, but not greater than C_SYNC_JUMP_WIDTH_MAX
-      s_sync_jump_width <= maximum(maximum(1, to_integer(SYNC_JUMP_WIDTH)), C_SYNC_JUMP_WIDTH_MAX);
+      s_sync_jump_width <= minimum(maximum(1, to_integer(SYNC_JUMP_WIDTH)), C_SYNC_JUMP_WIDTH_MAX);
 
       TIME_QUANTA_RESTART  <= '0';
 
@@ -6,7 +6,7 @@
 -- Author     : Simon Voigt Nesbø  <svn@hvl.no>
 -- Company    :
 -- Created    : 2019-07-06
--- Last update: 2020-09-17
+-- Last update: 2026-10-16
 -- Platform   :
 -- Standard   : VHDL'08
 -------------------------------------------------------------------------------
@@ -30,9 +30,16 @@ entity canola_frame_rx_fsm is
     CLK               : in  std_logic;
     RESET             : in  std_logic;
     RX_MSG_OUT        : out can_msg_t;
-    RX_MSG_VALID      : out std_logic;
+    RX_MSG_VALID      : out std_logic;  -- Pulsed for received messages that
+                                        -- passed the acceptance filter
+    RX_MSG_RECEIVED   : out std_logic;  -- Pulsed for all received messages
     TX_ARB_WON        : in  std_logic;  -- Tx FSM signal that we are transmitting and won arbitration
 
+    -- Signals to/from acceptance filter
+    RX_FILTER_START   : out std_logic;  -- Pulsed when ID fields are received
+    RX_FILTER_DONE    : in  std_logic;  -- High when filter result is ready
+    RX_FILTER_ACCEPT  : in  std_logic;  -- Message passed acceptance filter
+
     -- Signals to/from BSP
     BSP_RX_ACTIVE             : in  std_logic;
     BSP_RX_IFS                : in  std_logic;  -- High in inter frame spacing period
@@ -88,6 +95,7 @@ architecture rtl of canola_frame_rx_fsm is
   signal s_crc_mismatch                   : std_logic;
   signal s_crc_calc                       : std_logic_vector(C_CAN_CRC_WIDTH-1 downto 0);
   signal s_reg_tx_arb_won                 : std_logic;
+  signal s_rx_msg_pending                 : std_logic;  -- Waiting for filter
   signal s_rx_active_error_flag_bit_error : std_logic;
   signal s_bsp_rx_data_count              : natural range 0 to C_BSP_DATA_LENGTH;
 
@@ -113,6 +121,8 @@ begin  -- architecture rtl
   begin  -- process proc_fsm
     if rising_edge(CLK) then
       RX_MSG_VALID                       <= '0';
+      RX_MSG_RECEIVED                    <= '0';
+      RX_FILTER_START                    <= '0';
       BSP_RX_SEND_ACK                    <= '0';
       BSP_RX_DATA_CLEAR                  <= '0';
       BSP_RX_BIT_DESTUFF_EN              <= '1';
@@ -141,6 +151,7 @@ begin  -- architecture rtl
         s_fsm_state_out                    <= ST_IDLE;
         s_crc_mismatch                     <= '0';
         s_rx_active_error_flag_bit_error   <= '0';
+        s_rx_msg_pending                   <= '0';
       else
         -- Tx FSM is transmitting message, and won arbitration
         if TX_ARB_WON = '1' then
@@ -221,6 +232,7 @@ begin  -- architecture rtl
                 -- Standard frame
                 s_reg_rx_msg.ext_id         <= '0';
                 s_reg_rx_msg.remote_request <= s_srr_rtr_bit;
+                RX_FILTER_START             <= '1';
                 s_fsm_state_out             <= ST_RECV_R0;
               end if;
             end if;
@@ -242,6 +254,7 @@ begin  -- architecture rtl
             elsif s_bsp_rx_data_count = 1 and BSP_RX_DATA_CLEAR = '0' then
               BSP_RX_DATA_CLEAR           <= '1';
               s_reg_rx_msg.remote_request <= BSP_RX_DATA(0);
+              RX_FILTER_START             <= '1';
               s_fsm_state_out             <= ST_RECV_R1;
             end if;
 
@@ -496,7 +509,10 @@ begin  -- architecture rtl
             -- Note: Internal loopback can be implemented by setting
             --       this even when arbitration was won
             if s_reg_tx_arb_won = '0' then
-              RX_MSG_VALID <= '1'; -- Pulsed one cycle
+              RX_MSG_RECEIVED  <= '1'; -- Pulsed one cycle
+
+              -- RX_MSG_VALID is pulsed when the acceptance filter is done
+              s_rx_msg_pending <= '1';
             end if;
 
             BSP_RX_STOP     <= '1';
@@ -514,6 +530,14 @@ begin  -- architecture rtl
 
         end case;
 
+        -- Pulse RX_MSG_VALID for received messages that passed the
+        -- acceptance filter. The filter is normally done long before the
+        -- frame is received, but the message is held back until it is.
+        if s_rx_msg_pending = '1' and RX_FILTER_DONE = '1' then
+          RX_MSG_VALID     <= RX_FILTER_ACCEPT;
+          s_rx_msg_pending <= '0';
+        end if;
+
         -- Special handling of error flags and stuff errors
         if s_fsm_state_voted /= ST_IDLE then
           -- Stuff errors are detected by looking for error flags while we
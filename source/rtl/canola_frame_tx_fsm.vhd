@@ -6,7 +6,7 @@
 -- Author     : Simon Voigt Nesbø  <svn@hvl.no>
 -- Company    :
 -- Created    : 2019-06-26
--- Last update: 2020-08-31
+-- Last update: 2026-10-16
 -- Platform   :
 -- Standard   : VHDL'08
 -------------------------------------------------------------------------------
@@ -17,6 +17,7 @@
 -- Revisions  :
 -- Date        Version  Author  Description
 -- 2019-06-26  1.0      svn     Created
+-- 2026-10-16  1.1      svn     Reload or abort message on retransmit
 -------------------------------------------------------------------------------
 library ieee;
 use ieee.std_logic_1164.all;
@@ -34,6 +35,8 @@ entity canola_frame_tx_fsm is
     TX_MSG_IN                      : in  can_msg_t;
     TX_START                       : in  std_logic;  -- Start sending TX_MSG
     TX_RETRANSMIT_EN               : in  std_logic;
+    TX_MSG_RELOAD                  : in  std_logic;  -- Reload TX_MSG_IN as a new message on retransmit
+    TX_ABORT                       : in  std_logic;  -- Fail instead of retransmitting
     TX_BUSY                        : out std_logic;  -- FSM busy
     TX_DONE                        : out std_logic;  -- Transmit done, ack received
     TX_ARB_LOST                    : out std_logic;  -- Arbitration was lost
@@ -484,10 +487,22 @@ begin  -- architecture rtl
             then
               TX_FAILED       <= '1';
               s_fsm_state_out <= ST_IDLE;
+            elsif TX_ABORT = '1' then
+              TX_FAILED       <= '1';
+              s_fsm_state_out <= ST_IDLE;
             else
               TX_RETRANSMITTING      <= '1';
-              s_retransmit_attempts  <= s_retransmit_attempts + 1;
               s_fsm_state_out        <= ST_WAIT_FOR_BUS_IDLE;
+
+              -- The message to send may have changed (e.g. a higher priority
+              -- Tx mailbox was loaded while attempting to send this one).
+              -- A new message gets its own retransmit attempts.
+              if TX_MSG_RELOAD = '1' then
+                s_reg_tx_msg          <= TX_MSG_IN;
+                s_retransmit_attempts <= 0;
+              else
+                s_retransmit_attempts <= s_retransmit_attempts + 1;
+              end if;
             end if;
 
           when ST_DONE =>
@@ -6,7 +6,7 @@
 -- Author     : Simon Voigt Nesbø  <svn@hvl.no>
 -- Company    :
 -- Created    : 2019-06-26
--- Last update: 2020-09-04
+-- Last update: 2026-10-16
 -- Platform   :
 -- Standard   : VHDL'08
 -------------------------------------------------------------------------------
@@ -82,7 +82,20 @@ package canola_pkg is
 
   constant C_STUFF_BIT_THRESHOLD : natural := 5;
 
-  constant C_ACCEPTANCE_FILTERS_MAX : natural := 256;
+  constant C_ACCEPTANCE_FILTERS_MAX         : natural := 256;
+  constant C_ACCEPTANCE_FILTERS_DEFAULT     : natural := 16;
+  constant C_ACCEPTANCE_FILTER_INDEX_WIDTH  : natural := integer(ceil(log2(real(C_ACCEPTANCE_FILTERS_MAX))));
+
+  constant C_RX_FIFO_DEPTH_MAX     : natural := 256;
+  constant C_RX_FIFO_DEPTH_DEFAULT : natural := 16;
+  constant C_RX_FIFO_LEVEL_WIDTH   : natural := integer(ceil(log2(1.0+real(C_RX_FIFO_DEPTH_MAX))));
+
+  constant C_TX_MAILBOXES_MAX        : natural := 32;
+  constant C_TX_MAILBOXES_DEFAULT    : natural := 8;
+  constant C_TX_MAILBOX_INDEX_WIDTH  : natural := integer(ceil(log2(real(C_TX_MAILBOXES_MAX))));
+
+  -- Free-running timestamp counter in the AXI slave, in clock cycles
+  constant C_TIMESTAMP_WIDTH : natural := 32;
 
   -- Maximum number of retransmit attempts after a message failed to send
   -- (default and value to use to attempt retransmits forever until it succeeds)
@@ -100,6 +113,30 @@ package canola_pkg is
     data_length    : std_logic_vector(C_DLC_LENGTH-1 downto 0);
   end record can_msg_t;
 
+  -- Acceptance filter entry. A received message matches the filter when
+  -- all the bits that are set in the mask fields are equal in the message
+  -- and in the ID fields of the filter.
+  type can_acceptance_filter_t is record
+    arb_id_a            : std_logic_vector(C_ID_A_LENGTH-1 downto 0);
+    arb_id_b            : std_logic_vector(C_ID_B_LENGTH-1 downto 0);
+    remote_request      : std_logic;
+    ext_id              : std_logic;
+    arb_id_a_mask       : std_logic_vector(C_ID_A_LENGTH-1 downto 0);
+    arb_id_b_mask       : std_logic_vector(C_ID_B_LENGTH-1 downto 0);
+    remote_request_mask : std_logic;
+    ext_id_mask         : std_logic;
+  end record can_acceptance_filter_t;
+
+  constant C_ACCEPTANCE_FILTER_NONE : can_acceptance_filter_t := (
+    arb_id_a            => (others => '0'),
+    arb_id_b            => (others => '0'),
+    remote_request      => '0',
+    ext_id              => '0',
+    arb_id_a_mask       => (others => '0'),
+    arb_id_b_mask       => (others => '0'),
+    remote_request_mask => '0',
+    ext_id_mask         => '0');
+
 
   -----------------------------------------------------------------------------
   -- Declarations for error handling
@@ -0,0 +1,174 @@
+-------------------------------------------------------------------------------
+-- Title      : FIFO for received CAN messages
+-- Project    : Canola CAN Controller
+-------------------------------------------------------------------------------
+-- File       : canola_rx_fifo.vhd
+-- Author     : Simon Voigt Nesbø  <svn@hvl.no>
+-- Company    :
+-- Created    : 2026-10-16
+-- Last update: 2026-10-16
+-- Platform   :
+-- Standard   : VHDL'08
+-------------------------------------------------------------------------------
+-- Description: FIFO with room for G_DEPTH received messages, along with the
+--              index of the acceptance filter that accepted them and the
+--              timestamp of when they were received.
+--              The message at the head of the FIFO is always available on
+--              RD_MSG (first word fall through), and is removed by pulsing
+--              RD_EN.
+--              Messages that are received when the FIFO is full are dropped,
+--              and the OVERFLOW flag is set until FLUSH or CLEAR_OVERFLOW is
+--              pulsed.
+--              IRQ is pulsed when a message is written to the FIFO and the
+--              fill level (including the new message) is at or above
+--              IRQ_LEVEL.
+-------------------------------------------------------------------------------
+-- Copyright (c) 2026
+-------------------------------------------------------------------------------
+-- Revisions  :
+-- Date        Version  Author  Description
+-- 2026-10-16  1.0      svn     Created
+-- 2026-10-16  1.1      svn     Store timestamp with messages
+-------------------------------------------------------------------------------
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+library work;
+use work.canola_pkg.all;
+
+entity canola_rx_fifo is
+  generic (
+    G_DEPTH : natural range 1 to C_RX_FIFO_DEPTH_MAX := C_RX_FIFO_DEPTH_DEFAULT);
+  port (
+    CLK            : in std_logic;
+    RESET          : in std_logic;
+    FLUSH          : in std_logic;      -- Remove all messages and clear overflow
+    CLEAR_OVERFLOW : in std_logic;
+
+    -- Write interface, from Rx FSM
+    WR_EN         : in std_logic;
+    WR_MSG        : in can_msg_t;
+    WR_FILTER_HIT : in std_logic_vector(C_ACCEPTANCE_FILTER_INDEX_WIDTH-1 downto 0);
+    WR_TIMESTAMP  : in std_logic_vector(C_TIMESTAMP_WIDTH-1 downto 0);
+
+    -- Read interface, head of FIFO
+    RD_EN         : in  std_logic;      -- Pop message at head of FIFO
+    RD_MSG        : out can_msg_t;
+    RD_FILTER_HIT : out std_logic_vector(C_ACCEPTANCE_FILTER_INDEX_WIDTH-1 downto 0);
+    RD_TIMESTAMP  : out std_logic_vector(C_TIMESTAMP_WIDTH-1 downto 0);
+
+    -- Status
+    FILL_LEVEL : out std_logic_vector(C_RX_FIFO_LEVEL_WIDTH-1 downto 0);
+    EMPTY      : out std_logic;
+    FULL       : out std_logic;
+    OVERFLOW   : out std_logic;
+
+    IRQ_LEVEL : in  std_logic_vector(C_RX_FIFO_LEVEL_WIDTH-1 downto 0);
+    IRQ       : out std_logic
+    );
+end entity canola_rx_fifo;
+
+architecture rtl of canola_rx_fifo is
+
+  type t_msg_ram is array (0 to G_DEPTH-1) of can_msg_t;
+  type t_filter_hit_ram is array (0 to G_DEPTH-1) of
+    std_logic_vector(C_ACCEPTANCE_FILTER_INDEX_WIDTH-1 downto 0);
+  type t_timestamp_ram is array (0 to G_DEPTH-1) of
+    std_logic_vector(C_TIMESTAMP_WIDTH-1 downto 0);
+
+  signal s_msg_ram        : t_msg_ram;
+  signal s_filter_hit_ram : t_filter_hit_ram;
+  signal s_timestamp_ram  : t_timestamp_ram;
+
+  attribute ram_style                     : string;
+  attribute ram_style of s_msg_ram        : signal is "distributed";
+  attribute ram_style of s_filter_hit_ram : signal is "distributed";
+  attribute ram_style of s_timestamp_ram  : signal is "distributed";
+
+  signal s_wr_ptr : natural range 0 to G_DEPTH-1;
+  signal s_rd_ptr : natural range 0 to G_DEPTH-1;
+  signal s_count  : natural range 0 to G_DEPTH;
+
+  -- Write to FIFO this cycle
+  signal s_wr : std_logic;
+
+begin  -- architecture rtl
+
+  RD_MSG        <= s_msg_ram(s_rd_ptr);
+  RD_FILTER_HIT <= s_filter_hit_ram(s_rd_ptr);
+  RD_TIMESTAMP  <= s_timestamp_ram(s_rd_ptr);
+
+  FILL_LEVEL <= std_logic_vector(to_unsigned(s_count, C_RX_FIFO_LEVEL_WIDTH));
+  EMPTY      <= '1' when s_count = 0       else '0';
+  FULL       <= '1' when s_count = G_DEPTH else '0';
+
+  -- A message can be written to a full FIFO if a message is popped in the
+  -- same cycle
+  s_wr <= WR_EN and not FLUSH when s_count < G_DEPTH or RD_EN = '1' else '0';
+
+  proc_ram_write : process(CLK) is
+  begin
+    if rising_edge(CLK) then
+      if s_wr = '1' then
+        s_msg_ram(s_wr_ptr)        <= WR_MSG;
+        s_filter_hit_ram(s_wr_ptr) <= WR_FILTER_HIT;
+        s_timestamp_ram(s_wr_ptr)  <= WR_TIMESTAMP;
+      end if;
+    end if;
+  end process proc_ram_write;
+
+  proc_fifo : process(CLK) is
+    variable v_rd : std_logic;
+  begin
+    if rising_edge(CLK) then
+      IRQ <= '0';
+
+      if RESET = '1' or FLUSH = '1' then
+        s_wr_ptr <= 0;
+        s_rd_ptr <= 0;
+        s_count  <= 0;
+        OVERFLOW <= '0';
+      else
+        v_rd := '0';
+
+        if RD_EN = '1' and s_count > 0 then
+          v_rd := '1';
+
+          if s_rd_ptr = G_DEPTH-1 then
+            s_rd_ptr <= 0;
+          else
+            s_rd_ptr <= s_rd_ptr + 1;
+          end if;
+        end if;
+
+        if s_wr = '1' then
+          if s_wr_ptr = G_DEPTH-1 then
+            s_wr_ptr <= 0;
+          else
+            s_wr_ptr <= s_wr_ptr + 1;
+          end if;
+
+          if v_rd = '0' then
+            s_count <= s_count + 1;
+
+            if s_count + 1 >= to_integer(unsigned(IRQ_LEVEL)) then
+              IRQ <= '1';
+            end if;
+          elsif s_count >= to_integer(unsigned(IRQ_LEVEL)) then
+            IRQ <= '1';
+          end if;
+        elsif v_rd = '1' then
+          s_count <= s_count - 1;
+        end if;
+
+        if CLEAR_OVERFLOW = '1' then
+          OVERFLOW <= '0';
+        elsif WR_EN = '1' and s_wr = '0' then
+          OVERFLOW <= '1';
+        end if;
+      end if;
+    end if;
+  end process proc_fifo;
+
+end architecture rtl;
@@ -6,7 +6,7 @@
 -- Author     : Simon Voigt Nesbø  <svn@hvl.no>
 -- Company    :
 -- Created    : 2019-07-10
--- Last update: 2020-09-12
+-- Last update: 2026-10-16
 -- Platform   :
 -- Standard   : VHDL'08
 -------------------------------------------------------------------------------
@@ -24,6 +24,8 @@
 -- 2019-09-19  1.1      svn     Add outputs for counter register, error
 --                              counters and error state
 -- 2020-02-12  1.2      svn     Made counters external
+-- 2026-10-16  1.3      svn     Added acceptance filter bank
+-- 2026-10-16  1.4      svn     Added Tx message reload and abort inputs
 -------------------------------------------------------------------------------
 
 library ieee;
@@ -36,7 +38,8 @@ use work.canola_pkg.all;
 entity canola_top is
   generic (
     G_TIME_QUANTA_SCALE_WIDTH : natural := C_TIME_QUANTA_SCALE_WIDTH_DEFAULT;
-    G_RETRANSMIT_COUNT_MAX    : natural := C_RETRANSMIT_COUNT_MAX_DEFAULT);
+    G_RETRANSMIT_COUNT_MAX    : natural := C_RETRANSMIT_COUNT_MAX_DEFAULT;
+    G_ACCEPTANCE_FILTERS      : natural := C_ACCEPTANCE_FILTERS_DEFAULT);
   port (
     CLK   : in std_logic;
     RESET : in std_logic;
@@ -49,10 +52,24 @@ entity canola_top is
     RX_MSG       : out can_msg_t;
     RX_MSG_VALID : out std_logic;
 
+    -- Acceptance filter
+    -- When enabled, RX_MSG_VALID is only pulsed for messages that match one
+    -- of the enabled filters, and RX_FILTER_HIT holds the index of the
+    -- (lowest numbered) filter that matched. RX_FILTER_HIT is zero for
+    -- messages received while filtering is disabled.
+    ACCEPTANCE_FILTER_EN        : in  std_logic := '0';
+    ACCEPTANCE_FILTER_WR_EN     : in  std_logic := '0';
+    ACCEPTANCE_FILTER_WR_INDEX  : in  std_logic_vector(C_ACCEPTANCE_FILTER_INDEX_WIDTH-1 downto 0) := (others => '0');
+    ACCEPTANCE_FILTER_WR_ENABLE : in  std_logic := '0';
+    ACCEPTANCE_FILTER_WR_DATA   : in  can_acceptance_filter_t := C_ACCEPTANCE_FILTER_NONE;
+    RX_FILTER_HIT               : out std_logic_vector(C_ACCEPTANCE_FILTER_INDEX_WIDTH-1 downto 0);
+
     -- Tx interface
     TX_MSG           : in  can_msg_t;
     TX_START         : in  std_logic;
     TX_RETRANSMIT_EN : in  std_logic;
+    TX_MSG_RELOAD    : in  std_logic := '0';  -- Reload TX_MSG as a new message on retransmit
+    TX_ABORT         : in  std_logic := '0';  -- Fail instead of retransmitting
     TX_BUSY          : out std_logic;
     TX_DONE          : out std_logic;
     TX_FAILED        : out std_logic;
@@ -98,6 +115,12 @@ architecture struct of canola_top is
   signal s_tx_fsm_arb_won                     : std_logic;  -- Arbitration was won
   signal s_tx_fsm_retransmitting              : std_logic;  -- Attempting retransmit
 
+  -- Signals between Rx Frame FSM and acceptance filter
+  signal s_rx_msg_received  : std_logic;  -- Received message (before filtering)
+  signal s_rx_filter_start  : std_logic;
+  signal s_rx_filter_done   : std_logic;
+  signal s_rx_filter_accept : std_logic;
+
   -- BSP interface to Tx Frame FSM
   signal s_bsp_tx_data              : std_logic_vector(0 to C_BSP_DATA_LENGTH-1);
   signal s_bsp_tx_data_count        : std_logic_vector(C_BSP_DATA_LEN_BITSIZE-1 downto 0);
@@ -218,6 +241,8 @@ begin  -- architecture struct
       TX_MSG_IN                          => TX_MSG,
       TX_START                           => TX_START,
       TX_RETRANSMIT_EN                   => TX_RETRANSMIT_EN,
+      TX_MSG_RELOAD                      => TX_MSG_RELOAD,
+      TX_ABORT                           => TX_ABORT,
       TX_BUSY                            => TX_BUSY,
       TX_DONE                            => TX_DONE,
       TX_ARB_LOST                        => s_tx_fsm_arb_lost,
@@ -253,7 +278,11 @@ begin  -- architecture struct
       RESET                              => RESET,
       RX_MSG_OUT                         => RX_MSG,
       RX_MSG_VALID                       => RX_MSG_VALID,
+      RX_MSG_RECEIVED                    => s_rx_msg_received,
       TX_ARB_WON                         => s_tx_fsm_arb_won,
+      RX_FILTER_START                    => s_rx_filter_start,
+      RX_FILTER_DONE                     => s_rx_filter_done,
+      RX_FILTER_ACCEPT                   => s_rx_filter_accept,
       BSP_RX_ACTIVE                      => s_bsp_rx_active,
       BSP_RX_IFS                         => s_bsp_rx_ifs,
       BSP_RX_DATA                        => s_bsp_rx_data,
@@ -280,6 +309,25 @@ begin  -- architecture struct
       FSM_STATE_O                        => s_frame_rx_fsm_state,
       FSM_STATE_VOTED_I                  => s_frame_rx_fsm_state);
 
+  -- Acceptance filter bank, checked by the Rx FSM when the ID fields
+  -- of a frame have been received
+  INST_canola_acceptance_filter : entity work.canola_acceptance_filter
+    generic map (
+      G_NUM_FILTERS => G_ACCEPTANCE_FILTERS)
+    port map (
+      CLK          => CLK,
+      RESET        => RESET,
+      FILTER_EN    => ACCEPTANCE_FILTER_EN,
+      WR_EN        => ACCEPTANCE_FILTER_WR_EN,
+      WR_INDEX     => ACCEPTANCE_FILTER_WR_INDEX,
+      WR_ENABLE    => ACCEPTANCE_FILTER_WR_ENABLE,
+      WR_FILTER    => ACCEPTANCE_FILTER_WR_DATA,
+      RX_MSG       => RX_MSG,
+      MATCH_START  => s_rx_filter_start,
+      MATCH_DONE   => s_rx_filter_done,
+      MATCH_ACCEPT => s_rx_filter_accept,
+      MATCH_INDEX  => RX_FILTER_HIT);
+
   -- Bit Stream Processor (BSP)
   -- Responsible for bit stuffing/destuffing and
   -- CRC calculation of larger stream of bits.
@@ -393,7 +441,7 @@ begin  -- architecture struct
       TX_ACK_ERROR                     => s_eml_tx_ack_error,
       TX_ACTIVE_ERROR_FLAG_BIT_ERROR   => s_eml_tx_active_error_flag_bit_error,
       TRANSMIT_SUCCESS                 => TX_DONE,
-      RECEIVE_SUCCESS                  => RX_MSG_VALID,
+      RECEIVE_SUCCESS                  => s_rx_msg_received,
       RECV_11_RECESSIVE_BITS           => s_eml_recv_11_recessive_bits,
       TEC_COUNT_VALUE                  => s_eml_tec_count_value,
       TEC_COUNT_INCR                   => s_eml_tec_count_incr,
@@ -0,0 +1,273 @@
+-------------------------------------------------------------------------------
+-- Title      : Tx mailboxes with priority arbitration
+-- Project    : Canola CAN Controller
+-------------------------------------------------------------------------------
+-- File       : canola_tx_mailboxes.vhd
+-- Author     : Simon Voigt Nesbø  <svn@hvl.no>
+-- Company    :
+-- Created    : 2026-10-16
+-- Last update: 2026-10-16
+-- Platform   :
+-- Standard   : VHDL'08
+-------------------------------------------------------------------------------
+-- Description: G_NUM_MAILBOXES Tx mailboxes in front of the Tx FSM.
+--              A mailbox is loaded with a message by pulsing LOAD, which
+--              marks it as pending. The pending mailbox with the highest
+--              priority (the message that would win arbitration on the bus,
+--              lowest index on ties) is selected every clock cycle, and is
+--              started on the Tx FSM whenever it is idle.
+--              When the Tx FSM retransmits a message (after losing
+--              arbitration or an error), it reloads TX_MSG when TX_MSG_RELOAD
+--              is set, so that a higher priority mailbox that was loaded in
+--              the meantime is sent first. TX_MSG_RELOAD is only set when the
+--              selected mailbox is not the one in flight, and the Tx FSM
+--              counts retransmit attempts from zero for the new message, so
+--              the retransmit limit applies to each mailbox.
+--              Neither TX_START nor TX_MSG_RELOAD are set in the cycle after
+--              the mailbox flags change (s_settle), where s_best may still
+--              select a mailbox that was just aborted.
+--              TX_ABORT tells the Tx FSM to give up instead of
+--              retransmitting when no mailboxes are pending anymore.
+--              Each mailbox has a done and a failed flag, which are cleared
+--              when it is loaded. Aborted mailboxes are reported as failed.
+--              A mailbox that is being sent when it is aborted is aborted
+--              when the Tx FSM is done with it, and is reported as done if
+--              the message was sent successfully.
+--              The messages are kept in (distributed) RAM, the pending, done
+--              and failed flags are reset.
+-------------------------------------------------------------------------------
+-- Copyright (c) 2026
+-------------------------------------------------------------------------------
+-- Revisions  :
+-- Date        Version  Author  Description
+-- 2026-10-16  1.0      svn     Created
+-- 2026-10-16  1.1      svn     Don't reload TX_MSG while s_best settles
+-------------------------------------------------------------------------------
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+library work;
+use work.canola_pkg.all;
+
+entity canola_tx_mailboxes is
+  generic (
+    G_NUM_MAILBOXES : natural range 1 to C_TX_MAILBOXES_MAX := C_TX_MAILBOXES_DEFAULT);
+  port (
+    CLK   : in std_logic;
+    RESET : in std_logic;
+
+    -- Mailbox interface
+    LOAD       : in std_logic;          -- Load LOAD_MSG to mailbox LOAD_INDEX
+    LOAD_INDEX : in std_logic_vector(C_TX_MAILBOX_INDEX_WIDTH-1 downto 0);
+    LOAD_MSG   : in can_msg_t;
+    ABORT      : in std_logic_vector(C_TX_MAILBOXES_MAX-1 downto 0);
+
+    -- Mailbox status, one bit per mailbox
+    PENDING : out std_logic_vector(C_TX_MAILBOXES_MAX-1 downto 0);
+    DONE    : out std_logic_vector(C_TX_MAILBOXES_MAX-1 downto 0);
+    FAILED  : out std_logic_vector(C_TX_MAILBOXES_MAX-1 downto 0);
+
+    -- Signals to/from Tx FSM
+    TX_MSG            : out can_msg_t;
+    TX_START          : out std_logic;
+    TX_ABORT          : out std_logic;
+    TX_MSG_RELOAD     : out std_logic;  -- TX_MSG is another mailbox than in flight
+    TX_BUSY           : in  std_logic;
+    TX_DONE           : in  std_logic;
+    TX_FAILED         : in  std_logic;
+    TX_RETRANSMITTING : in  std_logic
+    );
+end entity canola_tx_mailboxes;
+
+architecture rtl of canola_tx_mailboxes is
+
+  type t_msg_ram is array (0 to G_NUM_MAILBOXES-1) of can_msg_t;
+  signal s_msg_ram : t_msg_ram;
+
+  attribute ram_style              : string;
+  attribute ram_style of s_msg_ram : signal is "distributed";
+
+  -- Priority of the message in a mailbox, lower value wins arbitration
+  subtype t_priority is unsigned(31 downto 0);
+  type t_priority_array is array (0 to G_NUM_MAILBOXES-1) of t_priority;
+  signal s_priority : t_priority_array;
+
+  signal s_pending   : std_logic_vector(0 to G_NUM_MAILBOXES-1);
+  signal s_done      : std_logic_vector(0 to G_NUM_MAILBOXES-1);
+  signal s_failed    : std_logic_vector(0 to G_NUM_MAILBOXES-1);
+  signal s_abort_req : std_logic_vector(0 to G_NUM_MAILBOXES-1);
+
+  -- Highest priority pending mailbox, and the one selected the previous cycle
+  -- (which is the mailbox the Tx FSM reloaded when it pulses TX_RETRANSMITTING)
+  signal s_best            : natural range 0 to G_NUM_MAILBOXES-1;
+  signal s_best_prev       : natural range 0 to G_NUM_MAILBOXES-1;
+  signal s_best_valid      : std_logic;
+  signal s_best_prev_valid : std_logic;
+
+  -- Mailbox that the Tx FSM is sending
+  signal s_in_flight : natural range 0 to G_NUM_MAILBOXES-1;
+  signal s_active    : std_logic;
+  signal s_started   : std_logic;
+
+  -- Mailbox flags changed last cycle, s_best is not updated yet
+  signal s_settle : std_logic;
+
+  signal s_tx_start : std_logic;
+
+  -- The priority of a message follows the order of the bits on the bus:
+  -- ID A, SRR/RTR, IDE, ID B, RTR
+  function msg_priority (
+    constant msg : can_msg_t)
+    return t_priority is
+  begin
+    if msg.ext_id = '1' then
+      return unsigned(msg.arb_id_a & '1' & '1' & msg.arb_id_b & msg.remote_request);
+    else
+      return unsigned(msg.arb_id_a & msg.remote_request & '0' &
+                      std_logic_vector(to_unsigned(0, C_ID_B_LENGTH)) & '0');
+    end if;
+  end function msg_priority;
+
+begin  -- architecture rtl
+
+  TX_MSG   <= s_msg_ram(s_best);
+  TX_START <= s_tx_start;
+  TX_ABORT <= not s_best_valid;
+
+  TX_MSG_RELOAD <= '1' when s_best_valid = '1' and s_best /= s_in_flight and s_settle = '0' else '0';
+
+  s_tx_start <= s_best_valid and not s_active and not s_settle and not TX_BUSY;
+
+  proc_status : process(s_pending, s_done, s_failed) is
+  begin
+    PENDING <= (others => '0');
+    DONE    <= (others => '0');
+    FAILED  <= (others => '0');
+
+    for i in 0 to G_NUM_MAILBOXES-1 loop
+      PENDING(i) <= s_pending(i);
+      DONE(i)    <= s_done(i);
+      FAILED(i)  <= s_failed(i);
+    end loop;
+  end process proc_status;
+
+  proc_msg_write : process(CLK) is
+  begin
+    if rising_edge(CLK) then
+      if LOAD = '1' and to_integer(unsigned(LOAD_INDEX)) < G_NUM_MAILBOXES then
+        if s_pending(to_integer(unsigned(LOAD_INDEX))) = '0' then
+          s_msg_ram(to_integer(unsigned(LOAD_INDEX)))  <= LOAD_MSG;
+          s_priority(to_integer(unsigned(LOAD_INDEX))) <= msg_priority(LOAD_MSG);
+        end if;
+      end if;
+    end if;
+  end process proc_msg_write;
+
+  -- Select the highest priority pending mailbox that has not been aborted
+  proc_arbitrate : process(CLK) is
+    variable v_best       : natural range 0 to G_NUM_MAILBOXES-1;
+    variable v_best_valid : std_logic;
+  begin
+    if rising_edge(CLK) then
+      if RESET = '1' then
+        s_best            <= 0;
+        s_best_prev       <= 0;
+        s_best_valid      <= '0';
+        s_best_prev_valid <= '0';
+      else
+        v_best       := 0;
+        v_best_valid := '0';
+
+        for i in 0 to G_NUM_MAILBOXES-1 loop
+          if s_pending(i) = '1' and s_abort_req(i) = '0' then
+            if v_best_valid = '0' or s_priority(i) < s_priority(v_best) then
+              v_best       := i;
+              v_best_valid := '1';
+            end if;
+          end if;
+        end loop;
+
+        s_best            <= v_best;
+        s_best_prev       <= s_best;
+        s_best_valid      <= v_best_valid;
+        s_best_prev_valid <= s_best_valid;
+      end if;
+    end if;
+  end process proc_arbitrate;
+
+  proc_mailboxes : process(CLK) is
+    variable v_load_index : natural;
+  begin
+    if rising_edge(CLK) then
+      if RESET = '1' then
+        s_pending   <= (others => '0');
+        s_done      <= (others => '0');
+        s_failed    <= (others => '0');
+        s_abort_req <= (others => '0');
+        s_in_flight <= 0;
+        s_active    <= '0';
+        s_started   <= '0';
+        s_settle    <= '0';
+      else
+        s_settle  <= '0';
+        s_started <= s_tx_start;
+
+        if s_tx_start = '1' then
+          s_active    <= '1';
+          s_in_flight <= s_best;
+        elsif s_started = '1' and TX_BUSY = '0' then
+          -- Start was ignored by the Tx FSM (bus off)
+          s_active <= '0';
+        end if;
+
+        if TX_RETRANSMITTING = '1' then
+          -- The Tx FSM reloaded the mailbox that was selected when it
+          -- decided to retransmit
+          s_in_flight <= s_best_prev;
+        end if;
+
+        for i in 0 to G_NUM_MAILBOXES-1 loop
+          if ABORT(i) = '1' and s_pending(i) = '1' then
+            s_abort_req(i) <= '1';
+            s_settle       <= '1';
+          end if;
+
+          -- Abort pending mailboxes that the Tx FSM may not be using
+          if s_abort_req(i) = '1' and s_pending(i) = '1' and
+            not (s_active = '1' and s_in_flight = i) and
+            not (s_best_valid = '1' and s_best = i) and
+            not (s_best_prev_valid = '1' and s_best_prev = i)
+          then
+            s_pending(i)   <= '0';
+            s_failed(i)    <= '1';
+            s_abort_req(i) <= '0';
+            s_settle       <= '1';
+          end if;
+        end loop;
+
+        if s_active = '1' and (TX_DONE = '1' or TX_FAILED = '1') then
+          s_active                 <= '0';
+          s_pending(s_in_flight)   <= '0';
+          s_done(s_in_flight)      <= TX_DONE;
+          s_failed(s_in_flight)    <= TX_FAILED;
+          s_abort_req(s_in_flight) <= '0';
+          s_settle                 <= '1';
+        end if;
+
+        v_load_index := to_integer(unsigned(LOAD_INDEX));
+
+        if LOAD = '1' and v_load_index < G_NUM_MAILBOXES then
+          if s_pending(v_load_index) = '0' then
+            s_pending(v_load_index)   <= '1';
+            s_done(v_load_index)      <= '0';
+            s_failed(v_load_index)    <= '0';
+            s_abort_req(v_load_index) <= '0';
+            s_settle                  <= '1';
+          end if;
+        end if;
+      end if;
+    end if;
+  end process proc_mailboxes;
+
+end architecture rtl;
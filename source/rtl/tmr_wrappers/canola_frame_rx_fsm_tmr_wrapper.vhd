@@ -6,7 +6,7 @@
 -- Author     : Simon Voigt Nesbø  <svn@hvl.no>
 -- Company    :
 -- Created    : 2020-01-28
--- Last update: 2020-08-28
+-- Last update: 2026-10-16
 -- Platform   :
 -- Standard   : VHDL'08
 -------------------------------------------------------------------------------
@@ -38,9 +38,16 @@ entity canola_frame_rx_fsm_tmr_wrapper is
     CLK               : in  std_logic;
     RESET             : in  std_logic;
     RX_MSG_OUT        : out can_msg_t;
-    RX_MSG_VALID      : out std_logic;
+    RX_MSG_VALID      : out std_logic;  -- Pulsed for received messages that
+                                        -- passed the acceptance filter
+    RX_MSG_RECEIVED   : out std_logic;  -- Pulsed for all received messages
     TX_ARB_WON        : in  std_logic;  -- Tx FSM signal that we are transmitting and won arbitration
 
+    -- Signals to/from acceptance filter
+    RX_FILTER_START   : out std_logic;  -- Pulsed when ID fields are received
+    RX_FILTER_DONE    : in  std_logic;  -- High when filter result is ready
+    RX_FILTER_ACCEPT  : in  std_logic;  -- Message passed acceptance filter
+
     -- Signals to/from BSP
     BSP_RX_ACTIVE             : in  std_logic;
     BSP_RX_IFS                : in  std_logic;  -- High in inter frame spacing period
@@ -105,7 +112,11 @@ begin  -- architecture structural
           RESET                              => RESET,
           RX_MSG_OUT                         => RX_MSG_OUT,
           RX_MSG_VALID                       => RX_MSG_VALID,
+          RX_MSG_RECEIVED                    => RX_MSG_RECEIVED,
           TX_ARB_WON                         => TX_ARB_WON,
+          RX_FILTER_START                    => RX_FILTER_START,
+          RX_FILTER_DONE                     => RX_FILTER_DONE,
+          RX_FILTER_ACCEPT                   => RX_FILTER_ACCEPT,
           BSP_RX_ACTIVE                      => BSP_RX_ACTIVE,
           BSP_RX_IFS                         => BSP_RX_IFS,
           BSP_RX_DATA                        => BSP_RX_DATA,
@@ -146,6 +157,8 @@ begin  -- architecture structural
       type t_can_msg_tmr is array (0 to C_K_TMR-1) of can_msg_t;
       signal s_rx_msg_out_tmr                         : t_can_msg_tmr;
       signal s_rx_msg_valid_tmr                       : std_logic_vector(0 to C_K_TMR-1);
+      signal s_rx_msg_received_tmr                    : std_logic_vector(0 to C_K_TMR-1);
+      signal s_rx_filter_start_tmr                    : std_logic_vector(0 to C_K_TMR-1);
       --signal s_inter_frame_space_tmr                  : std_logic_vector(0 to C_K_TMR-1);
       signal s_bsp_rx_data_clear_tmr                  : std_logic_vector(0 to C_K_TMR-1);
       signal s_bsp_rx_bit_destuff_en_tmr              : std_logic_vector(0 to C_K_TMR-1);
@@ -163,6 +176,8 @@ begin  -- architecture structural
       attribute DONT_TOUCH of s_fsm_state_voted                        : signal is "TRUE";
       attribute DONT_TOUCH of s_rx_msg_out_tmr                         : signal is "TRUE";
       attribute DONT_TOUCH of s_rx_msg_valid_tmr                       : signal is "TRUE";
+      attribute DONT_TOUCH of s_rx_msg_received_tmr                    : signal is "TRUE";
+      attribute DONT_TOUCH of s_rx_filter_start_tmr                    : signal is "TRUE";
       attribute DONT_TOUCH of s_bsp_rx_data_clear_tmr                  : signal is "TRUE";
       attribute DONT_TOUCH of s_bsp_rx_bit_destuff_en_tmr              : signal is "TRUE";
       attribute DONT_TOUCH of s_bsp_rx_stop_tmr                        : signal is "TRUE";
@@ -199,7 +214,9 @@ begin  -- architecture structural
       constant C_mismatch_eml_rx_crc_error                   : integer := 22;
       constant C_mismatch_eml_rx_form_error                  : integer := 23;
       constant C_mismatch_eml_rx_active_error_flag_bit_error : integer := 24;
-      constant C_MISMATCH_WIDTH                              : integer := 25;
+      constant C_mismatch_rx_msg_received                    : integer := 25;
+      constant C_mismatch_rx_filter_start                    : integer := 26;
+      constant C_MISMATCH_WIDTH                              : integer := 27;
 
       constant C_MISMATCH_NONE : std_logic_vector(C_MISMATCH_WIDTH-1 downto 0) := (others => '0');
       signal s_mismatch_vector : std_logic_vector(C_MISMATCH_WIDTH-1 downto 0);
@@ -227,7 +244,11 @@ begin  -- architecture structural
             RESET                              => RESET,
             RX_MSG_OUT                         => s_rx_msg_out_tmr(i),
             RX_MSG_VALID                       => s_rx_msg_valid_tmr(i),
+            RX_MSG_RECEIVED                    => s_rx_msg_received_tmr(i),
             TX_ARB_WON                         => TX_ARB_WON,
+            RX_FILTER_START                    => s_rx_filter_start_tmr(i),
+            RX_FILTER_DONE                     => RX_FILTER_DONE,
+            RX_FILTER_ACCEPT                   => RX_FILTER_ACCEPT,
             BSP_RX_ACTIVE                      => BSP_RX_ACTIVE,
             BSP_RX_IFS                         => BSP_RX_IFS,
             BSP_RX_DATA                        => BSP_RX_DATA,
@@ -359,6 +380,30 @@ begin  -- architecture structural
           VOTER_OUT => RX_MSG_VALID,
           MISMATCH  => s_mismatch_vector(C_mismatch_rx_msg_valid));
 
+      INST_rx_msg_received_voter : entity work.tmr_voter
+        generic map (
+          G_MISMATCH_OUTPUT_EN  => G_MISMATCH_OUTPUT_EN,
+          G_MISMATCH_OUTPUT_REG => C_MISMATCH_OUTPUT_REG)
+        port map (
+          CLK       => CLK,
+          INPUT_A   => s_rx_msg_received_tmr(0),
+          INPUT_B   => s_rx_msg_received_tmr(1),
+          INPUT_C   => s_rx_msg_received_tmr(2),
+          VOTER_OUT => RX_MSG_RECEIVED,
+          MISMATCH  => s_mismatch_vector(C_mismatch_rx_msg_received));
+
+      INST_rx_filter_start_voter : entity work.tmr_voter
+        generic map (
+          G_MISMATCH_OUTPUT_EN  => G_MISMATCH_OUTPUT_EN,
+          G_MISMATCH_OUTPUT_REG => C_MISMATCH_OUTPUT_REG)
+        port map (
+          CLK       => CLK,
+          INPUT_A   => s_rx_filter_start_tmr(0),
+          INPUT_B   => s_rx_filter_start_tmr(1),
+          INPUT_C   => s_rx_filter_start_tmr(2),
+          VOTER_OUT => RX_FILTER_START,
+          MISMATCH  => s_mismatch_vector(C_mismatch_rx_filter_start));
+
       INST_bsp_rx_data_clear_voter : entity work.tmr_voter
         generic map (
           G_MISMATCH_OUTPUT_EN  => G_MISMATCH_OUTPUT_EN,
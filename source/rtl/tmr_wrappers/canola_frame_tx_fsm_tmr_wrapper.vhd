@@ -6,7 +6,7 @@
 -- Author     : Simon Voigt Nesbø  <svn@hvl.no>
 -- Company    :
 -- Created    : 2020-01-29
--- Last update: 2020-08-30
+-- Last update: 2026-10-16
 -- Platform   :
 -- Standard   : VHDL'08
 -------------------------------------------------------------------------------
@@ -20,6 +20,7 @@
 -- Revisions  :
 -- Date        Version  Author  Description
 -- 2020-01-29  1.0      svn     Created
+-- 2026-10-16  1.1      svn     Added Tx message reload and abort inputs
 -------------------------------------------------------------------------------
 library ieee;
 use ieee.std_logic_1164.all;
@@ -41,6 +42,8 @@ entity canola_frame_tx_fsm_tmr_wrapper is
     TX_MSG_IN                      : in  can_msg_t;
     TX_START                       : in  std_logic;  -- Start sending TX_MSG
     TX_RETRANSMIT_EN               : in  std_logic;
+    TX_MSG_RELOAD                  : in  std_logic;  -- Reload TX_MSG_IN as a new message on retransmit
+    TX_ABORT                       : in  std_logic;  -- Fail instead of retransmitting
     TX_BUSY                        : out std_logic;  -- FSM busy
     TX_DONE                        : out std_logic;  -- Transmit complete, ack received
     TX_ARB_LOST                    : out std_logic;  -- Arbitration was lost
@@ -101,6 +104,8 @@ begin  -- architecture structural
           TX_MSG_IN                          => TX_MSG_IN,
           TX_START                           => TX_START,
           TX_RETRANSMIT_EN                   => TX_RETRANSMIT_EN,
+          TX_MSG_RELOAD                      => TX_MSG_RELOAD,
+          TX_ABORT                           => TX_ABORT,
           TX_BUSY                            => TX_BUSY,
           TX_DONE                            => TX_DONE,
           TX_ARB_LOST                        => TX_ARB_LOST,
@@ -229,6 +234,10 @@ begin  -- architecture structural
             TX_MSG_IN                          => TX_MSG_IN,
             TX_START                           => TX_START,
             TX_RETRANSMIT_EN                   => TX_RETRANSMIT_EN,
+            TX_MSG_RELOAD                      => TX_MSG_RELOAD,
+            TX_ABORT                           => TX_ABORT,
+          TX_MSG_RELOAD                      => TX_MSG_RELOAD,
+          TX_ABORT                           => TX_ABORT,
             TX_BUSY                            => s_tx_busy_tmr(i),
             TX_DONE                            => s_tx_done_tmr(i),
             TX_ARB_LOST                        => s_tx_arb_lost_tmr(i),
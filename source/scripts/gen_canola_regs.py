@@ -0,0 +1,321 @@
+#!/usr/bin/env python3
+"""
+Generate compile-time typed register/field accessors (C++) for the Canola
+AXI-slave from the register description in source/json/canola.json.
+
+Outputs:
+  canola_regs.hpp       - constexpr Register<>/Field<> definitions
+  canola_regs_check.hpp - static_asserts that the generated layout matches
+                          the register header generated by uart
+                          (canola_axi_slave.hpp)
+
+Usage: ./gen_canola_regs.py [json file] [-o output directory]
+"""
+
+import argparse
+import json
+import os
+import sys
+
+DATA_WIDTH = 32
+MODES = ('ro', 'rw', 'pulse')
+
+
+class LayoutError(Exception):
+    pass
+
+
+def parse_int(value, default=0):
+    if value is None:
+        return default
+    if isinstance(value, int):
+        return value
+    return int(value, 0)
+
+
+def field_width(field):
+    if field['type'] == 'sl':
+        return 1
+    return parse_int(field.get('length'), DATA_WIDTH)
+
+
+def parse_registers(desc):
+    """Return list of registers with absolute bit positions for all fields"""
+    registers = []
+    addresses = {}
+
+    for reg in desc['register']:
+        name = reg['name']
+        address = parse_int(reg['address'])
+        mode = reg['mode']
+
+        if mode not in MODES:
+            raise LayoutError('%s: unknown mode "%s"' % (name, mode))
+        if address % (DATA_WIDTH // 8) != 0:
+            raise LayoutError('%s: address 0x%x is not %d-bit aligned' % (name, address, DATA_WIDTH))
+        if address in addresses:
+            raise LayoutError('%s: address 0x%x already used by %s' % (name, address, addresses[address]))
+        addresses[address] = name
+
+        fields = []
+        if reg['type'] == 'fields':
+            offset = 0
+            for field in reg['fields']:
+                width = field_width(field)
+                fields.append({'name': field['name'],
+                               'offset': offset,
+                               'width': width,
+                               'reset': parse_int(field.get('reset'))})
+                offset += width
+        else:
+            fields.append({'name': 'VALUE',
+                           'offset': 0,
+                           'width': parse_int(reg.get('length'), DATA_WIDTH),
+                           'reset': parse_int(reg.get('reset'))})
+
+        names = set()
+        for field in fields:
+            if field['width'] < 1 or field['offset'] + field['width'] > DATA_WIDTH:
+                raise LayoutError('%s.%s: bits %d..%d do not fit in a %d-bit register'
+                                  % (name, field['name'], field['offset'],
+                                     field['offset'] + field['width'] - 1, DATA_WIDTH))
+            if field['name'] in names:
+                raise LayoutError('%s: duplicate field %s' % (name, field['name']))
+            if field['reset'] >> field['width']:
+                raise LayoutError('%s.%s: reset value 0x%x does not fit in %d bits'
+                                  % (name, field['name'], field['reset'], field['width']))
+            names.add(field['name'])
+
+        if reg['type'] == 'fields':
+            reset = 0
+            for field in fields:
+                reset |= field['reset'] << field['offset']
+        else:
+            reset = fields[0]['reset']
+
+        registers.append({'name': name,
+                          'address': address,
+                          'mode': mode,
+                          'type': reg['type'],
+                          'reset': reset,
+                          'description': reg.get('description', ''),
+                          'fields': fields})
+
+    return registers
+
+
+HEADER = """\
+/**
+ * @file   canola_regs.hpp
+ * @brief  Compile-time typed register and field accessors for {name}.
+ *
+ *         Generated by source/scripts/gen_canola_regs.py from
+ *         source/json/canola.json - DO NOT EDIT.
+ */
+
+#ifndef CANOLA_REGS_HPP
+#define CANOLA_REGS_HPP
+
+#include <cstdint>
+
+namespace canola
+{{
+namespace reg
+{{
+
+enum class Access {{ RO, RW, PULSE }};
+
+template <uint32_t Offset, uint32_t Width>
+struct Field {{
+  static_assert(Width >= 1 && Width <= 32, "Field width out of range");
+  static_assert(Offset + Width <= 32, "Field does not fit in 32-bit register");
+
+  static constexpr uint32_t offset = Offset;
+  static constexpr uint32_t width  = Width;
+  static constexpr uint32_t mask   = uint32_t((uint64_t(1) << Width) - 1) << Offset;
+
+  // Extract field value from register value
+  static constexpr uint32_t get(uint32_t reg) {{ return (reg & mask) >> Offset; }}
+
+  // Register value with only this field set to value
+  static constexpr uint32_t set(uint32_t value) {{ return (value << Offset) & mask; }}
+
+  // Replace this field in register value
+  static constexpr uint32_t insert(uint32_t reg, uint32_t value) {{ return (reg & ~mask) | set(value); }}
+}};
+
+namespace detail
+{{
+constexpr uint32_t mask_or() {{ return 0; }}
+
+template <typename F, typename... Fs>
+constexpr uint32_t mask_or(F, Fs... fs) {{ return F::mask | mask_or(fs...); }}
+
+constexpr bool disjoint(uint32_t) {{ return true; }}
+
+template <typename F, typename... Fs>
+constexpr bool disjoint(uint32_t used, F, Fs... fs) {{
+  return (used & F::mask) == 0 && disjoint(used | F::mask, fs...);
+}}
+}} // namespace detail
+
+template <uint32_t Address, uint32_t Reset, Access Mode, typename... Fields>
+struct Register {{
+  static_assert(Address % 4 == 0, "Register address is not 32-bit aligned");
+  static_assert(detail::disjoint(0, Fields()...), "Register has overlapping fields");
+  static_assert((Reset & ~detail::mask_or(Fields()...)) == 0, "Reset value outside of fields");
+
+  static constexpr uint32_t address  = Address;
+  static constexpr uint32_t reset    = Reset;
+  static constexpr uint32_t mask     = detail::mask_or(Fields()...);
+  static constexpr Access   access   = Mode;
+  static constexpr bool     readable = Mode != Access::PULSE;
+  static constexpr bool     writable = Mode != Access::RO;
+}};
+
+namespace detail
+{{
+constexpr bool unique_addresses(const uint32_t* addr, unsigned int n)
+{{
+  for(unsigned int i = 0; i < n; i++)
+    for(unsigned int j = i+1; j < n; j++)
+      if(addr[i] == addr[j])
+        return false;
+  return true;
+}}
+}} // namespace detail
+"""
+
+FOOTER = """\
+}} // namespace reg
+}} // namespace canola
+
+#endif
+"""
+
+CHECK_HEADER = """\
+/**
+ * @file   canola_regs_check.hpp
+ * @brief  Compile-time check that the register layout in canola_regs.hpp
+ *         matches canola_axi_slave.hpp. Any mismatch fails the build.
+ *
+ *         Generated by source/scripts/gen_canola_regs.py from
+ *         source/json/canola.json - DO NOT EDIT.
+ */
+
+#ifndef CANOLA_REGS_CHECK_HPP
+#define CANOLA_REGS_CHECK_HPP
+
+#include "canola_axi_slave.hpp"
+#include "canola_regs.hpp"
+
+namespace canola
+{
+namespace reg
+{
+namespace check
+{
+namespace ref = CANOLA_AXI_SLAVE;
+
+"""
+
+CHECK_FOOTER = """\
+} // namespace check
+} // namespace reg
+} // namespace canola
+
+#endif
+"""
+
+ACCESS = {'ro': 'Access::RO', 'rw': 'Access::RW', 'pulse': 'Access::PULSE'}
+
+
+def gen_register(reg):
+    fields = reg['fields']
+    lines = []
+    lines.append('/* Register: %s (%s) - %s */' % (reg['name'], reg['mode'].upper(), reg['description']))
+
+    field_types = ', '.join('Field<%d, %d>' % (f['offset'], f['width']) for f in fields)
+    lines.append('struct %s : Register<0x%x, 0x%x, %s, %s> {'
+                 % (reg['name'], reg['address'], reg['reset'], ACCESS[reg['mode']], field_types))
+
+    for f in fields:
+        lines.append('  using %s = Field<%d, %d>;' % (f['name'], f['offset'], f['width']))
+
+    # Struct with one member per field, to pack/unpack the whole register at once
+    lines.append('')
+    lines.append('  struct Value {')
+    for f in fields:
+        lines.append('    uint32_t %s;' % f['name'])
+    lines.append('  };')
+    lines.append('')
+    lines.append('  static constexpr uint32_t pack(const Value& v) {')
+    lines.append('    return ' + ' |\n      '.join('%s::set(v.%s)' % (f['name'], f['name']) for f in fields) + ';')
+    lines.append('  }')
+    lines.append('')
+    lines.append('  static constexpr Value unpack(uint32_t reg) {')
+    lines.append('    return Value{' + ', '.join('%s::get(reg)' % f['name'] for f in fields) + '};')
+    lines.append('  }')
+    lines.append('};')
+    lines.append('')
+    return '\n'.join(lines) + '\n'
+
+
+def gen_regs_hpp(desc, registers):
+    out = HEADER.format(name=desc['name'])
+    out += '\n'
+    for reg in registers:
+        out += gen_register(reg)
+
+    out += 'constexpr uint32_t ALL_ADDRESSES[] = {\n'
+    out += ',\n'.join('  %s::address' % reg['name'] for reg in registers)
+    out += '\n};\n\n'
+    out += ('static_assert(detail::unique_addresses(ALL_ADDRESSES, sizeof(ALL_ADDRESSES)/sizeof(ALL_ADDRESSES[0])),\n'
+            '              "Two registers share the same address");\n\n')
+    out += FOOTER.format()
+    return out
+
+
+def gen_check_hpp(registers):
+    out = CHECK_HEADER
+    for reg in registers:
+        name = reg['name']
+        out += '/* %s */\n' % name
+        out += 'static_assert(%s::address == ref::%s_OFFSET, "%s: address mismatch");\n' % (name, name, name)
+        out += 'static_assert(%s::reset == ref::%s_RESET, "%s: reset mismatch");\n' % (name, name, name)
+        if reg['type'] == 'fields':
+            for f in reg['fields']:
+                ref = '%s_%s' % (name, f['name'])
+                fld = '%s::%s' % (name, f['name'])
+                out += 'static_assert(%s::offset == ref::%s_OFFSET && %s::width == ref::%s_WIDTH &&\n' % (fld, ref, fld, ref)
+                out += '              %s::mask == ref::%s_MASK, "%s: layout mismatch");\n' % (fld, ref, ref)
+        out += '\n'
+    out += CHECK_FOOTER
+    return out
+
+
+def main():
+    script_dir = os.path.dirname(os.path.abspath(__file__))
+    parser = argparse.ArgumentParser(description='Generate C++ register accessors for Canola')
+    parser.add_argument('json', nargs='?', default=os.path.join(script_dir, '..', 'json', 'canola.json'))
+    parser.add_argument('-o', '--output', default=os.path.join(script_dir, '..', '..', 'software', 'cpp'))
+    args = parser.parse_args()
+
+    with open(args.json) as f:
+        desc = json.load(f)
+
+    try:
+        registers = parse_registers(desc)
+    except LayoutError as e:
+        print('Register layout error: %s' % e, file=sys.stderr)
+        sys.exit(1)
+
+    with open(os.path.join(args.output, 'canola_regs.hpp'), 'w') as f:
+        f.write(gen_regs_hpp(desc, registers))
+
+    with open(os.path.join(args.output, 'canola_regs_check.hpp'), 'w') as f:
+        f.write(gen_check_hpp(registers))
+
+
+if __name__ == '__main__':
+    main()
@@ -40,4 +40,7 @@ else
     mv temp/canola_axi_slave/hdl/canola_axi_slave_pif_pkg.vhd ../rtl/axi_slave/
     mv temp/canola_axi_slave/docs/canola_axi_slave.tex ../../doc/
     rm -rf temp
+
+    # Typed C++ register accessors (canola_regs.hpp, canola_regs_check.hpp)
+    python3 gen_canola_regs.py ../json/canola.json -o ../../software/cpp || exit 1
 fi
@@ -185,6 +185,9 @@ set files [list \
  [file normalize "${origin_dir}/../source/rtl/canola_btl.vhd"] \
  [file normalize "${origin_dir}/../source/rtl/canola_time_quanta_gen.vhd"] \
  [file normalize "${origin_dir}/../source/rtl/canola_eml.vhd"] \
+ [file normalize "${origin_dir}/../source/rtl/canola_acceptance_filter.vhd"] \
+ [file normalize "${origin_dir}/../source/rtl/canola_rx_fifo.vhd"] \
+ [file normalize "${origin_dir}/../source/rtl/canola_tx_mailboxes.vhd"] \
  [file normalize "${origin_dir}/../source/rtl/counters/counter_saturating.vhd"] \
  [file normalize "${origin_dir}/../source/rtl/counters/up_counter.vhd"] \
  [file normalize "${origin_dir}/../source/rtl/canola_top.vhd"] \
@@ -266,6 +269,21 @@ set file [file normalize $file]
 set file_obj [get_files -of_objects [get_filesets sources_1] [list "*$file"]]
 set_property -name "file_type" -value "VHDL 2008" -objects $file_obj
 
+set file "$origin_dir/../source/rtl/canola_acceptance_filter.vhd"
+set file [file normalize $file]
+set file_obj [get_files -of_objects [get_filesets sources_1] [list "*$file"]]
+set_property -name "file_type" -value "VHDL 2008" -objects $file_obj
+
+set file "$origin_dir/../source/rtl/canola_rx_fifo.vhd"
+set file [file normalize $file]
+set file_obj [get_files -of_objects [get_filesets sources_1] [list "*$file"]]
+set_property -name "file_type" -value "VHDL 2008" -objects $file_obj
+
+set file "$origin_dir/../source/rtl/canola_tx_mailboxes.vhd"
+set file [file normalize $file]
+set file_obj [get_files -of_objects [get_filesets sources_1] [list "*$file"]]
+set_property -name "file_type" -value "VHDL 2008" -objects $file_obj
+
 set file "$origin_dir/../source/rtl/counters/counter_saturating.vhd"
 set file [file normalize $file]
 set file_obj [get_files -of_objects [get_filesets sources_1] [list "*$file"]]
@@ -466,6 +484,15 @@ if { [get_files canola_btl.vhd] == "" } {
 if { [get_files canola_eml.vhd] == "" } {
   import_files -quiet -fileset sources_1 /home/simon/Code/FPGA/canola/source/rtl/canola_eml.vhd
 }
+if { [get_files canola_acceptance_filter.vhd] == "" } {
+  import_files -quiet -fileset sources_1 /home/simon/Code/FPGA/canola/source/rtl/canola_acceptance_filter.vhd
+}
+if { [get_files canola_rx_fifo.vhd] == "" } {
+  import_files -quiet -fileset sources_1 /home/simon/Code/FPGA/canola/source/rtl/canola_rx_fifo.vhd
+}
+if { [get_files canola_tx_mailboxes.vhd] == "" } {
+  import_files -quiet -fileset sources_1 /home/simon/Code/FPGA/canola/source/rtl/canola_tx_mailboxes.vhd
+}
 if { [get_files counter_saturating.vhd] == "" } {
   import_files -quiet -fileset sources_1 /home/simon/Code/FPGA/canola/source/rtl/counters/counter_saturating.vhd
 }
@@ -514,6 +541,15 @@ if { [get_files canola_btl.vhd] == "" } {
 if { [get_files canola_eml.vhd] == "" } {
   import_files -quiet -fileset sources_1 /home/simon/Code/FPGA/canola/source/rtl/canola_eml.vhd
 }
+if { [get_files canola_acceptance_filter.vhd] == "" } {
+  import_files -quiet -fileset sources_1 /home/simon/Code/FPGA/canola/source/rtl/canola_acceptance_filter.vhd
+}
+if { [get_files canola_rx_fifo.vhd] == "" } {
+  import_files -quiet -fileset sources_1 /home/simon/Code/FPGA/canola/source/rtl/canola_rx_fifo.vhd
+}
+if { [get_files canola_tx_mailboxes.vhd] == "" } {
+  import_files -quiet -fileset sources_1 /home/simon/Code/FPGA/canola/source/rtl/canola_tx_mailboxes.vhd
+}
 if { [get_files counter_saturating.vhd] == "" } {
   import_files -quiet -fileset sources_1 /home/simon/Code/FPGA/canola/source/rtl/counters/counter_saturating.vhd
 }
@@ -562,6 +598,15 @@ if { [get_files canola_btl.vhd] == "" } {
 if { [get_files canola_eml.vhd] == "" } {
   import_files -quiet -fileset sources_1 /home/simon/Code/FPGA/canola/source/rtl/canola_eml.vhd
 }
+if { [get_files canola_acceptance_filter.vhd] == "" } {
+  import_files -quiet -fileset sources_1 /home/simon/Code/FPGA/canola/source/rtl/canola_acceptance_filter.vhd
+}
+if { [get_files canola_rx_fifo.vhd] == "" } {
+  import_files -quiet -fileset sources_1 /home/simon/Code/FPGA/canola/source/rtl/canola_rx_fifo.vhd
+}
+if { [get_files canola_tx_mailboxes.vhd] == "" } {
+  import_files -quiet -fileset sources_1 /home/simon/Code/FPGA/canola/source/rtl/canola_tx_mailboxes.vhd
+}
 if { [get_files counter_saturating.vhd] == "" } {
   import_files -quiet -fileset sources_1 /home/simon/Code/FPGA/canola/source/rtl/counters/counter_saturating.vhd
 }
@@ -643,6 +688,15 @@ if { [get_files canola_btl.vhd] == "" } {
 if { [get_files canola_eml.vhd] == "" } {
   import_files -quiet -fileset sources_1 /home/simon/Code/FPGA/canola/source/rtl/canola_eml.vhd
 }
+if { [get_files canola_acceptance_filter.vhd] == "" } {
+  import_files -quiet -fileset sources_1 /home/simon/Code/FPGA/canola/source/rtl/canola_acceptance_filter.vhd
+}
+if { [get_files canola_rx_fifo.vhd] == "" } {
+  import_files -quiet -fileset sources_1 /home/simon/Code/FPGA/canola/source/rtl/canola_rx_fifo.vhd
+}
+if { [get_files canola_tx_mailboxes.vhd] == "" } {
+  import_files -quiet -fileset sources_1 /home/simon/Code/FPGA/canola/source/rtl/canola_tx_mailboxes.vhd
+}
 if { [get_files counter_saturating.vhd] == "" } {
   import_files -quiet -fileset sources_1 /home/simon/Code/FPGA/canola/source/rtl/counters/counter_saturating.vhd
 }